@@ -0,0 +1,48 @@
+# ev_generate_validators(TARGET <target> INTERFACES_DIR <dir> TYPES_DIR <dir> [INTERFACES <name>...])
+#
+# Generates C++ validators for the cmds and vars of the given interfaces, or of all interfaces in INTERFACES_DIR, and
+# adds them to the sources of TARGET. Everest then uses them instead of interpreting the json schemas of these
+# interfaces at runtime. The generated validators register themselves during static initialization, so TARGET has to
+# be the module executable or a shared library, object files of a static library might not be linked.
+
+set(EV_GENERATE_VALIDATORS_SCRIPT ${CMAKE_CURRENT_LIST_DIR}/generate_validators.py)
+
+function(ev_generate_validators)
+    set(one_value_args TARGET INTERFACES_DIR TYPES_DIR)
+    set(multi_value_args INTERFACES)
+    cmake_parse_arguments(arg "" "${one_value_args}" "${multi_value_args}" ${ARGN})
+
+    if (NOT arg_TARGET OR NOT arg_INTERFACES_DIR OR NOT arg_TYPES_DIR)
+        message(FATAL_ERROR "ev_generate_validators() needs TARGET, INTERFACES_DIR and TYPES_DIR")
+    endif()
+
+    find_package(Python3 REQUIRED COMPONENTS Interpreter)
+
+    if (arg_INTERFACES)
+        set(interface_files)
+        foreach(interface ${arg_INTERFACES})
+            list(APPEND interface_files ${arg_INTERFACES_DIR}/${interface}.yaml)
+        endforeach()
+    else()
+        file(GLOB interface_files CONFIGURE_DEPENDS ${arg_INTERFACES_DIR}/*.yaml)
+    endif()
+    file(GLOB_RECURSE type_files CONFIGURE_DEPENDS ${arg_TYPES_DIR}/*.yaml)
+
+    set(output ${CMAKE_CURRENT_BINARY_DIR}/generated/${arg_TARGET}_validators.cpp)
+    add_custom_command(
+        OUTPUT ${output}
+        COMMAND
+            ${Python3_EXECUTABLE} ${EV_GENERATE_VALIDATORS_SCRIPT}
+            --interfaces-dir ${arg_INTERFACES_DIR}
+            --types-dir ${arg_TYPES_DIR}
+            --output ${output}
+            ${arg_INTERFACES}
+        DEPENDS
+            ${EV_GENERATE_VALIDATORS_SCRIPT}
+            ${interface_files}
+            ${type_files}
+        COMMENT "Generating validators of ${arg_TARGET}"
+        VERBATIM
+    )
+    target_sources(${arg_TARGET} PRIVATE ${output})
+endfunction()
@@ -0,0 +1,333 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: Apache-2.0
+# Copyright Pionix GmbH and Contributors to EVerest
+"""
+Generates C++ validators for the schemas of the cmds and vars of EVerest interfaces, see ev-generate-validators.cmake
+
+Every schema is translated into a function checking the keywords of the schema directly, instead of interpreting the
+schema with the json schema validator at runtime. The generated functions register themselves with
+Everest::native_validators, so Everest uses them for the interfaces they have been generated for.
+
+Schemas using keywords that are not supported by the generator are skipped, they are still validated by the json
+schema validator.
+"""
+
+import argparse
+import json
+import math
+import sys
+from pathlib import Path
+
+import yaml
+
+# keywords that do not affect validation
+ANNOTATIONS = {'description', 'title', 'default', 'examples', '$comment', '$schema', 'readOnly', 'writeOnly', 'qos'}
+
+TYPE_CHECKS = {
+    'null': 'value.is_null()',
+    'boolean': 'value.is_boolean()',
+    'object': 'value.is_object()',
+    'array': 'value.is_array()',
+    'string': 'value.is_string()',
+    'number': 'value.is_number()',
+    'integer': 'Everest::native_validators::is_integer(value)',
+}
+
+NUMBER_KEYWORDS = {'minimum', 'maximum', 'exclusiveMinimum', 'exclusiveMaximum'}
+STRING_KEYWORDS = {'minLength', 'maxLength', 'pattern', 'format'}
+ARRAY_KEYWORDS = {'items', 'minItems', 'maxItems', 'uniqueItems'}
+OBJECT_KEYWORDS = {'properties', 'required', 'additionalProperties', 'minProperties', 'maxProperties'}
+SUPPORTED = (ANNOTATIONS | NUMBER_KEYWORDS | STRING_KEYWORDS | ARRAY_KEYWORDS | OBJECT_KEYWORDS |
+             {'$ref', 'type', 'enum', 'const', 'allOf'})
+
+
+class UnsupportedSchema(Exception):
+    pass
+
+
+def cpp_string(value):
+    """Returns value as C++ string literal"""
+    escaped = []
+    for c in value:
+        if c in '"\\':
+            escaped.append('\\' + c)
+        elif c == '\n':
+            escaped.append('\\n')
+        elif ord(c) < 0x20:
+            escaped.append('\\{:03o}'.format(ord(c)))
+        else:
+            escaped.append(c)
+    return '"' + ''.join(escaped) + '"'
+
+
+def cpp_json(value):
+    """Returns a C++ expression parsing value as json"""
+    return 'json::parse({})'.format(cpp_string(json.dumps(value, ensure_ascii=False, sort_keys=True)))
+
+
+def cpp_number(value):
+    if isinstance(value, bool) or not isinstance(value, (int, float)) or not math.isfinite(value):
+        raise UnsupportedSchema('{} is not a finite number'.format(value))
+    return repr(float(value))
+
+
+class Generator:
+    def __init__(self, types_dir):
+        self.type_files = {'/' + path.stem: path for path in sorted(Path(types_dir).rglob('*.yaml'))}
+        self.types = {}
+        self.type_functions = {}
+        self.functions = []
+
+    def get_type(self, ref):
+        if not ref.startswith('/') or '#/' not in ref:
+            raise UnsupportedSchema('only refs to types are supported, not {}'.format(ref))
+        type_file, type_name = ref.split('#/', 1)
+        if type_file not in self.types:
+            if type_file not in self.type_files:
+                raise UnsupportedSchema('type file of {} not found'.format(ref))
+            self.types[type_file] = yaml.safe_load(self.type_files[type_file].read_text()).get('types', {})
+        if type_name not in self.types[type_file]:
+            raise UnsupportedSchema('type {} not found'.format(ref))
+        return self.types[type_file][type_name]
+
+    def add_function(self, location):
+        name = 'check_{}'.format(len(self.functions))
+        self.functions.append(None)
+        return name, len(self.functions) - 1
+
+    def compile(self, schema, location):
+        """Returns the name of a function checking a value against the schema"""
+        name, index = self.add_function(location)
+        body = self.compile_body(schema, location)
+        self.functions[index] = '// {}\nvoid {}(const json& value) {{\n{}}}\n'.format(
+            location, name, ''.join('    ' + line + '\n' if line else '\n' for line in body))
+        return name
+
+    def compile_type(self, ref):
+        # the function is named before its body is generated, so recursive types refer to it
+        if ref not in self.type_functions:
+            schema = self.get_type(ref)
+            name, index = self.add_function(ref)
+            self.type_functions[ref] = name
+            try:
+                body = self.compile_body(schema, ref)
+            except UnsupportedSchema:
+                del self.type_functions[ref]
+                raise
+            self.functions[index] = '// {}\nvoid {}(const json& value) {{\n{}}}\n'.format(
+                ref, name, ''.join('    ' + line + '\n' if line else '\n' for line in body))
+        return self.type_functions[ref]
+
+    def compile_body(self, schema, location):
+        if schema is True:
+            return []
+        if schema is False:
+            return ['Everest::native_validators::fail({}, "no value is allowed");'.format(cpp_string(location))]
+        if not isinstance(schema, dict):
+            raise UnsupportedSchema('{} is not a schema'.format(location))
+        unsupported = set(schema) - SUPPORTED
+        if unsupported:
+            raise UnsupportedSchema('{} uses {}'.format(location, ', '.join(sorted(unsupported))))
+
+        loc = cpp_string(location)
+        fail = 'Everest::native_validators::fail(' + loc + ', {});'
+        body = []
+
+        # like in draft 7, all other keywords next to a ref are ignored
+        if '$ref' in schema:
+            return ['{}(value);'.format(self.compile_type(schema['$ref']))]
+
+        if 'type' in schema:
+            types = schema['type'] if isinstance(schema['type'], list) else [schema['type']]
+            if any(t not in TYPE_CHECKS for t in types):
+                raise UnsupportedSchema('{} has an unknown type'.format(location))
+            body += ['if (not({})) {{'.format(' or '.join(TYPE_CHECKS[t] for t in types)),
+                     '    ' + fail.format(cpp_string('value is not of type ' + ', '.join(types))),
+                     '}']
+
+        if 'enum' in schema:
+            body += ['static const json allowed = {};'.format(cpp_json(schema['enum'])),
+                     'if (std::find(allowed.begin(), allowed.end(), value) == allowed.end()) {',
+                     '    ' + fail.format('"value is not one of the allowed values"'),
+                     '}']
+
+        if 'const' in schema:
+            body += ['static const json expected = {};'.format(cpp_json(schema['const'])),
+                     'if (value != expected) {',
+                     '    ' + fail.format('"value is not the expected constant"'),
+                     '}']
+
+        if NUMBER_KEYWORDS & set(schema):
+            checks = [('minimum', '<'), ('maximum', '>'), ('exclusiveMinimum', '<='), ('exclusiveMaximum', '>=')]
+            body += ['if (value.is_number()) {', '    const auto number = value.get<double>();']
+            for keyword, violated in checks:
+                if keyword in schema:
+                    body += ['    if (number {} {}) {{'.format(violated, cpp_number(schema[keyword])),
+                             '        ' + fail.format(cpp_string('value violates ' + keyword)),
+                             '    }']
+            body += ['}']
+
+        if STRING_KEYWORDS & set(schema):
+            body += ['if (value.is_string()) {', '    const auto& string = value.get_ref<const std::string&>();']
+            for keyword, violated in [('minLength', '<'), ('maxLength', '>')]:
+                if keyword in schema:
+                    body += ['    if (Everest::native_validators::utf8_length(string) {} {}u) {{'.format(
+                                 violated, int(schema[keyword])),
+                             '        ' + fail.format(cpp_string('value violates ' + keyword)),
+                             '    }']
+            if 'pattern' in schema:
+                body += ['    static const std::regex pattern({});'.format(cpp_string(schema['pattern'])),
+                         '    if (not std::regex_search(string, pattern)) {',
+                         '        ' + fail.format(cpp_string('value does not match ' + schema['pattern'])),
+                         '    }']
+            if 'format' in schema:
+                body += ['    try {',
+                         '        Everest::Config::format_checker({}, string);'.format(cpp_string(schema['format'])),
+                         '    } catch (const std::exception& e) {',
+                         '        ' + fail.format('e.what()'),
+                         '    }']
+            body += ['}']
+
+        if ARRAY_KEYWORDS & set(schema):
+            body += ['if (value.is_array()) {']
+            for keyword, violated in [('minItems', '<'), ('maxItems', '>')]:
+                if keyword in schema:
+                    body += ['    if (value.size() {} {}u) {{'.format(violated, int(schema[keyword])),
+                             '        ' + fail.format(cpp_string('value violates ' + keyword)),
+                             '    }']
+            if schema.get('uniqueItems', False):
+                body += ['    for (auto item = value.begin(); item != value.end(); ++item) {',
+                         '        if (std::find(std::next(item), value.end(), *item) != value.end()) {',
+                         '            ' + fail.format('"items are not unique"'),
+                         '        }',
+                         '    }']
+            if 'items' in schema:
+                if isinstance(schema['items'], list):
+                    raise UnsupportedSchema('{} uses tuple items'.format(location))
+                body += ['    for (const auto& item : value) {',
+                         '        {}(item);'.format(self.compile(schema['items'], location + '/items')),
+                         '    }']
+            body += ['}']
+
+        if OBJECT_KEYWORDS & set(schema):
+            body += ['if (value.is_object()) {']
+            for keyword, violated in [('minProperties', '<'), ('maxProperties', '>')]:
+                if keyword in schema:
+                    body += ['    if (value.size() {} {}u) {{'.format(violated, int(schema[keyword])),
+                             '        ' + fail.format(cpp_string('value violates ' + keyword)),
+                             '    }']
+            for required in schema.get('required', []):
+                body += ['    if (not value.contains({})) {{'.format(cpp_string(required)),
+                         '        ' + fail.format(cpp_string('required property ' + required + ' is missing')),
+                         '    }']
+            properties = schema.get('properties', {})
+            for property_name in sorted(properties):
+                check = self.compile(properties[property_name], location + '/properties/' + property_name)
+                body += ['    if (const auto property = value.find({}); property != value.end()) {{'.format(
+                             cpp_string(property_name)),
+                         '        {}(*property);'.format(check),
+                         '    }']
+            additional = schema.get('additionalProperties', True)
+            if additional is not True:
+                known = ' and '.join('property.key() != {}'.format(cpp_string(p)) for p in sorted(properties))
+                body += ['    for (const auto& property : value.items()) {',
+                         '        if ({}) {{'.format(known or 'true')]
+                if additional is False:
+                    body += ['            ' + fail.format('"additional properties are not allowed"')]
+                else:
+                    check = self.compile(additional, location + '/additionalProperties')
+                    body += ['            {}(property.value());'.format(check)]
+                body += ['        }', '    }']
+            body += ['}']
+
+        for i, sub_schema in enumerate(schema.get('allOf', [])):
+            body += ['{}(value);'.format(self.compile(sub_schema, '{}/allOf/{}'.format(location, i)))]
+
+        return body
+
+    def generate(self, interfaces):
+        registrations = []
+        for interface_name, interface in interfaces:
+            schemas = []
+            for var_name, var in sorted((interface.get('vars') or {}).items()):
+                schemas.append(('vars/' + var_name, var))
+            for cmd_name, cmd in sorted((interface.get('cmds') or {}).items()):
+                for arg_name, arg in sorted((cmd.get('arguments') or {}).items()):
+                    schemas.append(('cmds/{}/arguments/{}'.format(cmd_name, arg_name), arg))
+                if cmd.get('result') is not None:
+                    schemas.append(('cmds/{}/result'.format(cmd_name), cmd['result']))
+
+            for schema_path, schema in schemas:
+                functions = len(self.functions)
+                try:
+                    check = self.compile(schema, '{}#/{}'.format(interface_name, schema_path))
+                    registrations.append((interface_name, schema_path, check))
+                except UnsupportedSchema as e:
+                    # drop the functions of the partially generated schema
+                    self.functions = self.functions[:functions]
+                    self.type_functions = {ref: name for ref, name in self.type_functions.items()
+                                           if int(name.split('_')[1]) < functions}
+                    print('Not generating a validator for {}#/{}: {}'.format(interface_name, schema_path, e),
+                          file=sys.stderr)
+
+        declarations = ''.join('void check_{}(const json& value);\n'.format(i) for i in range(len(self.functions)))
+        registration_list = ''.join('    {{{}, {}, &{}}},\n'.format(cpp_string(interface_name), cpp_string(path),
+                                                                   check)
+                                    for interface_name, path, check in registrations)
+        if registration_list:
+            registration_list = REGISTRATIONS.format(registration_list)
+        return TEMPLATE.format(interfaces=', '.join(name for name, _ in interfaces), declarations=declarations,
+                               functions='\n'.join(self.functions), registrations=registration_list)
+
+
+TEMPLATE = '''// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+//
+// Generated by generate_validators.py, do not edit
+// Interfaces: {interfaces}
+#include <algorithm>
+#include <iterator>
+#include <regex>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+#include <utils/config.hpp>
+#include <utils/schema_validator.hpp>
+
+namespace {{
+
+using json = nlohmann::json;
+
+{declarations}
+{functions}{registrations}
+}} // namespace
+'''
+
+REGISTRATIONS = '''
+const Everest::native_validators::Registration registrations[] = {{
+{}}};
+'''
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--interfaces-dir', type=Path, required=True, help='directory of the interface definitions')
+    parser.add_argument('--types-dir', type=Path, required=True, help='directory of the type definitions')
+    parser.add_argument('--output', type=Path, required=True, help='C++ file to generate')
+    parser.add_argument('interfaces', nargs='*', help='names of the interfaces, all interfaces if none are given')
+    args = parser.parse_args()
+
+    names = args.interfaces or sorted(path.stem for path in args.interfaces_dir.glob('*.yaml'))
+    interfaces = [(name, yaml.safe_load((args.interfaces_dir / (name + '.yaml')).read_text()) or {})
+                  for name in names]
+    source = Generator(args.types_dir).generate(interfaces)
+
+    # keep the timestamp of an unchanged file, so it is not compiled again
+    if not args.output.exists() or args.output.read_text() != source:
+        args.output.parent.mkdir(parents=True, exist_ok=True)
+        args.output.write_text(source)
+
+
+if __name__ == '__main__':
+    main()
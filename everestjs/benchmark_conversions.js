@@ -0,0 +1,29 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+//
+// Compares the recursive conversions of payloads with the conversions by JSON.parse/JSON.stringify, to choose the
+// json_parse_threshold of modules. Run it next to the built everestjs.node: node benchmark_conversions.js [iterations]
+const addon = require('./everestjs.node');
+
+const iterations = Number(process.argv[2] || 10000);
+
+const object_with = (count, make_value) => Object.fromEntries(
+  Array.from({ length: count }, (_, i) => [`key_${i}`, make_value(i)])
+);
+
+const payloads = {
+  scalar: 42,
+  small_object: { current: 16.0, phases: 3, enabled: true },
+  object_16: object_with(16, (i) => i * 0.5),
+  object_64: object_with(64, (i) => `value ${i}`),
+  schedule_96: Array.from({ length: 96 }, (_, i) => ({ start: i * 900, limit: 11000 + i, phases: 3 })),
+  certificate_chain: Array.from({ length: 3 }, () => ({ pem: 'A'.repeat(2048), valid: true })),
+};
+
+console.log('payload            values  to js: recursive  JSON.parse   to json: recursive  JSON.stringify   [ns]');
+Object.entries(payloads).forEach(([name, payload]) => {
+  const r = addon.benchmark_conversions(payload, iterations);
+  console.log(`${name.padEnd(18)} ${String(r.values).padStart(6)}  ${r.to_js_recursive_ns.toFixed(0).padStart(16)}`
+    + `  ${r.to_js_json_parse_ns.toFixed(0).padStart(10)}  ${r.to_json_recursive_ns.toFixed(0).padStart(18)}`
+    + `  ${r.to_json_stringify_ns.toFixed(0).padStart(14)}`);
+});
@@ -110,6 +110,49 @@ Napi::Value convertToNapiValue(const Napi::Env& env, const json& value) {
     EVTHROW(EVEXCEPTION(Everest::EverestApiError, "Javascript type can not be converted to Napi::Value: ", value));
 }
 
+std::size_t count_json_values(const Everest::json& value, std::size_t limit) {
+    std::size_t count = 1;
+    if (not value.is_structured()) {
+        return count;
+    }
+    for (const auto& element : value) {
+        if (count >= limit) {
+            break;
+        }
+        count += count_json_values(element, limit - count);
+    }
+    return count;
+}
+
+PayloadConverter::PayloadConverter(const Napi::Env& env, std::size_t threshold_) : threshold(threshold_) {
+    const auto json_object = env.Global().Get("JSON").As<Napi::Object>();
+    this->json_parse = Napi::Persistent(json_object.Get("parse").As<Napi::Function>());
+    this->json_stringify = Napi::Persistent(json_object.Get("stringify").As<Napi::Function>());
+}
+
+Napi::Value PayloadConverter::to_napi_value(const Napi::Env& env, const Everest::json& value) const {
+    BOOST_LOG_FUNCTION();
+
+    if (this->threshold == 0 or count_json_values(value, this->threshold) < this->threshold) {
+        return convertToNapiValue(env, value);
+    }
+    return this->json_parse.Call({Napi::String::New(env, value.dump())});
+}
+
+Everest::json PayloadConverter::to_json(const Napi::Value& value) const {
+    BOOST_LOG_FUNCTION();
+
+    if (this->threshold == 0 or not(value.IsArray() or (value.IsObject() and value.Type() == napi_object))) {
+        return convertToJson(value);
+    }
+    const auto text = this->json_stringify.Call({value});
+    if (not text.IsString()) {
+        // e.g. a toJSON() method returning undefined
+        return Everest::json(nullptr);
+    }
+    return Everest::json::parse(text.As<Napi::String>().Utf8Value());
+}
+
 Everest::error::Error convertToError(const Napi::Value& value) {
     BOOST_LOG_FUNCTION();
 
@@ -3,6 +3,8 @@
 #ifndef CONVERSIONS_HPP
 #define CONVERSIONS_HPP
 
+#include <cstddef>
+
 #include <framework/everest.hpp>
 
 #include <napi.h>
@@ -32,6 +34,38 @@ Everest::json convertToJson(const Napi::Value& value);
 Everest::TelemetryMap convertToTelemetryMap(const Napi::Object& obj);
 Napi::Value convertToNapiValue(const Napi::Env& env, const Everest::json& value);
 
+/// \brief Payloads with at least this many values are converted by JSON.parse and JSON.stringify by default
+constexpr std::size_t default_json_parse_threshold = 64;
+
+///
+/// \brief Converts the payloads of vars and cmds between Everest::json and javascript values
+/// \details The recursive conversions need several N-API calls per value. Payloads with at least \p threshold values
+///          are serialized instead and parsed by JSON.parse inside V8, which needs a single N-API call. Objects and
+///          arrays coming from javascript are always converted with JSON.stringify if the threshold is not 0, since
+///          their size is not known without visiting them. Unlike the recursive conversion it drops properties that are
+///          undefined or functions and uses the toJSON() methods of values like Dates. A threshold of 0 always uses the
+///          recursive conversions. Must only be used on the javascript thread
+///
+class PayloadConverter {
+public:
+    PayloadConverter(const Napi::Env& env, std::size_t threshold);
+
+    Napi::Value to_napi_value(const Napi::Env& env, const Everest::json& value) const;
+    Everest::json to_json(const Napi::Value& value) const;
+
+    std::size_t get_threshold() const {
+        return this->threshold;
+    }
+
+private:
+    std::size_t threshold;
+    Napi::FunctionReference json_parse;
+    Napi::FunctionReference json_stringify;
+};
+
+/// \returns the number of values in \p value including itself, counting stops once \p limit is reached
+std::size_t count_json_values(const Everest::json& value, std::size_t limit);
+
 // Error related
 Everest::error::Error convertToError(const Napi::Value& value);
 Everest::error::ErrorType convertToErrorType(const Napi::Value& value);
@@ -10,16 +10,22 @@
 
 #include <sys/prctl.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <future>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <thread>
 #include <vector>
 
 #include "conversions.hpp"
+#include "js_dispatcher.hpp"
 #include "js_exec_ctx.hpp"
 #include "utils.hpp"
 
@@ -50,6 +56,8 @@ struct EvModCtx {
     Napi::ObjectReference js_module_ref;
 
     std::unique_ptr<JsExecCtx> js_cb;
+    std::unique_ptr<JsDispatcher> js_dispatcher; ///< cmd calls and var values, without blocking the framework threads
+    std::unique_ptr<PayloadConverter> payloads;  ///< converts the values of vars and cmds
 
     std::map<std::pair<Requirement, std::string>, Napi::FunctionReference> var_subscriptions;
     struct CallbackPair {
@@ -64,16 +72,36 @@ struct EvModCtx {
     std::map<std::string, Napi::FunctionReference> mqtt_subscriptions;
 };
 
-// FIXME (aw): this could go into a class with singleton pattern
-EvModCtx* ctx;
+/// \returns the context of the module running in \p env, each worker thread of a javascript host runs its own module
+static EvModCtx* get_ctx(const Napi::Env& env) {
+    return env.GetInstanceData<EvModCtx>();
+}
+
+/// \brief Keeps the context alive when its environment is torn down, callbacks of the framework might still use it
+static void keep_ctx(Napi::Env, EvModCtx*) {
+}
+
+/// \returns the MQTT connection shared by all modules hosted in this process, established by the first of them
+static std::shared_ptr<Everest::MQTTAbstraction> get_shared_mqtt(const Everest::MQTTSettings& mqtt_settings) {
+    static std::mutex mqtt_mutex;
+    static std::shared_ptr<Everest::MQTTAbstraction> mqtt;
+    const std::lock_guard<std::mutex> lock(mqtt_mutex);
+    if (mqtt == nullptr) {
+        mqtt = std::make_shared<Everest::MQTTAbstraction>(mqtt_settings);
+        mqtt->connect();
+        mqtt->spawn_main_loop_thread();
+    }
+    return mqtt;
+}
 
 static Napi::Value publish_var(const std::string& impl_id, const std::string& var_name,
                                const Napi::CallbackInfo& info) {
     BOOST_LOG_FUNCTION();
     const auto& env = info.Env();
+    auto* ctx = get_ctx(env);
 
     try {
-        ctx->everest->publish_var(impl_id, var_name, convertToJson(info[0]));
+        ctx->everest->publish_var(impl_id, var_name, ctx->payloads->to_json(info[0]));
     } catch (std::exception& e) {
         EVLOG_AND_RETHROW(env);
     }
@@ -86,6 +114,7 @@ static Napi::Value setup_cmd_handler(const std::string& impl_id, const std::stri
     BOOST_LOG_FUNCTION();
 
     const auto& env = info.Env();
+    auto* ctx = get_ctx(env);
 
     try {
         const auto& handler = info[0].As<Napi::Function>();
@@ -99,28 +128,28 @@ static Napi::Value setup_cmd_handler(const std::string& impl_id, const std::stri
         }
 
         cmd_handlers.insert({cmd_key, Napi::Persistent(handler)});
-        // FIXME (aw): in principle we could also pass this reference down to js_cb
-
-        ctx->everest->provide_cmd(impl_id, cmd_name, [cmd_key](Everest::json input) -> Everest::json {
-            Everest::json result;
 
-            ctx->js_cb->exec(
-                [&input, &cmd_key](Napi::Env& env) {
-                    const auto& arg = convertToNapiValue(env, input);
-                    std::vector<napi_value> args{ctx->cmd_handlers[cmd_key].Value(), ctx->js_module_ref.Value(), arg};
-                    return args;
-                },
-                [&result, &cmd_key](const Napi::CallbackInfo& info, bool err) {
-                    if (err) {
-                        const std::string error_msg =
-                            "Call into " + cmd_key.first + "->" + cmd_key.second + " got rejected";
-                        throw Napi::Error::New(info.Env(), error_msg);
-                    }
-
-                    result = convertToJson(info[0]);
-                });
-
-            return result;
+        // the result is published once the promise of the handler settles, no framework thread waits for it
+        ctx->everest->provide_deferred_cmd(impl_id, cmd_name, [ctx, cmd_key](Everest::json input,
+                                                                             CmdResponder respond) {
+            ctx->js_dispatcher->post([ctx, cmd_key, input = std::move(input), respond = std::move(respond)](
+                                         Napi::Env env, Napi::Function callback_wrapper) {
+                const auto on_fulfill = [ctx, respond](const Napi::CallbackInfo& info) -> Napi::Value {
+                    respond(ctx->payloads->to_json(info[0]));
+                    return info.Env().Undefined();
+                };
+                const auto on_reject = [cmd_key](const Napi::CallbackInfo& info) -> Napi::Value {
+                    // the caller times out, since there is no result to report the failure with
+                    EVLOG_error << "Call into " << cmd_key.first << "->" << cmd_key.second
+                                << " got rejected: " << info[0].ToString().Utf8Value();
+                    return info.Env().Undefined();
+                };
+                auto on = Napi::Object::New(env);
+                on.Set("fulfill", Napi::Function::New(env, on_fulfill));
+                on.Set("reject", Napi::Function::New(env, on_reject));
+                callback_wrapper.Call({on, ctx->cmd_handlers[cmd_key].Value(), ctx->js_module_ref.Value(),
+                                       ctx->payloads->to_napi_value(env, input)});
+            });
         });
     } catch (std::exception& e) {
         EVLOG_AND_RETHROW(env);
@@ -133,9 +162,14 @@ static Napi::Value set_var_subscription_handler(const Requirement& req, const st
                                                 const Napi::CallbackInfo& info) {
     BOOST_LOG_FUNCTION();
     const auto& env = info.Env();
+    auto* ctx = get_ctx(env);
 
     try {
         const auto& handler = info[0].As<Napi::Function>();
+        // an optional second argument only delivers the latest value to handlers that cannot keep up
+        const bool latest_value_only = info.Length() > 1 and info[1].ToBoolean().Value();
+        const auto mode =
+            latest_value_only ? Everest::VarSubscriptionMode::LatestValue : Everest::VarSubscriptionMode::Queued;
 
         auto sub_key = std::make_pair(req, var_name);
         auto& var_subs = ctx->var_subscriptions;
@@ -147,17 +181,49 @@ static Napi::Value set_var_subscription_handler(const Requirement& req, const st
         }
         var_subs.insert({sub_key, Napi::Persistent(handler)});
 
-        // FIXME (aw): in principle we could also pass this reference down to js_cb
-        ctx->everest->subscribe_var(req, var_name, [sub_key](Everest::json input) {
-            ctx->js_cb->exec(
-                [&input, &sub_key](Napi::Env& env) {
-                    const auto& arg = convertToNapiValue(env, input);
-                    std::vector<napi_value> args{ctx->var_subscriptions[sub_key].Value(), ctx->js_module_ref.Value(),
-                                                 arg};
-                    return args;
+        // values arriving while the javascript thread is busy are handed over in one batch
+        if (not latest_value_only) {
+            ctx->everest->subscribe_var(
+                req, var_name,
+                [ctx, sub_key](Everest::json input) {
+                    ctx->js_dispatcher->post([ctx, sub_key, input = std::move(input)](Napi::Env env, Napi::Function) {
+                        ctx->var_subscriptions[sub_key].Call(
+                            {ctx->js_module_ref.Value(), ctx->payloads->to_napi_value(env, input)});
+                    });
                 },
-                nullptr);
-        });
+                mode);
+            return env.Undefined();
+        }
+
+        // the framework thread does not wait for the handler, so values replace each other until the job runs
+        struct LatestValue {
+            std::mutex mutex;
+            std::optional<Everest::json> value;
+        };
+        const auto latest = std::make_shared<LatestValue>();
+        ctx->everest->subscribe_var(
+            req, var_name,
+            [ctx, sub_key, latest](Everest::json input) {
+                {
+                    const std::lock_guard<std::mutex> lock(latest->mutex);
+                    const bool queued = latest->value.has_value();
+                    latest->value = std::move(input);
+                    if (queued) {
+                        return;
+                    }
+                }
+                ctx->js_dispatcher->post([ctx, sub_key, latest](Napi::Env env, Napi::Function) {
+                    Everest::json value;
+                    {
+                        const std::lock_guard<std::mutex> lock(latest->mutex);
+                        value = std::move(latest->value.value());
+                        latest->value.reset();
+                    }
+                    ctx->var_subscriptions[sub_key].Call(
+                        {ctx->js_module_ref.Value(), ctx->payloads->to_napi_value(env, value)});
+                });
+            },
+            mode);
     } catch (std::exception& e) {
         EVLOG_AND_RETHROW(env);
     }
@@ -169,6 +235,7 @@ static Napi::Value signal_ready(const Napi::CallbackInfo& info) {
     BOOST_LOG_FUNCTION();
 
     const auto& env = info.Env();
+    auto* ctx = get_ctx(env);
     Napi::Value retval;
 
     try {
@@ -181,10 +248,10 @@ static Napi::Value signal_ready(const Napi::CallbackInfo& info) {
     return retval;
 }
 
-void framework_ready_handler() {
+static void framework_ready_handler(EvModCtx* ctx) {
     BOOST_LOG_FUNCTION();
     // resolving the promise must be done inside the main js context!
-    auto handle_ready_js = [](const Napi::CallbackInfo& info) -> Napi::Value {
+    auto handle_ready_js = [ctx](const Napi::CallbackInfo& info) -> Napi::Value {
         ctx->framework_ready_flag = true;
         ctx->framework_ready_deferred.Resolve(ctx->js_module_ref.Value());
         return info.Env().Undefined();
@@ -202,6 +269,7 @@ static Napi::Value mqtt_publish(const Napi::CallbackInfo& info) {
     BOOST_LOG_FUNCTION();
 
     const auto& env = info.Env();
+    auto* ctx = get_ctx(env);
     try {
         const auto& topic_alias = info[0].ToString().Utf8Value();
         const auto& data = info[1].ToString().Utf8Value();
@@ -218,6 +286,7 @@ static Napi::Value mqtt_subscribe(const Napi::CallbackInfo& info) {
     BOOST_LOG_FUNCTION();
 
     const auto& env = info.Env();
+    auto* ctx = get_ctx(env);
 
     try {
         const auto& topic_alias = info[0].ToString().Utf8Value();
@@ -232,9 +301,9 @@ static Napi::Value mqtt_subscribe(const Napi::CallbackInfo& info) {
 
         ctx->mqtt_subscriptions.insert({topic_alias, Napi::Persistent(handler)});
 
-        ctx->everest->provide_external_mqtt_handler(topic_alias, [topic_alias](std::string data) {
+        ctx->everest->provide_external_mqtt_handler(topic_alias, [ctx, topic_alias](std::string data) {
             ctx->js_cb->exec(
-                [&topic_alias, &data](Napi::Env& env) {
+                [ctx, &topic_alias, &data](Napi::Env& env) {
                     // in case we're not ready, the mod argument of the subscribe handler will be undefined, so no
                     // module related functions can be used
                     Napi::Value module_ref = (ctx->framework_ready_flag) ? ctx->js_module_ref.Value() : env.Undefined();
@@ -255,6 +324,7 @@ static Napi::Value telemetry_publish(const Napi::CallbackInfo& info) {
     BOOST_LOG_FUNCTION();
 
     const auto& env = info.Env();
+    auto* ctx = get_ctx(env);
     try {
         auto length = info.Length();
         if (length == 3 || length == 4) {
@@ -282,13 +352,14 @@ static Napi::Value call_cmd(const Requirement& req, const std::string& cmd_name,
     BOOST_LOG_FUNCTION();
 
     const auto& env = info.Env();
+    auto* ctx = get_ctx(env);
     Napi::Value cmd_result;
 
     try {
-        const auto& argument = convertToJson(info[0]);
+        const auto& argument = ctx->payloads->to_json(info[0]);
         const auto& retval = ctx->everest->call_cmd(req, cmd_name, argument);
 
-        cmd_result = convertToNapiValue(info.Env(), retval);
+        cmd_result = ctx->payloads->to_napi_value(info.Env(), retval);
     } catch (std::exception& e) {
         EVLOG_AND_RETHROW(env);
     }
@@ -300,6 +371,7 @@ static Napi::Value raise_error(const std::string& impl_id, const Napi::CallbackI
     BOOST_LOG_FUNCTION();
 
     const Napi::Env& env = info.Env();
+    auto* ctx = get_ctx(env);
 
     try {
         ctx->everest->get_error_manager_impl(impl_id)->raise_error(convertToError(info[0]));
@@ -314,6 +386,7 @@ static Napi::Value clear_error(const std::string& impl_id, const Napi::CallbackI
     BOOST_LOG_FUNCTION();
 
     const Napi::Env& env = info.Env();
+    auto* ctx = get_ctx(env);
     try {
         const int info_length = info.Length();
         if (info_length == 1) {
@@ -340,6 +413,7 @@ static Napi::Value clear_all_errors_of_impl(const std::string& impl_id, const Na
     BOOST_LOG_FUNCTION();
 
     const Napi::Env& env = info.Env();
+    auto* ctx = get_ctx(env);
 
     try {
         ctx->everest->get_error_manager_impl(impl_id)->clear_all_errors();
@@ -354,6 +428,7 @@ static Napi::Value is_error_active_impl(const std::string& impl_id, const Napi::
     BOOST_LOG_FUNCTION();
 
     const Napi::Env& env = info.Env();
+    auto* ctx = get_ctx(env);
 
     bool result = false;
 
@@ -371,6 +446,7 @@ static Napi::Value is_condition_satisfied_impl(const std::string& impl_id, const
     BOOST_LOG_FUNCTION();
 
     const Napi::Env& env = info.Env();
+    auto* ctx = get_ctx(env);
 
     bool result = false;
 
@@ -393,6 +469,7 @@ static Napi::Value create_error(const std::string& impl_id, const Napi::Callback
     BOOST_LOG_FUNCTION();
 
     const Napi::Env& env = info.Env();
+    auto* ctx = get_ctx(env);
 
     try {
         if (info.Length() == 0) {
@@ -422,6 +499,7 @@ static Napi::Value subscribe_error(const Requirement& req, const Napi::CallbackI
     BOOST_LOG_FUNCTION();
 
     const Napi::Env& env = info.Env();
+    auto* ctx = get_ctx(env);
 
     try {
         std::string type = info[0].ToString().Utf8Value();
@@ -442,9 +520,9 @@ static Napi::Value subscribe_error(const Requirement& req, const Napi::CallbackI
 
         ctx->everest->get_error_manager_req(req)->subscribe_error(
             type,
-            [sub_key](const Everest::error::Error& error) {
+            [ctx, sub_key](const Everest::error::Error& error) {
                 ctx->js_cb->exec(
-                    [&error, &sub_key](Napi::Env& env) {
+                    [ctx, &error, &sub_key](Napi::Env& env) {
                         const auto& arg = convertToNapiValue(env, error);
                         std::vector<napi_value> args{ctx->error_subscriptions[sub_key].callback.Value(),
                                                      ctx->js_module_ref.Value(), arg};
@@ -452,9 +530,9 @@ static Napi::Value subscribe_error(const Requirement& req, const Napi::CallbackI
                     },
                     nullptr);
             },
-            [sub_key](const Everest::error::Error& error) {
+            [ctx, sub_key](const Everest::error::Error& error) {
                 ctx->js_cb->exec(
-                    [&error, &sub_key](Napi::Env& env) {
+                    [ctx, &error, &sub_key](Napi::Env& env) {
                         const auto& arg = convertToNapiValue(env, error);
                         std::vector<napi_value> args{ctx->error_subscriptions[sub_key].clear_callback.Value(),
                                                      ctx->js_module_ref.Value(), arg};
@@ -473,6 +551,7 @@ static Napi::Value subscribe_all_errors(const Requirement& req, const Napi::Call
     BOOST_LOG_FUNCTION();
 
     const Napi::Env& env = info.Env();
+    auto* ctx = get_ctx(env);
 
     try {
         auto& error_subs = ctx->error_subscriptions;
@@ -487,9 +566,9 @@ static Napi::Value subscribe_all_errors(const Requirement& req, const Napi::Call
         ctx->cb_pair_subscribe_all.clear_callback = Napi::Persistent(info[1].As<Napi::Function>());
 
         ctx->everest->get_error_manager_req(req)->subscribe_all_errors(
-            [](Everest::error::Error error) {
+            [ctx](Everest::error::Error error) {
                 ctx->js_cb->exec(
-                    [&error](Napi::Env& env) {
+                    [ctx, &error](Napi::Env& env) {
                         const auto& arg = convertToNapiValue(env, error);
                         std::vector<napi_value> args{ctx->cb_pair_subscribe_all.callback.Value(),
                                                      ctx->js_module_ref.Value(), arg};
@@ -497,9 +576,9 @@ static Napi::Value subscribe_all_errors(const Requirement& req, const Napi::Call
                     },
                     nullptr);
             },
-            [](Everest::error::Error error) {
+            [ctx](Everest::error::Error error) {
                 ctx->js_cb->exec(
-                    [&error](Napi::Env& env) {
+                    [ctx, &error](Napi::Env& env) {
                         const auto& arg = convertToNapiValue(env, error);
                         std::vector<napi_value> args{ctx->cb_pair_subscribe_all.clear_callback.Value(),
                                                      ctx->js_module_ref.Value(), arg};
@@ -518,6 +597,7 @@ static Napi::Value is_error_active_req(const Requirement& req, const Napi::Callb
     BOOST_LOG_FUNCTION();
 
     const Napi::Env& env = info.Env();
+    auto* ctx = get_ctx(env);
 
     bool result = false;
 
@@ -535,6 +615,7 @@ static Napi::Value is_condition_satisfied_req(const Requirement& req, const Napi
     BOOST_LOG_FUNCTION();
 
     const Napi::Env& env = info.Env();
+    auto* ctx = get_ctx(env);
 
     bool result = false;
 
@@ -576,12 +657,18 @@ static Napi::Value boot_module(const Napi::CallbackInfo& info) {
         const auto& mqtt_server_address = settings.Get("mqtt_server_address").ToString().Utf8Value();
         const auto& mqtt_server_port = settings.Get("mqtt_server_port").ToString().Utf8Value();
         const bool validate_schema = settings.Get("validate_schema").ToBoolean().Value();
+        // modules hosted in worker threads of a single node process share its MQTT connection and logging
+        const bool hosted = settings.Get("hosted").ToBoolean().Value();
+        const auto json_parse_threshold = settings.Get("json_parse_threshold").ToNumber().Int64Value();
 
         namespace fs = std::filesystem;
         fs::path logging_config_file =
             Everest::assert_file(settings.Get("logging_config_file").ToString().Utf8Value(), "Default logging config");
         // initialize logging as early as possible
-        Everest::Logging::init(logging_config_file.string(), module_id);
+        static std::once_flag logging_initialized;
+        std::call_once(logging_initialized, [&logging_config_file, &module_id, hosted]() {
+            Everest::Logging::init(logging_config_file.string(), hosted ? "javascript_host" : module_id);
+        });
         std::shared_ptr<Everest::MQTTAbstraction> mqtt;
         Everest::MQTTSettings mqtt_settings{};
         if (mqtt_broker_socket_path.empty()) {
@@ -598,16 +685,21 @@ static Napi::Value boot_module(const Napi::CallbackInfo& info) {
             Everest::populate_mqtt_settings(mqtt_settings, mqtt_broker_socket_path, mqtt_everest_prefix,
                                             mqtt_external_prefix);
         }
+        Everest::populate_mqtt_module_settings_from_env(mqtt_settings);
 
-        mqtt = std::make_shared<Everest::MQTTAbstraction>(mqtt_settings);
-        mqtt->connect();
-        mqtt->spawn_main_loop_thread();
+        if (hosted) {
+            mqtt = get_shared_mqtt(mqtt_settings);
+        } else {
+            mqtt = std::make_shared<Everest::MQTTAbstraction>(mqtt_settings);
+            mqtt->connect();
+            mqtt->spawn_main_loop_thread();
+        }
 
         const auto result = Everest::get_module_config(mqtt, module_id);
 
         auto rs = std::make_unique<Everest::RuntimeSettings>(result.at("settings"));
 
-        auto config = std::make_unique<Everest::Config>(mqtt_settings, result);
+        auto config = std::make_shared<const Everest::Config>(mqtt_settings, result);
 
         if (!config->contains(module_id)) {
             EVTHROW(EVEXCEPTION(Everest::EverestConfigError,
@@ -622,12 +714,14 @@ static Napi::Value boot_module(const Napi::CallbackInfo& info) {
         // initialize everest framework
         const auto& module_identifier = config->printable_identifier(module_id);
         EVLOG_debug << "Initializing framework for module " << module_identifier << "...";
-        EVLOG_debug << "Trying to set process name to: '" << module_identifier << "'...";
-        if (prctl(PR_SET_NAME, module_identifier.c_str())) {
-            EVLOG_warning << "Could not set process name to '" << module_identifier << "'";
-        }
+        if (not hosted) {
+            EVLOG_debug << "Trying to set process name to: '" << module_identifier << "'...";
+            if (prctl(PR_SET_NAME, module_identifier.c_str())) {
+                EVLOG_warning << "Could not set process name to '" << module_identifier << "'";
+            }
 
-        Everest::Logging::update_process_name(module_identifier);
+            Everest::Logging::update_process_name(module_identifier);
+        }
 
         //
         // fill in everything we know about the module
@@ -935,10 +1029,11 @@ static Napi::Value boot_module(const Napi::CallbackInfo& info) {
         module_this.DefineProperty(Napi::PropertyDescriptor::Value("info", module_info_prop, napi_enumerable));
 
         // connect to mqtt server and start mqtt mainloop thread
-        auto everest_handle = std::make_unique<Everest::Everest>(module_id, *config, validate_schema, mqtt,
+        auto everest_handle = std::make_unique<Everest::Everest>(module_id, config, validate_schema, mqtt,
                                                                  rs->telemetry_prefix, rs->telemetry_enabled);
 
-        ctx = new EvModCtx(std::move(everest_handle), module_manifest, env);
+        auto* ctx = new EvModCtx(std::move(everest_handle), module_manifest, env);
+        env.SetInstanceData<EvModCtx, keep_ctx>(ctx);
 
         // FIXME (aw): passing the handle away and then still accessing it is bad design
         //             all of this should be solved, if we would have a module instance on the js side
@@ -946,7 +1041,10 @@ static Napi::Value boot_module(const Napi::CallbackInfo& info) {
 
         ctx->js_module_ref = Napi::Persistent(module_this);
         ctx->js_cb = std::make_unique<JsExecCtx>(env, callback_wrapper);
-        ctx->everest->register_on_ready_handler(framework_ready_handler);
+        ctx->js_dispatcher = std::make_unique<JsDispatcher>(env, callback_wrapper);
+        ctx->payloads = std::make_unique<PayloadConverter>(
+            env, json_parse_threshold > 0 ? static_cast<std::size_t>(json_parse_threshold) : 0);
+        ctx->everest->register_on_ready_handler([ctx]() { framework_ready_handler(ctx); });
 
         const auto end_time = std::chrono::system_clock::now();
         EVLOG_info << "Module " << fmt::format(Everest::TERMINAL_STYLE_BLUE, "{}", module_id) << " initialized ["
@@ -961,6 +1059,41 @@ static Napi::Value boot_module(const Napi::CallbackInfo& info) {
     return available_handlers_prop;
 }
 
+///
+/// \brief Measures both conversions of the payload given as first argument, repeated as often as the second argument
+/// \returns the average nanoseconds per conversion of the recursive and the JSON based paths in both directions
+///
+static Napi::Value benchmark_conversions(const Napi::CallbackInfo& info) {
+    BOOST_LOG_FUNCTION();
+
+    const auto& env = info.Env();
+    Napi::Object result = Napi::Object::New(env);
+    try {
+        const auto iterations = std::max<std::int64_t>(info[1].ToNumber().Int64Value(), 1);
+        const PayloadConverter converter(env, 1);
+        const auto payload = convertToJson(info[0]);
+
+        const auto measure = [iterations](const auto& convert) {
+            const auto start = std::chrono::steady_clock::now();
+            for (std::int64_t i = 0; i < iterations; ++i) {
+                convert();
+            }
+            const auto duration = std::chrono::steady_clock::now() - start;
+            return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()) /
+                   static_cast<double>(iterations);
+        };
+
+        result.Set("values", static_cast<double>(count_json_values(payload, std::numeric_limits<std::size_t>::max())));
+        result.Set("to_js_recursive_ns", measure([&]() { convertToNapiValue(env, payload); }));
+        result.Set("to_js_json_parse_ns", measure([&]() { converter.to_napi_value(env, payload); }));
+        result.Set("to_json_recursive_ns", measure([&]() { convertToJson(info[0]); }));
+        result.Set("to_json_stringify_ns", measure([&]() { converter.to_json(info[0]); }));
+    } catch (std::exception& e) {
+        EVLOG_AND_RETHROW(env);
+    }
+    return result;
+}
+
 const std::string extract_logstring(const Napi::CallbackInfo& info) {
     // TODO (aw): check input
     return info[0].ToString().Utf8Value();
@@ -1006,6 +1139,9 @@ static Napi::Object Init(Napi::Env env, Napi::Object exports) {
     exports.DefineProperty(
         Napi::PropertyDescriptor::Value("boot_module", Napi::Function::New(env, boot_module), napi_enumerable));
 
+    exports.DefineProperty(Napi::PropertyDescriptor::Value(
+        "benchmark_conversions", Napi::Function::New(env, benchmark_conversions), napi_enumerable));
+
     return exports;
 }
 
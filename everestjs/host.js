@@ -0,0 +1,26 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+// Runs several javascript modules in worker threads of a single node process. The manager passes the modules as a
+// json list of {module, path} in EV_JS_HOST_MODULES. Each worker gets its own Everest instance, while the MQTT
+// connection and logging are shared by all of them.
+const { Worker } = require('worker_threads');
+
+const modules = JSON.parse(process.env.EV_JS_HOST_MODULES);
+
+modules.forEach(({ module, path }) => {
+  const worker = new Worker(path, {
+    argv: process.argv.slice(2),
+    env: { ...process.env, EV_MODULE: module, EV_JS_HOSTED: '1' },
+  });
+
+  // the manager only watches the host process, so a failing module takes down the whole host
+  worker.on('error', (error) => {
+    console.error(`Module ${module} failed:`, error);
+    process.exit(1);
+  });
+  worker.on('exit', (code) => {
+    console.error(`Module ${module} exited with code ${code}`);
+    process.exit(code);
+  });
+});
@@ -35,6 +35,8 @@ const EverestModule = function EverestModule(handler_setup, user_settings) {
     mqtt_server_address: process.env.EV_MQTT_BROKER_HOST,
     mqtt_server_port: process.env.EV_MQTT_BROKER_PORT,
     validate_schema: process.env.EV_VALIDATE_SCHEMA,
+    hosted: process.env.EV_JS_HOSTED,
+    json_parse_threshold: process.env.EV_JS_JSON_PARSE_THRESHOLD,
   };
 
   const settings = { ...env_settings, ...user_settings };
@@ -53,6 +55,9 @@ const EverestModule = function EverestModule(handler_setup, user_settings) {
     mqtt_server_address: helpers.get_default(settings, 'mqtt_server_address', ''),
     mqtt_server_port: helpers.get_default(settings, 'mqtt_server_port', 0),
     validate_schema: helpers.get_default(settings, 'validate_schema', false),
+    hosted: helpers.get_default(settings, 'hosted', false),
+    // payloads with at least this many values are converted with JSON.parse/JSON.stringify, 0 disables it
+    json_parse_threshold: Number(helpers.get_default(settings, 'json_parse_threshold', 64)),
   };
 
   function callbackWrapper(on, request, ...args) {
@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include "js_dispatcher.hpp"
+
+#include <everest/logging.hpp>
+
+JsDispatcher::JsDispatcher(const Napi::Env& env, const Napi::Function& callback_wrapper, const std::string& res_name) :
+    tsfn(TsfnType::New(env, callback_wrapper, res_name, 0, 1, this)) {
+}
+
+JsDispatcher::~JsDispatcher() {
+    tsfn.Release();
+}
+
+void JsDispatcher::post(Job job) {
+    bool first = false;
+    {
+        const std::lock_guard<std::mutex> lock(this->jobs_mutex);
+        first = this->jobs.empty();
+        this->jobs.push_back(std::move(job));
+    }
+    // the javascript thread takes everything queued until it runs, so only the first job of a batch has to wake it
+    if (first) {
+        tsfn.NonBlockingCall();
+    }
+}
+
+void JsDispatcher::run_jobs(Napi::Env env, Napi::Function callback_wrapper, JsDispatcher* this_, std::nullptr_t*) {
+    if (env == nullptr) {
+        // the thread safe function is finalized
+        return;
+    }
+
+    std::vector<Job> batch;
+    {
+        const std::lock_guard<std::mutex> lock(this_->jobs_mutex);
+        std::swap(batch, this_->jobs);
+    }
+
+    for (auto& job : batch) {
+        // a failing handler must not drop the rest of the batch
+        try {
+            job(env, callback_wrapper);
+        } catch (const Napi::Error& e) {
+            EVLOG_error << "Javascript handler failed: " << e.Message();
+        } catch (const std::exception& e) {
+            EVLOG_error << "Could not call javascript handler: " << e.what();
+        }
+    }
+}
@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef JS_DISPATCHER_HPP
+#define JS_DISPATCHER_HPP
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <napi.h>
+
+///
+/// \brief Runs jobs of the framework threads on the javascript thread without waiting for them
+/// \details Jobs are queued under a mutex and the thread safe function is only called for the first job of a batch.
+///          The javascript thread then runs all jobs queued until it got to them in a single invocation, so busy
+///          var subscriptions cost one thread safe function call per event loop tick instead of one per message
+///
+class JsDispatcher {
+public:
+    /// \brief A job, called with the callback wrapper of index.js that settles the promises of handlers
+    using Job = std::function<void(Napi::Env env, Napi::Function callback_wrapper)>;
+
+    JsDispatcher(const Napi::Env& env, const Napi::Function& callback_wrapper,
+                 const std::string& res_name = "Dispatcher");
+    ~JsDispatcher();
+
+    JsDispatcher(const JsDispatcher&) = delete;
+    JsDispatcher& operator=(const JsDispatcher&) = delete;
+
+    /// \brief queues the \p job to run on the javascript thread, can be called from any thread
+    void post(Job job);
+
+private:
+    static void run_jobs(Napi::Env env, Napi::Function callback_wrapper, JsDispatcher* this_, std::nullptr_t*);
+
+    using TsfnType = Napi::TypedThreadSafeFunction<JsDispatcher, std::nullptr_t, JsDispatcher::run_jobs>;
+
+    TsfnType tsfn;
+    std::mutex jobs_mutex;
+    std::vector<Job> jobs;
+};
+
+#endif // JS_DISPATCHER_HPP
@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include "delivery_queue.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+DeliveryQueue::DeliveryQueue() : fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+    if (this->fd == -1) {
+        throw std::runtime_error(fmt::format("Could not create the eventfd of the delivery queue: {}",
+                                             std::strerror(errno)));
+    }
+}
+
+DeliveryQueue::~DeliveryQueue() {
+    close(this->fd);
+}
+
+void DeliveryQueue::push(Delivery delivery) {
+    bool first = false;
+    {
+        const std::lock_guard<std::mutex> lock(this->pending_mutex);
+        first = this->pending.empty();
+        this->pending.push_back(std::move(delivery));
+    }
+    // the event loop takes everything that arrives until it wakes up, so only the first delivery has to wake it
+    if (first) {
+        const std::uint64_t one = 1;
+        [[maybe_unused]] const auto written = write(this->fd, &one, sizeof(one));
+    }
+}
+
+void DeliveryQueue::take_all(std::vector<Delivery>& batch) {
+    // reset before taking, a delivery pushed in between only causes a wakeup finding an empty queue
+    std::uint64_t count = 0;
+    [[maybe_unused]] const auto read_size = read(this->fd, &count, sizeof(count));
+    batch.clear();
+    const std::lock_guard<std::mutex> lock(this->pending_mutex);
+    std::swap(batch, this->pending);
+}
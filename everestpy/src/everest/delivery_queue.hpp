@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef EVERESTPY_DELIVERY_QUEUE_HPP
+#define EVERESTPY_DELIVERY_QUEUE_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <utils/types.hpp>
+
+///
+/// \brief A var value or cmd result waiting to be handed to python
+///
+struct Delivery {
+    bool is_cmd_result{false};
+    std::uint64_t id{0}; ///< index of the var callback or id of the cmd call
+    json value;
+    std::string payload; ///< the serialized value instead, for subscriptions with PayloadFormat::JsonBytes
+    std::string error;   ///< why the cmd call failed, empty if it succeeded
+};
+
+///
+/// \brief Collects the deliveries of the handler threads for an asyncio event loop
+/// \details The handler threads only take a mutex to push a delivery, so they never wait for the GIL. The event loop
+///          watches the eventfd of the queue, which is only signalled when the first delivery of a batch arrives, and
+///          takes all pending deliveries at once to run their callbacks under a single acquisition of the GIL
+///
+class DeliveryQueue {
+public:
+    DeliveryQueue();
+    ~DeliveryQueue();
+
+    DeliveryQueue(const DeliveryQueue&) = delete;
+    DeliveryQueue& operator=(const DeliveryQueue&) = delete;
+
+    /// \returns the eventfd that becomes readable when deliveries are pending
+    int get_fd() const {
+        return this->fd;
+    }
+
+    void push(Delivery delivery);
+
+    /// \brief resets the eventfd and swaps all pending deliveries into \p batch, which is cleared before
+    void take_all(std::vector<Delivery>& batch);
+
+private:
+    int fd;
+    std::mutex pending_mutex;
+    std::vector<Delivery> pending;
+};
+
+#endif // EVERESTPY_DELIVERY_QUEUE_HPP
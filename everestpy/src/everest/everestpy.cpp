@@ -27,6 +27,9 @@ PYBIND11_MODULE(everestpy, m) {
         .def(py::init<>())
         .def(py::init<const std::string&, const std::string&>());
 
+    m.def("set_hosted_module_id", &set_hosted_module_id,
+          "Sets the id of the module run by the calling thread of a python host");
+
     py::class_<ModuleInfo::Paths>(m, "ModuleInfoPaths")
         .def_readonly("etc", &ModuleInfo::Paths::etc)
         .def_readonly("libexec", &ModuleInfo::Paths::libexec)
@@ -125,6 +128,11 @@ PYBIND11_MODULE(everestpy, m) {
         .def_readonly("configs", &ModuleSetup::configs)
         .def_readonly("connections", &ModuleSetup::connections);
 
+    py::enum_<PayloadFormat>(m, "PayloadFormat")
+        .value("Objects", PayloadFormat::Objects)
+        .value("JsonBytes", PayloadFormat::JsonBytes)
+        .export_values();
+
     py::class_<Module>(m, "Module")
         .def(py::init<const RuntimeSession&>())
         .def(py::init<const std::string&, const RuntimeSession&>())
@@ -133,8 +141,17 @@ PYBIND11_MODULE(everestpy, m) {
         .def("init_done", py::overload_cast<const std::function<void()>&>(&Module::init_done))
         .def("call_command", &Module::call_command)
         .def("publish_variable", &Module::publish_variable)
+        .def("publish_variable_json", &Module::publish_variable_json)
         .def("implement_command", &Module::implement_command)
-        .def("subscribe_variable", &Module::subscribe_variable)
+        .def("subscribe_variable", &Module::subscribe_variable, py::arg("fulfillment"), py::arg("var_name"),
+             py::arg("callback"), py::arg("latest_value_only") = false,
+             py::arg("payload_format") = PayloadFormat::Objects)
+        .def("call_command_async", &Module::call_command_async)
+        .def("subscribe_variable_async", &Module::subscribe_variable_async, py::arg("fulfillment"),
+             py::arg("var_name"), py::arg("callback"), py::arg("latest_value_only") = false,
+             py::arg("payload_format") = PayloadFormat::Objects)
+        .def_property_readonly("delivery_fd", &Module::get_delivery_fd)
+        .def("drain_deliveries", &Module::drain_deliveries)
         .def("raise_error", &Module::raise_error)
         .def("clear_error",
              py::overload_cast<const std::string&, const Everest::error::ErrorType&, const bool>(&Module::clear_error),
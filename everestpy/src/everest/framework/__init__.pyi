@@ -1,5 +1,5 @@
 from pathlib import Path
-from typing import Callable, overload
+from typing import Any, Callable, Optional, overload
 from . import error
 
 class ModuleInfoPaths:
@@ -62,6 +62,9 @@ class Fulfillment:
     def implementation_id(self) -> str: ...
 
 
+def set_hosted_module_id(module_id: str) -> None: ...
+
+
 class RuntimeSession:
     @overload
     def __init__(self) -> None: ...
@@ -70,6 +73,11 @@ class RuntimeSession:
     def __init__(self, prefix: str, config_file_path: str) -> None: ...
 
 
+class PayloadFormat:
+    Objects: PayloadFormat
+    JsonBytes: PayloadFormat
+
+
 class Module:
     @overload
     def __init__(self, session: RuntimeSession) -> None: ...
@@ -91,10 +99,26 @@ class Module:
     def publish_variable(self, implementation_id: str,
                          variable_name: str, value: dict) -> None: ...
 
+    def publish_variable_json(self, implementation_id: str,
+                              variable_name: str, payload: bytes | str) -> None: ...
+
     def implement_command(self, implementation_id: str, command_name: str,
                           handler: Callable[[dict], dict]) -> None: ...
     def subscribe_variable(self, fulfillment: Fulfillment,
-                           variable_name: str, callback: Callable[[dict], None]) -> None: ...
+                           variable_name: str, callback: Callable[[Any], None],
+                           latest_value_only: bool = False,
+                           payload_format: PayloadFormat = PayloadFormat.Objects) -> None: ...
+    def call_command_async(self, fulfillment: Fulfillment, command_name: str, args: dict,
+                           on_done: Callable[[Any, Optional[str]], None]) -> None: ...
+    def subscribe_variable_async(self, fulfillment: Fulfillment,
+                                 variable_name: str, callback: Callable[[Any], None],
+                                 latest_value_only: bool = False,
+                                 payload_format: PayloadFormat = PayloadFormat.Objects) -> None: ...
+
+    @property
+    def delivery_fd(self) -> int: ...
+
+    def drain_deliveries(self) -> None: ...
     def raise_error(self, implementation_id: str, error: error.Error) -> None: ...
     def clear_error(self, implementation_id: str, type: str, clear_all: bool) -> None: ...
     def clear_error(self, implementation_id: str, type: str, sub_type: str) -> None: ...
@@ -0,0 +1,65 @@
+# SPDX-License-Identifier: Apache-2.0
+# Copyright Pionix GmbH and Contributors to EVerest
+"""asyncio integration of everestpy modules.
+
+The handler threads of the framework queue var values and cmd results without taking the GIL. The event loop is woken
+by the eventfd of the queue and runs the callbacks of everything that arrived in the meantime as one batch, so a busy
+module acquires the GIL once per batch instead of once per message:
+
+    async def main():
+        module = AsyncModule(Module(RuntimeSession()))
+        module.subscribe_variable(fulfillment, 'limits', on_limits)
+        result = await module.call_command(fulfillment, 'get_status', {})
+"""
+
+import asyncio
+import inspect
+from typing import Any, Callable, Optional
+
+try:
+    from .everestpy import Fulfillment, Module, PayloadFormat
+except ImportError:
+    from everestpy import Fulfillment, Module, PayloadFormat
+
+
+class AsyncModule:
+    """Wraps a Module for an asyncio event loop, all other methods are forwarded to the module."""
+
+    def __init__(self, module: Module, loop: Optional[asyncio.AbstractEventLoop] = None):
+        self._module = module
+        self._loop = loop if loop is not None else asyncio.get_running_loop()
+        self._loop.add_reader(module.delivery_fd, module.drain_deliveries)
+
+    async def call_command(self, fulfillment: Fulfillment, command_name: str, args: dict) -> Any:
+        """Calls a command without blocking the event loop, raises a RuntimeError if the call failed."""
+        future = self._loop.create_future()
+
+        def on_done(result: Any, error: Optional[str]):
+            if future.done():
+                return
+            if error is None:
+                future.set_result(result)
+            else:
+                future.set_exception(RuntimeError(error))
+
+        self._module.call_command_async(fulfillment, command_name, args, on_done)
+        return await future
+
+    def subscribe_variable(self, fulfillment: Fulfillment, variable_name: str, callback: Callable[[Any], Any],
+                           latest_value_only: bool = False,
+                           payload_format: PayloadFormat = PayloadFormat.Objects) -> None:
+        """Subscribes to a variable, the callback runs on the event loop and can be a coroutine function."""
+        if inspect.iscoroutinefunction(callback):
+            coroutine_function = callback
+
+            def callback(value):
+                self._loop.create_task(coroutine_function(value))
+
+        self._module.subscribe_variable_async(fulfillment, variable_name, callback, latest_value_only, payload_format)
+
+    def close(self) -> None:
+        """Stops handing out deliveries, pending cmd calls are never completed."""
+        self._loop.remove_reader(self._module.delivery_fd)
+
+    def __getattr__(self, name: str):
+        return getattr(self._module, name)
@@ -0,0 +1,53 @@
+# SPDX-License-Identifier: Apache-2.0
+# Copyright Pionix GmbH and Contributors to EVerest
+"""Runs several python modules in threads of a single interpreter.
+
+Started by the manager with the python_host setting. EV_PY_HOST_MODULES contains the id and the path of the module.py
+of every module to run. All modules share the MQTT connection and the logging of this process. If any of them fails,
+the whole process exits, so the manager notices it like the failure of a single module.
+"""
+
+import json
+import os
+import runpy
+import sys
+import threading
+import traceback
+
+import everest.framework
+
+
+def run_module(module_id: str, path: str):
+    everest.framework.set_hosted_module_id(module_id)
+    try:
+        runpy.run_path(path, run_name='__main__')
+    except SystemExit as e:
+        if e.code not in (None, 0):
+            print(f'Hosted module {module_id} exited with {e.code}', file=sys.stderr, flush=True)
+            os._exit(e.code if isinstance(e.code, int) else 1)
+    except BaseException:
+        print(f'Hosted module {module_id} failed:', file=sys.stderr)
+        traceback.print_exc()
+        sys.stderr.flush()
+        os._exit(1)
+
+
+def main():
+    modules = json.loads(os.environ['EV_PY_HOST_MODULES'])
+    # module.py files import their neighbours as if they were the main script
+    for module in modules:
+        sys.path.insert(0, os.path.dirname(module['path']))
+
+    threads = []
+    for module in modules:
+        thread = threading.Thread(target=run_module, args=(module['module'], module['path']), name=module['module'],
+                                  daemon=True)
+        thread.start()
+        threads.append(thread)
+
+    for thread in threads:
+        thread.join()
+
+
+if __name__ == '__main__':
+    main()
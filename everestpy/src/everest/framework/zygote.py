@@ -0,0 +1,75 @@
+# SPDX-License-Identifier: Apache-2.0
+# Copyright Pionix GmbH and Contributors to EVerest
+"""Forks python modules from an interpreter that already imported everestpy.
+
+Started by the manager with the python_zygote setting. The manager sends one request per module on the socket
+passed in EV_PYTHON_ZYGOTE_FD, containing the module id, the path of its module.py and its environment. The module is
+forked twice, so it is adopted by the manager once the intermediate process exited, and its pid is then reported back
+on the same socket.
+"""
+
+import ctypes
+import json
+import os
+import runpy
+import signal
+import socket
+import sys
+import time
+
+# importing the bindings is the expensive part of starting a python module, all forked modules share it
+import everest.framework  # noqa: F401
+
+MAX_REQUEST_SIZE = 1024 * 1024
+PR_SET_PDEATHSIG = 1
+
+
+def run_module(request: dict, manager_pid: int, intermediate_pid: int):
+    # wait until the manager adopted this process, before asking to be terminated together with it
+    while os.getppid() == intermediate_pid:
+        time.sleep(0.001)
+    ctypes.CDLL(None, use_errno=True).prctl(PR_SET_PDEATHSIG, signal.SIGTERM)
+    if os.getppid() != manager_pid:
+        os._exit(1)
+
+    os.environ.clear()
+    os.environ.update(request['env'])
+    path = request['path']
+    sys.argv = [path]
+    sys.path.insert(0, os.path.dirname(path))
+    runpy.run_path(path, run_name='__main__')
+    sys.exit(0)
+
+
+def main():
+    zygote_socket = socket.socket(fileno=int(os.environ.pop('EV_PYTHON_ZYGOTE_FD')))
+    manager_pid = os.getppid()
+
+    while True:
+        request = zygote_socket.recv(MAX_REQUEST_SIZE)
+        if not request:
+            # the manager closed its end of the socket
+            return
+        request = json.loads(request)
+
+        pid_read, pid_write = os.pipe()
+        intermediate_pid = os.fork()
+        if intermediate_pid == 0:
+            os.close(pid_read)
+            module_pid = os.fork()
+            if module_pid == 0:
+                os.close(pid_write)
+                zygote_socket.close()
+                run_module(request, manager_pid, os.getppid())
+            os.write(pid_write, str(module_pid).encode())
+            os._exit(0)
+
+        os.close(pid_write)
+        with os.fdopen(pid_read) as pid_pipe:
+            module_pid = int(pid_pipe.read())
+        # the module is only reported once it has been adopted by the manager
+        os.waitpid(intermediate_pid, 0)
+        zygote_socket.send(json.dumps({'module': request['module'], 'pid': module_pid}).encode())
+
+if __name__ == '__main__':
+    main()
@@ -4,6 +4,8 @@
 
 #include <cstddef>
 #include <cstdlib>
+#include <mutex>
+#include <optional>
 #include <stdexcept>
 
 #include <utils/filesystem.hpp>
@@ -26,6 +28,35 @@ const std::string get_variable_from_env(const std::string& variable, const std::
     return value;
 }
 
+static thread_local std::optional<std::string> hosted_module_id;
+
+void set_hosted_module_id(const std::string& module_id) {
+    hosted_module_id = module_id;
+}
+
+const std::string get_module_id() {
+    if (hosted_module_id.has_value()) {
+        return hosted_module_id.value();
+    }
+    return get_variable_from_env("EV_MODULE");
+}
+
+bool is_hosted() {
+    return std::getenv(Everest::EV_PY_HOST_MODULES) != nullptr;
+}
+
+std::shared_ptr<Everest::MQTTAbstraction> get_shared_mqtt_abstraction(const Everest::MQTTSettings& mqtt_settings) {
+    static std::mutex mqtt_mutex;
+    static std::shared_ptr<Everest::MQTTAbstraction> mqtt_abstraction;
+    const std::lock_guard<std::mutex> lock(mqtt_mutex);
+    if (mqtt_abstraction == nullptr) {
+        mqtt_abstraction = std::make_shared<Everest::MQTTAbstraction>(mqtt_settings);
+        mqtt_abstraction->connect();
+        mqtt_abstraction->spawn_main_loop_thread();
+    }
+    return mqtt_abstraction;
+}
+
 static Everest::MQTTSettings get_mqtt_settings_from_env() {
     const auto mqtt_everest_prefix =
         get_variable_from_env(Everest::EV_MQTT_EVEREST_PREFIX, Everest::defaults::MQTT_EVEREST_PREFIX);
@@ -46,10 +77,15 @@ static Everest::MQTTSettings get_mqtt_settings_from_env() {
         } catch (...) {
             EVLOG_warning << "Could not parse MQTT broker port, using default: " << mqtt_broker_port_;
         }
-        return Everest::create_mqtt_settings(mqtt_broker_host, mqtt_broker_port_, mqtt_everest_prefix,
-                                             mqtt_external_prefix);
+        auto mqtt_settings = Everest::create_mqtt_settings(mqtt_broker_host, mqtt_broker_port_, mqtt_everest_prefix,
+                                                           mqtt_external_prefix);
+        Everest::populate_mqtt_module_settings_from_env(mqtt_settings);
+        return mqtt_settings;
     } else {
-        return Everest::create_mqtt_settings(mqtt_broker_socket_path, mqtt_everest_prefix, mqtt_external_prefix);
+        auto mqtt_settings =
+            Everest::create_mqtt_settings(mqtt_broker_socket_path, mqtt_everest_prefix, mqtt_external_prefix);
+        Everest::populate_mqtt_module_settings_from_env(mqtt_settings);
+        return mqtt_settings;
     }
 }
 
@@ -69,12 +105,15 @@ RuntimeSession::RuntimeSession(const std::string& prefix, const std::string& con
 }
 
 RuntimeSession::RuntimeSession() {
-    const auto module_id = get_variable_from_env("EV_MODULE");
+    // all modules of a python host share the logging of the process
+    const auto module_id = is_hosted() ? std::string("python_host") : get_module_id();
 
     namespace fs = std::filesystem;
     const fs::path logging_config_file =
         Everest::assert_file(get_variable_from_env("EV_LOG_CONF_FILE"), "Default logging config");
-    Everest::Logging::init(logging_config_file.string(), module_id);
+    static std::once_flag logging_initialized;
+    std::call_once(logging_initialized,
+                   [&]() { Everest::Logging::init(logging_config_file.string(), module_id); });
 
     this->mqtt_settings = get_mqtt_settings_from_env();
 }
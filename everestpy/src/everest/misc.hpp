@@ -3,15 +3,29 @@
 #ifndef EVERESTPY_MISC_HPP
 #define EVERESTPY_MISC_HPP
 
+#include <memory>
 #include <string>
 
 #include <framework/runtime.hpp>
+#include <utils/mqtt_abstraction.hpp>
 #include <utils/mqtt_settings.hpp>
 #include <utils/types.hpp>
 
 const std::string get_variable_from_env(const std::string& variable);
 const std::string get_variable_from_env(const std::string& variable, const std::string& default_value);
 
+/// \brief Sets the id of the module run by the calling thread of a python host
+void set_hosted_module_id(const std::string& module_id);
+
+/// \returns the id of the module run by the calling thread, which is EV_MODULE unless this is a python host
+const std::string get_module_id();
+
+/// \returns true if this process is a python host running several modules
+bool is_hosted();
+
+/// \returns the MQTT connection shared by all modules of a python host
+std::shared_ptr<Everest::MQTTAbstraction> get_shared_mqtt_abstraction(const Everest::MQTTSettings& mqtt_settings);
+
 class RuntimeSession {
 public:
     RuntimeSession(const std::string& prefix, const std::string& config_file);
@@ -3,6 +3,7 @@
 #include "module.hpp"
 
 #include <pybind11/pybind11.h>
+#include <pybind11_json/pybind11_json.hpp>
 
 #include <utils/error/error_factory.hpp>
 #include <utils/error/error_manager_impl.hpp>
@@ -10,32 +11,36 @@
 #include <utils/error/error_state_monitor.hpp>
 
 std::unique_ptr<Everest::Everest>
-Module::create_everest_instance(const std::string& module_id, const Everest::Config& config,
+Module::create_everest_instance(const std::string& module_id, std::shared_ptr<const Everest::Config> config,
                                 const Everest::RuntimeSettings& rs,
                                 std::shared_ptr<Everest::MQTTAbstraction> mqtt_abstraction) {
-    return std::make_unique<Everest::Everest>(module_id, config, rs.validate_schema, mqtt_abstraction,
-                                              rs.telemetry_prefix, rs.telemetry_enabled);
+    return std::make_unique<Everest::Everest>(module_id, std::move(config), rs.validate_schema, mqtt_abstraction,
+                                              rs.telemetry_prefix, rs.telemetry_enabled, rs.validation_policy);
 }
 
-Module::Module(const RuntimeSession& session) : Module(get_variable_from_env("EV_MODULE"), session) {
+Module::Module(const RuntimeSession& session) : Module(get_module_id(), session) {
 }
 
 Module::Module(const std::string& module_id_, const RuntimeSession& session_) :
     module_id(module_id_), session(session_), start_time(std::chrono::system_clock::now()) {
 
-    this->mqtt_abstraction = std::make_shared<Everest::MQTTAbstraction>(session.get_mqtt_settings());
-    this->mqtt_abstraction->connect();
-    this->mqtt_abstraction->spawn_main_loop_thread();
+    if (is_hosted()) {
+        this->mqtt_abstraction = get_shared_mqtt_abstraction(session.get_mqtt_settings());
+    } else {
+        this->mqtt_abstraction = std::make_shared<Everest::MQTTAbstraction>(session.get_mqtt_settings());
+        this->mqtt_abstraction->connect();
+        this->mqtt_abstraction->spawn_main_loop_thread();
+    }
 
     const auto result = Everest::get_module_config(this->mqtt_abstraction, module_id);
 
     this->rs = std::make_unique<Everest::RuntimeSettings>(result.at("settings"));
 
-    this->config_ = std::make_unique<Everest::Config>(session.get_mqtt_settings(), result);
+    this->config_ = std::make_shared<Everest::Config>(session.get_mqtt_settings(), result);
 
     const auto& config = get_config();
 
-    this->handle = create_everest_instance(module_id, config, *this->rs, this->mqtt_abstraction);
+    this->handle = create_everest_instance(module_id, this->config_, *this->rs, this->mqtt_abstraction);
 
     // determine the fulfillments for our requirements
     const std::string& module_name = config.get_main_config().at(module_id).at("module");
@@ -89,11 +94,107 @@ void Module::implement_command(const std::string& impl_id, const std::string& cm
     handle->provide_cmd(impl_id, cmd_name, [&handler](json args) { return handler(std::move(args)); });
 }
 
+void Module::publish_variable_json(const std::string& impl_id, const std::string& var_name,
+                                   const std::string& payload) {
+    // NOTE: parsing does not touch python objects, so other python threads can run meanwhile
+    pybind11::gil_scoped_release release;
+    handle->publish_var(impl_id, var_name, json::parse(payload));
+}
+
 void Module::subscribe_variable(const Fulfillment& fulfillment, const std::string& var_name,
-                                std::function<void(json)> subscription_callback) {
+                                pybind11::function subscription_callback, bool latest_value_only,
+                                PayloadFormat payload_format) {
 
     auto& callback = subscription_callbacks.emplace_back(std::move(subscription_callback));
-    handle->subscribe_var(fulfillment.requirement, var_name, [&callback](json args) { callback(std::move(args)); });
+    handle->subscribe_var(
+        fulfillment.requirement, var_name,
+        [&callback, payload_format](json value) {
+            if (payload_format == PayloadFormat::JsonBytes) {
+                // serialized before taking the GIL, python decodes it with a parser of its choice
+                const auto payload = value.dump();
+                pybind11::gil_scoped_acquire gil;
+                callback(pybind11::bytes(payload));
+                return;
+            }
+            pybind11::gil_scoped_acquire gil;
+            callback(pyjson::from_json(value));
+        },
+        latest_value_only ? Everest::VarSubscriptionMode::LatestValue : Everest::VarSubscriptionMode::Queued);
+}
+
+void Module::call_command_async(const Fulfillment& fulfillment, const std::string& cmd_name, json args,
+                                pybind11::function on_done) {
+    const auto call_id = this->next_async_call_id++;
+    this->pending_async_calls.emplace(call_id, std::move(on_done));
+    try {
+        // NOTE: released like in call_command, since sending can wait for a free slot of a max_in_flight limit
+        pybind11::gil_scoped_release release;
+        handle->call_cmd_async(fulfillment.requirement, cmd_name, std::move(args),
+                               [this, call_id](std::future<json> result) {
+                                   Delivery delivery{true, call_id, nullptr, {}, {}};
+                                   try {
+                                       delivery.value = result.get();
+                                   } catch (const std::exception& e) {
+                                       delivery.error = e.what();
+                                   }
+                                   this->deliveries.push(std::move(delivery));
+                               });
+    } catch (...) {
+        this->pending_async_calls.erase(call_id);
+        throw;
+    }
+}
+
+void Module::subscribe_variable_async(const Fulfillment& fulfillment, const std::string& var_name,
+                                      pybind11::function callback, bool latest_value_only,
+                                      PayloadFormat payload_format) {
+    const auto index = this->async_subscription_callbacks.size();
+    this->async_subscription_callbacks.push_back(std::move(callback));
+    handle->subscribe_var(
+        fulfillment.requirement, var_name,
+        [this, index, payload_format](json value) {
+            Delivery delivery{false, index, nullptr, {}, {}};
+            if (payload_format == PayloadFormat::JsonBytes) {
+                delivery.payload = value.dump();
+            } else {
+                delivery.value = std::move(value);
+            }
+            this->deliveries.push(std::move(delivery));
+        },
+        latest_value_only ? Everest::VarSubscriptionMode::LatestValue : Everest::VarSubscriptionMode::Queued);
+}
+
+void Module::drain_deliveries() {
+    // a local batch, so a callback draining again does not invalidate it
+    std::vector<Delivery> batch;
+    this->deliveries.take_all(batch);
+    for (auto& delivery : batch) {
+        try {
+            if (not delivery.is_cmd_result) {
+                const auto& callback = this->async_subscription_callbacks.at(delivery.id);
+                if (delivery.payload.empty()) {
+                    callback(pyjson::from_json(delivery.value));
+                } else {
+                    callback(pybind11::bytes(delivery.payload));
+                }
+                continue;
+            }
+            const auto call = this->pending_async_calls.find(delivery.id);
+            if (call == this->pending_async_calls.end()) {
+                continue;
+            }
+            const auto on_done = std::move(call->second);
+            this->pending_async_calls.erase(call);
+            if (delivery.error.empty()) {
+                on_done(pyjson::from_json(delivery.value), pybind11::none());
+            } else {
+                on_done(pybind11::none(), delivery.error);
+            }
+        } catch (const pybind11::error_already_set& e) {
+            // a failing callback must not drop the rest of the batch
+            EVLOG_error << "Callback of module " << this->module_id << " failed: " << e.what();
+        }
+    }
 }
 
 void Module::raise_error(const std::string& impl_id, const Everest::error::Error& error) {
@@ -9,12 +9,24 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include <pybind11/pybind11.h>
+
 #include <framework/everest.hpp>
 
+#include "delivery_queue.hpp"
 #include "misc.hpp"
 
+///
+/// \brief How var values are handed to the python callbacks of a subscription
+///
+enum class PayloadFormat {
+    Objects,  ///< converted to python objects node by node
+    JsonBytes ///< serialized to JSON without holding the GIL, faster for large values decoded with e.g. orjson.loads
+};
+
 class Module {
 public:
     Module(const RuntimeSession&);
@@ -47,9 +59,41 @@ public:
 
     json call_command(const Fulfillment& fulfillment, const std::string& cmd_name, json args);
     void publish_variable(const std::string& impl_id, const std::string& var_name, json value);
+
+    ///
+    /// \brief Publishes a variable from its value serialized as JSON \p payload, which is parsed without holding the
+    /// GIL instead of being converted from python objects node by node
+    ///
+    void publish_variable_json(const std::string& impl_id, const std::string& var_name, const std::string& payload);
     void implement_command(const std::string& impl_id, const std::string& cmd_name, std::function<json(json)> handler);
-    void subscribe_variable(const Fulfillment& fulfillment, const std::string& var_name,
-                            std::function<void(json)> callback);
+    void subscribe_variable(const Fulfillment& fulfillment, const std::string& var_name, pybind11::function callback,
+                            bool latest_value_only = false, PayloadFormat payload_format = PayloadFormat::Objects);
+
+    ///
+    /// \brief Calls a command without blocking, \p on_done is called with the result and None, or with None and the
+    /// reason the call failed, by drain_deliveries()
+    ///
+    void call_command_async(const Fulfillment& fulfillment, const std::string& cmd_name, json args,
+                            pybind11::function on_done);
+
+    ///
+    /// \brief Subscribes to a variable like subscribe_variable(), but \p callback is called by drain_deliveries()
+    ///
+    void subscribe_variable_async(const Fulfillment& fulfillment, const std::string& var_name,
+                                  pybind11::function callback, bool latest_value_only = false,
+                                  PayloadFormat payload_format = PayloadFormat::Objects);
+
+    /// \returns the eventfd that becomes readable when drain_deliveries() has var values or cmd results to hand out
+    int get_delivery_fd() const {
+        return deliveries.get_fd();
+    }
+
+    ///
+    /// \brief Calls the callbacks of all var values and cmd results that arrived for the async API, meant to be called
+    /// by the event loop watching get_delivery_fd() while holding the GIL
+    ///
+    void drain_deliveries();
+
     void raise_error(const std::string& impl_id, const Everest::error::Error& error);
     void clear_error(const std::string& impl_id, const Everest::error::ErrorType& type, const bool clear_all = false);
     void clear_error(const std::string& impl_id, const Everest::error::ErrorType& type,
@@ -87,19 +131,26 @@ private:
     const std::chrono::time_point<std::chrono::system_clock> start_time;
     std::unique_ptr<Everest::RuntimeSettings> rs;
     std::shared_ptr<Everest::MQTTAbstraction> mqtt_abstraction;
-    std::unique_ptr<Everest::Config> config_;
+    std::shared_ptr<Everest::Config> config_;
+
+    // NOTE: the async API keeps its python objects here and only passes ids to the handler threads, so they never need
+    // the GIL, these are only touched while holding it. Declared before the handle, so they outlive its threads
+    DeliveryQueue deliveries;
+    std::deque<pybind11::function> async_subscription_callbacks{};
+    std::unordered_map<std::uint64_t, pybind11::function> pending_async_calls{};
+    std::uint64_t next_async_call_id{0};
 
     std::unique_ptr<Everest::Everest> handle;
 
     // NOTE (aw): we're keeping the handlers local to the module instance and don't pass them by copy-construction
     // to "external" c/c++ code, so no GIL related problems should appear
     std::deque<std::function<json(json)>> command_handlers{};
-    std::deque<std::function<void(json)>> subscription_callbacks{};
+    std::deque<pybind11::function> subscription_callbacks{};
     std::deque<std::function<void(json)>> err_susbcription_callbacks{};
     std::deque<std::function<void(json)>> err_cleared_susbcription_callbacks{};
 
     static std::unique_ptr<Everest::Everest>
-    create_everest_instance(const std::string& module_id, const Everest::Config& config,
+    create_everest_instance(const std::string& module_id, std::shared_ptr<const Everest::Config> config,
                             const Everest::RuntimeSettings& rs,
                             std::shared_ptr<Everest::MQTTAbstraction> mqtt_abstraction);
 
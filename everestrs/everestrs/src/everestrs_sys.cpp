@@ -82,9 +82,9 @@ Module::Module(const std::string& module_id, const std::string& prefix, const Ev
 
     config_ = std::make_shared<Everest::Config>(this->mqtt_settings_, result);
 
-    handle_ = std::make_unique<Everest::Everest>(this->module_id_, *this->config_, this->rs_->validate_schema,
+    handle_ = std::make_unique<Everest::Everest>(this->module_id_, this->config_, this->rs_->validate_schema,
                                                  this->mqtt_abstraction_, this->rs_->telemetry_prefix,
-                                                 this->rs_->telemetry_enabled);
+                                                 this->rs_->telemetry_enabled, this->rs_->validation_policy);
 }
 
 std::shared_ptr<Everest::Config> Module::get_config() const {
@@ -147,9 +147,31 @@ JsonBlob Module::call_command(rust::Str implementation_id, std::size_t index, ru
     return json2blob(return_value);
 }
 
+void Module::call_command_async(const Runtime& rt, rust::Str implementation_id, std::size_t index, rust::Str name,
+                                JsonBlob blob, std::uint64_t call_id) const {
+    const auto req = Requirement{std::string(implementation_id), index};
+    try {
+        handle_->call_cmd_async(req, std::string(name), json::parse(blob.data.begin(), blob.data.end()),
+                                [&rt, call_id](std::future<json> result) {
+                                    JsonBlob return_value{};
+                                    std::string error;
+                                    try {
+                                        return_value = json2blob(result.get());
+                                    } catch (const std::exception& e) {
+                                        error = e.what();
+                                    }
+                                    rt.handle_command_result(call_id, std::move(return_value), error);
+                                });
+    } catch (const std::exception& e) {
+        // e.g. invalid arguments, reported like a failed call instead of unwinding into rust
+        rt.handle_command_result(call_id, JsonBlob{}, e.what());
+    }
+}
+
 void Module::publish_variable(rust::Str implementation_id, rust::Str name, JsonBlob blob) const {
-    handle_->publish_var(std::string(implementation_id), std::string(name),
-                         json::parse(blob.data.begin(), blob.data.end()));
+    // the bytes serialized by serde go to the wire as they are, unless the framework has to parse them
+    handle_->publish_var_serialized(std::string(implementation_id), std::string(name),
+                                    std::string(blob.data.begin(), blob.data.end()));
 }
 
 std::shared_ptr<Module> mod;
@@ -167,6 +189,7 @@ std::shared_ptr<Module> create_module(rust::Str module_name, rust::Str prefix, r
                                         std::stoi(std::string(mqtt_broker_port)), std::string(mqtt_everest_prefix),
                                         std::string(mqtt_external_prefix));
     }
+    Everest::populate_mqtt_module_settings_from_env(mqtt_settings);
     mod = std::make_shared<Module>(std::string(module_name), std::string(prefix), mqtt_settings);
     return mod;
 }
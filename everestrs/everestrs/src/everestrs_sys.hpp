@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -32,6 +33,8 @@ public:
     void signal_ready(const Runtime& rt) const;
     void provide_command(const Runtime& rt, rust::String implementation_id, rust::String name) const;
     JsonBlob call_command(rust::Str implementation_id, std::size_t index, rust::Str name, JsonBlob args) const;
+    void call_command_async(const Runtime& rt, rust::Str implementation_id, std::size_t index, rust::Str name,
+                            JsonBlob args, std::uint64_t call_id) const;
     void subscribe_variable(const Runtime& rt, rust::String implementation_id, std::size_t index,
                             rust::String name) const;
     void subscribe_all_errors(const Runtime& rt) const;
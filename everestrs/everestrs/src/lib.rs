@@ -5,12 +5,16 @@ use log::debug;
 use serde::de::DeserializeOwned;
 use std::collections::HashMap;
 use std::convert::TryFrom;
+use std::future::Future;
 use std::path::PathBuf;
 use std::pin::Pin;
+use std::sync::atomic::{AtomicU64, Ordering};
 use std::sync::Arc;
+use std::sync::Mutex;
 use std::sync::Once;
 use std::sync::RwLock;
 use std::sync::Weak;
+use std::task::{Poll, Waker};
 use thiserror::Error;
 
 /// Prevent calling the init of loggers more than once.
@@ -31,6 +35,8 @@ pub enum Error {
     InvalidArgument(&'static str),
     #[error("Mismatched type: Variant contains '{0}'")]
     MismatchedType(String),
+    #[error("command call failed: '{0}'")]
+    CommandFailed(String),
 }
 
 pub type Result<T> = ::std::result::Result<T, Error>;
@@ -60,6 +66,8 @@ mod ffi {
             raised: bool,
         );
 
+        fn handle_command_result(self: &Runtime, call_id: u64, json: JsonBlob, error: &str);
+
         fn on_ready(&self);
     }
 
@@ -187,6 +195,19 @@ mod ffi {
             args: JsonBlob,
         ) -> JsonBlob;
 
+        /// Calls the command like `call_command`, but returns right after the call has been sent.
+        /// `handle_command_result` is called with the `call_id` on a framework thread once the
+        /// result arrived, or with an error if the call failed or timed out.
+        fn call_command_async(
+            self: &Module,
+            rt: Pin<&Runtime>,
+            implementation_id: &str,
+            index: usize,
+            name: &str,
+            args: JsonBlob,
+            call_id: u64,
+        );
+
         /// Informs the runtime that we want to receive the variable described by
         /// `implementation_id` and `name` and registers the `handle_variable` method from the
         /// `Subscriber` as the handler.
@@ -394,6 +415,48 @@ pub trait Subscriber: Sync + Send {
     fn on_ready(&self) {}
 }
 
+/// Receives the result of an asynchronous command call, see [Runtime::call_command_async].
+type CommandResultCallback = Box<dyn FnOnce(Result<serde_json::Value>) + Send>;
+
+/// Shared between a [CommandFuture] and the callback completing it.
+struct CommandState<R> {
+    result: Option<Result<R>>,
+    waker: Option<Waker>,
+}
+
+/// The result of [Runtime::call_command_future]. It only relies on the waker of the task
+/// awaiting it, so it can be awaited on any executor, e.g. tokio.
+pub struct CommandFuture<R> {
+    state: Arc<Mutex<CommandState<R>>>,
+}
+
+impl<R> CommandFuture<R> {
+    /// Returns a future which is already completed with `result`, e.g. for mocks.
+    pub fn ready(result: Result<R>) -> Self {
+        Self {
+            state: Arc::new(Mutex::new(CommandState {
+                result: Some(result),
+                waker: None,
+            })),
+        }
+    }
+}
+
+impl<R> Future for CommandFuture<R> {
+    type Output = Result<R>;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut std::task::Context<'_>) -> Poll<Self::Output> {
+        let mut state = self.state.lock().unwrap();
+        match state.result.take() {
+            Some(result) => Poll::Ready(result),
+            None => {
+                state.waker = Some(cx.waker().clone());
+                Poll::Pending
+            }
+        }
+    }
+}
+
 /// The [Runtime] is the central piece of the bridge between c++ and Rust. We
 /// have to ensure that the `cpp_module` never outlives the [Runtime] object.
 /// This means that the [Runtime] **must** take ownership of `cpp_module`.
@@ -404,6 +467,9 @@ pub trait Subscriber: Sync + Send {
 pub struct Runtime {
     cpp_module: cxx::SharedPtr<ffi::Module>,
     sub_impl: RwLock<Option<Weak<dyn Subscriber>>>,
+    /// The callbacks of the asynchronous command calls waiting for their result, by call id.
+    pending_calls: Mutex<HashMap<u64, CommandResultCallback>>,
+    next_call_id: AtomicU64,
 }
 
 impl Runtime {
@@ -464,6 +530,21 @@ impl Runtime {
             .handle_on_error(impl_id, index, error, raised);
     }
 
+    fn handle_command_result(&self, call_id: u64, json: ffi::JsonBlob, error: &str) {
+        debug!("handle_command_result: {call_id}");
+        let Some(callback) = self.pending_calls.lock().unwrap().remove(&call_id) else {
+            return;
+        };
+        if !error.is_empty() {
+            callback(Err(Error::CommandFailed(error.to_string())));
+            return;
+        }
+        callback(
+            serde_json::from_slice(json.as_bytes())
+                .map_err(|_| Error::InvalidArgument("return_value")),
+        );
+    }
+
     pub fn publish_variable<T: serde::Serialize>(
         &self,
         impl_id: &str,
@@ -496,6 +577,64 @@ impl Runtime {
         serde_json::from_slice(&return_value.data).unwrap()
     }
 
+    /// Calls a command without blocking the calling thread. `on_done` is called on a framework
+    /// thread with the result, or with [Error::CommandFailed] if the call failed or timed out.
+    pub fn call_command_async<T, R, F>(
+        self: Pin<&Self>,
+        impl_id: &str,
+        index: usize,
+        name: &str,
+        args: &T,
+        on_done: F,
+    ) where
+        T: serde::Serialize,
+        R: serde::de::DeserializeOwned,
+        F: FnOnce(Result<R>) + Send + 'static,
+    {
+        let blob = ffi::JsonBlob::from_vec(
+            serde_json::to_vec(args).expect("Serialization of data cannot fail."),
+        );
+        let call_id = self.next_call_id.fetch_add(1, Ordering::Relaxed);
+        let callback: CommandResultCallback = Box::new(move |result| {
+            on_done(result.and_then(|value| {
+                serde_json::from_value(value).map_err(|_| Error::InvalidArgument("return_value"))
+            }))
+        });
+        // released before the call, a failure to send the call completes the callback right away
+        self.pending_calls.lock().unwrap().insert(call_id, callback);
+        self.cpp_module
+            .as_ref()
+            .unwrap()
+            .call_command_async(self, impl_id, index, name, blob, call_id);
+    }
+
+    /// Calls a command like [Runtime::call_command_async], but returns a future of its result.
+    pub fn call_command_future<T, R>(
+        self: Pin<&Self>,
+        impl_id: &str,
+        index: usize,
+        name: &str,
+        args: &T,
+    ) -> CommandFuture<R>
+    where
+        T: serde::Serialize,
+        R: serde::de::DeserializeOwned + Send + 'static,
+    {
+        let state = Arc::new(Mutex::new(CommandState {
+            result: None,
+            waker: None,
+        }));
+        let completed = state.clone();
+        self.call_command_async(impl_id, index, name, args, move |result| {
+            let mut state = completed.lock().unwrap();
+            state.result = Some(result);
+            if let Some(waker) = state.waker.take() {
+                waker.wake();
+            }
+        });
+        CommandFuture { state }
+    }
+
     /// Called from the generated code.
     /// The type T should be an error.
     pub fn raise_error<T: serde::Serialize + core::fmt::Debug>(&self, impl_id: &str, error: T) {
@@ -559,6 +698,8 @@ impl Runtime {
         Arc::pin(Self {
             cpp_module,
             sub_impl: RwLock::new(None),
+            pending_calls: Mutex::new(HashMap::new()),
+            next_call_id: AtomicU64::new(0),
         })
     }
 
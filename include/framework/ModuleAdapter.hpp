@@ -79,6 +79,8 @@ struct ErrorFactory;
 } // namespace error
 struct ModuleAdapter {
     using CallFunc = std::function<Result(const Requirement&, const std::string&, Parameters)>;
+    using CallAsyncFunc = std::function<void(const Requirement&, const std::string&, Parameters, CmdResultCallback)>;
+    using CallAllFunc = std::function<std::vector<CmdCallResult>(const std::string&, const std::string&, Parameters)>;
     using PublishFunc = std::function<void(const std::string&, const std::string&, Value)>;
     using SubscribeFunc = std::function<void(const Requirement&, const std::string&, ValueCallback)>;
     using GetErrorManagerImplFunc = std::function<std::shared_ptr<error::ErrorManagerImpl>(const std::string&)>;
@@ -91,13 +93,18 @@ struct ModuleAdapter {
     using ExtMqttPublishFunc = std::function<void(const std::string&, const std::string&)>;
     using ExtMqttSubscribeFunc = std::function<UnsubscribeToken(const std::string&, StringHandler)>;
     using ExtMqttSubscribePairFunc = std::function<UnsubscribeToken(const std::string&, StringPairHandler)>;
+    using ExtMqttPublishRawFunc = std::function<void(const std::string&, std::string_view)>;
+    using ExtMqttSubscribeRawFunc = std::function<UnsubscribeToken(const std::string&, RawHandler)>;
     using TelemetryPublishFunc =
         std::function<void(const std::string&, const std::string&, const std::string&, const TelemetryMap&)>;
     using GetMappingFunc = std::function<std::optional<ModuleTierMappings>()>;
 
     CallFunc call;
+    CallAsyncFunc call_async; ///< like call, but returns right away and passes the result to a callback
+    CallAllFunc call_all;     ///< calls a cmd on all fulfillments of a requirement at once
     PublishFunc publish;
     SubscribeFunc subscribe;
+    SubscribeFunc subscribe_latest_value; ///< like subscribe, but only delivers the latest value to slow callbacks
     GetErrorManagerImplFunc get_error_manager_impl;
     GetErrorStateMonitorImplFunc get_error_state_monitor_impl;
     GetErrorFactoryFunc get_error_factory;
@@ -108,6 +115,8 @@ struct ModuleAdapter {
     ExtMqttPublishFunc ext_mqtt_publish;
     ExtMqttSubscribeFunc ext_mqtt_subscribe;
     ExtMqttSubscribePairFunc ext_mqtt_subscribe_pair;
+    ExtMqttPublishRawFunc ext_mqtt_publish_raw;     ///< publishes a payload as is, without copying it
+    ExtMqttSubscribeRawFunc ext_mqtt_subscribe_raw; ///< the handler gets views of the received payloads
     std::vector<cmd> registered_commands;
     TelemetryPublishFunc telemetry_publish;
     GetMappingFunc get_mapping;
@@ -156,6 +165,11 @@ public:
         this->publish(topic, data, 5);
     }
 
+    /// \brief publishes the \p payload as is, e.g. when forwarding high-rate traffic of a bridge
+    void publish_raw(const std::string& topic, std::string_view payload) {
+        ev.ext_mqtt_publish_raw(topic, payload);
+    }
+
     UnsubscribeToken subscribe(const std::string& topic, StringHandler handler) const {
         return ev.ext_mqtt_subscribe(topic, std::move(handler));
     }
@@ -164,6 +178,12 @@ public:
         return ev.ext_mqtt_subscribe_pair(topic, std::move(handler));
     }
 
+    /// \brief subscribes to \p topic with a \p handler getting views of the received payloads instead of copies, the
+    /// views are only valid during the call of the handler
+    UnsubscribeToken subscribe_raw(const std::string& topic, RawHandler handler) const {
+        return ev.ext_mqtt_subscribe_raw(topic, std::move(handler));
+    }
+
 private:
     ModuleAdapter& ev;
 };
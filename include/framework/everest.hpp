@@ -3,20 +3,36 @@
 #ifndef FRAMEWORK_EVEREST_HPP
 #define FRAMEWORK_EVEREST_HPP
 
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <future>
 #include <map>
+#include <mutex>
+#include <optional>
 #include <set>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <variant>
 
 #include <everest/exceptions.hpp>
 
+#include <utils/bounded_queue.hpp>
+#include <utils/cmd_call.hpp>
 #include <utils/config.hpp>
 #include <utils/error.hpp>
+#include <utils/in_flight_limit.hpp>
+#include <utils/memory_accounting.hpp>
+#include <utils/metrics.hpp>
 #include <utils/mqtt_abstraction.hpp>
+#include <utils/schema_validator.hpp>
+#include <utils/telemetry_aggregator.hpp>
 #include <utils/types.hpp>
+#include <utils/validation_policy.hpp>
+#include <utils/var_publish_filter.hpp>
 
 namespace Everest {
 ///
@@ -48,9 +64,16 @@ struct ErrorFactory;
 ///
 class Everest {
 public:
+    /// \brief Creates the framework of the module \p module_id with its own copy of the \p config
     Everest(std::string module_id, const Config& config, bool validate_data_with_schema,
             std::shared_ptr<MQTTAbstraction> mqtt_abstraction, const std::string& telemetry_prefix,
-            bool telemetry_enabled);
+            bool telemetry_enabled, const ValidationPolicy& validation_policy = {});
+    /// \brief Creates the framework of the module \p module_id sharing the immutable \p config with the caller, which
+    /// avoids holding a second copy of the config in every module process
+    Everest(std::string module_id, std::shared_ptr<const Config> config, bool validate_data_with_schema,
+            std::shared_ptr<MQTTAbstraction> mqtt_abstraction, const std::string& telemetry_prefix,
+            bool telemetry_enabled, const ValidationPolicy& validation_policy = {});
+    ~Everest();
 
     // forbid copy assignment and copy construction
     // NOTE (aw): move assignment and construction are also not supported because we're creating explicit references to
@@ -58,33 +81,183 @@ public:
     Everest(Everest const&) = delete;
     void operator=(Everest const&) = delete;
 
-    nlohmann::json get_cmd_definition(const std::string& module_id, const std::string& impl_id,
-                                      const std::string& cmd_name, bool is_call);
-    nlohmann::json get_cmd_definition(const std::string& module_id, const std::string& impl_id,
-                                      const std::string& cmd_name);
+    /// \returns the definition of the cmd, which stays valid as long as this object exists
+    const nlohmann::json& get_cmd_definition(const std::string& module_id, const std::string& impl_id,
+                                             const std::string& cmd_name, bool is_call);
+    const nlohmann::json& get_cmd_definition(const std::string& module_id, const std::string& impl_id,
+                                             const std::string& cmd_name);
 
     ///
     /// \brief Allows a module to indicate that it provides the given command \p cmd
     ///
+    /// The cmds of an implementation are handled one after another, unless its manifest sets a cmd_concurrency above
+    /// 1. Up to that many cmds are then handled concurrently on the handler executor, except for the cmds listed in
+    /// serialized_cmds, of which at most one call each is handled at a time.
+    ///
     void provide_cmd(const std::string& impl_id, const std::string& cmd_name, const JsonCommand& handler);
     void provide_cmd(const cmd& cmd);
 
+    ///
+    /// \brief Provides a cmd declared as streaming in its interface like provide_cmd(). The \p handler writes the
+    /// result in chunks, which are published right away, so large results never have to be held in memory at once.
+    /// Every chunk is validated against the result schema of the cmd
+    ///
+    void provide_streaming_cmd(const std::string& impl_id, const std::string& cmd_name,
+                               const StreamingJsonCommand& handler);
+
+    ///
+    /// \brief Provides a cmd like provide_cmd(), but the \p handler may return before it has a result and respond
+    /// later from any thread, so no handler thread is held while the result is computed elsewhere, e.g. by an event
+    /// loop. A call counts against the cmd_concurrency of its implementation only while its handler runs. Calls that
+    /// are never responded to time out at their caller. Responders must not outlive this instance
+    ///
+    void provide_deferred_cmd(const std::string& impl_id, const std::string& cmd_name,
+                              const DeferredJsonCommand& handler);
+
+    /// \brief A cmd of a resolved requirement, see bind_cmd()
+    struct BoundCmd {
+        std::string cmd_name;
+        std::string cmd_topic;
+        std::string target; ///< printable identifier of the called implementation
+        QOS qos;
+        std::set<std::string> arg_names;
+        std::map<std::string, std::shared_ptr<const SchemaValidator>> arg_validators; ///< only set if validating data
+        std::shared_ptr<ValidationSampler> arg_sampler;                               ///< only set if validating data
+        std::shared_ptr<ValidationCost> arg_cost;                                     ///< only set if validating data
+        std::shared_ptr<CmdResultCache> result_cache;                                 ///< only set if cacheable
+        bool streaming{false};                                                        ///< the result is sent in chunks
+        /// shared by all cmds of the connection, if configured
+        std::shared_ptr<InFlightLimit> in_flight_limit;
+    };
+
+    ///
+    /// \brief Resolves the given \p req and the definition of its command \p cmd_name once, so calling the returned
+    /// cmd repeatedly only validates its arguments, serializes and publishes them. Bound cmds are cached, so this is
+    /// cheap when called again
+    ///
+    std::shared_ptr<const BoundCmd> bind_cmd(const Requirement& req, const std::string& cmd_name);
+
     ///
     /// \brief Provides functionality for calling commands of other modules. The module is identified by the given \p
-    /// req, the command by the given command name \p cmd_name and the needed arguments by \p args
+    /// req, the command by the given command name \p cmd_name and the needed arguments by \p args. Results of cmds
+    /// declaring a cache in their interface are reused for calls with the same arguments until they expire
     ///
     nlohmann::json call_cmd(const Requirement& req, const std::string& cmd_name, json args);
 
+    ///
+    /// \brief Calls the given bound \p cmd with the arguments \p args like call_cmd()
+    ///
+    nlohmann::json call_cmd(const BoundCmd& cmd, json args);
+
+    ///
+    /// \brief Calls a command like call_cmd(), but returns right after the call has been sent. The given \p callback
+    /// is called on a handler thread once the result arrived or the call timed out, so several commands can be called
+    /// without waiting for each other. Invalid arguments are still thrown right away
+    ///
+    void call_cmd_async(const Requirement& req, const std::string& cmd_name, json args, CmdResultCallback callback);
+
+    ///
+    /// \returns the admission counters of all connections with a max_in_flight limit that cmds have been called on
+    ///
+    std::map<Requirement, InFlightStats> get_in_flight_stats();
+
+    ///
+    /// \returns how many messages have been validated, skipped because of the ValidationPolicy and how many of them did
+    /// not match their schema
+    ///
+    ValidationStats get_validation_stats() const;
+
+    ///
+    /// \returns the time spent validating the messages of every cmd and var, by module id, implementation id and the
+    /// path of the schema in the interface, like "evse_manager/evse/vars/limits"
+    ///
+    std::map<std::string, ValidationCostStats> get_validation_costs();
+
+    ///
+    /// \returns the estimated memory held by this module by subsystem: the config JSON, the handlers, the queues, the
+    /// MQTT buffers and the validators. Queued and pooled messages are accounted without their payloads
+    ///
+    MemoryReport get_memory_report();
+
+    ///
+    /// \returns the registry of the metrics of this module, which are published with the dispatch metrics and served
+    /// by the OpenMetrics endpoint of the manager if its metrics_port is set
+    ///
+    MetricsRegistry& get_metrics();
+
+    ///
+    /// \returns the context of the cmd call handled by the calling cmd handler, nullptr if called outside of a cmd
+    /// handler. Long running handlers can check it to stop working on calls whose result nobody waits for anymore,
+    /// cancellations are received on a topic of their own, so they reach calls while they are running
+    ///
+    static std::shared_ptr<const CmdCallContext> get_current_cmd_call();
+
+    ///
+    /// \brief Calls a command like call_cmd(), but returns a future of its result right after the call has been sent
+    ///
+    std::future<nlohmann::json> call_cmd_async(const Requirement& req, const std::string& cmd_name, json args);
+
+    ///
+    /// \brief Calls the given bound \p cmd with the arguments \p args like call_cmd_async()
+    ///
+    void call_cmd_async(const BoundCmd& cmd, json args, CmdResultCallback callback);
+    std::future<nlohmann::json> call_cmd_async(const BoundCmd& cmd, json args);
+
+    ///
+    /// \brief Calls a cmd declared as streaming in its interface and calls \p on_chunk on the calling thread for
+    /// every chunk of its result in order, as soon as it arrived. The timeout applies to the time between chunks, so
+    /// long streams do not time out as long as chunks keep arriving. The call is cancelled if \p on_chunk throws. The
+    /// provider sends at most CMD_STREAM_WINDOW chunks ahead of the ones \p on_chunk has consumed
+    ///
+    void call_streaming_cmd(const Requirement& req, const std::string& cmd_name, json args,
+                            const CmdChunkCallback& on_chunk);
+    void call_streaming_cmd(const BoundCmd& cmd, json args, const CmdChunkCallback& on_chunk);
+
+    ///
+    /// \brief Calls the command \p cmd_name with the arguments \p args on all fulfillments of the requirement
+    /// \p requirement_id at once. All calls share the deadline given by \p timeout, which defaults to the timeout of
+    /// call_cmd()
+    ///
+    /// \returns the result or error of every fulfillment, ordered by requirement index
+    ///
+    std::vector<CmdCallResult> call_cmd_all(const std::string& requirement_id, const std::string& cmd_name,
+                                            const nlohmann::json& args,
+                                            std::optional<std::chrono::milliseconds> timeout = std::nullopt);
+
     ///
     /// \brief Publishes a variable of the given \p impl_id, names \p var_name with the given \p value
+    /// \details If the var is configured to be published change only in the var_publishing entry of the module config,
+    ///          a value equal to the last published value is not published again until its refresh interval passed
     ///
     void publish_var(const std::string& impl_id, const std::string& var_name, nlohmann::json value);
 
+    ///
+    /// \brief Publishes a variable like publish_var(), but from its value already serialized as JSON \p payload. The
+    /// payload is spliced into the published message as is, unless it has to be parsed because it is validated or
+    /// the payloads are not encoded as JSON. The \p payload must be valid JSON
+    ///
+    void publish_var_serialized(const std::string& impl_id, const std::string& var_name, const std::string& payload);
+
+    ///
+    /// \brief Starts a batch of publishes, all variables published until the returned batch goes out of scope are
+    /// flushed to the broker together
+    ///
+    [[nodiscard]] PublishBatch publish_batch();
+
+    ///
+    /// \brief Publishes all variables in \p vars of the given \p impl_id in a single batch
+    ///
+    void publish_vars(const std::string& impl_id, const std::vector<std::pair<std::string, nlohmann::json>>& vars);
+
     ///
     /// \brief Subscribes to a variable of another module identified by the given \p req and variable name \p
-    /// var_name. The given \p callback is called when a new value becomes available
+    /// var_name. The given \p callback is called when a new value becomes available. With
+    /// VarSubscriptionMode::LatestValue updates arriving while the \p callback is busy are conflated, so a slow
+    /// callback only sees the latest value. If the var cache is enabled in the MQTT settings, the \p callback is
+    /// called right away with the last value received since this module started
     ///
-    void subscribe_var(const Requirement& req, const std::string& var_name, const JsonCallback& callback);
+    void subscribe_var(const Requirement& req, const std::string& var_name, const JsonCallback& callback,
+                       VarSubscriptionMode mode = VarSubscriptionMode::Queued);
 
     ///
     /// \brief Return the error manager for the given \p impl_id
@@ -123,6 +296,11 @@ public:
     ///
     void external_mqtt_publish(const std::string& topic, const std::string& data);
 
+    ///
+    /// \brief publishes the given \p payload on the given \p topic as is, without copying it into a message first
+    ///
+    void external_mqtt_publish_raw(const std::string& topic, std::string_view payload, QOS qos = QOS::QOS0);
+
     ///
     /// \brief Allows a module to indicate that it provides a external mqtt \p handler at the given \p topic
     ///
@@ -133,6 +311,12 @@ public:
     ///
     UnsubscribeToken provide_external_mqtt_handler(const std::string& topic, const StringPairHandler& handler);
 
+    ///
+    /// \brief Allows a module to indicate that it provides a external mqtt \p handler at the given \p topic, which
+    /// gets views of the topic and payload of the messages as received instead of copies
+    ///
+    UnsubscribeToken provide_external_mqtt_raw_handler(const std::string& topic, const RawHandler& handler);
+
     ///
     /// \brief publishes the given telemetry \p data on the given \p topic
     ///
@@ -189,8 +373,34 @@ public:
     void register_on_ready_handler(const std::function<void()>& handler);
 
 private:
+    /// \brief Calls waiting for their results on a cmd topic
+    struct PendingCmdCalls {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::function<void(nlohmann::json)>> calls; ///< Callbacks by call id
+        Token res_token; ///< Handler receiving all results of the topic
+    };
+
+    /// \brief Topic and definition of a var published by this module
+    struct PublishedVar {
+        std::string topic;
+        QOS qos{QOS::QOS2};
+        const nlohmann::json* definition{nullptr};        ///< points into config, nullptr if the var is not declared
+        std::shared_ptr<const SchemaValidator> validator; ///< only set if validating data
+        std::shared_ptr<ValidationSampler> sampler;       ///< only set if validating data
+        std::shared_ptr<ValidationCost> cost;             ///< only set if validating data
+        std::shared_ptr<VarChangeFilter> change_filter;   ///< only set if only changed values are published
+    };
+
+    struct ValidationCounters {
+        std::atomic<std::uint64_t> validated{0};
+        std::atomic<std::uint64_t> skipped{0};
+        std::atomic<std::uint64_t> violations{0};
+        std::atomic<std::uint64_t> dropped{0};
+    };
+
     std::shared_ptr<MQTTAbstraction> mqtt_abstraction;
-    Config config;
+    std::shared_ptr<const Config> shared_config; ///< immutable, possibly shared with the creator of this object
+    const Config& config;                        ///< *shared_config
     std::string module_id;
     std::map<std::string, std::shared_ptr<error::ErrorManagerImpl>> impl_error_managers; // one per implementation
     std::map<std::string, std::shared_ptr<error::ErrorStateMonitor>>
@@ -201,28 +411,197 @@ private:
     std::shared_ptr<error::ErrorManagerReqGlobal> global_error_manager;   // nullptr if not enabled in manifest
     std::shared_ptr<error::ErrorStateMonitor> global_error_state_monitor; // nullptr if not enabled in manifest
     std::map<std::string, std::set<std::string>> registered_cmds;
-    bool ready_received;
+    /// one per implementation running its cmds concurrently, see cmd_concurrency in the manifest
+    std::map<std::string, std::shared_ptr<ConcurrencyLimiter>> cmd_limiters;
+    std::atomic<bool> ready_received;
+    std::string ready_group; ///< the ready group of this module from its config, empty if it has none
     std::chrono::seconds remote_cmd_res_timeout;
     bool validate_data_with_schema;
+    ValidationPolicy validation_policy;
+    ValidationCounters validation_counters;
+    BoundedQueue<std::function<void()>> async_validations; ///< vars waiting for the asynchronous validation
+    std::thread async_validation_thread;                   ///< only running with asynchronous validation
+    std::mutex validation_costs_mutex;
+    std::map<std::string, std::shared_ptr<ValidationCost>> validation_costs; ///< see get_validation_costs()
+    MetricsRegistry metrics;
+    Counter* cmd_calls_metric{nullptr};
+    Counter* cmd_call_timeouts_metric{nullptr};
+    LatencyHistogram* cmd_call_duration_metric{nullptr};
+    Counter* vars_published_metric{nullptr};
+    Counter* vars_suppressed_metric{nullptr};
     std::unique_ptr<std::function<void()>> on_ready;
-    std::thread heartbeat_thread;
     std::string module_name;
     std::shared_future<void> main_loop_end{};
-    nlohmann::json module_manifest;
-    nlohmann::json module_classes;
+    const nlohmann::json& module_manifest; ///< part of config
+    const nlohmann::json& module_classes;  ///< part of config
     std::string mqtt_everest_prefix;
     std::string mqtt_external_prefix;
     std::string telemetry_prefix;
     std::optional<TelemetryConfig> telemetry_config;
     bool telemetry_enabled;
+    std::unique_ptr<TelemetryAggregator> telemetry_aggregator; ///< nullptr if every telemetry sample is published
     std::optional<ModuleTierMappings> module_tier_mappings;
+    EventLoop::Id dispatch_metrics_timer{0};    ///< 0 if dispatch metrics are not published
+    EventLoop::Id error_publish_timer{0};       ///< 0 if the publishes of errors are not limited
+    EventLoop::Id telemetry_batch_timer{0};     ///< 0 if telemetry samples are not aggregated
+    EventLoop::Id heartbeat_timer{0};           ///< 0 if no heartbeats are published
+    std::atomic<bool> heartbeat_pending{false}; ///< a heartbeat waits for the handler executor
+    std::uint64_t heartbeat_sequence{0};        ///< only used by the heartbeat task, which never runs concurrently
+    std::string call_id_prefix;                 ///< Random prefix of the ids of the cmd calls of this module
+    std::atomic<std::uint64_t> next_call_id{0};
+    std::map<std::string, Token> var_cache_tokens; ///< keep the var topics of the requirements subscribed, by topic
+    std::mutex pending_cmd_calls_mutex;
+    std::shared_ptr<PendingCmdCalls> pending_cmd_calls; ///< Calls waiting for results on the reply topic
+    std::string cmd_reply_topic;                        ///< Topic the results of the calls of this module are sent to
+    std::mutex bound_cmds_mutex;
+    std::map<std::pair<Requirement, std::string>, std::shared_ptr<const BoundCmd>> bound_cmds; ///< by cmd name
+    std::map<Requirement, std::shared_ptr<InFlightLimit>> in_flight_limits; ///< guarded by bound_cmds_mutex
+    std::mutex validators_mutex;
+    /// compiled schemas by interface and path of the schema in the interface, shared by all cmds and vars using them
+    std::unordered_map<std::string, std::shared_ptr<const SchemaValidator>> validators;
+    std::size_t interpreted_schema_bytes{0}; ///< estimated size of the schemas kept by the interpreted validators
+    VarPublishSettings var_publish_settings;
+    std::mutex published_vars_mutex;
+    std::map<std::pair<std::string, std::string>, PublishedVar> published_vars; ///< by impl id and var name
+    std::mutex active_cmd_calls_mutex;
+    std::unordered_map<std::string, std::shared_ptr<CmdCallContext>> active_cmd_calls; ///< calls handled right now
+    /// cancelled calls that have not been started when their cancellation arrived
+    std::unordered_set<std::string> early_cancelled_cmd_calls;
+    std::deque<std::string> early_cancelled_cmd_calls_order; ///< oldest first, to forget the oldest ones
 
     void handle_ready(const nlohmann::json& data);
 
+    ///
+    /// \brief Validates the arguments \p args of a call to the given \p cmd against its manifest
+    ///
+    void validate_cmd_args(const BoundCmd& cmd, const nlohmann::json& args);
+
+    ///
+    /// \returns true if the next message of the \p sampler should be validated and counts it
+    ///
+    bool sample_validation(ValidationSampler& sampler);
+
+    ///
+    /// \returns the accounting of the validations of the schema at \p schema_path of the given implementation
+    ///
+    std::shared_ptr<ValidationCost> get_validation_cost(const std::string& module_id, const std::string& impl_id,
+                                                        const std::string& schema_path);
+
+    ///
+    /// \brief Validates queued vars on a low priority thread until the queue is closed
+    ///
+    void run_async_validation();
+
+    ///
+    /// \returns true if a value of \p var with \p hash is not published because it did not change, see
+    /// VarChangeFilter
+    ///
+    bool is_unchanged(const PublishedVar& var, std::size_t hash);
+
+    ///
+    /// \brief Publishes the \p value of the given \p var right away and queues its validation
+    ///
+    void publish_var_validated_async(const PublishedVar& var, const std::string& impl_id, const std::string& var_name,
+                                     json value);
+
+    ///
+    /// \brief Publishes the envelope \p var_publish_data of a value of the given \p var within a publish span, whose
+    /// context is added to the envelope as its "trace", and counts it as published
+    ///
+    void publish_var_envelope(const PublishedVar& var, const std::string& impl_id, const std::string& var_name,
+                              json& var_publish_data);
+
+    ///
+    /// \returns the validator of the \p schema at \p schema_path in the interface \p interface_name, compiling the
+    /// schema on first use
+    ///
+    std::shared_ptr<const SchemaValidator> get_validator(const std::string& interface_name,
+                                                         const std::string& schema_path, const nlohmann::json& schema);
+
+    ///
+    /// \returns the topic and definition of the var \p var_name of the given \p impl_id, looked up on first use
+    ///
+    const PublishedVar& get_published_var(const std::string& impl_id, const std::string& var_name);
+
+    ///
+    /// \brief Validates and sends the given \p call like call_cmd_async(), but fails it after the given \p timeout
+    ///
+    void start_cmd_call(const BoundCmd& call, nlohmann::json args, CmdResultCallback callback,
+                        std::chrono::nanoseconds timeout);
+
+    ///
+    /// \returns the calls waiting for results, subscribing to the reply topic on first use
+    ///
+    std::shared_ptr<PendingCmdCalls> get_pending_cmd_calls();
+
+    ///
+    /// \brief Sends the given \p call with the arguments \p args, \p on_result is called once with its return value
+    /// \returns the id of the call
+    ///
+    std::string send_cmd_call(const BoundCmd& call, nlohmann::json args, std::chrono::nanoseconds timeout,
+                              std::function<void(nlohmann::json)> on_result);
+
+    ///
+    /// \brief Sends the given \p call like send_cmd_call(), but \p on_result_data is called with the data of every
+    /// result message until the last one of a streamed result. Without a \p timeout the call has no deadline
+    ///
+    std::string publish_cmd_call(const BoundCmd& call, nlohmann::json args,
+                                 std::optional<std::chrono::nanoseconds> timeout,
+                                 std::function<void(nlohmann::json)> on_result_data);
+
+    ///
+    /// \brief Registers the \p handler of the given cmd, publishing every chunk it writes as a separate result
+    /// message if \p streaming, otherwise the single value it writes as the result. The writer of a \p deferred
+    /// handler is a copy owning its state, with which the handler can respond after it returned
+    ///
+    void register_cmd_handler(const std::string& impl_id, const std::string& cmd_name,
+                              const StreamingJsonCommand& handler, bool streaming, bool deferred);
+
+    ///
+    /// \brief Stops waiting for the result of the call with the given \p call_id
+    ///
+    void drop_pending_cmd_call(const std::string& call_id);
+
+    ///
+    /// \brief Stops waiting for the result of the call with the given \p call_id after it timed out and tells the
+    /// provider, so it can stop working on the call
+    ///
+    void cancel_cmd_call(const std::string& cmd_topic, const std::string& cmd_name, const std::string& call_id);
+
+    ///
+    /// \brief Tells the provider of the streamed result of the call with the given \p call_id that the first
+    /// \p consumed chunks have been consumed, so it can send further ones
+    ///
+    void acknowledge_cmd_chunks(const BoundCmd& call, const std::string& call_id, std::uint64_t consumed);
+
+    ///
+    /// \brief Registers the cmd call with the given \p data as being handled by this module
+    /// \returns its context, which is cancelled if a cancellation for the call arrives
+    ///
+    std::shared_ptr<CmdCallContext> begin_cmd_call(const nlohmann::json& data);
+    void end_cmd_call(const std::string& key);
+    void cancel_active_cmd_call(const std::string& key);
+    void acknowledge_active_cmd_call(const std::string& key, std::uint64_t consumed);
+
+    ///
+    /// \brief publishes the next heartbeat from the handler executor, so the heartbeats stop when the handlers of this
+    /// module are stuck
+    ///
     void heartbeat();
 
     void publish_metadata();
 
+    void publish_dispatch_metrics();
+
+    /// \brief publishes the telemetry samples aggregated since the last batch in one message
+    void publish_telemetry_batch();
+
+    ///
+    /// \returns the limiter running the cmds of the given \p impl_id concurrently, nullptr if they are handled one
+    /// after another
+    ///
+    std::shared_ptr<ConcurrencyLimiter> get_cmd_limiter(const std::string& impl_id);
+
     static std::string check_args(const Arguments& func_args, nlohmann::json manifest_args);
     static bool check_arg(ArgumentType arg_types, nlohmann::json manifest_arg);
 
@@ -265,8 +644,7 @@ private:
     /// \brief Create external MQTT with an unsubscribe token
     /// \returns the unsubscribe token
     ///
-    UnsubscribeToken create_external_handler(const std::string& topic, const std::string& external_topic,
-                                             const StringPairHandler& handler);
+    UnsubscribeToken create_external_handler(const std::string& external_topic, const RawHandler& handler);
 };
 
 ///
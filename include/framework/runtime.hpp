@@ -12,6 +12,7 @@
 
 #include <framework/ModuleAdapter.hpp>
 #include <utils/module_config.hpp>
+#include <utils/validation_policy.hpp>
 #include <utils/yaml_loader.hpp>
 
 #include <everest/compile_time_settings.hpp>
@@ -40,6 +41,19 @@ inline constexpr auto EV_MQTT_BROKER_SOCKET_PATH = "EV_MQTT_BROKER_SOCKET_PATH";
 inline constexpr auto EV_MQTT_BROKER_HOST = "EV_MQTT_BROKER_HOST";
 inline constexpr auto EV_MQTT_BROKER_PORT = "EV_MQTT_BROKER_PORT";
 inline constexpr auto EV_VALIDATE_SCHEMA = "EV_VALIDATE_SCHEMA";
+inline constexpr auto EV_MQTT_SEND_BUFFER_SIZE = "EV_MQTT_SEND_BUFFER_SIZE";
+inline constexpr auto EV_MQTT_RECV_BUFFER_SIZE = "EV_MQTT_RECV_BUFFER_SIZE";
+inline constexpr auto EV_MQTT_GROWABLE_BUFFERS = "EV_MQTT_GROWABLE_BUFFERS";
+inline constexpr auto EV_MQTT_PAYLOAD_ENCODING = "EV_MQTT_PAYLOAD_ENCODING";
+inline constexpr auto EV_MQTT_QUEUES = "EV_MQTT_QUEUES";
+inline constexpr auto EV_MQTT_DISPATCH_METRICS = "EV_MQTT_DISPATCH_METRICS";
+inline constexpr auto EV_MQTT_HANDLER_ACCOUNTING = "EV_MQTT_HANDLER_ACCOUNTING";
+inline constexpr auto EV_MQTT_VAR_CACHE = "EV_MQTT_VAR_CACHE";
+inline constexpr auto EV_MQTT_TOPIC_ALIASES = "EV_MQTT_TOPIC_ALIASES";
+inline constexpr auto EV_MQTT_BROKER_SHARDS = "EV_MQTT_BROKER_SHARDS";
+inline constexpr auto EV_PYTHON_ZYGOTE_FD = "EV_PYTHON_ZYGOTE_FD";
+inline constexpr auto EV_JS_HOST_MODULES = "EV_JS_HOST_MODULES";
+inline constexpr auto EV_PY_HOST_MODULES = "EV_PY_HOST_MODULES";
 inline constexpr auto VERSION_INFORMATION_FILE = "version_information.txt";
 
 // FIXME (aw): this needs to be made available by
@@ -92,6 +106,7 @@ inline constexpr auto MQTT_BROKER_HOST = "localhost";
 inline constexpr auto MQTT_BROKER_PORT = 1883;
 inline constexpr auto MQTT_EVEREST_PREFIX = "everest";
 inline constexpr auto MQTT_EXTERNAL_PREFIX = "";
+inline constexpr auto MQTT_PAYLOAD_ENCODING = "json";
 inline constexpr auto TELEMETRY_PREFIX = "everest-telemetry";
 inline constexpr auto TELEMETRY_ENABLED = false;
 inline constexpr auto VALIDATE_SCHEMA = false;
@@ -100,6 +115,71 @@ inline constexpr auto VALIDATE_SCHEMA = false;
 
 std::string parse_string_option(const boost::program_options::variables_map& vm, const char* option);
 
+/// \brief Overwrites the MQTT buffer settings of the given \p mqtt_settings with the ones found in the
+/// EV_MQTT_SEND_BUFFER_SIZE, EV_MQTT_RECV_BUFFER_SIZE and EV_MQTT_GROWABLE_BUFFERS environment variables
+void populate_mqtt_buffer_settings_from_env(MQTTSettings& mqtt_settings);
+
+/// \brief Parses MQTT buffer settings from the given \p settings json, using \p defaults for missing entries
+MQTTBufferSettings parse_mqtt_buffer_settings(const nlohmann::json& settings, const MQTTBufferSettings& defaults);
+
+/// \brief Overwrites the payload encoding of the given \p mqtt_settings with the one found in the
+/// EV_MQTT_PAYLOAD_ENCODING environment variable
+void populate_mqtt_payload_encoding_from_env(MQTTSettings& mqtt_settings);
+
+/// \brief Parses the MQTT queue settings from the given \p queues json, the mqtt_queues object of the settings
+/// \throws EverestConfigError if an overflow policy is unknown
+MQTTQueueSettings parse_mqtt_queue_settings(const nlohmann::json& queues);
+
+/// \brief Serializes the given \p queue_settings into a json object that can be parsed by parse_mqtt_queue_settings
+nlohmann::json mqtt_queue_settings_to_json(const MQTTQueueSettings& queue_settings);
+
+/// \brief Overwrites the MQTT queue settings of the given \p mqtt_settings with the ones found in the EV_MQTT_QUEUES
+/// environment variable
+void populate_mqtt_queue_settings_from_env(MQTTSettings& mqtt_settings);
+
+/// \brief Parses the dispatch metrics settings from the given \p dispatch_metrics json, the mqtt_dispatch_metrics
+/// object of the settings
+MQTTDispatchMetricsSettings parse_mqtt_dispatch_metrics_settings(const nlohmann::json& dispatch_metrics);
+
+/// \brief Overwrites the dispatch metrics settings of the given \p mqtt_settings with the ones found in the
+/// EV_MQTT_DISPATCH_METRICS environment variable, which contains the publish interval in milliseconds if enabled
+void populate_mqtt_dispatch_metrics_settings_from_env(MQTTSettings& mqtt_settings);
+
+/// \brief Parses the handler accounting settings from the given \p handler_accounting json, the
+/// mqtt_handler_accounting object of the settings
+MQTTHandlerAccountingSettings parse_mqtt_handler_accounting_settings(const nlohmann::json& handler_accounting);
+
+/// \brief Overwrites the handler accounting settings of the given \p mqtt_settings with the ones found in the
+/// EV_MQTT_HANDLER_ACCOUNTING environment variable, which contains the handler budget in milliseconds if enabled
+void populate_mqtt_handler_accounting_settings_from_env(MQTTSettings& mqtt_settings);
+
+/// \brief Overwrites the var cache setting of the given \p mqtt_settings with the one found in the EV_MQTT_VAR_CACHE
+/// environment variable, which is "1" if enabled
+void populate_mqtt_var_cache_from_env(MQTTSettings& mqtt_settings);
+
+/// \brief Overwrites the topic aliases setting of the given \p mqtt_settings with the one found in the
+/// EV_MQTT_TOPIC_ALIASES environment variable, which is "1" if enabled
+void populate_mqtt_topic_aliases_from_env(MQTTSettings& mqtt_settings);
+
+/// \brief Parses the MQTT broker shards from the given \p broker_shards json, the mqtt_broker_shards array of the
+/// settings, resolving the external and telemetry topics and the modules of a shard into topic prefixes
+/// \throws EverestConfigError if a shard has no broker or no topics, or a topic prefix is carried by several shards
+std::vector<MQTTBrokerShard> parse_mqtt_broker_shards(const nlohmann::json& broker_shards,
+                                                      const MQTTSettings& mqtt_settings,
+                                                      const std::string& telemetry_prefix);
+
+/// \brief Serializes the given \p broker_shards into a json array that can be parsed by parse_mqtt_broker_shards
+nlohmann::json mqtt_broker_shards_to_json(const std::vector<MQTTBrokerShard>& broker_shards);
+
+/// \brief Overwrites the MQTT broker shards of the given \p mqtt_settings with the ones found in the
+/// EV_MQTT_BROKER_SHARDS environment variable
+void populate_mqtt_broker_shards_from_env(MQTTSettings& mqtt_settings);
+
+/// \brief Overwrites all settings of the given \p mqtt_settings that the manager passes to every module via the
+/// environment, i.e. buffers, payload encoding, queues, dispatch metrics, handler accounting, the var cache, the
+/// topic aliases and the broker shards
+void populate_mqtt_module_settings_from_env(MQTTSettings& mqtt_settings);
+
 const auto TERMINAL_STYLE_ERROR = fmt::emphasis::bold | fg(fmt::terminal_color::red);
 const auto TERMINAL_STYLE_OK = fmt::emphasis::bold | fg(fmt::terminal_color::green);
 const auto TERMINAL_STYLE_BLUE = fmt::emphasis::bold | fg(fmt::terminal_color::blue);
@@ -114,10 +194,13 @@ struct RuntimeSettings {
     std::string telemetry_prefix; ///< MQTT prefix for telemetry
     bool telemetry_enabled;       ///< If telemetry is enabled
     bool validate_schema;         ///< If schema validation for all var publishes and cmd calls is enabled
+    /// Which messages are validated if validate_schema is enabled
+    ValidationPolicy validation_policy;
 
     explicit RuntimeSettings(const fs::path& prefix, const fs::path& etc_dir, const fs::path& data_dir,
                              const fs::path& modules_dir, const fs::path& logging_config_file,
-                             const std::string& telemetry_prefix, bool telemetry_enabled, bool validate_schema);
+                             const std::string& telemetry_prefix, bool telemetry_enabled, bool validate_schema,
+                             const ValidationPolicy& validation_policy);
 
     explicit RuntimeSettings(const nlohmann::json& json);
 };
@@ -125,18 +208,30 @@ struct RuntimeSettings {
 /// \brief Settings needed by the manager to load and validate a config
 
 struct ManagerSettings {
-    fs::path configs_dir;          ///< Directory that contains EVerest configs
-    fs::path schemas_dir;          ///< Directory that contains schemas for config, manifest, interfaces, etc.
-    fs::path interfaces_dir;       ///< Directory that contains interface definitions
-    fs::path types_dir;            ///< Directory that contains type definitions
-    fs::path errors_dir;           ///< Directory that contains error definitions
-    fs::path config_file;          ///< Path to the loaded config file
-    fs::path www_dir;              ///< Directory that contains the everest-admin-panel
-    int controller_port;           ///< Websocket port of the controller
-    int controller_rpc_timeout_ms; ///< RPC timeout for controller commands
+    fs::path configs_dir;             ///< Directory that contains EVerest configs
+    fs::path schemas_dir;             ///< Directory that contains schemas for config, manifest, interfaces, etc.
+    fs::path interfaces_dir;          ///< Directory that contains interface definitions
+    fs::path types_dir;               ///< Directory that contains type definitions
+    fs::path errors_dir;              ///< Directory that contains error definitions
+    fs::path config_file;             ///< Path to the loaded config file
+    fs::path www_dir;                 ///< Directory that contains the everest-admin-panel
+    fs::path config_cache_dir;        ///< Directory to cache the compiled config in, empty if caching is disabled
+    int controller_port;              ///< Websocket port of the controller
+    int controller_rpc_timeout_ms;    ///< RPC timeout for controller commands
+    bool controller_ipc_binary;       ///< Encode the messages between manager and controller with MessagePack
+    int metrics_port;                 ///< HTTP port of the OpenMetrics endpoint of the manager, 0 if disabled
+    int resource_monitor_interval_ms; ///< Interval of sampling the resource use of the modules, 0 if disabled
 
     std::string run_as_user; ///< Username under which EVerest should run
 
+    std::optional<int> mqtt_qos;   ///< Overrides the MQTT QoS level of every var and cmd declared in interfaces
+    bool shm_transport;            ///< Deliver cmds and vars between modules via shared memory instead of the broker
+    bool shared_config_image;      ///< Hand the config to spawned modules in a sealed memfd instead of via the broker
+    bool compress_retained_config; ///< Compress the retained config topics, like manifests and schemas, with deflate
+    bool python_zygote;            ///< Fork python modules from a python process that already imported everestpy
+    bool javascript_host;          ///< Run all javascript modules in worker threads of a single node process
+    bool python_host;              ///< Run all python modules in threads of a single python process
+
     std::string version_information; ///< Version information string reported on startup of the manager
 
     nlohmann::json config; ///< Parsed json of the config_file
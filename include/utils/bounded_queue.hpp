@@ -0,0 +1,234 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_BOUNDED_QUEUE_HPP
+#define UTILS_BOUNDED_QUEUE_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Everest {
+
+/// \brief Decides what happens when an element is added to a queue that reached its maximum depth
+enum class QueueOverflowPolicy {
+    Block,           ///< Wait until the consumer made room for the element
+    DropOldest,      ///< Drop the oldest queued element to make room for the element
+    DropNewest,      ///< Drop the element that should have been added
+    ConflatePerTopic ///< Replace a queued element of the same topic, drop the oldest element if there is none
+};
+
+/// \brief Size limit and overflow behaviour of a queue
+struct QueueSettings {
+    std::size_t max_depth = 0; ///< Maximum number of queued elements, 0 for an unbounded queue
+    QueueOverflowPolicy overflow_policy = QueueOverflowPolicy::Block; ///< Applied when max_depth is reached
+};
+
+/// \brief Fill level and overflow counters of a queue
+struct QueueStats {
+    std::size_t depth{0};          ///< Number of currently queued elements
+    std::size_t max_depth_seen{0}; ///< High-water mark of queued elements
+    std::size_t dropped{0};        ///< Number of dropped elements
+    std::size_t conflated{0};      ///< Number of elements replaced by a newer element of the same topic
+    std::size_t blocked{0};        ///< Number of times a producer had to wait for room in the queue
+
+    QueueStats& operator+=(const QueueStats& other) {
+        this->depth += other.depth;
+        this->max_depth_seen = std::max(this->max_depth_seen, other.max_depth_seen);
+        this->dropped += other.dropped;
+        this->conflated += other.conflated;
+        this->blocked += other.blocked;
+        return *this;
+    }
+};
+
+///
+/// \brief Thread-safe FIFO queue with an optional maximum depth and a QueueOverflowPolicy
+///
+template <typename T> class BoundedQueue {
+public:
+    /// \brief returns the topic elements are conflated by, an empty string if the element must not be conflated
+    using ConflationKey = std::function<std::string(const T&)>;
+
+    explicit BoundedQueue(const QueueSettings& settings = {}, ConflationKey conflation_key = nullptr) :
+        settings(settings), conflation_key(std::move(conflation_key)) {
+    }
+
+    ///
+    /// \brief adds the given \p element, applying the overflow policy if the queue is full
+    /// \returns false if the element has been dropped
+    bool push(T element) {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        if (this->closed) {
+            return false;
+        }
+
+        if (is_full()) {
+            switch (this->settings.overflow_policy) {
+            case QueueOverflowPolicy::Block:
+                this->stats.blocked++;
+                this->not_full.wait(lock, [this]() { return not is_full() or this->closed; });
+                if (this->closed) {
+                    this->stats.dropped++;
+                    return false;
+                }
+                break;
+            case QueueOverflowPolicy::DropNewest:
+                this->stats.dropped++;
+                return false;
+            case QueueOverflowPolicy::ConflatePerTopic:
+                if (conflate(element)) {
+                    return true;
+                }
+                [[fallthrough]];
+            case QueueOverflowPolicy::DropOldest:
+                this->queue.pop_front();
+                this->stats.dropped++;
+                break;
+            }
+        }
+
+        this->queue.push_back(std::move(element));
+        this->stats.max_depth_seen = std::max(this->stats.max_depth_seen, this->queue.size());
+        lock.unlock();
+        this->not_empty.notify_one();
+        return true;
+    }
+
+    ///
+    /// \brief waits for the next element
+    /// \returns the oldest queued element or std::nullopt once the queue has been closed
+    std::optional<T> pop() {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->not_empty.wait(lock, [this]() { return not this->queue.empty() or this->closed; });
+        if (this->closed) {
+            return std::nullopt;
+        }
+
+        std::optional<T> element{std::move(this->queue.front())};
+        this->queue.pop_front();
+        lock.unlock();
+        this->not_full.notify_one();
+        return element;
+    }
+
+    ///
+    /// \returns the oldest queued element or std::nullopt if the queue is empty or has been closed, without waiting
+    std::optional<T> try_pop() {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        if (this->queue.empty() or this->closed) {
+            return std::nullopt;
+        }
+
+        std::optional<T> element{std::move(this->queue.front())};
+        this->queue.pop_front();
+        lock.unlock();
+        this->not_full.notify_one();
+        return element;
+    }
+
+    ///
+    /// \brief moves up to \p max_elements of the oldest queued elements to the end of \p elements without waiting,
+    /// taking the lock only once for the whole batch
+    /// \returns the number of moved elements, 0 if the queue is empty or has been closed
+    std::size_t try_pop_batch(std::vector<T>& elements, std::size_t max_elements) {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        if (this->closed) {
+            return 0;
+        }
+
+        const auto count = std::min(max_elements, this->queue.size());
+        const auto end = this->queue.begin() + count;
+        std::move(this->queue.begin(), end, std::back_inserter(elements));
+        this->queue.erase(this->queue.begin(), end);
+        lock.unlock();
+        if (count > 0) {
+            this->not_full.notify_all();
+        }
+        return count;
+    }
+
+    ///
+    /// \brief removes all queued elements without waiting
+    std::vector<T> drain() {
+        std::vector<T> elements;
+        {
+            const std::lock_guard<std::mutex> lock(this->mutex);
+            elements.reserve(this->queue.size());
+            std::move(this->queue.begin(), this->queue.end(), std::back_inserter(elements));
+            this->queue.clear();
+        }
+        this->not_full.notify_all();
+        return elements;
+    }
+
+    ///
+    /// \brief wakes up all waiting producers and consumers, afterwards no elements are accepted or handed out
+    void close() {
+        {
+            const std::lock_guard<std::mutex> lock(this->mutex);
+            this->closed = true;
+        }
+        this->not_empty.notify_all();
+        this->not_full.notify_all();
+    }
+
+    ///
+    /// \brief accepts and hands out elements again after close() has been called
+    void reopen() {
+        const std::lock_guard<std::mutex> lock(this->mutex);
+        this->closed = false;
+    }
+
+    ///
+    /// \returns the current fill level and overflow counters
+    QueueStats get_stats() {
+        const std::lock_guard<std::mutex> lock(this->mutex);
+        QueueStats current = this->stats;
+        current.depth = this->queue.size();
+        return current;
+    }
+
+private:
+    bool is_full() const {
+        return this->settings.max_depth != 0 and this->queue.size() >= this->settings.max_depth;
+    }
+
+    bool conflate(T& element) {
+        if (this->conflation_key == nullptr) {
+            return false;
+        }
+        const auto key = this->conflation_key(element);
+        if (key.empty()) {
+            return false;
+        }
+        // the replaced element keeps its position, so the order of the other topics is not changed
+        const auto queued = std::find_if(this->queue.rbegin(), this->queue.rend(),
+                                         [this, &key](const T& queued) { return this->conflation_key(queued) == key; });
+        if (queued == this->queue.rend()) {
+            return false;
+        }
+        *queued = std::move(element);
+        this->stats.conflated++;
+        return true;
+    }
+
+    QueueSettings settings;
+    ConflationKey conflation_key;
+    std::deque<T> queue;
+    std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    bool closed{false};
+    QueueStats stats;
+};
+
+} // namespace Everest
+
+#endif // UTILS_BOUNDED_QUEUE_HPP
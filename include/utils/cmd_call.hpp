@@ -0,0 +1,185 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_CMD_CALL_HPP
+#define UTILS_CMD_CALL_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include <nlohmann/json.hpp>
+
+#include <utils/event_loop.hpp>
+#include <utils/executor.hpp>
+#include <utils/types.hpp>
+
+namespace Everest {
+
+///
+/// \returns true if \p topic is the "/res" topic of a module below \p everest_prefix, the only topics a cmd call may
+/// ask for its results to be sent to, so a caller can not make the provider publish to any other topic
+///
+bool is_cmd_reply_topic(const std::string& topic, const std::string& everest_prefix);
+
+/// Chunks of a streamed cmd result the provider sends ahead before it waits for the caller to consume them
+constexpr auto CMD_STREAM_WINDOW = std::uint64_t{16};
+
+///
+/// \brief Deadline and cancellation state of a cmd call handled by this module
+///
+class CmdCallContext {
+public:
+    explicit CmdCallContext(std::optional<std::chrono::system_clock::time_point> deadline);
+
+    /// \returns the point in time after which the caller does not wait for the result anymore, if it sent one
+    std::optional<std::chrono::system_clock::time_point> get_deadline() const;
+
+    /// \returns true if the caller cancelled the call
+    bool is_cancelled() const;
+
+    /// \returns true if the call was cancelled or its deadline has passed, so its result would be ignored anyway
+    bool is_abandoned() const;
+
+    void cancel();
+
+    ///
+    /// \brief Blocks the provider of a streamed result until the caller consumed enough chunks to send the one with
+    /// the given \p seq within the CMD_STREAM_WINDOW
+    /// \returns false if the call has been cancelled or the caller did not consume any chunk within \p timeout, the
+    /// call is cancelled in this case
+    ///
+    bool wait_for_window(std::uint64_t seq, std::chrono::nanoseconds timeout);
+
+    /// \brief Records that the caller consumed the first \p consumed chunks of the streamed result
+    void acknowledge(std::uint64_t consumed);
+
+private:
+    std::optional<std::chrono::system_clock::time_point> deadline;
+    std::atomic_bool cancelled{false};
+    std::mutex window_mutex;
+    std::condition_variable window_cv;
+    std::uint64_t consumed{0}; ///< chunks of a streamed result consumed by the caller, guarded by window_mutex
+};
+
+///
+/// \brief Hands the result messages of a streamed cmd call over from the handler receiving them to the calling
+/// thread, holding at most CMD_STREAM_WINDOW chunks
+///
+class CmdChunkStream {
+public:
+    enum class Event {
+        Chunk,   ///< the next chunk in order is available
+        Done,    ///< the provider sent the last chunk
+        Lost,    ///< a chunk is missing
+        Overrun, ///< the provider sent more chunks than the window allows
+        Timeout, ///< no message arrived in time
+    };
+
+    /// \brief Adds a result message received for the call, called by the handler of the reply topic
+    void push(nlohmann::json data);
+
+    ///
+    /// \brief Waits up to \p timeout for the next result message
+    /// \returns the event, \p chunk is set to the retval of the message for Event::Chunk
+    ///
+    Event next(std::chrono::nanoseconds timeout, nlohmann::json& chunk);
+
+    ///
+    /// \returns the number of chunks consumed so far every half window, which the caller acknowledges to the
+    /// provider, so the provider never waits for the window while the caller has nothing left to consume
+    ///
+    std::optional<std::uint64_t> take_acknowledgement();
+
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<nlohmann::json> messages;
+    bool overrun{false};
+    std::uint64_t next_seq{0};     ///< seq of the next chunk handed to the caller
+    std::uint64_t acknowledged{0}; ///< chunks acknowledged to the provider
+};
+
+///
+/// \brief State of an asynchronous cmd call, shared by its result handler and its timeout timer, which complete it
+/// exactly once
+///
+class AsyncCmdCall {
+public:
+    /// \brief What is left to clean up of a call completed by complete()
+    struct Completion {
+        bool sent{false};    ///< the call has been sent as call_id and holds a slot of its in-flight limit, if any
+        std::string call_id; ///< only set if sent
+        EventLoop::Id timeout_timer{0};
+    };
+
+    explicit AsyncCmdCall(CmdResultCallback callback);
+
+    /// \brief Starts the timeout of the call with \p add_timer, the call cannot complete before it is set up
+    void start_timeout(const std::function<EventLoop::Id()>& add_timer);
+
+    ///
+    /// \brief Sends the call with \p send_call, which returns its call id, unless it already timed out while waiting
+    /// for a slot of its in-flight limit
+    /// \returns false if the call has not been sent because it completed already
+    ///
+    bool send(const std::function<std::string()>& send_call);
+
+    /// \returns the Completion of the call for the first caller only, nothing if it completed already
+    std::optional<Completion> complete();
+
+    /// \brief Hands the \p result of a completed call to its callback, which is posted to \p executor since it may
+    /// block or call cmds itself
+    void deliver(Executor& executor, std::promise<nlohmann::json> result);
+
+private:
+    std::mutex mutex; ///< Held while the call is sent, so it cannot complete before it is set up completely
+    bool completed{false};
+    bool sent{false}; ///< false while waiting for a slot of the in-flight limit
+    std::string call_id;
+    EventLoop::Id timeout_timer{0};
+    CmdResultCallback callback;
+};
+
+///
+/// \brief Results of a cacheable cmd by its serialized arguments, kept for a ttl until a var the results depend on
+/// changes
+///
+class CmdResultCache {
+public:
+    explicit CmdResultCache(std::chrono::nanoseconds ttl);
+
+    ///
+    /// \returns the cached result for the serialized arguments \p key if it did not expire yet, otherwise sets the
+    /// \p generation a result for \p key has to be stored with
+    ///
+    std::optional<nlohmann::json> lookup(const std::string& key, std::uint64_t& generation);
+
+    /// \brief Caches the \p result of a call for \p key, unless the cache has been invalidated since its lookup() at
+    /// \p generation, so the result might be outdated already
+    void store(const std::string& key, std::uint64_t generation, const nlohmann::json& result);
+
+    /// \brief Drops all cached results and the ones of calls still in flight
+    void invalidate();
+
+private:
+    struct Entry {
+        nlohmann::json result;
+        std::chrono::steady_clock::time_point expires;
+    };
+    std::chrono::nanoseconds ttl;
+    std::mutex mutex;
+    std::uint64_t generation{0}; ///< incremented on invalidation, so results of older calls are not cached
+    std::unordered_map<std::string, Entry> entries;
+};
+
+} // namespace Everest
+
+#endif // UTILS_CMD_CALL_HPP
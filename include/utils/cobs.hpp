@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_COBS_HPP
+#define UTILS_COBS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace Everest {
+
+/// \returns the maximum size of the COBS frame of a packet of \p length bytes, including the 0x00 delimiter
+constexpr std::size_t cobs_max_encoded_size(std::size_t length) {
+    return length + length / 254 + 2;
+}
+
+///
+/// \brief Encodes the \p length bytes of \p data as a COBS frame terminated by a 0x00 delimiter into \p out, which
+/// has to hold cobs_max_encoded_size(length) bytes
+/// \details The zeros are located with memchr and the blocks in between are copied with memcpy, so the packet is
+///          encoded in bulk instead of byte by byte
+/// \returns the size of the frame
+///
+std::size_t cobs_encode(const std::uint8_t* data, std::size_t length, std::uint8_t* out);
+
+///
+/// \brief Decodes the \p length bytes of a COBS frame without its delimiter from \p frame into \p out, which has to
+/// hold \p length bytes
+/// \returns the size of the packet, std::nullopt if the frame is malformed
+///
+std::optional<std::size_t> cobs_decode(const std::uint8_t* frame, std::size_t length, std::uint8_t* out);
+
+///
+/// \brief Splits a stream of COBS frames into packets
+/// \details The delimiters are located with memchr. Frames that arrive completely within one chunk are decoded
+///          straight from it, only the beginning of a frame split across chunks is buffered
+///
+class CobsDecoder {
+public:
+    using PacketHandler = std::function<void(const std::uint8_t* data, std::size_t length)>;
+
+    explicit CobsDecoder(std::size_t max_packet_size);
+
+    /// \brief feeds the \p length received bytes of \p data and calls \p handler for every completed packet
+    void feed(const std::uint8_t* data, std::size_t length, const PacketHandler& handler);
+
+    /// \brief drops a partially received frame, e.g. after reopening the device
+    void reset();
+
+    /// \returns the number of frames dropped so far because they were malformed or exceeded the maximum packet size
+    std::size_t get_dropped_frames() const {
+        return this->dropped_frames;
+    }
+
+private:
+    void decode_frame(const std::uint8_t* frame, std::size_t length, const PacketHandler& handler);
+
+    std::size_t max_frame_size;
+    std::vector<std::uint8_t> partial_frame;
+    std::vector<std::uint8_t> packet;
+    bool overflow{false}; ///< the current frame exceeds the maximum size and is skipped up to its delimiter
+    std::size_t dropped_frames{0};
+};
+
+} // namespace Everest
+
+#endif // UTILS_COBS_HPP
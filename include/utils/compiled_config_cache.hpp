@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_COMPILED_CONFIG_CACHE_HPP
+#define UTILS_COMPILED_CONFIG_CACHE_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace Everest {
+
+///
+/// \brief On-disk cache of a fully resolved config, stored as CBOR
+///
+/// The cache is keyed by a hash over the path and content of every input file and over additional settings that
+/// influence the result. Hashing the content instead of relying on modification times also catches updates that
+/// preserve the modification times, like image based firmware updates do.
+///
+class CompiledConfigCache {
+public:
+    /// \brief Creates a cache for the config file named \p config_file in \p cache_dir, that is valid as long as none
+    /// of the \p input_files and the \p settings change
+    CompiledConfigCache(const std::filesystem::path& cache_dir, const std::filesystem::path& config_file,
+                        const std::vector<std::filesystem::path>& input_files, const nlohmann::json& settings);
+
+    /// \returns the cached config if it was compiled from the same inputs, std::nullopt otherwise
+    std::optional<nlohmann::json> load() const;
+
+    /// \brief stores the compiled \p config, failing to do so is only logged since the cache is just an optimization
+    void store(const nlohmann::json& config) const;
+
+    /// \returns the hash of all inputs
+    std::uint64_t get_key() const;
+
+    /// \returns all regular files in \p dir and its subdirectories in a stable order, an empty list if \p dir does not
+    /// exist
+    static std::vector<std::filesystem::path> find_files(const std::filesystem::path& dir);
+
+private:
+    std::filesystem::path cache_file;
+    std::uint64_t key;
+};
+
+} // namespace Everest
+
+#endif // UTILS_COMPILED_CONFIG_CACHE_HPP
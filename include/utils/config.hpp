@@ -3,20 +3,25 @@
 #ifndef UTILS_CONFIG_HPP
 #define UTILS_CONFIG_HPP
 
+#include <array>
+#include <cstddef>
 #include <filesystem>
 #include <list>
+#include <map>
 #include <optional>
 #include <regex>
 #include <set>
 #include <string>
 #include <tuple>
 #include <unordered_map>
+#include <vector>
 
 #include <nlohmann/json-schema.hpp>
 
 #include <utils/config_cache.hpp>
 #include <utils/error.hpp>
 #include <utils/error/error_type_map.hpp>
+#include <utils/memory_accounting.hpp>
 #include <utils/module_config.hpp>
 #include <utils/mqtt_settings.hpp>
 #include <utils/types.hpp>
@@ -50,6 +55,56 @@ struct ImplementationInfo {
     std::string impl_intf;
 };
 
+///
+/// \brief MQTT topics of an implementation, precomputed in its ImplementationIndex
+///
+enum class ImplementationTopic : std::size_t {
+    Cmd,          ///< Cmd calls of the implementation
+    Var,          ///< Vars published by the implementation
+    Error,        ///< Prefix of raised errors, the error type is appended
+    ErrorCleared, ///< Prefix of cleared errors, the error type is appended
+    Count
+};
+
+///
+/// \brief MQTT topics of a module, precomputed in its ModuleIndex
+///
+enum class ModuleTopic : std::size_t {
+    CmdResult, ///< Results of the cmds called by the module
+    Heartbeat, ///< Heartbeats of the module
+    Metadata,  ///< Metadata published by the module
+    Ready,     ///< Ready signal of the module
+    Config,    ///< Config sent to the module by the manager
+    GetConfig, ///< Config requests of the module
+    Count
+};
+
+///
+/// \brief Indexed view of an implementation provided by a module, built once when the config is loaded
+///
+struct ImplementationIndex {
+    std::string interface;            ///< Name of the implemented interface
+    std::string mqtt_prefix;          ///< MQTT prefix of the implementation as returned by ConfigBase::mqtt_prefix()
+    std::string printable_identifier; ///< As returned by ConfigBase::printable_identifier()
+    std::array<std::string, static_cast<std::size_t>(ImplementationTopic::Count)> topics; ///< By ImplementationTopic
+};
+
+///
+/// \brief Indexed view of a module, built once when the config is loaded, so runtime queries don't need to walk the
+/// json documents
+///
+struct ModuleIndex {
+    std::string name;                 ///< Name of the module
+    std::string mqtt_prefix;          ///< MQTT prefix of the module as returned by ConfigBase::mqtt_module_prefix()
+    std::string printable_identifier; ///< As returned by ConfigBase::printable_identifier()
+    std::array<std::string, static_cast<std::size_t>(ModuleTopic::Count)> topics; ///< By ModuleTopic
+    std::unordered_map<std::string, ImplementationIndex> implementations; ///< Provided implementations by id
+    /// Connections of every requirement as returned by ConfigBase::resolve_requirement(), by requirement id
+    std::unordered_map<std::string, nlohmann::json> requirements;
+    std::map<Requirement, Fulfillment> fulfillments; ///< As returned by ConfigBase::resolve_requirements()
+    bool indexed{false}; ///< False if the manifest of the module is not known, so only id related fields are set
+};
+
 ///
 /// \brief Base class for configs
 ///
@@ -73,6 +128,17 @@ protected:
 
     const MQTTSettings mqtt_settings;
 
+    std::unordered_map<std::string, ModuleIndex> index; ///< Indexed view of all modules, by module id
+
+    ///
+    /// \brief (Re)builds the indexed view of all modules, needs to be called whenever the main config, module names or
+    /// manifests changed
+    void build_index();
+
+    ///
+    /// \returns the module index of \p module_id with the manifest of the module known, throws if there is none
+    const ModuleIndex& get_module_index(const std::string& module_id) const;
+
 public:
     ///
     /// \brief Create a ConfigBase with the provided \p mqtt_settings
@@ -92,7 +158,7 @@ public:
 
     ///
     /// \returns the module name matching the provided \p module_id
-    std::string get_module_name(const std::string& module_id) const;
+    const std::string& get_module_name(const std::string& module_id) const;
 
     ///
     /// \brief turns the given \p module_id and \p impl_id into a mqtt prefix
@@ -104,6 +170,17 @@ public:
     ///
     std::string mqtt_module_prefix(const std::string& module_id);
 
+    ///
+    /// \returns the precomputed \p topic of the implementation \p impl_id of \p module_id, which stays valid as long as
+    /// this config exists. Throws if the implementation is not known
+    const std::string& get_topic(const std::string& module_id, const std::string& impl_id,
+                                 ImplementationTopic topic) const;
+
+    ///
+    /// \returns the precomputed \p topic of \p module_id, which stays valid as long as this config exists. Throws if
+    /// the module is not known
+    const std::string& get_topic(const std::string& module_id, ModuleTopic topic) const;
+
     ///
     /// \returns a json object that contains the main config
     const nlohmann::json& get_main_config() const;
@@ -152,13 +229,13 @@ public:
     /// \brief checks if the given \p module_id provides the requirement given in \p requirement_id
     ///
     /// \returns a json object that contains the requirement
-    nlohmann::json resolve_requirement(const std::string& module_id, const std::string& requirement_id) const;
+    const nlohmann::json& resolve_requirement(const std::string& module_id, const std::string& requirement_id) const;
 
     ///
     /// \brief resolves all Requirements of the given \p module_id to their Fulfillments
     ///
     /// \returns a map indexed by Requirements
-    std::map<Requirement, Fulfillment> resolve_requirements(const std::string& module_id) const;
+    const std::map<Requirement, Fulfillment>& resolve_requirements(const std::string& module_id) const;
 
     ///
     /// \returns a list of Requirements for \p module_id
@@ -180,6 +257,10 @@ public:
     //
     /// \returns the 3 tier model mapping for the given \p module_id and \p impl_id
     std::optional<Mapping> get_3_tier_model_mapping(const std::string& module_id, const std::string& impl_id) const;
+    ///
+    /// \returns the estimated memory held by the parsed JSON documents of this config, with the bytes of each of them
+    /// in the details
+    SubsystemMemory get_memory_usage() const;
 };
 
 ///
@@ -192,7 +273,19 @@ private:
     std::unordered_map<std::string, std::optional<TelemetryConfig>> telemetry_configs;
 
     ///
-    /// \brief loads and validates the manifest of the module \p module_id using the provided \p module config
+    /// \brief loads and validates the manifest of the module \p module_name, this does not modify the config and can be
+    /// called concurrently
+    ///
+    /// \returns the manifest extended with its default values
+    nlohmann::json load_manifest(const std::string& module_name) const;
+
+    ///
+    /// \brief loads the manifests of all \p module_names and the interfaces they provide in parallel
+    void load_manifests(const std::set<std::string>& module_names);
+
+    ///
+    /// \brief validates the config of the module \p module_id using the provided \p module config against its already
+    /// loaded manifest
     void load_and_validate_manifest(const std::string& module_id, const nlohmann::json& module_config);
 
     ///
@@ -200,33 +293,31 @@ private:
     ///
     /// \returns the loaded json and how long the validation took in ms
     std::tuple<nlohmann::json, int64_t> load_and_validate_with_schema(const fs::path& file_path,
-                                                                      const nlohmann::json& schema);
+                                                                      const nlohmann::json& schema) const;
 
     ///
-    /// \brief resolves inheritance tree of json interface \p intf_name, throws an exception if variables or commands
-    /// would be overwritten
-    ///
-    /// \returns the resulting interface definition
-    nlohmann::json resolve_interface(const std::string& intf_name);
+    /// \brief loads and validates the interfaces \p intf_names that have not been loaded yet in parallel and stores
+    /// them in the interface definitions
+    void resolve_interfaces(const std::set<std::string>& intf_names);
 
     ///
     /// \brief loads the contents of the interface file referenced by the give \p intf_name from disk and validates its
     /// contents
     ///
     /// \returns a json object containing the interface definition
-    nlohmann::json load_interface_file(const std::string& intf_name);
+    nlohmann::json load_interface_file(const std::string& intf_name) const;
 
     ///
     /// \brief loads the contents of an error or an error list referenced by the given \p reference.
     ///
     /// \returns a list of json objects containing the error definitions
-    std::list<nlohmann::json> resolve_error_ref(const std::string& reference);
+    std::list<nlohmann::json> resolve_error_ref(const std::string& reference) const;
 
     ///
     /// \brief replaces all error references in the given \p interface_json with the actual error definitions
     ///
     /// \returns the interface_json with replaced error references
-    nlohmann::json replace_error_refs(nlohmann::json& interface_json);
+    nlohmann::json replace_error_refs(nlohmann::json& interface_json) const;
 
     ///
     /// \brief resolves all requirements (connections) of the modules in the main config
@@ -254,9 +345,22 @@ private:
     /// Implementations can have overwritten mappings.
     void parse_3_tier_model_mapping();
 
+    ///
+    /// \returns all files the config is compiled from, including the \p user_config_path that may not exist
+    std::vector<fs::path> get_compiled_config_inputs(const fs::path& user_config_path) const;
+
+    ///
+    /// \returns the fully resolved config that can be restored with load_compiled()
+    nlohmann::json serialize_compiled();
+
+    ///
+    /// \brief restores the fully resolved config from the \p compiled output of serialize_compiled()
+    void load_compiled(const nlohmann::json& compiled);
+
 public:
     ///
-    /// \brief Create a ManagerConfig from the provided ManagerSettings \p ms
+    /// \brief Create a ManagerConfig from the provided ManagerSettings \p ms, the compiled config cached in its
+    /// config_cache_dir is used instead if none of its inputs changed
     explicit ManagerConfig(const ManagerSettings& ms);
 
     ///
@@ -266,6 +370,23 @@ public:
     ///
     /// \returns a TelemetryConfig if this has been configured for the given \p module_id
     std::optional<TelemetryConfig> get_telemetry_config(const std::string& module_id);
+
+    ///
+    /// \brief Computes the part of the config the module \p module_id needs: the manifests and module config caches of
+    /// itself and the modules it is connected to, the interfaces it provides, requires or is connected to and the types
+    /// and error namespaces these interfaces reference
+    ///
+    /// \returns a json object with the manifests, interface_definitions, types, error_map and module_config_cache
+    /// entries
+    nlohmann::json get_module_config_slice(const std::string& module_id) const;
+
+    ///
+    /// \brief Compares this config to the reloaded config \p other: a module changed if it was added or removed, if its
+    /// config entry, manifest or one of the interfaces it provides or requires changed, or if a module it is connected
+    /// to changed its 3 tier model mapping
+    ///
+    /// \returns the ids of all changed modules, or std::nullopt if settings shared by all modules changed
+    std::optional<std::set<std::string>> get_changed_modules(const ManagerConfig& other) const;
 };
 
 ///
@@ -287,11 +408,11 @@ public:
 
     ///
     /// \returns true if the module \p module_name provides the implementation \p impl_id
-    bool module_provides(const std::string& module_name, const std::string& impl_id);
+    bool module_provides(const std::string& module_name, const std::string& impl_id) const;
 
     ///
     /// \returns the commands that the modules \p module_name implements from the given implementation \p impl_id
-    nlohmann::json get_module_cmds(const std::string& module_name, const std::string& impl_id);
+    const nlohmann::json& get_module_cmds(const std::string& module_name, const std::string& impl_id) const;
 
     ///
     /// \brief A RequirementInitialization contains everything needed to initialize a requirement in user code. This
@@ -305,7 +426,7 @@ public:
 
     ///
     /// \returns a json object that contains the module config options
-    nlohmann::json get_module_json_config(const std::string& module_id);
+    nlohmann::json get_module_json_config(const std::string& module_id) const;
 
     ///
     /// \brief assemble basic information about the module (id, name,
@@ -316,7 +437,7 @@ public:
 
     ///
     /// \returns a TelemetryConfig if this has been configured
-    std::optional<TelemetryConfig> get_telemetry_config();
+    std::optional<TelemetryConfig> get_telemetry_config() const;
 
     ///
     /// \returns a json object that contains the interface definition
@@ -326,7 +447,7 @@ public:
     /// \brief A json schema loader that can handle type refs and otherwise uses the builtin draft7 schema of
     /// the json schema validator when it encounters it. Throws an exception
     /// otherwise
-    void ref_loader(const nlohmann::json_uri& uri, nlohmann::json& schema);
+    void ref_loader(const nlohmann::json_uri& uri, nlohmann::json& schema) const;
 
     ///
     /// \brief loads the config.json and manifest.json in the schemes subfolder of
@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_CONFIG_IMAGE_HPP
+#define UTILS_CONFIG_IMAGE_HPP
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <nlohmann/json.hpp>
+
+namespace Everest {
+
+inline constexpr auto EV_CONFIG_IMAGE_FD = "EV_CONFIG_IMAGE_FD";
+
+///
+/// \brief Read-only image of the config snapshots of all modules, shared by the manager with the modules it spawns
+///
+/// The image is a sealed memfd inherited by the modules, so its pages are shared between all processes instead of
+/// each module receiving its own copy via MQTT. It consists of a sorted table of keys and offsets followed by CBOR
+/// encoded blobs. Every entry of a snapshot is stored as its own blob and identical blobs are only stored once, so
+/// e.g. an interface definition used by many modules occupies the image only once. A module only decodes the blobs
+/// referenced by its own snapshot.
+///
+class ConfigImage {
+public:
+    ///
+    /// \brief creates an image of the given \p module_snapshots, indexed by module id, in the format sent by the
+    /// manager on get_config
+    static std::unique_ptr<ConfigImage> create(const std::map<std::string, nlohmann::json>& module_snapshots);
+
+    ///
+    /// \brief maps the image announced by the manager in the EV_CONFIG_IMAGE_FD environment variable
+    /// \returns the image or nullptr if no config image has been passed to this process
+    static std::unique_ptr<ConfigImage> attach_from_env();
+
+    ~ConfigImage();
+
+    ConfigImage(ConfigImage const&) = delete;
+    void operator=(ConfigImage const&) = delete;
+
+    ///
+    /// \brief sets the EV_CONFIG_IMAGE_FD environment variable for a module process
+    void setup_environment() const;
+
+    ///
+    /// \returns the snapshot of the module \p module_id or std::nullopt if the image does not contain it
+    std::optional<nlohmann::json> get_module_snapshot(const std::string& module_id) const;
+
+    ///
+    /// \returns the size of the image in bytes
+    std::size_t get_size() const;
+
+private:
+    ConfigImage(int fd, const void* image, std::size_t size);
+
+    std::optional<std::string_view> find(std::string_view key) const;
+    nlohmann::json decode_blob(const nlohmann::json& index) const;
+
+    int fd;            ///< memfd of the image, only kept open by the manager to pass it on to the modules
+    const void* image; ///< read-only mapping of the image
+    std::size_t size;
+};
+
+} // namespace Everest
+
+#endif // UTILS_CONFIG_IMAGE_HPP
@@ -3,17 +3,46 @@
 #ifndef UTILS_DATE_HPP
 #define UTILS_DATE_HPP
 
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
 #include <date/date.h>
 #include <date/tz.h>
 
 namespace Everest {
 namespace Date {
 
+/// \brief Length of an RFC3339 timestamp with milliseconds like 2024-01-31T12:00:00.000Z
+constexpr std::size_t RFC3339_LENGTH = 24;
+using Rfc3339Buffer = std::array<char, RFC3339_LENGTH>;
+
 std::string to_rfc3339(const std::chrono::time_point<date::utc_clock>& t);
 
+///
+/// \brief Formats \p t like to_rfc3339() into \p buffer without allocating
+/// \details The date and time of day up to the seconds are cached per thread and reused while the formatted timestamps
+///          stay in the same second, so formatting a timestamp usually only writes its milliseconds
+/// \returns a view of \p buffer, or an empty view if the year of \p t has more than four digits
+///
+std::string_view format_rfc3339(const std::chrono::time_point<date::utc_clock>& t, Rfc3339Buffer& buffer);
+
 std::chrono::time_point<date::utc_clock> from_rfc3339(const std::string& t);
 
+///
+/// \brief Clock reading the coarse realtime clock of the kernel, which is only updated once per kernel tick
+/// \details Reading it is considerably cheaper than date::utc_clock::now() since it neither needs a precise clock read
+///          nor a leap second lookup, the leap seconds are looked up once per day. Suited for timestamps that are
+///          published at a high rate and do not need more than a few milliseconds of resolution, like telemetry.
+///
+struct CoarseClock {
+    using time_point = std::chrono::time_point<date::utc_clock>;
+
+    static time_point now();
+};
+
 } // namespace Date
 } // namespace Everest
 
-#endif // UTILS_CONFIG_HPP
+#endif // UTILS_DATE_HPP
@@ -4,8 +4,11 @@
 #ifndef UTILS_ERROR_DATABASE_HPP
 #define UTILS_ERROR_DATABASE_HPP
 
+#include <functional>
 #include <list>
+#include <map>
 #include <memory>
+#include <mutex>
 
 #include <utils/error/error_filter.hpp>
 
@@ -15,6 +18,13 @@ namespace error {
 class ErrorDatabase {
 public:
     using EditErrorFunc = std::function<void(ErrorPtr)>;
+    ///
+    /// \brief Called after errors were added to or removed from the database
+    /// \param added The errors that were added
+    /// \param removed The errors that were removed
+    ///
+    using ErrorsChangedFunc = std::function<void(const std::list<ErrorPtr>& added, const std::list<ErrorPtr>& removed)>;
+    using ChangeHandlerId = std::size_t;
 
     ErrorDatabase() = default;
     virtual ~ErrorDatabase() = default;
@@ -23,6 +33,38 @@ public:
     virtual std::list<ErrorPtr> get_errors(const std::list<ErrorFilter>& filters) const = 0;
     virtual std::list<ErrorPtr> edit_errors(const std::list<ErrorFilter>& filters, EditErrorFunc edit_func) = 0;
     virtual std::list<ErrorPtr> remove_errors(const std::list<ErrorFilter>& filters) = 0;
+
+    ///
+    /// \brief add_change_handler registers a handler that is called after every change of the database, outside of
+    ///        the lock of the database so it can query it
+    /// \return The id to remove the handler with
+    ///
+    ChangeHandlerId add_change_handler(ErrorsChangedFunc handler);
+    ///
+    /// \brief remove_change_handler removes a handler registered with add_change_handler, returns after a running
+    ///        call of the handler finished
+    ///
+    void remove_change_handler(ChangeHandlerId id);
+
+protected:
+    ///
+    /// \brief notify_change calls all change handlers, implementations call it after every change
+    ///
+    void notify_change(const std::list<ErrorPtr>& added, const std::list<ErrorPtr>& removed) const;
+
+    ///
+    /// \brief lock_changes serializes the changes of the database with their notifications, implementations hold
+    ///        the returned lock from before taking their own lock for a change until notify_change() returned, so the
+    ///        handlers see the changes in the order they were made
+    ///
+    std::unique_lock<std::recursive_mutex> lock_changes() const;
+
+private:
+    /// recursive, since change handlers may change the database themselves
+    mutable std::recursive_mutex changes_mutex;
+    std::map<ChangeHandlerId, ErrorsChangedFunc> change_handlers;
+    ChangeHandlerId next_change_handler_id{0};
+    mutable std::mutex change_handlers_mutex;
 };
 
 } // namespace error
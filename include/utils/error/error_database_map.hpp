@@ -5,6 +5,11 @@
 #define ERROR_DATABASE_MAP_HPP
 
 #include <list>
+#include <map>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
 #include <utils/error.hpp>
 #include <utils/error/error_database.hpp>
 
@@ -21,8 +26,20 @@ public:
     std::list<ErrorPtr> remove_errors(const std::list<ErrorFilter>& filters) override;
 
 private:
+    using HandleIndex = std::unordered_map<std::string, std::set<ErrorHandle>>;
+
     std::list<ErrorPtr> get_errors_no_mutex(const std::list<ErrorFilter>& filters) const;
+    ///
+    /// \brief get_indexed_handles looks up the handles of the errors matching \p filter in the secondary indexes
+    /// \return The matching handles, or nullptr if the filter type is not indexed
+    ///
+    const std::set<ErrorHandle>* get_indexed_handles(const ErrorFilter& filter) const;
+    void remove_error_no_mutex(const ErrorPtr& error);
+
     std::map<ErrorHandle, ErrorPtr> errors;
+    HandleIndex type_index;     ///< Handles of the errors by type
+    HandleIndex sub_type_index; ///< Handles of the errors by sub type
+    HandleIndex origin_index;   ///< Handles of the errors by ImplementationIdentifier::to_string() of their origin
     mutable std::mutex errors_mutex;
 };
 
@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#ifndef ERROR_DATABASE_RING_HPP
+#define ERROR_DATABASE_RING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <utils/error.hpp>
+#include <utils/error/error_database.hpp>
+
+namespace Everest {
+namespace error {
+
+struct ErrorRecord;
+struct ErrorRingHeader;
+
+///
+/// \brief Error history keeping the last errors in a ring of fixed size records
+/// \details Unlike ErrorDatabaseMap, removing errors does not forget them: they stay in the history with the state
+///          ClearedByModule until they are overwritten by newer errors, so the memory stays bounded by the capacity.
+///          Errors are queried with ErrorFilter, including StateFilter. TimePeriodFilter queries are answered from an
+///          index of the timestamps. The strings of an error are truncated to the size of a record and the mapping of
+///          its origin is not kept.
+///
+///          If a file is given, the ring is mapped from it, so the history survives restarts. A file with a different
+///          capacity or format is overwritten.
+///
+class ErrorDatabaseRing : public ErrorDatabase {
+public:
+    ///
+    /// \brief ErrorDatabaseRing constructor
+    /// \param capacity The number of errors kept in the history
+    /// \param file The file the ring is persisted to, the ring is kept in memory only if empty
+    /// \throws EverestInternalError if the file can not be mapped
+    ///
+    explicit ErrorDatabaseRing(std::size_t capacity, const std::string& file = "");
+    ~ErrorDatabaseRing() override;
+    ErrorDatabaseRing(const ErrorDatabaseRing&) = delete;
+    ErrorDatabaseRing& operator=(const ErrorDatabaseRing&) = delete;
+
+    void add_error(ErrorPtr error) override;
+    std::list<ErrorPtr> get_errors(const std::list<ErrorFilter>& filters) const override;
+    std::list<ErrorPtr> edit_errors(const std::list<ErrorFilter>& filters, EditErrorFunc edit_func) override;
+    ///
+    /// \brief remove_errors marks the active errors matching \p filters as cleared, they stay in the history
+    /// \return The errors that were active
+    ///
+    std::list<ErrorPtr> remove_errors(const std::list<ErrorFilter>& filters) override;
+
+    /// \returns the number of errors in the history
+    std::size_t size() const;
+
+private:
+    /// \returns the slots of the records matching \p filters in the order the errors were raised
+    std::list<std::size_t> find_slots_no_mutex(const std::list<ErrorFilter>& filters) const;
+    void index_slot_no_mutex(std::size_t slot);
+    void unindex_slot_no_mutex(std::size_t slot);
+
+    std::size_t capacity;
+    std::size_t mapped_size{0}; ///< 0 if the ring is not mapped from a file
+    ErrorRingHeader* header{nullptr};
+    ErrorRecord* records{nullptr};
+
+    std::multimap<std::int64_t, std::size_t> time_index;      ///< Slots by the timestamp of their error
+    std::unordered_map<std::string, std::size_t> handle_index; ///< Slots by the handle of their error
+    mutable std::mutex records_mutex;
+};
+
+} // namespace error
+} // namespace Everest
+
+#endif // ERROR_DATABASE_RING_HPP
@@ -104,6 +104,12 @@ public:
     SubTypeFilter get_sub_type_filter() const;
     VendorIdFilter get_vendor_id_filter() const;
 
+    ///
+    /// \brief matches checks if \p error passes this filter
+    /// \return True if the error passes the filter, false otherwise
+    ///
+    bool matches(const Error& error) const;
+
 private:
     FilterVariant filter;
 };
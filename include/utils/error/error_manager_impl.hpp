@@ -4,10 +4,13 @@
 #ifndef UTILS_ERROR_MANAGER_IMPL_HPP
 #define UTILS_ERROR_MANAGER_IMPL_HPP
 
+#include <chrono>
 #include <list>
 #include <memory>
+#include <optional>
 
 #include <utils/error.hpp>
+#include <utils/error/error_publish_limiter.hpp>
 
 namespace Everest {
 namespace error {
@@ -21,7 +24,8 @@ public:
 
     ErrorManagerImpl(std::shared_ptr<ErrorTypeMap> error_type_map, std::shared_ptr<ErrorDatabase> error_database,
                      std::list<ErrorType> allowed_error_types, PublishErrorFunc publish_raised_error,
-                     PublishErrorFunc publish_cleared_error, const bool validate_error_types = true);
+                     PublishErrorFunc publish_cleared_error, const bool validate_error_types = true,
+                     const ErrorPublishSettings& publish_settings = {});
 
     ///
     /// \brief raise_error raises an error
@@ -52,6 +56,18 @@ public:
     ///
     std::list<ErrorPtr> clear_all_errors();
 
+    ///
+    /// \brief flush_publishes publishes the raises and clears deferred by the publish settings that became due
+    /// \details Needs to be called periodically if has_deferred_publishes() returns true.
+    /// \return The time the next deferred publish becomes due, if any
+    ///
+    std::optional<std::chrono::steady_clock::time_point> flush_publishes();
+
+    ///
+    /// \brief has_deferred_publishes returns true if the publish settings limit the publishes of any error type
+    ///
+    bool has_deferred_publishes() const;
+
 private:
     bool can_be_raised(const ErrorType& type, const ErrorSubType& sub_type) const;
     bool can_be_cleared(const ErrorType& type, const ErrorSubType& sub_type) const;
@@ -63,6 +79,7 @@ private:
 
     PublishErrorFunc publish_raised_error;
     PublishErrorFunc publish_cleared_error;
+    std::unique_ptr<ErrorPublishLimiter> publish_limiter; ///< nullptr if publishes are not limited
 
     const bool validate_error_types;
 };
@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#ifndef UTILS_ERROR_POOL_HPP
+#define UTILS_ERROR_POOL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include <utils/error.hpp>
+
+namespace Everest {
+namespace error {
+
+///
+/// \brief Free list of equally sized memory blocks, keeping at most max_free_blocks of them when they are released
+///
+template <std::size_t Size, std::size_t Alignment> class BlockPool {
+public:
+    static constexpr std::size_t max_free_blocks = 1024;
+
+    static BlockPool& get() {
+        // never destroyed, so errors outliving static destruction can still be released
+        static auto* pool = new BlockPool();
+        return *pool;
+    }
+
+    void* allocate() {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (not this->free_blocks.empty()) {
+                void* block = this->free_blocks.back();
+                this->free_blocks.pop_back();
+                return block;
+            }
+        }
+        return ::operator new(Size, std::align_val_t(Alignment));
+    }
+
+    void release(void* block) {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (this->free_blocks.size() < max_free_blocks) {
+                this->free_blocks.push_back(block);
+                return;
+            }
+        }
+        ::operator delete(block, std::align_val_t(Alignment));
+    }
+
+private:
+    BlockPool() {
+        this->free_blocks.reserve(max_free_blocks);
+    }
+
+    std::mutex mutex;
+    std::vector<void*> free_blocks;
+};
+
+///
+/// \brief Allocator taking single objects from a BlockPool, so errors raised and cleared in a storm reuse their memory
+///
+template <typename T> struct PoolAllocator {
+    using value_type = T;
+
+    PoolAllocator() = default;
+    template <typename U> PoolAllocator(const PoolAllocator<U>&) noexcept {
+    }
+
+    T* allocate(std::size_t n) {
+        if (n != 1) {
+            return std::allocator<T>().allocate(n);
+        }
+        return static_cast<T*>(BlockPool<sizeof(T), alignof(T)>::get().allocate());
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        if (n != 1) {
+            std::allocator<T>().deallocate(p, n);
+            return;
+        }
+        BlockPool<sizeof(T), alignof(T)>::get().release(p);
+    }
+
+    template <typename U> bool operator==(const PoolAllocator<U>&) const noexcept {
+        return true;
+    }
+    template <typename U> bool operator!=(const PoolAllocator<U>&) const noexcept {
+        return false;
+    }
+};
+
+///
+/// \brief make_error creates an ErrorPtr whose error and reference count share one block of a BlockPool
+///
+template <typename... Args> ErrorPtr make_error(Args&&... args) {
+    return std::allocate_shared<Error>(PoolAllocator<Error>(), std::forward<Args>(args)...);
+}
+
+} // namespace error
+} // namespace Everest
+
+#endif // UTILS_ERROR_POOL_HPP
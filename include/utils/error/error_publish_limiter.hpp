@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#ifndef UTILS_ERROR_PUBLISH_LIMITER_HPP
+#define UTILS_ERROR_PUBLISH_LIMITER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+
+#include <utils/error.hpp>
+
+namespace Everest {
+namespace error {
+
+///
+/// \brief Limits for publishing the raises and clears of one error type
+///
+struct ErrorPublishLimits {
+    std::chrono::milliseconds debounce{0}; ///< Time an error has to stay raised before its raise is published
+    std::chrono::milliseconds hold{0};     ///< Time an error has to stay cleared before its clear is published
+    double max_publishes_per_s{0};         ///< Publishes of this error per second, 0 for no limit
+    std::size_t flapping_transitions{0};   ///< Raises and clears within flapping_window logged as flapping, 0 for never
+    std::chrono::seconds flapping_window{10};
+
+    /// \returns true if no limit is set, so raises and clears can be published right away
+    bool is_passthrough() const;
+};
+
+///
+/// \brief Settings of the ErrorPublishLimiter, configured with the error_publishing entry of a module in the config
+///
+struct ErrorPublishSettings {
+    ErrorPublishLimits defaults;                   ///< Limits of all error types without an entry in types
+    std::map<ErrorType, ErrorPublishLimits> types; ///< Limits of specific error types
+
+    /// \returns the settings parsed from the error_publishing entry of a module config, if any
+    static ErrorPublishSettings parse(const nlohmann::json& module_config);
+    /// \returns true if no error type has any limit
+    bool is_passthrough() const;
+    const ErrorPublishLimits& get_limits(const ErrorType& type) const;
+};
+
+///
+/// \brief Coalesces flapping raises and clears of errors before they are published
+/// \details Only the state an error settled in is published: a raise is published once the error stayed raised for
+///          the debounce time, a clear once it stayed cleared for the hold time, and raises or clears in between
+///          cancel each other. Publishes beyond the rate limit are deferred, so the last state is always published
+///          eventually. Errors raising and clearing more often than the flapping threshold are logged when they start
+///          and stop flapping, together with the number of raises and clears that were not published.
+///          The caller calls flush() periodically to publish the transitions that became due. Raises and clears are
+///          published in the order they became due, one at a time, so the publish functions must not raise or clear
+///          errors with this limiter themselves.
+///
+class ErrorPublishLimiter {
+public:
+    using clock = std::chrono::steady_clock;
+    using PublishErrorFunc = std::function<void(const Error&)>;
+
+    ErrorPublishLimiter(ErrorPublishSettings settings, PublishErrorFunc publish_raised_error,
+                        PublishErrorFunc publish_cleared_error);
+
+    void raise_error(const Error& error, clock::time_point now = clock::now());
+    void clear_error(const Error& error, clock::time_point now = clock::now());
+
+    ///
+    /// \brief publishes all raises and clears that became due
+    /// \returns the time the next pending transition becomes due, if any
+    ///
+    std::optional<clock::time_point> flush(clock::time_point now = clock::now());
+
+private:
+    using ErrorKey = std::pair<ErrorType, ErrorSubType>;
+
+    struct ErrorState {
+        bool published_raised{false}; ///< State last published to the subscribers
+        bool raised{false};           ///< State last reported by the module
+        Error error;                  ///< Error last reported by the module
+        clock::time_point changed;    ///< Time the module last changed the state
+        double tokens{0};             ///< Publishes allowed by the rate limit
+        clock::time_point refilled;   ///< Time the tokens were last refilled
+        std::deque<clock::time_point> transitions; ///< Raises and clears within the flapping window
+        std::size_t coalesced{0};                  ///< Raises and clears not published since the last report
+        bool flapping{false};
+    };
+
+    void on_transition(const Error& error, bool raised, clock::time_point now);
+    /// \returns the time \p state becomes due, or nothing if it is published
+    std::optional<clock::time_point> get_due(const ErrorState& state, const ErrorPublishLimits& limits,
+                                             clock::time_point now) const;
+
+    ErrorPublishSettings settings;
+    PublishErrorFunc publish_raised_error;
+    PublishErrorFunc publish_cleared_error;
+
+    std::mutex publish_mutex; ///< held from collecting the due transitions until they are published, so they keep order
+    std::mutex states_mutex;
+    std::map<ErrorKey, ErrorState> states;
+};
+
+} // namespace error
+} // namespace Everest
+
+#endif // UTILS_ERROR_PUBLISH_LIMITER_HPP
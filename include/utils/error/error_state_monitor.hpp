@@ -4,15 +4,21 @@
 #ifndef UTILS_ERROR_STATE_MONITOR_HPP
 #define UTILS_ERROR_STATE_MONITOR_HPP
 
+#include <functional>
 #include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <utility>
+#include <vector>
 
 #include <utils/error.hpp>
+#include <utils/error/error_database.hpp>
 
 namespace Everest {
 namespace error {
 
-struct ErrorDatabase;
-
 ///
 /// \brief The StateMonitor class is used to monitor the state of multiple error types
 /// \details The StateMonitor class is used to monitor the state of multiple error types. It can be used to check if a
@@ -30,11 +36,21 @@ public:
         bool active;
     };
 
+    using ConditionId = std::size_t;
+    ///
+    /// \brief Called when a registered condition becomes satisfied or unsatisfied
+    /// \param satisfied True if the condition is satisfied now, false otherwise
+    ///
+    using ConditionChangedFunc = std::function<void(bool satisfied)>;
+
     ///
     /// \brief StateMonitor constructor
     /// \param error_database The error database to monitor
     ///
     explicit ErrorStateMonitor(std::shared_ptr<ErrorDatabase> error_database);
+    ~ErrorStateMonitor();
+    ErrorStateMonitor(const ErrorStateMonitor&) = delete;
+    ErrorStateMonitor& operator=(const ErrorStateMonitor&) = delete;
 
     ///
     /// \brief is_error_active checks if a certain combination of error type and sub_type is active
@@ -64,8 +80,51 @@ public:
     ///
     bool is_condition_satisfied(const std::list<StateCondition>& condition) const;
 
+    ///
+    /// \brief register_condition registers a list of conditions that is kept up to date on every change of the
+    ///        database, so transitions don't need to be polled for
+    /// \details The handler is called on every transition of the condition, not with its initial state. It is called
+    ///          from the thread changing the database and must not register or unregister conditions.
+    /// \param condition The list of conditions that all need to be satisfied
+    /// \param handler Called when the condition becomes satisfied or unsatisfied
+    /// \return The id to unregister the condition with
+    ///
+    ConditionId register_condition(const std::list<StateCondition>& condition, const ConditionChangedFunc& handler);
+
+    ///
+    /// \brief unregister_condition unregisters a condition registered with register_condition
+    /// \param id The id returned by register_condition
+    ///
+    void unregister_condition(ConditionId id);
+
+    ///
+    /// \brief is_registered_condition_satisfied returns the current state of a registered condition in O(1)
+    /// \param id The id returned by register_condition
+    /// \return True if the condition is satisfied, false otherwise
+    ///
+    bool is_registered_condition_satisfied(ConditionId id) const;
+
 private:
+    using ErrorKey = std::pair<ErrorType, ErrorSubType>;
+
+    struct CompiledCondition {
+        std::vector<StateCondition> terms;
+        std::size_t unsatisfied{0}; ///< Number of terms that are not satisfied
+        ConditionChangedFunc handler;
+    };
+
+    void on_errors_changed(const std::list<ErrorPtr>& added, const std::list<ErrorPtr>& removed);
+    /// \brief Updates the conditions depending on \p key after it became active or inactive
+    void update_conditions(const ErrorKey& key, bool active, std::vector<std::pair<ConditionChangedFunc, bool>>& calls);
+
     std::shared_ptr<ErrorDatabase> database;
+    ErrorDatabase::ChangeHandlerId change_handler_id;
+
+    mutable std::mutex conditions_mutex;
+    std::map<ErrorKey, std::set<ErrorHandle>> active_errors; ///< Handles of the active errors per type and sub type
+    std::map<ConditionId, CompiledCondition> conditions;
+    std::multimap<ErrorKey, ConditionId> conditions_by_key;
+    ConditionId next_condition_id{0};
 };
 
 } // namespace error
@@ -5,6 +5,11 @@
 #define UTILS_ERROR_TYPE_MAP_HPP
 
 #include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
 
 #include <utils/error.hpp>
 
@@ -15,6 +20,8 @@ namespace error {
 /// \brief A map of error types to their descriptions.
 /// This class is used to load error types from a directory
 /// and to get the description of an error type.
+/// The error type files of a directory are parsed on first use of one of their types, so error namespaces that are
+/// never used are never loaded. Copies of a map share the loaded error types.
 ///
 class ErrorTypeMap {
 public:
@@ -31,7 +38,7 @@ public:
     explicit ErrorTypeMap(std::filesystem::path error_types_dir);
 
     ///
-    /// \brief Loads error types from a directory.
+    /// \brief Loads error types from a directory, each error type file is parsed on first use of its namespace.
     /// \param error_types_dir The directory to load the error types from.
     ///
     void load_error_types(std::filesystem::path error_types_dir);
@@ -57,13 +64,29 @@ public:
     bool has(const ErrorType& error_type) const;
 
     ///
-    /// \brief Returns the contained ErrorType map
+    /// \brief Returns the contained ErrorType map, loading all error namespaces not loaded yet
     /// \return The error types map
     ///
-    std::map<ErrorType, std::string> get_error_types();
+    std::map<ErrorType, std::string> get_error_types() const;
+
+    ///
+    /// \brief Returns the error types of the given namespaces only
+    /// \param namespaces The namespaces, which are the part of the error types before the '/'
+    /// \return The error types map of these namespaces
+    ///
+    std::map<ErrorType, std::string> get_error_types(const std::set<std::string>& namespaces) const;
 
 private:
-    std::map<ErrorType, std::string> error_types;
+    struct Catalog {
+        std::mutex mutex;
+        std::map<ErrorType, std::string> error_types;
+        std::map<std::string, std::filesystem::path> unloaded_namespaces; ///< Error type files by their namespace
+    };
+
+    /// \brief Parses the error type file of \p error_namespace if it was not loaded yet
+    static void load_namespace_no_mutex(Catalog& catalog, const std::string& error_namespace);
+
+    std::shared_ptr<Catalog> catalog{std::make_shared<Catalog>()};
 };
 
 } // namespace error
@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_EVENT_LOOP_HPP
+#define UTILS_EVENT_LOOP_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace Everest {
+
+///
+/// \brief Single threaded event loop based on epoll, dispatching file descriptor events and timerfd based timers
+///
+/// All callbacks are executed on the thread calling run(), so they must not block. Registering and removing file
+/// descriptors and timers as well as stopping the loop is thread-safe and can also be done from within callbacks.
+///
+class EventLoop {
+public:
+    using Id = std::uint64_t;
+    using FdCallback = std::function<void(std::uint32_t events)>;
+    using TimerCallback = std::function<void()>;
+
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(EventLoop const&) = delete;
+    void operator=(EventLoop const&) = delete;
+
+    ///
+    /// \brief calls the given \p callback with the occurred epoll events whenever one of the given \p events occurs
+    /// on \p fd, the file descriptor stays owned by the caller
+    /// \returns an id identifying the registration
+    Id add_fd(int fd, std::uint32_t events, const FdCallback& callback);
+
+    ///
+    /// \brief calls the given \p callback after \p interval, repeatedly if \p periodic is set
+    /// \returns an id identifying the timer
+    Id add_timer(std::chrono::nanoseconds interval, const TimerCallback& callback, bool periodic = true);
+
+    ///
+    /// \brief removes the file descriptor registration or timer identified by \p id, after this call returns its
+    /// callback will not be called anymore unless it is currently executing
+    void remove(Id id);
+
+    ///
+    /// \brief dispatches events until stop() is called
+    void run();
+
+    ///
+    /// \brief makes run() return after the currently dispatched callbacks finished
+    void stop();
+
+private:
+    struct Entry {
+        int fd;
+        bool is_timer; ///< timer fds are owned by the entry and closed once it is no longer dispatched
+        bool periodic;
+        std::function<void(std::uint32_t events)> callback;
+
+        ~Entry();
+    };
+
+    Id add_entry(int fd, std::uint32_t events, std::shared_ptr<Entry> entry);
+
+    int epoll_fd{-1};
+    int stop_event_fd{-1};
+    std::atomic_bool stop_requested{false};
+    std::mutex entries_mutex;
+    std::unordered_map<Id, std::shared_ptr<Entry>> entries;
+    Id next_id{1}; ///< 0 is reserved for the stop event
+};
+
+} // namespace Everest
+
+#endif // UTILS_EVENT_LOOP_HPP
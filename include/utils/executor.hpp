@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_EXECUTOR_HPP
+#define UTILS_EXECUTOR_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace Everest {
+
+///
+/// \brief Thread pool running posted tasks on a small number of worker threads
+///
+/// Handlers are allowed to block, e.g. while waiting for the result of a cmd that is delivered by another task. To
+/// avoid starving such tasks, a monitor spawns additional temporary workers up to \p max_threads whenever queued tasks
+/// did not make progress for a while. Temporary workers exit again after being idle.
+///
+class Executor {
+public:
+    using Task = std::function<void()>;
+
+    /// \brief starts \p core_threads workers that can grow to at most \p max_threads while workers are blocked
+    Executor(std::size_t core_threads, std::size_t max_threads);
+    ~Executor();
+
+    Executor(Executor const&) = delete;
+    void operator=(Executor const&) = delete;
+
+    /// \brief queues the given \p task to be run on one of the workers
+    void post(Task task);
+
+    /// \returns the number of currently running worker threads
+    std::size_t get_thread_count();
+
+    /// \returns the number of worker threads used by default, which is the number of available cores
+    static std::size_t default_thread_count();
+
+private:
+    void run_worker(bool temporary);
+    void run_monitor();
+    void cleanup_finished_workers();
+
+    std::mutex mutex;
+    std::condition_variable tasks_available;
+    std::condition_variable monitor_wakeup;
+    std::deque<Task> tasks;
+    std::list<std::thread> workers;
+    std::list<std::thread::id> finished_workers;
+    std::size_t max_threads;
+    std::size_t idle_workers{0};
+    std::size_t completed_tasks{0};
+    bool running{true};
+    std::thread monitor;
+};
+
+///
+/// \brief Runs posted tasks on an Executor, but at most \p max_concurrent_tasks of them at the same time
+///
+/// Tasks posted with the same non-empty key are additionally run one after another in the order they were posted, so
+/// they behave as if they were posted to their own strand that shares the concurrency limit with all other tasks.
+///
+class ConcurrencyLimiter : public std::enable_shared_from_this<ConcurrencyLimiter> {
+public:
+    /// \brief Creates a limiter running at most \p max_concurrent_tasks on the given \p executor. Must be owned by a
+    /// std::shared_ptr
+    ConcurrencyLimiter(Executor& executor, std::size_t max_concurrent_tasks);
+
+    /// \brief queues the given \p task, it is not run concurrently to other tasks posted with the same non-empty
+    /// \p key
+    void post(const std::string& key, Executor::Task task);
+
+    /// \returns the number of tasks waiting for a free slot or for the previous task with the same key
+    std::size_t get_pending_count();
+
+private:
+    void start_pending_tasks();
+    void finish_task(const std::string& key);
+
+    Executor& executor;
+    std::size_t max_concurrent_tasks;
+    std::mutex mutex;
+    std::deque<std::pair<std::string, Executor::Task>> pending_tasks;
+    std::set<std::string> running_keys;
+    std::size_t running_tasks{0};
+};
+
+} // namespace Everest
+
+#endif // UTILS_EXECUTOR_HPP
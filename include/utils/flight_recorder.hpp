@@ -0,0 +1,156 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_FLIGHT_RECORDER_HPP
+#define UTILS_FLIGHT_RECORDER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include <utils/types.hpp>
+
+namespace Everest {
+
+/// \brief Kind of a framework event recorded by the FlightRecorder
+enum class FlightEvent : std::uint8_t {
+    Dispatch = 1, ///< a handler was called with a received message
+    Publish,      ///< a message was published
+    CmdResult,    ///< a synchronous cmd call got its result
+    CmdTimeout,   ///< a synchronous cmd call timed out
+};
+
+/// \returns the snake case name of the given \p event
+std::string flight_event_to_string(FlightEvent event);
+
+///
+/// \brief Compact binary record of a framework event, stored as is in the ring buffer and in dumps
+/// \details Topics longer than the record keep their end, which names the cmd or var
+///
+struct FlightRecord {
+    static constexpr std::size_t topic_capacity = 68;
+    static constexpr std::size_t call_id_capacity = 36; ///< fits a UUID
+
+    std::int64_t timestamp_ns;    ///< system clock time of the event
+    std::uint32_t duration_us;    ///< time the handler or cmd call took, 0 for publishes
+    FlightEvent event;
+    std::uint8_t handler_type;    ///< HandlerType of dispatched messages
+    std::uint8_t topic_size;
+    std::uint8_t call_id_size;
+    char call_id[call_id_capacity];
+    char topic[topic_capacity];
+};
+
+/// \brief Slot of the ring buffer of the FlightRecorder
+struct alignas(64) FlightRecorderSlot {
+    std::atomic<std::uint64_t> sequence; ///< sequence number + 1 of the complete record, 0 while it is written
+    FlightRecord record;
+};
+static_assert(sizeof(FlightRecorderSlot) == 128, "a slot should fill two cache lines, dumps depend on its size");
+
+///
+/// \brief Header of a flight recorder dump, which is followed by the raw slots of the ring buffer
+///
+struct FlightRecorderDumpHeader {
+    static constexpr std::uint32_t current_version = 1;
+    static constexpr std::size_t module_id_capacity = 64;
+    static constexpr std::size_t reason_capacity = 32;
+
+    char magic[8];                  ///< "EVFLREC" and a terminating 0
+    std::uint32_t version;
+    std::uint32_t slot_size;        ///< size of a slot, to detect dumps of an incompatible build
+    std::uint64_t capacity;         ///< number of slots following the header
+    std::uint64_t next_sequence;    ///< sequence number of the next record at the time of the dump
+    std::int64_t dump_timestamp_ns; ///< system clock time of the dump
+    std::int32_t pid;
+    std::uint32_t reserved;
+    char module_id[module_id_capacity];
+    char reason[reason_capacity];
+};
+
+///
+/// \brief A decoded flight recorder dump
+///
+struct FlightRecording {
+    std::string module_id;
+    std::string reason;
+    std::int32_t pid{0};
+    std::int64_t dump_timestamp_ns{0};
+    std::uint64_t lost_records{0}; ///< records that were overwritten, because the ring buffer was full
+    std::vector<FlightRecord> records; ///< oldest first
+};
+
+///
+/// \brief Settings of the FlightRecorder, configured with the flight_recorder entry of a module in the config
+///
+struct FlightRecorderSettings {
+    std::size_t records{0}; ///< Number of the most recent events that are kept, the recorder is disabled if 0
+    std::string file;       ///< File the events are dumped to
+
+    /// \returns the settings parsed from the flight_recorder entry of the config of the module \p module_id, if any
+    static FlightRecorderSettings parse(const nlohmann::json& module_config, const std::string& module_id);
+};
+
+///
+/// \brief Records the last framework events of this process in a lock-free ring buffer, so they can be inspected after
+/// a crash even if verbose logging was disabled
+/// \details The events are dumped to file when the process crashes with a fatal signal, when a critical message is
+///          logged, or on SIGUSR2. Writers claim a slot with a single atomic increment and mark it complete with its
+///          sequence number, dumps only copy the raw memory of the ring buffer and are async-signal-safe. A record
+///          written while it is dumped can be torn, which the decoder detects by its sequence number. Without a
+///          configured recorder an event only costs the check of a pointer.
+///
+class FlightRecorder {
+public:
+    /// \returns the flight recorder of this process
+    static FlightRecorder& get();
+
+    ///
+    /// \brief allocates the ring buffer and installs the signal handlers and the log sink dumping it
+    /// \details The recorder can only be configured once per process, later calls are ignored
+    ///
+    void configure(const FlightRecorderSettings& settings, const std::string& module_id);
+
+    /// \returns true if events are recorded
+    bool is_enabled() const {
+        return this->slots.load(std::memory_order_relaxed) != nullptr;
+    }
+
+    void record(FlightEvent event, HandlerType handler_type, std::string_view topic, std::string_view call_id,
+                std::chrono::nanoseconds duration);
+
+    ///
+    /// \brief writes the ring buffer to the configured file, safe to call from a signal handler
+    /// \returns true if the dump was written
+    ///
+    bool dump(const char* reason) noexcept;
+
+private:
+    FlightRecorder() = default;
+
+    std::atomic<FlightRecorderSlot*> slots{nullptr};
+    std::size_t capacity{0};
+    std::atomic<std::uint64_t> next_sequence{0};
+    std::atomic_flag dumping = ATOMIC_FLAG_INIT;
+    FlightRecorderDumpHeader header{};
+    char file[4096]{}; ///< copied, so no allocation is needed while dumping
+};
+
+///
+/// \brief decodes a flight recorder dump from \p stream
+/// \throws EverestInternalError if \p stream does not contain a dump of a compatible build
+///
+FlightRecording decode_flight_recording(std::istream& stream);
+
+/// \returns the \p record as JSON, with its handler type, topic and call id as strings
+nlohmann::json to_json(const FlightRecord& record);
+
+} // namespace Everest
+
+#endif // UTILS_FLIGHT_RECORDER_HPP
@@ -0,0 +1,45 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_FRAMEWORK_LOG_HPP
+#define UTILS_FRAMEWORK_LOG_HPP
+
+#include <fmt/format.h>
+
+#include <everest/logging.hpp>
+
+// Logging of the hot paths of the framework, which can be compiled out with the EVEREST_FRAMEWORK_LOG_LEVEL and
+// EVEREST_FRAMEWORK_LOG_SCOPES CMake options. Everything is compiled in if they are not defined.
+
+/// Lowest level of the messages that are compiled in: 0 for verbose, 1 for debug, 2 for info
+#ifndef EVEREST_FRAMEWORK_LOG_LEVEL
+#define EVEREST_FRAMEWORK_LOG_LEVEL 0
+#endif
+
+/// 1 if the named scopes of the framework functions are tracked for log messages
+#ifndef EVEREST_FRAMEWORK_LOG_SCOPES
+#define EVEREST_FRAMEWORK_LOG_SCOPES 1
+#endif
+
+/// \brief Pushes the named scope of the calling function, like BOOST_LOG_FUNCTION() if scopes are tracked
+#if EVEREST_FRAMEWORK_LOG_SCOPES
+#define FRAMEWORK_LOG_FUNCTION() BOOST_LOG_FUNCTION()
+#else
+#define FRAMEWORK_LOG_FUNCTION() static_cast<void>(0)
+#endif
+
+// The format arguments are only evaluated if the message is compiled in and the record is opened by the logger, so
+// strings such as printable identifiers are not built for discarded messages. Disabled levels are removed as dead code.
+
+/// \brief Logs the message formatted from the fmt::format() arguments with the verbose level
+#define FRAMEWORK_LOG_VERBOSE(...)                                                                                     \
+    if (EVEREST_FRAMEWORK_LOG_LEVEL > 0) {                                                                             \
+    } else                                                                                                             \
+        EVLOG_verbose << fmt::format(__VA_ARGS__)
+
+/// \brief Logs the message formatted from the fmt::format() arguments with the debug level
+#define FRAMEWORK_LOG_DEBUG(...)                                                                                       \
+    if (EVEREST_FRAMEWORK_LOG_LEVEL > 1) {                                                                             \
+    } else                                                                                                             \
+        EVLOG_debug << fmt::format(__VA_ARGS__)
+
+#endif // UTILS_FRAMEWORK_LOG_HPP
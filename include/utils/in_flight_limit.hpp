@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_IN_FLIGHT_LIMIT_HPP
+#define UTILS_IN_FLIGHT_LIMIT_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+#include <nlohmann/json.hpp>
+
+namespace Everest {
+
+/// \brief What happens to calls exceeding the limit of an InFlightLimit
+enum class InFlightOverflow {
+    Queue,  ///< wait for a free slot
+    Reject, ///< fail right away
+};
+
+/// \brief Counters of an InFlightLimit
+struct InFlightStats {
+    std::size_t max_in_flight{0};
+    std::size_t in_flight{0};  ///< Calls holding a slot right now
+    std::size_t queued{0};     ///< Calls waiting for a free slot right now
+    std::uint64_t admitted{0}; ///< Calls that got a slot so far, including formerly queued ones
+    std::uint64_t rejected{0}; ///< Calls that failed right away because no slot was free
+    std::uint64_t expired{0};  ///< Queued calls that gave up waiting for a slot
+};
+
+///
+/// \brief Admission control for calls that stay in flight until their result arrives, allowing at most
+/// \p max_in_flight of them at the same time
+///
+/// Queued calls are started in the order they were queued by the thread finishing the call whose slot they get.
+///
+class InFlightLimit {
+public:
+    /// \brief Starts a call once it got a slot, returns false if it has been given up in the meantime, so its slot is
+    /// passed on
+    using Start = std::function<bool()>;
+
+    InFlightLimit(std::size_t max_in_flight, InFlightOverflow overflow);
+
+    ///
+    /// \brief Runs \p start right away if a slot is free, otherwise queues it until a slot becomes free
+    /// \returns false if \p start has been rejected and will never run
+    ///
+    bool admit(Start start);
+
+    ///
+    /// \brief Blocks until a slot is free
+    /// \returns false if the call has been rejected or no slot became free until \p deadline
+    ///
+    bool acquire_until(std::chrono::steady_clock::time_point deadline);
+
+    /// \brief frees the slot of a call started by admit() or acquire_until() and passes it to the next queued call
+    void release();
+
+    InFlightStats get_stats();
+
+private:
+    std::size_t max_in_flight;
+    InFlightOverflow overflow;
+    std::mutex mutex;
+    std::deque<Start> queue;
+    InFlightStats stats;
+};
+
+void to_json(nlohmann::json& j, const InFlightStats& stats);
+
+} // namespace Everest
+
+#endif // UTILS_IN_FLIGHT_LIMIT_HPP
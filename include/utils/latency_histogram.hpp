@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_LATENCY_HISTOGRAM_HPP
+#define UTILS_LATENCY_HISTOGRAM_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include <nlohmann/json.hpp>
+
+namespace Everest {
+
+/// \brief Percentiles of the durations recorded in a LatencyHistogram
+struct LatencySummary {
+    std::uint64_t count{0};          ///< Number of recorded durations
+    std::chrono::nanoseconds mean{}; ///< Average of all recorded durations
+    std::chrono::nanoseconds p50{};  ///< Median
+    std::chrono::nanoseconds p90{};
+    std::chrono::nanoseconds p99{};
+    std::chrono::nanoseconds p999{};
+    std::chrono::nanoseconds max{};  ///< Longest recorded duration
+};
+
+///
+/// \brief Histogram of durations with logarithmic buckets, similar to a HDR histogram with three significant binary
+/// digits
+///
+/// Every power of two is split into 8 linear sub buckets, so reported percentiles are at most 12.5% too large for any
+/// duration from 1 ns up to about 18 minutes. Recording is lock-free and does not allocate, so it can be done from any
+/// thread on the hot path.
+///
+class LatencyHistogram {
+public:
+    /// \brief adds the given \p duration, negative durations are recorded as 0
+    void record(std::chrono::nanoseconds duration);
+
+    /// \returns the percentiles of all durations recorded so far
+    LatencySummary get_summary() const;
+
+private:
+    static constexpr std::size_t sub_bucket_bits = 3;
+    static constexpr std::size_t sub_bucket_count = std::size_t{1} << sub_bucket_bits;
+    static constexpr std::size_t max_value_bits = 40;
+    static constexpr std::size_t bucket_count = (max_value_bits - sub_bucket_bits + 1) * sub_bucket_count;
+
+    static std::size_t bucket_index(std::uint64_t value);
+    static std::uint64_t bucket_upper_bound(std::size_t index);
+
+    std::array<std::atomic<std::uint64_t>, bucket_count> buckets{};
+    std::atomic<std::uint64_t> count{0};
+    std::atomic<std::uint64_t> sum{0};
+    std::atomic<std::uint64_t> max{0};
+};
+
+void to_json(nlohmann::json& j, const LatencySummary& summary);
+
+} // namespace Everest
+
+#endif // UTILS_LATENCY_HISTOGRAM_HPP
@@ -0,0 +1,41 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_MEMORY_ACCOUNTING_HPP
+#define UTILS_MEMORY_ACCOUNTING_HPP
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+namespace Everest {
+
+///
+/// \returns an estimate of the bytes held by \p value, including the node itself and everything allocated for its
+/// strings, arrays and objects
+/// \details The estimate is based on the sizes of the standard library containers used by nlohmann::json and does not
+///          account for the overhead of the allocator, so it is meant for comparing subsystems, not for exact numbers
+///
+std::size_t estimate_json_bytes(const nlohmann::json& value);
+
+/// \brief Estimated memory of one subsystem of a module
+struct SubsystemMemory {
+    std::size_t bytes{0};                              ///< Estimated bytes held by the subsystem
+    nlohmann::json details = nlohmann::json::object(); ///< Counts and sizes the estimate is based on
+};
+
+/// \brief Estimated memory of a module by subsystem, see Everest::get_memory_report()
+struct MemoryReport {
+    std::map<std::string, SubsystemMemory> subsystems; ///< By name of the subsystem
+
+    /// \returns the sum of the bytes of all subsystems
+    std::size_t total_bytes() const;
+};
+
+void to_json(nlohmann::json& j, const SubsystemMemory& memory);
+void to_json(nlohmann::json& j, const MemoryReport& report);
+
+} // namespace Everest
+
+#endif // UTILS_MEMORY_ACCOUNTING_HPP
@@ -3,18 +3,29 @@
 #ifndef UTILS_MESSAGE_QUEUE_HPP
 #define UTILS_MESSAGE_QUEUE_HPP
 
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
-#include <queue>
+#include <optional>
+#include <string>
 #include <thread>
-#include <unordered_set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 
+#include <utils/bounded_queue.hpp>
+#include <utils/executor.hpp>
+#include <utils/latency_histogram.hpp>
+#include <utils/payload_encoding.hpp>
 #include <utils/types.hpp>
 
 namespace Everest {
@@ -22,63 +33,267 @@ namespace Everest {
 struct Message {
     std::string topic;   ///< The MQTT topic where this message originated from
     std::string payload; ///< The message payload
+    std::chrono::steady_clock::time_point received{}; ///< Only set if dispatch latencies are recorded
 };
 
 struct ParsedMessage {
     std::string topic;
     json data;
+    std::chrono::steady_clock::time_point received{};   ///< Only set if dispatch latencies are recorded
+    std::chrono::steady_clock::time_point dispatched{}; ///< Only set if dispatch latencies are recorded
+    bool raw{false};       ///< The payload of a message on an external topic has not been parsed, data is not set
+    std::string payload{}; ///< Only set if raw
 };
 
+constexpr auto HANDLER_TYPE_COUNT = static_cast<std::size_t>(HandlerType::Unknown) + 1;
+
+/// \returns the snake case name of the given handler \p type used in metrics
+std::string handler_type_to_string(HandlerType type);
+
+/// \brief Latency histograms of the stages the messages of a topic pass between the MQTT client and its handlers
+struct DispatchLatencies {
+    LatencyHistogram receive_queue; ///< Received from the broker until parsing started
+    LatencyHistogram parse;         ///< Parsing until the message has been added to the handler queue of the topic
+    LatencyHistogram handler_queue; ///< Added to the handler queue until the handlers are called
+    std::array<LatencyHistogram, HANDLER_TYPE_COUNT> handlers; ///< Run time of the handlers by HandlerType
+};
+
+/// \brief Dispatch latencies and handler queue statistics of a topic
+struct DispatchMetrics {
+    LatencySummary receive_queue;                   ///< Received from the broker until parsing started
+    LatencySummary parse;                           ///< Parsing until the message has been added to the handler queue
+    LatencySummary handler_queue;                   ///< Added to the handler queue until the handlers are called
+    std::map<HandlerType, LatencySummary> handlers; ///< Run time of the handlers that have been called by HandlerType
+    QueueStats queue;                               ///< Fill level and overflow counters of the handler queue
+};
+
+void to_json(json& j, const DispatchMetrics& metrics);
+
+/// \brief Accumulated wall clock and CPU time of the handlers of a topic registered with the same HandlerType and name
+struct HandlerAccountingStats {
+    HandlerType type{HandlerType::Unknown};
+    std::string name;                    ///< cmd or var name, empty for handlers receiving all messages of the topic
+    std::uint64_t calls{0};              ///< Number of handler calls
+    std::chrono::nanoseconds wall{};     ///< Wall clock time spent in the handlers
+    std::chrono::nanoseconds cpu{};      ///< CPU time of the handler threads spent in the handlers
+    std::chrono::nanoseconds max_wall{}; ///< Longest single call
+    std::uint64_t over_budget{0};        ///< Number of calls that exceeded the handler budget
+};
+
+void to_json(json& j, const HandlerAccountingStats& stats);
+
 using MessageCallback = std::function<void(const Message&)>;
 
+class MessagePool;
+
+/// \brief Returns a Message to the MessagePool it was acquired from instead of deleting it
+struct MessageRecycler {
+    MessagePool* pool{nullptr};
+
+    void operator()(Message* message) const;
+};
+
+/// \brief A Message that is handed back to its MessagePool once it is no longer referenced
+using PooledMessage = std::unique_ptr<Message, MessageRecycler>;
+
+/// \brief Allocation statistics of a MessagePool
+struct MessagePoolStats {
+    std::size_t allocations; ///< Number of Messages that had to be allocated on the heap
+    std::size_t reuses;      ///< Number of Messages that were served from the pool without allocating
+    std::size_t discarded;   ///< Number of Messages that were freed instead of being returned to the pool
+    std::size_t pooled;      ///< Number of Messages currently waiting in the pool
+};
+
+/// \brief Pool of recycled Messages. Topic and payload strings of recycled Messages keep their capacity, so that
+/// copying a received message out of the MQTT receive buffer does not allocate once the pool is warmed up
+class MessagePool {
+private:
+    std::vector<std::unique_ptr<Message>> free_messages;
+    std::mutex free_messages_mutex;
+    std::size_t max_pooled_messages;
+    std::size_t max_pooled_capacity;
+    std::atomic<std::size_t> allocations{0};
+    std::atomic<std::size_t> reuses{0};
+    std::atomic<std::size_t> discarded{0};
+
+public:
+    /// \brief Creates a message pool keeping at most \p max_pooled_messages recycled Messages. Messages with a
+    /// payload capacity larger than \p max_pooled_capacity are freed instead of being recycled
+    MessagePool(std::size_t max_pooled_messages, std::size_t max_pooled_capacity);
+
+    /// \brief Copies the given \p topic and \p payload into a pooled Message
+    PooledMessage acquire(const char* topic, std::size_t topic_size, const char* payload, std::size_t payload_size);
+
+    /// \brief Hands the given \p message back to the pool
+    void recycle(Message* message);
+
+    /// \returns the allocation statistics of this pool
+    MessagePoolStats get_stats();
+};
+
+/// \brief Priority classes of received messages, every class is queued separately
+enum class MessagePriority {
+    Command,   ///< cmd calls and results
+    Lifecycle, ///< ready signals, config, errors and all other framework messages
+    Var,       ///< vars
+    External   ///< external MQTT messages
+};
+
+/// \brief returns the priority class of a received message
+using MessageClassifier = std::function<MessagePriority(const Message&)>;
+
 /// \brief Simple message queue that takes std::string messages, parsed them and dispatches them to handlers
+///
+/// Every priority class has its own queue. cmd and lifecycle messages are always delivered first and are never
+/// limited, so their latency stays bounded under data plane load. Vars and external messages share the remaining
+/// capacity by weight, so neither of them can starve the other.
+///
+/// Messages are taken out of the queues in batches, so the worker takes every lock once per batch instead of once per
+/// message, and it is only woken up if it could have run out of messages.
 class MessageQueue {
 
 private:
+    static constexpr std::size_t lane_count = 4;
+    static constexpr std::size_t control_batch = 16; ///< Maximum number of cmd or lifecycle messages per batch
+    static constexpr std::size_t var_batch = 16;     ///< Maximum number of vars delivered between control batches
+    static constexpr std::size_t external_batch = 4; ///< Maximum number of external messages per var batch
+
     std::thread worker_thread;
-    std::queue<std::unique_ptr<Message>> message_queue;
-    std::mutex queue_ctrl_mutex;
+    std::array<std::unique_ptr<BoundedQueue<PooledMessage>>, lane_count> lanes; ///< Queues by MessagePriority
     MessageCallback message_callback;
-    std::condition_variable cv;
-    bool running;
+    MessageClassifier classifier;
+    std::mutex pending_mutex;
+    std::condition_variable pending_cv;
+    std::atomic_bool pending{false}; ///< Messages have been added since the worker last looked at the queues
+    bool stopped{false};
+
+    BoundedQueue<PooledMessage>& lane(MessagePriority priority);
+    void next_batch(std::vector<PooledMessage>& batch);
 
 public:
-    /// \brief Creates a message queue with the provided \p message_callback
-    explicit MessageQueue(MessageCallback);
+    /// \brief Creates a message queue with the provided \p message_callback. Messages are sorted into priority
+    /// classes by the optional \p classifier, without one all messages are treated as external messages. The queues of
+    /// vars and external messages are limited by the given \p settings and conflated by the topic returned by the
+    /// optional \p conflation_key
+    explicit MessageQueue(MessageCallback, const QueueSettings& settings = {},
+                          BoundedQueue<PooledMessage>::ConflationKey conflation_key = nullptr,
+                          MessageClassifier classifier = nullptr);
     ~MessageQueue();
 
     /// \brief Adds a \p message to the message queue which will then be delivered to the message callback
-    void add(std::unique_ptr<Message>);
+    void add(PooledMessage);
 
-    /// \brief Stops the message queue
+    /// \brief Stops the message queue and waits until the message callback returned, no message is delivered afterwards
     void stop();
+
+    /// \returns the fill level and overflow counters of all queues
+    QueueStats get_stats();
 };
 
 /// \brief Contains a message queue driven list of handler callbacks
-class MessageHandler {
+///
+/// Messages are handled on a shared Executor. At most one task per MessageHandler is scheduled at a time, so the
+/// messages of a topic are still delivered in order and never concurrently, like a strand.
+class MessageHandler : public std::enable_shared_from_this<MessageHandler> {
 private:
-    std::unordered_set<std::shared_ptr<TypedHandler>> handlers;
-    std::thread handler_thread;
-    std::queue<std::shared_ptr<ParsedMessage>> message_queue;
-    std::mutex handler_ctrl_mutex;
-    std::mutex handler_list_mutex;
-    std::condition_variable cv;
-    bool running;
+    using HandlerList = std::vector<std::shared_ptr<TypedHandler>>;
 
-public:
-    /// \brief Creates the message handler
-    MessageHandler();
+    /// \brief Counters of a HandlerAccountingStats, updated by the handler threads without locking
+    struct HandlerAccounting {
+        HandlerType type;
+        std::string name;
+        std::atomic<std::uint64_t> calls{0};
+        std::atomic<std::uint64_t> wall_ns{0};
+        std::atomic<std::uint64_t> cpu_ns{0};
+        std::atomic<std::uint64_t> max_wall_ns{0};
+        std::atomic<std::uint64_t> over_budget{0};
+    };
+
+    /// \brief The handler currently being called, at most one handler of a MessageHandler runs at a time
+    struct RunningHandler {
+        HandlerAccounting* accounting{nullptr}; ///< nullptr if no accounted handler is running
+        std::chrono::steady_clock::time_point started;
+        bool reported{false}; ///< The watchdog already warned about this call
+    };
+
+    /// \brief Immutable snapshot of the registered handlers, which is replaced as a whole when handlers are added or
+    /// removed, so dispatching messages neither locks nor copies any handlers
+    ///
+    /// Handlers are indexed by what they are matched against, so dispatching does not depend on the number of
+    /// registered handlers, e.g. the result handlers of many concurrent calls
+    struct HandlerIndex {
+        std::unordered_map<std::string, HandlerList> call_handlers;   ///< Call handlers by cmd name
+        /// Result handlers by call id, handlers without a call id and cmd name receive all results of the topic
+        std::unordered_map<std::string, HandlerList> result_handlers;
+        std::unordered_map<std::string, HandlerList> var_handlers;    ///< SubscribeVar handlers by var name
+        HandlerList other_handlers; ///< All other handlers, receiving every message without preprocessing
+        std::size_t handler_count{0};
+        /// Accounting records of the handlers, only filled if handlers are accounted
+        std::unordered_map<const TypedHandler*, HandlerAccounting*> accounting;
+
+        HandlerList& find_handler_list(const TypedHandler& handler);
+        void erase_empty_handler_list(const TypedHandler& handler);
+    };
 
-    /// \brief Destructor
-    ~MessageHandler();
+    std::shared_ptr<const HandlerIndex> handlers; ///< Only accessed with std::atomic_load and std::atomic_store
+    Executor& executor;
+    std::unique_ptr<DispatchLatencies> latencies; ///< nullptr unless dispatch latencies are recorded
+    BoundedQueue<std::shared_ptr<ParsedMessage>> message_queue;
+    std::atomic_bool scheduled{false};
+    std::mutex handler_list_mutex; ///< Serializes modifications of the handler index
+    bool account_handlers;
+    std::chrono::nanoseconds handler_budget;
+    std::mutex accounting_mutex; ///< Protects accounting_records and running_handler
+    /// Records are kept after their handlers have been removed, so the report covers the whole run time
+    std::map<std::pair<HandlerType, std::string>, std::unique_ptr<HandlerAccounting>> accounting_records;
+    RunningHandler running_handler;
+    bool cache_vars;
+    std::mutex var_cache_mutex; ///< Protects var_cache and pending_replays
+    /// The last var message by var name, only filled if vars are cached
+    std::unordered_map<std::string, std::shared_ptr<const ParsedMessage>> var_cache;
+    /// Var handlers added since the last delivery, which still get the cached value of their var
+    std::vector<std::shared_ptr<TypedHandler>> pending_replays;
+    std::atomic_bool replays_pending{false};
+
+    void schedule();
+    void drain();
+    void handle(const ParsedMessage& message);
+    void cache_var(const std::shared_ptr<ParsedMessage>& message);
+    void replay_cached_vars();
+    void update_handlers(const std::function<void(HandlerIndex&)>& update);
+    HandlerAccounting* get_accounting_record(const TypedHandler& handler);
+    void account_handler_call(const std::string& topic, HandlerAccounting& accounting,
+                              std::chrono::steady_clock::time_point started, std::chrono::nanoseconds cpu_started);
+
+public:
+    /// \brief Creates the message handler running its handlers on the given \p executor, with a queue limited by the
+    /// given \p settings. Vars are conflated by their name, external messages by their topic and cmd calls and
+    /// results are never conflated. Dispatch latencies are only recorded if \p record_latencies is set and the wall
+    /// clock and CPU time of every handler only if \p account_handlers is set. Calls taking longer than a non-zero
+    /// \p handler_budget are logged. If \p cache_vars is set, the last value of every var on this topic is kept and
+    /// delivered right away to var handlers added later. Must be owned by a std::shared_ptr
+    explicit MessageHandler(Executor& executor, const QueueSettings& settings = {}, bool record_latencies = false,
+                            bool account_handlers = false, std::chrono::nanoseconds handler_budget = {},
+                            bool cache_vars = false);
 
     /// \brief Adds a \p message to the message queue which will be delivered to the registered handlers
     void add(std::shared_ptr<ParsedMessage>);
 
-    /// \brief Stops the message handler
+    /// \returns true if any registered handler would receive a message with the given \p envelope
+    bool wants_message(const PayloadEnvelope& envelope);
+
+    /// \returns true if all registered handlers only receive the results of specific calls, so the messages of this
+    /// topic can be filtered by their result id alone
+    bool filters_results();
+
+    /// \returns true if a handler is registered for the result of the call with the given \p id
+    bool wants_result(const std::string& id);
+
+    /// \brief Stops the message handler, messages that have not been delivered yet are discarded
     void stop();
 
-    /// \brief Adds a \p handler that will receive messages from the queue.
+    /// \brief Adds a \p handler that will receive messages from the queue. A var handler first receives the cached
+    /// value of its var, if vars are cached and the var has been received before
     void add_handler(std::shared_ptr<TypedHandler> handler);
 
     /// \brief Removes a specific \p handler
@@ -86,6 +301,53 @@ public:
 
     /// \brief \returns the number of registered handlers
     std::size_t count_handlers();
+
+    /// \returns the fill level and overflow counters of the queue
+    QueueStats get_stats();
+
+    /// \returns the number of vars whose last value is cached
+    std::size_t count_cached_vars();
+
+    /// \returns the latency histograms of this topic, nullptr if latencies are not recorded
+    DispatchLatencies* get_latencies();
+
+    /// \returns the dispatch latencies and queue statistics of this topic
+    DispatchMetrics get_metrics();
+
+    /// \returns the wall clock and CPU time spent in the handlers of this topic, empty if handlers are not accounted
+    std::vector<HandlerAccountingStats> get_handler_accounting();
+
+    /// \brief Logs a warning if the handler that is currently running on the given \p topic has exceeded the
+    /// handler budget at the given time \p now, at most once per call
+    void check_handler_budget(const std::string& topic, std::chrono::steady_clock::time_point now);
+};
+
+/// \brief Single pending slot delivering only the latest of the values stored in it to a callback running on an
+/// Executor
+///
+/// Values stored while the callback is still busy with a previous value replace each other, so a slow callback neither
+/// builds up a backlog nor delays the other handlers of the topic the values were received on.
+class LatestValueSlot : public std::enable_shared_from_this<LatestValueSlot> {
+private:
+    Executor& executor;
+    std::function<void(const json&)> callback;
+    std::mutex slot_mutex;
+    std::optional<json> value;
+    bool delivering{false}; ///< A task delivering the slot to the callback has been posted and not finished yet
+    std::atomic<std::size_t> conflated{0};
+
+    void deliver();
+
+public:
+    /// \brief Creates a slot delivering its values to the given \p callback on the given \p executor. Must be owned
+    /// by a std::shared_ptr
+    LatestValueSlot(Executor& executor, std::function<void(const json&)> callback);
+
+    /// \brief Stores the given \p value, replacing a value that has not been delivered yet
+    void store(json value);
+
+    /// \returns the number of values that have been replaced before they could be delivered
+    std::size_t get_conflated_count();
 };
 
 } // namespace Everest
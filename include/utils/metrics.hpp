@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_METRICS_HPP
+#define UTILS_METRICS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <variant>
+
+#include <nlohmann/json.hpp>
+
+#include <utils/latency_histogram.hpp>
+
+namespace Everest {
+
+using MetricLabels = std::map<std::string, std::string>;
+
+/// \brief Monotonically increasing count, e.g. of calls or reconnects
+class Counter {
+public:
+    void increment(std::uint64_t n = 1) {
+        this->value.fetch_add(n, std::memory_order_relaxed);
+    }
+    std::uint64_t get() const {
+        return this->value.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<std::uint64_t> value{0};
+};
+
+/// \brief Value that goes up and down, e.g. a queue depth
+class Gauge {
+public:
+    void set(double value_) {
+        this->value.store(value_, std::memory_order_relaxed);
+    }
+    void add(double delta) {
+        auto current = this->value.load(std::memory_order_relaxed);
+        while (not this->value.compare_exchange_weak(current, current + delta, std::memory_order_relaxed)) {
+        }
+    }
+    double get() const {
+        return this->value.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<double> value{0};
+};
+
+///
+/// \brief Registry of the counters, gauges and latency histograms of a module
+/// \details Looking up a metric takes a lock, the returned references stay valid as long as the registry, so they are
+///          looked up once and updated lock-free on the hot path. A metric is identified by its name and labels and
+///          can only be registered with one type.
+///
+class MetricsRegistry {
+public:
+    /// \throws EverestInternalError if \p name is already registered as a different type
+    Counter& counter(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+    /// \throws EverestInternalError if \p name is already registered as a different type
+    Gauge& gauge(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+    /// \throws EverestInternalError if \p name is already registered as a different type
+    LatencyHistogram& histogram(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+
+    ///
+    /// \returns the current values of all metrics as array of json samples, which can be published and passed to
+    ///          to_openmetrics() by another process
+    /// \param labels labels added to every sample, e.g. the id of the module
+    ///
+    nlohmann::json get_snapshot(const MetricLabels& labels = {}) const;
+
+private:
+    struct Metric {
+        std::string name;
+        std::string help;
+        MetricLabels labels;
+        std::variant<std::unique_ptr<Counter>, std::unique_ptr<Gauge>, std::unique_ptr<LatencyHistogram>> value;
+    };
+
+    template <typename T> T& get_or_add(const std::string& name, const std::string& help, const MetricLabels& labels);
+
+    mutable std::mutex metrics_mutex;
+    std::map<std::pair<std::string, MetricLabels>, Metric> metrics; ///< by name and labels
+    std::map<std::string, std::size_t> types;                     ///< variant index of every registered name
+};
+
+///
+/// \returns the given json \p samples of one or more snapshots in the OpenMetrics text format, samples of the same
+///          metric in different snapshots are grouped in one metric family
+///
+std::string to_openmetrics(const nlohmann::json& samples);
+
+} // namespace Everest
+
+#endif // UTILS_METRICS_HPP
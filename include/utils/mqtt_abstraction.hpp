@@ -4,10 +4,16 @@
 #define UTILS_MQTT_ABSTRACTION_HPP
 
 #include <future>
+#include <map>
+#include <memory>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 
+#include <utils/event_loop.hpp>
+#include <utils/message_queue.hpp>
 #include <utils/mqtt_settings.hpp>
+#include <utils/traffic_recorder.hpp>
 #include <utils/types.hpp>
 
 namespace Everest {
@@ -16,6 +22,11 @@ class MQTTAbstractionImpl;
 
 ///
 /// \brief Contains a C++ abstraction for using MQTT in EVerest modules
+/// \details With broker shards configured in the MQTTSettings, every publish goes to the broker carrying its topic and
+///          every subscription to all brokers carrying topics matching it. The messages received from the shards are
+///          dispatched by the main broker connection, so all handlers run on its handler executor and a handler is
+///          never called concurrently, even if its topic spans several brokers. Timers and all statistics other than
+///          those of the send and receive buffers are the ones of the main broker connection as well.
 ///
 class MQTTAbstraction {
 public:
@@ -52,6 +63,26 @@ public:
     /// \copydoc MQTTAbstractionImpl::publish(const std::string&, const std::string&, QOS)
     void publish(const std::string& topic, const std::string& data, QOS qos, bool retain = false);
 
+    ///
+    /// \copydoc MQTTAbstractionImpl::publish_raw(const std::string&, std::string_view, QOS, bool)
+    void publish_raw(const std::string& topic, std::string_view payload, QOS qos, bool retain = false);
+
+    ///
+    /// \copydoc MQTTAbstractionImpl::begin_publish_batch()
+    void begin_publish_batch();
+
+    ///
+    /// \copydoc MQTTAbstractionImpl::end_publish_batch()
+    void end_publish_batch();
+
+    ///
+    /// \copydoc MQTTAbstractionImpl::set_publish_flush_policy(const PublishFlushPolicy&)
+    void set_publish_flush_policy(const PublishFlushPolicy& policy);
+
+    ///
+    /// \copydoc MQTTAbstractionImpl::get_payload_encoding()
+    MQTTPayloadEncoding get_payload_encoding() const;
+
     ///
     /// \copydoc MQTTAbstractionImpl::subscribe(const std::string&)
     void subscribe(const std::string& topic);
@@ -77,13 +108,22 @@ public:
     const std::string& get_external_prefix() const;
 
     ///
-    /// \copydoc MQTTAbstractionImpl::spawn_main_loop_thread()
+    /// \brief Spawns the threads running the main loops of all broker connections
+    /// \returns a future, which is fulfilled once the main loop of any of the connections terminated
     std::shared_future<void> spawn_main_loop_thread();
 
     ///
-    /// \copydoc MQTTAbstractionImpl::get_main_loop_future()
+    /// \returns the future returned by spawn_main_loop_thread()
     std::shared_future<void> get_main_loop_future();
 
+    ///
+    /// \copydoc MQTTAbstractionImpl::get_event_loop()
+    EventLoop& get_event_loop();
+
+    ///
+    /// \copydoc MQTTAbstractionImpl::get_handler_executor()
+    Executor& get_handler_executor();
+
     ///
     /// \copydoc MQTTAbstractionImpl::register_handler(const std::string&, std::shared_ptr<TypedHandler>, QOS)
     void register_handler(const std::string& topic, std::shared_ptr<TypedHandler> handler, QOS qos);
@@ -92,10 +132,77 @@ public:
     /// \copydoc MQTTAbstractionImpl::unregister_handler(const std::string&, const Token&)
     void unregister_handler(const std::string& topic, const Token& token);
 
+    ///
+    /// \copydoc MQTTAbstractionImpl::get_message_pool_stats()
+    MessagePoolStats get_message_pool_stats();
+
+    ///
+    /// \copydoc MQTTAbstractionImpl::get_buffer_stats()
+    MQTTBufferStats get_buffer_stats();
+
+    ///
+    /// \copydoc MQTTAbstractionImpl::get_handler_memory_stats()
+    MQTTHandlerMemoryStats get_handler_memory_stats();
+
+    ///
+    /// \copydoc MQTTAbstractionImpl::get_queue_stats()
+    MQTTQueueStats get_queue_stats();
+
+    ///
+    /// \copydoc MQTTAbstractionImpl::get_dispatch_metrics()
+    std::map<std::string, DispatchMetrics> get_dispatch_metrics();
+
+    ///
+    /// \copydoc MQTTAbstractionImpl::get_dispatch_metrics_settings()
+    MQTTDispatchMetricsSettings get_dispatch_metrics_settings() const;
+
+    ///
+    /// \copydoc MQTTAbstractionImpl::is_var_cache_enabled()
+    bool is_var_cache_enabled() const;
+
+    ///
+    /// \brief starts recording the everest messages received and published from now on as configured by \p settings,
+    /// only the first call starts a recording
+    /// \throws EverestInternalError if the recording cannot be opened
+    void start_traffic_recording(const TrafficRecorderSettings& settings, const std::string& module_id);
+
+    ///
+    /// \copydoc MQTTAbstractionImpl::get_handler_accounting()
+    std::map<std::string, std::vector<HandlerAccountingStats>> get_handler_accounting();
+
 private:
-    std::unique_ptr<MQTTAbstractionImpl> mqtt_abstraction;
+    std::unique_ptr<MQTTAbstractionImpl> mqtt_abstraction; ///< connection to the main broker
+    std::vector<MQTTBrokerShard> broker_shards;
+    std::vector<std::unique_ptr<MQTTAbstractionImpl>> shard_clients; ///< connections to the broker_shards, in order
+    std::shared_ptr<TrafficRecorder> traffic_recorder;
+    std::shared_future<void> main_loop_future; ///< of all connections, only set if there are shards
     std::string everest_prefix;
     std::string external_prefix;
+
+    /// \returns the connection to the broker carrying \p topic
+    MQTTAbstractionImpl& get_client(const std::string& topic);
+
+    /// \returns the connections to the brokers carrying topics matching \p topic_filter
+    std::vector<MQTTAbstractionImpl*> get_clients(const std::string& topic_filter);
+
+    /// \returns the connections to the main broker and all shards
+    std::vector<MQTTAbstractionImpl*> get_all_clients();
+};
+
+///
+/// \brief Scoped batch of publishes: all messages published while an instance is alive are flushed to the broker
+/// together when it (or the outermost of nested batches) goes out of scope
+///
+class PublishBatch {
+public:
+    explicit PublishBatch(MQTTAbstraction& mqtt_abstraction);
+    ~PublishBatch();
+
+    PublishBatch(PublishBatch const&) = delete;
+    void operator=(PublishBatch const&) = delete;
+
+private:
+    MQTTAbstraction& mqtt_abstraction;
 };
 } // namespace Everest
 
@@ -3,24 +3,39 @@
 #ifndef UTILS_MQTT_ABSTRACTION_IMPL_HPP
 #define UTILS_MQTT_ABSTRACTION_IMPL_HPP
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <future>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <string_view>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <mqtt.h>
 #include <nlohmann/json.hpp>
 
+#include <utils/event_loop.hpp>
+#include <utils/executor.hpp>
 #include <utils/message_queue.hpp>
+#include <utils/mqtt_settings.hpp>
+#include <utils/shm_transport.hpp>
+#include <utils/topic_trie.hpp>
+#include <utils/traffic_recorder.hpp>
 #include <utils/types.hpp>
 
 #include <utils/thread.hpp>
 
-constexpr auto MQTT_BUF_SIZE = 500 * std::size_t{1024};
+constexpr auto MQTT_MAX_BUF_SIZE = 64 * std::size_t{1024 * 1024};
+constexpr auto MQTT_MESSAGE_POOL_SIZE = std::size_t{64};
+constexpr auto MQTT_MESSAGE_POOL_MAX_PAYLOAD_CAPACITY = 64 * std::size_t{1024};
+constexpr auto MQTT_HANDLER_EXECUTOR_MAX_THREADS = std::size_t{256};
 
 namespace Everest {
 /// \brief Contains a payload and the topic it was received on with additional QOS
@@ -33,12 +48,20 @@ struct MessageWithQOS : Message {
 ///
 /// \brief Contains a C++ abstraction of MQTT-C and some convenience functionality for using MQTT in EVerest modules
 ///
+/// A connection created with a \p dispatcher, like the ones to broker shards, has no handlers and no handler executor
+/// of its own: the messages it receives are dispatched by the \p dispatcher, so a handler registered for topics of
+/// several connections still runs on a single strand. Its handlers are registered with the \p dispatcher, while it
+/// only keeps the subscriptions, which have to outlive it.
+///
 class MQTTAbstractionImpl {
 public:
     MQTTAbstractionImpl(const std::string& mqtt_server_address, const std::string& mqtt_server_port,
-                        const std::string& mqtt_everest_prefix, const std::string& mqtt_external_prefix);
+                        const std::string& mqtt_everest_prefix, const std::string& mqtt_external_prefix,
+                        const MQTTBufferSettings& buffer_settings = {}, const MQTTQueueSettings& queue_settings = {},
+                        MQTTAbstractionImpl* dispatcher = nullptr);
     MQTTAbstractionImpl(const std::string& mqtt_server_socket_path, const std::string& mqtt_everest_prefix,
-                        const std::string& mqtt_external_prefix);
+                        const std::string& mqtt_external_prefix, const MQTTBufferSettings& buffer_settings = {},
+                        const MQTTQueueSettings& queue_settings = {}, MQTTAbstractionImpl* dispatcher = nullptr);
 
     ~MQTTAbstractionImpl();
 
@@ -68,6 +91,62 @@ public:
     /// \brief publishes the given \p data on the given \p topic with the given \p qos
     void publish(const std::string& topic, const std::string& data, QOS qos, bool retain = false);
 
+    ///
+    /// \brief publishes the given \p payload on the given \p topic as is, without copying it into a message first
+    /// unless it has to be queued until connected
+    void publish_raw(const std::string& topic, std::string_view payload, QOS qos, bool retain = false);
+
+    ///
+    /// \brief starts a batch of publishes: until the matching end_publish_batch() call, published messages are only
+    /// queued into the send buffer and the main loop is woken up once when the outermost batch ends. Batches are
+    /// per thread, publishes of other threads wake up the main loop as usual
+    void begin_publish_batch();
+
+    ///
+    /// \brief ends a batch of publishes started with begin_publish_batch() and flushes the queued messages
+    void end_publish_batch();
+
+    ///
+    /// \brief sets the \p policy deciding when published messages are flushed to the broker
+    void set_publish_flush_policy(const PublishFlushPolicy& policy);
+
+    ///
+    /// \brief sets the \p encoding used to serialize json payloads published on everest topics, received payloads
+    /// are always accepted in any encoding
+    void set_payload_encoding(MQTTPayloadEncoding encoding);
+
+    ///
+    /// \returns the encoding used to serialize json payloads published on everest topics
+    MQTTPayloadEncoding get_payload_encoding() const;
+
+    ///
+    /// \brief sets whether dispatch latencies are recorded, must be called before any handler is registered
+    void set_dispatch_metrics_settings(const MQTTDispatchMetricsSettings& settings);
+
+    ///
+    /// \returns the settings passed to set_dispatch_metrics_settings()
+    MQTTDispatchMetricsSettings get_dispatch_metrics_settings() const;
+
+    ///
+    /// \brief sets whether the time spent in handlers is accounted and the budget of a single handler call, must be
+    /// called before any handler is registered
+    void set_handler_accounting_settings(const MQTTHandlerAccountingSettings& settings);
+
+    ///
+    /// \brief sets whether the last value of every var received on a topic with handlers is cached, so var handlers
+    /// registered later receive it right away instead of waiting for the next publish, must be called before any
+    /// handler is registered
+    void set_var_cache_enabled(bool enabled);
+
+    ///
+    /// \returns the setting passed to set_var_cache_enabled()
+    bool is_var_cache_enabled() const;
+
+    ///
+    /// \brief records the everest messages received and published from now on with the given \p recorder, only the
+    /// recorder of the first call is used
+    void set_traffic_recorder(std::shared_ptr<TrafficRecorder> recorder);
+
     ///
     /// \brief subscribes to the given \p topic with QOS level 0
     void subscribe(const std::string& topic);
@@ -93,15 +172,36 @@ public:
     /// \returns the main loop future, which will be fulfilled on thread termination
     std::shared_future<void> get_main_loop_future();
 
+    ///
+    /// \returns the event loop running on the main loop thread, which can be used to schedule timers and watch file
+    /// descriptors without spawning additional threads, its callbacks must not block
+    EventLoop& get_event_loop();
+
+    ///
+    /// \returns the executor running the message handlers, which can be used to run callbacks outside of the handler
+    /// of a topic, the one of the dispatcher if the connection has one
+    Executor& get_handler_executor();
+
     ///
     /// \brief subscribes to the given \p topic and registers a callback \p handler that is called when a message
-    /// arrives on the topic. With \p qos a MQTT Quality of Service level can be set.
+    /// arrives on the topic. With \p qos a MQTT Quality of Service level can be set. With a dispatcher, the handler is
+    /// registered with the dispatcher and the topic is subscribed on both connections.
     void register_handler(const std::string& topic, std::shared_ptr<TypedHandler> handler, QOS qos);
 
     ///
     /// \brief unsubscribes a handler identified by its \p token from the given \p topic
     void unregister_handler(const std::string& topic, const Token& token);
 
+    ///
+    /// \brief subscribes to the given \p topic for handlers registered with the dispatcher of this connection, the
+    /// subscriptions are counted and renewed after reconnecting like the ones of handlers
+    void add_forwarded_subscription(const std::string& topic, QOS qos);
+
+    ///
+    /// \brief removes a subscription added with add_forwarded_subscription(), the topic is unsubscribed once the last
+    /// one is removed
+    void remove_forwarded_subscription(const std::string& topic);
+
     ///
     /// \brief checks if the given \p full_topic matches the given \p wildcard_topic that can contain "+" and "#"
     /// wildcards
@@ -109,19 +209,57 @@ public:
     /// \returns true if the topic matches, false otherwise
     static bool check_topic_matches(const std::string& full_topic, const std::string& wildcard_topic);
 
+    ///
+    /// \returns the allocation statistics of the pool holding received messages
+    MessagePoolStats get_message_pool_stats();
+
+    ///
+    /// \returns the fill levels and overflow counters of the message queues
+    MQTTQueueStats get_queue_stats();
+
+    ///
+    /// \returns the dispatch latencies and handler queue statistics by topic, latencies are only filled in if enabled
+    /// with set_dispatch_metrics_settings()
+    std::map<std::string, DispatchMetrics> get_dispatch_metrics();
+
+    ///
+    /// \returns the wall clock and CPU time spent in the handlers by topic, empty unless enabled with
+    /// set_handler_accounting_settings()
+    std::map<std::string, std::vector<HandlerAccountingStats>> get_handler_accounting();
+
+    ///
+    /// \returns the current sizes and usage statistics of the send and receive buffers
+    MQTTBufferStats get_buffer_stats();
+
+    ///
+    /// \returns the number of topics with handlers, the number of handlers and an estimate of the memory they hold
+    MQTTHandlerMemoryStats get_handler_memory_stats();
+
     ///
     /// \brief callback that is called from the mqtt implementation whenever a message is received
     static void publish_callback(void** unused, struct mqtt_response_publish* published);
 
 private:
-    static constexpr int mqtt_poll_timeout_ms{300000};
     bool mqtt_is_connected;
-    std::map<std::string, MessageHandler> message_handlers;
+    MQTTAbstractionImpl* dispatcher; ///< dispatches the received messages, nullptr if this connection does it itself
+    std::unordered_map<std::string, std::shared_ptr<MessageHandler>> message_handlers;
+    TopicTrie wildcard_handler_topics; ///< handler topics containing wildcards, indexing message_handlers
+    /// handler topics below the everest prefix containing wildcards, kept apart so everest messages are only matched
+    /// against them if there are any
+    TopicTrie everest_wildcard_handler_topics;
     std::mutex handlers_mutex;
+    /// subscriptions for the handlers of the dispatcher by topic, with the number of handlers
+    std::unordered_map<std::string, std::size_t> forwarded_subscriptions;
+    MQTTQueueSettings queue_settings;
+    MessagePool message_pool; ///< must outlive message_queue, which hands its messages back to this pool
     MessageQueue message_queue;
-    std::vector<std::shared_ptr<MessageWithQOS>> messages_before_connected;
+    std::unique_ptr<ShmTransport> shm_transport; ///< bypasses the broker for cmd and var topics if set up by manager
+    /// topics of message_handlers received via shm_transport instead of the broker, guarded by handlers_mutex
+    std::unordered_set<std::string> shm_topics;
+    BoundedQueue<std::shared_ptr<MessageWithQOS>> messages_before_connected;
     std::mutex messages_before_connected_mutex;
 
+    EventLoop event_loop; ///< dispatches the broker socket, write notifications and timers on the main loop thread
     Thread mqtt_mainloop_thread;
     std::shared_future<void> main_loop_future;
 
@@ -131,21 +269,83 @@ private:
     std::string mqtt_everest_prefix;
     std::string mqtt_external_prefix;
     struct mqtt_client mqtt_client;
-    uint8_t sendbuf[MQTT_BUF_SIZE];
-    uint8_t recvbuf[MQTT_BUF_SIZE];
-
-    static int open_nb_socket(const char* addr, const char* port);
+    MQTTBufferSettings buffer_settings;
+    std::atomic<MQTTPayloadEncoding> payload_encoding{MQTTPayloadEncoding::Json};
+    MQTTDispatchMetricsSettings dispatch_metrics_settings;
+    MQTTHandlerAccountingSettings handler_accounting_settings;
+    bool var_cache_enabled{false};
+    std::shared_ptr<TrafficRecorder> traffic_recorder; ///< never reset once set
+    std::atomic<TrafficRecorder*> active_traffic_recorder{nullptr}; ///< checked by every received and published message
+    std::mutex traffic_recorder_mutex;
+    // buffers are intentionally not value-initialized, so only pages actually used by MQTT-C become resident
+    std::unique_ptr<uint8_t[]> sendbuf;
+    std::unique_ptr<uint8_t[]> recvbuf;
+    std::atomic<std::size_t> sendbuf_size;
+    std::atomic<std::size_t> recvbuf_size;
+    std::atomic<std::size_t> largest_sent_message{0};
+    std::atomic<std::size_t> largest_received_message{0};
+    std::atomic<std::size_t> send_buffer_grows{0};
+    std::atomic<std::size_t> recv_buffer_grows{0};
+    std::atomic<std::size_t> send_buffer_rejections{0};
+    /// a publish waiting for the event loop to grow the send buffer
+    struct DeferredPublish {
+        std::string topic;
+        std::string data;
+        std::uint8_t flags;
+    };
+    std::deque<DeferredPublish> deferred_publishes; ///< in publish order, guarded by deferred_publishes_mutex
+    std::size_t deferred_publishes_required_size{0}; ///< send buffer size needed by the largest deferred publish
+    std::atomic_bool deferred_publishes_pending{false};
+    std::mutex deferred_publishes_mutex;
+
+    static int open_nb_socket(const char* addr, const char* port, bool wait_for_connect);
+    static int open_unix_socket(const std::string& socket_path);
     bool connectBroker(std::string& socket_path);
     bool connectBroker(const char* host, const char* port);
+    void sync();
     void on_mqtt_message(const Message& message);
     void on_mqtt_connect();
-    static void on_mqtt_disconnect();
-
+    void on_mqtt_disconnect();
+    void watch_broker_socket();
+    void schedule_reconnect(std::chrono::milliseconds backoff);
+    void try_reconnect(std::chrono::milliseconds backoff);
+    void report_reconnect_failure(const std::string& reason);
+    bool complete_reconnect(int socket_fd);
+
+    void setup_shm_transport();
+    void receive_message(const char* topic, std::size_t topic_size, const char* payload, std::size_t payload_size);
+    bool receives_via_shm(const std::string& topic);
+    bool is_shm_topic(const std::string& topic) const;
+    TopicTrie& get_wildcard_handler_topics(const std::string& topic);
+    std::string external_conflation_key(const std::string& topic) const;
+    MessagePriority classify_message(const std::string& topic) const;
     void notify_write_data();
+    void notify_published_data();
+    static std::size_t send_buffer_required_size(std::size_t message_size);
+    void defer_publish(const std::string& topic, std::string_view data, std::uint8_t flags);
+    void publish_deferred();
+    bool grow_recv_buffer();
+    void shrink_buffers();
+    void check_handler_budgets();
+    void log_handler_accounting_report();
+
+    std::atomic<bool> publish_notification_pending{false};
+    std::atomic<std::chrono::microseconds::rep> publish_coalesce_window_us{0};
+    EventLoop::Id publish_flush_timer_id{0}; ///< Pending sync of coalesced publishes, only accessed by the event loop
+
+    std::atomic_bool reconnecting{false};
+    std::atomic<EventLoop::Id> broker_socket_event_id{0};
+    std::atomic<EventLoop::Id> reconnect_timer_id{0}; ///< Backoff or connect timeout of the next reconnect
+    std::atomic<EventLoop::Id> connect_socket_event_id{0}; ///< Waits for the socket of a reconnect to be connected
+    bool reconnect_failure_reported{false}; ///< A failed reconnect has been logged, only accessed by the event loop
 
     int mqtt_socket_fd{-1};
     int event_fd{-1};
     int disconnect_event_fd{-1};
+
+    /// runs the handlers of all topics, declared last so it is destroyed first and no running handler outlives the
+    /// members it uses, nullptr if the connection has a dispatcher
+    std::unique_ptr<Executor> handler_executor;
 };
 } // namespace Everest
 
@@ -3,11 +3,98 @@
 #ifndef UTILS_MQTT_SETTINGS_HPP
 #define UTILS_MQTT_SETTINGS_HPP
 
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include <date/date.h>
 #include <date/tz.h>
 
+#include <utils/bounded_queue.hpp>
+
 namespace Everest {
 
+constexpr auto MQTT_DEFAULT_BUFFER_SIZE = 500 * std::size_t{1024};
+
+/// \brief serialization used for payloads published on everest topics
+enum class MQTTPayloadEncoding {
+    Json,
+    Cbor,
+    MessagePack
+};
+
+/// \brief sizes of the MQTT send and receive buffers of a module
+struct MQTTBufferSettings {
+    std::size_t send_buffer_size = MQTT_DEFAULT_BUFFER_SIZE; ///< Size of the MQTT send buffer in bytes
+    std::size_t recv_buffer_size = MQTT_DEFAULT_BUFFER_SIZE; ///< Size of the MQTT receive buffer in bytes
+    bool growable = false; ///< If enabled the buffers are grown on demand for messages exceeding their size and
+                           ///< shrunk back to the configured size once the large message has been handled
+};
+
+/// \brief current sizes and usage statistics of the MQTT send and receive buffers of a module
+struct MQTTBufferStats {
+    std::size_t send_buffer_size;         ///< Current size of the send buffer in bytes
+    std::size_t recv_buffer_size;         ///< Current size of the receive buffer in bytes
+    std::size_t largest_sent_message;     ///< High-water mark of topic and payload size of published messages
+    std::size_t largest_received_message; ///< High-water mark of topic and payload size of received messages
+    std::size_t send_buffer_grows;        ///< Number of times the send buffer had to be grown
+    std::size_t recv_buffer_grows;        ///< Number of times the receive buffer had to be grown
+    std::size_t send_buffer_rejections;   ///< Number of messages dropped since they could not wait for the send
+                                          ///< buffer to grow
+};
+
+/// \brief estimated memory of the message handlers of an MQTT connection
+struct MQTTHandlerMemoryStats {
+    std::size_t topics{0};   ///< Number of topics with registered handlers
+    std::size_t handlers{0}; ///< Number of handlers registered on all topics
+    std::size_t bytes{0};    ///< Estimated bytes of the handlers of all topics
+};
+
+/// \brief limits of the queues between the MQTT client and the handlers of a module
+struct MQTTQueueSettings {
+    QueueSettings receive;          ///< Messages received from the broker, waiting to be parsed
+    QueueSettings handler;          ///< Parsed messages waiting for the handlers of a topic, applies to each topic
+    QueueSettings before_connected; ///< Messages published before the connection to the broker has been established
+};
+
+/// \brief fill levels and overflow counters of the queues between the MQTT client and the handlers of a module
+struct MQTTQueueStats {
+    QueueStats receive;          ///< Messages received from the broker, waiting to be parsed
+    QueueStats handler;          ///< Parsed messages waiting for handlers, summed up over all topics
+    QueueStats before_connected; ///< Messages published before the connection to the broker has been established
+};
+
+/// \brief recording and publishing of the per topic dispatch latencies of a module
+struct MQTTDispatchMetricsSettings {
+    bool enabled = false;                          ///< Record latency histograms, nothing is measured if disabled
+    std::chrono::milliseconds publish_interval{0}; ///< Interval of publishing them as telemetry, 0 to not publish
+};
+
+/// \brief accounting of the time spent in the handlers of a module
+struct MQTTHandlerAccountingSettings {
+    bool enabled = false;                ///< Measure wall clock and CPU time of every handler and report it at shutdown
+    std::chrono::milliseconds budget{0}; ///< Warn about handler calls taking longer, 0 to disable the watchdog
+};
+
+///
+/// \brief additional MQTT broker carrying the topics starting with one of its prefixes instead of the main broker
+/// \details All modules and the manager connect to every shard and route by topic alone, so a topic is always
+///          published and subscribed on the same broker
+///
+struct MQTTBrokerShard {
+    std::string broker_socket_path; ///< A path to a socket the MQTT broker uses in socket mode. If this is set
+                                    ///< broker_host and broker_port are ignored
+    std::string broker_host;        ///< The hostname of the MQTT broker
+    int broker_port = 0;            ///< The port the MQTT broker listens on
+    std::vector<std::string> topic_prefixes; ///< Topics carried by this broker, the longest matching prefix of all
+                                             ///< shards wins
+
+    /// \returns true if a Unix Domain Socket is used for connection to the MQTT broker
+    bool uses_socket() const;
+};
+
 /// \brief minimal MQTT connection settings needed for an initial connection of a module to the manager
 struct MQTTSettings {
     std::string broker_socket_path; ///< A path to a socket the MQTT broker uses in socket mode. If this is set
@@ -16,6 +103,14 @@ struct MQTTSettings {
     int broker_port = 0;            ///< The port the MQTT broker listens on
     std::string everest_prefix;     ///< MQTT topic prefix for the "everest" topic
     std::string external_prefix;    ///< MQTT topic prefix for external topics
+    MQTTBufferSettings buffers;     ///< Sizes of the MQTT send and receive buffers
+    MQTTPayloadEncoding payload_encoding = MQTTPayloadEncoding::Json; ///< Serialization of everest topic payloads
+    MQTTQueueSettings queues;       ///< Limits of the message queues
+    MQTTDispatchMetricsSettings dispatch_metrics; ///< Recording of dispatch latencies
+    MQTTHandlerAccountingSettings handler_accounting; ///< Accounting of the time spent in handlers
+    bool var_cache = false; ///< Keep the last value of every var for later subscribers
+    bool topic_aliases = false; ///< Use short aliases of the module and implementation ids in cmd, var and res topics
+    std::vector<MQTTBrokerShard> broker_shards; ///< Additional brokers carrying topic namespaces of the main broker
 
     /// \brief Indicates if a Unix Domain Socket is used for connection to the MQTT broker
     /// \returns true is a UDS is used, false if a connection via host and port is used
@@ -42,6 +137,18 @@ void populate_mqtt_settings(MQTTSettings& mqtt_settings, const std::string& mqtt
 void populate_mqtt_settings(MQTTSettings& mqtt_settings, const std::string& mqtt_broker_host, int mqtt_broker_port,
                             const std::string& mqtt_everest_prefix, const std::string& mqtt_external_prefix);
 
+///
+/// \returns the broker connection carrying \p topic, 0 for the main broker and i + 1 for the i-th of the \p shards
+///
+std::size_t get_broker_connection(const std::vector<MQTTBrokerShard>& shards, std::string_view topic);
+
+///
+/// \returns the broker connections carrying any topic matching \p topic_filter, which can contain wildcards, in
+/// ascending order
+///
+std::vector<std::size_t> get_broker_connections(const std::vector<MQTTBrokerShard>& shards,
+                                                std::string_view topic_filter);
+
 } // namespace Everest
 
 #endif // UTILS_MQTT_SETTINGS_HPP
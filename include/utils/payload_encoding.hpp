@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_PAYLOAD_ENCODING_HPP
+#define UTILS_PAYLOAD_ENCODING_HPP
+
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+#include <utils/mqtt_settings.hpp>
+
+namespace Everest {
+
+///
+/// \brief Marker starting every binary encoded payload, followed by a byte identifying the encoding
+///
+/// Since a JSON text can never start with a NUL byte, binary and JSON payloads can be told apart by every receiver
+/// regardless of the encoding it publishes with itself.
+constexpr auto BINARY_PAYLOAD_MARKER = '\0';
+constexpr auto CBOR_PAYLOAD_IDENTIFIER = 'C';
+constexpr auto MESSAGE_PACK_PAYLOAD_IDENTIFIER = 'M';
+/// The rest of the payload is a zlib stream compressed with the dictionary of the framework, which holds a JSON text or
+/// binary encoded payload again, see compress_payload()
+constexpr auto DEFLATE_PAYLOAD_IDENTIFIER = 'Z';
+
+/// \brief converts the given \p encoding into its configuration string representation
+std::string payload_encoding_to_string(MQTTPayloadEncoding encoding);
+
+/// \brief converts the given configuration string \p encoding into a MQTTPayloadEncoding
+/// \throws EverestConfigError if \p encoding is unknown
+MQTTPayloadEncoding string_to_payload_encoding(const std::string& encoding);
+
+/// \brief serializes the given \p data with the given \p encoding
+std::string encode_payload(const nlohmann::json& data, MQTTPayloadEncoding encoding);
+
+///
+/// \brief serializes the given \p data with the given \p encoding into \p payload, replacing its contents
+/// \details The data is written straight into \p payload, which keeps its capacity, so serializing into a reused
+///          buffer does not allocate once the buffer is large enough
+void encode_payload(const nlohmann::json& data, MQTTPayloadEncoding encoding, std::string& payload);
+
+/// \returns true if the given \p payload has been serialized with a binary encoding
+bool is_binary_payload(const std::string& payload);
+
+///
+/// \brief compresses the given JSON text or binary encoded \p payload with deflate, using a dictionary of the keys and
+/// values common in manifests, interfaces, types and schemas
+/// \returns the compressed payload, or \p payload itself if it is too small to get smaller by compressing it
+/// \throws std::runtime_error if the payload could not be compressed
+std::string compress_payload(const std::string& payload);
+
+///
+/// \brief deserializes the given \p payload, which can either be a JSON text or a binary encoded payload, which is
+/// decompressed first if it has been compressed with compress_payload()
+/// \throws nlohmann::json::exception or std::runtime_error if the payload could not be decoded
+nlohmann::json decode_payload(const std::string& payload);
+
+///
+/// \brief Header fields of an EVerest message envelope {"name": ..., "type": ..., "data": {"id": ...}}
+struct PayloadEnvelope {
+    std::string name; ///< name of the cmd or var, empty if the payload has none
+    std::string type; ///< type of the message like "call" or "result", empty if the payload has none
+    std::string id;   ///< id of the call or result, empty if the payload has none
+};
+
+///
+/// \brief extracts the envelope fields of the given \p payload into \p envelope without materializing its data body,
+/// so messages no handler is interested in can be dropped without fully decoding them
+/// \returns false if the payload could not be decoded
+bool decode_payload_envelope(const std::string& payload, PayloadEnvelope& envelope);
+
+///
+/// \brief extracts only the "id" of the "data" object of the given \p payload into \p id, stopping right after it,
+/// which is cheap for the sorted keys of the payloads of the framework, where the data object and its id come first
+/// \returns false if the payload could not be decoded
+bool decode_payload_id(const std::string& payload, std::string& id);
+
+/// \returns the envelope fields of an already decoded message, fields that are missing or no strings are left empty
+PayloadEnvelope get_payload_envelope(const nlohmann::json& data);
+
+} // namespace Everest
+
+#endif // UTILS_PAYLOAD_ENCODING_HPP
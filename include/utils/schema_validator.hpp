@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_SCHEMA_VALIDATOR_HPP
+#define UTILS_SCHEMA_VALIDATOR_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include <nlohmann/json-schema.hpp>
+#include <nlohmann/json.hpp>
+
+namespace Everest {
+
+/// \brief Checks a value against a schema, throws an exception describing the first violation if it does not match
+using NativeValidator = void (*)(const nlohmann::json& value);
+
+///
+/// \brief A compiled schema of a cmd or var, either generated at build time or interpreted by the json schema
+/// validator
+///
+class SchemaValidator {
+public:
+    explicit SchemaValidator(NativeValidator native);
+    explicit SchemaValidator(std::unique_ptr<nlohmann::json_schema::json_validator> interpreted);
+
+    /// \brief throws an exception if \p value does not match the schema
+    void validate(const nlohmann::json& value) const;
+
+    /// \returns true if the schema is checked by generated code
+    bool is_native() const;
+
+private:
+    NativeValidator native{nullptr};
+    std::unique_ptr<nlohmann::json_schema::json_validator> interpreted;
+};
+
+///
+/// \brief Validators generated by ev_generate_validators() from interface and type definitions
+///
+/// Schemas are identified by the name of their interface and their path in it, like "vars/limits" or
+/// "cmds/set_limit/arguments/limit". The generated code registers its validators during static initialization, so
+/// linking it into a module is enough for Everest to use them instead of interpreting the same schemas at runtime.
+///
+namespace native_validators {
+
+void add(const std::string& interface_name, const std::string& schema_path, NativeValidator validator);
+
+/// \returns the validator generated for the schema or nullptr if there is none
+NativeValidator get(const std::string& interface_name, const std::string& schema_path);
+
+/// \brief Registers a generated validator when it is constructed
+struct Registration {
+    Registration(const char* interface_name, const char* schema_path, NativeValidator validator) {
+        add(interface_name, schema_path, validator);
+    }
+};
+
+/// \brief throws std::invalid_argument telling which part of the schema at \p location rejected the value
+[[noreturn]] void fail(const char* location, const char* reason);
+
+/// \returns true if \p value is an integer according to json schema, which includes floats without a fraction
+bool is_integer(const nlohmann::json& value);
+
+/// \returns the number of code points of the UTF-8 encoded string \p value, used for minLength and maxLength
+std::size_t utf8_length(const std::string& value);
+
+} // namespace native_validators
+
+} // namespace Everest
+
+#endif // UTILS_SCHEMA_VALIDATOR_HPP
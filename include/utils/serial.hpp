@@ -3,12 +3,23 @@
 #ifndef UTILS_SERIAL_HPP
 #define UTILS_SERIAL_HPP
 
+#include <array>
 #include <cstddef>
 #include <cstdio>
+#include <mutex>
 #include <stdint.h>
+#include <string>
 #include <termios.h>
+#include <vector>
+
+#include <utils/cobs.hpp>
+#include <utils/event_loop.hpp>
 
 namespace Everest {
+
+/// \returns the termios speed of \p baud, 0 if the baud rate is not supported on this platform
+speed_t baud_to_speed(int baud);
+
 class Serial {
 
 public:
@@ -39,6 +50,67 @@ private:
     uint8_t* decode;
     uint32_t crc32(uint8_t* buf, int len);
 };
+
+///
+/// \brief Non-blocking serial link exchanging COBS framed packets, driven by an EventLoop
+/// \details The device is opened non-blocking and registered on the event loop, which reads everything available
+///          and decodes it in bulk with the CobsDecoder. Packets are sent from any thread: they are encoded into the
+///          transmit buffer and written right away as far as the device accepts them, the rest is written once the
+///          event loop reports the device writable again.
+///
+class AsyncSerial {
+public:
+    using PacketHandler = CobsDecoder::PacketHandler;
+
+    static constexpr std::size_t DEFAULT_MAX_PACKET_SIZE = 2048;
+    /// \brief send_packet() fails while more than this many bytes wait for the device
+    static constexpr std::size_t DEFAULT_MAX_PENDING_TX = 64 * 1024;
+
+    /// \brief calls \p handler on the thread of the \p event_loop for every received packet
+    AsyncSerial(EventLoop& event_loop, const PacketHandler& handler,
+                std::size_t max_packet_size = DEFAULT_MAX_PACKET_SIZE,
+                std::size_t max_pending_tx = DEFAULT_MAX_PENDING_TX);
+    ~AsyncSerial();
+
+    AsyncSerial(const AsyncSerial&) = delete;
+    AsyncSerial& operator=(const AsyncSerial&) = delete;
+
+    /// \brief opens the tty \p device in raw mode with \p baud, see baud_to_speed() for the supported rates
+    bool open_device(const std::string& device, int baud);
+
+    /// \brief takes over the already configured \p fd, e.g. a pty or a socket
+    bool attach(int fd);
+
+    void close_device();
+
+    /// \returns false if the device is not open or the transmit buffer is full
+    bool send_packet(const std::uint8_t* data, std::size_t length);
+
+    /// \returns the number of received frames that were malformed or too large
+    std::size_t get_dropped_frames() const;
+
+private:
+    void handle_readable(std::uint32_t events);
+    void handle_writable();
+    /// \brief writes as much of the transmit buffer as possible, expects tx_mutex to be held
+    void write_pending();
+
+    EventLoop& event_loop;
+    PacketHandler handler;
+    CobsDecoder decoder;
+    const std::size_t max_pending_tx;
+
+    int fd{-1};
+    int write_fd{-1}; ///< duplicate of fd, epoll only takes one registration per file descriptor
+    EventLoop::Id read_id{0};
+    EventLoop::Id write_id{0}; ///< only registered while the device does not take the transmit buffer
+
+    std::array<std::uint8_t, 4096> rx_buffer{};
+
+    std::mutex tx_mutex;
+    std::vector<std::uint8_t> tx_buffer;
+    std::size_t tx_offset{0}; ///< start of the bytes in tx_buffer not written yet
+};
 } // namespace Everest
 
 #endif // UTILS_CONFIG_HPP
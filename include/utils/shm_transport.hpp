@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_SHM_TRANSPORT_HPP
+#define UTILS_SHM_TRANSPORT_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <sys/types.h>
+
+namespace Everest {
+
+inline constexpr auto EV_SHM_TRANSPORT_NAME = "EV_SHM_TRANSPORT_NAME";
+inline constexpr auto EV_SHM_TRANSPORT_SLOT = "EV_SHM_TRANSPORT_SLOT";
+inline constexpr auto EV_SHM_TRANSPORT_EVENTFDS = "EV_SHM_TRANSPORT_EVENTFDS";
+
+constexpr auto SHM_TRANSPORT_MAX_SLOTS = std::size_t{128};
+constexpr auto SHM_TRANSPORT_MAX_TOPICS = std::size_t{4096};
+constexpr auto SHM_TRANSPORT_MAX_TOPIC_SIZE = std::size_t{256};
+constexpr auto SHM_TRANSPORT_DEFAULT_RING_SIZE = 256 * std::size_t{1024};
+
+///
+/// \brief Transport for EVerest internal messages between modules running on the same host, bypassing the MQTT broker
+///
+/// The manager creates a shared memory segment containing a subscription table and one ring buffer per module (slot),
+/// as well as one eventfd per slot that is inherited by the spawned modules. Publishing a message copies it into the
+/// rings of all slots that subscribed to its topic and signals their eventfds. The manager only sets up a segment if
+/// all modules run in its slots, so a topic subscribed via shared memory is neither subscribed at nor published to the
+/// broker, only topics without a subscribed slot go through the broker. Topics longer than
+/// SHM_TRANSPORT_MAX_TOPIC_SIZE or not fitting into the full subscription table are only delivered via the broker.
+/// Messages not fitting into the ring of a subscriber are dropped and counted, publishing never waits for a receiver.
+///
+class ShmTransport {
+public:
+    using MessageCallback = std::function<void(const char* topic, std::size_t topic_size, const char* payload,
+                                               std::size_t payload_size)>;
+
+    ///
+    /// \brief creates a new shared memory segment called \p name with \p slot_count rings of \p ring_size bytes each
+    static std::unique_ptr<ShmTransport> create(const std::string& name, std::size_t slot_count,
+                                                std::size_t ring_size = SHM_TRANSPORT_DEFAULT_RING_SIZE);
+
+    ///
+    /// \brief attaches to the shared memory segment announced by the manager in the EV_SHM_TRANSPORT_* environment
+    /// variables
+    /// \returns the attached transport or nullptr if no shared memory transport has been set up for this process
+    static std::unique_ptr<ShmTransport> attach_from_env();
+
+    ~ShmTransport();
+
+    ShmTransport(ShmTransport const&) = delete;
+    void operator=(ShmTransport const&) = delete;
+
+    ///
+    /// \brief sets the EV_SHM_TRANSPORT_* environment variables for a module process using the given \p slot
+    void setup_environment(std::size_t slot) const;
+
+    ///
+    /// \brief copies the given \p payload published on \p topic into the rings of all subscribed slots, slots whose
+    /// ring is full miss the message, which is counted in get_dropped_messages()
+    /// \returns false if no slot subscribed to the topic, in this case the message has not been delivered
+    bool publish(const std::string& topic, std::string_view payload);
+
+    ///
+    /// \brief subscribes the own slot to the given \p topic
+    /// \returns false if the topic can not be received via shared memory and has to be subscribed at the broker
+    bool subscribe(const std::string& topic);
+
+    ///
+    /// \brief unsubscribes the own slot from the given \p topic
+    void unsubscribe(const std::string& topic);
+
+    ///
+    /// \brief spawns a thread calling the given \p callback for every message delivered to the own slot
+    void start_receiving(const MessageCallback& callback);
+
+    /// \returns the number of messages dropped by this process because the ring of a subscriber was full
+    std::uint64_t get_dropped_messages() const;
+
+private:
+    struct SegmentHeader;
+    struct RingHeader;
+
+    ShmTransport(std::string name, void* segment, std::size_t segment_size, std::vector<int> event_fds,
+                 std::size_t slot, pid_t owner_pid);
+
+    RingHeader& ring(std::size_t slot) const;
+    bool write_to_ring(std::size_t slot, const std::string& topic, std::string_view payload);
+    void receive_loop();
+    void receive_pending();
+    bool set_subscribed(const std::string& topic, bool subscribed);
+
+    std::string name;
+    void* segment;
+    std::size_t segment_size;
+    std::vector<int> event_fds;
+    std::size_t slot;
+    pid_t owner_pid; ///< process that created the segment and removes it again, 0 for attached modules
+    int stop_event_fd{-1};
+    MessageCallback callback;
+    std::string received_topic;   ///< re-used for all received messages by the receive thread
+    std::string received_payload; ///< re-used for all received messages by the receive thread
+    std::thread receive_thread;
+    std::atomic<std::uint64_t> dropped_messages{0};
+};
+
+} // namespace Everest
+
+#endif // UTILS_SHM_TRANSPORT_HPP
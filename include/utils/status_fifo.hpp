@@ -3,18 +3,45 @@
 #ifndef STATUS_FIFO_HPP
 #define STATUS_FIFO_HPP
 
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <thread>
+
+#include <nlohmann/json.hpp>
 
 namespace Everest {
 
+///
+/// \brief Reports the state of the manager to a supervising process through a fifo
+/// \details Messages are queued and written by a background thread to the non-blocking fifo, so a slow reader never
+///          stalls the manager. Besides the plain text lines, structured messages can be reported as JSON lines if
+///          enabled. A queued structured message is replaced by a newer one with the same type and module while the
+///          reader lags, and the oldest ones are dropped if the queue is full
+///
 class StatusFifo {
 public:
     // defined messages
     static constexpr auto ALL_MODULES_STARTED = "ALL_MODULES_STARTED\n";
     static constexpr auto WAITING_FOR_STANDALONE_MODULES = "WAITING_FOR_STANDALONE_MODULES\n";
 
-    static StatusFifo create_from_path(const std::string&);
-    void update(const std::string&);
+    /// \brief messages queued beyond this drop the oldest structured message
+    static constexpr std::size_t MAX_QUEUED_MESSAGES = 256;
+
+    /// \brief opens the fifo at \p fifo_path, \p structured enables the JSON lines of report()
+    static StatusFifo create_from_path(const std::string& fifo_path, bool structured = false);
+
+    /// \brief queues a text \p message, which is never coalesced
+    void update(const std::string& message);
+
+    ///
+    /// \brief queues a structured message with the \p type, the \p module it is about (empty if it is about the
+    /// manager) and the \p details, which are written as one JSON line
+    ///
+    void report(const std::string& type, const std::string& module, nlohmann::json details = nlohmann::json::object());
 
     StatusFifo(StatusFifo const&) = delete;
     StatusFifo& operator=(StatusFifo const&) = delete;
@@ -24,12 +51,31 @@ public:
     ~StatusFifo();
 
 private:
+    struct QueuedMessage {
+        std::string key; ///< type and module of a structured message, empty for text messages
+        std::string line;
+    };
+
     StatusFifo() = default;
-    explicit StatusFifo(int fd_) : fd(fd_), disabled(false), opened(true){};
+    StatusFifo(int fd_, bool structured_);
+
+    void enqueue(std::string key, std::string line);
+    void run_writer();
+
+    /// \returns false if the reader is gone or stop was requested while the fifo was full
+    bool write_all(const std::string& data);
 
     int fd{-1};
-    bool disabled{true};
+    std::atomic<bool> disabled{true};
     bool opened{false};
+    bool structured{false};
+
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::deque<QueuedMessage> queue;
+    std::size_t dropped{0}; ///< structured messages dropped since the last write
+    bool stop{false};
+    std::thread writer;
 };
 
 } // namespace Everest
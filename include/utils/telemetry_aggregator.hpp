@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_TELEMETRY_AGGREGATOR_HPP
+#define UTILS_TELEMETRY_AGGREGATOR_HPP
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+
+namespace Everest {
+
+///
+/// \brief Aggregates telemetry samples in memory, so they can be published as one batch per interval
+/// \details Samples are grouped by their topic and type. Of every key the last value is kept, numeric keys also keep
+///          the minimum, maximum and average of the values since the last flush.
+///
+class TelemetryAggregator {
+public:
+    ///
+    /// \brief adds a sample of the given \p type published on \p topic
+    /// \param values object with the values of the sample by their key
+    ///
+    void add(const std::string& topic, const std::string& type, const nlohmann::json& values);
+
+    ///
+    /// \brief takes the samples aggregated since the last flush
+    /// \returns an array with an entry of every topic and type, empty if no samples were added
+    ///
+    nlohmann::json flush();
+
+private:
+    /// \brief Aggregate of the values of one key
+    struct ValueSummary {
+        nlohmann::json last;
+        std::size_t count{0}; ///< Number of numeric values
+        double min{0};
+        double max{0};
+        double sum{0};
+    };
+
+    /// \brief Aggregate of the samples of one topic and type
+    struct SampleSummary {
+        std::size_t count{0};
+        std::map<std::string, ValueSummary> values;
+    };
+
+    std::mutex samples_mutex;
+    std::map<std::pair<std::string, std::string>, SampleSummary> samples; ///< by topic and type
+};
+
+} // namespace Everest
+
+#endif // UTILS_TELEMETRY_AGGREGATOR_HPP
@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_TOPIC_TRIE_HPP
+#define UTILS_TOPIC_TRIE_HPP
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Everest {
+
+///
+/// \returns true if the given \p topic contains a "+" or "#" MQTT wildcard level
+bool contains_wildcards(const std::string& topic);
+
+///
+/// \brief Subscription trie for MQTT topics containing "+" and "#" wildcards.
+///
+/// Topics are split into their levels on insertion, so matching an incoming topic only costs as many steps as the
+/// topic has levels (times the number of wildcards on the way), independent of the number of stored subscriptions.
+///
+class TopicTrie {
+public:
+    TopicTrie();
+    ~TopicTrie();
+
+    TopicTrie(TopicTrie const&) = delete;
+    void operator=(TopicTrie const&) = delete;
+
+    ///
+    /// \brief inserts the given \p wildcard_topic, inserting the same topic twice has no effect
+    void insert(const std::string& wildcard_topic);
+
+    ///
+    /// \brief removes the given \p wildcard_topic and prunes nodes that are no longer needed
+    void remove(const std::string& wildcard_topic);
+
+    ///
+    /// \brief appends all stored topics matching the given \p full_topic to \p matches
+    void find_matches(const std::string& full_topic, std::vector<const std::string*>& matches) const;
+
+    ///
+    /// \returns the number of stored topics
+    std::size_t size() const;
+
+private:
+    struct Node {
+        std::unordered_map<std::string, std::unique_ptr<Node>> children;
+        std::unique_ptr<Node> single_level;           ///< child for a "+" level
+        std::optional<std::string> multi_level_topic; ///< topic ending with "#" on this level
+        std::optional<std::string> topic;             ///< topic ending exactly on this node
+
+        bool empty() const;
+    };
+
+    Node root;
+    std::size_t topic_count{0};
+
+    static void find_matches(const Node& node, const std::vector<std::string_view>& levels, std::size_t index,
+                             std::vector<const std::string*>& matches);
+    bool remove(Node& node, const std::vector<std::string_view>& levels, std::size_t index);
+};
+
+} // namespace Everest
+
+#endif // UTILS_TOPIC_TRIE_HPP
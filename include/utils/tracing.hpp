@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_TRACING_HPP
+#define UTILS_TRACING_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+
+namespace Everest {
+namespace tracing {
+
+///
+/// \brief Identifies a span of a trace, carried in the "trace" entry of cmd calls and var publishes
+///
+struct TraceContext {
+    std::uint64_t trace_id{0}; ///< 0 if the message is not traced
+    std::uint64_t span_id{0};
+
+    bool is_valid() const {
+        return this->trace_id != 0;
+    }
+};
+
+/// \returns the compact text form of \p context, 16 hex digits of the trace id and 16 of the span id
+std::string to_string(const TraceContext& context);
+/// \returns the context parsed from \p text, an invalid one if \p text is malformed
+TraceContext from_string(const std::string& text);
+
+/// \returns the context of the innermost span of the calling thread, invalid if it does not run in a traced span
+TraceContext current();
+
+///
+/// \brief Makes \p context the current context of the calling thread until it is destroyed, e.g. while handling a
+/// message that carried it
+///
+class ScopedContext {
+public:
+    explicit ScopedContext(const TraceContext& context);
+    ~ScopedContext();
+    ScopedContext(const ScopedContext&) = delete;
+    ScopedContext& operator=(const ScopedContext&) = delete;
+
+private:
+    TraceContext previous;
+};
+
+///
+/// \brief Settings of the Tracer, configured with the tracing entry of a module in the config
+///
+struct TracingSettings {
+    double sample_rate{0};         ///< Share of the cmd calls and var publishes starting a new trace
+    std::string file;              ///< Chrome trace file the spans are written to, spans are not recorded if empty
+    std::size_t max_spans{100000}; ///< Only the most recent spans are kept
+
+    /// \returns the settings parsed from the tracing entry of a module config, if any
+    static TracingSettings parse(const nlohmann::json& module_config);
+};
+
+///
+/// \brief Records the spans of the traced cmd calls, var publishes and handlers of this process
+/// \details Traces are started by sampling new cmd calls and var publishes with the sample rate. Contexts received
+///          with messages are passed on to the messages published while handling them, even if spans are not
+///          recorded by this process. Without a sampled trace, a span only costs a check of the current context.
+///
+class Tracer {
+public:
+    /// \returns the tracer of this process
+    static Tracer& get();
+
+    void configure(const TracingSettings& settings);
+
+    /// \returns a new context for a span that is a child of the current context, or the root of a new trace if it
+    ///          is sampled. Invalid if the message is not traced
+    TraceContext new_span_context(bool start_trace);
+
+    /// \returns true if spans are recorded
+    bool is_recording() const {
+        return this->recording.load(std::memory_order_relaxed);
+    }
+
+    void record(const char* category, std::string name, const TraceContext& context, const TraceContext& parent,
+                std::chrono::system_clock::time_point start, std::chrono::system_clock::duration duration);
+
+    /// \returns the recorded spans in the Chrome trace format, which can be loaded in Perfetto or chrome://tracing
+    nlohmann::json get_chrome_trace() const;
+
+    ///
+    /// \brief writes the recorded spans to the configured file in the Chrome trace format
+    /// \throws EverestInternalError if the file can not be written
+    ///
+    void write_chrome_trace() const;
+
+private:
+    struct SpanRecord {
+        const char* category;
+        std::string name;
+        TraceContext context;
+        std::uint64_t parent_span_id;
+        std::int64_t start_us;
+        std::int64_t duration_us;
+        long thread_id;
+    };
+
+    Tracer() = default;
+
+    std::atomic<bool> recording{false};
+    std::atomic<std::uint64_t> sample_threshold{0}; ///< random ids not above it start a trace
+    mutable std::mutex spans_mutex;
+    TracingSettings settings;
+    std::deque<SpanRecord> spans;
+};
+
+///
+/// \brief Span of a cmd call, var publish or handler, which is current on the calling thread while it exists
+///
+class Span {
+public:
+    ///
+    /// \param category Category of the span in the trace, e.g. "cmd" or "dispatch"
+    /// \param start_trace Start a new trace if the span is sampled and there is no current context, otherwise the span
+    ///                    is only traced as child of the current context
+    ///
+    explicit Span(const char* category, bool start_trace = true);
+    ~Span();
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    /// \returns the context of this span, invalid if it is not traced
+    const TraceContext& get_context() const {
+        return this->context;
+    }
+    /// \returns true if the span is recorded, so naming it is worth the cost of formatting its name
+    bool is_recording() const {
+        return this->recording;
+    }
+    void set_name(std::string name_) {
+        this->name = std::move(name_);
+    }
+
+private:
+    const char* category;
+    TraceContext context;
+    TraceContext parent;
+    bool recording{false};
+    std::string name;
+    std::chrono::system_clock::time_point start;
+};
+
+} // namespace tracing
+} // namespace Everest
+
+#endif // UTILS_TRACING_HPP
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_TRAFFIC_RECORDER_HPP
+#define UTILS_TRAFFIC_RECORDER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <nlohmann/json.hpp>
+
+namespace Everest {
+
+/// \brief Direction of a message recorded by the TrafficRecorder
+enum class TrafficDirection : std::uint8_t {
+    Received = 1, ///< the module received the message
+    Published,    ///< the module published the message
+};
+
+/// \brief A message recorded by the TrafficRecorder
+struct TrafficRecord {
+    std::chrono::nanoseconds offset{0}; ///< time since the recording started
+    TrafficDirection direction{TrafficDirection::Received};
+    std::string topic;
+    std::string payload; ///< as sent over the broker, in any payload encoding
+};
+
+///
+/// \brief Settings of the TrafficRecorder, configured with the traffic_recorder entry of a module in the config
+///
+struct TrafficRecorderSettings {
+    std::string file;        ///< File the traffic is recorded to, the recorder is disabled if empty
+    std::uint64_t max_bytes; ///< Recording stops once the file reached this size, so a capture cannot fill the disk
+
+    /// \returns the settings parsed from the traffic_recorder entry of the config of the module \p module_id, if any
+    static TrafficRecorderSettings parse(const nlohmann::json& module_config, const std::string& module_id);
+};
+
+///
+/// \brief Records the everest messages received and published by a module with their timestamps to a compact binary
+/// file, which can be replayed against a module under test with everest-traffic-replay
+/// \details The file starts with a header naming the module, every message is appended as its offset from the start
+///          of the recording, its direction, and the sizes and bytes of its topic and payload. Messages are written
+///          through a buffered stream, so recording only costs a copy into the stream buffer most of the time.
+///
+class TrafficRecorder {
+public:
+    /// \throws EverestInternalError if the file of the \p settings cannot be opened
+    TrafficRecorder(const TrafficRecorderSettings& settings, const std::string& module_id);
+    ~TrafficRecorder();
+
+    TrafficRecorder(const TrafficRecorder&) = delete;
+    TrafficRecorder& operator=(const TrafficRecorder&) = delete;
+
+    void record(TrafficDirection direction, std::string_view topic, std::string_view payload);
+
+    /// \brief writes the buffered messages to the file
+    void flush();
+
+    /// \returns the number of messages recorded so far
+    std::uint64_t get_recorded() const;
+
+private:
+    mutable std::mutex mutex;
+    std::ofstream stream;
+    std::chrono::steady_clock::time_point start;
+    std::uint64_t max_bytes;
+    std::uint64_t written_bytes{0};
+    std::uint64_t recorded{0};
+    bool full{false};
+};
+
+///
+/// \brief Reads the messages of a recording written by the TrafficRecorder one by one
+///
+class TrafficReader {
+public:
+    /// \throws EverestInternalError if \p stream does not start with the header of a recording
+    explicit TrafficReader(std::istream& stream);
+
+    /// \returns the id of the recorded module
+    const std::string& get_module_id() const;
+
+    /// \returns the system clock time the recording started at
+    std::int64_t get_start_timestamp_ns() const;
+
+    ///
+    /// \returns the next message, or nothing at the end of the recording
+    /// \throws EverestInternalError if the recording is truncated within a message
+    ///
+    std::optional<TrafficRecord> next();
+
+private:
+    std::istream& stream;
+    std::string module_id;
+    std::int64_t start_timestamp_ns{0};
+};
+
+} // namespace Everest
+
+#endif // UTILS_TRAFFIC_RECORDER_HPP
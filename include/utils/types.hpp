@@ -3,12 +3,16 @@
 #ifndef UTILS_TYPES_HPP
 #define UTILS_TYPES_HPP
 
+#include <chrono>
 #include <cstddef>
+#include <exception>
 #include <filesystem>
 #include <fmt/core.h>
+#include <future>
 #include <map>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -34,6 +38,25 @@ using Object = json::object_t;
 using Handler = std::function<void(const std::string&, json)>;
 using StringHandler = std::function<void(std::string)>;
 using StringPairHandler = std::function<void(const std::string& topic, const std::string& data)>;
+/// Receives the payload of an external MQTT message as is, the views are only valid during the call
+using RawHandler = std::function<void(std::string_view topic, std::string_view payload)>;
+/// Receives the ready future of an asynchronous cmd call, whose get() returns the result or throws if the call failed
+using CmdResultCallback = std::function<void(std::future<json>)>;
+/// Sends the next chunk of a streamed cmd result, returns false once the caller stopped waiting for the result
+using CmdChunkWriter = std::function<bool(json chunk)>;
+/// Handles a streaming cmd by writing its result in chunks instead of returning it
+using StreamingJsonCommand = std::function<void(json args, const CmdChunkWriter& write)>;
+using CmdChunkCallback = std::function<void(json chunk)>;
+/// Publishes the result of a deferred cmd, can be called once from any thread
+using CmdResponder = std::function<void(json result)>;
+/// Handles a deferred cmd, which only has to respond after the handler returned
+using DeferredJsonCommand = std::function<void(json args, CmdResponder respond)>;
+
+/// \brief Decides how var updates are delivered to a subscriber
+enum class VarSubscriptionMode {
+    Queued,     ///< Every update is delivered in order
+    LatestValue ///< Updates arriving while the callback is busy replace each other, only the latest one is delivered
+};
 
 enum class HandlerType {
     Call,
@@ -51,11 +74,13 @@ struct TypedHandler {
     std::string id;
     HandlerType type;
     std::shared_ptr<Handler> handler;
+    std::shared_ptr<RawHandler> raw_handler; ///< set instead of handler for handlers of external MQTT payloads as is
 
     TypedHandler(const std::string& name_, const std::string& id_, HandlerType type_,
                  std::shared_ptr<Handler> handler_);
     TypedHandler(const std::string& name_, HandlerType type_, std::shared_ptr<Handler> handler_);
     TypedHandler(HandlerType type_, std::shared_ptr<Handler> handler_);
+    TypedHandler(HandlerType type_, std::shared_ptr<RawHandler> raw_handler_);
 };
 
 using Token = std::shared_ptr<TypedHandler>;
@@ -67,6 +92,22 @@ enum class QOS {
     QOS2  ///< Exactly once delivery
 };
 
+/// \brief Controls when published MQTT messages are flushed to the broker
+struct PublishFlushPolicy {
+    std::chrono::microseconds coalesce_window{0}; ///< Time to wait for further publishes before flushing, zero flushes
+                                                  ///< immediately
+
+    /// \returns a policy flushing every publish (or batch of publishes) immediately
+    static PublishFlushPolicy immediate() {
+        return {};
+    }
+
+    /// \returns a policy collecting publishes for up to \p window before flushing them together
+    static PublishFlushPolicy coalesce(std::chrono::microseconds window) {
+        return {window};
+    }
+};
+
 /// \brief A Mapping that can be used to map a module or implementation to a specific EVSE or optionally to a Connector
 struct Mapping {
     int evse;                     ///< The EVSE id
@@ -130,10 +171,22 @@ struct ModuleInfo {
 
 struct TelemetryConfig {
     int id;
+    std::chrono::milliseconds batch_interval{0}; ///< Interval of publishing batches, 0 to publish every sample
     explicit TelemetryConfig(int id) : id(id) {
     }
 };
 
+///
+/// \brief Liveness heartbeats of a module, configured with the heartbeat entry of a module in the config
+///
+struct HeartbeatSettings {
+    std::chrono::milliseconds interval{0}; ///< Interval of the heartbeats, 0 if they are disabled
+    unsigned int missed_limit{3};          ///< Missed heartbeats after which the manager reports the module as hanging
+
+    /// \returns the settings parsed from the heartbeat entry of a module config, if any
+    static HeartbeatSettings parse(const nlohmann::json& module_config);
+};
+
 struct Requirement {
     std::string id;
     size_t index = 0;
@@ -141,6 +194,13 @@ struct Requirement {
 
 bool operator<(const Requirement& lhs, const Requirement& rhs);
 
+/// \brief Outcome of a cmd call to one fulfillment of a requirement
+struct CmdCallResult {
+    Requirement requirement;
+    std::optional<json> result; ///< The return value, not set if the call failed
+    std::exception_ptr error;   ///< The exception the call failed with, nullptr if it succeeded
+};
+
 /// \brief A Fulfillment relates a Requirement to its connected implementation, identified via its module and
 /// implementation id.
 struct Fulfillment {
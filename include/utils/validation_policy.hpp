@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_VALIDATION_POLICY_HPP
+#define UTILS_VALIDATION_POLICY_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+namespace Everest {
+
+/// \brief Which messages are validated against their schema if schema validation is enabled
+enum class ValidationMode {
+    All,       ///< every message
+    FirstN,    ///< the first first_n messages of every cmd and var
+    Sample,    ///< every sample_rate-th message of every cmd and var
+    Publisher, ///< only the messages a module sends, received messages have been validated by their sender already
+};
+
+/// \brief Settings of the schema validation of cmds and vars
+struct ValidationPolicy {
+    ValidationMode mode{ValidationMode::All};
+    std::uint64_t first_n{100};    ///< Only used with ValidationMode::FirstN
+    std::uint64_t sample_rate{10}; ///< Only used with ValidationMode::Sample
+    /// Validate published vars on a background thread after they have been published, so violations are only logged
+    bool asynchronous{false};
+};
+
+/// \returns the ValidationMode named \p mode like in the settings of the config, throws std::out_of_range otherwise
+ValidationMode validation_mode_from_string(const std::string& mode);
+std::string validation_mode_to_string(ValidationMode mode);
+
+/// \brief Counters of the schema validation of a module
+struct ValidationStats {
+    std::uint64_t validated{0};  ///< Messages that have been validated
+    std::uint64_t skipped{0};    ///< Messages that have not been validated because of the ValidationPolicy
+    std::uint64_t violations{0}; ///< Validated messages that did not match their schema
+    std::uint64_t dropped{0};    ///< Messages not validated because the asynchronous validation fell behind
+};
+
+///
+/// \brief Decides which messages of a single cmd or var are validated according to a ValidationPolicy
+///
+/// The arguments and the result of every cmd and every var have their own sampler, so the first messages of a rarely
+/// used var are validated even if a chatty var already used up its first_n.
+///
+class ValidationSampler {
+public:
+    /// \brief \p sent tells if the messages are sent by this module, otherwise they are received from other modules
+    ValidationSampler(const ValidationPolicy& policy, bool sent);
+
+    /// \returns true if the next message should be validated
+    bool should_validate();
+
+private:
+    ValidationPolicy policy;
+    bool sent;
+    std::atomic<std::uint64_t> messages{0};
+};
+
+/// \brief Time spent validating the messages of a single cmd or var
+struct ValidationCostStats {
+    std::uint64_t validations{0};     ///< Validated messages
+    std::uint64_t failures{0};        ///< Validated messages that did not match their schema
+    std::chrono::nanoseconds total{}; ///< Time spent validating all messages
+    std::chrono::nanoseconds max{};   ///< Longest validation of a single message
+};
+
+///
+/// \brief Accounts the validations of a single cmd or var. Recording is lock-free, so it can be done from any thread
+///
+class ValidationCost {
+public:
+    void record(std::chrono::nanoseconds duration, bool valid);
+
+    ValidationCostStats get_stats() const;
+
+private:
+    std::atomic<std::uint64_t> validations{0};
+    std::atomic<std::uint64_t> failures{0};
+    std::atomic<std::int64_t> total_ns{0};
+    std::atomic<std::int64_t> max_ns{0};
+};
+
+void to_json(nlohmann::json& j, const ValidationPolicy& policy);
+void from_json(const nlohmann::json& j, ValidationPolicy& policy);
+void to_json(nlohmann::json& j, const ValidationStats& stats);
+void to_json(nlohmann::json& j, const ValidationCostStats& stats);
+
+} // namespace Everest
+
+#endif // UTILS_VALIDATION_POLICY_HPP
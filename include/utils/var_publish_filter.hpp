@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_VAR_PUBLISH_FILTER_HPP
+#define UTILS_VAR_PUBLISH_FILTER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+namespace Everest {
+
+/// \brief Publishing limits of one var
+struct VarPublishLimits {
+    bool change_only{false}; ///< Only publish values that differ from the last published value
+    /// Publish an unchanged value anyway if the last publish is this long ago, 0 to never republish it
+    std::chrono::milliseconds refresh_interval{0};
+};
+
+///
+/// \brief Settings of the published vars of a module, configured with the var_publishing entry of a module in the
+///        config
+///
+struct VarPublishSettings {
+    VarPublishLimits defaults;                    ///< Limits of all vars without an entry in vars
+    std::map<std::string, VarPublishLimits> vars; ///< Limits of specific vars by "<implementation id>/<var name>"
+
+    /// \returns the settings parsed from the var_publishing entry of a module config, if any
+    static VarPublishSettings parse(const nlohmann::json& module_config);
+    const VarPublishLimits& get_limits(const std::string& impl_id, const std::string& var_name) const;
+};
+
+///
+/// \brief Suppresses publishing a var if its value did not change since it was published last
+/// \details Values are compared by their hash, so a hash collision suppresses a changed value until the next refresh.
+///          Used by Everest::publish_var() for the vars with VarPublishLimits::change_only set.
+///
+class VarChangeFilter {
+public:
+    using clock = std::chrono::steady_clock;
+
+    explicit VarChangeFilter(const VarPublishLimits& limits);
+
+    ///
+    /// \returns true if a value with \p hash should be published at \p now, the value is considered published then
+    ///
+    bool should_publish(std::size_t hash, clock::time_point now = clock::now());
+
+    /// \returns the number of values that have not been published because they did not change
+    std::uint64_t get_suppressed() const;
+
+private:
+    VarPublishLimits limits;
+    mutable std::mutex mutex;
+    std::optional<std::size_t> last_hash; ///< not set before the first publish
+    clock::time_point last_publish;
+    std::uint64_t suppressed{0};
+};
+
+} // namespace Everest
+
+#endif // UTILS_VAR_PUBLISH_FILTER_HPP
@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include <utils/cmd_call.hpp>
+
+namespace Everest {
+
+bool is_cmd_reply_topic(const std::string& topic, const std::string& everest_prefix) {
+    const std::string suffix = "/res";
+    // modules/{module_id} or t/{alias} if topic aliases are enabled
+    for (const auto& module_prefix : {everest_prefix + "modules/", everest_prefix + "t/"}) {
+        if (topic.size() <= module_prefix.size() + suffix.size() or
+            topic.compare(0, module_prefix.size(), module_prefix) != 0 or
+            topic.compare(topic.size() - suffix.size(), suffix.size(), suffix) != 0) {
+            continue;
+        }
+        const auto module = topic.substr(module_prefix.size(), topic.size() - module_prefix.size() - suffix.size());
+        return module.find_first_of("/+#") == std::string::npos;
+    }
+    return false;
+}
+
+CmdCallContext::CmdCallContext(std::optional<std::chrono::system_clock::time_point> deadline) : deadline(deadline) {
+}
+
+std::optional<std::chrono::system_clock::time_point> CmdCallContext::get_deadline() const {
+    return this->deadline;
+}
+
+bool CmdCallContext::is_cancelled() const {
+    return this->cancelled;
+}
+
+bool CmdCallContext::is_abandoned() const {
+    return this->cancelled or (this->deadline.has_value() and std::chrono::system_clock::now() > *this->deadline);
+}
+
+void CmdCallContext::cancel() {
+    {
+        const std::lock_guard<std::mutex> lock(this->window_mutex);
+        this->cancelled = true;
+    }
+    this->window_cv.notify_all();
+}
+
+bool CmdCallContext::wait_for_window(std::uint64_t seq, std::chrono::nanoseconds timeout) {
+    std::unique_lock<std::mutex> lock(this->window_mutex);
+    const auto in_window = [this, seq]() { return this->cancelled or seq < this->consumed + CMD_STREAM_WINDOW; };
+    if (not this->window_cv.wait_for(lock, timeout, in_window)) {
+        // the caller is gone or stuck, its stream is given up like a cancelled one
+        this->cancelled = true;
+    }
+    return not this->cancelled;
+}
+
+void CmdCallContext::acknowledge(std::uint64_t consumed) {
+    {
+        const std::lock_guard<std::mutex> lock(this->window_mutex);
+        this->consumed = std::max(this->consumed, consumed);
+    }
+    this->window_cv.notify_all();
+}
+
+void CmdChunkStream::push(nlohmann::json data) {
+    {
+        const std::lock_guard<std::mutex> lock(this->mutex);
+        // the window holds unconsumed chunks and the final message
+        if (this->messages.size() > CMD_STREAM_WINDOW) {
+            this->overrun = true;
+        } else {
+            this->messages.push_back(std::move(data));
+        }
+    }
+    this->cv.notify_one();
+}
+
+CmdChunkStream::Event CmdChunkStream::next(std::chrono::nanoseconds timeout, nlohmann::json& chunk) {
+    nlohmann::json message;
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        const auto has_message = [this]() { return this->overrun or not this->messages.empty(); };
+        if (not this->cv.wait_for(lock, timeout, has_message)) {
+            return Event::Timeout;
+        }
+        if (this->overrun) {
+            return Event::Overrun;
+        }
+        message = std::move(this->messages.front());
+        this->messages.pop_front();
+    }
+
+    if (message.value("done", false)) {
+        return Event::Done;
+    }
+    if (message.value("seq", this->next_seq) != this->next_seq) {
+        return Event::Lost;
+    }
+    this->next_seq++;
+    chunk = std::move(message["retval"]);
+    return Event::Chunk;
+}
+
+std::optional<std::uint64_t> CmdChunkStream::take_acknowledgement() {
+    if (this->next_seq < this->acknowledged + CMD_STREAM_WINDOW / 2) {
+        return std::nullopt;
+    }
+    this->acknowledged = this->next_seq;
+    return this->acknowledged;
+}
+
+AsyncCmdCall::AsyncCmdCall(CmdResultCallback callback) : callback(std::move(callback)) {
+}
+
+void AsyncCmdCall::start_timeout(const std::function<EventLoop::Id()>& add_timer) {
+    const std::lock_guard<std::mutex> lock(this->mutex);
+    this->timeout_timer = add_timer();
+}
+
+bool AsyncCmdCall::send(const std::function<std::string()>& send_call) {
+    const std::lock_guard<std::mutex> lock(this->mutex);
+    if (this->completed) {
+        // timed out while waiting for a slot
+        return false;
+    }
+    this->call_id = send_call();
+    this->sent = true;
+    return true;
+}
+
+std::optional<AsyncCmdCall::Completion> AsyncCmdCall::complete() {
+    const std::lock_guard<std::mutex> lock(this->mutex);
+    if (this->completed) {
+        return std::nullopt;
+    }
+    this->completed = true;
+    return Completion{this->sent, this->call_id, this->timeout_timer};
+}
+
+void AsyncCmdCall::deliver(Executor& executor, std::promise<nlohmann::json> result) {
+    executor.post([callback = std::move(this->callback),
+                   result = std::make_shared<std::promise<nlohmann::json>>(std::move(result))]() {
+        callback(result->get_future());
+    });
+}
+
+CmdResultCache::CmdResultCache(std::chrono::nanoseconds ttl) : ttl(ttl) {
+}
+
+std::optional<nlohmann::json> CmdResultCache::lookup(const std::string& key, std::uint64_t& generation) {
+    const std::lock_guard<std::mutex> lock(this->mutex);
+    const auto entry = this->entries.find(key);
+    if (entry != this->entries.end()) {
+        if (std::chrono::steady_clock::now() < entry->second.expires) {
+            return entry->second.result;
+        }
+        this->entries.erase(entry);
+    }
+    generation = this->generation;
+    return std::nullopt;
+}
+
+void CmdResultCache::store(const std::string& key, std::uint64_t generation, const nlohmann::json& result) {
+    const std::lock_guard<std::mutex> lock(this->mutex);
+    if (this->generation != generation) {
+        return;
+    }
+    this->entries[key] = {result, std::chrono::steady_clock::now() + this->ttl};
+}
+
+void CmdResultCache::invalidate() {
+    const std::lock_guard<std::mutex> lock(this->mutex);
+    this->generation++;
+    this->entries.clear();
+}
+
+} // namespace Everest
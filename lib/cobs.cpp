@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <utils/cobs.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+namespace Everest {
+
+/// \brief a block holds at most 254 bytes, so its code byte never becomes 0x00
+static constexpr std::size_t MAX_BLOCK_SIZE = 254;
+
+std::size_t cobs_encode(const std::uint8_t* data, std::size_t length, std::uint8_t* out) {
+    const auto* src = data;
+    const auto* const end = data + length;
+    auto* dst = out;
+
+    while (true) {
+        const auto chunk = std::min<std::size_t>(end - src, MAX_BLOCK_SIZE);
+        const auto* zero = static_cast<const std::uint8_t*>(std::memchr(src, 0, chunk));
+        const std::size_t run = zero != nullptr ? zero - src : chunk;
+
+        *dst++ = static_cast<std::uint8_t>(run + 1);
+        std::memcpy(dst, src, run);
+        dst += run;
+        src += run;
+
+        if (zero != nullptr) {
+            // the zero is implied by the code byte, a trailing zero gets an empty block of its own
+            src++;
+            continue;
+        }
+        if (run == MAX_BLOCK_SIZE and src != end) {
+            // a full block without an implied zero
+            continue;
+        }
+        break;
+    }
+
+    *dst++ = 0x00;
+    return dst - out;
+}
+
+std::optional<std::size_t> cobs_decode(const std::uint8_t* frame, std::size_t length, std::uint8_t* out) {
+    std::size_t in = 0;
+    std::size_t decoded = 0;
+    while (in < length) {
+        const auto code = frame[in++];
+        const std::size_t run = code - 1;
+        if (code == 0x00 or run > length - in) {
+            return std::nullopt;
+        }
+        std::memcpy(out + decoded, frame + in, run);
+        in += run;
+        decoded += run;
+        if (code != MAX_BLOCK_SIZE + 1 and in < length) {
+            out[decoded++] = 0x00;
+        }
+    }
+    return decoded;
+}
+
+CobsDecoder::CobsDecoder(std::size_t max_packet_size) : max_frame_size(cobs_max_encoded_size(max_packet_size) - 1) {
+}
+
+void CobsDecoder::reset() {
+    this->partial_frame.clear();
+    this->overflow = false;
+}
+
+void CobsDecoder::decode_frame(const std::uint8_t* frame, std::size_t length, const PacketHandler& handler) {
+    if (length == 0) {
+        // consecutive delimiters, e.g. used by the sender to resynchronize
+        return;
+    }
+    this->packet.resize(length);
+    const auto size = cobs_decode(frame, length, this->packet.data());
+    if (not size.has_value()) {
+        this->dropped_frames++;
+        return;
+    }
+    handler(this->packet.data(), size.value());
+}
+
+void CobsDecoder::feed(const std::uint8_t* data, std::size_t length, const PacketHandler& handler) {
+    while (length > 0) {
+        const auto* delimiter = static_cast<const std::uint8_t*>(std::memchr(data, 0, length));
+        const std::size_t frame_bytes = delimiter != nullptr ? delimiter - data : length;
+
+        if (not this->overflow) {
+            if (this->partial_frame.size() + frame_bytes > this->max_frame_size) {
+                this->overflow = true;
+                this->partial_frame.clear();
+            } else if (delimiter != nullptr and this->partial_frame.empty()) {
+                // the whole frame is in this chunk
+                decode_frame(data, frame_bytes, handler);
+            } else {
+                this->partial_frame.insert(this->partial_frame.end(), data, data + frame_bytes);
+                if (delimiter != nullptr) {
+                    decode_frame(this->partial_frame.data(), this->partial_frame.size(), handler);
+                    this->partial_frame.clear();
+                }
+            }
+        }
+
+        if (delimiter == nullptr) {
+            return;
+        }
+        if (this->overflow) {
+            this->dropped_frames++;
+            this->overflow = false;
+        }
+        data += frame_bytes + 1;
+        length -= frame_bytes + 1;
+    }
+}
+
+} // namespace Everest
@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include <fmt/format.h>
+
+#include <everest/logging.hpp>
+
+#include <utils/compiled_config_cache.hpp>
+
+namespace Everest {
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+
+namespace {
+/// Incremented whenever the layout of the cached config changes
+constexpr auto cache_format_version = 1;
+
+constexpr std::uint64_t fnv_offset_basis = 0xcbf29ce484222325;
+constexpr std::uint64_t fnv_prime = 0x100000001b3;
+
+void hash_bytes(std::uint64_t& hash, const char* data, std::size_t size) {
+    for (std::size_t i = 0; i < size; i++) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= fnv_prime;
+    }
+}
+
+void hash_string(std::uint64_t& hash, const std::string& value) {
+    // the terminating zero separates consecutive strings
+    hash_bytes(hash, value.c_str(), value.size() + 1);
+}
+
+void hash_file(std::uint64_t& hash, const fs::path& path) {
+    hash_string(hash, path.string());
+    std::ifstream file(path, std::ios::binary);
+    if (not file) {
+        // a missing file must result in a different key than an empty one
+        hash_string(hash, "<missing>");
+        return;
+    }
+    char buffer[64 * 1024];
+    while (file.read(buffer, sizeof(buffer)) or file.gcount() > 0) {
+        hash_bytes(hash, buffer, static_cast<std::size_t>(file.gcount()));
+    }
+}
+} // namespace
+
+CompiledConfigCache::CompiledConfigCache(const fs::path& cache_dir, const fs::path& config_file,
+                                         const std::vector<fs::path>& input_files, const json& settings) :
+    cache_file(cache_dir / (config_file.stem().string() + ".cbor")), key(fnv_offset_basis) {
+    hash_string(this->key, std::to_string(cache_format_version));
+    hash_string(this->key, settings.dump());
+    for (const auto& input_file : input_files) {
+        hash_file(this->key, input_file);
+    }
+}
+
+std::optional<json> CompiledConfigCache::load() const {
+    std::ifstream file(this->cache_file, std::ios::binary);
+    if (not file) {
+        EVLOG_debug << fmt::format("No compiled config cached at {}", this->cache_file.string());
+        return std::nullopt;
+    }
+
+    try {
+        auto cached = json::from_cbor(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        if (cached.at("key").get<std::uint64_t>() != this->key) {
+            EVLOG_info << "Config inputs changed since the config was cached, compiling it again";
+            return std::nullopt;
+        }
+        return std::move(cached.at("config"));
+    } catch (const std::exception& e) {
+        EVLOG_warning << fmt::format("Ignoring broken compiled config cache {}: {}", this->cache_file.string(),
+                                     e.what());
+        return std::nullopt;
+    }
+}
+
+void CompiledConfigCache::store(const json& config) const {
+    try {
+        fs::create_directories(this->cache_file.parent_path());
+        // write to a temporary file first, so a concurrent or interrupted write never leaves a truncated cache behind
+        auto temporary_file = this->cache_file;
+        temporary_file += ".tmp";
+        {
+            std::ofstream file(temporary_file, std::ios::binary | std::ios::trunc);
+            const auto cbor = json::to_cbor(json{{"key", this->key}, {"config", config}});
+            file.write(reinterpret_cast<const char*>(cbor.data()), static_cast<std::streamsize>(cbor.size()));
+            if (not file.flush()) {
+                throw std::runtime_error("could not write " + temporary_file.string());
+            }
+        }
+        fs::rename(temporary_file, this->cache_file);
+        EVLOG_debug << fmt::format("Stored compiled config at {}", this->cache_file.string());
+    } catch (const std::exception& e) {
+        EVLOG_warning << fmt::format("Could not store compiled config cache {}: {}", this->cache_file.string(),
+                                     e.what());
+    }
+}
+
+std::uint64_t CompiledConfigCache::get_key() const {
+    return this->key;
+}
+
+std::vector<fs::path> CompiledConfigCache::find_files(const fs::path& dir) {
+    std::vector<fs::path> paths;
+    if (not fs::is_directory(dir)) {
+        return paths;
+    }
+    for (const auto& entry : fs::recursive_directory_iterator(dir)) {
+        if (entry.is_regular_file()) {
+            paths.push_back(entry.path());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+} // namespace Everest
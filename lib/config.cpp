@@ -1,11 +1,18 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright Pionix GmbH and Contributors to EVerest
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <fstream>
 #include <list>
+#include <numeric>
 #include <set>
 #include <sstream>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 #include <fmt/format.h>
 
@@ -13,6 +20,7 @@
 #include <everest/logging.hpp>
 
 #include <framework/runtime.hpp>
+#include <utils/compiled_config_cache.hpp>
 #include <utils/config.hpp>
 #include <utils/formatter.hpp>
 #include <utils/yaml_loader.hpp>
@@ -36,6 +44,53 @@ public:
     const std::string what;
 };
 
+///
+/// \brief runs \p task for every index in [0, \p count) on up to as many threads as there are cores
+///
+/// All indices are processed even if some of them fail, afterwards the exception of the lowest failing index is
+/// rethrown, so errors are reported the same way regardless of the scheduling.
+template <typename Task> static void parallel_for(std::size_t count, const Task& task) {
+    std::vector<std::exception_ptr> errors(count);
+    std::atomic<std::size_t> next_index{0};
+    const auto worker = [&]() {
+        for (auto index = next_index++; index < count; index = next_index++) {
+            try {
+                task(index);
+            } catch (...) {
+                errors.at(index) = std::current_exception();
+            }
+        }
+    };
+
+    const auto thread_count = std::min<std::size_t>(count, std::max(std::thread::hardware_concurrency(), 1U));
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < thread_count; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+/// \returns all yaml files in \p dir and its subdirectories in a stable order
+static std::vector<fs::path> find_yaml_files(const fs::path& dir) {
+    std::vector<fs::path> paths;
+    for (const auto& entry : fs::recursive_directory_iterator(dir)) {
+        if (fs::is_regular_file(entry.path()) && entry.path().extension() == ".yaml") {
+            paths.push_back(entry.path());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
 static json draft07 = R"(
 {
     "$ref": "http://json-schema.org/draft-07/schema#"
@@ -288,23 +343,47 @@ std::string ConfigBase::printable_identifier(const std::string& module_id) const
 std::string ConfigBase::printable_identifier(const std::string& module_id, const std::string& impl_id) const {
     BOOST_LOG_FUNCTION();
 
+    const auto module_it = this->index.find(module_id);
+    if (module_it != this->index.end()) {
+        const auto& module_index = module_it->second;
+        if (impl_id.empty()) {
+            return module_index.printable_identifier;
+        }
+        const auto impl_it = module_index.implementations.find(impl_id);
+        if (impl_it != module_index.implementations.end()) {
+            return impl_it->second.printable_identifier;
+        }
+    }
+
+    // not indexed (yet), this also reports unknown ids
     const auto info = extract_implementation_info(this->module_names, this->manifests, module_id, impl_id);
     return create_printable_identifier(info, module_id, impl_id);
 }
 
-std::string ConfigBase::get_module_name(const std::string& module_id) const {
+const std::string& ConfigBase::get_module_name(const std::string& module_id) const {
     return this->module_names.at(module_id);
 }
 
 std::string ConfigBase::mqtt_prefix(const std::string& module_id, const std::string& impl_id) {
     BOOST_LOG_FUNCTION();
 
+    const auto module_it = this->index.find(module_id);
+    if (module_it != this->index.end()) {
+        const auto impl_it = module_it->second.implementations.find(impl_id);
+        if (impl_it != module_it->second.implementations.end()) {
+            return impl_it->second.mqtt_prefix;
+        }
+    }
     return fmt::format("{}modules/{}/impl/{}", this->mqtt_settings.everest_prefix, module_id, impl_id);
 }
 
 std::string ConfigBase::mqtt_module_prefix(const std::string& module_id) {
     BOOST_LOG_FUNCTION();
 
+    const auto module_it = this->index.find(module_id);
+    if (module_it != this->index.end()) {
+        return module_it->second.mqtt_prefix;
+    }
     return fmt::format("{}modules/{}", this->mqtt_settings.everest_prefix, module_id);
 }
 
@@ -338,6 +417,30 @@ const json& ConfigBase::get_settings() const {
     return this->settings;
 }
 
+SubsystemMemory ConfigBase::get_memory_usage() const {
+    BOOST_LOG_FUNCTION();
+    SubsystemMemory memory;
+    const auto add = [&memory](const std::string& name, const json& document) {
+        const auto bytes = estimate_json_bytes(document);
+        memory.details[name] = bytes;
+        memory.bytes += bytes;
+    };
+    add("main", this->main);
+    add("settings", this->settings);
+    add("manifests", this->manifests);
+    add("interfaces", this->interfaces);
+    add("interface_definitions", this->interface_definitions);
+    add("types", this->types);
+    std::size_t schema_bytes = 0;
+    for (const auto* schema : {&this->_schemas.config, &this->_schemas.manifest, &this->_schemas.interface,
+                               &this->_schemas.type, &this->_schemas.error_declaration_list}) {
+        schema_bytes += estimate_json_bytes(*schema);
+    }
+    memory.details["schemas"] = schema_bytes;
+    memory.bytes += schema_bytes;
+    return memory;
+}
+
 const json ConfigBase::get_schemas() const {
     BOOST_LOG_FUNCTION();
     return this->_schemas;
@@ -362,58 +465,20 @@ std::unordered_map<std::string, std::string> ConfigBase::get_module_names() {
     return this->module_names;
 }
 
-json ConfigBase::resolve_requirement(const std::string& module_id, const std::string& requirement_id) const {
+const json& ConfigBase::resolve_requirement(const std::string& module_id, const std::string& requirement_id) const {
     BOOST_LOG_FUNCTION();
 
-    // FIXME (aw): this function should throw, if the requirement id
-    //             isn't even listed in the module manifest
-    // FIXME (aw): the following if doesn't check for the requirement id
-    //             at all
-    const auto module_name_it = this->module_names.find(module_id);
-    if (module_name_it == this->module_names.end()) {
-        EVLOG_AND_THROW(EverestApiError(fmt::format("Requested requirement id '{}' of module {} not found in config!",
-                                                    requirement_id, printable_identifier(module_id))));
-    }
-
-    // check for connections for this requirement
-    const auto& module_config = this->main.at(module_id);
-    const std::string module_name = module_name_it->second;
-    const auto& requirement = this->manifests.at(module_name).at("requires").at(requirement_id);
-    if (!module_config.at("connections").contains(requirement_id)) {
-        return json::array(); // return an empty array if our config does not contain any connections for this
-                              // requirement id
+    const auto& module_index = get_module_index(module_id);
+    const auto requirement_it = module_index.requirements.find(requirement_id);
+    if (requirement_it == module_index.requirements.end()) {
+        EVLOG_AND_THROW(EverestApiError(fmt::format("Requirement id '{}' not defined in manifest of module {}!",
+                                                    requirement_id, module_index.printable_identifier)));
     }
-
-    // if only one single connection entry was required, return only this one
-    // callers can check with is_array() if this is a single connection (legacy) or a connection list
-    if (requirement.at("min_connections") == 1 && requirement.at("max_connections") == 1) {
-        return module_config.at("connections").at(requirement_id).at(0);
-    }
-    return module_config.at("connections").at(requirement_id);
+    return requirement_it->second;
 }
 
-std::map<Requirement, Fulfillment> ConfigBase::resolve_requirements(const std::string& module_id) const {
-    std::map<Requirement, Fulfillment> requirements;
-
-    const auto& module_name = get_module_name(module_id);
-    for (const auto& req_id : Config::keys(this->manifests.at(module_name).at("requires"))) {
-        const auto& resolved_req = this->resolve_requirement(module_id, req_id);
-        if (!resolved_req.is_array()) {
-            const auto& resolved_module_id = resolved_req.at("module_id");
-            const auto& resolved_impl_id = resolved_req.at("implementation_id");
-            const auto req = Requirement{req_id, 0};
-            requirements[req] = {resolved_module_id, resolved_impl_id, req};
-        } else {
-            for (std::size_t i = 0; i < resolved_req.size(); i++) {
-                const auto& resolved_module_id = resolved_req.at(i).at("module_id");
-                const auto& resolved_impl_id = resolved_req.at(i).at("implementation_id");
-                const auto req = Requirement{req_id, i};
-                requirements[req] = {resolved_module_id, resolved_impl_id, req};
-            }
-        }
-    }
-
-    return requirements;
+const std::map<Requirement, Fulfillment>& ConfigBase::resolve_requirements(const std::string& module_id) const {
+    return get_module_index(module_id).fulfillments;
 }
 
 std::list<Requirement> ConfigBase::get_requirements(const std::string& module_id) const {
@@ -440,6 +505,153 @@ std::map<std::string, std::vector<Fulfillment>> ConfigBase::get_fulfillments(con
     return res;
 }
 
+/// \returns the connections of \p requirement_id in \p module_config, a single connection if the requirement allows
+/// exactly one
+static json resolve_connections(const json& module_config, const json& requirement, const std::string& requirement_id) {
+    const auto& connections = module_config.at("connections");
+    if (not connections.contains(requirement_id)) {
+        return json::array(); // return an empty array if our config does not contain any connections for this
+                              // requirement id
+    }
+
+    // if only one single connection entry was required, return only this one
+    // callers can check with is_array() if this is a single connection (legacy) or a connection list
+    if (requirement.at("min_connections") == 1 && requirement.at("max_connections") == 1) {
+        return connections.at(requirement_id).at(0);
+    }
+    return connections.at(requirement_id);
+}
+
+/// \returns the alias of the module or implementation identified by \p key in the topics of its cmds, vars and results,
+/// which is the 32 bit FNV-1a hash of the key in base 36, so every module derives the same alias on its own
+static std::string get_topic_alias(const std::string& key) {
+    std::uint32_t hash = 2166136261U;
+    for (const auto c : key) {
+        hash = (hash ^ static_cast<std::uint8_t>(c)) * 16777619U;
+    }
+    constexpr std::string_view digits = "0123456789abcdefghijklmnopqrstuvwxyz";
+    std::string alias;
+    do {
+        alias.insert(alias.begin(), digits[hash % digits.size()]);
+        hash /= digits.size();
+    } while (hash > 0);
+    return alias;
+}
+
+void ConfigBase::build_index() {
+    BOOST_LOG_FUNCTION();
+
+    // the keys of the aliases used so far by alias, the manager knows all modules and implementations and refuses to
+    // start if two of them have the same alias
+    std::unordered_map<std::string, std::string> topic_alias_keys;
+    const auto get_aliased_prefix = [this, &topic_alias_keys](const std::string& key) {
+        auto alias = get_topic_alias(key);
+        const auto [alias_it, inserted] = topic_alias_keys.emplace(alias, key);
+        if (not inserted and alias_it->second != key) {
+            EVLOG_AND_THROW(EverestConfigError(
+                fmt::format("'{}' and '{}' have the same topic alias '{}', disable mqtt_topic_aliases", key,
+                            alias_it->second, alias)));
+        }
+        return fmt::format("{}t/{}", this->mqtt_settings.everest_prefix, alias);
+    };
+
+    this->index.clear();
+    this->index.reserve(this->module_names.size());
+    for (const auto& [module_id, module_name] : this->module_names) {
+        auto& module_index = this->index[module_id];
+        module_index.name = module_name;
+        module_index.mqtt_prefix = fmt::format("{}modules/{}", this->mqtt_settings.everest_prefix, module_id);
+        module_index.printable_identifier = fmt::format("{}:{}", module_id, module_name);
+        const auto set_module_topic = [&module_index](ModuleTopic topic, const char* suffix) {
+            module_index.topics.at(static_cast<std::size_t>(topic)) = module_index.mqtt_prefix + suffix;
+        };
+        set_module_topic(ModuleTopic::CmdResult, "/res");
+        set_module_topic(ModuleTopic::Heartbeat, "/heartbeat");
+        set_module_topic(ModuleTopic::Metadata, "/metadata");
+        set_module_topic(ModuleTopic::Ready, "/ready");
+        set_module_topic(ModuleTopic::Config, "/config");
+        set_module_topic(ModuleTopic::GetConfig, "/get_config");
+        if (this->mqtt_settings.topic_aliases) {
+            // the suffixes stay the same, the receivers tell cmds, vars and results apart by them
+            module_index.topics.at(static_cast<std::size_t>(ModuleTopic::CmdResult)) =
+                get_aliased_prefix(module_id) + "/res";
+        }
+
+        // modules only receive the manifests of the modules they are connected to
+        const auto manifest_it = this->manifests.find(module_name);
+        const auto module_config_it = this->main.find(module_id);
+        if (manifest_it == this->manifests.end() or module_config_it == this->main.end()) {
+            continue;
+        }
+        module_index.indexed = true;
+
+        for (const auto& [impl_id, impl] : manifest_it->at("provides").items()) {
+            auto& impl_index = module_index.implementations[impl_id];
+            impl_index.interface = impl.at("interface");
+            impl_index.mqtt_prefix = fmt::format("{}/impl/{}", module_index.mqtt_prefix, impl_id);
+            impl_index.printable_identifier =
+                fmt::format("{}->{}:{}", module_index.printable_identifier, impl_id, impl_index.interface);
+            const auto set_impl_topic = [&impl_index](ImplementationTopic topic, const char* suffix) {
+                impl_index.topics.at(static_cast<std::size_t>(topic)) = impl_index.mqtt_prefix + suffix;
+            };
+            set_impl_topic(ImplementationTopic::Cmd, "/cmd");
+            set_impl_topic(ImplementationTopic::Var, "/var");
+            set_impl_topic(ImplementationTopic::Error, "/error/");
+            set_impl_topic(ImplementationTopic::ErrorCleared, "/error-cleared/");
+            if (this->mqtt_settings.topic_aliases) {
+                // errors keep their topics, they are subscribed to with wildcards for all modules and implementations
+                const auto aliased_prefix = get_aliased_prefix(fmt::format("{}/{}", module_id, impl_id));
+                impl_index.topics.at(static_cast<std::size_t>(ImplementationTopic::Cmd)) = aliased_prefix + "/cmd";
+                impl_index.topics.at(static_cast<std::size_t>(ImplementationTopic::Var)) = aliased_prefix + "/var";
+            }
+        }
+
+        for (const auto& [requirement_id, requirement] : manifest_it->at("requires").items()) {
+            auto connections = resolve_connections(*module_config_it, requirement, requirement_id);
+            if (not connections.is_array()) {
+                const auto req = Requirement{requirement_id, 0};
+                module_index.fulfillments[req] = {connections.at("module_id"), connections.at("implementation_id"),
+                                                  req};
+            } else {
+                for (std::size_t i = 0; i < connections.size(); i++) {
+                    const auto req = Requirement{requirement_id, i};
+                    module_index.fulfillments[req] = {connections.at(i).at("module_id"),
+                                                      connections.at(i).at("implementation_id"), req};
+                }
+            }
+            module_index.requirements.emplace(requirement_id, std::move(connections));
+        }
+    }
+}
+
+const std::string& ConfigBase::get_topic(const std::string& module_id, const std::string& impl_id,
+                                         ImplementationTopic topic) const {
+    const auto& implementations = get_module_index(module_id).implementations;
+    const auto impl_it = implementations.find(impl_id);
+    if (impl_it == implementations.end()) {
+        EVLOG_AND_THROW(EverestApiError(fmt::format("Implementation id '{}' not defined in manifest of module '{}'!",
+                                                    impl_id, module_id)));
+    }
+    return impl_it->second.topics.at(static_cast<std::size_t>(topic));
+}
+
+const std::string& ConfigBase::get_topic(const std::string& module_id, ModuleTopic topic) const {
+    const auto module_it = this->index.find(module_id);
+    if (module_it == this->index.end()) {
+        EVLOG_AND_THROW(EverestApiError(fmt::format("Module id '{}' not found in config!", module_id)));
+    }
+    return module_it->second.topics.at(static_cast<std::size_t>(topic));
+}
+
+const ModuleIndex& ConfigBase::get_module_index(const std::string& module_id) const {
+    const auto module_it = this->index.find(module_id);
+    if (module_it == this->index.end() or not module_it->second.indexed) {
+        EVLOG_AND_THROW(EverestApiError(
+            fmt::format("Requested module id '{}' not found in config or its manifest is not known!", module_id)));
+    }
+    return module_it->second;
+}
+
 std::unordered_map<std::string, ModuleTierMappings> ConfigBase::get_3_tier_model_mappings() {
     return this->tier_mappings;
 }
@@ -466,30 +678,28 @@ std::optional<Mapping> ConfigBase::get_3_tier_model_mapping(const std::string& m
 }
 
 // ManagerConfig
-void ManagerConfig::load_and_validate_manifest(const std::string& module_id, const json& module_config) {
-    const std::string module_name = module_config.at("module");
-
-    this->module_config_cache[module_id] = ConfigCache();
-    this->module_names[module_id] = module_name;
-    EVLOG_debug << fmt::format("Found module {}, loading and verifying manifest...", printable_identifier(module_id));
+json ManagerConfig::load_manifest(const std::string& module_name) const {
+    json manifest;
 
     // load and validate module manifest.json
     const fs::path manifest_path = this->ms.runtime_settings->modules_dir / module_name / "manifest.yaml";
     try {
 
         if (module_name != "ProbeModule") {
+            EVLOG_debug << fmt::format("Loading module manifest file at: {}", fs::canonical(manifest_path).string());
+            manifest = load_yaml(manifest_path);
+        } else {
             // FIXME (aw): this is implicit logic, because we know, that the ProbeModule manifest had been set up
             // manually already
-            EVLOG_debug << fmt::format("Loading module manifest file at: {}", fs::canonical(manifest_path).string());
-            this->manifests[module_name] = load_yaml(manifest_path);
+            manifest = this->manifests.at(module_name);
         }
 
         json_validator validator(Config::loader, Config::format_checker);
         validator.set_root_schema(this->_schemas.manifest);
-        const auto patch = validator.validate(this->manifests[module_name]);
+        const auto patch = validator.validate(manifest);
         if (!patch.is_null()) {
             // extend manifest with default values
-            this->manifests[module_name] = this->manifests[module_name].patch(patch);
+            manifest = manifest.patch(patch);
         }
     } catch (const std::exception& e) {
         EVLOG_AND_THROW(EverestConfigError(fmt::format("Failed to load and parse manifest file {}: {}",
@@ -498,14 +708,14 @@ void ManagerConfig::load_and_validate_manifest(const std::string& module_id, con
 
     // validate user-defined default values for the config meta-schemas
     try {
-        validate_config_schema(this->manifests[module_name]["config"]);
+        validate_config_schema(manifest["config"]);
     } catch (const std::exception& e) {
         EVLOG_AND_THROW(EverestConfigError(
             fmt::format("Failed to validate the module configuration meta-schema for module '{}'. Reason:\n{}",
                         module_name, e.what())));
     }
 
-    for (const auto& impl : this->manifests[module_name]["provides"].items()) {
+    for (const auto& impl : manifest["provides"].items()) {
         try {
             validate_config_schema(impl.value().at("config"));
         } catch (const std::exception& e) {
@@ -516,6 +726,32 @@ void ManagerConfig::load_and_validate_manifest(const std::string& module_id, con
         }
     }
 
+    return manifest;
+}
+
+void ManagerConfig::load_manifests(const std::set<std::string>& module_names) {
+    const std::vector<std::string> names(module_names.begin(), module_names.end());
+    std::vector<json> manifests(names.size());
+    parallel_for(names.size(), [&](std::size_t index) { manifests.at(index) = load_manifest(names.at(index)); });
+
+    std::set<std::string> interface_names;
+    for (std::size_t index = 0; index < names.size(); index++) {
+        for (const auto& impl : manifests.at(index).at("provides").items()) {
+            interface_names.insert(impl.value().at("interface").get<std::string>());
+        }
+        this->manifests[names.at(index)] = std::move(manifests.at(index));
+    }
+
+    resolve_interfaces(interface_names);
+}
+
+void ManagerConfig::load_and_validate_manifest(const std::string& module_id, const json& module_config) {
+    const std::string module_name = module_config.at("module");
+
+    this->module_config_cache[module_id] = ConfigCache();
+    this->module_names[module_id] = module_name;
+    EVLOG_debug << fmt::format("Found module {}, verifying manifest...", printable_identifier(module_id));
+
     const std::set<std::string> provided_impls = Config::keys(this->manifests[module_name]["provides"]);
 
     this->interfaces[module_name] = json({});
@@ -524,9 +760,7 @@ void ManagerConfig::load_and_validate_manifest(const std::string& module_id, con
     for (const auto& impl_id : provided_impls) {
         EVLOG_debug << fmt::format("Loading interface for implementation: {}", impl_id);
         auto intf_name = this->manifests[module_name]["provides"][impl_id]["interface"].get<std::string>();
-        auto seen_interfaces = std::set<std::string>();
         this->interfaces[module_name][impl_id] = intf_name;
-        resolve_interface(intf_name);
         this->module_config_cache[module_name].cmds[impl_id] = this->interface_definitions.at(intf_name).at("cmds");
     }
 
@@ -609,7 +843,8 @@ void ManagerConfig::load_and_validate_manifest(const std::string& module_id, con
     }
 }
 
-std::tuple<json, int64_t> ManagerConfig::load_and_validate_with_schema(const fs::path& file_path, const json& schema) {
+std::tuple<json, int64_t> ManagerConfig::load_and_validate_with_schema(const fs::path& file_path,
+                                                                       const json& schema) const {
     const json json_to_validate = load_yaml(file_path);
     int64_t validation_ms = 0;
 
@@ -629,15 +864,22 @@ std::tuple<json, int64_t> ManagerConfig::load_and_validate_with_schema(const fs:
     return {json_to_validate, validation_ms};
 }
 
-json ManagerConfig::resolve_interface(const std::string& intf_name) {
-    // load and validate interface.json and mark interface as seen
-    const auto intf_definition = load_interface_file(intf_name);
+void ManagerConfig::resolve_interfaces(const std::set<std::string>& intf_names) {
+    std::vector<std::string> missing;
+    std::copy_if(intf_names.begin(), intf_names.end(), std::back_inserter(missing),
+                 [this](const std::string& intf_name) { return not this->interface_definitions.contains(intf_name); });
 
-    this->interface_definitions[intf_name] = intf_definition;
-    return intf_definition;
+    // load and validate interface files in parallel, they do not depend on each other
+    std::vector<json> intf_definitions(missing.size());
+    parallel_for(missing.size(),
+                 [&](std::size_t index) { intf_definitions.at(index) = load_interface_file(missing.at(index)); });
+
+    for (std::size_t index = 0; index < missing.size(); index++) {
+        this->interface_definitions[missing.at(index)] = std::move(intf_definitions.at(index));
+    }
 }
 
-json ManagerConfig::load_interface_file(const std::string& intf_name) {
+json ManagerConfig::load_interface_file(const std::string& intf_name) const {
     BOOST_LOG_FUNCTION();
     const fs::path intf_path = this->ms.interfaces_dir / (intf_name + ".yaml");
     try {
@@ -666,6 +908,9 @@ json ManagerConfig::load_interface_file(const std::string& intf_name) {
         validator.set_root_schema(draft07);
         for (auto& var_entry : interface_json["vars"].items()) {
             auto& var_value = var_entry.value();
+            if (this->ms.mqtt_qos.has_value()) {
+                var_value["qos"] = this->ms.mqtt_qos.value();
+            }
             // erase "description"
             if (var_value.contains("description")) {
                 var_value.erase("description");
@@ -692,6 +937,9 @@ json ManagerConfig::load_interface_file(const std::string& intf_name) {
             if (cmd.contains("description")) {
                 cmd.erase("description");
             }
+            if (this->ms.mqtt_qos.has_value()) {
+                cmd["qos"] = this->ms.mqtt_qos.value();
+            }
             for (auto& arguments_entry : cmd["arguments"].items()) {
                 auto& arg_entry = arguments_entry.value();
                 // erase "description"
@@ -715,7 +963,7 @@ json ManagerConfig::load_interface_file(const std::string& intf_name) {
     }
 }
 
-std::list<json> ManagerConfig::resolve_error_ref(const std::string& reference) {
+std::list<json> ManagerConfig::resolve_error_ref(const std::string& reference) const {
     BOOST_LOG_FUNCTION();
     const std::string ref_prefix = "/errors/";
     const std::string err_ref = reference.substr(ref_prefix.length());
@@ -752,7 +1000,7 @@ std::list<json> ManagerConfig::resolve_error_ref(const std::string& reference) {
     return errors;
 }
 
-json ManagerConfig::replace_error_refs(json& interface_json) {
+json ManagerConfig::replace_error_refs(json& interface_json) const {
     BOOST_LOG_FUNCTION();
     if (!interface_json.contains("errors")) {
         return interface_json;
@@ -891,70 +1139,65 @@ void ManagerConfig::parse(json config) {
     this->main = std::move(config);
     // load type files
     if (this->ms.runtime_settings->validate_schema) {
-        int64_t total_time_validation_ms = 0, total_time_parsing_ms = 0;
-        for (auto const& types_entry : fs::recursive_directory_iterator(this->ms.types_dir)) {
-            const auto start_time = std::chrono::system_clock::now();
-            const auto& type_file_path = types_entry.path();
-            if (fs::is_regular_file(type_file_path) && type_file_path.extension() == ".yaml") {
-                const auto type_path =
-                    std::string("/") + fs::relative(type_file_path, this->ms.types_dir).stem().string();
-
-                try {
-                    // load and validate type file, store validated result in this->types
-                    EVLOG_verbose << fmt::format("Loading type file at: {}", fs::canonical(type_file_path).c_str());
-
-                    const auto [type_json, validate_ms] =
-                        load_and_validate_with_schema(type_file_path, this->_schemas.type);
-                    total_time_validation_ms += validate_ms;
-
-                    this->types[type_path] = type_json.at("types");
-                } catch (const std::exception& e) {
-                    EVLOG_AND_THROW(EverestConfigError(fmt::format(
-                        "Failed to load and parse type file '{}', reason: {}", type_file_path.string(), e.what())));
-                }
+        const auto start_time = std::chrono::system_clock::now();
+        const auto type_file_paths = find_yaml_files(this->ms.types_dir);
+        std::vector<json> type_jsons(type_file_paths.size());
+        std::vector<int64_t> validate_ms(type_file_paths.size());
+        parallel_for(type_file_paths.size(), [&](std::size_t index) {
+            const auto& type_file_path = type_file_paths.at(index);
+            try {
+                // load and validate type file, the validated results are stored in this->types below
+                EVLOG_verbose << fmt::format("Loading type file at: {}", fs::canonical(type_file_path).c_str());
+
+                auto [type_json, type_validate_ms] = load_and_validate_with_schema(type_file_path, this->_schemas.type);
+                type_jsons.at(index) = std::move(type_json.at("types"));
+                validate_ms.at(index) = type_validate_ms;
+            } catch (const std::exception& e) {
+                EVLOG_AND_THROW(EverestConfigError(fmt::format(
+                    "Failed to load and parse type file '{}', reason: {}", type_file_path.string(), e.what())));
             }
-            const auto end_time = std::chrono::system_clock::now();
-            total_time_parsing_ms +=
-                std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
-            EVLOG_debug << "Parsing of type " << types_entry.path().string() << " took: "
-                        << std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count() << "ms";
+        });
+
+        for (std::size_t index = 0; index < type_file_paths.size(); index++) {
+            const auto type_path =
+                std::string("/") + fs::relative(type_file_paths.at(index), this->ms.types_dir).stem().string();
+            this->types[type_path] = std::move(type_jsons.at(index));
         }
-        EVLOG_info << "- Types loaded in [" << total_time_parsing_ms - total_time_validation_ms << "ms]";
-        EVLOG_info << "- Types validated [" << total_time_validation_ms << "ms]";
+        const auto end_time = std::chrono::system_clock::now();
+        EVLOG_info << "- Types loaded in ["
+                   << std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count() << "ms]";
+        EVLOG_info << "- Types validated [" << std::accumulate(validate_ms.begin(), validate_ms.end(), int64_t{0})
+                   << "ms] on all threads";
     }
 
     // load error files
     if (this->ms.runtime_settings->validate_schema) {
-        int64_t total_time_validation_ms = 0, total_time_parsing_ms = 0;
-        for (auto const& errors_entry : fs::recursive_directory_iterator(this->ms.errors_dir)) {
-            const auto start_time = std::chrono::system_clock::now();
-            const auto& error_file_path = errors_entry.path();
-            if (fs::is_regular_file(error_file_path) && error_file_path.extension() == ".yaml") {
-                try {
-                    // load and validate error file
-                    EVLOG_verbose << fmt::format("Loading error file at: {}", fs::canonical(error_file_path).c_str());
-
-                    const auto [error_json, validate_ms] =
-                        load_and_validate_with_schema(error_file_path, this->_schemas.error_declaration_list);
-                    total_time_validation_ms += validate_ms;
-
-                } catch (const std::exception& e) {
-                    EVLOG_AND_THROW(EverestConfigError(fmt::format(
-                        "Failed to load and parse error file '{}', reason: {}", error_file_path.string(), e.what())));
-                }
+        const auto start_time = std::chrono::system_clock::now();
+        const auto error_file_paths = find_yaml_files(this->ms.errors_dir);
+        std::vector<int64_t> validate_ms(error_file_paths.size());
+        parallel_for(error_file_paths.size(), [&](std::size_t index) {
+            const auto& error_file_path = error_file_paths.at(index);
+            try {
+                // load and validate error file
+                EVLOG_verbose << fmt::format("Loading error file at: {}", fs::canonical(error_file_path).c_str());
+
+                validate_ms.at(index) = std::get<int64_t>(
+                    load_and_validate_with_schema(error_file_path, this->_schemas.error_declaration_list));
+            } catch (const std::exception& e) {
+                EVLOG_AND_THROW(EverestConfigError(fmt::format(
+                    "Failed to load and parse error file '{}', reason: {}", error_file_path.string(), e.what())));
             }
-            const auto end_time = std::chrono::system_clock::now();
-            total_time_parsing_ms +=
-                std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
-            EVLOG_debug << "Parsing of error " << errors_entry.path().string() << " took: "
-                        << std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count() << "ms";
-        }
-        EVLOG_info << "- Errors loaded in [" << total_time_parsing_ms - total_time_validation_ms << "ms]";
-        EVLOG_info << "- Errors validated [" << total_time_validation_ms << "ms]";
+        });
+        const auto end_time = std::chrono::system_clock::now();
+        EVLOG_info << "- Errors loaded in ["
+                   << std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count() << "ms]";
+        EVLOG_info << "- Errors validated [" << std::accumulate(validate_ms.begin(), validate_ms.end(), int64_t{0})
+                   << "ms] on all threads";
     }
     std::optional<std::string> probe_module_id;
 
-    // load manifest files of configured modules
+    // load manifest files and the interfaces they provide of configured modules, those only depend on the files
+    std::set<std::string> module_names;
     for (const auto& element : this->main.items()) {
         const auto& module_id = element.key();
         const auto& module_config = element.value();
@@ -967,12 +1210,21 @@ void ManagerConfig::parse(json config) {
             continue;
         }
 
-        load_and_validate_manifest(module_id, module_config);
+        module_names.insert(module_config.at("module").get<std::string>());
+    }
+    load_manifests(module_names);
+
+    for (const auto& element : this->main.items()) {
+        if (element.key() != probe_module_id) {
+            load_and_validate_manifest(element.key(), element.value());
+        }
     }
 
     if (probe_module_id) {
+        // the ProbeModule manifest is derived from the manifests of the modules it is connected to
         setup_probe_module_manifest(*probe_module_id, this->main, this->manifests);
 
+        load_manifests({"ProbeModule"});
         load_and_validate_manifest(*probe_module_id, this->main.at(*probe_module_id));
     }
 
@@ -983,13 +1235,14 @@ void ManagerConfig::parse(json config) {
         if (module_config.contains("telemetry")) {
             const auto& telemetry = module_config.at("telemetry");
             if (telemetry.contains("id")) {
-                this->telemetry_configs[module_id].emplace(TelemetryConfig{telemetry.at("id").get<int>()});
+                this->telemetry_configs[module_id] = telemetry.get<TelemetryConfig>();
             }
         }
     }
 
     resolve_all_requirements();
     parse_3_tier_model_mapping();
+    build_index();
 
     // TODO: cleanup "descriptions" from config ?
 }
@@ -1042,27 +1295,114 @@ void ManagerConfig::parse_3_tier_model_mapping() {
     }
 }
 
+std::vector<fs::path> ManagerConfig::get_compiled_config_inputs(const fs::path& user_config_path) const {
+    std::vector<fs::path> inputs{this->ms.config_file, user_config_path};
+    for (const auto& dir : {this->ms.schemas_dir, this->ms.interfaces_dir, this->ms.types_dir, this->ms.errors_dir}) {
+        const auto files = CompiledConfigCache::find_files(dir);
+        inputs.insert(inputs.end(), files.begin(), files.end());
+    }
+
+    std::vector<fs::path> manifest_paths;
+    const auto& modules_dir = this->ms.runtime_settings->modules_dir;
+    if (fs::is_directory(modules_dir)) {
+        for (const auto& module_entry : fs::directory_iterator(modules_dir)) {
+            const auto manifest_path = module_entry.path() / "manifest.yaml";
+            if (fs::is_regular_file(manifest_path)) {
+                manifest_paths.push_back(manifest_path);
+            }
+        }
+    }
+    std::sort(manifest_paths.begin(), manifest_paths.end());
+    inputs.insert(inputs.end(), manifest_paths.begin(), manifest_paths.end());
+    return inputs;
+}
+
+json ManagerConfig::serialize_compiled() {
+    json telemetry_configs = json::object();
+    for (const auto& [module_id, telemetry_config] : this->telemetry_configs) {
+        if (telemetry_config.has_value()) {
+            telemetry_configs[module_id] = telemetry_config.value();
+        }
+    }
+
+    return {{"main", this->main},
+            {"manifests", this->manifests},
+            {"interfaces", this->interfaces},
+            {"interface_definitions", this->interface_definitions},
+            {"types", this->types},
+            {"schemas", this->_schemas},
+            {"error_map", this->error_map.get_error_types()},
+            {"module_names", this->module_names},
+            {"module_config_cache", this->module_config_cache},
+            {"mappings", this->tier_mappings},
+            {"telemetry_configs", telemetry_configs}};
+}
+
+void ManagerConfig::load_compiled(const json& compiled) {
+    this->main = compiled.at("main");
+    this->manifests = compiled.at("manifests");
+    this->interfaces = compiled.at("interfaces");
+    this->interface_definitions = compiled.at("interface_definitions");
+    this->types = compiled.at("types");
+    this->_schemas = compiled.at("schemas");
+    this->error_map = error::ErrorTypeMap();
+    this->error_map.load_error_types_map(compiled.at("error_map"));
+    this->module_names = compiled.at("module_names");
+    this->module_config_cache = compiled.at("module_config_cache");
+    this->tier_mappings = compiled.at("mappings");
+    this->telemetry_configs.clear();
+    for (const auto& [module_id, telemetry_config] : compiled.at("telemetry_configs").items()) {
+        this->telemetry_configs[module_id].emplace(telemetry_config.get<TelemetryConfig>());
+    }
+    build_index();
+}
+
 ManagerConfig::ManagerConfig(const ManagerSettings& ms) : ConfigBase(ms.mqtt_settings), ms(ms) {
     BOOST_LOG_FUNCTION();
 
+    const fs::path config_path = this->ms.config_file;
+    // try to load user config from a directory "user-config" that might be in the same parent directory as the
+    // config_file. The config is supposed to have the same name as the parent config.
+    // TODO(kai): introduce a parameter that can overwrite the location of the user config?
+    // TODO(kai): or should we introduce a "meta-config" that references all configs that should be merged here?
+    const auto user_config_path = config_path.parent_path() / "user-config" / config_path.filename();
+    this->settings = this->ms.get_runtime_settings();
+
+    std::optional<CompiledConfigCache> cache;
+    if (not this->ms.config_cache_dir.empty()) {
+        const json cache_settings = {
+            {"mqtt_qos", this->ms.mqtt_qos.has_value() ? json(this->ms.mqtt_qos.value()) : json(nullptr)},
+            {"validate_schema", this->ms.runtime_settings->validate_schema},
+            {"version_information", this->ms.version_information}};
+        cache.emplace(this->ms.config_cache_dir, config_path, get_compiled_config_inputs(user_config_path),
+                      cache_settings);
+        if (const auto compiled = cache->load()) {
+            try {
+                load_compiled(compiled.value());
+                EVLOG_info << fmt::format("Loaded compiled config from cache in {}",
+                                          this->ms.config_cache_dir.string());
+                return;
+            } catch (const std::exception& e) {
+                EVLOG_warning << fmt::format("Could not load compiled config from cache: {}", e.what());
+            }
+        }
+    }
+
     this->manifests = json({});
     this->interfaces = json({});
     this->interface_definitions = json({});
     this->types = json({});
+    this->module_names.clear();
+    this->module_config_cache.clear();
+    this->tier_mappings.clear();
+    this->telemetry_configs.clear();
     this->_schemas = Config::load_schemas(this->ms.schemas_dir);
     this->error_map = error::ErrorTypeMap(this->ms.errors_dir);
 
     // load and process config file
-    const fs::path config_path = this->ms.config_file;
-
     try {
         EVLOG_info << fmt::format("Loading config file at: {}", fs::canonical(config_path).string());
         auto complete_config = this->ms.config;
-        // try to load user config from a directory "user-config" that might be in the same parent directory as the
-        // config_file. The config is supposed to have the same name as the parent config.
-        // TODO(kai): introduce a parameter that can overwrite the location of the user config?
-        // TODO(kai): or should we introduce a "meta-config" that references all configs that should be merged here?
-        const auto user_config_path = config_path.parent_path() / "user-config" / config_path.filename();
         if (fs::exists(user_config_path)) {
             EVLOG_info << fmt::format("Loading user-config file at: {}", fs::canonical(user_config_path).string());
             auto user_config = load_yaml(user_config_path);
@@ -1081,11 +1421,14 @@ ManagerConfig::ManagerConfig(const ManagerSettings& ms) : ConfigBase(ms.mqtt_set
         }
 
         const auto config = complete_config.at("active_modules");
-        this->settings = this->ms.get_runtime_settings();
         this->parse(config);
     } catch (const std::exception& e) {
         EVLOG_AND_THROW(EverestConfigError(fmt::format("Failed to load and parse config file: {}", e.what())));
     }
+
+    if (cache.has_value()) {
+        cache->store(serialize_compiled());
+    }
 }
 
 json ManagerConfig::serialize() {
@@ -1102,6 +1445,169 @@ std::optional<TelemetryConfig> ManagerConfig::get_telemetry_config(const std::st
     return this->telemetry_configs.at(module_id);
 }
 
+/// \brief collects the type files referenced by "$ref" entries anywhere in \p schema into \p type_files
+static void collect_type_refs(const json& schema, std::set<std::string>& type_files) {
+    if (schema.is_object()) {
+        for (const auto& [key, value] : schema.items()) {
+            if (key == "$ref" and value.is_string()) {
+                const auto& ref = value.get_ref<const std::string&>();
+                // refs within the same type file start with #, those are already included
+                if (not ref.empty() and ref.front() == '/') {
+                    type_files.insert(ref.substr(0, ref.find('#')));
+                }
+            } else {
+                collect_type_refs(value, type_files);
+            }
+        }
+    } else if (schema.is_array()) {
+        for (const auto& value : schema) {
+            collect_type_refs(value, type_files);
+        }
+    }
+}
+
+json ManagerConfig::get_module_config_slice(const std::string& module_id) const {
+    BOOST_LOG_FUNCTION();
+
+    const auto& module_name = this->get_module_name(module_id);
+    const auto& manifest = this->manifests.at(module_name);
+    if (manifest.value("enable_global_errors", false)) {
+        // the module subscribes to the errors of every module, so it needs to know all of them
+        return {{"manifests", this->manifests},
+                {"interface_definitions", this->interface_definitions},
+                {"types", this->types},
+                {"error_map", this->error_map.get_error_types()},
+                {"module_config_cache", this->module_config_cache}};
+    }
+
+    // the module itself and every module it is connected to
+    std::set<std::string> module_names{module_name};
+    std::set<std::string> interface_names;
+    for (const auto& impl : manifest.at("provides").items()) {
+        interface_names.insert(impl.value().at("interface").get<std::string>());
+    }
+    for (const auto& requirement : manifest.at("requires").items()) {
+        interface_names.insert(requirement.value().at("interface").get<std::string>());
+    }
+    for (const auto& connections : this->main.at(module_id).value("connections", json::object()).items()) {
+        for (const auto& connection : connections.value()) {
+            module_names.insert(this->get_module_name(connection.at("module_id")));
+            interface_names.insert(connection.at("provides").at("interface").get<std::string>());
+        }
+    }
+
+    json manifests = json::object();
+    std::unordered_map<std::string, ConfigCache> module_config_cache;
+    for (const auto& name : module_names) {
+        manifests[name] = this->manifests.at(name);
+        module_config_cache[name] = this->module_config_cache.at(name);
+    }
+
+    json interface_definitions = json::object();
+    std::set<std::string> type_files;
+    std::set<std::string> error_namespaces;
+    for (const auto& interface_name : interface_names) {
+        const auto& interface_definition = this->interface_definitions.at(interface_name);
+        collect_type_refs(interface_definition, type_files);
+        for (const auto& error_namespace : interface_definition.value("errors", json::object()).items()) {
+            error_namespaces.insert(error_namespace.key());
+        }
+        interface_definitions[interface_name] = interface_definition;
+    }
+
+    // types can reference other type files, so add referenced files until no new ones show up
+    json types = json::object();
+    std::vector<std::string> pending_type_files(type_files.begin(), type_files.end());
+    while (not pending_type_files.empty()) {
+        const auto type_file = std::move(pending_type_files.back());
+        pending_type_files.pop_back();
+        const auto type_it = this->types.find(type_file);
+        if (type_it == this->types.end()) {
+            // types are only loaded with schema validation enabled
+            continue;
+        }
+        types[type_file] = *type_it;
+        std::set<std::string> referenced_type_files;
+        collect_type_refs(*type_it, referenced_type_files);
+        for (const auto& referenced_type_file : referenced_type_files) {
+            if (type_files.insert(referenced_type_file).second) {
+                pending_type_files.push_back(referenced_type_file);
+            }
+        }
+    }
+
+    return {{"manifests", std::move(manifests)},
+            {"interface_definitions", std::move(interface_definitions)},
+            {"types", std::move(types)},
+            {"error_map", this->error_map.get_error_types(error_namespaces)},
+            {"module_config_cache", std::move(module_config_cache)}};
+}
+
+/// \returns the 3 tier model mappings of \p module_id in \p config as json, null if there are none
+static json get_mappings_json(const ConfigBase& config, const std::string& module_id) {
+    const auto mappings = config.get_module_3_tier_model_mappings(module_id);
+    return mappings.has_value() ? json(mappings.value()) : json(nullptr);
+}
+
+std::optional<std::set<std::string>> ManagerConfig::get_changed_modules(const ManagerConfig& other) const {
+    BOOST_LOG_FUNCTION();
+
+    // everything besides the active modules is shared by all modules
+    auto shared_config = this->ms.config;
+    shared_config.erase("active_modules");
+    auto other_shared_config = other.ms.config;
+    other_shared_config.erase("active_modules");
+    if (shared_config != other_shared_config or this->settings != other.settings or this->types != other.types) {
+        return std::nullopt;
+    }
+
+    std::set<std::string> changed;
+    for (const auto& [module_id, module_config] : this->main.items()) {
+        const auto other_module_config = other.main.find(module_id);
+        if (other_module_config == other.main.end() or *other_module_config != module_config) {
+            changed.insert(module_id);
+            continue;
+        }
+
+        const auto& manifest = this->manifests.at(get_module_name(module_id));
+        if (manifest != other.manifests.at(other.get_module_name(module_id))) {
+            changed.insert(module_id);
+            continue;
+        }
+
+        for (const auto& section : {"provides", "requires"}) {
+            for (const auto& entry : manifest.at(section)) {
+                const auto& interface_name = entry.at("interface").get_ref<const std::string&>();
+                if (this->interface_definitions.at(interface_name) !=
+                    other.interface_definitions.value(interface_name, json())) {
+                    changed.insert(module_id);
+                }
+            }
+        }
+    }
+    for (const auto& module : other.main.items()) {
+        if (not this->main.contains(module.key())) {
+            changed.insert(module.key());
+        }
+    }
+
+    // modules receive the mappings of the modules they are connected to
+    for (const auto& module : this->main.items()) {
+        const auto& module_id = module.key();
+        if (changed.find(module_id) != changed.end()) {
+            continue;
+        }
+        for (const auto& [requirement, fulfillment] : resolve_requirements(module_id)) {
+            if (get_mappings_json(*this, fulfillment.module_id) != get_mappings_json(other, fulfillment.module_id)) {
+                changed.insert(module_id);
+                break;
+            }
+        }
+    }
+
+    return changed;
+}
+
 // Config
 
 Config::Config(const MQTTSettings& mqtt_settings, json serialized_config) : ConfigBase(mqtt_settings) {
@@ -1122,18 +1628,19 @@ Config::Config(const MQTTSettings& mqtt_settings, json serialized_config) : Conf
     this->_schemas = serialized_config.at("schemas");
     this->error_map = error::ErrorTypeMap();
     this->error_map.load_error_types_map(serialized_config.at("error_map"));
+    build_index();
 }
 
 error::ErrorTypeMap Config::get_error_map() const {
     return this->error_map;
 }
 
-bool Config::module_provides(const std::string& module_name, const std::string& impl_id) {
+bool Config::module_provides(const std::string& module_name, const std::string& impl_id) const {
     const auto& provides = this->module_config_cache.at(module_name).provides_impl;
     return (provides.find(impl_id) != provides.end());
 }
 
-json Config::get_module_cmds(const std::string& module_name, const std::string& impl_id) {
+const json& Config::get_module_cmds(const std::string& module_name, const std::string& impl_id) const {
     return this->module_config_cache.at(module_name).cmds.at(impl_id);
 }
 
@@ -1198,9 +1705,13 @@ ModuleConfigs Config::get_module_configs(const std::string& module_id) const {
 }
 
 // FIXME (aw): check if module_id does not exist
-json Config::get_module_json_config(const std::string& module_id) {
+json Config::get_module_json_config(const std::string& module_id) const {
     BOOST_LOG_FUNCTION();
-    return this->main[module_id]["config_maps"];
+    const auto module_it = this->main.find(module_id);
+    if (module_it == this->main.end()) {
+        return nullptr;
+    }
+    return module_it->value("config_maps", json(nullptr));
 }
 
 ModuleInfo Config::get_module_info(const std::string& module_id) const {
@@ -1224,7 +1735,7 @@ ModuleInfo Config::get_module_info(const std::string& module_id) const {
     return module_info;
 }
 
-std::optional<TelemetryConfig> Config::get_telemetry_config() {
+std::optional<TelemetryConfig> Config::get_telemetry_config() const {
     return this->telemetry_config;
 }
 
@@ -1233,7 +1744,7 @@ json Config::get_interface_definition(const std::string& interface_name) const {
     return this->interface_definitions.value(interface_name, json());
 }
 
-void Config::ref_loader(const json_uri& uri, json& schema) {
+void Config::ref_loader(const json_uri& uri, json& schema) const {
     BOOST_LOG_FUNCTION();
 
     if (uri.location() == "http://json-schema.org/draft-07/schema") {
@@ -1241,8 +1752,11 @@ void Config::ref_loader(const json_uri& uri, json& schema) {
         return;
     } else {
         const auto& path = uri.path();
-        if (this->types.contains(path)) {
-            schema = this->types[path];
+        const auto type_document = this->types.find(path);
+        if (type_document != this->types.end()) {
+            // the validator takes ownership of the loaded schema, so this copy cannot be avoided, validators are
+            // cached per schema though, so each type file is only copied once per schema referencing it
+            schema = *type_document;
             EVLOG_verbose << fmt::format("ref path \"{}\" schema has been found.", path);
             return;
         } else {
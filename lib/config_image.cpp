@@ -0,0 +1,259 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include <everest/exceptions.hpp>
+#include <everest/logging.hpp>
+
+#include <utils/config_image.hpp>
+
+namespace Everest {
+
+using json = nlohmann::json;
+
+namespace {
+constexpr uint32_t CONFIG_IMAGE_MAGIC = 0x45564349; // "EVCI"
+constexpr uint32_t CONFIG_IMAGE_VERSION = 1;
+constexpr auto CONFIG_IMAGE_SEALS = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL;
+
+struct ImageHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t entry_count;
+};
+
+/// \brief Entry of the key table following the header, all offsets are relative to the start of the image
+struct ImageEntry {
+    uint64_t key_offset;
+    uint64_t key_size;
+    uint64_t value_offset;
+    uint64_t value_size;
+};
+
+std::string module_key(const std::string& module_id) {
+    return "m/" + module_id;
+}
+
+std::string blob_key(std::size_t index) {
+    return "b/" + std::to_string(index);
+}
+
+/// \brief Collects the CBOR encoded blobs of all snapshots, storing identical blobs only once
+class BlobWriter {
+public:
+    std::size_t add(const json& value) {
+        const auto cbor = json::to_cbor(value);
+        auto bytes = std::string(cbor.begin(), cbor.end());
+        const auto [it, inserted] = this->indices.emplace(std::move(bytes), this->indices.size());
+        return it->second;
+    }
+
+    /// \returns the index describing where the entries of the given \p snapshot are stored
+    json add_snapshot(const json& snapshot) {
+        json index = json::object();
+        for (const auto& [field, value] : snapshot.items()) {
+            if (value.is_object()) {
+                json entries = json::object();
+                for (const auto& [key, entry] : value.items()) {
+                    entries[key] = this->add(entry);
+                }
+                index[field] = {{"entries", std::move(entries)}};
+            } else {
+                index[field] = {{"value", this->add(value)}};
+            }
+        }
+        return index;
+    }
+
+    void move_blobs_to(std::map<std::string, std::string>& contents) {
+        for (auto& [bytes, index] : this->indices) {
+            contents.emplace(blob_key(index), bytes);
+        }
+        this->indices.clear();
+    }
+
+private:
+    std::unordered_map<std::string, std::size_t> indices;
+};
+} // namespace
+
+ConfigImage::ConfigImage(int fd, const void* image, std::size_t size) : fd(fd), image(image), size(size) {
+}
+
+ConfigImage::~ConfigImage() {
+    munmap(const_cast<void*>(this->image), this->size);
+    if (this->fd != -1) {
+        close(this->fd);
+    }
+}
+
+std::unique_ptr<ConfigImage> ConfigImage::create(const std::map<std::string, json>& module_snapshots) {
+    std::map<std::string, std::string> contents;
+    BlobWriter blobs;
+    for (const auto& [module_id, snapshot] : module_snapshots) {
+        const auto cbor = json::to_cbor(blobs.add_snapshot(snapshot));
+        contents.emplace(module_key(module_id), std::string(cbor.begin(), cbor.end()));
+    }
+    blobs.move_blobs_to(contents);
+
+    auto size = sizeof(ImageHeader) + contents.size() * sizeof(ImageEntry);
+    for (const auto& [key, value] : contents) {
+        size += key.size() + value.size();
+    }
+
+    // the memfd is deliberately created without MFD_CLOEXEC, so the spawned modules inherit it
+    const int fd = memfd_create("everest_config_image", MFD_ALLOW_SEALING);
+    if (fd == -1) {
+        throw EverestInternalError(fmt::format("Could not create config image: {}", strerror(errno)));
+    }
+    if (ftruncate(fd, static_cast<off_t>(size)) == -1) {
+        close(fd);
+        throw EverestInternalError(fmt::format("Could not resize config image: {}", strerror(errno)));
+    }
+    void* writable_image = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (writable_image == MAP_FAILED) {
+        close(fd);
+        throw EverestInternalError(fmt::format("Could not map config image: {}", strerror(errno)));
+    }
+
+    auto* bytes = static_cast<char*>(writable_image);
+    auto* header = static_cast<ImageHeader*>(writable_image);
+    header->magic = CONFIG_IMAGE_MAGIC;
+    header->version = CONFIG_IMAGE_VERSION;
+    header->entry_count = contents.size();
+    auto* entry = reinterpret_cast<ImageEntry*>(bytes + sizeof(ImageHeader));
+    auto offset = sizeof(ImageHeader) + contents.size() * sizeof(ImageEntry);
+    // std::map keeps the keys sorted, so they can be looked up with a binary search
+    for (const auto& [key, value] : contents) {
+        entry->key_offset = offset;
+        entry->key_size = key.size();
+        std::memcpy(bytes + offset, key.data(), key.size());
+        offset += key.size();
+        entry->value_offset = offset;
+        entry->value_size = value.size();
+        std::memcpy(bytes + offset, value.data(), value.size());
+        offset += value.size();
+        entry++;
+    }
+
+    // writable mappings have to be gone before the image can be sealed against writes
+    munmap(writable_image, size);
+    if (fcntl(fd, F_ADD_SEALS, CONFIG_IMAGE_SEALS) == -1) {
+        close(fd);
+        throw EverestInternalError(fmt::format("Could not seal config image: {}", strerror(errno)));
+    }
+    const void* image = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (image == MAP_FAILED) {
+        close(fd);
+        throw EverestInternalError(fmt::format("Could not map config image: {}", strerror(errno)));
+    }
+
+    EVLOG_debug << fmt::format("Created config image of {} modules with {} bytes", module_snapshots.size(), size);
+    return std::unique_ptr<ConfigImage>(new ConfigImage(fd, image, size));
+}
+
+std::unique_ptr<ConfigImage> ConfigImage::attach_from_env() {
+    // NOLINTNEXTLINE(concurrency-mt-unsafe): not problematic that this function is not threadsafe here
+    const char* fd_string = std::getenv(EV_CONFIG_IMAGE_FD);
+    if (fd_string == nullptr) {
+        return nullptr;
+    }
+
+    const int fd = std::atoi(fd_string);
+    struct stat image_stat {};
+    // only a sealed image is guaranteed to not change while it is being read
+    if (fstat(fd, &image_stat) == -1 or (fcntl(fd, F_GET_SEALS) & CONFIG_IMAGE_SEALS) != CONFIG_IMAGE_SEALS or
+        static_cast<std::size_t>(image_stat.st_size) < sizeof(ImageHeader)) {
+        EVLOG_warning << fmt::format("Ignoring invalid config image passed as fd {}", fd_string);
+        return nullptr;
+    }
+
+    const auto size = static_cast<std::size_t>(image_stat.st_size);
+    // the fd is left open, since processes spawned by the module inherit the environment variable as well
+    const void* image = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (image == MAP_FAILED) {
+        EVLOG_warning << fmt::format("Could not map config image: {}", strerror(errno));
+        return nullptr;
+    }
+
+    const auto* header = static_cast<const ImageHeader*>(image);
+    if (header->magic != CONFIG_IMAGE_MAGIC or header->version != CONFIG_IMAGE_VERSION or
+        header->entry_count > (size - sizeof(ImageHeader)) / sizeof(ImageEntry)) {
+        EVLOG_warning << "Ignoring config image with unknown format";
+        munmap(const_cast<void*>(image), size);
+        return nullptr;
+    }
+    return std::unique_ptr<ConfigImage>(new ConfigImage(-1, image, size));
+}
+
+void ConfigImage::setup_environment() const {
+    setenv(EV_CONFIG_IMAGE_FD, std::to_string(this->fd).c_str(), 1);
+}
+
+std::optional<json> ConfigImage::get_module_snapshot(const std::string& module_id) const {
+    const auto record = this->find(module_key(module_id));
+    if (not record.has_value()) {
+        return std::nullopt;
+    }
+
+    const auto record_index = json::from_cbor(record->begin(), record->end());
+    json snapshot = json::object();
+    for (const auto& [field, index] : record_index.items()) {
+        if (index.contains("entries")) {
+            auto& entries = snapshot[field] = json::object();
+            for (const auto& [key, entry_index] : index.at("entries").items()) {
+                entries[key] = this->decode_blob(entry_index);
+            }
+        } else {
+            snapshot[field] = this->decode_blob(index.at("value"));
+        }
+    }
+    return snapshot;
+}
+
+std::size_t ConfigImage::get_size() const {
+    return this->size;
+}
+
+std::optional<std::string_view> ConfigImage::find(std::string_view key) const {
+    const auto* bytes = static_cast<const char*>(this->image);
+    const auto* header = static_cast<const ImageHeader*>(this->image);
+    const auto* entries = reinterpret_cast<const ImageEntry*>(bytes + sizeof(ImageHeader));
+    const auto* entries_end = entries + header->entry_count;
+
+    const auto get_key = [bytes](const ImageEntry& entry) {
+        return std::string_view(bytes + entry.key_offset, entry.key_size);
+    };
+    const auto entry = std::lower_bound(entries, entries_end, key, [&get_key](const ImageEntry& entry,
+                                                                              std::string_view key) {
+        return get_key(entry) < key;
+    });
+    if (entry == entries_end or get_key(*entry) != key) {
+        return std::nullopt;
+    }
+    return std::string_view(bytes + entry->value_offset, entry->value_size);
+}
+
+json ConfigImage::decode_blob(const json& index) const {
+    const auto blob = this->find(blob_key(index.get<std::size_t>()));
+    if (not blob.has_value()) {
+        throw EverestInternalError(fmt::format("Config image is missing blob {}", index.dump()));
+    }
+    return json::from_cbor(blob->begin(), blob->end());
+}
+
+} // namespace Everest
@@ -2,11 +2,93 @@
 // Copyright 2020 - 2022 Pionix GmbH and Contributors to EVerest
 #include <utils/date.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <limits>
+#include <sstream>
+
 namespace Everest {
 namespace Date {
 
+namespace {
+/// Length of the date and time of day up to the seconds like 2024-01-31T12:00:00
+constexpr std::size_t RFC3339_SECONDS_LENGTH = 19;
+
+void write_digits(char* out, unsigned value, std::size_t digits) {
+    for (std::size_t i = digits; i > 0; i--) {
+        out[i - 1] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+}
+
+/// Formatted seconds of the last timestamp formatted by this thread
+struct SecondsCache {
+    bool valid{false};
+    std::chrono::time_point<date::utc_clock, std::chrono::seconds> seconds;
+    std::array<char, RFC3339_SECONDS_LENGTH> formatted{};
+};
+
+bool format_seconds(const std::chrono::time_point<date::utc_clock, std::chrono::seconds>& seconds,
+                    std::array<char, RFC3339_SECONDS_LENGTH>& out) {
+    // during a leap second the system time stays at 23:59:59, the utc time reads 23:59:60
+    const auto leap_second = date::get_leap_second_info(seconds).is_leap_second;
+    const auto sys = date::utc_clock::to_sys(seconds);
+    const auto day = date::floor<date::days>(sys);
+    const date::year_month_day ymd{day};
+    const date::hh_mm_ss<std::chrono::seconds> time_of_day{sys - day};
+    const auto year = static_cast<int>(ymd.year());
+    if (year < 0 or year > 9999) {
+        return false;
+    }
+
+    write_digits(&out[0], static_cast<unsigned>(year), 4);
+    out[4] = '-';
+    write_digits(&out[5], static_cast<unsigned>(ymd.month()), 2);
+    out[7] = '-';
+    write_digits(&out[8], static_cast<unsigned>(ymd.day()), 2);
+    out[10] = 'T';
+    write_digits(&out[11], time_of_day.hours().count(), 2);
+    out[13] = ':';
+    write_digits(&out[14], time_of_day.minutes().count(), 2);
+    out[16] = ':';
+    write_digits(&out[17], leap_second ? 60 : time_of_day.seconds().count(), 2);
+    return true;
+}
+
+/// Day of the system time the cached leap second offset is valid for
+std::atomic<std::int64_t> leap_offset_day{std::numeric_limits<std::int64_t>::min()};
+std::atomic<std::int64_t> leap_offset_ns{0};
+} // namespace
+
 std::string to_rfc3339(const std::chrono::time_point<date::utc_clock>& t) {
-    return date::format("%FT%TZ", std::chrono::time_point_cast<std::chrono::milliseconds>(t));
+    Rfc3339Buffer buffer;
+    const auto formatted = format_rfc3339(t, buffer);
+    if (formatted.empty()) {
+        return date::format("%FT%TZ", std::chrono::time_point_cast<std::chrono::milliseconds>(t));
+    }
+    return std::string(formatted);
+}
+
+std::string_view format_rfc3339(const std::chrono::time_point<date::utc_clock>& t, Rfc3339Buffer& buffer) {
+    thread_local SecondsCache cache;
+
+    const auto seconds = date::floor<std::chrono::seconds>(t);
+    if (not cache.valid or cache.seconds != seconds) {
+        cache.valid = format_seconds(seconds, cache.formatted);
+        cache.seconds = seconds;
+        if (not cache.valid) {
+            return {};
+        }
+    }
+
+    const auto milliseconds = date::floor<std::chrono::milliseconds>(t - seconds).count();
+    std::copy(cache.formatted.begin(), cache.formatted.end(), buffer.begin());
+    buffer[RFC3339_SECONDS_LENGTH] = '.';
+    write_digits(&buffer[RFC3339_SECONDS_LENGTH + 1], static_cast<unsigned>(milliseconds), 3);
+    buffer[RFC3339_LENGTH - 1] = 'Z';
+    return {buffer.data(), buffer.size()};
 }
 
 std::chrono::time_point<date::utc_clock> from_rfc3339(const std::string& t) {
@@ -16,5 +98,23 @@ std::chrono::time_point<date::utc_clock> from_rfc3339(const std::string& t) {
     return tp;
 }
 
+CoarseClock::time_point CoarseClock::now() {
+    timespec ts{};
+    clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+    const auto sys = date::sys_time<std::chrono::nanoseconds>(std::chrono::seconds(ts.tv_sec) +
+                                                              std::chrono::nanoseconds(ts.tv_nsec));
+
+    // leap seconds are inserted at the end of a day, so the offset at the start of a day is valid for all of it
+    const auto day = date::floor<date::days>(sys);
+    if (leap_offset_day.load(std::memory_order_acquire) != day.time_since_epoch().count()) {
+        const auto offset = date::utc_clock::from_sys(day).time_since_epoch() - day.time_since_epoch();
+        leap_offset_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(offset).count(),
+                             std::memory_order_relaxed);
+        leap_offset_day.store(day.time_since_epoch().count(), std::memory_order_release);
+    }
+    const auto utc = sys.time_since_epoch() + std::chrono::nanoseconds(leap_offset_ns.load(std::memory_order_relaxed));
+    return time_point(std::chrono::duration_cast<time_point::duration>(utc));
+}
+
 } // namespace Date
 } // namespace Everest
@@ -0,0 +1,36 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#include <utils/error/error_database.hpp>
+
+namespace Everest {
+namespace error {
+
+ErrorDatabase::ChangeHandlerId ErrorDatabase::add_change_handler(ErrorsChangedFunc handler) {
+    std::lock_guard<std::mutex> lock(this->change_handlers_mutex);
+    const auto id = this->next_change_handler_id++;
+    this->change_handlers.emplace(id, std::move(handler));
+    return id;
+}
+
+void ErrorDatabase::remove_change_handler(ChangeHandlerId id) {
+    std::lock_guard<std::mutex> lock(this->change_handlers_mutex);
+    this->change_handlers.erase(id);
+}
+
+std::unique_lock<std::recursive_mutex> ErrorDatabase::lock_changes() const {
+    return std::unique_lock<std::recursive_mutex>(this->changes_mutex);
+}
+
+void ErrorDatabase::notify_change(const std::list<ErrorPtr>& added, const std::list<ErrorPtr>& removed) const {
+    if (added.empty() and removed.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(this->change_handlers_mutex);
+    for (const auto& [id, handler] : this->change_handlers) {
+        handler(added, removed);
+    }
+}
+
+} // namespace error
+} // namespace Everest
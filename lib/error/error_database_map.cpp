@@ -12,13 +12,39 @@
 namespace Everest {
 namespace error {
 
-void ErrorDatabaseMap::add_error(ErrorPtr error) {
-    std::lock_guard<std::mutex> lock(this->errors_mutex);
-    if (this->errors.find(error->uuid) != this->errors.end()) {
-        EVLOG_error << "Error with handle " << error->uuid.to_string() << " already exists in ErrorDatabaseMap.";
+namespace {
+void add_to_index(std::unordered_map<std::string, std::set<ErrorHandle>>& index, const std::string& key,
+                  const ErrorHandle& handle) {
+    index[key].insert(handle);
+}
+
+void remove_from_index(std::unordered_map<std::string, std::set<ErrorHandle>>& index, const std::string& key,
+                       const ErrorHandle& handle) {
+    const auto it = index.find(key);
+    if (it == index.end()) {
         return;
     }
-    this->errors[error->uuid] = error;
+    it->second.erase(handle);
+    if (it->second.empty()) {
+        index.erase(it);
+    }
+}
+} // namespace
+
+void ErrorDatabaseMap::add_error(ErrorPtr error) {
+    const auto changes_lock = this->lock_changes();
+    {
+        std::lock_guard<std::mutex> lock(this->errors_mutex);
+        if (this->errors.find(error->uuid) != this->errors.end()) {
+            EVLOG_error << "Error with handle " << error->uuid.to_string() << " already exists in ErrorDatabaseMap.";
+            return;
+        }
+        this->errors[error->uuid] = error;
+        add_to_index(this->type_index, error->type, error->uuid);
+        add_to_index(this->sub_type_index, error->sub_type, error->uuid);
+        add_to_index(this->origin_index, error->origin.to_string(), error->uuid);
+    }
+    this->notify_change({error}, {});
 }
 
 std::list<ErrorPtr> ErrorDatabaseMap::get_errors(const std::list<ErrorFilter>& filters) const {
@@ -29,15 +55,38 @@ std::list<ErrorPtr> ErrorDatabaseMap::get_errors(const std::list<ErrorFilter>& f
 std::list<ErrorPtr> ErrorDatabaseMap::get_errors_no_mutex(const std::list<ErrorFilter>& filters) const {
     BOOST_LOG_FUNCTION();
 
+    // start from the smallest candidate set any of the filters provides, the filters are applied to these only
     std::list<ErrorPtr> result;
-    std::transform(this->errors.begin(), this->errors.end(), std::back_inserter(result),
-                   [](const std::pair<ErrorHandle, ErrorPtr>& entry) { return entry.second; });
+    const auto handle_filter = std::find_if(filters.begin(), filters.end(), [](const ErrorFilter& filter) {
+        return filter.get_filter_type() == FilterType::Handle;
+    });
+    if (handle_filter != filters.end()) {
+        const auto it = this->errors.find(handle_filter->get_handle_filter());
+        if (it != this->errors.end()) {
+            result.push_back(it->second);
+        }
+    } else {
+        const std::set<ErrorHandle>* candidates = nullptr;
+        for (const ErrorFilter& filter : filters) {
+            const auto* handles = this->get_indexed_handles(filter);
+            if (handles != nullptr and (candidates == nullptr or handles->size() < candidates->size())) {
+                candidates = handles;
+            }
+        }
+        if (candidates != nullptr) {
+            std::transform(candidates->begin(), candidates->end(), std::back_inserter(result),
+                           [this](const ErrorHandle& handle) { return this->errors.at(handle); });
+        } else {
+            std::transform(this->errors.begin(), this->errors.end(), std::back_inserter(result),
+                           [](const std::pair<ErrorHandle, ErrorPtr>& entry) { return entry.second; });
+        }
+    }
 
     for (const ErrorFilter& filter : filters) {
         std::function<bool(const ErrorPtr&)> pred;
         switch (filter.get_filter_type()) {
         case FilterType::State: {
-            pred = [](const ErrorPtr& error) { return false; };
+            pred = [](const ErrorPtr&) { return false; };
             EVLOG_error << "ErrorDatabaseMap does not support StateFilter. Ignoring.";
         } break;
         case FilterType::Origin: {
@@ -88,6 +137,37 @@ std::list<ErrorPtr> ErrorDatabaseMap::get_errors_no_mutex(const std::list<ErrorF
     return result;
 }
 
+const std::set<ErrorHandle>* ErrorDatabaseMap::get_indexed_handles(const ErrorFilter& filter) const {
+    static const std::set<ErrorHandle> no_handles;
+    const HandleIndex* index = nullptr;
+    std::string key;
+    switch (filter.get_filter_type()) {
+    case FilterType::Type:
+        index = &this->type_index;
+        key = filter.get_type_filter().value;
+        break;
+    case FilterType::SubType:
+        index = &this->sub_type_index;
+        key = filter.get_sub_type_filter().value;
+        break;
+    case FilterType::Origin:
+        index = &this->origin_index;
+        key = filter.get_origin_filter().to_string();
+        break;
+    default:
+        return nullptr;
+    }
+    const auto it = index->find(key);
+    return it != index->end() ? &it->second : &no_handles;
+}
+
+void ErrorDatabaseMap::remove_error_no_mutex(const ErrorPtr& error) {
+    remove_from_index(this->type_index, error->type, error->uuid);
+    remove_from_index(this->sub_type_index, error->sub_type, error->uuid);
+    remove_from_index(this->origin_index, error->origin.to_string(), error->uuid);
+    this->errors.erase(error->uuid);
+}
+
 std::list<ErrorPtr> ErrorDatabaseMap::edit_errors(const std::list<ErrorFilter>& filters, EditErrorFunc edit_func) {
     std::lock_guard<std::mutex> lock(this->errors_mutex);
     std::list<ErrorPtr> result = this->get_errors_no_mutex(filters);
@@ -99,8 +179,11 @@ std::list<ErrorPtr> ErrorDatabaseMap::edit_errors(const std::list<ErrorFilter>&
 
 std::list<ErrorPtr> ErrorDatabaseMap::remove_errors(const std::list<ErrorFilter>& filters) {
     BOOST_LOG_FUNCTION();
-    EditErrorFunc remove_func = [this](const ErrorPtr& error) { this->errors.erase(error->uuid); };
-    return this->edit_errors(filters, remove_func);
+    const auto changes_lock = this->lock_changes();
+    EditErrorFunc remove_func = [this](const ErrorPtr& error) { this->remove_error_no_mutex(error); };
+    const auto removed = this->edit_errors(filters, remove_func);
+    this->notify_change({}, removed);
+    return removed;
 }
 
 } // namespace error
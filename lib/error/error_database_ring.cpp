@@ -0,0 +1,268 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#include <utils/error/error_database_ring.hpp>
+#include <utils/error/error_pool.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include <everest/exceptions.hpp>
+#include <everest/logging.hpp>
+
+namespace Everest {
+namespace error {
+
+namespace {
+constexpr std::uint32_t ERROR_RING_MAGIC = 0x45564552; // "EVER"
+constexpr std::uint32_t ERROR_RING_VERSION = 1;
+} // namespace
+
+struct ErrorRingHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t record_size;
+    std::uint64_t capacity;
+    std::uint64_t written; ///< Number of errors ever added, the next one is stored in slot written % capacity
+};
+
+/// \brief Compact error with fixed size strings, so the ring can be mapped from a file
+struct ErrorRecord {
+    char uuid[40];
+    char type[96];
+    char sub_type[64];
+    char message[128];
+    char description[128];
+    char origin_module[64];
+    char origin_implementation[64];
+    char vendor_id[32];
+    std::int64_t timestamp_ns;
+    std::uint8_t severity;
+    std::uint8_t state;
+};
+
+namespace {
+template <std::size_t N> void copy_string(char (&destination)[N], const std::string& source) {
+    const auto size = std::min(source.size(), N - 1);
+    std::memcpy(destination, source.data(), size);
+    std::memset(destination + size, 0, N - size);
+}
+
+template <std::size_t N> std::string read_string(const char (&source)[N]) {
+    return std::string(source, strnlen(source, N));
+}
+
+std::int64_t to_ns(const Error::time_point& time_point) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time_point.time_since_epoch()).count();
+}
+
+void write_record(ErrorRecord& record, const Error& error) {
+    copy_string(record.uuid, error.uuid.to_string());
+    copy_string(record.type, error.type);
+    copy_string(record.sub_type, error.sub_type);
+    copy_string(record.message, error.message);
+    copy_string(record.description, error.description);
+    copy_string(record.origin_module, error.origin.module_id);
+    copy_string(record.origin_implementation, error.origin.implementation_id);
+    copy_string(record.vendor_id, error.vendor_id);
+    record.timestamp_ns = to_ns(error.timestamp);
+    record.severity = static_cast<std::uint8_t>(error.severity);
+    record.state = static_cast<std::uint8_t>(error.state);
+}
+
+ErrorPtr read_record(const ErrorRecord& record) {
+    const auto timestamp = Error::time_point(
+        std::chrono::duration_cast<Error::time_point::duration>(std::chrono::nanoseconds(record.timestamp_ns)));
+    return make_error(
+        read_string(record.type), read_string(record.sub_type), read_string(record.message),
+        read_string(record.description),
+        ImplementationIdentifier(read_string(record.origin_module), read_string(record.origin_implementation)),
+        read_string(record.vendor_id), static_cast<Severity>(record.severity), timestamp,
+        UUID(read_string(record.uuid)), static_cast<State>(record.state));
+}
+
+bool matches_all(const Error& error, const std::list<ErrorFilter>& filters) {
+    return std::all_of(filters.begin(), filters.end(),
+                       [&error](const ErrorFilter& filter) { return filter.matches(error); });
+}
+} // namespace
+
+ErrorDatabaseRing::ErrorDatabaseRing(std::size_t capacity_, const std::string& file) : capacity(capacity_) {
+    if (this->capacity == 0) {
+        throw EverestInternalError("The capacity of an error ring has to be at least 1");
+    }
+    const auto size = sizeof(ErrorRingHeader) + this->capacity * sizeof(ErrorRecord);
+    void* memory = nullptr;
+    if (file.empty()) {
+        memory = ::operator new(size);
+        std::memset(memory, 0, size);
+    } else {
+        const int fd = open(file.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw EverestInternalError(fmt::format("Could not open error ring {}: {}", file, strerror(errno)));
+        }
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            close(fd);
+            throw EverestInternalError(fmt::format("Could not resize error ring {}: {}", file, strerror(errno)));
+        }
+        memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (memory == MAP_FAILED) {
+            throw EverestInternalError(fmt::format("Could not map error ring {}: {}", file, strerror(errno)));
+        }
+        this->mapped_size = size;
+    }
+
+    this->header = static_cast<ErrorRingHeader*>(memory);
+    this->records = reinterpret_cast<ErrorRecord*>(static_cast<char*>(memory) + sizeof(ErrorRingHeader));
+    if (this->header->magic != ERROR_RING_MAGIC or this->header->version != ERROR_RING_VERSION or
+        this->header->record_size != sizeof(ErrorRecord) or this->header->capacity != this->capacity) {
+        if (this->header->magic != 0) {
+            EVLOG_warning << fmt::format("Discarding error ring {} with a different capacity or format", file);
+        }
+        std::memset(memory, 0, size);
+        this->header->magic = ERROR_RING_MAGIC;
+        this->header->version = ERROR_RING_VERSION;
+        this->header->record_size = sizeof(ErrorRecord);
+        this->header->capacity = this->capacity;
+        this->header->written = 0;
+    }
+
+    for (std::size_t slot = 0; slot < this->size(); slot++) {
+        this->index_slot_no_mutex(slot);
+    }
+}
+
+ErrorDatabaseRing::~ErrorDatabaseRing() {
+    if (this->mapped_size != 0) {
+        munmap(this->header, this->mapped_size);
+    } else {
+        ::operator delete(this->header);
+    }
+}
+
+std::size_t ErrorDatabaseRing::size() const {
+    return std::min<std::size_t>(this->header->written, this->capacity);
+}
+
+void ErrorDatabaseRing::index_slot_no_mutex(std::size_t slot) {
+    const auto& record = this->records[slot];
+    this->time_index.emplace(record.timestamp_ns, slot);
+    this->handle_index[read_string(record.uuid)] = slot;
+}
+
+void ErrorDatabaseRing::unindex_slot_no_mutex(std::size_t slot) {
+    const auto& record = this->records[slot];
+    const auto range = this->time_index.equal_range(record.timestamp_ns);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == slot) {
+            this->time_index.erase(it);
+            break;
+        }
+    }
+    this->handle_index.erase(read_string(record.uuid));
+}
+
+void ErrorDatabaseRing::add_error(ErrorPtr error) {
+    const auto changes_lock = this->lock_changes();
+    {
+        std::lock_guard<std::mutex> lock(this->records_mutex);
+        if (this->handle_index.find(error->uuid.to_string()) != this->handle_index.end()) {
+            EVLOG_error << "Error with handle " << error->uuid.to_string() << " already exists in ErrorDatabaseRing.";
+            return;
+        }
+        const auto slot = this->header->written % this->capacity;
+        if (this->header->written >= this->capacity) {
+            this->unindex_slot_no_mutex(slot);
+        }
+        write_record(this->records[slot], *error);
+        this->header->written++;
+        this->index_slot_no_mutex(slot);
+    }
+    this->notify_change({error}, {});
+}
+
+std::list<std::size_t> ErrorDatabaseRing::find_slots_no_mutex(const std::list<ErrorFilter>& filters) const {
+    std::list<std::size_t> slots;
+    const auto matches = [this, &filters](std::size_t slot) {
+        return matches_all(*read_record(this->records[slot]), filters);
+    };
+
+    const auto handle_filter = std::find_if(filters.begin(), filters.end(), [](const ErrorFilter& filter) {
+        return filter.get_filter_type() == FilterType::Handle;
+    });
+    if (handle_filter != filters.end()) {
+        const auto it = this->handle_index.find(handle_filter->get_handle_filter().to_string());
+        if (it != this->handle_index.end() and matches(it->second)) {
+            slots.push_back(it->second);
+        }
+        return slots;
+    }
+
+    // time periods are looked up in the time index, further filters are checked on each record in the period
+    auto begin = this->time_index.begin();
+    auto end = this->time_index.end();
+    const auto time_period_filter = std::find_if(filters.begin(), filters.end(), [](const ErrorFilter& filter) {
+        return filter.get_filter_type() == FilterType::TimePeriod;
+    });
+    if (time_period_filter != filters.end()) {
+        const auto period = time_period_filter->get_time_period_filter();
+        if (period.from > period.to) {
+            return slots;
+        }
+        begin = this->time_index.lower_bound(to_ns(period.from));
+        end = this->time_index.upper_bound(to_ns(period.to));
+    }
+    for (auto it = begin; it != end; ++it) {
+        if (matches(it->second)) {
+            slots.push_back(it->second);
+        }
+    }
+    return slots;
+}
+
+std::list<ErrorPtr> ErrorDatabaseRing::get_errors(const std::list<ErrorFilter>& filters) const {
+    std::lock_guard<std::mutex> lock(this->records_mutex);
+    std::list<ErrorPtr> result;
+    for (const auto slot : this->find_slots_no_mutex(filters)) {
+        result.push_back(read_record(this->records[slot]));
+    }
+    return result;
+}
+
+std::list<ErrorPtr> ErrorDatabaseRing::edit_errors(const std::list<ErrorFilter>& filters, EditErrorFunc edit_func) {
+    std::lock_guard<std::mutex> lock(this->records_mutex);
+    std::list<ErrorPtr> result;
+    for (const auto slot : this->find_slots_no_mutex(filters)) {
+        auto error = read_record(this->records[slot]);
+        edit_func(error);
+        this->unindex_slot_no_mutex(slot);
+        write_record(this->records[slot], *error);
+        this->index_slot_no_mutex(slot);
+        result.push_back(error);
+    }
+    return result;
+}
+
+std::list<ErrorPtr> ErrorDatabaseRing::remove_errors(const std::list<ErrorFilter>& filters) {
+    BOOST_LOG_FUNCTION();
+    const auto changes_lock = this->lock_changes();
+    auto active_filters = filters;
+    active_filters.push_back(ErrorFilter(StateFilter(State::Active)));
+    const auto removed =
+        this->edit_errors(active_filters, [](const ErrorPtr& error) { error->state = State::ClearedByModule; });
+    this->notify_change({}, removed);
+    return removed;
+}
+
+} // namespace error
+} // namespace Everest
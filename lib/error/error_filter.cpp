@@ -177,5 +177,38 @@ VendorIdFilter ErrorFilter::get_vendor_id_filter() const {
     return std::get<VendorIdFilter>(filter);
 }
 
+bool ErrorFilter::matches(const Error& error) const {
+    switch (this->get_filter_type()) {
+    case FilterType::State:
+        return error.state == this->get_state_filter();
+    case FilterType::Origin:
+        return error.origin == this->get_origin_filter();
+    case FilterType::Type:
+        return error.type == this->get_type_filter().value;
+    case FilterType::Severity:
+        switch (this->get_severity_filter()) {
+        case SeverityFilter::LOW_GE:
+            return error.severity >= Severity::Low;
+        case SeverityFilter::MEDIUM_GE:
+            return error.severity >= Severity::Medium;
+        case SeverityFilter::HIGH_GE:
+            return error.severity >= Severity::High;
+        }
+        break;
+    case FilterType::TimePeriod: {
+        const auto period = this->get_time_period_filter();
+        return error.timestamp >= period.from and error.timestamp <= period.to;
+    }
+    case FilterType::Handle:
+        return error.uuid == this->get_handle_filter();
+    case FilterType::SubType:
+        return error.sub_type == this->get_sub_type_filter().value;
+    case FilterType::VendorId:
+        return error.vendor_id == this->get_vendor_id_filter().value;
+    }
+    EVLOG_error << "No known condition for provided enum of type FilterType.";
+    return false;
+}
+
 } // namespace error
 } // namespace Everest
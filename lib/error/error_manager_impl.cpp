@@ -5,6 +5,7 @@
 
 #include <utils/error.hpp>
 #include <utils/error/error_database.hpp>
+#include <utils/error/error_pool.hpp>
 #include <utils/error/error_type_map.hpp>
 
 #include <everest/logging.hpp>
@@ -20,7 +21,8 @@ ErrorManagerImpl::ErrorManagerImpl(std::shared_ptr<ErrorTypeMap> error_type_map_
                                    std::list<ErrorType> allowed_error_types_,
                                    ErrorManagerImpl::PublishErrorFunc publish_raised_error_,
                                    ErrorManagerImpl::PublishErrorFunc publish_cleared_error_,
-                                   const bool validate_error_types_) :
+                                   const bool validate_error_types_,
+                                   const ErrorPublishSettings& publish_settings) :
     error_type_map(error_type_map_),
     database(error_database_),
     allowed_error_types(allowed_error_types_),
@@ -34,6 +36,12 @@ ErrorManagerImpl::ErrorManagerImpl(std::shared_ptr<ErrorTypeMap> error_type_map_
             }
         }
     }
+    if (not publish_settings.is_passthrough()) {
+        this->publish_limiter = std::make_unique<ErrorPublishLimiter>(publish_settings, this->publish_raised_error,
+                                                                      this->publish_cleared_error);
+        this->publish_raised_error = [this](const Error& error) { this->publish_limiter->raise_error(error); };
+        this->publish_cleared_error = [this](const Error& error) { this->publish_limiter->clear_error(error); };
+    }
 }
 
 void ErrorManagerImpl::raise_error(const Error& error) {
@@ -49,7 +57,7 @@ void ErrorManagerImpl::raise_error(const Error& error) {
                     << " is already active.";
         return;
     }
-    database->add_error(std::make_shared<Error>(error));
+    database->add_error(make_error(error));
     this->publish_raised_error(error);
     EVLOG_error << "Error raised, type: " << error.type << ", sub_type: " << error.sub_type
                 << ", message: " << error.message;
@@ -109,6 +117,17 @@ std::list<ErrorPtr> ErrorManagerImpl::clear_all_errors() {
     return res;
 }
 
+std::optional<std::chrono::steady_clock::time_point> ErrorManagerImpl::flush_publishes() {
+    if (this->publish_limiter == nullptr) {
+        return std::nullopt;
+    }
+    return this->publish_limiter->flush();
+}
+
+bool ErrorManagerImpl::has_deferred_publishes() const {
+    return this->publish_limiter != nullptr;
+}
+
 bool ErrorManagerImpl::can_be_raised(const ErrorType& type, const ErrorSubType& sub_type) const {
     std::list<ErrorFilter> filters = {ErrorFilter(TypeFilter(type)), ErrorFilter(SubTypeFilter(sub_type))};
     return database->get_errors(filters).empty();
@@ -5,6 +5,7 @@
 
 #include <utils/error.hpp>
 #include <utils/error/error_database.hpp>
+#include <utils/error/error_pool.hpp>
 #include <utils/error/error_filter.hpp>
 #include <utils/error/error_type_map.hpp>
 
@@ -66,7 +67,7 @@ void ErrorManagerReq::on_error_raised(const Error& error) {
         EVLOG_error << "Error type '" << error.type << "' is not defined, ignored.";
         return;
     }
-    database->add_error(std::make_shared<Error>(error));
+    database->add_error(make_error(error));
     on_error(error, true);
 }
 
@@ -5,6 +5,7 @@
 
 #include <everest/logging.hpp>
 #include <utils/error/error_database.hpp>
+#include <utils/error/error_pool.hpp>
 #include <utils/error/error_type_map.hpp>
 
 namespace Everest {
@@ -45,7 +46,7 @@ void ErrorManagerReqGlobal::on_error_raised(const Error& error) {
                     << "' is already raised, ignoring new error";
         return;
     }
-    database->add_error(std::make_shared<Error>(error));
+    database->add_error(make_error(error));
     errors = database->get_errors({ErrorFilter(TypeFilter(error.type)), ErrorFilter(SubTypeFilter(error.sub_type)),
                                    ErrorFilter(OriginFilter(error.origin))});
     if (errors.size() != 1) {
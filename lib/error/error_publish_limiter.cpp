@@ -0,0 +1,186 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#include <utils/error/error_publish_limiter.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include <everest/logging.hpp>
+
+namespace Everest {
+namespace error {
+
+namespace {
+ErrorPublishLimits parse_limits(const nlohmann::json& limits_json, const ErrorPublishLimits& defaults) {
+    ErrorPublishLimits limits;
+    limits.debounce = std::chrono::milliseconds(limits_json.value("debounce_ms", defaults.debounce.count()));
+    limits.hold = std::chrono::milliseconds(limits_json.value("hold_ms", defaults.hold.count()));
+    limits.max_publishes_per_s = limits_json.value("max_publishes_per_s", defaults.max_publishes_per_s);
+    limits.flapping_transitions = limits_json.value("flapping_transitions", defaults.flapping_transitions);
+    limits.flapping_window =
+        std::chrono::seconds(limits_json.value("flapping_window_s", defaults.flapping_window.count()));
+    return limits;
+}
+
+std::string get_printable_name(const Error& error) {
+    return fmt::format("{} ({}) of {}", error.type, error.sub_type, error.origin.to_string());
+}
+} // namespace
+
+bool ErrorPublishLimits::is_passthrough() const {
+    return this->debounce.count() == 0 and this->hold.count() == 0 and this->max_publishes_per_s <= 0 and
+           this->flapping_transitions == 0;
+}
+
+ErrorPublishSettings ErrorPublishSettings::parse(const nlohmann::json& module_config) {
+    ErrorPublishSettings settings;
+    const auto error_publishing = module_config.find("error_publishing");
+    if (error_publishing == module_config.end()) {
+        return settings;
+    }
+    settings.defaults = parse_limits(*error_publishing, settings.defaults);
+    // the range of items() does not extend the lifetime of the json it iterates
+    const auto types = error_publishing->value("types", nlohmann::json::object());
+    for (const auto& [type, limits] : types.items()) {
+        settings.types[type] = parse_limits(limits, settings.defaults);
+    }
+    return settings;
+}
+
+bool ErrorPublishSettings::is_passthrough() const {
+    return this->defaults.is_passthrough() and
+           std::all_of(this->types.begin(), this->types.end(),
+                       [](const auto& type_limits) { return type_limits.second.is_passthrough(); });
+}
+
+const ErrorPublishLimits& ErrorPublishSettings::get_limits(const ErrorType& type) const {
+    const auto it = this->types.find(type);
+    return it != this->types.end() ? it->second : this->defaults;
+}
+
+ErrorPublishLimiter::ErrorPublishLimiter(ErrorPublishSettings settings_, PublishErrorFunc publish_raised_error_,
+                                         PublishErrorFunc publish_cleared_error_) :
+    settings(std::move(settings_)),
+    publish_raised_error(std::move(publish_raised_error_)),
+    publish_cleared_error(std::move(publish_cleared_error_)) {
+}
+
+void ErrorPublishLimiter::raise_error(const Error& error, clock::time_point now) {
+    this->on_transition(error, true, now);
+}
+
+void ErrorPublishLimiter::clear_error(const Error& error, clock::time_point now) {
+    this->on_transition(error, false, now);
+}
+
+void ErrorPublishLimiter::on_transition(const Error& error, bool raised, clock::time_point now) {
+    {
+        std::lock_guard<std::mutex> lock(this->states_mutex);
+        const auto& limits = this->settings.get_limits(error.type);
+        const auto [it, inserted] = this->states.try_emplace({error.type, error.sub_type});
+        auto& state = it->second;
+        if (inserted) {
+            state.tokens = std::max(limits.max_publishes_per_s, 1.0);
+            state.refilled = now;
+        }
+        state.error = error;
+        if (state.raised == raised) {
+            return;
+        }
+        state.raised = raised;
+        state.changed = now;
+        state.coalesced++;
+
+        if (limits.flapping_transitions > 0) {
+            state.transitions.push_back(now);
+            while (state.transitions.front() < now - limits.flapping_window) {
+                state.transitions.pop_front();
+            }
+            if (not state.flapping and state.transitions.size() >= limits.flapping_transitions) {
+                state.flapping = true;
+                EVLOG_warning << fmt::format("Error {} is flapping: {} raises and clears within {}s, only its settled "
+                                             "state is published",
+                                             get_printable_name(error), state.transitions.size(),
+                                             limits.flapping_window.count());
+            }
+        }
+    }
+    // transitions without debounce, hold or exceeded rate limit are published right away
+    this->flush(now);
+}
+
+std::optional<ErrorPublishLimiter::clock::time_point>
+ErrorPublishLimiter::get_due(const ErrorState& state, const ErrorPublishLimits& limits, clock::time_point now) const {
+    if (state.raised == state.published_raised) {
+        return std::nullopt;
+    }
+    auto due = state.changed + (state.raised ? limits.debounce : limits.hold);
+    if (limits.max_publishes_per_s > 0 and state.tokens < 1) {
+        const auto missing = std::chrono::duration<double>((1 - state.tokens) / limits.max_publishes_per_s);
+        due = std::max(due, now + std::chrono::ceil<clock::duration>(missing));
+    }
+    return due;
+}
+
+std::optional<ErrorPublishLimiter::clock::time_point> ErrorPublishLimiter::flush(clock::time_point now) {
+    std::vector<std::pair<bool, Error>> publishes;
+    std::optional<clock::time_point> next_due;
+    // a concurrent flush must not publish a later transition before the ones collected here
+    const std::lock_guard<std::mutex> publish_lock(this->publish_mutex);
+    {
+        std::lock_guard<std::mutex> lock(this->states_mutex);
+        for (auto it = this->states.begin(); it != this->states.end();) {
+            auto& state = it->second;
+            const auto& limits = this->settings.get_limits(state.error.type);
+            const auto burst = std::max(limits.max_publishes_per_s, 1.0);
+            if (limits.max_publishes_per_s > 0) {
+                const auto elapsed = std::chrono::duration<double>(now - state.refilled).count();
+                state.tokens = std::min(burst, state.tokens + elapsed * limits.max_publishes_per_s);
+                state.refilled = now;
+            }
+
+            const auto due = this->get_due(state, limits, now);
+            if (due.has_value() and *due <= now) {
+                publishes.emplace_back(state.raised, state.error);
+                state.published_raised = state.raised;
+                if (limits.max_publishes_per_s > 0) {
+                    state.tokens -= 1;
+                }
+                if (state.coalesced > 0) {
+                    state.coalesced--;
+                }
+            } else if (due.has_value()) {
+                next_due = next_due.has_value() ? std::min(*next_due, *due) : *due;
+            }
+
+            while (not state.transitions.empty() and state.transitions.front() < now - limits.flapping_window) {
+                state.transitions.pop_front();
+            }
+            if (state.flapping and state.transitions.size() < limits.flapping_transitions) {
+                state.flapping = false;
+                EVLOG_info << fmt::format("Error {} stopped flapping, {} raises and clears were not published",
+                                          get_printable_name(state.error), state.coalesced);
+                state.coalesced = 0;
+            }
+
+            // states are kept until the rate limit recovered, otherwise a storm would start with a full burst again
+            const bool settled = not state.raised and not state.published_raised and
+                                 state.transitions.empty() and not state.flapping and state.tokens >= burst;
+            it = settled ? this->states.erase(it) : std::next(it);
+        }
+    }
+    for (const auto& [raised, error] : publishes) {
+        if (raised) {
+            this->publish_raised_error(error);
+        } else {
+            this->publish_cleared_error(error);
+        }
+    }
+    return next_due;
+}
+
+} // namespace error
+} // namespace Everest
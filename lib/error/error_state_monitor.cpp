@@ -16,6 +16,20 @@ ErrorStateMonitor::StateCondition::StateCondition(ErrorType type_, ErrorSubType
 }
 
 ErrorStateMonitor::ErrorStateMonitor(std::shared_ptr<ErrorDatabase> error_database_) : database(error_database_) {
+    this->change_handler_id = this->database->add_change_handler(
+        [this](const std::list<ErrorPtr>& added, const std::list<ErrorPtr>& removed) {
+            this->on_errors_changed(added, removed);
+        });
+    // the handler is registered first and the errors are tracked by handle, so errors changed meanwhile are neither
+    // lost nor counted twice
+    std::lock_guard<std::mutex> lock(this->conditions_mutex);
+    for (const ErrorPtr& error : this->database->get_errors({})) {
+        this->active_errors[{error->type, error->sub_type}].insert(error->uuid);
+    }
+}
+
+ErrorStateMonitor::~ErrorStateMonitor() {
+    this->database->remove_change_handler(this->change_handler_id);
 }
 
 bool ErrorStateMonitor::is_error_active(const ErrorType& type, const ErrorSubType& sub_type) const {
@@ -41,5 +55,99 @@ bool ErrorStateMonitor::is_condition_satisfied(const std::list<StateCondition>&
     return true;
 }
 
+ErrorStateMonitor::ConditionId ErrorStateMonitor::register_condition(const std::list<StateCondition>& condition,
+                                                                     const ConditionChangedFunc& handler) {
+    std::lock_guard<std::mutex> lock(this->conditions_mutex);
+    const auto id = this->next_condition_id++;
+    CompiledCondition compiled{{condition.begin(), condition.end()}, 0, handler};
+    std::set<ErrorKey> keys;
+    for (const auto& term : compiled.terms) {
+        const ErrorKey key{term.type, term.sub_type};
+        const auto it = this->active_errors.find(key);
+        const bool active = it != this->active_errors.end() and not it->second.empty();
+        if (active != term.active) {
+            compiled.unsatisfied++;
+        }
+        if (keys.insert(key).second) {
+            this->conditions_by_key.emplace(key, id);
+        }
+    }
+    this->conditions.emplace(id, std::move(compiled));
+    return id;
+}
+
+void ErrorStateMonitor::unregister_condition(ConditionId id) {
+    std::lock_guard<std::mutex> lock(this->conditions_mutex);
+    const auto condition = this->conditions.find(id);
+    if (condition == this->conditions.end()) {
+        return;
+    }
+    for (const auto& term : condition->second.terms) {
+        const auto range = this->conditions_by_key.equal_range({term.type, term.sub_type});
+        for (auto it = range.first; it != range.second;) {
+            it = it->second == id ? this->conditions_by_key.erase(it) : std::next(it);
+        }
+    }
+    this->conditions.erase(condition);
+}
+
+bool ErrorStateMonitor::is_registered_condition_satisfied(ConditionId id) const {
+    std::lock_guard<std::mutex> lock(this->conditions_mutex);
+    return this->conditions.at(id).unsatisfied == 0;
+}
+
+void ErrorStateMonitor::on_errors_changed(const std::list<ErrorPtr>& added, const std::list<ErrorPtr>& removed) {
+    std::vector<std::pair<ConditionChangedFunc, bool>> calls;
+    {
+        std::lock_guard<std::mutex> lock(this->conditions_mutex);
+        for (const ErrorPtr& error : added) {
+            ErrorKey key{error->type, error->sub_type};
+            auto& handles = this->active_errors[key];
+            if (handles.insert(error->uuid).second and handles.size() == 1) {
+                this->update_conditions(key, true, calls);
+            }
+        }
+        for (const ErrorPtr& error : removed) {
+            const ErrorKey key{error->type, error->sub_type};
+            const auto it = this->active_errors.find(key);
+            if (it == this->active_errors.end() or it->second.erase(error->uuid) == 0) {
+                continue;
+            }
+            if (it->second.empty()) {
+                this->active_errors.erase(it);
+                this->update_conditions(key, false, calls);
+            }
+        }
+    }
+    for (const auto& [handler, satisfied] : calls) {
+        if (handler) {
+            handler(satisfied);
+        }
+    }
+}
+
+void ErrorStateMonitor::update_conditions(const ErrorKey& key, bool active,
+                                          std::vector<std::pair<ConditionChangedFunc, bool>>& calls) {
+    const auto range = this->conditions_by_key.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it) {
+        auto& condition = this->conditions.at(it->second);
+        const bool was_satisfied = condition.unsatisfied == 0;
+        for (const auto& term : condition.terms) {
+            if (term.type != key.first or term.sub_type != key.second) {
+                continue;
+            }
+            if (term.active == active) {
+                condition.unsatisfied--;
+            } else {
+                condition.unsatisfied++;
+            }
+        }
+        const bool satisfied = condition.unsatisfied == 0;
+        if (satisfied != was_satisfied) {
+            calls.emplace_back(condition.handler, satisfied);
+        }
+    }
+}
+
 } // namespace error
 } // namespace Everest
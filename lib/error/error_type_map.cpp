@@ -23,6 +23,7 @@ void ErrorTypeMap::load_error_types(std::filesystem::path error_types_dir) {
                     << "' does not exist, error types not loaded.";
         return;
     }
+    std::lock_guard<std::mutex> lock(this->catalog->mutex);
     for (const auto& entry : std::filesystem::directory_iterator(error_types_dir)) {
         if (!entry.is_regular_file()) {
             continue;
@@ -30,63 +31,96 @@ void ErrorTypeMap::load_error_types(std::filesystem::path error_types_dir) {
         if (entry.path().extension() != ".yaml") {
             continue;
         }
-        std::string prefix = entry.path().stem().string();
-        json error_type_file = Everest::load_yaml(entry.path());
-        if (!error_type_file.contains("errors")) {
-            EVLOG_warning << "Error type file '" << entry.path().string() << "' does not contain 'errors' key.";
+        this->catalog->unloaded_namespaces[entry.path().stem().string()] = entry.path();
+    }
+}
+
+void ErrorTypeMap::load_namespace_no_mutex(Catalog& catalog, const std::string& error_namespace) {
+    BOOST_LOG_FUNCTION();
+
+    const auto unloaded = catalog.unloaded_namespaces.find(error_namespace);
+    if (unloaded == catalog.unloaded_namespaces.end()) {
+        return;
+    }
+    const auto path = std::move(unloaded->second);
+    catalog.unloaded_namespaces.erase(unloaded);
+
+    json error_type_file = Everest::load_yaml(path);
+    if (!error_type_file.contains("errors")) {
+        EVLOG_warning << "Error type file '" << path.string() << "' does not contain 'errors' key.";
+        return;
+    }
+    if (!error_type_file.at("errors").is_array()) {
+        EVLOG_error << "Error type file '" << path.string()
+                    << "' does not contain an array with key 'errors', skipped.";
+        return;
+    }
+    for (const auto& error : error_type_file["errors"]) {
+        if (!error.contains("name")) {
+            EVLOG_error << "Error type file '" << path.string()
+                        << "' contains an error without a 'name' key, skipped.";
             continue;
         }
-        if (!error_type_file.at("errors").is_array()) {
-            EVLOG_error << "Error type file '" << entry.path().string()
-                        << "' does not contain an array with key 'errors', skipped.";
-            continue;
+        std::string description;
+        if (!error.contains("description")) {
+            EVLOG_error << "Error type file '" << path.string()
+                        << "' contains an error without a 'description' key, using default description";
+            description = "No description found";
+        } else {
+            description = error.at("description").get<std::string>();
         }
-        for (const auto& error : error_type_file["errors"]) {
-            if (!error.contains("name")) {
-                EVLOG_error << "Error type file '" << entry.path().string()
-                            << "' contains an error without a 'name' key, skipped.";
-                continue;
-            }
-            std::string description;
-            if (!error.contains("description")) {
-                EVLOG_error << "Error type file '" << entry.path().string()
-                            << "' contains an error without a 'description' key, using default description";
-                description = "No description found";
-            } else {
-                description = error.at("description").get<std::string>();
-            }
-            ErrorType complete_name = prefix + "/" + error.at("name").get<std::string>();
-            if (this->has(complete_name)) {
-                EVLOG_error << "Error type file '" << entry.path().string() << "' contains an error with the name '"
-                            << complete_name << "' which is already defined, skipped.";
-                continue;
-            }
-            error_types[complete_name] = description;
+        ErrorType complete_name = error_namespace + "/" + error.at("name").get<std::string>();
+        if (catalog.error_types.find(complete_name) != catalog.error_types.end()) {
+            EVLOG_error << "Error type file '" << path.string() << "' contains an error with the name '"
+                        << complete_name << "' which is already defined, skipped.";
+            continue;
         }
+        catalog.error_types[complete_name] = description;
     }
 }
 
 void ErrorTypeMap::load_error_types_map(std::map<ErrorType, std::string> error_types_map) {
-    this->error_types = error_types_map;
+    this->catalog = std::make_shared<Catalog>();
+    this->catalog->error_types = std::move(error_types_map);
 }
 
 std::string ErrorTypeMap::get_description(const ErrorType& error_type) const {
-    std::string description;
-    try {
-        description = error_types.at(error_type);
-    } catch (...) {
+    std::lock_guard<std::mutex> lock(this->catalog->mutex);
+    load_namespace_no_mutex(*this->catalog, error_type.substr(0, error_type.find('/')));
+    const auto it = this->catalog->error_types.find(error_type);
+    if (it == this->catalog->error_types.end()) {
         EVLOG_error << "Error type '" << error_type << "' is not defined, returning default description.";
-        description = "No description found";
+        return "No description found";
     }
-    return description;
+    return it->second;
 }
 
 bool ErrorTypeMap::has(const ErrorType& error_type) const {
-    return error_types.find(error_type) != error_types.end();
+    std::lock_guard<std::mutex> lock(this->catalog->mutex);
+    load_namespace_no_mutex(*this->catalog, error_type.substr(0, error_type.find('/')));
+    return this->catalog->error_types.find(error_type) != this->catalog->error_types.end();
 }
 
-std::map<ErrorType, std::string> ErrorTypeMap::get_error_types() {
-    return error_types;
+std::map<ErrorType, std::string> ErrorTypeMap::get_error_types() const {
+    std::lock_guard<std::mutex> lock(this->catalog->mutex);
+    while (not this->catalog->unloaded_namespaces.empty()) {
+        load_namespace_no_mutex(*this->catalog, this->catalog->unloaded_namespaces.begin()->first);
+    }
+    return this->catalog->error_types;
+}
+
+std::map<ErrorType, std::string> ErrorTypeMap::get_error_types(const std::set<std::string>& namespaces) const {
+    std::lock_guard<std::mutex> lock(this->catalog->mutex);
+    std::map<ErrorType, std::string> result;
+    for (const auto& error_namespace : namespaces) {
+        load_namespace_no_mutex(*this->catalog, error_namespace);
+        const auto prefix = error_namespace + "/";
+        for (auto it = this->catalog->error_types.lower_bound(prefix);
+             it != this->catalog->error_types.end() and it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+            result.insert(*it);
+        }
+    }
+    return result;
 }
 
 } // namespace error
@@ -0,0 +1,166 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include <everest/exceptions.hpp>
+#include <everest/logging.hpp>
+
+#include <utils/event_loop.hpp>
+
+namespace Everest {
+
+constexpr auto STOP_EVENT_ID = EventLoop::Id{0};
+constexpr auto MAX_EVENTS_PER_WAIT = 16;
+
+EventLoop::EventLoop() {
+    this->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (this->epoll_fd == -1) {
+        EVLOG_AND_THROW(EverestInternalError(fmt::format("Could not create epoll instance: {}", strerror(errno))));
+    }
+
+    this->stop_event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (this->stop_event_fd == -1) {
+        close(this->epoll_fd);
+        EVLOG_AND_THROW(EverestInternalError(fmt::format("Could not create stop event fd: {}", strerror(errno))));
+    }
+
+    struct epoll_event event {};
+    event.events = EPOLLIN;
+    event.data.u64 = STOP_EVENT_ID;
+    epoll_ctl(this->epoll_fd, EPOLL_CTL_ADD, this->stop_event_fd, &event);
+}
+
+EventLoop::Entry::~Entry() {
+    if (this->is_timer) {
+        close(this->fd);
+    }
+}
+
+EventLoop::~EventLoop() {
+    this->entries.clear();
+    close(this->stop_event_fd);
+    close(this->epoll_fd);
+}
+
+EventLoop::Id EventLoop::add_fd(int fd, std::uint32_t events, const FdCallback& callback) {
+    return add_entry(fd, events, std::shared_ptr<Entry>(new Entry{fd, false, false, callback}));
+}
+
+EventLoop::Id EventLoop::add_timer(std::chrono::nanoseconds interval, const TimerCallback& callback, bool periodic) {
+    const int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (timer_fd == -1) {
+        EVLOG_AND_THROW(EverestInternalError(fmt::format("Could not create timer fd: {}", strerror(errno))));
+    }
+
+    // a zero it_value would disarm the timer
+    const auto initial = std::max(interval, std::chrono::nanoseconds{1});
+    const auto to_timespec = [](std::chrono::nanoseconds duration) {
+        const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(duration);
+        return timespec{static_cast<time_t>(seconds.count()), static_cast<long>((duration - seconds).count())};
+    };
+    struct itimerspec spec {};
+    spec.it_value = to_timespec(initial);
+    if (periodic) {
+        spec.it_interval = to_timespec(initial);
+    }
+    // constructed in place, since destroying a temporary entry would close the timer fd
+    auto entry = std::shared_ptr<Entry>(
+        new Entry{timer_fd, true, periodic, [callback](std::uint32_t /*events*/) { callback(); }});
+    if (timerfd_settime(timer_fd, 0, &spec, nullptr) == -1) {
+        EVLOG_AND_THROW(EverestInternalError(fmt::format("Could not arm timer fd: {}", strerror(errno))));
+    }
+
+    return add_entry(timer_fd, EPOLLIN, std::move(entry));
+}
+
+EventLoop::Id EventLoop::add_entry(int fd, std::uint32_t events, std::shared_ptr<Entry> entry) {
+    const std::lock_guard<std::mutex> lock(this->entries_mutex);
+    const auto id = this->next_id++;
+
+    struct epoll_event event {};
+    event.events = events;
+    event.data.u64 = id;
+    if (epoll_ctl(this->epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1) {
+        EVLOG_AND_THROW(
+            EverestInternalError(fmt::format("Could not add fd {} to event loop: {}", fd, strerror(errno))));
+    }
+
+    this->entries.emplace(id, std::move(entry));
+    return id;
+}
+
+void EventLoop::remove(Id id) {
+    const std::lock_guard<std::mutex> lock(this->entries_mutex);
+    const auto it = this->entries.find(id);
+    if (it == this->entries.end()) {
+        return;
+    }
+
+    epoll_ctl(this->epoll_fd, EPOLL_CTL_DEL, it->second->fd, nullptr);
+    this->entries.erase(it);
+}
+
+void EventLoop::run() {
+    std::array<struct epoll_event, MAX_EVENTS_PER_WAIT> events{};
+
+    while (not this->stop_requested) {
+        const auto count = epoll_wait(this->epoll_fd, events.data(), events.size(), -1);
+        if (count == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            EVLOG_AND_THROW(EverestInternalError(fmt::format("Error while waiting for events: {}", strerror(errno))));
+        }
+
+        for (int i = 0; i < count and not this->stop_requested; i++) {
+            const auto id = events.at(i).data.u64;
+            if (id == STOP_EVENT_ID) {
+                continue;
+            }
+
+            std::shared_ptr<Entry> entry;
+            {
+                const std::lock_guard<std::mutex> lock(this->entries_mutex);
+                const auto it = this->entries.find(id);
+                if (it == this->entries.end()) {
+                    // removed by a callback dispatched earlier in this iteration
+                    continue;
+                }
+                entry = it->second;
+            }
+
+            if (entry->is_timer) {
+                std::uint64_t expirations = 0;
+                if (read(entry->fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+                    continue;
+                }
+                if (not entry->periodic) {
+                    remove(id);
+                }
+            }
+
+            entry->callback(events.at(i).events);
+        }
+    }
+
+    eventfd_t value = 0;
+    eventfd_read(this->stop_event_fd, &value);
+    this->stop_requested = false;
+}
+
+void EventLoop::stop() {
+    this->stop_requested = true;
+    eventfd_write(this->stop_event_fd, 1);
+}
+
+} // namespace Everest
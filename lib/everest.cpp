@@ -1,11 +1,20 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
 #include <cstddef>
+#include <cstring>
+#include <deque>
 #include <future>
 #include <map>
 #include <memory>
 #include <set>
 
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
 #include <boost/any.hpp>
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_generators.hpp>
@@ -28,7 +37,11 @@
 #include <utils/error/error_manager_req_global.hpp>
 #include <utils/error/error_state_monitor.hpp>
 #include <utils/error/error_type_map.hpp>
+#include <utils/flight_recorder.hpp>
 #include <utils/formatter.hpp>
+#include <utils/framework_log.hpp>
+#include <utils/tracing.hpp>
+#include <utils/traffic_recorder.hpp>
 
 namespace Everest {
 using json = nlohmann::json;
@@ -36,35 +49,101 @@ using json_uri = nlohmann::json_uri;
 using json_validator = nlohmann::json_schema::json_validator;
 
 const auto remote_cmd_res_timeout_seconds = 300;
+constexpr std::size_t async_validation_queue_depth = 1024; ///< vars published while the validation falls behind
+constexpr int async_validation_nice = 19;                  ///< lowest priority for the asynchronous validation
 const std::array<std::string, 3> TELEMETRY_RESERVED_KEYS = {{"connector_id"}};
+/// resolution of the debounce and hold times of errors with limited publishes
+constexpr auto error_publish_flush_interval = std::chrono::milliseconds(20);
+/// cancellations of calls that have not been started, e.g. while queued behind a running call, kept for the start
+constexpr std::size_t max_early_cancelled_cmd_calls = 1024;
+
+/// \returns the topic of cancellations and acknowledgements of the calls on \p cmd_topic, which has its own handler
+/// strand, so they are handled while a call on \p cmd_topic is running
+static std::string get_cmd_control_topic(const std::string& cmd_topic) {
+    return cmd_topic + "/control";
+}
+
+/// \returns the QOS declared by the "qos" entry of the given var or cmd \p definition, QOS2 if none is declared
+static QOS get_qos(const json& definition) {
+    const auto qos_it = definition.find("qos");
+    if (qos_it == definition.end()) {
+        return QOS::QOS2;
+    }
+    switch (qos_it->get<int>()) {
+    case 0:
+        return QOS::QOS0;
+    case 1:
+        return QOS::QOS1;
+    default:
+        return QOS::QOS2;
+    }
+}
+
+/// \brief Runs \p validate and accounts its duration and outcome in \p cost, validation errors are rethrown
+template <typename Validate> static void record_validation(ValidationCost& cost, const Validate& validate) {
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        validate();
+    } catch (...) {
+        cost.record(std::chrono::steady_clock::now() - start, false);
+        throw;
+    }
+    cost.record(std::chrono::steady_clock::now() - start, true);
+}
+
+/// \returns the name of the module \p module_id, throws if it is not part of the \p config
+static const std::string& get_module_name_from_config(const Config& config, const std::string& module_id) {
+    const auto& main_config = config.get_main_config();
+    const auto module_config_it = main_config.find(module_id);
+    if (module_config_it == main_config.end()) {
+        EVLOG_AND_THROW(EverestBaseRuntimeError("Module id '" + module_id + "' not found in config"));
+    }
+    return module_config_it->at("module").get_ref<const std::string&>();
+}
 
 Everest::Everest(std::string module_id_, const Config& config_, bool validate_data_with_schema,
                  std::shared_ptr<MQTTAbstraction> mqtt_abstraction, const std::string& telemetry_prefix,
-                 bool telemetry_enabled) :
+                 bool telemetry_enabled, const ValidationPolicy& validation_policy) :
+    Everest(std::move(module_id_), std::make_shared<const Config>(config_), validate_data_with_schema,
+            std::move(mqtt_abstraction), telemetry_prefix, telemetry_enabled, validation_policy) {
+}
+
+Everest::Everest(std::string module_id_, std::shared_ptr<const Config> config_, bool validate_data_with_schema,
+                 std::shared_ptr<MQTTAbstraction> mqtt_abstraction, const std::string& telemetry_prefix,
+                 bool telemetry_enabled, const ValidationPolicy& validation_policy) :
     mqtt_abstraction(mqtt_abstraction),
-    config(config_),
+    shared_config(std::move(config_)),
+    config(*this->shared_config),
     module_id(std::move(module_id_)),
     remote_cmd_res_timeout(remote_cmd_res_timeout_seconds),
     validate_data_with_schema(validate_data_with_schema),
+    validation_policy(validation_policy),
+    async_validations(QueueSettings{async_validation_queue_depth, QueueOverflowPolicy::DropNewest}),
+    module_name(get_module_name_from_config(this->config, this->module_id)),
+    module_manifest(this->config.get_manifests().at(this->module_name)),
+    module_classes(this->config.get_interfaces().at(this->module_name)),
     mqtt_everest_prefix(mqtt_abstraction->get_everest_prefix()),
     mqtt_external_prefix(mqtt_abstraction->get_external_prefix()),
     telemetry_prefix(telemetry_prefix),
-    telemetry_enabled(telemetry_enabled) {
-    BOOST_LOG_FUNCTION();
+    telemetry_enabled(telemetry_enabled),
+    call_id_prefix(boost::uuids::to_string(boost::uuids::random_generator()())) {
+    FRAMEWORK_LOG_FUNCTION();
 
-    EVLOG_debug << "Initializing EVerest framework...";
+    this->cmd_reply_topic = this->config.get_topic(this->module_id, ModuleTopic::CmdResult);
 
-    const auto& main_config = this->config.get_main_config();
-    const auto module_config_it = main_config.find(this->module_id);
-    if (module_config_it == main_config.end()) {
-        EVLOG_AND_THROW(EverestBaseRuntimeError("Module id '" + module_id + "' not found in config"));
-    }
+    EVLOG_debug << "Initializing EVerest framework...";
 
-    this->module_name = module_config_it->at("module");
-    this->module_manifest = this->config.get_manifests()[this->module_name];
-    this->module_classes = this->config.get_interfaces()[this->module_name];
     this->telemetry_config = this->config.get_telemetry_config();
 
+    this->cmd_calls_metric = &this->metrics.counter("everest_cmd_calls", "Synchronous cmd calls of this module");
+    this->cmd_call_timeouts_metric =
+        &this->metrics.counter("everest_cmd_call_timeouts", "Synchronous cmd calls that did not get a result in time");
+    this->cmd_call_duration_metric =
+        &this->metrics.histogram("everest_cmd_call_duration_seconds", "Time until synchronous cmd calls got a result");
+    this->vars_published_metric = &this->metrics.counter("everest_vars_published", "Vars published by this module");
+    this->vars_suppressed_metric = &this->metrics.counter(
+        "everest_vars_suppressed", "Vars not published by this module because their value did not change");
+
     this->ready_received = false;
     this->on_ready = nullptr;
 
@@ -87,7 +166,23 @@ Everest::Everest(std::string module_id_, const Config& config_, bool validate_da
 
     this->module_tier_mappings = config.get_module_3_tier_model_mappings(this->module_id);
 
+    const auto module_config_it = this->config.get_main_config().find(this->module_id);
+    if (module_config_it->contains("tracing")) {
+        tracing::Tracer::get().configure(tracing::TracingSettings::parse(*module_config_it));
+    }
+    if (module_config_it->contains("flight_recorder")) {
+        FlightRecorder::get().configure(FlightRecorderSettings::parse(*module_config_it, this->module_id),
+                                        this->module_id);
+    }
+    if (module_config_it->contains("traffic_recorder")) {
+        this->mqtt_abstraction->start_traffic_recording(
+            TrafficRecorderSettings::parse(*module_config_it, this->module_id), this->module_id);
+    }
+
+    this->var_publish_settings = VarPublishSettings::parse(*module_config_it);
+
     // setup error_managers, error_state_monitors, error_factories and error_databases for all implementations
+    const auto error_publish_settings = error::ErrorPublishSettings::parse(*module_config_it);
     for (const std::string& impl : Config::keys(this->module_manifest.at("provides"))) {
         // setup shared database
         auto error_database = std::make_shared<error::ErrorDatabaseMap>();
@@ -108,7 +203,7 @@ Everest::Everest(std::string module_id_, const Config& config_, bool validate_da
             [this, impl](const error::Error& error) { this->publish_cleared_error(impl, error); };
         this->impl_error_managers[impl] = std::make_shared<error::ErrorManagerImpl>(
             std::make_shared<error::ErrorTypeMap>(this->config.get_error_map()), error_database, allowed_error_types,
-            publish_raised_error, publish_cleared_error);
+            publish_raised_error, publish_cleared_error, true, error_publish_settings);
 
         // setup error state monitor
         this->impl_error_state_monitors[impl] = std::make_shared<error::ErrorStateMonitor>(error_database);
@@ -187,24 +282,134 @@ Everest::Everest(std::string module_id_, const Config& config_, bool validate_da
         this->req_error_state_monitors[req] = std::make_shared<error::ErrorStateMonitor>(error_database);
     }
 
+    if (this->mqtt_abstraction->is_var_cache_enabled()) {
+        // receive the vars of all requirements from the start, so they are cached for subscriptions made later
+        for (const auto& [req, fulfillment] : this->config.resolve_requirements(this->module_id)) {
+            const auto& var_topic =
+                this->config.get_topic(fulfillment.module_id, fulfillment.implementation_id, ImplementationTopic::Var);
+            if (this->var_cache_tokens.count(var_topic) != 0) {
+                continue;
+            }
+            // a var handler without a name keeps the topic subscribed, but never receives any var itself
+            auto token = std::make_shared<TypedHandler>(
+                HandlerType::SubscribeVar, std::make_shared<Handler>([](const std::string&, const json&) {}));
+            this->mqtt_abstraction->register_handler(var_topic, token, QOS::QOS2);
+            this->var_cache_tokens.emplace(var_topic, std::move(token));
+        }
+    }
+
     // register handler for global ready signal
     const auto handle_ready_wrapper = [this](const std::string&, const json& data) { this->handle_ready(data); };
     const auto everest_ready =
         std::make_shared<TypedHandler>(HandlerType::ExternalMQTT, std::make_shared<Handler>(handle_ready_wrapper));
     this->mqtt_abstraction->register_handler(fmt::format("{}ready", mqtt_everest_prefix), everest_ready, QOS::QOS2);
 
+    // modules of a ready group become ready with their group, the global ready signal then only repeats it
+    this->ready_group = module_config_it->value("ready_group", "");
+    if (not this->ready_group.empty()) {
+        const auto group_ready = std::make_shared<TypedHandler>(HandlerType::ExternalMQTT,
+                                                                std::make_shared<Handler>(handle_ready_wrapper));
+        this->mqtt_abstraction->register_handler(fmt::format("{}ready/{}", mqtt_everest_prefix, this->ready_group),
+                                                 group_ready, QOS::QOS2);
+    }
+
     this->publish_metadata();
+
+    const auto dispatch_metrics_settings = this->mqtt_abstraction->get_dispatch_metrics_settings();
+    if (dispatch_metrics_settings.enabled and dispatch_metrics_settings.publish_interval.count() > 0) {
+        this->dispatch_metrics_timer = this->mqtt_abstraction->get_event_loop().add_timer(
+            dispatch_metrics_settings.publish_interval, [this]() { this->publish_dispatch_metrics(); });
+    }
+
+    if (this->telemetry_enabled and this->telemetry_config.has_value() and
+        this->telemetry_config->batch_interval.count() > 0) {
+        this->telemetry_aggregator = std::make_unique<TelemetryAggregator>();
+        this->telemetry_batch_timer = this->mqtt_abstraction->get_event_loop().add_timer(
+            this->telemetry_config->batch_interval, [this]() { this->publish_telemetry_batch(); });
+    }
+
+    const auto heartbeat_settings = HeartbeatSettings::parse(*module_config_it);
+    if (heartbeat_settings.interval.count() > 0) {
+        this->heartbeat_timer = this->mqtt_abstraction->get_event_loop().add_timer(heartbeat_settings.interval,
+                                                                                   [this]() { this->heartbeat(); });
+    }
+
+    if (not error_publish_settings.is_passthrough()) {
+        this->error_publish_timer =
+            this->mqtt_abstraction->get_event_loop().add_timer(error_publish_flush_interval, [this]() {
+                for (const auto& [impl, error_manager] : this->impl_error_managers) {
+                    error_manager->flush_publishes();
+                }
+            });
+    }
+
+    if (this->validate_data_with_schema and this->validation_policy.asynchronous) {
+        this->async_validation_thread = std::thread(&Everest::run_async_validation, this);
+    }
+}
+
+Everest::~Everest() {
+    this->async_validations.close();
+    if (this->async_validation_thread.joinable()) {
+        this->async_validation_thread.join();
+    }
+    if (this->dispatch_metrics_timer != 0) {
+        this->mqtt_abstraction->get_event_loop().remove(this->dispatch_metrics_timer);
+    }
+    if (this->error_publish_timer != 0) {
+        this->mqtt_abstraction->get_event_loop().remove(this->error_publish_timer);
+    }
+    if (this->heartbeat_timer != 0) {
+        this->mqtt_abstraction->get_event_loop().remove(this->heartbeat_timer);
+    }
+    if (this->telemetry_batch_timer != 0) {
+        this->mqtt_abstraction->get_event_loop().remove(this->telemetry_batch_timer);
+        // samples of the last interval
+        this->publish_telemetry_batch();
+    }
+    if (tracing::Tracer::get().is_recording()) {
+        try {
+            tracing::Tracer::get().write_chrome_trace();
+        } catch (const EverestInternalError& e) {
+            EVLOG_error << e.what();
+        }
+    }
+    for (const auto& [topic, token] : this->var_cache_tokens) {
+        this->mqtt_abstraction->unregister_handler(topic, token);
+    }
+    const std::lock_guard<std::mutex> lock(this->pending_cmd_calls_mutex);
+    if (this->pending_cmd_calls != nullptr) {
+        this->mqtt_abstraction->unregister_handler(this->cmd_reply_topic, this->pending_cmd_calls->res_token);
+    }
+}
+
+void Everest::publish_dispatch_metrics() {
+    FRAMEWORK_LOG_FUNCTION();
+
+    json metrics = json::object();
+    for (const auto& [topic, topic_metrics] : this->mqtt_abstraction->get_dispatch_metrics()) {
+        metrics[topic] = topic_metrics;
+    }
+    this->telemetry_publish(fmt::format("dispatch_metrics/{}", this->module_id), metrics.dump());
+    this->telemetry_publish(fmt::format("metrics/{}", this->module_id),
+                            this->metrics.get_snapshot({{"module", this->module_id}}).dump());
+
+    if (this->validate_data_with_schema) {
+        const json validation_metrics = {{"totals", get_validation_stats()}, {"schemas", get_validation_costs()}};
+        this->telemetry_publish(fmt::format("validation_metrics/{}", this->module_id), validation_metrics.dump());
+    }
+    this->telemetry_publish(fmt::format("memory/{}", this->module_id), json(this->get_memory_report()).dump());
 }
 
 void Everest::spawn_main_loop_thread() {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
     // TODO: since the MQTT main loop has already been started before constructing this object, this is a no-op now
 
     this->main_loop_end = this->mqtt_abstraction->get_main_loop_future();
 }
 
 void Everest::wait_for_main_loop_end() {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
     // FIXME (aw): check if mainloop has been started, simple assert for now
     assert(this->main_loop_end.valid());
@@ -213,21 +418,21 @@ void Everest::wait_for_main_loop_end() {
 }
 
 void Everest::heartbeat() {
-    BOOST_LOG_FUNCTION();
-    const auto heartbeat_topic = fmt::format("{}/heartbeat", this->config.mqtt_module_prefix(this->module_id));
+    FRAMEWORK_LOG_FUNCTION();
 
-    using namespace date;
-
-    while (this->ready_received) {
-        std::ostringstream now;
-        now << date::utc_clock::now();
-        this->mqtt_abstraction->publish(heartbeat_topic, json(now.str()), QOS::QOS0);
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+    // heartbeats do not pile up while the handlers are stuck, the manager notices the gap in the sequence numbers
+    if (this->heartbeat_pending.exchange(true)) {
+        return;
     }
+    this->mqtt_abstraction->get_handler_executor().post([this]() {
+        this->heartbeat_pending = false;
+        const auto& heartbeat_topic = this->config.get_topic(this->module_id, ModuleTopic::Heartbeat);
+        this->mqtt_abstraction->publish(heartbeat_topic, json(this->heartbeat_sequence++), QOS::QOS0);
+    });
 }
 
 void Everest::publish_metadata() {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
     const auto module_info = this->config.get_module_info(this->module_id);
     const auto manifest = this->config.get_manifests().at(module_info.name);
@@ -243,13 +448,13 @@ void Everest::publish_metadata() {
         }
     }
 
-    const auto metadata_topic = fmt::format("{}/metadata", this->config.mqtt_module_prefix(this->module_id));
+    const auto& metadata_topic = this->config.get_topic(this->module_id, ModuleTopic::Metadata);
 
     this->mqtt_abstraction->publish(metadata_topic, metadata, QOS::QOS2);
 }
 
 void Everest::register_on_ready_handler(const std::function<void()>& handler) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
     this->on_ready = std::make_unique<std::function<void()>>(handler);
 }
@@ -259,11 +464,9 @@ std::optional<ModuleTierMappings> Everest::get_3_tier_model_mapping() {
 }
 
 void Everest::check_code() {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
-    const json module_manifest =
-        this->config.get_manifests()[this->config.get_main_config()[this->module_id]["module"].get<std::string>()];
-    for (const auto& element : module_manifest.at("provides").items()) {
+    for (const auto& element : this->module_manifest.at("provides").items()) {
         const auto& impl_id = element.key();
         const auto& impl_manifest = element.value();
         const auto interface_definition = this->config.get_interface_definition(impl_manifest.at("interface"));
@@ -287,19 +490,25 @@ void Everest::check_code() {
 }
 
 bool Everest::connect() {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
     return this->mqtt_abstraction->connect();
 }
 
 void Everest::disconnect() {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
     this->mqtt_abstraction->disconnect();
 }
 
-json Everest::call_cmd(const Requirement& req, const std::string& cmd_name, json json_args) {
-    BOOST_LOG_FUNCTION();
+std::shared_ptr<const Everest::BoundCmd> Everest::bind_cmd(const Requirement& req, const std::string& cmd_name) {
+    FRAMEWORK_LOG_FUNCTION();
+
+    const std::lock_guard<std::mutex> lock(this->bound_cmds_mutex);
+    auto& bound_cmd = this->bound_cmds[{req, cmd_name}];
+    if (bound_cmd != nullptr) {
+        return bound_cmd;
+    }
 
     // resolve requirement
     json connections = this->config.resolve_requirement(this->module_id, req.id);
@@ -309,157 +518,911 @@ json Everest::call_cmd(const Requirement& req, const std::string& cmd_name, json
     }
 
     // extract manifest definition of this command
-    const json cmd_definition =
+    const auto& cmd_definition =
         get_cmd_definition(connection.at("module_id"), connection.at("implementation_id"), cmd_name, true);
 
-    const json return_type = cmd_definition.at("result").at("type");
-
-    std::set<std::string> arg_names = Config::keys(json_args);
-
-    // check args against manifest
+    auto cmd = std::make_shared<BoundCmd>();
+    cmd->cmd_name = cmd_name;
+    cmd->target = this->config.printable_identifier(connection["module_id"], connection["implementation_id"]);
+    cmd->cmd_topic =
+        this->config.get_topic(connection["module_id"], connection["implementation_id"], ImplementationTopic::Cmd);
+    cmd->qos = get_qos(cmd_definition);
+    if (cmd_definition.contains("cache")) {
+        const auto& cache_definition = cmd_definition.at("cache");
+        auto cache = std::make_shared<CmdResultCache>(
+            std::chrono::milliseconds(cache_definition.at("ttl_ms").get<std::int64_t>()));
+        const auto& var_topic =
+            this->config.get_topic(connection["module_id"], connection["implementation_id"], ImplementationTopic::Var);
+        for (const auto& var_name : cache_definition.value("invalidated_by", json::array())) {
+            // invalidated right when the value is dispatched on the var topic, not after a subscription delivered it,
+            // so no result computed before the change is cached meanwhile
+            this->mqtt_abstraction->register_handler(
+                var_topic,
+                std::make_shared<TypedHandler>(
+                    var_name.get<std::string>(), HandlerType::SubscribeVar,
+                    std::make_shared<Handler>([cache](const std::string&, const json&) { cache->invalidate(); })),
+                QOS::QOS2);
+        }
+        cmd->result_cache = std::move(cache);
+    }
+    cmd->streaming = cmd_definition.value("streaming", false);
+    if (connection.contains("max_in_flight")) {
+        auto& limit = this->in_flight_limits[req];
+        if (limit == nullptr) {
+            const auto overflow = connection.value("in_flight_overflow", "queue") == "reject"
+                                      ? InFlightOverflow::Reject
+                                      : InFlightOverflow::Queue;
+            limit = std::make_shared<InFlightLimit>(connection.at("max_in_flight").get<std::size_t>(), overflow);
+        }
+        cmd->in_flight_limit = limit;
+    }
+    if (cmd_definition.contains("arguments")) {
+        cmd->arg_names = Config::keys(cmd_definition.at("arguments"));
+    }
     if (this->validate_data_with_schema) {
-        if (cmd_definition.at("arguments").size() != json_args.size()) {
-            EVLOG_AND_THROW(EverestApiError(fmt::format(
-                "Call to {}->{}({}): Argument count does not match manifest!",
-                this->config.printable_identifier(connection.at("module_id"), connection.at("implementation_id")),
-                cmd_name, fmt::join(arg_names, ", "))));
+        const auto& interface_name = this->config.get_interfaces()
+                                         .at(this->config.get_module_name(connection.at("module_id")))
+                                         .at(connection.at("implementation_id").get<std::string>())
+                                         .get_ref<const std::string&>();
+        for (const auto& arg_name : cmd->arg_names) {
+            cmd->arg_validators.emplace(arg_name,
+                                        get_validator(interface_name,
+                                                      fmt::format("cmds/{}/arguments/{}", cmd_name, arg_name),
+                                                      cmd_definition.at("arguments").at(arg_name)));
         }
+        cmd->arg_sampler = std::make_shared<ValidationSampler>(this->validation_policy, true);
+        cmd->arg_cost = get_validation_cost(connection.at("module_id"), connection.at("implementation_id"),
+                                            fmt::format("cmds/{}/arguments", cmd_name));
+    }
 
-        std::set<std::string> unknown_arguments;
-        std::set<std::string> cmd_arguments;
-        if (cmd_definition.contains("arguments")) {
-            cmd_arguments = Config::keys(cmd_definition.at("arguments"));
-        }
+    bound_cmd = std::move(cmd);
+    return bound_cmd;
+}
+
+std::map<Requirement, InFlightStats> Everest::get_in_flight_stats() {
+    const std::lock_guard<std::mutex> lock(this->bound_cmds_mutex);
+    std::map<Requirement, InFlightStats> stats;
+    for (const auto& [req, limit] : this->in_flight_limits) {
+        stats.emplace(req, limit->get_stats());
+    }
+    return stats;
+}
 
-        std::set_difference(arg_names.begin(), arg_names.end(), cmd_arguments.begin(), cmd_arguments.end(),
-                            std::inserter(unknown_arguments, unknown_arguments.end()));
+ValidationStats Everest::get_validation_stats() const {
+    ValidationStats stats;
+    stats.validated = this->validation_counters.validated.load();
+    stats.skipped = this->validation_counters.skipped.load();
+    stats.violations = this->validation_counters.violations.load();
+    stats.dropped = this->validation_counters.dropped.load();
+    return stats;
+}
 
-        if (!unknown_arguments.empty()) {
-            EVLOG_AND_THROW(EverestApiError(fmt::format(
-                "Call to {}->{}({}): Argument names do not match manifest: {} != {}!",
-                this->config.printable_identifier(connection.at("module_id"), connection.at("implementation_id")),
-                cmd_name, fmt::join(arg_names, ","), fmt::join(arg_names, ","), fmt::join(cmd_arguments, ","))));
+bool Everest::sample_validation(ValidationSampler& sampler) {
+    if (not sampler.should_validate()) {
+        this->validation_counters.skipped++;
+        return false;
+    }
+    this->validation_counters.validated++;
+    return true;
+}
+
+std::map<std::string, ValidationCostStats> Everest::get_validation_costs() {
+    const std::lock_guard<std::mutex> lock(this->validation_costs_mutex);
+    std::map<std::string, ValidationCostStats> costs;
+    for (const auto& [key, cost] : this->validation_costs) {
+        costs.emplace(key, cost->get_stats());
+    }
+    return costs;
+}
+
+MemoryReport Everest::get_memory_report() {
+    MemoryReport report;
+
+    auto& config_memory = report.subsystems["config"];
+    config_memory = this->config.get_memory_usage();
+    // the config is immutable and only counted once, no matter how many instances share it
+    config_memory.details["owners"] = this->shared_config.use_count();
+
+    const auto handler_stats = this->mqtt_abstraction->get_handler_memory_stats();
+    auto& handlers = report.subsystems["handlers"];
+    handlers.bytes = handler_stats.bytes;
+    handlers.details["topics"] = handler_stats.topics;
+    handlers.details["handlers"] = handler_stats.handlers;
+    {
+        const std::lock_guard<std::mutex> lock(this->bound_cmds_mutex);
+        handlers.details["bound_cmds"] = this->bound_cmds.size();
+        handlers.bytes += this->bound_cmds.size() * sizeof(BoundCmd);
+    }
+    {
+        const std::lock_guard<std::mutex> lock(this->published_vars_mutex);
+        handlers.details["published_vars"] = this->published_vars.size();
+        handlers.bytes += this->published_vars.size() * sizeof(PublishedVar);
+    }
+
+    const auto queue_stats = this->mqtt_abstraction->get_queue_stats();
+    const auto pool_stats = this->mqtt_abstraction->get_message_pool_stats();
+    const auto validation_stats = this->async_validations.get_stats();
+    auto& queues = report.subsystems["queues"];
+    queues.details["received"] = queue_stats.receive.depth;
+    queues.details["handler"] = queue_stats.handler.depth;
+    queues.details["before_connected"] = queue_stats.before_connected.depth;
+    queues.details["pooled"] = pool_stats.pooled;
+    queues.details["async_validations"] = validation_stats.depth;
+    queues.bytes = (queue_stats.receive.depth + queue_stats.before_connected.depth + pool_stats.pooled) *
+                       sizeof(Message) +
+                   queue_stats.handler.depth * sizeof(ParsedMessage) +
+                   validation_stats.depth * sizeof(std::function<void()>);
+
+    const auto buffer_stats = this->mqtt_abstraction->get_buffer_stats();
+    auto& buffers = report.subsystems["mqtt_buffers"];
+    buffers.bytes = buffer_stats.send_buffer_size + buffer_stats.recv_buffer_size;
+    buffers.details["send"] = buffer_stats.send_buffer_size;
+    buffers.details["receive"] = buffer_stats.recv_buffer_size;
+
+    auto& validators = report.subsystems["validators"];
+    {
+        const std::lock_guard<std::mutex> lock(this->validators_mutex);
+        std::size_t native = 0;
+        for (const auto& [key, validator] : this->validators) {
+            if (validator != nullptr and validator->is_native()) {
+                native++;
+            }
         }
+        validators.bytes = this->validators.size() * sizeof(SchemaValidator) + this->interpreted_schema_bytes;
+        validators.details["native"] = native;
+        validators.details["interpreted"] = this->validators.size() - native;
+        validators.details["schema_bytes"] = this->interpreted_schema_bytes;
     }
 
-    if (this->validate_data_with_schema) {
+    return report;
+}
+
+MetricsRegistry& Everest::get_metrics() {
+    return this->metrics;
+}
+
+std::shared_ptr<ValidationCost> Everest::get_validation_cost(const std::string& module_id, const std::string& impl_id,
+                                                             const std::string& schema_path) {
+    const std::lock_guard<std::mutex> lock(this->validation_costs_mutex);
+    auto& cost = this->validation_costs[fmt::format("{}/{}/{}", module_id, impl_id, schema_path)];
+    if (cost == nullptr) {
+        cost = std::make_shared<ValidationCost>();
+    }
+    return cost;
+}
+
+void Everest::run_async_validation() {
+    // validation must not compete with the threads publishing and handling messages
+    if (setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), async_validation_nice) != 0) {
+        EVLOG_warning << fmt::format("Could not lower the priority of the validation thread: {}", strerror(errno));
+    }
+    while (auto validation = this->async_validations.pop()) {
+        (*validation)();
+    }
+}
+
+void Everest::validate_cmd_args(const BoundCmd& cmd, const json& json_args) {
+    std::set<std::string> arg_names = Config::keys(json_args);
+
+    // check args against manifest
+    if (cmd.arg_names.size() != json_args.size()) {
+        EVLOG_AND_THROW(EverestApiError(fmt::format("Call to {}->{}({}): Argument count does not match manifest!",
+                                                    cmd.target, cmd.cmd_name, fmt::join(arg_names, ", "))));
+    }
+
+    std::set<std::string> unknown_arguments;
+    std::set_difference(arg_names.begin(), arg_names.end(), cmd.arg_names.begin(), cmd.arg_names.end(),
+                        std::inserter(unknown_arguments, unknown_arguments.end()));
+
+    if (!unknown_arguments.empty()) {
+        EVLOG_AND_THROW(EverestApiError(
+            fmt::format("Call to {}->{}({}): Argument names do not match manifest: {} != {}!", cmd.target,
+                        cmd.cmd_name, fmt::join(arg_names, ","), fmt::join(arg_names, ","),
+                        fmt::join(cmd.arg_names, ","))));
+    }
+
+    if (not sample_validation(*cmd.arg_sampler)) {
+        return;
+    }
+    record_validation(*cmd.arg_cost, [&]() {
         for (const auto& arg_name : arg_names) {
             try {
-                json_validator validator(
-                    [this](const json_uri& uri, json& schema) { this->config.ref_loader(uri, schema); },
-                    Config::format_checker);
-                validator.set_root_schema(cmd_definition.at("arguments").at(arg_name));
-                validator.validate(json_args.at(arg_name));
+                cmd.arg_validators.at(arg_name)->validate(json_args.at(arg_name));
             } catch (const std::exception& e) {
+                this->validation_counters.violations++;
                 EVLOG_AND_THROW(EverestApiError(fmt::format(
                     "Call to {}->{}({}): Argument '{}' with value '{}' could not be validated with schema: {}",
-                    this->config.printable_identifier(connection.at("module_id"), connection.at("implementation_id")),
-                    cmd_name, fmt::join(arg_names, ","), arg_name, json_args.at(arg_name).dump(2), e.what())));
+                    cmd.target, cmd.cmd_name, fmt::join(arg_names, ","), arg_name, json_args.at(arg_name).dump(2),
+                    e.what())));
             }
         }
-    }
-
-    const std::string call_id = boost::uuids::to_string(boost::uuids::random_generator()());
+    });
+}
 
-    std::promise<json> res_promise;
-    std::future<json> res_future = res_promise.get_future();
+std::shared_ptr<Everest::PendingCmdCalls> Everest::get_pending_cmd_calls() {
+    const std::lock_guard<std::mutex> lock(this->pending_cmd_calls_mutex);
+    auto& pending_calls = this->pending_cmd_calls;
+    if (pending_calls != nullptr) {
+        return pending_calls;
+    }
 
-    const auto res_handler = [this, &res_promise, call_id, connection, cmd_name, return_type](const std::string&,
-                                                                                              json data) {
+    pending_calls = std::make_shared<PendingCmdCalls>();
+    // providers send the results of all calls of this module to its own reply topic, so a single long-lived handler
+    // receives them without any results of other modules and calls neither register a handler nor (un)subscribe at
+    // the broker
+    const auto res_handler = [pending_calls](const std::string&, json data) {
         const auto& data_id = data.at("id");
-        if (data_id != call_id) {
-            EVLOG_debug << fmt::format("RES: data_id != call_id ({} != {})", data_id, call_id);
+        if (not data_id.is_string()) {
             return;
         }
+        // streamed results consist of several messages, the call keeps waiting until the last one
+        const auto last = data.value("done", true);
+        std::function<void(json)> on_result;
+        {
+            const std::lock_guard<std::mutex> lock(pending_calls->mutex);
+            const auto call = pending_calls->calls.find(data_id.get_ref<const std::string&>());
+            if (call == pending_calls->calls.end()) {
+                // result of a call that already timed out
+                return;
+            }
+            if (last) {
+                on_result = std::move(call->second);
+                pending_calls->calls.erase(call);
+            } else {
+                on_result = call->second;
+            }
+        }
 
-        EVLOG_verbose << fmt::format(
-            "Incoming res {} for {}->{}()", data_id,
-            this->config.printable_identifier(connection["module_id"], connection["implementation_id"]), cmd_name);
+        FRAMEWORK_LOG_VERBOSE("Incoming res {}", data_id);
 
-        res_promise.set_value(std::move(data["retval"]));
+        on_result(std::move(data));
     };
+    pending_calls->res_token =
+        std::make_shared<TypedHandler>(HandlerType::Result, std::make_shared<Handler>(res_handler));
+    this->mqtt_abstraction->register_handler(this->cmd_reply_topic, pending_calls->res_token, QOS::QOS2);
+    return pending_calls;
+}
+
+std::string Everest::send_cmd_call(const BoundCmd& call, json json_args, std::chrono::nanoseconds timeout,
+                                   std::function<void(json)> on_result) {
+    return publish_cmd_call(call, std::move(json_args), timeout,
+                            [on_result = std::move(on_result)](json data) { on_result(std::move(data["retval"])); });
+}
+
+std::string Everest::publish_cmd_call(const BoundCmd& call, json json_args,
+                                      std::optional<std::chrono::nanoseconds> timeout,
+                                      std::function<void(json)> on_result_data) {
+    FRAMEWORK_LOG_FUNCTION();
+
+    // unique across restarts of this module by the random prefix, counting is much cheaper than generating uuids
+    const auto call_id = fmt::format("{}-{:x}", this->call_id_prefix, this->next_call_id++);
+
+    const auto pending_calls = get_pending_cmd_calls();
+    {
+        const std::lock_guard<std::mutex> lock(pending_calls->mutex);
+        pending_calls->calls.emplace(call_id, std::move(on_result_data));
+    }
+
+    json call_data = json::object({{"id", call_id},
+                                   {"args", std::move(json_args)},
+                                   {"origin", this->module_id},
+                                   {"reply_to", this->cmd_reply_topic}});
+    if (timeout.has_value()) {
+        // lets the provider skip calls nobody waits for anymore, wall clock time since the provider might run
+        // elsewhere
+        const auto deadline = std::chrono::duration_cast<std::chrono::milliseconds>(
+            (std::chrono::system_clock::now() + *timeout).time_since_epoch());
+        call_data["deadline"] = deadline.count();
+    }
+    json cmd_publish_data = json::object({{"name", call.cmd_name}, {"type", "call"}, {"data", std::move(call_data)}});
+    const auto trace = tracing::current();
+    if (trace.is_valid()) {
+        cmd_publish_data["trace"] = tracing::to_string(trace);
+    }
+
+    this->mqtt_abstraction->publish(call.cmd_topic, cmd_publish_data, call.qos);
 
-    const auto cmd_topic =
-        fmt::format("{}/cmd", this->config.mqtt_prefix(connection["module_id"], connection["implementation_id"]));
+    return call_id;
+}
 
-    const std::shared_ptr<TypedHandler> res_token =
-        std::make_shared<TypedHandler>(cmd_name, call_id, HandlerType::Result, std::make_shared<Handler>(res_handler));
-    this->mqtt_abstraction->register_handler(cmd_topic, res_token, QOS::QOS2);
+void Everest::drop_pending_cmd_call(const std::string& call_id) {
+    const auto pending_calls = get_pending_cmd_calls();
+    const std::lock_guard<std::mutex> lock(pending_calls->mutex);
+    pending_calls->calls.erase(call_id);
+}
 
-    const json cmd_publish_data =
+void Everest::cancel_cmd_call(const std::string& cmd_topic, const std::string& cmd_name, const std::string& call_id) {
+    drop_pending_cmd_call(call_id);
+    // the provider stops handling the call if it has not started yet or if its handler checks for cancellation
+    const json cancel_publish_data =
         json::object({{"name", cmd_name},
-                      {"type", "call"},
-                      {"data", json::object({{"id", call_id}, {"args", json_args}, {"origin", this->module_id}})}});
+                      {"type", "cancel"},
+                      {"data", json::object({{"id", call_id}, {"origin", this->module_id}, {"cancel", true}})}});
+    this->mqtt_abstraction->publish(get_cmd_control_topic(cmd_topic), cancel_publish_data, QOS::QOS2);
+}
 
-    this->mqtt_abstraction->publish(cmd_topic, cmd_publish_data, QOS::QOS2);
+void Everest::acknowledge_cmd_chunks(const BoundCmd& call, const std::string& call_id, std::uint64_t consumed) {
+    const json ack_publish_data =
+        json::object({{"name", call.cmd_name},
+                      {"type", "ack"},
+                      {"data", json::object({{"id", call_id}, {"origin", this->module_id}, {"ack", consumed}})}});
+    this->mqtt_abstraction->publish(get_cmd_control_topic(call.cmd_topic), ack_publish_data, QOS::QOS2);
+}
 
-    // wait for result future
+json Everest::call_cmd(const Requirement& req, const std::string& cmd_name, json json_args) {
+    FRAMEWORK_LOG_FUNCTION();
+
+    return call_cmd(*bind_cmd(req, cmd_name), std::move(json_args));
+}
+
+json Everest::call_cmd(const BoundCmd& call, json json_args) {
+    FRAMEWORK_LOG_FUNCTION();
+
+    if (call.streaming) {
+        EVLOG_AND_THROW(EverestApiError(fmt::format("{}->{}() streams its result, use call_streaming_cmd() to call it",
+                                                    call.target, call.cmd_name)));
+    }
+
+    tracing::Span span("cmd");
+    if (span.is_recording()) {
+        span.set_name(fmt::format("call {}->{}()", call.target, call.cmd_name));
+    }
+
+    if (this->validate_data_with_schema) {
+        validate_cmd_args(call, json_args);
+    }
+
+    std::string cache_key;
+    std::uint64_t cache_generation = 0;
+    if (call.result_cache != nullptr) {
+        cache_key = json_args.dump();
+        auto cached_result = call.result_cache->lookup(cache_key, cache_generation);
+        if (cached_result.has_value()) {
+            return std::move(*cached_result);
+        }
+    }
+
+    // waiting for a free slot counts towards the timeout of the call
     const std::chrono::time_point<std::chrono::steady_clock> res_wait =
         std::chrono::steady_clock::now() + this->remote_cmd_res_timeout;
+    if (call.in_flight_limit != nullptr and not call.in_flight_limit->acquire_until(res_wait)) {
+        // a queued call gives up at its deadline, a rejected one right away
+        if (std::chrono::steady_clock::now() >= res_wait) {
+            this->cmd_call_timeouts_metric->increment();
+            EVLOG_AND_THROW(EverestTimeoutError(fmt::format(
+                "Timeout while waiting for a free slot to call {}->{}()", call.target, call.cmd_name)));
+        }
+        EVLOG_AND_THROW(EverestApiError(fmt::format("Too many calls in flight to {}, {}() has not been called",
+                                                    call.target, call.cmd_name)));
+    }
+
+    // shared with the result handler, which might still be delivering the result when waiting for it timed out
+    auto res_promise = std::make_shared<std::promise<json>>();
+    std::future<json> res_future = res_promise->get_future();
+
+    this->cmd_calls_metric->increment();
+    const auto call_started = std::chrono::steady_clock::now();
+    const auto call_id =
+        send_cmd_call(call, std::move(json_args), res_wait - call_started,
+                      [res_promise](json retval) { res_promise->set_value(std::move(retval)); });
+
+    // wait for result future
     std::future_status res_future_status;
     do {
         res_future_status = res_future.wait_until(res_wait);
     } while (res_future_status == std::future_status::deferred);
+    if (call.in_flight_limit != nullptr) {
+        call.in_flight_limit->release();
+    }
 
     json result;
     if (res_future_status == std::future_status::timeout) {
-        EVLOG_AND_THROW(EverestTimeoutError(fmt::format(
-            "Timeout while waiting for result of {}->{}()",
-            this->config.printable_identifier(connection["module_id"], connection["implementation_id"]), cmd_name)));
+        this->cmd_call_timeouts_metric->increment();
+        FlightRecorder::get().record(FlightEvent::CmdTimeout, HandlerType::Call, call.cmd_topic, call_id,
+                                     std::chrono::steady_clock::now() - call_started);
+        cancel_cmd_call(call.cmd_topic, call.cmd_name, call_id);
+        EVLOG_AND_THROW(EverestTimeoutError(
+            fmt::format("Timeout while waiting for result of {}->{}()", call.target, call.cmd_name)));
     }
     if (res_future_status == std::future_status::ready) {
+        const auto call_duration = std::chrono::steady_clock::now() - call_started;
+        this->cmd_call_duration_metric->record(call_duration);
+        FlightRecorder::get().record(FlightEvent::CmdResult, HandlerType::Call, call.cmd_topic, call_id,
+                                     call_duration);
         result = res_future.get();
+        if (call.result_cache != nullptr) {
+            call.result_cache->store(cache_key, cache_generation, result);
+        }
     }
-    this->mqtt_abstraction->unregister_handler(cmd_topic, res_token);
 
     return result;
 }
 
-void Everest::publish_var(const std::string& impl_id, const std::string& var_name, json value) {
-    BOOST_LOG_FUNCTION();
+void Everest::call_cmd_async(const Requirement& req, const std::string& cmd_name, json json_args,
+                             CmdResultCallback callback) {
+    FRAMEWORK_LOG_FUNCTION();
 
-    // check arguments
+    call_cmd_async(*bind_cmd(req, cmd_name), std::move(json_args), std::move(callback));
+}
+
+void Everest::call_cmd_async(const BoundCmd& call, json json_args, CmdResultCallback callback) {
+    FRAMEWORK_LOG_FUNCTION();
+
+    start_cmd_call(call, std::move(json_args), std::move(callback), this->remote_cmd_res_timeout);
+}
+
+void Everest::start_cmd_call(const BoundCmd& call, json json_args, CmdResultCallback callback,
+                             std::chrono::nanoseconds timeout) {
+    if (call.streaming) {
+        EVLOG_AND_THROW(EverestApiError(fmt::format("{}->{}() streams its result, use call_streaming_cmd() to call it",
+                                                    call.target, call.cmd_name)));
+    }
+
+    // validation errors are thrown right away, like for call_cmd
     if (this->validate_data_with_schema) {
-        const auto impl_intf = this->config.get_interface_definitions().at(this->module_classes.at(impl_id));
+        validate_cmd_args(call, json_args);
+    }
 
-        if (!module_manifest.at("provides").contains(impl_id)) {
-            EVLOG_AND_THROW(EverestApiError(
-                fmt::format("Implementation '{}' not declared in manifest of module '{}'!", impl_id, this->module_id)));
+    std::string cache_key;
+    std::uint64_t cache_generation = 0;
+    if (call.result_cache != nullptr) {
+        cache_key = json_args.dump();
+        auto cached_result = call.result_cache->lookup(cache_key, cache_generation);
+        if (cached_result.has_value()) {
+            this->mqtt_abstraction->get_handler_executor().post(
+                [callback = std::move(callback), cached_result = std::move(*cached_result)]() mutable {
+                    std::promise<json> result;
+                    result.set_value(std::move(cached_result));
+                    callback(result.get_future());
+                });
+            return;
+        }
+    }
+
+    auto async_call = std::make_shared<AsyncCmdCall>(std::move(callback));
+
+    // completes the call exactly once, either with its result or with a timeout
+    const auto complete = [this, cmd_topic = call.cmd_topic, cmd_name = call.cmd_name, limit = call.in_flight_limit](
+                              AsyncCmdCall& async_call, std::promise<json> result, bool timed_out) {
+        const auto completion = async_call.complete();
+        if (not completion.has_value()) {
+            return;
+        }
+        this->mqtt_abstraction->get_event_loop().remove(completion->timeout_timer);
+        if (completion->sent) {
+            if (timed_out) {
+                cancel_cmd_call(cmd_topic, cmd_name, completion->call_id);
+            } else {
+                drop_pending_cmd_call(completion->call_id);
+            }
+            if (limit != nullptr) {
+                limit->release();
+            }
+        }
+        async_call.deliver(this->mqtt_abstraction->get_handler_executor(), std::move(result));
+    };
+
+    async_call->start_timeout([this, &timeout, &async_call, &complete, &call]() {
+        return this->mqtt_abstraction->get_event_loop().add_timer(
+            timeout,
+            [this, async_call, complete, target = call.target, cmd_name = call.cmd_name]() {
+                // callbacks may block, so they must not run on the event loop
+                this->mqtt_abstraction->get_handler_executor().post([async_call, complete, target, cmd_name]() {
+                    const auto message =
+                        fmt::format("Timeout while waiting for result of {}->{}()", target, cmd_name);
+                    EVLOG_error << message;
+                    std::promise<json> result;
+                    result.set_exception(std::make_exception_ptr(EverestTimeoutError(message)));
+                    complete(*async_call, std::move(result), true);
+                });
+            },
+            false);
+    });
+    const auto on_result = [async_call, complete, cache = call.result_cache, cache_key = std::move(cache_key),
+                            cache_generation](json retval) {
+        if (cache != nullptr) {
+            cache->store(cache_key, cache_generation, retval);
+        }
+        std::promise<json> result;
+        result.set_value(std::move(retval));
+        complete(*async_call, std::move(result), false);
+    };
+
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    const auto send = [this, async_call, on_result, deadline](const BoundCmd& call, json json_args) {
+        return async_call->send([this, &call, &json_args, &on_result, deadline]() {
+            return send_cmd_call(call, std::move(json_args), deadline - std::chrono::steady_clock::now(), on_result);
+        });
+    };
+
+    if (call.in_flight_limit == nullptr) {
+        send(call, std::move(json_args));
+        return;
+    }
+
+    // queued calls are sent after this returned, so they need their own copy of the cmd
+    const auto admitted = call.in_flight_limit->admit(
+        [send, queued_call = std::make_shared<const BoundCmd>(call), json_args = std::move(json_args)]() mutable {
+            return send(*queued_call, std::move(json_args));
+        });
+    if (not admitted) {
+        const auto completion = async_call->complete();
+        if (not completion.has_value()) {
+            // the timeout already failed the call
+            return;
+        }
+        this->mqtt_abstraction->get_event_loop().remove(completion->timeout_timer);
+        EVLOG_AND_THROW(EverestApiError(fmt::format("Too many calls in flight to {}, {}() has not been called",
+                                                    call.target, call.cmd_name)));
+    }
+}
+
+std::future<json> Everest::call_cmd_async(const Requirement& req, const std::string& cmd_name, json json_args) {
+    return call_cmd_async(*bind_cmd(req, cmd_name), std::move(json_args));
+}
+
+std::future<json> Everest::call_cmd_async(const BoundCmd& call, json json_args) {
+    auto result = std::make_shared<std::promise<json>>();
+    auto future = result->get_future();
+    call_cmd_async(call, std::move(json_args), [result](std::future<json> call_result) {
+        try {
+            result->set_value(call_result.get());
+        } catch (...) {
+            result->set_exception(std::current_exception());
+        }
+    });
+    return future;
+}
+
+std::shared_ptr<const SchemaValidator> Everest::get_validator(const std::string& interface_name,
+                                                              const std::string& schema_path, const json& schema) {
+    const std::lock_guard<std::mutex> lock(this->validators_mutex);
+    auto& validator = this->validators[fmt::format("{}#/{}", interface_name, schema_path)];
+    if (validator == nullptr) {
+        // validators generated at build time are preferred over interpreting the schema
+        const auto native_validator = native_validators::get(interface_name, schema_path);
+        if (native_validator != nullptr) {
+            validator = std::make_shared<SchemaValidator>(native_validator);
+            return validator;
+        }
+        auto interpreted = std::make_unique<json_validator>(
+            [this](const json_uri& uri, json& schema) { this->config.ref_loader(uri, schema); },
+            Config::format_checker);
+        interpreted->set_root_schema(schema);
+        validator = std::make_shared<SchemaValidator>(std::move(interpreted));
+        this->interpreted_schema_bytes += estimate_json_bytes(schema);
+    }
+    return validator;
+}
+
+const Everest::PublishedVar& Everest::get_published_var(const std::string& impl_id, const std::string& var_name) {
+    const std::lock_guard<std::mutex> lock(this->published_vars_mutex);
+    const auto published_var = this->published_vars.find({impl_id, var_name});
+    if (published_var != this->published_vars.end()) {
+        return published_var->second;
+    }
+
+    const auto module_class = this->module_classes.find(impl_id);
+    if (module_class == this->module_classes.end()) {
+        EVLOG_AND_THROW(EverestApiError(
+            fmt::format("Implementation '{}' not declared in manifest of module '{}'!", impl_id, this->module_id)));
+    }
+    PublishedVar var;
+    var.topic = this->config.get_topic(this->module_id, impl_id, ImplementationTopic::Var);
+    const auto& interface_name = module_class->get_ref<const std::string&>();
+    const auto& impl_vars = this->config.get_interface_definitions().at(interface_name).at("vars");
+    const auto var_definition_it = impl_vars.find(var_name);
+    if (var_definition_it != impl_vars.end()) {
+        var.definition = &*var_definition_it;
+        var.qos = get_qos(*var_definition_it);
+        if (this->validate_data_with_schema) {
+            var.validator = get_validator(interface_name, fmt::format("vars/{}", var_name), *var_definition_it);
+            var.sampler = std::make_shared<ValidationSampler>(this->validation_policy, true);
+            var.cost = get_validation_cost(this->module_id, impl_id, fmt::format("vars/{}", var_name));
+        }
+        const auto& limits = this->var_publish_settings.get_limits(impl_id, var_name);
+        if (limits.change_only) {
+            var.change_filter = std::make_shared<VarChangeFilter>(limits);
         }
+    }
+    return this->published_vars.emplace(std::make_pair(impl_id, var_name), std::move(var)).first->second;
+}
+
+void Everest::call_streaming_cmd(const Requirement& req, const std::string& cmd_name, json json_args,
+                                 const CmdChunkCallback& on_chunk) {
+    FRAMEWORK_LOG_FUNCTION();
+
+    call_streaming_cmd(*bind_cmd(req, cmd_name), std::move(json_args), on_chunk);
+}
+
+void Everest::call_streaming_cmd(const BoundCmd& call, json json_args, const CmdChunkCallback& on_chunk) {
+    FRAMEWORK_LOG_FUNCTION();
+
+    if (not call.streaming) {
+        EVLOG_AND_THROW(EverestApiError(fmt::format("{}->{}() does not stream its result, use call_cmd() to call it",
+                                                    call.target, call.cmd_name)));
+    }
+    if (this->validate_data_with_schema) {
+        validate_cmd_args(call, json_args);
+    }
+
+    if (call.in_flight_limit != nullptr and
+        not call.in_flight_limit->acquire_until(std::chrono::steady_clock::now() + this->remote_cmd_res_timeout)) {
+        EVLOG_AND_THROW(EverestApiError(fmt::format("Too many calls in flight to {}, {}() has not been called",
+                                                    call.target, call.cmd_name)));
+    }
+
+    // chunks are handed over to the calling thread, so a slow consumer does not block other handlers. The provider
+    // waits for acknowledgements of consumed chunks, so at most a window of them is held here
+    const auto stream = std::make_shared<CmdChunkStream>();
+
+    // the stream may take arbitrarily long, so the call has no deadline
+    const auto call_id = publish_cmd_call(call, std::move(json_args), std::nullopt,
+                                          [stream](json data) { stream->push(std::move(data)); });
+
+    const auto stop = [this, &call, &call_id]() {
+        cancel_cmd_call(call.cmd_topic, call.cmd_name, call_id);
+        if (call.in_flight_limit != nullptr) {
+            call.in_flight_limit->release();
+        }
+    };
+    const auto fail = [&stop](const auto& error) {
+        stop();
+        EVLOG_AND_THROW(error);
+    };
+
+    std::uint64_t next_seq = 0;
+    while (true) {
+        json chunk;
+        const auto event = stream->next(this->remote_cmd_res_timeout, chunk);
+        if (event == CmdChunkStream::Event::Done) {
+            break;
+        }
+        switch (event) {
+        case CmdChunkStream::Event::Timeout:
+            fail(EverestTimeoutError(fmt::format("Timeout while waiting for chunk {} of the result of {}->{}()",
+                                                 next_seq, call.target, call.cmd_name)));
+            break;
+        case CmdChunkStream::Event::Lost:
+            fail(EverestInternalError(fmt::format("Chunk {} of the result of {}->{}() has been lost", next_seq,
+                                                  call.target, call.cmd_name)));
+            break;
+        case CmdChunkStream::Event::Overrun:
+            fail(EverestInternalError(fmt::format("{}->{}() sent more chunks of its result than acknowledged",
+                                                  call.target, call.cmd_name)));
+            break;
+        default:
+            break;
+        }
+        next_seq++;
+        try {
+            on_chunk(std::move(chunk));
+        } catch (...) {
+            stop();
+            throw;
+        }
+        const auto consumed = stream->take_acknowledgement();
+        if (consumed.has_value()) {
+            acknowledge_cmd_chunks(call, call_id, *consumed);
+        }
+    }
+
+    if (call.in_flight_limit != nullptr) {
+        call.in_flight_limit->release();
+    }
+}
+
+std::vector<CmdCallResult> Everest::call_cmd_all(const std::string& requirement_id, const std::string& cmd_name,
+                                                 const json& json_args,
+                                                 std::optional<std::chrono::milliseconds> timeout) {
+    FRAMEWORK_LOG_FUNCTION();
+
+    const auto connections = this->config.resolve_requirement(this->module_id, requirement_id);
+    const auto fulfillment_count = connections.is_array() ? connections.size() : std::size_t{1};
+    const auto deadline = std::chrono::steady_clock::now() + timeout.value_or(this->remote_cmd_res_timeout);
+
+    // send all calls before waiting for any result, so waiting takes as long as the slowest call only
+    std::vector<CmdCallResult> results(fulfillment_count);
+    std::vector<std::future<json>> futures(fulfillment_count);
+    for (std::size_t index = 0; index < fulfillment_count; index++) {
+        auto& result = results.at(index);
+        result.requirement = {requirement_id, index};
+        try {
+            auto promise = std::make_shared<std::promise<json>>();
+            futures.at(index) = promise->get_future();
+            start_cmd_call(
+                *bind_cmd(result.requirement, cmd_name), json_args,
+                [promise](std::future<json> call_result) {
+                    try {
+                        promise->set_value(call_result.get());
+                    } catch (...) {
+                        promise->set_exception(std::current_exception());
+                    }
+                },
+                deadline - std::chrono::steady_clock::now());
+        } catch (...) {
+            result.error = std::current_exception();
+            futures.at(index) = {};
+        }
+    }
 
-        if (!impl_intf.at("vars").contains(var_name)) {
+    for (std::size_t index = 0; index < fulfillment_count; index++) {
+        auto& result = results.at(index);
+        auto& future = futures.at(index);
+        if (not future.valid()) {
+            continue;
+        }
+        // the timers of the calls fail them at the deadline, this only guards against an event loop that is not running
+        if (future.wait_until(deadline + std::chrono::seconds(1)) != std::future_status::ready) {
+            result.error = std::make_exception_ptr(EverestTimeoutError(fmt::format(
+                "Timeout while waiting for result of {}[{}]->{}()", requirement_id, index, cmd_name)));
+            continue;
+        }
+        try {
+            result.result = future.get();
+        } catch (...) {
+            result.error = std::current_exception();
+        }
+    }
+    return results;
+}
+
+void Everest::publish_var(const std::string& impl_id, const std::string& var_name, json value) {
+    FRAMEWORK_LOG_FUNCTION();
+
+    // check arguments
+    if (this->validate_data_with_schema and !module_manifest.at("provides").contains(impl_id)) {
+        EVLOG_AND_THROW(EverestApiError(
+            fmt::format("Implementation '{}' not declared in manifest of module '{}'!", impl_id, this->module_id)));
+    }
+
+    // topic, qos and definition of the var never change, so they are only looked up once
+    const auto& var = get_published_var(impl_id, var_name);
+
+    if (this->validate_data_with_schema) {
+        if (var.definition == nullptr) {
             EVLOG_AND_THROW(
                 EverestApiError(fmt::format("{} does not declare var '{}' in manifest!",
                                             this->config.printable_identifier(this->module_id, impl_id), var_name)));
         }
 
-        // validate var contents before publishing
-        const auto var_definition = impl_intf.at("vars").at(var_name);
+        if (this->validation_policy.asynchronous) {
+            if (sample_validation(*var.sampler)) {
+                if (is_unchanged(var, std::hash<json>{}(value))) {
+                    return;
+                }
+                publish_var_validated_async(var, impl_id, var_name, std::move(value));
+                return;
+            }
+        } else {
+            // validate var contents before publishing
+            try {
+                if (sample_validation(*var.sampler)) {
+                    record_validation(*var.cost, [&]() { var.validator->validate(value); });
+                }
+            } catch (const std::exception& e) {
+                this->validation_counters.violations++;
+                EVLOG_AND_THROW(EverestApiError(fmt::format(
+                    "Publish var of {} with variable name '{}' with value: {}\ncould not be validated with schema: {}",
+                    this->config.printable_identifier(this->module_id, impl_id), var_name, value.dump(2), e.what())));
+            }
+        }
+    }
+
+    // compared after the validation, so publishing an invalid value again throws again
+    if (is_unchanged(var, std::hash<json>{}(value))) {
+        return;
+    }
+
+    // the value is moved into the envelope, which is serialized straight into the reused payload buffer of the
+    // publishing thread
+    json var_publish_data = json::object();
+    var_publish_data.emplace("name", var_name);
+    var_publish_data.emplace("data", std::move(value));
+    publish_var_envelope(var, impl_id, var_name, var_publish_data);
+}
+
+void Everest::publish_var_envelope(const PublishedVar& var, const std::string& impl_id, const std::string& var_name,
+                                   json& var_publish_data) {
+    tracing::Span span("publish");
+    if (span.get_context().is_valid()) {
+        var_publish_data["trace"] = tracing::to_string(span.get_context());
+        if (span.is_recording()) {
+            span.set_name(fmt::format("publish {}.{}", impl_id, var_name));
+        }
+    }
+
+    this->mqtt_abstraction->publish(var.topic, var_publish_data, var.qos);
+    this->vars_published_metric->increment();
+}
+
+void Everest::publish_var_serialized(const std::string& impl_id, const std::string& var_name,
+                                     const std::string& payload) {
+    FRAMEWORK_LOG_FUNCTION();
+
+    if (this->validate_data_with_schema or
+        this->mqtt_abstraction->get_payload_encoding() != MQTTPayloadEncoding::Json) {
+        publish_var(impl_id, var_name, json::parse(payload));
+        return;
+    }
+
+    const auto& var = get_published_var(impl_id, var_name);
+    // the payload is hashed as is, so the same value serialized differently counts as changed
+    if (is_unchanged(var, std::hash<std::string>{}(payload))) {
+        return;
+    }
+    // the same message publish_var() would build, without parsing and serializing the value again
+    std::string message = fmt::format("{{\"name\":{},\"data\":{}", json(var_name).dump(), payload);
+    tracing::Span span("publish");
+    if (span.get_context().is_valid()) {
+        message += fmt::format(",\"trace\":\"{}\"", tracing::to_string(span.get_context()));
+        if (span.is_recording()) {
+            span.set_name(fmt::format("publish {}.{}", impl_id, var_name));
+        }
+    }
+    message += '}';
+
+    this->mqtt_abstraction->publish(var.topic, message, var.qos);
+    this->vars_published_metric->increment();
+}
+
+bool Everest::is_unchanged(const PublishedVar& var, std::size_t hash) {
+    if (var.change_filter == nullptr or var.change_filter->should_publish(hash)) {
+        return false;
+    }
+    this->vars_suppressed_metric->increment();
+    return true;
+}
+
+void Everest::publish_var_validated_async(const PublishedVar& var, const std::string& impl_id,
+                                          const std::string& var_name, json value) {
+    // the published data is shared with the validation instead of copying it
+    auto envelope = std::make_shared<json>(json::object());
+    envelope->emplace("name", var_name);
+    envelope->emplace("data", std::move(value));
+    publish_var_envelope(var, impl_id, var_name, *envelope);
+    const std::shared_ptr<const json> var_publish_data = std::move(envelope);
+
+    const auto queued = this->async_validations.push([this, validator = var.validator, cost = var.cost,
+                                                      var_publish_data, impl_id]() {
+        const auto& data = var_publish_data->at("data");
         try {
-            json_validator validator(
-                [this](const json_uri& uri, json& schema) { this->config.ref_loader(uri, schema); },
-                Config::format_checker);
-            validator.set_root_schema(var_definition);
-            validator.validate(value);
+            record_validation(*cost, [&]() { validator->validate(data); });
         } catch (const std::exception& e) {
-            EVLOG_AND_THROW(EverestApiError(fmt::format(
-                "Publish var of {} with variable name '{}' with value: {}\ncould not be validated with schema: {}",
-                this->config.printable_identifier(this->module_id, impl_id), var_name, value.dump(2), e.what())));
+            this->validation_counters.violations++;
+            EVLOG_error << fmt::format(
+                "Published var of {} with variable name '{}' with value: {}\ndoes not match its schema: {}",
+                this->config.printable_identifier(this->module_id, impl_id),
+                var_publish_data->at("name").get_ref<const std::string&>(), data.dump(2), e.what());
         }
+    });
+    if (not queued) {
+        // counted as validated by the sampler already
+        this->validation_counters.validated--;
+        this->validation_counters.dropped++;
     }
+}
+
+PublishBatch Everest::publish_batch() {
+    FRAMEWORK_LOG_FUNCTION();
 
-    const auto var_topic = fmt::format("{}/var", this->config.mqtt_prefix(this->module_id, impl_id));
+    return PublishBatch(*this->mqtt_abstraction);
+}
 
-    const json var_publish_data = {{"name", var_name}, {"data", value}};
+void Everest::publish_vars(const std::string& impl_id, const std::vector<std::pair<std::string, json>>& vars) {
+    FRAMEWORK_LOG_FUNCTION();
 
-    // FIXME(kai): implement an efficient way of choosing qos for each variable
-    this->mqtt_abstraction->publish(var_topic, var_publish_data, QOS::QOS2);
+    const auto batch = this->publish_batch();
+    for (const auto& [var_name, value] : vars) {
+        this->publish_var(impl_id, var_name, value);
+    }
 }
 
-void Everest::subscribe_var(const Requirement& req, const std::string& var_name, const JsonCallback& callback) {
-    BOOST_LOG_FUNCTION();
+void Everest::subscribe_var(const Requirement& req, const std::string& var_name, const JsonCallback& callback,
+                            VarSubscriptionMode mode) {
+    FRAMEWORK_LOG_FUNCTION();
 
-    EVLOG_debug << fmt::format("subscribing to var: {}:{}", req.id, var_name);
+    FRAMEWORK_LOG_DEBUG("subscribing to var: {}:{}", req.id, var_name);
 
     // resolve requirement
     json connections = this->config.resolve_requirement(this->module_id, req.id);
@@ -471,8 +1434,9 @@ void Everest::subscribe_var(const Requirement& req, const std::string& var_name,
     const auto requirement_module_id = connection.at("module_id").get<std::string>();
     const auto module_name = this->config.get_module_name(requirement_module_id);
     const auto requirement_impl_id = connection.at("implementation_id").get<std::string>();
-    const auto requirement_impl_manifest = this->config.get_interface_definitions().at(
-        this->config.get_interfaces().at(module_name).at(requirement_impl_id));
+    const auto& interface_name =
+        this->config.get_interfaces().at(module_name).at(requirement_impl_id).get_ref<const std::string&>();
+    const auto& requirement_impl_manifest = this->config.get_interface_definitions().at(interface_name);
 
     if (!requirement_impl_manifest.at("vars").contains(var_name)) {
         EVLOG_AND_THROW(EverestApiError(
@@ -480,22 +1444,28 @@ void Everest::subscribe_var(const Requirement& req, const std::string& var_name,
                         this->config.printable_identifier(requirement_module_id, requirement_impl_id), var_name)));
     }
 
-    const auto requirement_manifest_vardef = requirement_impl_manifest.at("vars").at(var_name);
+    const auto& requirement_manifest_vardef = requirement_impl_manifest.at("vars").at(var_name);
 
-    const auto handler = [this, requirement_module_id, requirement_impl_id, requirement_manifest_vardef, var_name,
-                          callback](const std::string&, json const& data) {
-        EVLOG_verbose << fmt::format(
-            "Incoming {}->{}", this->config.printable_identifier(requirement_module_id, requirement_impl_id), var_name);
+    std::shared_ptr<const SchemaValidator> validator;
+    std::shared_ptr<ValidationSampler> sampler;
+    std::shared_ptr<ValidationCost> cost;
+    if (this->validate_data_with_schema) {
+        validator = get_validator(interface_name, fmt::format("vars/{}", var_name), requirement_manifest_vardef);
+        sampler = std::make_shared<ValidationSampler>(this->validation_policy, false);
+        cost = get_validation_cost(requirement_module_id, requirement_impl_id, fmt::format("vars/{}", var_name));
+    }
 
-        if (this->validate_data_with_schema) {
+    const auto deliver = [this, requirement_module_id, requirement_impl_id, validator, sampler, cost, var_name,
+                          callback](json const& data) {
+        FRAMEWORK_LOG_VERBOSE("Incoming {}->{}",
+                              this->config.printable_identifier(requirement_module_id, requirement_impl_id), var_name);
+
+        if (validator != nullptr and sample_validation(*sampler)) {
             // check data and ignore it if not matching (publishing it should have been prohibited already)
             try {
-                json_validator validator(
-                    [this](const json_uri& uri, json& schema) { this->config.ref_loader(uri, schema); },
-                    Config::format_checker);
-                validator.set_root_schema(requirement_manifest_vardef);
-                validator.validate(data);
+                record_validation(*cost, [&]() { validator->validate(data); });
             } catch (const std::exception& e) {
+                this->validation_counters.violations++;
                 EVLOG_warning << fmt::format("Ignoring incoming var '{}' because not matching manifest schema: {}",
                                              var_name, e.what());
                 return;
@@ -505,19 +1475,29 @@ void Everest::subscribe_var(const Requirement& req, const std::string& var_name,
         callback(data);
     };
 
-    const auto var_topic = fmt::format("{}/var", this->config.mqtt_prefix(requirement_module_id, requirement_impl_id));
+    Handler handler;
+    if (mode == VarSubscriptionMode::LatestValue) {
+        // validation is deferred until delivery as well, so values that are replaced anyway are never validated
+        const auto slot = std::make_shared<LatestValueSlot>(this->mqtt_abstraction->get_handler_executor(), deliver);
+        handler = [slot](const std::string&, json data) { slot->store(std::move(data)); };
+    } else {
+        handler = [deliver](const std::string&, json const& data) { deliver(data); };
+    }
+
+    const auto& var_topic =
+        this->config.get_topic(requirement_module_id, requirement_impl_id, ImplementationTopic::Var);
 
     // TODO(kai): multiple subscription should be perfectly fine here!
-    const std::shared_ptr<TypedHandler> token =
-        std::make_shared<TypedHandler>(var_name, HandlerType::SubscribeVar, std::make_shared<Handler>(handler));
+    const std::shared_ptr<TypedHandler> token = std::make_shared<TypedHandler>(
+        var_name, HandlerType::SubscribeVar, std::make_shared<Handler>(std::move(handler)));
     this->mqtt_abstraction->register_handler(var_topic, token, QOS::QOS2);
 }
 
 void Everest::subscribe_error(const Requirement& req, const error::ErrorType& error_type,
                               const error::ErrorCallback& callback, const error::ErrorCallback& clear_callback) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
-    EVLOG_debug << fmt::format("subscribing to error: {}:{}", req.id, error_type);
+    FRAMEWORK_LOG_DEBUG("subscribing to error: {}:{}", req.id, error_type);
 
     // resolve requirement
     json connections = this->config.resolve_requirement(this->module_id, req.id);
@@ -551,26 +1531,25 @@ void Everest::subscribe_error(const Requirement& req, const error::ErrorType& er
 
     const auto raise_handler = [this, requirement_module_id, requirement_impl_id, error_type,
                                 callback](const std::string&, json const& data) {
-        EVLOG_debug << fmt::format("Incoming error {}->{}",
-                                   this->config.printable_identifier(requirement_module_id, requirement_impl_id),
-                                   error_type);
+        FRAMEWORK_LOG_DEBUG("Incoming error {}->{}",
+                            this->config.printable_identifier(requirement_module_id, requirement_impl_id), error_type);
 
         callback(data.get<error::Error>());
     };
 
     const auto clear_handler = [this, requirement_module_id, requirement_impl_id, error_type,
                                 clear_callback](const std::string&, json const& data) {
-        EVLOG_debug << fmt::format("Error cleared {}->{}",
-                                   this->config.printable_identifier(requirement_module_id, requirement_impl_id),
-                                   error_type);
+        FRAMEWORK_LOG_DEBUG("Error cleared {}->{}",
+                            this->config.printable_identifier(requirement_module_id, requirement_impl_id), error_type);
         clear_callback(data.get<error::Error>());
     };
 
     const std::string raise_topic =
-        fmt::format("{}/error/{}", this->config.mqtt_prefix(requirement_module_id, requirement_impl_id), error_type);
+        this->config.get_topic(requirement_module_id, requirement_impl_id, ImplementationTopic::Error) + error_type;
 
-    const std::string clear_topic = fmt::format(
-        "{}/error-cleared/{}", this->config.mqtt_prefix(requirement_module_id, requirement_impl_id), error_type);
+    const std::string clear_topic =
+        this->config.get_topic(requirement_module_id, requirement_impl_id, ImplementationTopic::ErrorCleared) +
+        error_type;
 
     const std::shared_ptr<TypedHandler> raise_token = std::make_shared<TypedHandler>(
         error_type, HandlerType::SubscribeError, std::make_shared<Handler>(raise_handler));
@@ -637,9 +1616,9 @@ std::shared_ptr<error::ErrorStateMonitor> Everest::get_global_error_state_monito
 
 void Everest::subscribe_global_all_errors(const error::ErrorCallback& callback,
                                           const error::ErrorCallback& clear_callback) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
-    EVLOG_debug << fmt::format("subscribing to all errors");
+    FRAMEWORK_LOG_DEBUG("subscribing to all errors");
 
     if (not this->config.get_module_info(this->module_id).global_errors_enabled) {
         EVLOG_error << fmt::format("Module {} is not allowed to subscribe to all errors, ignore subscription",
@@ -649,105 +1628,97 @@ void Everest::subscribe_global_all_errors(const error::ErrorCallback& callback,
 
     const auto raise_handler = [this, callback](const std::string&, json const& data) {
         error::Error error = data.get<error::Error>();
-        EVLOG_debug << fmt::format(
-            "Incoming error {}->{}",
-            this->config.printable_identifier(error.origin.module_id, error.origin.implementation_id), error.type);
+        FRAMEWORK_LOG_DEBUG("Incoming error {}->{}",
+                            this->config.printable_identifier(error.origin.module_id, error.origin.implementation_id),
+                            error.type);
         callback(error);
     };
 
     const auto clear_handler = [this, clear_callback](const std::string&, json const& data) {
         error::Error error = data.get<error::Error>();
-        EVLOG_debug << fmt::format(
-            "Incoming error cleared {}->{}",
-            this->config.printable_identifier(error.origin.module_id, error.origin.implementation_id), error.type);
+        FRAMEWORK_LOG_DEBUG("Incoming error cleared {}->{}",
+                            this->config.printable_identifier(error.origin.module_id, error.origin.implementation_id),
+                            error.type);
         clear_callback(error);
     };
 
-    for (const auto& [module_id, module_name] : this->config.get_module_names()) {
-        const json provides = this->config.get_manifests().at(module_name).at("provides");
-        for (const auto& impl : provides.items()) {
-            const std::string& impl_id = impl.key();
-            const std::string& interface = impl.value().at("interface");
-            const json errors = this->config.get_interface_definition(interface).at("errors");
-            for (const auto& error_namespace_it : errors.items()) {
-                const std::string& error_type_namespace = error_namespace_it.key();
-                for (const auto& error_name_it : error_namespace_it.value().items()) {
-                    const std::string& error_type_name = error_name_it.key();
-                    const std::string raise_topic =
-                        fmt::format("{}/error/{}/{}", this->config.mqtt_prefix(module_id, impl_id),
-                                    error_type_namespace, error_type_name);
-                    const std::shared_ptr<TypedHandler> raise_token = std::make_shared<TypedHandler>(
-                        HandlerType::SubscribeError, std::make_shared<Handler>(raise_handler));
-                    this->mqtt_abstraction->register_handler(raise_topic, raise_token, QOS::QOS2);
-
-                    const std::string clear_topic =
-                        fmt::format("{}/error-cleared/{}/{}", this->config.mqtt_prefix(module_id, impl_id),
-                                    error_type_namespace, error_type_name);
-                    const std::shared_ptr<TypedHandler> clear_token = std::make_shared<TypedHandler>(
-                        HandlerType::SubscribeError, std::make_shared<Handler>(clear_handler));
-                    this->mqtt_abstraction->register_handler(clear_topic, clear_token, QOS::QOS2);
-                }
-            }
-        }
-    }
+    // a single wildcard subscription per direction covers the errors of all implementations of all modules, the
+    // error type is part of the payload
+    const std::shared_ptr<TypedHandler> raise_token =
+        std::make_shared<TypedHandler>(HandlerType::SubscribeError, std::make_shared<Handler>(raise_handler));
+    this->mqtt_abstraction->register_handler(fmt::format("{}modules/+/impl/+/error/#", this->mqtt_everest_prefix),
+                                             raise_token, QOS::QOS2);
+
+    const std::shared_ptr<TypedHandler> clear_token =
+        std::make_shared<TypedHandler>(HandlerType::SubscribeError, std::make_shared<Handler>(clear_handler));
+    this->mqtt_abstraction->register_handler(
+        fmt::format("{}modules/+/impl/+/error-cleared/#", this->mqtt_everest_prefix), clear_token, QOS::QOS2);
 }
 
 void Everest::publish_raised_error(const std::string& impl_id, const error::Error& error) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
-    const auto error_topic = fmt::format("{}/error/{}", this->config.mqtt_prefix(this->module_id, impl_id), error.type);
+    const auto error_topic = this->config.get_topic(this->module_id, impl_id, ImplementationTopic::Error) + error.type;
 
     this->mqtt_abstraction->publish(error_topic, json(error), QOS::QOS2);
 }
 
 void Everest::publish_cleared_error(const std::string& impl_id, const error::Error& error) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
     const auto error_topic =
-        fmt::format("{}/error-cleared/{}", this->config.mqtt_prefix(this->module_id, impl_id), error.type);
+        this->config.get_topic(this->module_id, impl_id, ImplementationTopic::ErrorCleared) + error.type;
 
     this->mqtt_abstraction->publish(error_topic, json(error), QOS::QOS2);
 }
 
 void Everest::external_mqtt_publish(const std::string& topic, const std::string& data) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
     check_external_mqtt();
     this->mqtt_abstraction->publish(fmt::format("{}{}", this->mqtt_external_prefix, topic), data);
 }
 
+void Everest::external_mqtt_publish_raw(const std::string& topic, std::string_view payload, QOS qos) {
+    FRAMEWORK_LOG_FUNCTION();
+    check_external_mqtt();
+    // the topic is built in a buffer reused by all raw publishes of this thread
+    thread_local std::string external_topic;
+    external_topic.assign(this->mqtt_external_prefix).append(topic);
+    this->mqtt_abstraction->publish_raw(external_topic, payload, qos);
+}
+
 UnsubscribeToken Everest::provide_external_mqtt_handler(const std::string& topic, const StringHandler& handler) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
     const auto external_topic = check_external_mqtt(topic);
-    return create_external_handler(
-        topic, external_topic, [handler, external_topic](const std::string&, json const& data) {
-            EVLOG_verbose << fmt::format("Incoming external mqtt data for topic '{}'...", external_topic);
-            if (!data.is_string()) {
-                EVLOG_AND_THROW(
-                    EverestInternalError("External mqtt result is not a string (that should never happen)"));
-            }
-            handler(data.get<std::string>());
-        });
+    return create_external_handler(external_topic, [handler](std::string_view topic, std::string_view payload) {
+        FRAMEWORK_LOG_VERBOSE("Incoming external mqtt data for topic '{}'...", topic);
+        handler(std::string(payload));
+    });
 }
 
 UnsubscribeToken Everest::provide_external_mqtt_handler(const std::string& topic, const StringPairHandler& handler) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
     const auto external_topic = check_external_mqtt(topic);
-    return create_external_handler(topic, external_topic, [handler](const std::string& topic, const json& data) {
-        EVLOG_verbose << fmt::format("Incoming external mqtt data for topic '{}'...", topic);
-        const std::string data_s = (data.is_string()) ? std::string(data) : data.dump();
-        handler(topic, data_s);
+    return create_external_handler(external_topic, [handler](std::string_view topic, std::string_view payload) {
+        FRAMEWORK_LOG_VERBOSE("Incoming external mqtt data for topic '{}'...", topic);
+        handler(std::string(topic), std::string(payload));
     });
 }
 
+UnsubscribeToken Everest::provide_external_mqtt_raw_handler(const std::string& topic, const RawHandler& handler) {
+    FRAMEWORK_LOG_FUNCTION();
+    return create_external_handler(check_external_mqtt(topic), handler);
+}
+
 void Everest::telemetry_publish(const std::string& topic, const std::string& data) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
     this->mqtt_abstraction->publish(fmt::format("{}{}", this->telemetry_prefix, topic), data);
 }
 
 void Everest::telemetry_publish(const std::string& category, const std::string& subcategory, const std::string& type,
                                 const TelemetryMap& telemetry) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
     if (!this->telemetry_enabled || !this->telemetry_config.has_value()) {
         // telemetry not enabled for this module instance in config
@@ -755,9 +1726,7 @@ void Everest::telemetry_publish(const std::string& category, const std::string&
     }
     const int id = telemetry_config->id;
     const std::string id_string = std::to_string(id);
-    auto telemetry_data =
-        json::object({{"timestamp", Date::to_rfc3339(date::utc_clock::now())}, {"connector_id", id}, {"type", type}});
-
+    auto values = json::object();
     for (auto&& [key, entry] : telemetry) {
         if (std::any_of(TELEMETRY_RESERVED_KEYS.begin(), TELEMETRY_RESERVED_KEYS.end(),
                         [&key_ = key](const auto& element) { return element == key_; })) {
@@ -765,17 +1734,42 @@ void Everest::telemetry_publish(const std::string& category, const std::string&
         } else {
             json data;
             std::visit([&data](auto& value) { data = value; }, entry);
-            telemetry_data[key] = data;
+            values[key] = data;
         }
     }
     const std::string topic = category + "/" + id_string + "/" + subcategory;
+
+    if (this->telemetry_aggregator != nullptr) {
+        // published with the next batch
+        this->telemetry_aggregator->add(topic, type, values);
+        return;
+    }
+
+    auto telemetry_data =
+        json::object({{"timestamp", Date::to_rfc3339(Date::CoarseClock::now())}, {"connector_id", id}, {"type", type}});
+    telemetry_data.update(values);
     this->telemetry_publish(topic, telemetry_data.dump());
 }
 
+void Everest::publish_telemetry_batch() {
+    FRAMEWORK_LOG_FUNCTION();
+
+    auto samples = this->telemetry_aggregator->flush();
+    if (samples.empty()) {
+        return;
+    }
+    const int id = this->telemetry_config->id;
+    const json batch = {{"timestamp", Date::to_rfc3339(Date::CoarseClock::now())},
+                        {"connector_id", id},
+                        {"interval_ms", this->telemetry_config->batch_interval.count()},
+                        {"samples", std::move(samples)}};
+    this->telemetry_publish(fmt::format("batch/{}", id), batch.dump());
+}
+
 void Everest::signal_ready() {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
-    const auto ready_topic = fmt::format("{}/ready", this->config.mqtt_module_prefix(this->module_id));
+    const auto& ready_topic = this->config.get_topic(this->module_id, ModuleTopic::Ready);
 
     this->mqtt_abstraction->publish(ready_topic, json(true), QOS::QOS2);
 }
@@ -785,9 +1779,9 @@ void Everest::signal_ready() {
 /// This will called when receiving the global ready signal from manager.
 ///
 void Everest::handle_ready(const json& data) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
-    EVLOG_debug << fmt::format("handle_ready: {}", data.dump());
+    FRAMEWORK_LOG_DEBUG("handle_ready: {}", data.dump());
 
     bool ready = false;
 
@@ -800,12 +1794,14 @@ void Everest::handle_ready(const json& data) {
         return;
     }
 
-    if (this->ready_received) {
-        EVLOG_warning << "Ignoring repeated everest ready signal (possibly triggered by "
-                         "restarting a standalone module)!";
+    // the group and the global ready signal might be handled concurrently
+    if (this->ready_received.exchange(true)) {
+        if (this->ready_group.empty()) {
+            EVLOG_warning << "Ignoring repeated everest ready signal (possibly triggered by "
+                             "restarting a standalone module or reloading the config)!";
+        }
         return;
     }
-    this->ready_received = true;
 
     // call module ready handler
     EVLOG_debug << "Framework now ready to process events, calling module ready handler";
@@ -813,16 +1809,108 @@ void Everest::handle_ready(const json& data) {
         const auto on_ready_handler = *on_ready;
         on_ready_handler();
     }
+}
+
+namespace {
+/// \brief The cmd call handled on the current thread, nullptr if none
+thread_local std::shared_ptr<CmdCallContext> current_cmd_call;
+
+/// \returns the key of the given call or cancellation \p data in the active cmd calls
+std::string context_key(const json& data) {
+    return fmt::format("{}/{}", data.value("origin", ""), data.at("id").dump());
+}
+} // namespace
+
+std::shared_ptr<const CmdCallContext> Everest::get_current_cmd_call() {
+    return current_cmd_call;
+}
+
+std::shared_ptr<CmdCallContext> Everest::begin_cmd_call(const json& data) {
+    std::optional<std::chrono::system_clock::time_point> deadline;
+    const auto deadline_it = data.find("deadline");
+    if (deadline_it != data.end() and deadline_it->is_number_integer()) {
+        deadline = std::chrono::system_clock::time_point(std::chrono::milliseconds(deadline_it->get<std::int64_t>()));
+    }
+    auto context = std::make_shared<CmdCallContext>(deadline);
+    const auto key = context_key(data);
+    const std::lock_guard<std::mutex> lock(this->active_cmd_calls_mutex);
+    if (this->early_cancelled_cmd_calls.erase(key) > 0) {
+        context->cancel();
+    }
+    this->active_cmd_calls[key] = context;
+    return context;
+}
+
+void Everest::end_cmd_call(const std::string& key) {
+    const std::lock_guard<std::mutex> lock(this->active_cmd_calls_mutex);
+    this->active_cmd_calls.erase(key);
+}
+
+void Everest::cancel_active_cmd_call(const std::string& key) {
+    const std::lock_guard<std::mutex> lock(this->active_cmd_calls_mutex);
+    const auto context = this->active_cmd_calls.find(key);
+    if (context != this->active_cmd_calls.end()) {
+        FRAMEWORK_LOG_DEBUG("Call {} has been cancelled by its caller", key);
+        context->second->cancel();
+        return;
+    }
+    // cancellations are handled apart from the calls, the call might still be waiting to be started or be finished
+    // already
+    auto& order = this->early_cancelled_cmd_calls_order;
+    if (order.size() >= max_early_cancelled_cmd_calls) {
+        this->early_cancelled_cmd_calls.erase(order.front());
+        order.pop_front();
+    }
+    order.push_back(key);
+    this->early_cancelled_cmd_calls.insert(key);
+}
 
-    // TODO(kai): make heartbeat interval configurable, disable it completely until then
-    // this->heartbeat_thread = std::thread(&Everest::heartbeat, this);
+void Everest::acknowledge_active_cmd_call(const std::string& key, std::uint64_t consumed) {
+    const std::lock_guard<std::mutex> lock(this->active_cmd_calls_mutex);
+    const auto context = this->active_cmd_calls.find(key);
+    if (context != this->active_cmd_calls.end()) {
+        context->second->acknowledge(consumed);
+    }
 }
 
 void Everest::provide_cmd(const std::string& impl_id, const std::string& cmd_name, const JsonCommand& handler) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
-    // extract manifest definition of this command
-    const json cmd_definition = get_cmd_definition(this->module_id, impl_id, cmd_name, false);
+    register_cmd_handler(
+        impl_id, cmd_name, [handler](json args, const CmdChunkWriter& write) { write(handler(std::move(args))); },
+        false, false);
+}
+
+void Everest::provide_streaming_cmd(const std::string& impl_id, const std::string& cmd_name,
+                                    const StreamingJsonCommand& handler) {
+    FRAMEWORK_LOG_FUNCTION();
+
+    register_cmd_handler(impl_id, cmd_name, handler, true, false);
+}
+
+void Everest::provide_deferred_cmd(const std::string& impl_id, const std::string& cmd_name,
+                                   const DeferredJsonCommand& handler) {
+    FRAMEWORK_LOG_FUNCTION();
+
+    // the responder is a chunk writer, which the wrapper hands out as a copy owning its state
+    register_cmd_handler(
+        impl_id, cmd_name, [handler](json args, const CmdChunkWriter& respond) { handler(std::move(args), respond); },
+        false, true);
+}
+
+void Everest::register_cmd_handler(const std::string& impl_id, const std::string& cmd_name,
+                                   const StreamingJsonCommand& handler, bool streaming, bool deferred) {
+    FRAMEWORK_LOG_FUNCTION();
+
+    // extract manifest definition of this command, the handlers refer to it in the config instead of copying it
+    const auto& cmd_definition = get_cmd_definition(this->module_id, impl_id, cmd_name, false);
+
+    if (cmd_definition.value("streaming", false) != streaming) {
+        EVLOG_AND_THROW(EverestApiError(
+            fmt::format("{}->{}(...): {}", this->config.printable_identifier(this->module_id, impl_id), cmd_name,
+                        streaming ? "Only cmds declared as streaming can be provided with provide_streaming_cmd()"
+                                  : "Streaming cmds have to be provided with provide_streaming_cmd()")));
+    }
 
     if (this->registered_cmds.count(impl_id) != 0 && this->registered_cmds.at(impl_id).count(cmd_name) != 0) {
         EVLOG_AND_THROW(EverestApiError(fmt::format(
@@ -830,91 +1918,274 @@ void Everest::provide_cmd(const std::string& impl_id, const std::string& cmd_nam
             this->config.printable_identifier(this->module_id, impl_id), cmd_name)));
     }
 
-    const auto cmd_topic = fmt::format("{}/cmd", this->config.mqtt_prefix(this->module_id, impl_id));
+    const auto& cmd_topic = this->config.get_topic(this->module_id, impl_id, ImplementationTopic::Cmd);
 
-    // define command wrapper
-    const auto wrapper = [this, cmd_topic, impl_id, cmd_name, handler, cmd_definition](const std::string&, json data) {
-        BOOST_LOG_FUNCTION();
+    // schemas are compiled once, not for every call
+    std::map<std::string, std::shared_ptr<const SchemaValidator>> arg_validators;
+    std::shared_ptr<const SchemaValidator> result_validator;
+    if (this->validate_data_with_schema) {
+        const auto& interface_name = this->module_classes.at(impl_id).get_ref<const std::string&>();
+        if (cmd_definition.contains("arguments")) {
+            for (const auto& [arg_name, arg_definition] : cmd_definition.at("arguments").items()) {
+                arg_validators.emplace(arg_name, get_validator(interface_name,
+                                                               fmt::format("cmds/{}/arguments/{}", cmd_name, arg_name),
+                                                               arg_definition));
+            }
+        }
+        if (cmd_definition.contains("result") and not cmd_definition.at("result").is_null()) {
+            result_validator =
+                get_validator(interface_name, fmt::format("cmds/{}/result", cmd_name), cmd_definition.at("result"));
+        }
+    }
+    // arguments are received from the caller, results are sent to it
+    const auto arg_sampler = std::make_shared<ValidationSampler>(this->validation_policy, false);
+    const auto result_sampler = std::make_shared<ValidationSampler>(this->validation_policy, true);
+    const auto arg_cost = get_validation_cost(this->module_id, impl_id, fmt::format("cmds/{}/arguments", cmd_name));
+    const auto result_cost = get_validation_cost(this->module_id, impl_id, fmt::format("cmds/{}/result", cmd_name));
+    const auto qos = get_qos(cmd_definition);
+
+    // checks a result against the manifest, shared with the responders of deferred cmds outliving the wrapper
+    const auto validate_result = std::make_shared<const std::function<bool(const json&)>>(
+        [this, cmd_name, &cmd_definition = cmd_definition, result_validator, result_sampler,
+         result_cost](const json& retval) {
+            if (not this->validate_data_with_schema or not sample_validation(*result_sampler)) {
+                return true;
+            }
+            try {
+                // only use validator on non-null return types
+                if (!(retval.is_null() && result_validator == nullptr)) {
+                    record_validation(*result_cost, [&]() {
+                        if (result_validator == nullptr) {
+                            throw std::invalid_argument("the cmd does not declare a result");
+                        }
+                        result_validator->validate(retval);
+                    });
+                }
+            } catch (const std::exception& e) {
+                this->validation_counters.violations++;
+                EVLOG_warning << fmt::format("Ignoring return value of cmd '{}' because the validation of the result "
+                                             "failed: {}\ndefinition: {}\ndata: {}",
+                                             cmd_name, e.what(), cmd_definition, retval);
+                return false;
+            }
+            return true;
+        });
+
+    // define command wrapper, which returns true if a deferred cmd is still waiting for its response
+    const auto wrapper = [this, cmd_topic, impl_id, cmd_name, handler, &cmd_definition = cmd_definition, streaming,
+                          deferred, qos, arg_validators, arg_sampler, arg_cost,
+                          validate_result](const std::string&, json data) {
+        FRAMEWORK_LOG_FUNCTION();
+
+        if (current_cmd_call != nullptr and current_cmd_call->is_abandoned()) {
+            FRAMEWORK_LOG_DEBUG("Skipping call {} of {}->{}(), its caller stopped waiting for it",
+                                data.at("id").dump(), this->config.printable_identifier(this->module_id, impl_id),
+                                cmd_name);
+            return false;
+        }
 
         std::set<std::string> arg_names;
         if (cmd_definition.contains("arguments")) {
             arg_names = Config::keys(cmd_definition.at("arguments"));
         }
 
-        EVLOG_verbose << fmt::format("Incoming {}->{}({}) for <handler>",
-                                     this->config.printable_identifier(this->module_id, impl_id), cmd_name,
-                                     fmt::join(arg_names, ","));
+        FRAMEWORK_LOG_VERBOSE("Incoming {}->{}({}) for <handler>",
+                              this->config.printable_identifier(this->module_id, impl_id), cmd_name,
+                              fmt::join(arg_names, ","));
 
         // check data and ignore it if not matching (publishing it should have
         // been prohibited already)
-        if (this->validate_data_with_schema) {
+        if (this->validate_data_with_schema and sample_validation(*arg_sampler)) {
             try {
-                for (const auto& arg_name : arg_names) {
-                    if (!data.at("args").contains(arg_name)) {
-                        EVLOG_AND_THROW(std::invalid_argument(
-                            fmt::format("Missing argument {} for {}!", arg_name,
-                                        this->config.printable_identifier(this->module_id, impl_id))));
+                record_validation(*arg_cost, [&]() {
+                    for (const auto& arg_name : arg_names) {
+                        if (!data.at("args").contains(arg_name)) {
+                            EVLOG_AND_THROW(std::invalid_argument(
+                                fmt::format("Missing argument {} for {}!", arg_name,
+                                            this->config.printable_identifier(this->module_id, impl_id))));
+                        }
+                        arg_validators.at(arg_name)->validate(data.at("args").at(arg_name));
                     }
-                    json_validator validator(
-                        [this](const json_uri& uri, json& schema) { this->config.ref_loader(uri, schema); },
-                        Config::format_checker);
-                    validator.set_root_schema(cmd_definition.at("arguments").at(arg_name));
-                    validator.validate(data.at("args").at(arg_name));
-                }
+                });
             } catch (const std::exception& e) {
+                this->validation_counters.violations++;
                 EVLOG_warning << fmt::format("Ignoring incoming cmd '{}' because not matching manifest schema: {}",
                                              cmd_name, e.what());
-                return;
+                return false;
             }
         }
 
-        // publish results
-        json res_data = json({});
-        res_data["id"] = data.at("id");
-
-        // call real cmd handler
-        res_data["retval"] = handler(data.at("args"));
+        // results are sent to the reply topic of the caller, callers not sending one wait for them on the cmd topic
+        const auto reply_topic = data.value("reply_to", cmd_topic);
+        if (reply_topic != cmd_topic and not is_cmd_reply_topic(reply_topic, this->mqtt_everest_prefix)) {
+            EVLOG_warning << fmt::format("Ignoring incoming cmd '{}' because its results should be sent to '{}', "
+                                         "which is not the result topic of a module",
+                                         cmd_name, reply_topic);
+            return false;
+        }
 
-        // check retval agains manifest
-        if (this->validate_data_with_schema) {
-            try {
-                // only use validator on non-null return types
-                if (!(res_data.at("retval").is_null() &&
-                      (!cmd_definition.contains("result") || cmd_definition.at("result").is_null()))) {
-                    json_validator validator(
-                        [this](const json_uri& uri, json& schema) { this->config.ref_loader(uri, schema); },
-                        Config::format_checker);
-                    validator.set_root_schema(cmd_definition.at("result"));
-                    validator.validate(res_data.at("retval"));
+        if (deferred) {
+            // the responder is called later from any thread, so it owns copies of everything it needs. The call ends
+            // once it has been responded to, or when the last copy of the responder is gone without a response
+            const auto key = context_key(data);
+            const auto responded = std::shared_ptr<std::atomic<bool>>(new std::atomic<bool>(false),
+                                                                      [this, key](std::atomic<bool>* flag) {
+                                                                          if (not flag->load()) {
+                                                                              this->end_cmd_call(key);
+                                                                          }
+                                                                          delete flag;
+                                                                      });
+            const CmdChunkWriter respond = [this, cmd_name, qos, validate_result, key, responded, reply_topic,
+                                            id = data.at("id"), context = current_cmd_call](json retval) {
+                if (responded->exchange(true)) {
+                    EVLOG_warning << fmt::format("Ignoring another response to call {} of cmd '{}'", key, cmd_name);
+                    return false;
                 }
+                this->end_cmd_call(key);
+                if (not(*validate_result)(retval)) {
+                    return true;
+                }
+                if (context != nullptr and context->is_abandoned()) {
+                    FRAMEWORK_LOG_DEBUG("Not publishing the response to call {} of cmd '{}', its caller stopped "
+                                        "waiting for it",
+                                        key, cmd_name);
+                    return false;
+                }
+                const json res_data = {{"id", id}, {"retval", std::move(retval)}, {"origin", this->module_id}};
+                this->mqtt_abstraction->publish(
+                    reply_topic, json::object({{"name", cmd_name}, {"type", "result"}, {"data", res_data}}), qos);
+                return true;
+            };
+            handler(data.at("args"), respond);
+            return true;
+        }
 
-            } catch (const std::exception& e) {
-                EVLOG_warning << fmt::format("Ignoring return value of cmd '{}' because the validation of the result "
-                                             "failed: {}\ndefinition: {}\ndata: {}",
-                                             cmd_name, e.what(), cmd_definition, res_data);
-                return;
+        // publishes a result message, streams are terminated by a final message without a retval
+        std::uint64_t seq = 0;
+        const auto publish_result = [&](json retval, bool done) {
+            json res_data = json({});
+            res_data["id"] = data.at("id");
+            res_data["retval"] = std::move(retval);
+            if (streaming) {
+                res_data["seq"] = seq++;
+                res_data["done"] = done;
             }
-        }
+            res_data["origin"] = this->module_id;
 
-        EVLOG_verbose << fmt::format("RETVAL: {}", res_data["retval"].dump());
-        res_data["origin"] = this->module_id;
+            const json res_publish_data = json::object({{"name", cmd_name}, {"type", "result"}, {"data", res_data}});
 
-        const json res_publish_data = json::object({{"name", cmd_name}, {"type", "result"}, {"data", res_data}});
+            this->mqtt_abstraction->publish(reply_topic, res_publish_data, qos);
+        };
+
+        const CmdChunkWriter write = [&](json retval) {
+            // check retval agains manifest
+            if (not(*validate_result)(retval)) {
+                return true;
+            }
+
+            if (current_cmd_call != nullptr and current_cmd_call->is_abandoned()) {
+                FRAMEWORK_LOG_DEBUG("Not publishing result of {}->{}(), its caller stopped waiting for it",
+                                    this->config.printable_identifier(this->module_id, impl_id), cmd_name);
+                return false;
+            }
+            // the caller acknowledges the chunks it consumed, so chunks never pile up faster than it consumes them
+            if (streaming and current_cmd_call != nullptr and
+                not current_cmd_call->wait_for_window(seq, this->remote_cmd_res_timeout)) {
+                FRAMEWORK_LOG_DEBUG("Not publishing chunk {} of {}->{}(), its caller stopped consuming the result",
+                                    seq, this->config.printable_identifier(this->module_id, impl_id), cmd_name);
+                return false;
+            }
+
+            FRAMEWORK_LOG_VERBOSE("RETVAL: {}", retval.dump());
+            publish_result(std::move(retval), false);
+            return true;
+        };
+
+        // call real cmd handler
+        handler(data.at("args"), write);
+
+        if (streaming and not(current_cmd_call != nullptr and current_cmd_call->is_abandoned())) {
+            publish_result(nullptr, true);
+        }
+        return false;
+    };
 
-        this->mqtt_abstraction->publish(cmd_topic, res_publish_data);
+    // makes the deadline and cancellation of the call available to the handler and forgets the call afterwards
+    const auto handle_call = [this, wrapper](const std::string& topic, json data,
+                                             const std::shared_ptr<CmdCallContext>& context) {
+        const auto call_id = context_key(data);
+        current_cmd_call = context;
+        const auto pending = wrapper(topic, std::move(data));
+        current_cmd_call = nullptr;
+        if (not pending) {
+            end_cmd_call(call_id);
+        }
     };
 
-    const auto typed_handler =
-        std::make_shared<TypedHandler>(cmd_name, HandlerType::Call, std::make_shared<Handler>(wrapper));
+    std::shared_ptr<ConcurrencyLimiter> limiter = get_cmd_limiter(impl_id);
+    std::string key;
+    if (limiter != nullptr) {
+        // results are correlated by call id, so calls can finish in any order
+        const auto& impl_manifest = this->module_manifest.at("provides").at(impl_id);
+        const auto serialized_cmds = impl_manifest.value("serialized_cmds", json::array());
+        const auto serialized = std::find(serialized_cmds.begin(), serialized_cmds.end(), cmd_name) !=
+                                serialized_cmds.end();
+        key = serialized ? cmd_name : std::string{};
+    }
+
+    const auto typed_handler = std::make_shared<TypedHandler>(
+        cmd_name, HandlerType::Call,
+        std::make_shared<Handler>([this, limiter, key, handle_call](const std::string& topic, json data) {
+            auto context = begin_cmd_call(data);
+            if (limiter == nullptr) {
+                handle_call(topic, std::move(data), context);
+                return;
+            }
+            // the trace of the call continues on the thread handling it
+            limiter->post(key, [handle_call, topic, data = std::move(data), context,
+                                trace = tracing::current()]() mutable {
+                const tracing::ScopedContext trace_context(trace);
+                handle_call(topic, std::move(data), context);
+            });
+        }));
     this->mqtt_abstraction->register_handler(cmd_topic, typed_handler, QOS::QOS2);
 
+    // cancellations and acknowledgements of chunks reach running calls, which block the strand of the cmd topic
+    const auto control_handler = std::make_shared<TypedHandler>(
+        cmd_name, HandlerType::Call, std::make_shared<Handler>([this](const std::string&, json data) {
+            const auto consumed = data.find("ack");
+            if (consumed != data.end() and consumed->is_number_unsigned()) {
+                acknowledge_active_cmd_call(context_key(data), consumed->get<std::uint64_t>());
+            } else if (data.contains("cancel")) {
+                cancel_active_cmd_call(context_key(data));
+            }
+        }));
+    this->mqtt_abstraction->register_handler(get_cmd_control_topic(cmd_topic), control_handler, QOS::QOS2);
+
     // this list of registered cmds will be used later on to check if all cmds
     // defined in manifest are provided by code
     this->registered_cmds[impl_id].insert(cmd_name);
 }
 
+std::shared_ptr<ConcurrencyLimiter> Everest::get_cmd_limiter(const std::string& impl_id) {
+    const auto limiter = this->cmd_limiters.find(impl_id);
+    if (limiter != this->cmd_limiters.end()) {
+        return limiter->second;
+    }
+
+    const auto& impl_manifest = this->module_manifest.at("provides").at(impl_id);
+    const auto cmd_concurrency = impl_manifest.value("cmd_concurrency", std::size_t{1});
+    std::shared_ptr<ConcurrencyLimiter> new_limiter;
+    if (cmd_concurrency > 1) {
+        new_limiter = std::make_shared<ConcurrencyLimiter>(this->mqtt_abstraction->get_handler_executor(),
+                                                           cmd_concurrency);
+    }
+    this->cmd_limiters.emplace(impl_id, new_limiter);
+    return new_limiter;
+}
+
 void Everest::provide_cmd(const cmd& cmd) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
     const auto impl_id = cmd.impl_id;
     const auto cmd_name = cmd.cmd_name;
@@ -923,7 +2194,7 @@ void Everest::provide_cmd(const cmd& cmd) {
     const auto return_type = cmd.return_type;
 
     // extract manifest definition of this command
-    json cmd_definition = get_cmd_definition(this->module_id, impl_id, cmd_name, false);
+    const auto& cmd_definition = get_cmd_definition(this->module_id, impl_id, cmd_name, false);
 
     std::set<std::string> arg_names;
     for (const auto& arg_type : arg_types) {
@@ -979,9 +2250,9 @@ void Everest::provide_cmd(const cmd& cmd) {
     });
 }
 
-json Everest::get_cmd_definition(const std::string& module_id, const std::string& impl_id, const std::string& cmd_name,
-                                 bool is_call) {
-    BOOST_LOG_FUNCTION();
+const json& Everest::get_cmd_definition(const std::string& module_id, const std::string& impl_id,
+                                        const std::string& cmd_name, bool is_call) {
+    FRAMEWORK_LOG_FUNCTION();
 
     const auto& module_name = this->config.get_module_name(module_id);
     const auto& cmds = this->config.get_module_cmds(module_name, impl_id);
@@ -1014,20 +2285,20 @@ json Everest::get_cmd_definition(const std::string& module_id, const std::string
     return cmds.at(cmd_name);
 }
 
-json Everest::get_cmd_definition(const std::string& module_id, const std::string& impl_id,
-                                 const std::string& cmd_name) {
-    BOOST_LOG_FUNCTION();
+const json& Everest::get_cmd_definition(const std::string& module_id, const std::string& impl_id,
+                                        const std::string& cmd_name) {
+    FRAMEWORK_LOG_FUNCTION();
 
     return get_cmd_definition(module_id, impl_id, cmd_name, false);
 }
 
 bool Everest::is_telemetry_enabled() {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
     return (this->telemetry_enabled && this->telemetry_config.has_value());
 }
 
 std::string Everest::check_args(const Arguments& func_args, json manifest_args) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
     for (const auto& func_arg : func_args) {
         const auto arg_name = func_arg.first;
@@ -1042,7 +2313,7 @@ std::string Everest::check_args(const Arguments& func_args, json manifest_args)
 }
 
 bool Everest::check_arg(ArgumentType arg_types, json manifest_arg) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
     // FIXME (aw): the error messages here need to be taken into the
     //             correct context!
@@ -1078,7 +2349,7 @@ bool Everest::check_arg(ArgumentType arg_types, json manifest_arg) {
 
 void Everest::check_external_mqtt() {
     // check if external mqtt is enabled
-    if (!module_manifest.contains("enable_external_mqtt") && !module_manifest["enable_external_mqtt"]) {
+    if (!module_manifest.contains("enable_external_mqtt")) {
         EVLOG_AND_THROW(EverestApiError(fmt::format("Module {} tries to provide an external MQTT handler, but didn't "
                                                     "set 'enable_external_mqtt' to 'true' in its manifest",
                                                     config.printable_identifier(module_id))));
@@ -1090,11 +2361,10 @@ std::string Everest::check_external_mqtt(const std::string& topic) {
     return fmt::format("{}{}", mqtt_external_prefix, topic);
 }
 
-UnsubscribeToken Everest::create_external_handler(const std::string& topic, const std::string& external_topic,
-                                                  const StringPairHandler& handler) {
-    const auto token = std::make_shared<TypedHandler>(HandlerType::ExternalMQTT, std::make_shared<Handler>(handler));
+UnsubscribeToken Everest::create_external_handler(const std::string& external_topic, const RawHandler& handler) {
+    const auto token = std::make_shared<TypedHandler>(HandlerType::ExternalMQTT, std::make_shared<RawHandler>(handler));
     mqtt_abstraction->register_handler(external_topic, token, QOS::QOS0);
-    return [this, topic, token]() { this->mqtt_abstraction->unregister_handler(topic, token); };
+    return [this, external_topic, token]() { this->mqtt_abstraction->unregister_handler(external_topic, token); };
 }
 
 std::optional<Mapping> get_impl_mapping(std::optional<ModuleTierMappings> module_tier_mappings,
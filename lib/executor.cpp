@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+
+#include <everest/logging.hpp>
+
+#include <utils/executor.hpp>
+
+namespace Everest {
+
+// queued tasks waiting longer than this while no task completes are considered starved by blocked workers
+constexpr auto STARVATION_INTERVAL = std::chrono::milliseconds(50);
+constexpr auto TEMPORARY_WORKER_IDLE_TIMEOUT = std::chrono::seconds(10);
+
+Executor::Executor(std::size_t core_threads, std::size_t max_threads) :
+    max_threads(std::max(core_threads, max_threads)) {
+    const std::lock_guard<std::mutex> lock(this->mutex);
+    for (std::size_t i = 0; i < std::max(core_threads, std::size_t{1}); i++) {
+        this->workers.emplace_back([this]() { run_worker(false); });
+    }
+    this->monitor = std::thread([this]() { run_monitor(); });
+}
+
+Executor::~Executor() {
+    {
+        const std::lock_guard<std::mutex> lock(this->mutex);
+        this->running = false;
+    }
+    this->tasks_available.notify_all();
+    this->monitor_wakeup.notify_all();
+    this->monitor.join();
+
+    // no workers are spawned or removed anymore after the monitor finished
+    for (auto& worker : this->workers) {
+        worker.join();
+    }
+}
+
+void Executor::post(Task task) {
+    {
+        const std::lock_guard<std::mutex> lock(this->mutex);
+        this->tasks.push_back(std::move(task));
+    }
+    this->tasks_available.notify_one();
+}
+
+std::size_t Executor::get_thread_count() {
+    const std::lock_guard<std::mutex> lock(this->mutex);
+    return this->workers.size() - this->finished_workers.size();
+}
+
+std::size_t Executor::default_thread_count() {
+    return std::max(std::thread::hardware_concurrency(), 2U);
+}
+
+void Executor::run_worker(bool temporary) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    while (true) {
+        this->idle_workers++;
+        const auto has_work = [this]() { return not this->tasks.empty() or not this->running; };
+        bool woken = true;
+        if (temporary) {
+            woken = this->tasks_available.wait_for(lock, TEMPORARY_WORKER_IDLE_TIMEOUT, has_work);
+        } else {
+            this->tasks_available.wait(lock, has_work);
+        }
+        this->idle_workers--;
+
+        if (not this->running or not woken) {
+            break;
+        }
+
+        auto task = std::move(this->tasks.front());
+        this->tasks.pop_front();
+        lock.unlock();
+
+        try {
+            task();
+        } catch (const std::exception& e) {
+            EVLOG_error << "Uncaught exception in executor task: " << e.what();
+        }
+
+        lock.lock();
+        this->completed_tasks++;
+    }
+
+    if (temporary and this->running) {
+        // joined by the monitor, since a thread cannot join itself
+        this->finished_workers.push_back(std::this_thread::get_id());
+        this->monitor_wakeup.notify_one();
+    }
+}
+
+void Executor::run_monitor() {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    auto last_completed_tasks = this->completed_tasks;
+    while (this->running) {
+        this->monitor_wakeup.wait_for(lock, STARVATION_INTERVAL);
+        cleanup_finished_workers();
+
+        const auto starved = not this->tasks.empty() and this->idle_workers == 0 and
+                             this->completed_tasks == last_completed_tasks;
+        last_completed_tasks = this->completed_tasks;
+        if (starved and this->running and this->workers.size() < this->max_threads) {
+            EVLOG_debug << "All executor workers are blocked, spawning an additional worker";
+            this->workers.emplace_back([this]() { run_worker(true); });
+        }
+    }
+}
+
+void Executor::cleanup_finished_workers() {
+    for (const auto& id : this->finished_workers) {
+        const auto worker = std::find_if(this->workers.begin(), this->workers.end(),
+                                         [&id](const std::thread& thread) { return thread.get_id() == id; });
+        if (worker != this->workers.end()) {
+            // the worker already released the lock for good, so joining does not block for long
+            worker->join();
+            this->workers.erase(worker);
+        }
+    }
+    this->finished_workers.clear();
+}
+
+ConcurrencyLimiter::ConcurrencyLimiter(Executor& executor, std::size_t max_concurrent_tasks) :
+    executor(executor), max_concurrent_tasks(std::max(max_concurrent_tasks, std::size_t{1})) {
+}
+
+void ConcurrencyLimiter::post(const std::string& key, Executor::Task task) {
+    const std::lock_guard<std::mutex> lock(this->mutex);
+    this->pending_tasks.emplace_back(key, std::move(task));
+    start_pending_tasks();
+}
+
+std::size_t ConcurrencyLimiter::get_pending_count() {
+    const std::lock_guard<std::mutex> lock(this->mutex);
+    return this->pending_tasks.size();
+}
+
+void ConcurrencyLimiter::start_pending_tasks() {
+    auto it = this->pending_tasks.begin();
+    while (this->running_tasks < this->max_concurrent_tasks and it != this->pending_tasks.end()) {
+        // tasks whose key is still running stay queued, later tasks with other keys may overtake them
+        if (not it->first.empty() and this->running_keys.count(it->first) != 0) {
+            ++it;
+            continue;
+        }
+        auto key = std::move(it->first);
+        auto task = std::move(it->second);
+        it = this->pending_tasks.erase(it);
+        if (not key.empty()) {
+            this->running_keys.insert(key);
+        }
+        this->running_tasks++;
+        // the task keeps this limiter alive until it has finished
+        this->executor.post([self = shared_from_this(), key = std::move(key), task = std::move(task)]() {
+            try {
+                task();
+            } catch (const std::exception& e) {
+                // tasks are handlers that used to run on their handler thread, where exceptions terminate the module
+                EVLOG_critical << "Caught exception in concurrently running handler: " << e.what();
+                exit(1);
+            }
+            self->finish_task(key);
+        });
+    }
+}
+
+void ConcurrencyLimiter::finish_task(const std::string& key) {
+    const std::lock_guard<std::mutex> lock(this->mutex);
+    this->running_tasks--;
+    if (not key.empty()) {
+        this->running_keys.erase(key);
+    }
+    start_pending_tasks();
+}
+
+} // namespace Everest
@@ -0,0 +1,308 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <utils/flight_recorder.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+#include <limits>
+#include <mutex>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <boost/log/attributes/value_extraction.hpp>
+#include <boost/log/core.hpp>
+#include <boost/log/sinks/basic_sink_backend.hpp>
+#include <boost/log/sinks/unlocked_frontend.hpp>
+#include <boost/smart_ptr/make_shared_object.hpp>
+#include <fmt/format.h>
+
+#include <everest/exceptions.hpp>
+#include <everest/logging.hpp>
+
+#include <utils/message_queue.hpp>
+
+namespace Everest {
+
+namespace {
+constexpr char dump_magic[8] = "EVFLREC";
+constexpr std::size_t default_records = 4096;
+/// dumps claiming more slots are considered corrupt
+constexpr std::uint64_t max_decoded_capacity = std::uint64_t{1} << 24;
+
+constexpr int fatal_signals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+constexpr int dump_signal = SIGUSR2;
+struct sigaction previous_actions[NSIG];
+
+/// \brief copies \p source into \p destination including the terminating 0, without calling into the C library
+void copy_string(char* destination, std::size_t capacity, const char* source) noexcept {
+    std::size_t i = 0;
+    for (; i + 1 < capacity and source[i] != '\0'; ++i) {
+        destination[i] = source[i];
+    }
+    destination[i] = '\0';
+}
+
+bool write_all(int fd, const void* data, std::size_t size) noexcept {
+    const auto* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        const auto written = ::write(fd, bytes, size);
+        if (written < 0 and errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+const char* fatal_signal_reason(int signal) noexcept {
+    switch (signal) {
+    case SIGSEGV:
+        return "SIGSEGV";
+    case SIGBUS:
+        return "SIGBUS";
+    case SIGFPE:
+        return "SIGFPE";
+    case SIGILL:
+        return "SIGILL";
+    case SIGABRT:
+        return "SIGABRT";
+    default:
+        return "signal";
+    }
+}
+
+void handle_fatal_signal(int signal) {
+    const auto saved_errno = errno;
+    FlightRecorder::get().dump(fatal_signal_reason(signal));
+    // let the previous disposition, usually the default one, terminate the process once this handler returns
+    sigaction(signal, &previous_actions[signal], nullptr);
+    raise(signal);
+    errno = saved_errno;
+}
+
+void handle_dump_signal(int /*signal*/) {
+    const auto saved_errno = errno;
+    FlightRecorder::get().dump("SIGUSR2");
+    errno = saved_errno;
+}
+
+void install_signal_handler(int signal, void (*handler)(int)) {
+    struct sigaction action {};
+    action.sa_handler = handler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(signal, &action, &previous_actions[signal]);
+}
+
+///
+/// \brief Sink backend dumping the flight recorder whenever a critical message is logged
+///
+class CriticalLogBackend : public boost::log::sinks::basic_sink_backend<boost::log::sinks::concurrent_feeding> {
+public:
+    void consume(const boost::log::record_view& record) {
+        const auto severity = boost::log::extract<Logging::severity_level>("Severity", record);
+        if (severity and severity.get() >= Logging::critical) {
+            FlightRecorder::get().dump("critical log");
+        }
+    }
+};
+} // namespace
+
+std::string flight_event_to_string(FlightEvent event) {
+    switch (event) {
+    case FlightEvent::Dispatch:
+        return "dispatch";
+    case FlightEvent::Publish:
+        return "publish";
+    case FlightEvent::CmdResult:
+        return "cmd_result";
+    case FlightEvent::CmdTimeout:
+        return "cmd_timeout";
+    }
+    return "unknown";
+}
+
+FlightRecorderSettings FlightRecorderSettings::parse(const nlohmann::json& module_config,
+                                                     const std::string& module_id) {
+    FlightRecorderSettings settings;
+    const auto flight_recorder = module_config.find("flight_recorder");
+    if (flight_recorder == module_config.end()) {
+        return settings;
+    }
+    settings.records = flight_recorder->value("records", default_records);
+    settings.file = flight_recorder->value("file", fmt::format("/tmp/everest_flight_recorder_{}.bin", module_id));
+    return settings;
+}
+
+FlightRecorder& FlightRecorder::get() {
+    // never destroyed, so events of threads outliving static destruction and late crashes can still be recorded
+    static auto* recorder = new FlightRecorder();
+    return *recorder;
+}
+
+void FlightRecorder::configure(const FlightRecorderSettings& settings, const std::string& module_id) {
+    static std::mutex configure_mutex;
+    const std::lock_guard<std::mutex> lock(configure_mutex);
+    if (this->is_enabled() or settings.records == 0) {
+        return;
+    }
+    if (settings.file.size() >= sizeof(this->file)) {
+        throw EverestInternalError(fmt::format("Flight recorder file name {} is too long", settings.file));
+    }
+    copy_string(this->file, sizeof(this->file), settings.file.c_str());
+    std::memcpy(this->header.magic, dump_magic, sizeof(dump_magic));
+    this->header.version = FlightRecorderDumpHeader::current_version;
+    this->header.slot_size = sizeof(FlightRecorderSlot);
+    this->header.capacity = settings.records;
+    this->header.pid = static_cast<std::int32_t>(getpid());
+    copy_string(this->header.module_id, sizeof(this->header.module_id), module_id.c_str());
+
+    this->capacity = settings.records;
+    // value initialized, so slots that were never written have sequence 0
+    this->slots.store(new FlightRecorderSlot[settings.records](), std::memory_order_release);
+
+    for (const auto signal : fatal_signals) {
+        install_signal_handler(signal, handle_fatal_signal);
+    }
+    install_signal_handler(dump_signal, handle_dump_signal);
+    // the backend is thread-safe, so it is fed without serializing the logging threads
+    boost::log::core::get()->add_sink(boost::make_shared<boost::log::sinks::unlocked_sink<CriticalLogBackend>>());
+
+    EVLOG_debug << fmt::format("Recording the last {} framework events, dumped to {} on crashes and SIGUSR2",
+                               settings.records, settings.file);
+}
+
+void FlightRecorder::record(FlightEvent event, HandlerType handler_type, std::string_view topic,
+                            std::string_view call_id, std::chrono::nanoseconds duration) {
+    auto* ring = this->slots.load(std::memory_order_acquire);
+    if (ring == nullptr) {
+        return;
+    }
+    const auto sequence = this->next_sequence.fetch_add(1, std::memory_order_relaxed);
+    auto& slot = ring[sequence % this->capacity];
+    // marks the slot as being written, so a dump in between can tell the record is torn
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    auto& record = slot.record;
+    record.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::system_clock::now().time_since_epoch())
+                              .count();
+    constexpr auto max_duration_us = static_cast<std::int64_t>(std::numeric_limits<std::uint32_t>::max());
+    record.duration_us = static_cast<std::uint32_t>(
+        std::min(std::chrono::duration_cast<std::chrono::microseconds>(duration).count(), max_duration_us));
+    record.event = event;
+    record.handler_type = static_cast<std::uint8_t>(handler_type);
+    if (topic.size() > FlightRecord::topic_capacity) {
+        topic.remove_prefix(topic.size() - FlightRecord::topic_capacity);
+    }
+    record.topic_size = static_cast<std::uint8_t>(topic.size());
+    std::memcpy(record.topic, topic.data(), topic.size());
+    call_id = call_id.substr(0, FlightRecord::call_id_capacity);
+    record.call_id_size = static_cast<std::uint8_t>(call_id.size());
+    std::memcpy(record.call_id, call_id.data(), call_id.size());
+
+    slot.sequence.store(sequence + 1, std::memory_order_release);
+}
+
+bool FlightRecorder::dump(const char* reason) noexcept {
+    auto* ring = this->slots.load(std::memory_order_acquire);
+    // a crash while dumping must not dump again
+    if (ring == nullptr or this->dumping.test_and_set()) {
+        return false;
+    }
+    timespec now{};
+    clock_gettime(CLOCK_REALTIME, &now);
+    this->header.dump_timestamp_ns = static_cast<std::int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+    this->header.next_sequence = this->next_sequence.load(std::memory_order_acquire);
+    copy_string(this->header.reason, sizeof(this->header.reason), reason);
+
+    bool written = false;
+    const int fd = ::open(this->file, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd >= 0) {
+        written = write_all(fd, &this->header, sizeof(this->header)) and
+                  write_all(fd, ring, this->capacity * sizeof(FlightRecorderSlot));
+        written = ::close(fd) == 0 and written;
+    }
+    this->dumping.clear();
+    return written;
+}
+
+FlightRecording decode_flight_recording(std::istream& stream) {
+    FlightRecorderDumpHeader header{};
+    if (not stream.read(reinterpret_cast<char*>(&header), sizeof(header)) or
+        std::memcmp(header.magic, dump_magic, sizeof(dump_magic)) != 0) {
+        throw EverestInternalError("Not a flight recorder dump");
+    }
+    if (header.version != FlightRecorderDumpHeader::current_version or
+        header.slot_size != sizeof(FlightRecorderSlot)) {
+        throw EverestInternalError(fmt::format("Unsupported flight recorder dump version {} with slot size {}",
+                                               header.version, header.slot_size));
+    }
+    if (header.capacity == 0 or header.capacity > max_decoded_capacity) {
+        throw EverestInternalError(fmt::format("Invalid flight recorder dump capacity {}", header.capacity));
+    }
+
+    FlightRecording recording;
+    header.module_id[sizeof(header.module_id) - 1] = '\0';
+    header.reason[sizeof(header.reason) - 1] = '\0';
+    recording.module_id = header.module_id;
+    recording.reason = header.reason;
+    recording.pid = header.pid;
+    recording.dump_timestamp_ns = header.dump_timestamp_ns;
+    recording.lost_records = header.next_sequence > header.capacity ? header.next_sequence - header.capacity : 0;
+
+    std::vector<std::pair<std::uint64_t, FlightRecord>> records;
+    char slot[sizeof(FlightRecorderSlot)];
+    for (std::uint64_t index = 0; index < header.capacity; ++index) {
+        if (not stream.read(slot, sizeof(slot))) {
+            throw EverestInternalError(fmt::format("Flight recorder dump is truncated after {} slots", index));
+        }
+        std::uint64_t sequence = 0;
+        std::memcpy(&sequence, slot + offsetof(FlightRecorderSlot, sequence), sizeof(sequence));
+        // never written, being written or overwritten while dumping
+        if (sequence == 0 or (sequence - 1) % header.capacity != index or sequence > header.next_sequence) {
+            continue;
+        }
+        FlightRecord record{};
+        std::memcpy(&record, slot + offsetof(FlightRecorderSlot, record), sizeof(record));
+        record.topic_size = std::min<std::uint8_t>(record.topic_size, FlightRecord::topic_capacity);
+        record.call_id_size = std::min<std::uint8_t>(record.call_id_size, FlightRecord::call_id_capacity);
+        records.emplace_back(sequence, record);
+    }
+    std::sort(records.begin(), records.end(),
+              [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+    recording.records.reserve(records.size());
+    for (const auto& [sequence, record] : records) {
+        recording.records.push_back(record);
+    }
+    return recording;
+}
+
+nlohmann::json to_json(const FlightRecord& record) {
+    nlohmann::json result = {{"timestamp_ns", record.timestamp_ns},
+                             {"event", flight_event_to_string(record.event)},
+                             {"topic", std::string(record.topic, record.topic_size)}};
+    if (record.event == FlightEvent::Dispatch) {
+        const auto handler_type = std::min<std::size_t>(record.handler_type, HANDLER_TYPE_COUNT - 1);
+        result["handler_type"] = handler_type_to_string(static_cast<HandlerType>(handler_type));
+    }
+    if (record.call_id_size > 0) {
+        result["call_id"] = std::string(record.call_id, record.call_id_size);
+    }
+    if (record.event != FlightEvent::Publish) {
+        result["duration_us"] = record.duration_us;
+    }
+    return result;
+}
+
+} // namespace Everest
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <condition_variable>
+#include <memory>
+
+#include <utils/in_flight_limit.hpp>
+
+namespace Everest {
+
+InFlightLimit::InFlightLimit(std::size_t max_in_flight, InFlightOverflow overflow) :
+    max_in_flight(max_in_flight), overflow(overflow) {
+    this->stats.max_in_flight = max_in_flight;
+}
+
+bool InFlightLimit::admit(Start start) {
+    {
+        const std::lock_guard<std::mutex> lock(this->mutex);
+        if (this->stats.in_flight >= this->max_in_flight) {
+            if (this->overflow == InFlightOverflow::Reject) {
+                this->stats.rejected++;
+                return false;
+            }
+            this->queue.push_back(std::move(start));
+            this->stats.queued = this->queue.size();
+            return true;
+        }
+        this->stats.in_flight++;
+        this->stats.admitted++;
+    }
+
+    if (not start()) {
+        release();
+    }
+    return true;
+}
+
+bool InFlightLimit::acquire_until(std::chrono::steady_clock::time_point deadline) {
+    struct Waiter {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool acquired{false};
+        bool given_up{false};
+    };
+    const auto waiter = std::make_shared<Waiter>();
+
+    {
+        const std::lock_guard<std::mutex> lock(this->mutex);
+        if (this->stats.in_flight < this->max_in_flight) {
+            this->stats.in_flight++;
+            this->stats.admitted++;
+            return true;
+        }
+        if (this->overflow == InFlightOverflow::Reject) {
+            this->stats.rejected++;
+            return false;
+        }
+        this->queue.push_back([waiter]() {
+            const std::lock_guard<std::mutex> lock(waiter->mutex);
+            if (waiter->given_up) {
+                return false;
+            }
+            waiter->acquired = true;
+            waiter->cv.notify_one();
+            return true;
+        });
+        this->stats.queued = this->queue.size();
+    }
+
+    std::unique_lock<std::mutex> lock(waiter->mutex);
+    if (not waiter->cv.wait_until(lock, deadline, [&waiter]() { return waiter->acquired; })) {
+        waiter->given_up = true;
+        return false;
+    }
+    return true;
+}
+
+void InFlightLimit::release() {
+    while (true) {
+        Start next;
+        {
+            const std::lock_guard<std::mutex> lock(this->mutex);
+            if (this->queue.empty()) {
+                this->stats.in_flight--;
+                return;
+            }
+            next = std::move(this->queue.front());
+            this->queue.pop_front();
+            this->stats.queued = this->queue.size();
+        }
+
+        // the slot is handed over, so in_flight stays the same
+        const auto started = next();
+        const std::lock_guard<std::mutex> lock(this->mutex);
+        if (started) {
+            this->stats.admitted++;
+            return;
+        }
+        this->stats.expired++;
+    }
+}
+
+InFlightStats InFlightLimit::get_stats() {
+    const std::lock_guard<std::mutex> lock(this->mutex);
+    return this->stats;
+}
+
+void to_json(nlohmann::json& j, const InFlightStats& stats) {
+    j = {{"max_in_flight", stats.max_in_flight}, {"in_flight", stats.in_flight}, {"queued", stats.queued},
+         {"admitted", stats.admitted},           {"rejected", stats.rejected},   {"expired", stats.expired}};
+}
+
+} // namespace Everest
@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+
+#include <utils/latency_histogram.hpp>
+
+namespace Everest {
+
+std::size_t LatencyHistogram::bucket_index(std::uint64_t value) {
+    if (value < sub_bucket_count) {
+        return static_cast<std::size_t>(value);
+    }
+    const auto msb = static_cast<std::size_t>(63 - __builtin_clzll(value));
+    if (msb >= max_value_bits) {
+        return bucket_count - 1;
+    }
+    const auto shift = msb - sub_bucket_bits;
+    return (shift + 1) * sub_bucket_count + static_cast<std::size_t>((value >> shift) & (sub_bucket_count - 1));
+}
+
+std::uint64_t LatencyHistogram::bucket_upper_bound(std::size_t index) {
+    if (index < sub_bucket_count) {
+        return index;
+    }
+    const auto shift = index / sub_bucket_count - 1;
+    const auto sub_bucket = index % sub_bucket_count;
+    return ((sub_bucket_count + sub_bucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds duration) {
+    const auto value = static_cast<std::uint64_t>(std::max(duration.count(), std::chrono::nanoseconds::rep{0}));
+    this->buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    this->count.fetch_add(1, std::memory_order_relaxed);
+    this->sum.fetch_add(value, std::memory_order_relaxed);
+
+    auto current_max = this->max.load(std::memory_order_relaxed);
+    while (value > current_max and
+           not this->max.compare_exchange_weak(current_max, value, std::memory_order_relaxed)) {
+    }
+}
+
+LatencySummary LatencyHistogram::get_summary() const {
+    // the buckets are read one after another while other threads may still record, so the summary is only
+    // approximately consistent, which is fine for monitoring
+    std::array<std::uint64_t, bucket_count> counts{};
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < bucket_count; i++) {
+        counts[i] = this->buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    LatencySummary summary;
+    summary.count = total;
+    summary.max = std::chrono::nanoseconds(this->max.load(std::memory_order_relaxed));
+    if (total == 0) {
+        return summary;
+    }
+    summary.mean = std::chrono::nanoseconds(this->sum.load(std::memory_order_relaxed) / total);
+
+    const auto percentile = [&counts, total, &summary](double fraction) {
+        const auto rank = static_cast<std::uint64_t>(fraction * static_cast<double>(total - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < bucket_count; i++) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return std::min(std::chrono::nanoseconds(bucket_upper_bound(i)), summary.max);
+            }
+        }
+        return summary.max;
+    };
+    summary.p50 = percentile(0.5);
+    summary.p90 = percentile(0.9);
+    summary.p99 = percentile(0.99);
+    summary.p999 = percentile(0.999);
+    return summary;
+}
+
+void to_json(nlohmann::json& j, const LatencySummary& summary) {
+    const auto us = [](std::chrono::nanoseconds duration) { return duration.count() / 1000.0; };
+    j = {{"count", summary.count},    {"mean_us", us(summary.mean)}, {"p50_us", us(summary.p50)},
+         {"p90_us", us(summary.p90)}, {"p99_us", us(summary.p99)},   {"p999_us", us(summary.p999)},
+         {"max_us", us(summary.max)}};
+}
+
+} // namespace Everest
@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <utils/memory_accounting.hpp>
+
+namespace Everest {
+
+namespace {
+/// \brief the header of a std::map node: color, parent, left and right
+constexpr std::size_t MAP_NODE_HEADER_SIZE = 4 * sizeof(void*);
+
+/// \returns the bytes allocated for the characters of \p string, 0 if it fits into the small string buffer
+std::size_t string_heap_bytes(const std::string& string) {
+    return string.capacity() > std::string().capacity() ? string.capacity() + 1 : 0;
+}
+
+/// \returns the bytes allocated by \p value, without the node itself
+std::size_t json_heap_bytes(const nlohmann::json& value) {
+    switch (value.type()) {
+    case nlohmann::json::value_t::string: {
+        const auto& string = value.get_ref<const nlohmann::json::string_t&>();
+        return sizeof(nlohmann::json::string_t) + string_heap_bytes(string);
+    }
+    case nlohmann::json::value_t::binary: {
+        const auto& binary = value.get_ref<const nlohmann::json::binary_t&>();
+        return sizeof(nlohmann::json::binary_t) + binary.capacity();
+    }
+    case nlohmann::json::value_t::array: {
+        const auto& array = value.get_ref<const nlohmann::json::array_t&>();
+        std::size_t bytes = sizeof(nlohmann::json::array_t) + array.capacity() * sizeof(nlohmann::json);
+        for (const auto& element : array) {
+            bytes += json_heap_bytes(element);
+        }
+        return bytes;
+    }
+    case nlohmann::json::value_t::object: {
+        const auto& object = value.get_ref<const nlohmann::json::object_t&>();
+        std::size_t bytes = sizeof(nlohmann::json::object_t);
+        for (const auto& [key, element] : object) {
+            bytes += MAP_NODE_HEADER_SIZE + sizeof(nlohmann::json::object_t::value_type) + string_heap_bytes(key) +
+                     json_heap_bytes(element);
+        }
+        return bytes;
+    }
+    default:
+        // numbers, booleans and null are stored in the node itself
+        return 0;
+    }
+}
+} // namespace
+
+std::size_t estimate_json_bytes(const nlohmann::json& value) {
+    return sizeof(nlohmann::json) + json_heap_bytes(value);
+}
+
+std::size_t MemoryReport::total_bytes() const {
+    std::size_t bytes = 0;
+    for (const auto& [name, memory] : this->subsystems) {
+        bytes += memory.bytes;
+    }
+    return bytes;
+}
+
+void to_json(nlohmann::json& j, const SubsystemMemory& memory) {
+    j = memory.details;
+    j["bytes"] = memory.bytes;
+}
+
+void to_json(nlohmann::json& j, const MemoryReport& report) {
+    j = {{"total_bytes", report.total_bytes()}, {"subsystems", report.subsystems}};
+}
+
+} // namespace Everest
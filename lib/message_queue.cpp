@@ -1,159 +1,788 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <optional>
+#include <string_view>
 #include <thread>
 
 #include <fmt/format.h>
 
 #include <everest/logging.hpp>
 
+#include <utils/flight_recorder.hpp>
 #include <utils/message_queue.hpp>
+#include <utils/tracing.hpp>
 
 namespace Everest {
 
-MessageQueue::MessageQueue(MessageCallback message_callback_) :
-    message_callback(std::move(message_callback_)), running(true) {
+void MessageRecycler::operator()(Message* message) const {
+    if (this->pool != nullptr) {
+        this->pool->recycle(message);
+    } else {
+        delete message;
+    }
+}
+
+MessagePool::MessagePool(std::size_t max_pooled_messages, std::size_t max_pooled_capacity) :
+    max_pooled_messages(max_pooled_messages), max_pooled_capacity(max_pooled_capacity) {
+    this->free_messages.reserve(max_pooled_messages);
+}
+
+PooledMessage MessagePool::acquire(const char* topic, std::size_t topic_size, const char* payload,
+                                   std::size_t payload_size) {
+    std::unique_ptr<Message> message;
+    {
+        const std::lock_guard<std::mutex> lock(this->free_messages_mutex);
+        if (not this->free_messages.empty()) {
+            message = std::move(this->free_messages.back());
+            this->free_messages.pop_back();
+        }
+    }
+
+    if (message) {
+        this->reuses++;
+    } else {
+        message = std::make_unique<Message>();
+        this->allocations++;
+    }
+
+    // assign() re-uses the already reserved capacity of recycled messages
+    message->topic.assign(topic, topic_size);
+    message->payload.assign(payload, payload_size);
+
+    return PooledMessage(message.release(), MessageRecycler{this});
+}
+
+void MessagePool::recycle(Message* message) {
+    std::unique_ptr<Message> owned_message(message);
+    // do not keep huge buffers (e.g. from config or manifest messages) around
+    if (owned_message->payload.capacity() <= this->max_pooled_capacity) {
+        const std::lock_guard<std::mutex> lock(this->free_messages_mutex);
+        if (this->free_messages.size() < this->max_pooled_messages) {
+            this->free_messages.push_back(std::move(owned_message));
+            return;
+        }
+    }
+    this->discarded++;
+}
+
+MessagePoolStats MessagePool::get_stats() {
+    std::size_t pooled = 0;
+    {
+        const std::lock_guard<std::mutex> lock(this->free_messages_mutex);
+        pooled = this->free_messages.size();
+    }
+    return {this->allocations.load(), this->reuses.load(), this->discarded.load(), pooled};
+}
+
+MessageQueue::MessageQueue(MessageCallback message_callback_, const QueueSettings& settings,
+                           BoundedQueue<PooledMessage>::ConflationKey conflation_key, MessageClassifier classifier) :
+    message_callback(std::move(message_callback_)), classifier(std::move(classifier)) {
+    // dropping or blocking on cmd results or ready signals would break the module, so only the data plane is limited
+    this->lanes[static_cast<std::size_t>(MessagePriority::Command)] = std::make_unique<BoundedQueue<PooledMessage>>();
+    this->lanes[static_cast<std::size_t>(MessagePriority::Lifecycle)] = std::make_unique<BoundedQueue<PooledMessage>>();
+    this->lanes[static_cast<std::size_t>(MessagePriority::Var)] =
+        std::make_unique<BoundedQueue<PooledMessage>>(settings, conflation_key);
+    this->lanes[static_cast<std::size_t>(MessagePriority::External)] =
+        std::make_unique<BoundedQueue<PooledMessage>>(settings, conflation_key);
+
     this->worker_thread = std::thread([this]() {
+        std::vector<PooledMessage> batch;
         while (true) {
-            std::unique_lock<std::mutex> lock(this->queue_ctrl_mutex);
-            this->cv.wait(lock, [this]() { return !this->message_queue.empty() || this->running == false; });
-            if (!this->running) {
+            // reset before looking at the queues, so messages added afterwards always wake up the worker again
+            this->pending = false;
+            next_batch(batch);
+            if (not batch.empty()) {
+                for (const auto& message : batch) {
+                    // pass the message to the message callback
+                    this->message_callback(*message);
+                }
+                // the vector keeps its capacity, messages go back to their pool right away
+                batch.clear();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(this->pending_mutex);
+            this->pending_cv.wait(lock, [this]() { return this->pending or this->stopped; });
+            if (this->stopped) {
                 return;
             }
+        }
+    });
+}
 
-            const auto message = std::move(this->message_queue.front());
-            this->message_queue.pop();
-            lock.unlock();
+BoundedQueue<PooledMessage>& MessageQueue::lane(MessagePriority priority) {
+    return *this->lanes[static_cast<std::size_t>(priority)];
+}
 
-            // pass the message to the message callback
-            this->message_callback(*message);
+void MessageQueue::next_batch(std::vector<PooledMessage>& batch) {
+    for (const auto priority : {MessagePriority::Command, MessagePriority::Lifecycle}) {
+        if (lane(priority).try_pop_batch(batch, control_batch) > 0) {
+            return;
         }
-    });
+    }
+
+    lane(MessagePriority::Var).try_pop_batch(batch, var_batch);
+    lane(MessagePriority::External).try_pop_batch(batch, external_batch);
 }
 
-void MessageQueue::add(std::unique_ptr<Message> message) {
+void MessageQueue::add(PooledMessage message) {
+    const auto priority = this->classifier ? this->classifier(*message) : MessagePriority::External;
+    if (not lane(priority).push(std::move(message))) {
+        return;
+    }
+    // only the first message added while the worker is busy needs to signal it
+    if (this->pending.exchange(true)) {
+        return;
+    }
     {
-        const std::lock_guard<std::mutex> lock(this->queue_ctrl_mutex);
-        this->message_queue.push(std::move(message));
+        // the worker checks the flag while holding the mutex, so the notification cannot get lost
+        const std::lock_guard<std::mutex> lock(this->pending_mutex);
     }
-    this->cv.notify_all();
+    this->pending_cv.notify_one();
 }
 
 void MessageQueue::stop() {
+    for (auto& lane : this->lanes) {
+        lane->close();
+    }
     {
-        const std::lock_guard<std::mutex> lock(this->queue_ctrl_mutex);
-        this->running = false;
+        const std::lock_guard<std::mutex> lock(this->pending_mutex);
+        this->stopped = true;
+    }
+    this->pending_cv.notify_one();
+    if (this->worker_thread.joinable() and this->worker_thread.get_id() != std::this_thread::get_id()) {
+        this->worker_thread.join();
+    }
+}
+
+QueueStats MessageQueue::get_stats() {
+    QueueStats stats;
+    for (auto& lane : this->lanes) {
+        stats += lane->get_stats();
     }
-    this->cv.notify_all();
+    return stats;
 }
 
 MessageQueue::~MessageQueue() {
     stop();
-    worker_thread.join();
 }
 
-MessageHandler::MessageHandler() : running(true) {
-    this->handler_thread = std::thread([this]() {
-        while (true) {
-            std::unique_lock<std::mutex> lock(this->handler_ctrl_mutex);
-            this->cv.wait(lock, [this]() { return !this->message_queue.empty() || this->running == false; });
-            if (!this->running) {
-                return;
+std::string handler_type_to_string(HandlerType type) {
+    switch (type) {
+    case HandlerType::Call:
+        return "call";
+    case HandlerType::Result:
+        return "result";
+    case HandlerType::SubscribeVar:
+        return "subscribe_var";
+    case HandlerType::SubscribeError:
+        return "subscribe_error";
+    case HandlerType::ClearErrorRequest:
+        return "clear_error_request";
+    case HandlerType::GetConfig:
+        return "get_config";
+    case HandlerType::ExternalMQTT:
+        return "external_mqtt";
+    default:
+        return "unknown";
+    }
+}
+
+void to_json(json& j, const DispatchMetrics& metrics) {
+    j = {{"receive_queue", metrics.receive_queue},
+         {"parse", metrics.parse},
+         {"handler_queue", metrics.handler_queue},
+         {"handlers", json::object()},
+         {"queue",
+          {{"depth", metrics.queue.depth},
+           {"max_depth_seen", metrics.queue.max_depth_seen},
+           {"dropped", metrics.queue.dropped},
+           {"conflated", metrics.queue.conflated},
+           {"blocked", metrics.queue.blocked}}}};
+    for (const auto& [type, summary] : metrics.handlers) {
+        j.at("handlers")[handler_type_to_string(type)] = summary;
+    }
+}
+
+void to_json(json& j, const HandlerAccountingStats& stats) {
+    const auto ms = [](std::chrono::nanoseconds duration) { return duration.count() / 1000000.0; };
+    j = {{"type", handler_type_to_string(stats.type)},
+         {"name", stats.name},
+         {"calls", stats.calls},
+         {"wall_ms", ms(stats.wall)},
+         {"cpu_ms", ms(stats.cpu)},
+         {"max_wall_ms", ms(stats.max_wall)},
+         {"over_budget", stats.over_budget}};
+}
+
+/// \returns the CPU time consumed by the calling thread so far
+static std::chrono::nanoseconds thread_cpu_time() {
+    timespec time{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+}
+
+static std::string conflation_key(const std::shared_ptr<ParsedMessage>& message) {
+    const auto& data = message->data;
+    if (not data.is_object()) {
+        // external messages are wrapped payload strings
+        return message->topic;
+    }
+    // calls and results carry a type and must never be replaced by another call or result
+    if (data.contains("type") or not data.contains("name") or not data.at("name").is_string()) {
+        return "";
+    }
+    return data.at("name").get<std::string>();
+}
+
+MessageHandler::MessageHandler(Executor& executor, const QueueSettings& settings, bool record_latencies,
+                               bool account_handlers, std::chrono::nanoseconds handler_budget, bool cache_vars) :
+    handlers(std::make_shared<const HandlerIndex>()),
+    executor(executor),
+    latencies(record_latencies ? std::make_unique<DispatchLatencies>() : nullptr),
+    message_queue(settings, conflation_key),
+    account_handlers(account_handlers),
+    handler_budget(handler_budget),
+    cache_vars(cache_vars) {
+}
+
+void MessageHandler::schedule() {
+    if (this->scheduled.exchange(true)) {
+        return;
+    }
+    // the task keeps this handler alive until all of its queued messages have been delivered or discarded
+    this->executor.post([self = shared_from_this()]() { self->drain(); });
+}
+
+void MessageHandler::drain() {
+    // deliver a limited number of messages per task, so busy topics do not starve the other topics
+    constexpr auto max_messages_per_task = std::size_t{16};
+    if (this->replays_pending) {
+        // before any newer message, so the handlers see the vars in order
+        replay_cached_vars();
+    }
+    std::vector<std::shared_ptr<ParsedMessage>> messages;
+    messages.reserve(max_messages_per_task);
+    this->message_queue.try_pop_batch(messages, max_messages_per_task);
+    for (const auto& message : messages) {
+        try {
+            handle(*message);
+            if (this->cache_vars) {
+                cache_var(message);
             }
+        } catch (const std::exception& e) {
+            // exceptions escaping a handler used to terminate its handler thread and with it the module
+            EVLOG_critical << fmt::format("Caught exception in handler for topic '{}': {}", message->topic, e.what());
+            exit(1);
+        }
+    }
+
+    this->scheduled = false;
+    // messages and handlers added after the last try_pop() did not schedule a task, since this one was still running
+    if (this->message_queue.get_stats().depth > 0 or this->replays_pending) {
+        schedule();
+    }
+}
+
+void MessageHandler::handle(const ParsedMessage& message) {
+    const auto& data = message.data;
+    // the snapshot keeps all of its handlers alive, even if they are removed while being called
+    const auto index = std::atomic_load(&this->handlers);
+
+    auto* latencies = this->latencies.get();
+    if (latencies != nullptr) {
+        latencies->handler_queue.record(std::chrono::steady_clock::now() - message.dispatched);
+    }
 
-            const auto message = std::move(this->message_queue.front());
-            this->message_queue.pop();
-            lock.unlock();
+    // handlers of traced messages run in their trace, so messages they publish continue it
+    const auto trace = data.is_object() ? data.find("trace") : data.end();
+    const tracing::ScopedContext trace_context(trace != data.end() and trace->is_string()
+                                                   ? tracing::from_string(trace->get_ref<const std::string&>())
+                                                   : tracing::current());
 
-            const auto& data = message->data;
+    // raw payloads are only wrapped into json for the handlers asking for json and parsed payloads only serialized
+    // again for the handlers asking for the payload as is, both at most once per message
+    std::optional<json> wrapped_payload;
+    std::optional<std::string> serialized_data;
+    const auto get_data = [&message, &data, &wrapped_payload]() -> const json& {
+        if (not message.raw) {
+            return data;
+        }
+        if (not wrapped_payload.has_value()) {
+            wrapped_payload = json(message.payload);
+        }
+        return wrapped_payload.value();
+    };
+    const auto get_payload = [&message, &data, &serialized_data]() -> std::string_view {
+        if (message.raw) {
+            return message.payload;
+        }
+        if (not serialized_data.has_value()) {
+            serialized_data = data.is_string() ? data.get<std::string>() : data.dump();
+        }
+        return serialized_data.value();
+    };
 
-            // get the registered handlers
-            std::vector<std::shared_ptr<TypedHandler>> local_handlers;
-            {
-                const std::lock_guard<std::mutex> handlers_lock(handler_list_mutex);
-                local_handlers = {std::begin(this->handlers), std::end(this->handlers)};
+    const auto call = [this, &message, &data, &index, latencies, &get_data, &get_payload](const TypedHandler& handler) {
+        HandlerAccounting* accounting = nullptr;
+        if (this->account_handlers) {
+            const auto record = index->accounting.find(&handler);
+            accounting = record != index->accounting.end() ? record->second : nullptr;
+        }
+        auto& flight_recorder = FlightRecorder::get();
+        const auto record_flight = flight_recorder.is_enabled();
+        const auto started = latencies != nullptr or accounting != nullptr or record_flight
+                                 ? std::chrono::steady_clock::now()
+                                 : std::chrono::steady_clock::time_point{};
+        const auto cpu_started = accounting != nullptr ? thread_cpu_time() : std::chrono::nanoseconds{};
+        if (accounting != nullptr) {
+            const std::lock_guard<std::mutex> lock(this->accounting_mutex);
+            this->running_handler = {accounting, started, false};
+        }
+        tracing::Span span("dispatch", false);
+        if (span.is_recording()) {
+            span.set_name(fmt::format("{} {}", handler_type_to_string(handler.type), message.topic));
+        }
+        switch (handler.type) {
+        case HandlerType::Call:
+        case HandlerType::Result:
+        case HandlerType::SubscribeVar:
+            // unpack call, result or var
+            (*handler.handler)(message.topic, data.at("data"));
+            break;
+        default:
+            // external or unknown, no preprocessing
+            if (handler.raw_handler != nullptr) {
+                (*handler.raw_handler)(message.topic, get_payload());
+            } else {
+                (*handler.handler)(message.topic, get_data());
             }
+            break;
+        }
+        if (latencies != nullptr) {
+            latencies->handlers.at(static_cast<std::size_t>(handler.type))
+                .record(std::chrono::steady_clock::now() - started);
+        }
+        if (accounting != nullptr) {
+            account_handler_call(message.topic, *accounting, started, cpu_started);
+        }
+        if (record_flight) {
+            std::string_view call_id;
+            if (handler.type == HandlerType::Call or handler.type == HandlerType::Result) {
+                const auto& call_data = data.at("data");
+                const auto id = call_data.find("id");
+                if (id != call_data.end() and id->is_string()) {
+                    call_id = id->get_ref<const std::string&>();
+                }
+            }
+            flight_recorder.record(FlightEvent::Dispatch, handler.type, message.topic, call_id,
+                                   std::chrono::steady_clock::now() - started);
+        }
+    };
+
+    // distribute this message to the matching handlers
+    for (const auto& handler : index->other_handlers) {
+        call(*handler);
+    }
+
+    const auto name = data.is_object() ? data.find("name") : data.end();
+    if (name == data.end() or not name->is_string()) {
+        return;
+    }
+    const auto& name_str = name->get_ref<const std::string&>();
 
-            // distribute this message to the registered handlers
-            for (auto& handler : local_handlers) {
-                auto handler_fn = *handler->handler;
-
-                if (handler->type == HandlerType::Call) {
-                    // unpack call
-                    if (handler->name != data.at("name")) {
-                        continue;
-                    }
-                    if (data.at("type") == "call") {
-                        handler_fn(message->topic, data.at("data"));
-                    }
-                } else if (handler->type == HandlerType::Result) {
-                    // unpack result
-                    if (handler->name != data.at("name")) {
-                        continue;
-                    }
-                    if (data.at("type") == "result") {
-                        // only deliver result to handler with matching id
-                        if (handler->id == data.at("data").at("id")) {
-                            handler_fn(message->topic, data.at("data"));
-                        }
-                    }
-                } else if (handler->type == HandlerType::SubscribeVar) {
-                    // unpack var
-                    if (handler->name != data.at("name")) {
-                        continue;
-                    }
-                    handler_fn(message->topic, data.at("data"));
-                } else {
-                    // external or unknown, no preprocessing
-                    handler_fn(message->topic, data);
+    const auto var_handlers = index->var_handlers.find(name_str);
+    if (var_handlers != index->var_handlers.end()) {
+        if (this->replays_pending and data.find("type") == data.end()) {
+            // handlers added after the last delivery get this value instead of the cached one
+            const std::lock_guard<std::mutex> lock(this->var_cache_mutex);
+            auto& pending = this->pending_replays;
+            pending.erase(std::remove_if(pending.begin(), pending.end(),
+                                         [&var_handlers](const auto& handler) {
+                                             const auto& handlers = var_handlers->second;
+                                             return std::find(handlers.begin(), handlers.end(), handler) !=
+                                                    handlers.end();
+                                         }),
+                          pending.end());
+            this->replays_pending = not pending.empty();
+        }
+        for (const auto& handler : var_handlers->second) {
+            call(*handler);
+        }
+    }
+
+    const auto type = data.find("type");
+    // cancellations of calls and acknowledgements of streamed chunks are delivered to the call handlers, which know
+    // the calls they are handling
+    if (type != data.end() and (*type == "call" or *type == "cancel" or *type == "ack")) {
+        const auto call_handlers = index->call_handlers.find(name_str);
+        if (call_handlers != index->call_handlers.end()) {
+            for (const auto& handler : call_handlers->second) {
+                call(*handler);
+            }
+        }
+    } else if (type != data.end() and *type == "result") {
+        // only deliver result to handler with matching id and to the handlers receiving all results
+        const auto& id = data.at("data").at("id");
+        const auto deliver = [&call, &name_str](const HandlerList& handlers) {
+            for (const auto& handler : handlers) {
+                if (handler->name.empty() or handler->name == name_str) {
+                    call(*handler);
                 }
             }
+        };
+        const auto result_handlers = id.is_string() ? index->result_handlers.find(id.get_ref<const std::string&>())
+                                                    : index->result_handlers.end();
+        if (result_handlers != index->result_handlers.end() and result_handlers->first != "") {
+            deliver(result_handlers->second);
         }
-    });
+        const auto all_result_handlers = index->result_handlers.find("");
+        if (all_result_handlers != index->result_handlers.end()) {
+            deliver(all_result_handlers->second);
+        }
+    }
 }
 
-void MessageHandler::add(std::shared_ptr<ParsedMessage> message) {
+void MessageHandler::cache_var(const std::shared_ptr<ParsedMessage>& message) {
+    const auto& data = message->data;
+    if (not data.is_object() or data.contains("type") or not data.contains("data")) {
+        return;
+    }
+    const auto name = data.find("name");
+    if (name == data.end() or not name->is_string()) {
+        return;
+    }
+    const std::lock_guard<std::mutex> lock(this->var_cache_mutex);
+    this->var_cache[name->get_ref<const std::string&>()] = message;
+}
+
+void MessageHandler::replay_cached_vars() {
+    std::vector<std::pair<std::shared_ptr<TypedHandler>, std::shared_ptr<const ParsedMessage>>> replays;
     {
-        const std::lock_guard<std::mutex> lock(this->handler_ctrl_mutex);
-        this->message_queue.push(std::move(message));
+        const std::lock_guard<std::mutex> lock(this->var_cache_mutex);
+        for (auto& handler : this->pending_replays) {
+            const auto cached = this->var_cache.find(handler->name);
+            if (cached != this->var_cache.end()) {
+                replays.emplace_back(std::move(handler), cached->second);
+            }
+        }
+        this->pending_replays.clear();
+        this->replays_pending = false;
+    }
+
+    const auto index = std::atomic_load(&this->handlers);
+    for (const auto& [handler, message] : replays) {
+        // handlers removed in the meantime are not called anymore
+        const auto var_handlers = index->var_handlers.find(handler->name);
+        if (var_handlers == index->var_handlers.end() or
+            std::find(var_handlers->second.begin(), var_handlers->second.end(), handler) ==
+                var_handlers->second.end()) {
+            continue;
+        }
+        try {
+            (*handler->handler)(message->topic, message->data.at("data"));
+        } catch (const std::exception& e) {
+            EVLOG_critical << fmt::format("Caught exception in handler for topic '{}': {}", message->topic, e.what());
+            exit(1);
+        }
     }
-    this->cv.notify_all();
 }
 
-void MessageHandler::stop() {
+void MessageHandler::account_handler_call(const std::string& topic, HandlerAccounting& accounting,
+                                          std::chrono::steady_clock::time_point started,
+                                          std::chrono::nanoseconds cpu_started) {
+    const auto wall = std::chrono::steady_clock::now() - started;
+    const auto cpu = thread_cpu_time() - cpu_started;
+    const auto wall_ns = static_cast<std::uint64_t>(std::chrono::nanoseconds(wall).count());
+    accounting.calls.fetch_add(1, std::memory_order_relaxed);
+    accounting.wall_ns.fetch_add(wall_ns, std::memory_order_relaxed);
+    accounting.cpu_ns.fetch_add(static_cast<std::uint64_t>(cpu.count()), std::memory_order_relaxed);
+    auto max_wall_ns = accounting.max_wall_ns.load(std::memory_order_relaxed);
+    while (wall_ns > max_wall_ns and
+           not accounting.max_wall_ns.compare_exchange_weak(max_wall_ns, wall_ns, std::memory_order_relaxed)) {
+    }
+
+    bool reported = false;
     {
-        const std::lock_guard<std::mutex> lock(this->handler_ctrl_mutex);
-        this->running = false;
+        const std::lock_guard<std::mutex> lock(this->accounting_mutex);
+        reported = this->running_handler.reported;
+        this->running_handler = {};
+    }
+    if (this->handler_budget.count() <= 0 or wall <= this->handler_budget) {
+        return;
+    }
+    accounting.over_budget.fetch_add(1, std::memory_order_relaxed);
+    const auto ms = [](std::chrono::nanoseconds duration) { return duration.count() / 1000000.0; };
+    if (reported) {
+        EVLOG_warning << fmt::format("Handler {} '{}' on topic '{}' finished after {:.1f} ms, using {:.1f} ms CPU time",
+                                     handler_type_to_string(accounting.type), accounting.name, topic, ms(wall),
+                                     ms(cpu));
+    } else {
+        EVLOG_warning << fmt::format(
+            "Handler {} '{}' on topic '{}' took {:.1f} ms, using {:.1f} ms CPU time, exceeding its budget of {:.1f} ms",
+            handler_type_to_string(accounting.type), accounting.name, topic, ms(wall), ms(cpu),
+            ms(this->handler_budget));
+    }
+}
+
+void MessageHandler::check_handler_budget(const std::string& topic, std::chrono::steady_clock::time_point now) {
+    if (this->handler_budget.count() <= 0) {
+        return;
+    }
+    const std::lock_guard<std::mutex> lock(this->accounting_mutex);
+    auto& running = this->running_handler;
+    if (running.accounting == nullptr or running.reported or now - running.started <= this->handler_budget) {
+        return;
+    }
+    running.reported = true;
+    // a blocked handler also blocks all later messages of its topic, so warn while it is still running
+    EVLOG_warning << fmt::format(
+        "Handler {} '{}' on topic '{}' is still running after {} ms, exceeding its budget of {} ms",
+        handler_type_to_string(running.accounting->type), running.accounting->name, topic,
+        std::chrono::duration_cast<std::chrono::milliseconds>(now - running.started).count(),
+        std::chrono::duration_cast<std::chrono::milliseconds>(this->handler_budget).count());
+}
+
+void MessageHandler::add(std::shared_ptr<ParsedMessage> message) {
+    if (this->message_queue.push(std::move(message))) {
+        schedule();
+    }
+}
+
+void MessageHandler::stop() {
+    this->message_queue.close();
+    this->message_queue.drain();
+}
+
+bool MessageHandler::wants_message(const PayloadEnvelope& envelope) {
+    const auto index = std::atomic_load(&this->handlers);
+    if (not index->other_handlers.empty()) {
+        return true;
+    }
+    if (envelope.name.empty()) {
+        return false;
+    }
+    if (this->cache_vars and envelope.type.empty()) {
+        // every var is cached, also the ones nobody has subscribed to yet
+        return true;
+    }
+    if (index->var_handlers.find(envelope.name) != index->var_handlers.end()) {
+        return true;
+    }
+    if (envelope.type == "call" or envelope.type == "cancel" or envelope.type == "ack") {
+        return index->call_handlers.find(envelope.name) != index->call_handlers.end();
+    }
+    if (envelope.type == "result") {
+        const auto matches = [&index, &envelope](const std::string& id) {
+            const auto handlers = index->result_handlers.find(id);
+            return handlers != index->result_handlers.end() and
+                   std::any_of(handlers->second.begin(), handlers->second.end(), [&envelope](const auto& handler) {
+                       return handler->name.empty() or handler->name == envelope.name;
+                   });
+        };
+        return matches(envelope.id) or (not envelope.id.empty() and matches(""));
+    }
+    return false;
+}
+
+bool MessageHandler::filters_results() {
+    const auto index = std::atomic_load(&this->handlers);
+    return not this->cache_vars and index->other_handlers.empty() and index->call_handlers.empty() and
+           index->var_handlers.empty() and not index->result_handlers.empty() and
+           index->result_handlers.find("") == index->result_handlers.end();
+}
+
+bool MessageHandler::wants_result(const std::string& id) {
+    const auto index = std::atomic_load(&this->handlers);
+    return index->result_handlers.find(id) != index->result_handlers.end();
+}
+
+MessageHandler::HandlerList& MessageHandler::HandlerIndex::find_handler_list(const TypedHandler& handler) {
+    switch (handler.type) {
+    case HandlerType::Call:
+        return this->call_handlers[handler.name];
+    case HandlerType::Result:
+        return this->result_handlers[handler.id];
+    case HandlerType::SubscribeVar:
+        return this->var_handlers[handler.name];
+    default:
+        return this->other_handlers;
     }
-    this->cv.notify_all();
+}
+
+void MessageHandler::HandlerIndex::erase_empty_handler_list(const TypedHandler& handler) {
+    // do not keep an index entry for every call id that ever had a result handler
+    switch (handler.type) {
+    case HandlerType::Call:
+        this->call_handlers.erase(handler.name);
+        break;
+    case HandlerType::Result:
+        this->result_handlers.erase(handler.id);
+        break;
+    case HandlerType::SubscribeVar:
+        this->var_handlers.erase(handler.name);
+        break;
+    default:
+        break;
+    }
+}
+
+void MessageHandler::update_handlers(const std::function<void(HandlerIndex&)>& update) {
+    const std::lock_guard<std::mutex> lock(this->handler_list_mutex);
+    auto index = std::make_shared<HandlerIndex>(*std::atomic_load(&this->handlers));
+    update(*index);
+    std::atomic_store(&this->handlers, std::shared_ptr<const HandlerIndex>(std::move(index)));
+}
+
+MessageHandler::HandlerAccounting* MessageHandler::get_accounting_record(const TypedHandler& handler) {
+    const std::lock_guard<std::mutex> lock(this->accounting_mutex);
+    // result handlers are accounted by cmd name, every call has its own result handler
+    auto& record = this->accounting_records[{handler.type, handler.name}];
+    if (record == nullptr) {
+        record = std::make_unique<HandlerAccounting>();
+        record->type = handler.type;
+        record->name = handler.name;
+    }
+    return record.get();
 }
 
 void MessageHandler::add_handler(std::shared_ptr<TypedHandler> handler) {
-    {
-        const std::lock_guard<std::mutex> lock(this->handler_list_mutex);
-        this->handlers.insert(handler);
+    auto* accounting = this->account_handlers ? get_accounting_record(*handler) : nullptr;
+    const bool replay = this->cache_vars and handler->type == HandlerType::SubscribeVar;
+    if (replay) {
+        // registered as pending before the handler can receive messages, so a message delivered to it in between
+        // replaces the cached value
+        const std::lock_guard<std::mutex> lock(this->var_cache_mutex);
+        this->pending_replays.push_back(handler);
+        this->replays_pending = true;
+    }
+    update_handlers([&handler, accounting](HandlerIndex& index) {
+        auto& handlers = index.find_handler_list(*handler);
+        if (std::find(handlers.begin(), handlers.end(), handler) == handlers.end()) {
+            handlers.push_back(handler);
+            index.handler_count++;
+        }
+        if (accounting != nullptr) {
+            index.accounting[handler.get()] = accounting;
+        }
+    });
+    if (replay) {
+        schedule();
     }
 }
 
 void MessageHandler::remove_handler(std::shared_ptr<TypedHandler> handler) {
-    {
-        const std::lock_guard<std::mutex> lock(this->handler_list_mutex);
-        auto it = std::find(this->handlers.begin(), this->handlers.end(), handler);
-        this->handlers.erase(it);
-    }
+    update_handlers([&handler](HandlerIndex& index) {
+        auto& handlers = index.find_handler_list(*handler);
+        auto it = std::find(handlers.begin(), handlers.end(), handler);
+        if (it != handlers.end()) {
+            handlers.erase(it);
+            index.handler_count--;
+            index.accounting.erase(handler.get());
+        }
+        if (handlers.empty()) {
+            index.erase_empty_handler_list(*handler);
+        }
+    });
 }
 
 std::size_t MessageHandler::count_handlers() {
-    std::size_t count = 0;
+    return std::atomic_load(&this->handlers)->handler_count;
+}
+QueueStats MessageHandler::get_stats() {
+    return this->message_queue.get_stats();
+}
+
+std::size_t MessageHandler::count_cached_vars() {
+    const std::lock_guard<std::mutex> lock(this->var_cache_mutex);
+    return this->var_cache.size();
+}
+
+DispatchLatencies* MessageHandler::get_latencies() {
+    return this->latencies.get();
+}
+
+DispatchMetrics MessageHandler::get_metrics() {
+    DispatchMetrics metrics;
+    metrics.queue = this->message_queue.get_stats();
+    if (this->latencies == nullptr) {
+        return metrics;
+    }
+    metrics.receive_queue = this->latencies->receive_queue.get_summary();
+    metrics.parse = this->latencies->parse.get_summary();
+    metrics.handler_queue = this->latencies->handler_queue.get_summary();
+    for (std::size_t type = 0; type < HANDLER_TYPE_COUNT; type++) {
+        auto summary = this->latencies->handlers.at(type).get_summary();
+        if (summary.count > 0) {
+            metrics.handlers.emplace(static_cast<HandlerType>(type), std::move(summary));
+        }
+    }
+    return metrics;
+}
+
+std::vector<HandlerAccountingStats> MessageHandler::get_handler_accounting() {
+    std::vector<HandlerAccountingStats> stats;
+    const std::lock_guard<std::mutex> lock(this->accounting_mutex);
+    stats.reserve(this->accounting_records.size());
+    for (const auto& [key, record] : this->accounting_records) {
+        HandlerAccountingStats record_stats;
+        record_stats.type = record->type;
+        record_stats.name = record->name;
+        record_stats.calls = record->calls.load(std::memory_order_relaxed);
+        record_stats.wall = std::chrono::nanoseconds(record->wall_ns.load(std::memory_order_relaxed));
+        record_stats.cpu = std::chrono::nanoseconds(record->cpu_ns.load(std::memory_order_relaxed));
+        record_stats.max_wall = std::chrono::nanoseconds(record->max_wall_ns.load(std::memory_order_relaxed));
+        record_stats.over_budget = record->over_budget.load(std::memory_order_relaxed);
+        stats.push_back(std::move(record_stats));
+    }
+    return stats;
+}
+
+LatestValueSlot::LatestValueSlot(Executor& executor, std::function<void(const json&)> callback) :
+    executor(executor), callback(std::move(callback)) {
+}
+
+void LatestValueSlot::store(json value) {
     {
-        const std::lock_guard<std::mutex> lock(this->handler_list_mutex);
-        count = this->handlers.size();
+        const std::lock_guard<std::mutex> lock(this->slot_mutex);
+        if (this->value.has_value()) {
+            this->conflated++;
+        }
+        this->value = std::move(value);
+        if (this->delivering) {
+            return;
+        }
+        this->delivering = true;
     }
-    return count;
+    this->executor.post([self = shared_from_this()]() { self->deliver(); });
 }
 
-MessageHandler::~MessageHandler() {
-    stop();
-    handler_thread.join();
+void LatestValueSlot::deliver() {
+    while (true) {
+        json current;
+        {
+            const std::lock_guard<std::mutex> lock(this->slot_mutex);
+            if (not this->value.has_value()) {
+                this->delivering = false;
+                return;
+            }
+            current = std::move(*this->value);
+            this->value.reset();
+        }
+        try {
+            this->callback(current);
+        } catch (const std::exception& e) {
+            EVLOG_critical << fmt::format("Caught exception in latest value callback: {}", e.what());
+            exit(1);
+        }
+    }
+}
+
+std::size_t LatestValueSlot::get_conflated_count() {
+    return this->conflated;
 }
 
 } // namespace Everest
@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <utils/metrics.hpp>
+
+#include <array>
+#include <chrono>
+#include <type_traits>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <everest/exceptions.hpp>
+
+namespace Everest {
+
+namespace {
+constexpr std::array<const char*, 3> metric_types = {"counter", "gauge", "summary"};
+
+/// \returns \p text with backslashes, quotes and newlines escaped as required for label values and help texts
+std::string escape(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (const auto c : text) {
+        switch (c) {
+        case '\\':
+            escaped += "\\\\";
+            break;
+        case '"':
+            escaped += "\\\"";
+            break;
+        case '\n':
+            escaped += "\\n";
+            break;
+        default:
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+double to_seconds(std::chrono::nanoseconds duration) {
+    return std::chrono::duration<double>(duration).count();
+}
+
+std::string format_labels(const nlohmann::json& labels, const std::string& extra_label = "") {
+    std::string formatted;
+    for (const auto& [key, value] : labels.items()) {
+        formatted += fmt::format("{}{}=\"{}\"", formatted.empty() ? "" : ",", key, escape(value.get<std::string>()));
+    }
+    if (not extra_label.empty()) {
+        formatted += fmt::format("{}{}", formatted.empty() ? "" : ",", extra_label);
+    }
+    return formatted.empty() ? "" : fmt::format("{{{}}}", formatted);
+}
+} // namespace
+
+template <typename T>
+T& MetricsRegistry::get_or_add(const std::string& name, const std::string& help, const MetricLabels& labels) {
+    using Value = decltype(Metric::value);
+    constexpr auto type_index = std::is_same_v<T, Counter> ? 0 : std::is_same_v<T, Gauge> ? 1 : 2;
+    static_assert(std::is_same_v<std::variant_alternative_t<type_index, Value>, std::unique_ptr<T>>);
+
+    std::lock_guard<std::mutex> lock(this->metrics_mutex);
+    const auto [type_it, inserted] = this->types.try_emplace(name, type_index);
+    if (not inserted and type_it->second != type_index) {
+        throw EverestInternalError(fmt::format("Metric {} is already registered as {}, it can not be used as {}", name,
+                                               metric_types.at(type_it->second), metric_types.at(type_index)));
+    }
+    auto metric_it = this->metrics.find({name, labels});
+    if (metric_it == this->metrics.end()) {
+        Metric metric{name, help, labels, std::make_unique<T>()};
+        metric_it = this->metrics.emplace(std::make_pair(name, labels), std::move(metric)).first;
+    }
+    return *std::get<std::unique_ptr<T>>(metric_it->second.value);
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const MetricLabels& labels) {
+    return this->get_or_add<Counter>(name, help, labels);
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const MetricLabels& labels) {
+    return this->get_or_add<Gauge>(name, help, labels);
+}
+
+LatencyHistogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                             const MetricLabels& labels) {
+    return this->get_or_add<LatencyHistogram>(name, help, labels);
+}
+
+nlohmann::json MetricsRegistry::get_snapshot(const MetricLabels& labels) const {
+    auto snapshot = nlohmann::json::array();
+    std::lock_guard<std::mutex> lock(this->metrics_mutex);
+    for (const auto& [key, metric] : this->metrics) {
+        auto metric_labels = metric.labels;
+        metric_labels.insert(labels.begin(), labels.end());
+        nlohmann::json sample = {{"name", metric.name},
+                                 {"type", metric_types.at(metric.value.index())},
+                                 {"help", metric.help},
+                                 {"labels", metric_labels}};
+        if (const auto* counter = std::get_if<std::unique_ptr<Counter>>(&metric.value)) {
+            sample["value"] = (*counter)->get();
+        } else if (const auto* gauge = std::get_if<std::unique_ptr<Gauge>>(&metric.value)) {
+            sample["value"] = (*gauge)->get();
+        } else {
+            const auto summary = std::get<std::unique_ptr<LatencyHistogram>>(metric.value)->get_summary();
+            sample["count"] = summary.count;
+            sample["sum"] = to_seconds(summary.mean) * static_cast<double>(summary.count);
+            sample["quantiles"] = {{"0.5", to_seconds(summary.p50)},
+                                   {"0.9", to_seconds(summary.p90)},
+                                   {"0.99", to_seconds(summary.p99)},
+                                   {"0.999", to_seconds(summary.p999)}};
+        }
+        snapshot.push_back(std::move(sample));
+    }
+    return snapshot;
+}
+
+std::string to_openmetrics(const nlohmann::json& samples) {
+    // the samples of a metric family have to be written together
+    std::map<std::string, std::vector<const nlohmann::json*>> families;
+    for (const auto& sample : samples) {
+        families[sample.at("name").get<std::string>()].push_back(&sample);
+    }
+
+    std::string text;
+    for (const auto& [name, family] : families) {
+        const auto type = family.front()->at("type").get<std::string>();
+        text += fmt::format("# TYPE {} {}\n", name, type);
+        text += fmt::format("# HELP {} {}\n", name, escape(family.front()->value("help", "")));
+        for (const auto* sample : family) {
+            const auto& labels = sample->at("labels");
+            if (type == "counter") {
+                text += fmt::format("{}_total{} {}\n", name, format_labels(labels), sample->at("value").dump());
+            } else if (type == "gauge") {
+                text += fmt::format("{}{} {}\n", name, format_labels(labels), sample->at("value").dump());
+            } else {
+                for (const auto& [quantile, value] : sample->at("quantiles").items()) {
+                    const auto quantile_label = fmt::format("quantile=\"{}\"", quantile);
+                    text += fmt::format("{}{} {}\n", name, format_labels(labels, quantile_label), value.dump());
+                }
+                text += fmt::format("{}_sum{} {}\n", name, format_labels(labels), sample->at("sum").dump());
+                text += fmt::format("{}_count{} {}\n", name, format_labels(labels), sample->at("count").dump());
+            }
+        }
+    }
+    text += "# EOF\n";
+    return text;
+}
+
+} // namespace Everest
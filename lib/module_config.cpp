@@ -8,7 +8,9 @@
 #include <everest/exceptions.hpp>
 #include <everest/logging.hpp>
 
+#include <utils/config_image.hpp>
 #include <utils/module_config.hpp>
+#include <utils/payload_encoding.hpp>
 #include <utils/types.hpp>
 
 namespace Everest {
@@ -17,6 +19,16 @@ using json = nlohmann::json;
 inline constexpr int mqtt_get_config_timeout_ms = 5000;
 
 json get_module_config(std::shared_ptr<MQTTAbstraction> mqtt, const std::string& module_id) {
+    // modules spawned by a manager sharing its config image do not need to ask the manager at all
+    const auto config_image = ConfigImage::attach_from_env();
+    if (config_image != nullptr) {
+        auto snapshot = config_image->get_module_snapshot(module_id);
+        if (snapshot.has_value()) {
+            EVLOG_debug << fmt::format("Read config snapshot for {} from the shared config image", module_id);
+            return std::move(snapshot.value());
+        }
+    }
+
     const auto& everest_prefix = mqtt->get_everest_prefix();
 
     const auto get_config_topic = fmt::format("{}modules/{}/get_config", everest_prefix, module_id);
@@ -34,7 +46,9 @@ json get_module_config(std::shared_ptr<MQTTAbstraction> mqtt, const std::string&
         std::make_shared<TypedHandler>(HandlerType::GetConfig, std::make_shared<Handler>(res_handler));
     mqtt->register_handler(config_topic, res_token, QOS::QOS2);
 
-    const json config_publish_data = json::object({{"type", "full"}});
+    // request everything in a single, binary encoded message instead of fetching the parts one by one
+    const json config_publish_data = json::object(
+        {{"type", "snapshot"}, {"encoding", payload_encoding_to_string(MQTTPayloadEncoding::Cbor)}});
 
     mqtt->publish(get_config_topic, config_publish_data, QOS::QOS2);
 
@@ -57,6 +71,12 @@ json get_module_config(std::shared_ptr<MQTTAbstraction> mqtt, const std::string&
     }
     mqtt->unregister_handler(config_topic, res_token);
 
+    if (result.contains("interface_definitions")) {
+        EVLOG_debug << fmt::format("Received config snapshot for {}", module_id);
+        return result;
+    }
+
+    // managers without snapshot support only send the module specific part of the config
     const auto interface_names_topic = fmt::format("{}interfaces", everest_prefix);
     const auto interface_names = mqtt->get(interface_names_topic, QOS::QOS2);
     auto interface_definitions = json::object();
@@ -1,109 +1,311 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright Pionix GmbH and Contributors to EVerest
+#include <chrono>
+#include <thread>
+
 #include <everest/logging.hpp>
 
+#include <utils/framework_log.hpp>
 #include <utils/mqtt_abstraction.hpp>
 #include <utils/mqtt_abstraction_impl.hpp>
 
 namespace Everest {
 
-std::unique_ptr<MQTTAbstractionImpl> create_mqtt_client(const MQTTSettings& mqtt_settings) {
+std::unique_ptr<MQTTAbstractionImpl> create_mqtt_client(const MQTTSettings& mqtt_settings,
+                                                        MQTTAbstractionImpl* dispatcher = nullptr) {
+    std::unique_ptr<MQTTAbstractionImpl> mqtt_client;
     if (mqtt_settings.uses_socket()) {
-        return std::make_unique<MQTTAbstractionImpl>(mqtt_settings.broker_socket_path, mqtt_settings.everest_prefix,
-                                                     mqtt_settings.external_prefix);
+        mqtt_client = std::make_unique<MQTTAbstractionImpl>(
+            mqtt_settings.broker_socket_path, mqtt_settings.everest_prefix, mqtt_settings.external_prefix,
+            mqtt_settings.buffers, mqtt_settings.queues, dispatcher);
     } else {
-        return std::make_unique<MQTTAbstractionImpl>(mqtt_settings.broker_host,
-                                                     std::to_string(mqtt_settings.broker_port),
-                                                     mqtt_settings.everest_prefix, mqtt_settings.external_prefix);
+        mqtt_client = std::make_unique<MQTTAbstractionImpl>(
+            mqtt_settings.broker_host, std::to_string(mqtt_settings.broker_port), mqtt_settings.everest_prefix,
+            mqtt_settings.external_prefix, mqtt_settings.buffers, mqtt_settings.queues, dispatcher);
     }
+    mqtt_client->set_payload_encoding(mqtt_settings.payload_encoding);
+    mqtt_client->set_dispatch_metrics_settings(mqtt_settings.dispatch_metrics);
+    mqtt_client->set_handler_accounting_settings(mqtt_settings.handler_accounting);
+    mqtt_client->set_var_cache_enabled(mqtt_settings.var_cache);
+    return mqtt_client;
 }
 
 MQTTAbstraction::MQTTAbstraction(const MQTTSettings& mqtt_settings) :
+    mqtt_abstraction(create_mqtt_client(mqtt_settings)),
+    broker_shards(mqtt_settings.broker_shards),
     everest_prefix(mqtt_settings.everest_prefix),
-    external_prefix(mqtt_settings.external_prefix),
-    mqtt_abstraction(create_mqtt_client(mqtt_settings)) {
+    external_prefix(mqtt_settings.external_prefix) {
+    for (const auto& shard : this->broker_shards) {
+        // same settings as the main connection apart from the broker
+        auto shard_settings = mqtt_settings;
+        shard_settings.broker_socket_path = shard.broker_socket_path;
+        shard_settings.broker_host = shard.broker_host;
+        shard_settings.broker_port = shard.broker_port;
+        shard_settings.broker_shards.clear();
+        // the main connection dispatches the messages of the shards, so each handler keeps a single strand
+        this->shard_clients.push_back(create_mqtt_client(shard_settings, this->mqtt_abstraction.get()));
+    }
 }
 
 MQTTAbstraction::~MQTTAbstraction() = default;
 
 bool MQTTAbstraction::connect() {
-    BOOST_LOG_FUNCTION();
-    return mqtt_abstraction->connect();
+    FRAMEWORK_LOG_FUNCTION();
+    bool connected = true;
+    for (auto* client : get_all_clients()) {
+        connected = client->connect() and connected;
+    }
+    return connected;
 }
 
 void MQTTAbstraction::disconnect() {
-    BOOST_LOG_FUNCTION();
-    mqtt_abstraction->disconnect();
+    FRAMEWORK_LOG_FUNCTION();
+    for (auto* client : get_all_clients()) {
+        client->disconnect();
+    }
 }
 
 void MQTTAbstraction::publish(const std::string& topic, const json& json) {
-    BOOST_LOG_FUNCTION();
-    mqtt_abstraction->publish(topic, json);
+    FRAMEWORK_LOG_FUNCTION();
+    get_client(topic).publish(topic, json);
 }
 
 void MQTTAbstraction::publish(const std::string& topic, const json& json, QOS qos, bool retain) {
-    BOOST_LOG_FUNCTION();
-    mqtt_abstraction->publish(topic, json, qos, retain);
+    FRAMEWORK_LOG_FUNCTION();
+    get_client(topic).publish(topic, json, qos, retain);
 }
 
 void MQTTAbstraction::publish(const std::string& topic, const std::string& data) {
-    BOOST_LOG_FUNCTION();
-    mqtt_abstraction->publish(topic, data);
+    FRAMEWORK_LOG_FUNCTION();
+    get_client(topic).publish(topic, data);
 }
 
 void MQTTAbstraction::publish(const std::string& topic, const std::string& data, QOS qos, bool retain) {
-    BOOST_LOG_FUNCTION();
-    mqtt_abstraction->publish(topic, data, qos, retain);
+    FRAMEWORK_LOG_FUNCTION();
+    get_client(topic).publish(topic, data, qos, retain);
+}
+
+void MQTTAbstraction::publish_raw(const std::string& topic, std::string_view payload, QOS qos, bool retain) {
+    FRAMEWORK_LOG_FUNCTION();
+    get_client(topic).publish_raw(topic, payload, qos, retain);
+}
+
+void MQTTAbstraction::begin_publish_batch() {
+    FRAMEWORK_LOG_FUNCTION();
+    for (auto* client : get_all_clients()) {
+        client->begin_publish_batch();
+    }
+}
+
+void MQTTAbstraction::end_publish_batch() {
+    FRAMEWORK_LOG_FUNCTION();
+    for (auto* client : get_all_clients()) {
+        client->end_publish_batch();
+    }
+}
+
+void MQTTAbstraction::set_publish_flush_policy(const PublishFlushPolicy& policy) {
+    FRAMEWORK_LOG_FUNCTION();
+    for (auto* client : get_all_clients()) {
+        client->set_publish_flush_policy(policy);
+    }
+}
+
+MQTTPayloadEncoding MQTTAbstraction::get_payload_encoding() const {
+    return mqtt_abstraction->get_payload_encoding();
 }
 
 void MQTTAbstraction::subscribe(const std::string& topic) {
-    BOOST_LOG_FUNCTION();
-    mqtt_abstraction->subscribe(topic);
+    FRAMEWORK_LOG_FUNCTION();
+    for (auto* client : get_clients(topic)) {
+        client->subscribe(topic);
+    }
 }
 
 void MQTTAbstraction::subscribe(const std::string& topic, QOS qos) {
-    BOOST_LOG_FUNCTION();
-    mqtt_abstraction->subscribe(topic, qos);
+    FRAMEWORK_LOG_FUNCTION();
+    for (auto* client : get_clients(topic)) {
+        client->subscribe(topic, qos);
+    }
 }
 
 void MQTTAbstraction::unsubscribe(const std::string& topic) {
-    BOOST_LOG_FUNCTION();
-    mqtt_abstraction->unsubscribe(topic);
+    FRAMEWORK_LOG_FUNCTION();
+    for (auto* client : get_clients(topic)) {
+        client->unsubscribe(topic);
+    }
 }
 
 json MQTTAbstraction::get(const std::string& topic, QOS qos) {
-    BOOST_LOG_FUNCTION();
-    return mqtt_abstraction->get(topic, qos);
+    FRAMEWORK_LOG_FUNCTION();
+    return get_client(topic).get(topic, qos);
 }
 
 const std::string& MQTTAbstraction::get_everest_prefix() const {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
     return everest_prefix;
 }
 
 const std::string& MQTTAbstraction::get_external_prefix() const {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
     return external_prefix;
 }
 
 std::shared_future<void> MQTTAbstraction::spawn_main_loop_thread() {
-    BOOST_LOG_FUNCTION();
-    return mqtt_abstraction->spawn_main_loop_thread();
+    FRAMEWORK_LOG_FUNCTION();
+    if (this->shard_clients.empty()) {
+        return mqtt_abstraction->spawn_main_loop_thread();
+    }
+    std::vector<std::shared_future<void>> main_loops;
+    for (auto* client : get_all_clients()) {
+        main_loops.push_back(client->spawn_main_loop_thread());
+    }
+    // waiting for the main loops ends as soon as one of them terminates, so losing a shard is noticed as well
+    auto terminated = std::make_shared<std::promise<void>>();
+    this->main_loop_future = terminated->get_future().share();
+    std::thread([main_loops = std::move(main_loops), terminated]() {
+        while (true) {
+            for (const auto& main_loop : main_loops) {
+                if (main_loop.wait_for(std::chrono::milliseconds(0)) != std::future_status::ready) {
+                    continue;
+                }
+                try {
+                    main_loop.get();
+                    terminated->set_value();
+                } catch (...) {
+                    terminated->set_exception(std::current_exception());
+                }
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }).detach();
+    return this->main_loop_future;
 }
 
 std::shared_future<void> MQTTAbstraction::get_main_loop_future() {
-    BOOST_LOG_FUNCTION();
-    return mqtt_abstraction->get_main_loop_future();
+    FRAMEWORK_LOG_FUNCTION();
+    if (this->shard_clients.empty()) {
+        return mqtt_abstraction->get_main_loop_future();
+    }
+    return this->main_loop_future;
+}
+
+EventLoop& MQTTAbstraction::get_event_loop() {
+    FRAMEWORK_LOG_FUNCTION();
+    return mqtt_abstraction->get_event_loop();
+}
+
+Executor& MQTTAbstraction::get_handler_executor() {
+    FRAMEWORK_LOG_FUNCTION();
+    return mqtt_abstraction->get_handler_executor();
 }
 
 void MQTTAbstraction::register_handler(const std::string& topic, std::shared_ptr<TypedHandler> handler, QOS qos) {
-    BOOST_LOG_FUNCTION();
-    mqtt_abstraction->register_handler(topic, handler, qos);
+    FRAMEWORK_LOG_FUNCTION();
+    // handlers are always registered with the main connection, which dispatches the messages of the shards
+    mqtt_abstraction->register_handler(topic, std::move(handler), qos);
+    for (auto* client : get_clients(topic)) {
+        if (client != mqtt_abstraction.get()) {
+            client->add_forwarded_subscription(topic, qos);
+        }
+    }
 }
 
 void MQTTAbstraction::unregister_handler(const std::string& topic, const Token& token) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
+    for (auto* client : get_clients(topic)) {
+        if (client != mqtt_abstraction.get()) {
+            client->remove_forwarded_subscription(topic);
+        }
+    }
     mqtt_abstraction->unregister_handler(topic, token);
 }
 
+MessagePoolStats MQTTAbstraction::get_message_pool_stats() {
+    FRAMEWORK_LOG_FUNCTION();
+    return mqtt_abstraction->get_message_pool_stats();
+}
+
+MQTTBufferStats MQTTAbstraction::get_buffer_stats() {
+    FRAMEWORK_LOG_FUNCTION();
+    return mqtt_abstraction->get_buffer_stats();
+}
+
+MQTTHandlerMemoryStats MQTTAbstraction::get_handler_memory_stats() {
+    FRAMEWORK_LOG_FUNCTION();
+    return mqtt_abstraction->get_handler_memory_stats();
+}
+
+MQTTQueueStats MQTTAbstraction::get_queue_stats() {
+    FRAMEWORK_LOG_FUNCTION();
+    return mqtt_abstraction->get_queue_stats();
+}
+
+std::map<std::string, DispatchMetrics> MQTTAbstraction::get_dispatch_metrics() {
+    FRAMEWORK_LOG_FUNCTION();
+    return mqtt_abstraction->get_dispatch_metrics();
+}
+
+MQTTDispatchMetricsSettings MQTTAbstraction::get_dispatch_metrics_settings() const {
+    return mqtt_abstraction->get_dispatch_metrics_settings();
+}
+
+bool MQTTAbstraction::is_var_cache_enabled() const {
+    FRAMEWORK_LOG_FUNCTION();
+    return mqtt_abstraction->is_var_cache_enabled();
+}
+
+void MQTTAbstraction::start_traffic_recording(const TrafficRecorderSettings& settings, const std::string& module_id) {
+    FRAMEWORK_LOG_FUNCTION();
+    if (this->traffic_recorder != nullptr or settings.file.empty()) {
+        return;
+    }
+    // shared by all connections, so the traffic of all brokers ends up in one recording
+    this->traffic_recorder = std::make_shared<TrafficRecorder>(settings, module_id);
+    for (auto* client : get_all_clients()) {
+        client->set_traffic_recorder(this->traffic_recorder);
+    }
+}
+
+std::map<std::string, std::vector<HandlerAccountingStats>> MQTTAbstraction::get_handler_accounting() {
+    FRAMEWORK_LOG_FUNCTION();
+    return mqtt_abstraction->get_handler_accounting();
+}
+
+MQTTAbstractionImpl& MQTTAbstraction::get_client(const std::string& topic) {
+    if (this->shard_clients.empty()) {
+        return *mqtt_abstraction;
+    }
+    const auto connection = get_broker_connection(this->broker_shards, topic);
+    return connection == 0 ? *mqtt_abstraction : *this->shard_clients.at(connection - 1);
+}
+
+std::vector<MQTTAbstractionImpl*> MQTTAbstraction::get_clients(const std::string& topic_filter) {
+    if (this->shard_clients.empty()) {
+        return {mqtt_abstraction.get()};
+    }
+    std::vector<MQTTAbstractionImpl*> clients;
+    for (const auto connection : get_broker_connections(this->broker_shards, topic_filter)) {
+        clients.push_back(connection == 0 ? mqtt_abstraction.get() : this->shard_clients.at(connection - 1).get());
+    }
+    return clients;
+}
+
+std::vector<MQTTAbstractionImpl*> MQTTAbstraction::get_all_clients() {
+    std::vector<MQTTAbstractionImpl*> clients{mqtt_abstraction.get()};
+    for (auto& shard_client : this->shard_clients) {
+        clients.push_back(shard_client.get());
+    }
+    return clients;
+}
+
+PublishBatch::PublishBatch(MQTTAbstraction& mqtt_abstraction) : mqtt_abstraction(mqtt_abstraction) {
+    this->mqtt_abstraction.begin_publish_batch();
+}
+
+PublishBatch::~PublishBatch() {
+    this->mqtt_abstraction.end_publish_batch();
+}
+
 } // namespace Everest
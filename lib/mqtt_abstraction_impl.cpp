@@ -12,6 +12,7 @@
 #include <netdb.h>
 #include <netinet/tcp.h>
 #include <poll.h>
+#include <sys/epoll.h>
 #include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <sys/un.h>
@@ -23,11 +24,39 @@
 #include <everest/exceptions.hpp>
 #include <everest/logging.hpp>
 
+#include <utils/flight_recorder.hpp>
+#include <utils/framework_log.hpp>
 #include <utils/mqtt_abstraction_impl.hpp>
+#include <utils/payload_encoding.hpp>
 
 namespace Everest {
 const auto mqtt_keep_alive = 600;
-const auto mqtt_get_timeout_ms = 5000; ///< Timeout for MQTT get in milliseconds
+// checking every quarter of the keep alive period ensures a ping at the latest after half of it without sending
+const auto mqtt_keep_alive_check_interval_s = mqtt_keep_alive / 4;
+const auto mqtt_reconnect_min_backoff = std::chrono::milliseconds(10);
+const auto mqtt_reconnect_max_backoff = std::chrono::milliseconds(500);
+const auto mqtt_get_timeout_ms = 5000;     ///< Timeout for MQTT get in milliseconds
+const auto mqtt_connect_timeout_ms = 1000; ///< Time the TCP connection to the broker may take to be established
+/// Number of publishes that may wait for the send buffer to grow, further ones are rejected
+const auto mqtt_max_deferred_publishes = std::size_t{1024};
+/// Capacity up to which the buffer json payloads are serialized into is kept for the next publish of the thread
+const auto mqtt_max_reused_payload_capacity = std::size_t{64 * 1024};
+
+namespace {
+/// Depth of the publish batches the calling thread has open by client, so a batch of one thread does not hold back
+/// the wakeups for the publishes of others
+thread_local std::unordered_map<const MQTTAbstractionImpl*, int> publish_batch_depths;
+
+/// \returns the pending error of the socket \p sockfd, e.g. of a non-blocking connect, 0 if there is none
+int get_socket_error(int sockfd) {
+    int error = 0;
+    socklen_t error_size = sizeof(error);
+    if (getsockopt(sockfd, SOL_SOCKET, SO_ERROR, &error, &error_size) == -1) {
+        return errno;
+    }
+    return error;
+}
+} // namespace
 
 MessageWithQOS::MessageWithQOS(const std::string& topic, const std::string& payload, QOS qos) :
     Message{topic, payload}, qos(qos) {
@@ -35,80 +64,125 @@ MessageWithQOS::MessageWithQOS(const std::string& topic, const std::string& payl
 
 MQTTAbstractionImpl::MQTTAbstractionImpl(const std::string& mqtt_server_address, const std::string& mqtt_server_port,
                                          const std::string& mqtt_everest_prefix,
-                                         const std::string& mqtt_external_prefix) :
-    message_queue(([this](const Message& message) { this->on_mqtt_message(message); })),
+                                         const std::string& mqtt_external_prefix,
+                                         const MQTTBufferSettings& buffer_settings,
+                                         const MQTTQueueSettings& queue_settings, MQTTAbstractionImpl* dispatcher) :
+    dispatcher(dispatcher),
+    queue_settings(queue_settings),
+    message_pool(MQTT_MESSAGE_POOL_SIZE, MQTT_MESSAGE_POOL_MAX_PAYLOAD_CAPACITY),
+    message_queue(([this](const Message& message) { this->on_mqtt_message(message); }), queue_settings.receive,
+                  [this](const PooledMessage& message) { return external_conflation_key(message->topic); },
+                  [this](const Message& message) { return classify_message(message.topic); }),
+    messages_before_connected(queue_settings.before_connected,
+                              [this](const std::shared_ptr<MessageWithQOS>& message) {
+                                  return external_conflation_key(message->topic);
+                              }),
     mqtt_server_address(mqtt_server_address),
     mqtt_server_port(mqtt_server_port),
     mqtt_everest_prefix(mqtt_everest_prefix),
     mqtt_external_prefix(mqtt_external_prefix),
     mqtt_client{},
-    sendbuf{},
-    recvbuf{} {
-    BOOST_LOG_FUNCTION();
+    buffer_settings(buffer_settings),
+    sendbuf(new uint8_t[buffer_settings.send_buffer_size]),
+    recvbuf(new uint8_t[buffer_settings.recv_buffer_size]),
+    sendbuf_size(buffer_settings.send_buffer_size),
+    recvbuf_size(buffer_settings.recv_buffer_size),
+    handler_executor(dispatcher != nullptr
+                         ? nullptr
+                         : std::make_unique<Executor>(Executor::default_thread_count(),
+                                                      MQTT_HANDLER_EXECUTOR_MAX_THREADS)) {
+    FRAMEWORK_LOG_FUNCTION();
 
     EVLOG_debug << "Initializing MQTT abstraction layer...";
 
     this->mqtt_is_connected = false;
 
-    this->mqtt_client.publish_response_callback_state = &this->message_queue;
+    this->mqtt_client.publish_response_callback_state = this;
 
     this->disconnect_event_fd = eventfd(0, 0);
     if (this->disconnect_event_fd == -1) {
         throw EverestInternalError("Could not setup eventfd for disconnect event");
     }
+
+    setup_shm_transport();
 }
 
 MQTTAbstractionImpl::MQTTAbstractionImpl(const std::string& mqtt_server_socket_path,
                                          const std::string& mqtt_everest_prefix,
-                                         const std::string& mqtt_external_prefix) :
-    message_queue(([this](const Message& message) { this->on_mqtt_message(message); })),
+                                         const std::string& mqtt_external_prefix,
+                                         const MQTTBufferSettings& buffer_settings,
+                                         const MQTTQueueSettings& queue_settings, MQTTAbstractionImpl* dispatcher) :
+    dispatcher(dispatcher),
+    queue_settings(queue_settings),
+    message_pool(MQTT_MESSAGE_POOL_SIZE, MQTT_MESSAGE_POOL_MAX_PAYLOAD_CAPACITY),
+    message_queue(([this](const Message& message) { this->on_mqtt_message(message); }), queue_settings.receive,
+                  [this](const PooledMessage& message) { return external_conflation_key(message->topic); },
+                  [this](const Message& message) { return classify_message(message.topic); }),
+    messages_before_connected(queue_settings.before_connected,
+                              [this](const std::shared_ptr<MessageWithQOS>& message) {
+                                  return external_conflation_key(message->topic);
+                              }),
     mqtt_server_socket_path(mqtt_server_socket_path),
     mqtt_everest_prefix(mqtt_everest_prefix),
     mqtt_external_prefix(mqtt_external_prefix),
     mqtt_client{},
-    sendbuf{},
-    recvbuf{} {
-    BOOST_LOG_FUNCTION();
+    buffer_settings(buffer_settings),
+    sendbuf(new uint8_t[buffer_settings.send_buffer_size]),
+    recvbuf(new uint8_t[buffer_settings.recv_buffer_size]),
+    sendbuf_size(buffer_settings.send_buffer_size),
+    recvbuf_size(buffer_settings.recv_buffer_size),
+    handler_executor(dispatcher != nullptr
+                         ? nullptr
+                         : std::make_unique<Executor>(Executor::default_thread_count(),
+                                                      MQTT_HANDLER_EXECUTOR_MAX_THREADS)) {
+    FRAMEWORK_LOG_FUNCTION();
 
     EVLOG_debug << "Initializing MQTT abstraction layer...";
 
     this->mqtt_is_connected = false;
 
-    this->mqtt_client.publish_response_callback_state = &this->message_queue;
+    this->mqtt_client.publish_response_callback_state = this;
 
     this->disconnect_event_fd = eventfd(0, 0);
     if (this->disconnect_event_fd == -1) {
         throw EverestInternalError("Could not setup eventfd for disconnect event");
     }
+
+    setup_shm_transport();
 }
 
 MQTTAbstractionImpl::~MQTTAbstractionImpl() {
+    if (this->handler_accounting_settings.enabled) {
+        log_handler_accounting_report();
+    }
     // FIXME (aw): verify that disconnecting is thread-safe!
     if (this->mqtt_is_connected) {
         disconnect();
     }
     // this->mqtt_mainloop_thread.join();
+    // no handler task is posted anymore once the dispatching thread stopped, the ones still running are joined when
+    // the executor is destroyed before the other members
+    this->message_queue.stop();
 }
 
 bool MQTTAbstractionImpl::connect() {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
     if (this->mqtt_is_connected) {
         return true;
     }
 
     if (!this->mqtt_server_socket_path.empty()) {
-        EVLOG_debug << fmt::format("Connecting to MQTT broker: {}", this->mqtt_server_socket_path);
+        FRAMEWORK_LOG_DEBUG("Connecting to MQTT broker: {}", this->mqtt_server_socket_path);
         return connectBroker(this->mqtt_server_socket_path);
     } else {
-        EVLOG_debug << fmt::format("Connecting to MQTT broker: {}:{}", this->mqtt_server_address,
-                                   this->mqtt_server_port);
+        FRAMEWORK_LOG_DEBUG("Connecting to MQTT broker: {}:{}", this->mqtt_server_address, this->mqtt_server_port);
         return connectBroker(this->mqtt_server_address.c_str(), this->mqtt_server_port.c_str());
     }
 }
 
 void MQTTAbstractionImpl::disconnect() {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
     mqtt_disconnect(&this->mqtt_client);
     // FIXME(kai): always set connected to false for the moment
@@ -117,25 +191,48 @@ void MQTTAbstractionImpl::disconnect() {
 }
 
 void MQTTAbstractionImpl::publish(const std::string& topic, const json& json) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
     publish(topic, json, QOS::QOS2);
 }
 
 void MQTTAbstractionImpl::publish(const std::string& topic, const json& json, QOS qos, bool retain) {
-    BOOST_LOG_FUNCTION();
-
-    publish(topic, json.dump(), qos, retain);
+    FRAMEWORK_LOG_FUNCTION();
+
+    // serialized into a buffer reused by all publishes of this thread, the message is copied into the send buffer or
+    // queued by the publish below anyway, so a new string per message is not needed
+    thread_local std::string payload;
+    // retained messages are kept as JSON, since they are mostly read by external tools
+    const auto encoding = not retain and topic.find(this->mqtt_everest_prefix) == 0 ? this->payload_encoding.load()
+                                                                                    : MQTTPayloadEncoding::Json;
+    encode_payload(json, encoding, payload);
+    publish(topic, payload, qos, retain);
+    if (payload.capacity() > mqtt_max_reused_payload_capacity) {
+        // a single large message does not keep its buffer for the lifetime of the thread
+        std::string().swap(payload);
+    }
 }
 
 void MQTTAbstractionImpl::publish(const std::string& topic, const std::string& data) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
     publish(topic, data, QOS::QOS0);
 }
 
 void MQTTAbstractionImpl::publish(const std::string& topic, const std::string& data, QOS qos, bool retain) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
+
+    publish_raw(topic, data, qos, retain);
+}
+
+void MQTTAbstractionImpl::publish_raw(const std::string& topic, std::string_view data, QOS qos, bool retain) {
+    FRAMEWORK_LOG_FUNCTION();
+
+    FlightRecorder::get().record(FlightEvent::Publish, HandlerType::Unknown, topic, {}, {});
+    auto* recorder = this->active_traffic_recorder.load(std::memory_order_acquire);
+    if (recorder != nullptr and topic.rfind(this->mqtt_everest_prefix, 0) == 0) {
+        recorder->record(TrafficDirection::Published, topic, data);
+    }
 
     auto publish_flags = 0;
     switch (qos) {
@@ -157,29 +254,113 @@ void MQTTAbstractionImpl::publish(const std::string& topic, const std::string& d
         publish_flags |= MQTT_PUBLISH_RETAIN;
     }
 
+    // all modules subscribing to a topic received via shared memory are in the segment, so the broker is only needed
+    // for topics without subscribed slots, this also does not depend on the broker connection
+    auto* shm = (this->dispatcher != nullptr) ? this->dispatcher->shm_transport.get() : this->shm_transport.get();
+    if (shm != nullptr and not retain and is_shm_topic(topic) and shm->publish(topic, data)) {
+        FRAMEWORK_LOG_VERBOSE("publishing to {} via shared memory", topic);
+        return;
+    }
+
     if (!this->mqtt_is_connected) {
-        const std::lock_guard<std::mutex> lock(messages_before_connected_mutex);
-        this->messages_before_connected.push_back(std::make_shared<MessageWithQOS>(topic, data, qos));
+        std::unique_lock<std::mutex> lock(messages_before_connected_mutex);
+        if (!this->mqtt_is_connected) {
+            lock.unlock();
+            // the queue is closed once connected, publish directly if the connection has been established meanwhile
+            if (this->messages_before_connected.push(std::make_shared<MessageWithQOS>(topic, std::string(data), qos)) or
+                !this->mqtt_is_connected) {
+                return;
+            }
+        }
+    }
+
+    const auto message_size = topic.size() + data.size();
+    if (message_size > this->largest_sent_message) {
+        this->largest_sent_message = message_size;
+    }
+    // the send buffer is only grown by the event loop, once MQTT-C is done with the messages queued in it, so
+    // publishes not fitting into it wait there, in order with the publishes following them
+    if (this->buffer_settings.growable and
+        (this->deferred_publishes_pending or send_buffer_required_size(message_size) > this->sendbuf_size)) {
+        defer_publish(topic, data, static_cast<std::uint8_t>(publish_flags));
         return;
     }
 
-    const MQTTErrors error = mqtt_publish(&this->mqtt_client, topic.c_str(), data.c_str(), data.size(), publish_flags);
+    const MQTTErrors error = mqtt_publish(&this->mqtt_client, topic.c_str(), data.data(), data.size(), publish_flags);
+    if (error == MQTT_ERROR_SEND_BUFFER_IS_FULL and this->buffer_settings.growable) {
+        // MQTT-C refuses all further publishes until this error is reset
+        MQTT_PAL_MUTEX_LOCK(&this->mqtt_client.mutex);
+        this->mqtt_client.error = MQTT_OK;
+        MQTT_PAL_MUTEX_UNLOCK(&this->mqtt_client.mutex);
+        defer_publish(topic, data, static_cast<std::uint8_t>(publish_flags));
+        return;
+    }
     if (error != MQTT_OK) {
         EVLOG_error << fmt::format("MQTT Error {}", mqtt_error_str(error));
     }
-    notify_write_data();
+    notify_published_data();
+
+    FRAMEWORK_LOG_VERBOSE("publishing to {}", topic);
+}
+
+void MQTTAbstractionImpl::begin_publish_batch() {
+    publish_batch_depths[this]++;
+}
+
+void MQTTAbstractionImpl::end_publish_batch() {
+    const auto depth = publish_batch_depths.find(this);
+    if (depth == publish_batch_depths.end() or --depth->second > 0) {
+        return;
+    }
+    publish_batch_depths.erase(depth);
+    if (this->publish_notification_pending.exchange(false)) {
+        notify_write_data();
+    }
+}
+
+void MQTTAbstractionImpl::set_publish_flush_policy(const PublishFlushPolicy& policy) {
+    this->publish_coalesce_window_us = policy.coalesce_window.count();
+}
+
+void MQTTAbstractionImpl::set_payload_encoding(MQTTPayloadEncoding encoding) {
+    FRAMEWORK_LOG_FUNCTION();
+
+    this->payload_encoding = encoding;
+}
+
+MQTTPayloadEncoding MQTTAbstractionImpl::get_payload_encoding() const {
+    return this->payload_encoding;
+}
+
+void MQTTAbstractionImpl::set_dispatch_metrics_settings(const MQTTDispatchMetricsSettings& settings) {
+    FRAMEWORK_LOG_FUNCTION();
+
+    this->dispatch_metrics_settings = settings;
+}
 
-    EVLOG_verbose << fmt::format("publishing to {}", topic);
+MQTTDispatchMetricsSettings MQTTAbstractionImpl::get_dispatch_metrics_settings() const {
+    return this->dispatch_metrics_settings;
+}
+
+void MQTTAbstractionImpl::set_traffic_recorder(std::shared_ptr<TrafficRecorder> recorder) {
+    FRAMEWORK_LOG_FUNCTION();
+
+    const std::lock_guard<std::mutex> lock(this->traffic_recorder_mutex);
+    if (this->traffic_recorder != nullptr) {
+        return;
+    }
+    this->traffic_recorder = std::move(recorder);
+    this->active_traffic_recorder.store(this->traffic_recorder.get(), std::memory_order_release);
 }
 
 void MQTTAbstractionImpl::subscribe(const std::string& topic) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
     subscribe(topic, QOS::QOS2);
 }
 
 void MQTTAbstractionImpl::subscribe(const std::string& topic, QOS qos) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
     auto max_qos_level = 0;
     switch (qos) {
@@ -201,14 +382,14 @@ void MQTTAbstractionImpl::subscribe(const std::string& topic, QOS qos) {
 }
 
 void MQTTAbstractionImpl::unsubscribe(const std::string& topic) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
     mqtt_unsubscribe(&this->mqtt_client, topic.c_str());
     notify_write_data();
 }
 
 json MQTTAbstractionImpl::get(const std::string& topic, QOS qos) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
     std::promise<json> res_promise;
     std::future<json> res_future = res_promise.get_future();
 
@@ -241,58 +422,408 @@ json MQTTAbstractionImpl::get(const std::string& topic, QOS qos) {
     return result;
 }
 
+void MQTTAbstractionImpl::set_handler_accounting_settings(const MQTTHandlerAccountingSettings& settings) {
+    FRAMEWORK_LOG_FUNCTION();
+
+    this->handler_accounting_settings = settings;
+}
+
+void MQTTAbstractionImpl::set_var_cache_enabled(bool enabled) {
+    FRAMEWORK_LOG_FUNCTION();
+    this->var_cache_enabled = enabled;
+}
+
+bool MQTTAbstractionImpl::is_var_cache_enabled() const {
+    return this->var_cache_enabled;
+}
+
+void MQTTAbstractionImpl::setup_shm_transport() {
+    if (this->dispatcher != nullptr) {
+        // the slot of this module is received by its main broker connection
+        return;
+    }
+    this->shm_transport = ShmTransport::attach_from_env();
+    if (this->shm_transport == nullptr) {
+        return;
+    }
+
+    EVLOG_debug << "Using shared memory transport for cmd and var topics";
+    this->shm_transport->start_receiving(
+        [this](const char* topic, std::size_t topic_size, const char* payload, std::size_t payload_size) {
+            this->receive_message(topic, topic_size, payload, payload_size);
+        });
+}
+
+void MQTTAbstractionImpl::receive_message(const char* topic, std::size_t topic_size, const char* payload,
+                                          std::size_t payload_size) {
+    if (this->dispatcher != nullptr) {
+        this->dispatcher->receive_message(topic, topic_size, payload, payload_size);
+        return;
+    }
+    auto message = this->message_pool.acquire(topic, topic_size, payload, payload_size);
+    if (this->dispatch_metrics_settings.enabled) {
+        message->received = std::chrono::steady_clock::now();
+    }
+    auto* recorder = this->active_traffic_recorder.load(std::memory_order_acquire);
+    if (recorder != nullptr and message->topic.rfind(this->mqtt_everest_prefix, 0) == 0) {
+        recorder->record(TrafficDirection::Received, message->topic, message->payload);
+    }
+    this->message_queue.add(std::move(message));
+}
+
+TopicTrie& MQTTAbstractionImpl::get_wildcard_handler_topics(const std::string& topic) {
+    if (topic.rfind(this->mqtt_everest_prefix, 0) == 0) {
+        return this->everest_wildcard_handler_topics;
+    }
+    return this->wildcard_handler_topics;
+}
+
+bool MQTTAbstractionImpl::receives_via_shm(const std::string& topic) {
+    const std::lock_guard<std::mutex> lock(handlers_mutex);
+    return this->shm_topics.count(topic) != 0;
+}
+
+bool MQTTAbstractionImpl::is_shm_topic(const std::string& topic) const {
+    const auto ends_with = [&topic](const std::string& suffix) {
+        return topic.size() >= suffix.size() and
+               topic.compare(topic.size() - suffix.size(), suffix.size(), suffix) == 0;
+    };
+    return topic.rfind(this->mqtt_everest_prefix, 0) == 0 and not contains_wildcards(topic) and
+           (ends_with("/cmd") or ends_with("/var") or ends_with("/res"));
+}
+
 void MQTTAbstractionImpl::notify_write_data() {
     // FIXME (aw): error handling
     eventfd_write(this->event_fd, 1);
 }
 
+std::size_t MQTTAbstractionImpl::send_buffer_required_size(std::size_t message_size) {
+    // fixed header, topic length and packet id of a publish packet plus the bookkeeping MQTT-C keeps per message,
+    // which is also needed for the end of the queue
+    return message_size + 16 + 2 * sizeof(struct mqtt_queued_message);
+}
+
+void MQTTAbstractionImpl::defer_publish(const std::string& topic, std::string_view data, std::uint8_t flags) {
+    const auto required_size = send_buffer_required_size(topic.size() + data.size());
+    {
+        const std::lock_guard<std::mutex> lock(this->deferred_publishes_mutex);
+        if (required_size <= MQTT_MAX_BUF_SIZE and this->deferred_publishes.size() < mqtt_max_deferred_publishes) {
+            this->deferred_publishes.push_back({topic, std::string(data), flags});
+            this->deferred_publishes_required_size = std::max(this->deferred_publishes_required_size, required_size);
+            this->deferred_publishes_pending = true;
+            notify_write_data();
+            return;
+        }
+    }
+    this->send_buffer_rejections++;
+    EVLOG_error << fmt::format("MQTT send buffer cannot take message of {} bytes on {}, dropping it",
+                               topic.size() + data.size(), topic);
+}
+
+void MQTTAbstractionImpl::publish_deferred() {
+    if (not this->deferred_publishes_pending) {
+        return;
+    }
+
+    const std::lock_guard<std::mutex> lock(this->deferred_publishes_mutex);
+    MQTT_PAL_MUTEX_LOCK(&this->mqtt_client.mutex);
+    auto& mq = this->mqtt_client.mq;
+    mqtt_mq_clean(&mq);
+    if (this->sendbuf_size < this->deferred_publishes_required_size) {
+        if (mqtt_mq_length(&mq) != 0) {
+            // the buffer can only be replaced once MQTT-C is done with all messages queued in it, which is checked
+            // again on the next sync
+            MQTT_PAL_MUTEX_UNLOCK(&this->mqtt_client.mutex);
+            return;
+        }
+        const auto new_size =
+            std::min(std::max(this->sendbuf_size * 2, this->deferred_publishes_required_size), MQTT_MAX_BUF_SIZE);
+        FRAMEWORK_LOG_DEBUG("Growing MQTT send buffer from {} to {} bytes", this->sendbuf_size, new_size);
+        this->sendbuf = std::unique_ptr<uint8_t[]>(new uint8_t[new_size]);
+        this->sendbuf_size = new_size;
+        mqtt_mq_init(&mq, this->sendbuf.get(), new_size);
+        this->send_buffer_grows++;
+    }
+    MQTT_PAL_MUTEX_UNLOCK(&this->mqtt_client.mutex);
+
+    auto published = false;
+    while (not this->deferred_publishes.empty()) {
+        const auto& message = this->deferred_publishes.front();
+        const MQTTErrors error = mqtt_publish(&this->mqtt_client, message.topic.c_str(), message.data.data(),
+                                              message.data.size(), message.flags);
+        if (error == MQTT_ERROR_SEND_BUFFER_IS_FULL) {
+            // the remaining messages fit once the queued ones have been sent
+            MQTT_PAL_MUTEX_LOCK(&this->mqtt_client.mutex);
+            this->mqtt_client.error = MQTT_OK;
+            MQTT_PAL_MUTEX_UNLOCK(&this->mqtt_client.mutex);
+            break;
+        }
+        if (error != MQTT_OK) {
+            EVLOG_error << fmt::format("MQTT Error {}", mqtt_error_str(error));
+        }
+        published = true;
+        this->deferred_publishes.pop_front();
+    }
+    if (this->deferred_publishes.empty()) {
+        this->deferred_publishes_required_size = 0;
+        this->deferred_publishes_pending = false;
+    }
+    if (published) {
+        // send the published messages with the next sync, which also continues with the remaining ones
+        notify_write_data();
+    }
+}
+
+bool MQTTAbstractionImpl::grow_recv_buffer() {
+    auto& recv_buffer = this->mqtt_client.recv_buffer;
+
+    MQTT_PAL_MUTEX_LOCK(&this->mqtt_client.mutex);
+    const auto new_size = this->recvbuf_size * 2;
+    if (new_size > MQTT_MAX_BUF_SIZE) {
+        MQTT_PAL_MUTEX_UNLOCK(&this->mqtt_client.mutex);
+        return false;
+    }
+    FRAMEWORK_LOG_DEBUG("Growing MQTT receive buffer from {} to {} bytes", this->recvbuf_size, new_size);
+
+    // keep the already received part of the message that did not fit
+    const auto used_size = static_cast<std::size_t>(recv_buffer.curr - recv_buffer.mem_start);
+    auto new_recvbuf = std::unique_ptr<uint8_t[]>(new uint8_t[new_size]);
+    std::memcpy(new_recvbuf.get(), recv_buffer.mem_start, used_size);
+    this->recvbuf = std::move(new_recvbuf);
+    this->recvbuf_size = new_size;
+
+    recv_buffer.mem_start = this->recvbuf.get();
+    recv_buffer.mem_size = new_size;
+    recv_buffer.curr = recv_buffer.mem_start + used_size;
+    recv_buffer.curr_sz = new_size - used_size;
+    this->mqtt_client.error = MQTT_OK;
+    this->recv_buffer_grows++;
+    MQTT_PAL_MUTEX_UNLOCK(&this->mqtt_client.mutex);
+    return true;
+}
+
+void MQTTAbstractionImpl::shrink_buffers() {
+    if (this->deferred_publishes_pending) {
+        // the send buffer has just been grown for them
+        return;
+    }
+    if (this->sendbuf_size <= this->buffer_settings.send_buffer_size and
+        this->recvbuf_size <= this->buffer_settings.recv_buffer_size) {
+        return;
+    }
+
+    MQTT_PAL_MUTEX_LOCK(&this->mqtt_client.mutex);
+    auto& recv_buffer = this->mqtt_client.recv_buffer;
+    if (this->recvbuf_size > this->buffer_settings.recv_buffer_size and recv_buffer.curr == recv_buffer.mem_start) {
+        this->recvbuf = std::unique_ptr<uint8_t[]>(new uint8_t[this->buffer_settings.recv_buffer_size]);
+        this->recvbuf_size = this->buffer_settings.recv_buffer_size;
+        recv_buffer.mem_start = this->recvbuf.get();
+        recv_buffer.mem_size = this->recvbuf_size;
+        recv_buffer.curr = recv_buffer.mem_start;
+        recv_buffer.curr_sz = this->recvbuf_size;
+    }
+
+    auto& mq = this->mqtt_client.mq;
+    if (this->sendbuf_size > this->buffer_settings.send_buffer_size) {
+        mqtt_mq_clean(&mq);
+        if (mqtt_mq_length(&mq) == 0) {
+            this->sendbuf = std::unique_ptr<uint8_t[]>(new uint8_t[this->buffer_settings.send_buffer_size]);
+            this->sendbuf_size = this->buffer_settings.send_buffer_size;
+            mqtt_mq_init(&mq, this->sendbuf.get(), this->sendbuf_size);
+        }
+    }
+    MQTT_PAL_MUTEX_UNLOCK(&this->mqtt_client.mutex);
+}
+
+MQTTQueueStats MQTTAbstractionImpl::get_queue_stats() {
+    FRAMEWORK_LOG_FUNCTION();
+
+    MQTTQueueStats stats{this->message_queue.get_stats(), {}, this->messages_before_connected.get_stats()};
+    const std::lock_guard<std::mutex> lock(handlers_mutex);
+    for (const auto& [topic, handler] : this->message_handlers) {
+        stats.handler += handler->get_stats();
+    }
+    return stats;
+}
+
+std::map<std::string, DispatchMetrics> MQTTAbstractionImpl::get_dispatch_metrics() {
+    FRAMEWORK_LOG_FUNCTION();
+
+    std::map<std::string, DispatchMetrics> metrics;
+    const std::lock_guard<std::mutex> lock(handlers_mutex);
+    for (const auto& [topic, handler] : this->message_handlers) {
+        metrics.emplace(topic, handler->get_metrics());
+    }
+    return metrics;
+}
+
+std::map<std::string, std::vector<HandlerAccountingStats>> MQTTAbstractionImpl::get_handler_accounting() {
+    FRAMEWORK_LOG_FUNCTION();
+
+    std::map<std::string, std::vector<HandlerAccountingStats>> accounting;
+    const std::lock_guard<std::mutex> lock(handlers_mutex);
+    for (const auto& [topic, handler] : this->message_handlers) {
+        auto stats = handler->get_handler_accounting();
+        if (not stats.empty()) {
+            accounting.emplace(topic, std::move(stats));
+        }
+    }
+    return accounting;
+}
+
+void MQTTAbstractionImpl::check_handler_budgets() {
+    const auto now = std::chrono::steady_clock::now();
+    const std::lock_guard<std::mutex> lock(handlers_mutex);
+    for (const auto& [topic, handler] : this->message_handlers) {
+        handler->check_handler_budget(topic, now);
+    }
+}
+
+void MQTTAbstractionImpl::log_handler_accounting_report() {
+    constexpr auto max_reported_handlers = std::size_t{20};
+    std::vector<std::pair<std::string, HandlerAccountingStats>> handlers;
+    for (auto& [topic, topic_stats] : get_handler_accounting()) {
+        for (auto& stats : topic_stats) {
+            if (stats.calls > 0) {
+                handlers.emplace_back(topic, std::move(stats));
+            }
+        }
+    }
+    if (handlers.empty()) {
+        return;
+    }
+    std::sort(handlers.begin(), handlers.end(),
+              [](const auto& lhs, const auto& rhs) { return lhs.second.cpu > rhs.second.cpu; });
+
+    const auto ms = [](std::chrono::nanoseconds duration) { return duration.count() / 1000000.0; };
+    std::string report;
+    for (std::size_t i = 0; i < std::min(handlers.size(), max_reported_handlers); i++) {
+        const auto& [topic, stats] = handlers.at(i);
+        report += fmt::format("\n  {} {} '{}': {} calls, {:.1f} ms CPU, {:.1f} ms wall, {:.1f} ms max, {} over budget",
+                              topic, handler_type_to_string(stats.type), stats.name, stats.calls, ms(stats.cpu),
+                              ms(stats.wall), ms(stats.max_wall), stats.over_budget);
+    }
+    EVLOG_info << fmt::format("Time spent in the {} most expensive of {} handlers:{}",
+                              std::min(handlers.size(), max_reported_handlers), handlers.size(), report);
+}
+
+std::string MQTTAbstractionImpl::external_conflation_key(const std::string& topic) const {
+    // everest topics multiplex several vars and cmds, so they can only be conflated once parsed
+    if (topic.find(this->mqtt_everest_prefix) == 0) {
+        return "";
+    }
+    return topic;
+}
+
+MessagePriority MQTTAbstractionImpl::classify_message(const std::string& topic) const {
+    if (topic.find(this->mqtt_everest_prefix) != 0) {
+        return MessagePriority::External;
+    }
+    // calls arrive on the cmd topic of an implementation, cancellations on the control topic next to it and results
+    // on the res topic of the calling module
+    if (boost::algorithm::ends_with(topic, "/cmd") or boost::algorithm::ends_with(topic, "/cmd/control") or
+        boost::algorithm::ends_with(topic, "/res")) {
+        return MessagePriority::Command;
+    }
+    if (boost::algorithm::ends_with(topic, "/var")) {
+        return MessagePriority::Var;
+    }
+    return MessagePriority::Lifecycle;
+}
+
+MQTTBufferStats MQTTAbstractionImpl::get_buffer_stats() {
+    MQTTBufferStats stats{};
+    stats.send_buffer_size = this->sendbuf_size;
+    stats.recv_buffer_size = this->recvbuf_size;
+    stats.largest_sent_message = this->largest_sent_message;
+    stats.largest_received_message = this->largest_received_message;
+    stats.send_buffer_grows = this->send_buffer_grows;
+    stats.recv_buffer_grows = this->recv_buffer_grows;
+    stats.send_buffer_rejections = this->send_buffer_rejections;
+    return stats;
+}
+
+MQTTHandlerMemoryStats MQTTAbstractionImpl::get_handler_memory_stats() {
+    FRAMEWORK_LOG_FUNCTION();
+
+    MQTTHandlerMemoryStats stats;
+    const std::lock_guard<std::mutex> lock(handlers_mutex);
+    for (const auto& [topic, handler] : this->message_handlers) {
+        const auto handlers = handler->count_handlers();
+        stats.topics++;
+        stats.handlers += handlers;
+        // the handler list of a topic is an immutable snapshot, which is copied when handlers are added or removed
+        stats.bytes += sizeof(MessageHandler) + topic.capacity() + handlers * (sizeof(TypedHandler) + sizeof(Token));
+    }
+    return stats;
+}
+
+void MQTTAbstractionImpl::notify_published_data() {
+    // messages published inside of a batch are already queued in the send buffer, the main loop is woken up once the
+    // batch has ended
+    if (publish_batch_depths.find(this) != publish_batch_depths.end()) {
+        this->publish_notification_pending = true;
+        return;
+    }
+    notify_write_data();
+}
+
 std::shared_future<void> MQTTAbstractionImpl::spawn_main_loop_thread() {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
     std::packaged_task<void(void)> task([this]() {
         try {
-            while (this->mqtt_is_connected) {
-
+            watch_broker_socket();
+            const auto write_notification_id = this->event_loop.add_fd(this->event_fd, EPOLLIN, [this](std::uint32_t) {
                 eventfd_t eventfd_buffer;
-                const int nfds = 3;
-                struct pollfd pollfds[nfds] = {{this->mqtt_socket_fd, POLLIN, 0},
-                                               {this->event_fd, POLLIN, 0},
-                                               {this->disconnect_event_fd, POLLIN, 0}};
-                auto retval = ::poll(pollfds, nfds, mqtt_poll_timeout_ms);
-
-                if (retval >= 0) {
-                    // data available to send (the notifier writes, we should be ready to read)
-                    if (retval > 0) {
-                        // check for disconnect event
-                        if (pollfds[2].revents & POLLIN) {
-                            break;
-                        }
-                        // check for write notification and reset it
-                        if (pollfds[1].revents & POLLIN) {
-                            // FIXME (aw): check for failure
-                            eventfd_read(this->event_fd, &eventfd_buffer);
-                        }
-                    }
-
-                    if (retval == 0) {
-                        // nothing to send or receive however, need to send the keep alive message
-                        // otherwise the brocker will disconnect the client
-                        // mqtt_sync might send this automatically but ocasionally might miss it
+                // FIXME (aw): check for failure
+                eventfd_read(this->event_fd, &eventfd_buffer);
+                // give further publishes the chance to end up in the same sync if configured, without holding up
+                // the other events of the loop meanwhile
+                const auto coalesce_window_us = this->publish_coalesce_window_us.load();
+                if (coalesce_window_us <= 0) {
+                    sync();
+                } else if (this->publish_flush_timer_id == 0) {
+                    this->publish_flush_timer_id = this->event_loop.add_timer(
+                        std::chrono::microseconds(coalesce_window_us),
+                        [this]() {
+                            this->publish_flush_timer_id = 0;
+                            sync();
+                        },
+                        false);
+                }
+            });
+            const auto disconnect_id = this->event_loop.add_fd(this->disconnect_event_fd, EPOLLIN,
+                                                               [this](std::uint32_t) { this->event_loop.stop(); });
+            const auto keep_alive_id =
+                this->event_loop.add_timer(std::chrono::seconds(mqtt_keep_alive_check_interval_s), [this]() {
+                    // the broker disconnects clients that did not send anything within the keep alive period, so
+                    // ping in time if nothing else has been sent, mqtt_sync also handles resending unacknowledged
+                    // messages
+                    if (not this->reconnecting and
+                        MQTT_PAL_TIME() - this->mqtt_client.time_of_last_send >= mqtt_keep_alive_check_interval_s) {
                         mqtt_ping(&this->mqtt_client);
                     }
+                    sync();
+                });
+
+            const auto handler_budget = this->handler_accounting_settings.budget;
+            EventLoop::Id handler_watchdog_id = 0;
+            if (this->handler_accounting_settings.enabled and handler_budget.count() > 0) {
+                // check twice per budget, so a blocked handler is reported at most half a budget late
+                handler_watchdog_id = this->event_loop.add_timer(
+                    std::max(handler_budget / 2, std::chrono::milliseconds(1)), [this]() { check_handler_budgets(); });
+            }
 
-                    // send and receive messages
-                    const MQTTErrors error = mqtt_sync(&this->mqtt_client);
-                    if (error != MQTT_OK) {
-                        EVLOG_error << fmt::format("Error during MQTT sync: {}", mqtt_error_str(error));
-
-                        on_mqtt_disconnect();
+            if (this->mqtt_is_connected) {
+                this->event_loop.run();
+            }
 
-                        return;
-                    }
-                } else {
-                    // probably we got hit by a signal, nothing to do, just reloop
-                }
+            for (const auto id :
+                 {this->broker_socket_event_id.load(), this->reconnect_timer_id.load(),
+                  this->connect_socket_event_id.load(), write_notification_id, disconnect_id, keep_alive_id,
+                  handler_watchdog_id, this->publish_flush_timer_id}) {
+                this->event_loop.remove(id);
             }
         } catch (boost::exception& e) {
             EVLOG_critical << fmt::format("Caught MQTT mainloop boost::exception:\n{}",
@@ -310,64 +841,258 @@ std::shared_future<void> MQTTAbstractionImpl::spawn_main_loop_thread() {
     return this->main_loop_future;
 }
 
+void MQTTAbstractionImpl::sync() {
+    if (this->reconnecting) {
+        return;
+    }
+
+    const MQTTErrors error = mqtt_sync(&this->mqtt_client);
+    if (error == MQTT_ERROR_RECV_BUFFER_TOO_SMALL and this->buffer_settings.growable and grow_recv_buffer()) {
+        // the partially received message has been kept, continue receiving it
+        sync();
+        return;
+    }
+    if (error != MQTT_OK) {
+        EVLOG_error << fmt::format("Error during MQTT sync: {}", mqtt_error_str(error));
+
+        on_mqtt_disconnect();
+        return;
+    }
+    if (this->buffer_settings.growable) {
+        publish_deferred();
+        shrink_buffers();
+    }
+}
+
+void MQTTAbstractionImpl::watch_broker_socket() {
+    this->broker_socket_event_id = this->event_loop.add_fd(this->mqtt_socket_fd, EPOLLIN, [this](std::uint32_t) {
+        // send and receive messages
+        sync();
+    });
+}
+
+void MQTTAbstractionImpl::schedule_reconnect(std::chrono::milliseconds backoff) {
+    this->reconnect_timer_id = this->event_loop.add_timer(
+        backoff,
+        [this, backoff]() {
+            this->reconnect_timer_id = 0;
+            try_reconnect(backoff);
+        },
+        false);
+}
+
+void MQTTAbstractionImpl::try_reconnect(std::chrono::milliseconds backoff) {
+    FRAMEWORK_LOG_FUNCTION();
+
+    const auto retry = [this, backoff]() { schedule_reconnect(std::min(backoff * 2, mqtt_reconnect_max_backoff)); };
+
+    if (!this->mqtt_server_socket_path.empty()) {
+        const auto socket_fd = open_unix_socket(this->mqtt_server_socket_path);
+        if (socket_fd == -1) {
+            report_reconnect_failure(strerror(errno));
+            retry();
+        } else if (not complete_reconnect(socket_fd)) {
+            retry();
+        }
+        return;
+    }
+
+    const auto socket_fd = open_nb_socket(this->mqtt_server_address.c_str(), this->mqtt_server_port.c_str(), false);
+    if (socket_fd == -1) {
+        report_reconnect_failure(strerror(errno));
+        retry();
+        return;
+    }
+    int enable = 1;
+    setsockopt(socket_fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+    // the socket becomes writable once the connection has been established or failed, the event loop keeps
+    // dispatching meanwhile
+    const auto stop_waiting = [this]() {
+        this->event_loop.remove(this->connect_socket_event_id);
+        this->connect_socket_event_id = 0;
+        this->event_loop.remove(this->reconnect_timer_id);
+        this->reconnect_timer_id = 0;
+    };
+    this->connect_socket_event_id =
+        this->event_loop.add_fd(socket_fd, EPOLLOUT, [this, socket_fd, retry, stop_waiting](std::uint32_t) {
+            stop_waiting();
+            const auto error = get_socket_error(socket_fd);
+            if (error != 0) {
+                close(socket_fd);
+                report_reconnect_failure(strerror(error));
+                retry();
+            } else if (not complete_reconnect(socket_fd)) {
+                retry();
+            }
+        });
+    this->reconnect_timer_id = this->event_loop.add_timer(
+        std::chrono::milliseconds(mqtt_connect_timeout_ms),
+        [this, socket_fd, retry, stop_waiting]() {
+            stop_waiting();
+            close(socket_fd);
+            report_reconnect_failure(strerror(ETIMEDOUT));
+            retry();
+        },
+        false);
+}
+
+void MQTTAbstractionImpl::report_reconnect_failure(const std::string& reason) {
+    // only the first failure of an outage is worth a warning, the broker may be away for a while
+    if (this->reconnect_failure_reported) {
+        FRAMEWORK_LOG_DEBUG("Could not reconnect to MQTT broker yet: {}", reason);
+        return;
+    }
+    this->reconnect_failure_reported = true;
+    EVLOG_warning << fmt::format("Could not reconnect to MQTT broker, retrying until it is back: {}", reason);
+}
+
+bool MQTTAbstractionImpl::complete_reconnect(int socket_fd) {
+    FRAMEWORK_LOG_FUNCTION();
+
+    MQTT_PAL_MUTEX_LOCK(&this->mqtt_client.mutex);
+    mqtt_reinit(&this->mqtt_client, socket_fd, this->sendbuf.get(), this->sendbuf_size, this->recvbuf.get(),
+                this->recvbuf_size);
+    MQTT_PAL_MUTEX_UNLOCK(&this->mqtt_client.mutex);
+    this->mqtt_socket_fd = socket_fd;
+
+    const uint8_t connect_flags = MQTT_CONNECT_CLEAN_SESSION;
+    MQTTErrors error = mqtt_connect(&this->mqtt_client, nullptr, nullptr, nullptr, 0, nullptr, nullptr, connect_flags,
+                                    mqtt_keep_alive);
+    if (error == MQTT_OK) {
+        error = mqtt_sync(&this->mqtt_client);
+    }
+    if (error != MQTT_OK) {
+        report_reconnect_failure(mqtt_error_str(error));
+        close(socket_fd);
+        this->mqtt_socket_fd = -1;
+        return false;
+    }
+
+    this->reconnecting = false;
+    this->reconnect_failure_reported = false;
+    watch_broker_socket();
+    EVLOG_info << "Reconnected to MQTT broker";
+    // the subscriptions of all handlers and the messages queued in the meantime are only packed into the send buffer
+    // here, they are sent together by the next sync of the main loop
+    on_mqtt_connect();
+    return true;
+}
+
+EventLoop& MQTTAbstractionImpl::get_event_loop() {
+    return this->event_loop;
+}
+
+Executor& MQTTAbstractionImpl::get_handler_executor() {
+    if (this->dispatcher != nullptr) {
+        return this->dispatcher->get_handler_executor();
+    }
+    return *this->handler_executor;
+}
+
 std::shared_future<void> MQTTAbstractionImpl::get_main_loop_future() {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
     return this->main_loop_future;
 }
 
 void MQTTAbstractionImpl::on_mqtt_message(const Message& message) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
     const auto& topic = message.topic;
     const auto& payload = message.payload;
 
+    const bool record_latencies = this->dispatch_metrics_settings.enabled;
+    const auto started = record_latencies ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+
     try {
-        json data;
-        bool is_everest_topic = false;
-        if (topic.find(mqtt_everest_prefix) == 0) {
-            EVLOG_verbose << fmt::format("topic {} starts with {}", topic, mqtt_everest_prefix);
-            is_everest_topic = true;
-            try {
-                data = json::parse(payload);
-            } catch (nlohmann::detail::parse_error& e) {
-                EVLOG_warning << fmt::format("Could not decode json for incoming topic '{}': {}", topic, payload);
-                return;
+        const bool is_everest_topic = topic.find(mqtt_everest_prefix) == 0;
+
+        std::unique_lock<std::mutex> lock(handlers_mutex);
+        // messages are added after releasing the lock, since adding can block on full handler queues
+        std::vector<std::shared_ptr<MessageHandler>> matching_handlers;
+
+        // exact topic matches are looked up directly, this covers almost all everest topics since they rarely contain
+        // wildcards
+        const auto exact_handler = this->message_handlers.find(topic);
+        if (exact_handler != this->message_handlers.end()) {
+            matching_handlers.push_back(exact_handler->second);
+        }
+
+        const auto& wildcard_topics =
+            is_everest_topic ? this->everest_wildcard_handler_topics : this->wildcard_handler_topics;
+        if (wildcard_topics.size() > 0) {
+            std::vector<const std::string*> wildcard_matches;
+            wildcard_topics.find_matches(topic, wildcard_matches);
+            for (const auto* handler_topic : wildcard_matches) {
+                matching_handlers.push_back(this->message_handlers.at(*handler_topic));
             }
-        } else {
-            EVLOG_debug << fmt::format("Message parsing for topic '{}' not implemented. Wrapping in json object.",
-                                       topic);
-            data = json(payload);
         }
+        lock.unlock();
 
-        bool found = false;
+        const bool found = not matching_handlers.empty();
 
-        std::unique_lock<std::mutex> lock(handlers_mutex);
-        std::shared_ptr<ParsedMessage> parsed_message{nullptr};
-        for (auto& [handler_topic, handler] : this->message_handlers) {
-            bool topic_matches = false;
-            if (is_everest_topic) {
-                // everest topics never contain wildcards, so a direct comparison is enough
-                if (topic == handler_topic) {
-                    topic_matches = true;
+        json data;
+        bool raw = false;
+        if (found and is_everest_topic) {
+            FRAMEWORK_LOG_VERBOSE("topic {} starts with {}", topic, mqtt_everest_prefix);
+
+            // results of calls made by others are dropped by their id without decoding the full payload, the id is
+            // found right at its start
+            if (std::all_of(matching_handlers.begin(), matching_handlers.end(),
+                            [](const auto& handler) { return handler->filters_results(); })) {
+                std::string id;
+                if (decode_payload_id(payload, id) and
+                    std::none_of(matching_handlers.begin(), matching_handlers.end(),
+                                 [&id](const auto& handler) { return handler->wants_result(id); })) {
+                    return;
                 }
-            } else {
-                topic_matches = MQTTAbstractionImpl::check_topic_matches(topic, handler_topic);
             }
 
-            if (topic_matches) {
-                found = true;
-                if (not parsed_message) {
-                    parsed_message.reset(new ParsedMessage{topic, std::move(data)});
+            try {
+                data = decode_payload(payload);
+            } catch (const std::exception& e) {
+                EVLOG_warning << fmt::format("Could not decode payload for incoming topic '{}': {}", topic,
+                                             is_binary_payload(payload) ? e.what() : payload);
+                return;
+            }
+
+            // messages no handler is interested in, like vars nobody subscribed to, are not queued
+            const auto envelope = get_payload_envelope(data);
+            if (std::none_of(matching_handlers.begin(), matching_handlers.end(),
+                             [&envelope](const auto& handler) { return handler->wants_message(envelope); })) {
+                return;
+            }
+        } else if (found) {
+            FRAMEWORK_LOG_VERBOSE("Passing the payload for external topic '{}' on as is", topic);
+            raw = true;
+        }
+
+        if (found) {
+            auto parsed_message = std::make_shared<ParsedMessage>(ParsedMessage{topic, std::move(data)});
+            if (raw) {
+                // only wrapped into json for the handlers asking for it
+                parsed_message->raw = true;
+                parsed_message->payload = payload;
+            }
+            if (record_latencies) {
+                parsed_message->received = message.received;
+                parsed_message->dispatched = std::chrono::steady_clock::now();
+                for (const auto& handler : matching_handlers) {
+                    if (auto* latencies = handler->get_latencies()) {
+                        latencies->receive_queue.record(started - message.received);
+                        latencies->parse.record(parsed_message->dispatched - started);
+                    }
                 }
-                handler.add(parsed_message);
+            }
+            for (const auto& handler : matching_handlers) {
+                handler->add(parsed_message);
             }
         }
-        lock.unlock();
 
         // It can happen that we unsubscribe from a topic and have removed the message handler but the MQTT unsubscribe
         // didn't complete yet and we still receive messages on this topic that we can just ignore
         if (!found) {
-            EVLOG_verbose << fmt::format("Topic '{}' should have a matching handler!", topic);
+            FRAMEWORK_LOG_VERBOSE("Topic '{}' should have a matching handler!", topic);
         }
     } catch (boost::exception& e) {
         EVLOG_critical << fmt::format("Caught MQTT on_message boost::exception:\n{}",
@@ -381,66 +1106,95 @@ void MQTTAbstractionImpl::on_mqtt_message(const Message& message) {
 }
 
 void MQTTAbstractionImpl::on_mqtt_connect() {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
     EVLOG_debug << "Connected to MQTT broker";
 
     // subscribe to all topics needed by currently registered handlers
     EVLOG_debug << "Subscribing to needed MQTT topics...";
+
     const std::lock_guard<std::mutex> lock(handlers_mutex);
     for (auto const& [topic, handler] : this->message_handlers) {
-        EVLOG_debug << fmt::format("Subscribing to {}", topic);
+        if (this->shm_topics.count(topic) != 0) {
+            continue;
+        }
+        FRAMEWORK_LOG_DEBUG("Subscribing to {}", topic);
         subscribe(topic); // FIXME(kai): get QOS from handler
     }
+    for (auto const& [topic, handlers] : this->forwarded_subscriptions) {
+        FRAMEWORK_LOG_DEBUG("Subscribing to {}", topic);
+        subscribe(topic);
+    }
 
     // this will allow new handlers to subscribe directly, if needed
     {
         const std::lock_guard<std::mutex> lock(messages_before_connected_mutex);
         this->mqtt_is_connected = true;
-        for (auto& message : this->messages_before_connected) {
-            this->publish(message->topic, message->payload, message->qos);
-        }
-        this->messages_before_connected.clear();
+    }
+    // wakes up blocked publishers, which will publish directly from now on
+    this->messages_before_connected.close();
+    for (const auto& message : this->messages_before_connected.drain()) {
+        this->publish(message->topic, message->payload, message->qos);
     }
 }
 
 void MQTTAbstractionImpl::on_mqtt_disconnect() {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
+
+    EVLOG_warning << "Lost connection to MQTT broker, reconnecting...";
+
+    // publishes are queued until the connection has been re-established
+    {
+        const std::lock_guard<std::mutex> lock(messages_before_connected_mutex);
+        this->mqtt_is_connected = false;
+    }
+    this->messages_before_connected.reopen();
+
+    this->reconnecting = true;
+    this->event_loop.remove(this->broker_socket_event_id);
+    this->broker_socket_event_id = 0;
+    close(this->mqtt_socket_fd);
+    this->mqtt_socket_fd = -1;
 
-    EVLOG_AND_THROW(EverestInternalError("Lost connection to MQTT broker"));
+    schedule_reconnect(mqtt_reconnect_min_backoff);
 }
 
 void MQTTAbstractionImpl::register_handler(const std::string& topic, std::shared_ptr<TypedHandler> handler, QOS qos) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
+
+    if (this->dispatcher != nullptr) {
+        // the handler is in place before messages of this connection arrive
+        this->dispatcher->register_handler(topic, std::move(handler), qos);
+        add_forwarded_subscription(topic, qos);
+        return;
+    }
 
     switch (handler->type) {
     case HandlerType::Call:
-        EVLOG_debug << fmt::format("Registering call handler {} for command {} on topic {}",
-                                   fmt::ptr(&handler->handler), handler->name, topic);
+        FRAMEWORK_LOG_DEBUG("Registering call handler {} for command {} on topic {}", fmt::ptr(&handler->handler),
+                            handler->name, topic);
         break;
     case HandlerType::Result:
-        EVLOG_verbose << fmt::format("Registering result handler {} for command {} on topic {}",
-                                     fmt::ptr(&handler->handler), handler->name, topic);
+        FRAMEWORK_LOG_VERBOSE("Registering result handler {} for command {} on topic {}", fmt::ptr(&handler->handler),
+                              handler->name, topic);
         break;
     case HandlerType::SubscribeVar:
-        EVLOG_debug << fmt::format("Registering subscribe handler {} for variable {} on topic {}",
-                                   fmt::ptr(&handler->handler), handler->name, topic);
+        FRAMEWORK_LOG_DEBUG("Registering subscribe handler {} for variable {} on topic {}",
+                            fmt::ptr(&handler->handler), handler->name, topic);
         break;
     case HandlerType::SubscribeError:
-        EVLOG_debug << fmt::format("Registering error handler {} for variable {} on topic {}",
-                                   fmt::ptr(&handler->handler), handler->name, topic);
+        FRAMEWORK_LOG_DEBUG("Registering error handler {} for variable {} on topic {}", fmt::ptr(&handler->handler),
+                            handler->name, topic);
         break;
     case HandlerType::ClearErrorRequest:
-        EVLOG_debug << fmt::format("Registering clear error handler {} for variable {} on topic {}",
-                                   fmt::ptr(&handler->handler), handler->name, topic);
+        FRAMEWORK_LOG_DEBUG("Registering clear error handler {} for variable {} on topic {}",
+                            fmt::ptr(&handler->handler), handler->name, topic);
         break;
     case HandlerType::ExternalMQTT:
-        EVLOG_debug << fmt::format("Registering external MQTT handler {} on topic {}", fmt::ptr(&handler->handler),
-                                   topic);
+        FRAMEWORK_LOG_DEBUG("Registering external MQTT handler {} on topic {}", fmt::ptr(&handler->handler), topic);
         break;
     case HandlerType::GetConfig:
-        EVLOG_debug << fmt::format("Registering get config MQTT handler {} on topic {}", fmt::ptr(&handler->handler),
-                                   topic);
+        FRAMEWORK_LOG_DEBUG("Registering get config MQTT handler {} on topic {}", fmt::ptr(&handler->handler), topic);
         break;
     default:
         EVLOG_warning << fmt::format("Registering unknown handler {} on topic {}", fmt::ptr(&handler->handler), topic);
@@ -450,85 +1204,112 @@ void MQTTAbstractionImpl::register_handler(const std::string& topic, std::shared
     const std::lock_guard<std::mutex> lock(handlers_mutex);
 
     if (this->message_handlers.count(topic) == 0) {
-        this->message_handlers.emplace(std::piecewise_construct, std::forward_as_tuple(topic), std::forward_as_tuple());
+        this->message_handlers.emplace(
+            topic, std::make_shared<MessageHandler>(
+                       *this->handler_executor, this->queue_settings.handler, this->dispatch_metrics_settings.enabled,
+                       this->handler_accounting_settings.enabled, this->handler_accounting_settings.budget,
+                       this->var_cache_enabled));
+        if (contains_wildcards(topic)) {
+            get_wildcard_handler_topics(topic).insert(topic);
+        }
     }
 
+    const auto first_handler = (this->message_handlers.at(topic)->count_handlers() == 0);
+    if (first_handler and this->shm_transport != nullptr and is_shm_topic(topic) and
+        this->shm_transport->subscribe(topic)) {
+        this->shm_topics.insert(topic);
+    }
     const auto subscription_necessary =
-        (this->mqtt_is_connected && this->message_handlers.at(topic).count_handlers() == 0);
+        (this->mqtt_is_connected && first_handler && this->shm_topics.count(topic) == 0);
 
-    this->message_handlers.at(topic).add_handler(handler);
+    this->message_handlers.at(topic)->add_handler(handler);
 
     if (subscription_necessary) {
-        EVLOG_verbose << fmt::format("Subscribing to {}", topic);
+        FRAMEWORK_LOG_VERBOSE("Subscribing to {}", topic);
         this->subscribe(topic, qos);
     }
-    EVLOG_verbose << fmt::format("#handler[{}] = {}", topic, this->message_handlers.at(topic).count_handlers());
+    FRAMEWORK_LOG_VERBOSE("#handler[{}] = {}", topic, this->message_handlers.at(topic)->count_handlers());
 }
 
 void MQTTAbstractionImpl::unregister_handler(const std::string& topic, const Token& token) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
-    EVLOG_verbose << fmt::format("Unregistering handler {} for {}", fmt::ptr(&token), topic);
+    FRAMEWORK_LOG_VERBOSE("Unregistering handler {} for {}", fmt::ptr(&token), topic);
+
+    if (this->dispatcher != nullptr) {
+        remove_forwarded_subscription(topic);
+        this->dispatcher->unregister_handler(topic, token);
+        return;
+    }
 
     const std::lock_guard<std::mutex> lock(handlers_mutex);
     std::size_t number_of_handlers = 0;
     if (this->message_handlers.find(topic) != this->message_handlers.end()) {
         auto& topic_message_handler = this->message_handlers.at(topic);
-        if (topic_message_handler.count_handlers() != 0) {
-            topic_message_handler.remove_handler(token);
-            number_of_handlers = topic_message_handler.count_handlers();
+        if (topic_message_handler->count_handlers() != 0) {
+            topic_message_handler->remove_handler(token);
+            number_of_handlers = topic_message_handler->count_handlers();
         }
     }
 
     // unsubscribe if this was the last handler for this topic
     if (number_of_handlers == 0) {
-        // TODO(kai): should we throw/log an error if we are not connected?
-        if (this->mqtt_is_connected) {
-            EVLOG_verbose << fmt::format("Unsubscribing from {}", topic);
+        if (this->shm_topics.erase(topic) != 0) {
+            this->shm_transport->unsubscribe(topic);
+        } else if (this->mqtt_is_connected) {
+            // TODO(kai): should we throw/log an error if we are not connected?
+            FRAMEWORK_LOG_VERBOSE("Unsubscribing from {}", topic);
             this->unsubscribe(topic);
         }
-        this->message_handlers.erase(topic);
+        const auto message_handler = this->message_handlers.find(topic);
+        if (message_handler != this->message_handlers.end()) {
+            // queued messages might still keep the handler alive, they are no longer delivered
+            message_handler->second->stop();
+        }
+        if (this->message_handlers.erase(topic) != 0 and contains_wildcards(topic)) {
+            get_wildcard_handler_topics(topic).remove(topic);
+        }
     }
 
     const std::string handler_count = (number_of_handlers == 0) ? "None" : std::to_string(number_of_handlers);
-    EVLOG_verbose << fmt::format("#handler[{}] = {}", topic, handler_count);
+    FRAMEWORK_LOG_VERBOSE("#handler[{}] = {}", topic, handler_count);
 }
 
-bool MQTTAbstractionImpl::connectBroker(std::string& socket_path) {
-    BOOST_LOG_FUNCTION();
+void MQTTAbstractionImpl::add_forwarded_subscription(const std::string& topic, QOS qos) {
+    FRAMEWORK_LOG_FUNCTION();
 
-    /* open the non-blocking TCP socket (connecting to the broker) */
-    mqtt_socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
-    if (mqtt_socket_fd == -1) {
-        EVLOG_error << fmt::format("Failed to open socket: {}", strerror(errno));
-        return false;
+    if (this->dispatcher != nullptr and this->dispatcher->receives_via_shm(topic)) {
+        // the dispatcher already receives these messages via shared memory, never from the broker
+        return;
     }
-
-    // Initialize the address structure
-    struct sockaddr_un addr;
-    memset(&addr, 0, sizeof(struct sockaddr_un));
-    addr.sun_family = AF_UNIX;
-    if (socket_path.size() > (sizeof(addr.sun_path) - 1)) {
-        EVLOG_error << fmt::format("the given path for the unix domain socket: {} is too big", socket_path);
-        close(mqtt_socket_fd);
-        return false;
+    const std::lock_guard<std::mutex> lock(handlers_mutex);
+    if (this->forwarded_subscriptions[topic]++ == 0 and this->mqtt_is_connected) {
+        FRAMEWORK_LOG_VERBOSE("Subscribing to {}", topic);
+        this->subscribe(topic, qos);
     }
-    // no need to set the terminating null due to memset
-    std::strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+}
 
-    // make non-blocking
-    auto retval = fcntl(mqtt_socket_fd, F_SETFL,
-                        fcntl(mqtt_socket_fd, F_GETFL) | O_NONBLOCK); // NOLINT: We have no good alternative to fcntl
-    if (retval != 0) {
-        EVLOG_error << fmt::format("Failed to set nonblock for unix domain socket: {}", socket_path);
-        close(mqtt_socket_fd);
-        return false;
+void MQTTAbstractionImpl::remove_forwarded_subscription(const std::string& topic) {
+    FRAMEWORK_LOG_FUNCTION();
+
+    const std::lock_guard<std::mutex> lock(handlers_mutex);
+    const auto subscription = this->forwarded_subscriptions.find(topic);
+    if (subscription == this->forwarded_subscriptions.end() or --subscription->second != 0) {
+        return;
+    }
+    this->forwarded_subscriptions.erase(subscription);
+    if (this->mqtt_is_connected) {
+        FRAMEWORK_LOG_VERBOSE("Unsubscribing from {}", topic);
+        this->unsubscribe(topic);
     }
+}
+
+bool MQTTAbstractionImpl::connectBroker(std::string& socket_path) {
+    FRAMEWORK_LOG_FUNCTION();
 
-    // conect the socket
-    if (::connect(mqtt_socket_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(struct sockaddr_un)) == -1) {
-        EVLOG_error << fmt::format("Failed to connect to unix domain socket: {}", socket_path);
-        close(mqtt_socket_fd);
+    mqtt_socket_fd = open_unix_socket(socket_path);
+    if (mqtt_socket_fd == -1) {
+        EVLOG_error << fmt::format("Failed to connect to unix domain socket {}: {}", socket_path, strerror(errno));
         return false;
     }
 
@@ -539,8 +1320,8 @@ bool MQTTAbstractionImpl::connectBroker(std::string& socket_path) {
         return false;
     }
 
-    mqtt_init(&this->mqtt_client, mqtt_socket_fd, static_cast<uint8_t*>(this->sendbuf), sizeof(this->sendbuf),
-              static_cast<uint8_t*>(this->recvbuf), sizeof(this->recvbuf), MQTTAbstractionImpl::publish_callback);
+    mqtt_init(&this->mqtt_client, mqtt_socket_fd, this->sendbuf.get(), this->sendbuf_size, this->recvbuf.get(),
+              this->recvbuf_size, MQTTAbstractionImpl::publish_callback);
     const uint8_t connect_flags = MQTT_CONNECT_CLEAN_SESSION;
     /* Send connection request to the broker. */
     if (mqtt_connect(&this->mqtt_client, nullptr, nullptr, nullptr, 0, nullptr, nullptr, connect_flags,
@@ -559,10 +1340,10 @@ bool MQTTAbstractionImpl::connectBroker(std::string& socket_path) {
 }
 
 bool MQTTAbstractionImpl::connectBroker(const char* host, const char* port) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
     /* open the non-blocking TCP socket (connecting to the broker) */
-    mqtt_socket_fd = open_nb_socket(host, port);
+    mqtt_socket_fd = open_nb_socket(host, port, true);
 
     if (mqtt_socket_fd == -1) {
         EVLOG_error << fmt::format("Failed to open socket: {}", strerror(errno));
@@ -581,8 +1362,8 @@ bool MQTTAbstractionImpl::connectBroker(const char* host, const char* port) {
     int enable = 1;
     setsockopt(mqtt_socket_fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
 
-    mqtt_init(&this->mqtt_client, mqtt_socket_fd, static_cast<uint8_t*>(this->sendbuf), sizeof(this->sendbuf),
-              static_cast<uint8_t*>(this->recvbuf), sizeof(this->recvbuf), MQTTAbstractionImpl::publish_callback);
+    mqtt_init(&this->mqtt_client, mqtt_socket_fd, this->sendbuf.get(), this->sendbuf_size, this->recvbuf.get(),
+              this->recvbuf_size, MQTTAbstractionImpl::publish_callback);
     const uint8_t connect_flags = MQTT_CONNECT_CLEAN_SESSION;
     /* Send connection request to the broker. */
     if (mqtt_connect(&this->mqtt_client, nullptr, nullptr, nullptr, 0, nullptr, nullptr, connect_flags,
@@ -600,8 +1381,70 @@ bool MQTTAbstractionImpl::connectBroker(const char* host, const char* port) {
     return true;
 }
 
-int MQTTAbstractionImpl::open_nb_socket(const char* addr, const char* port) {
-    BOOST_LOG_FUNCTION();
+int MQTTAbstractionImpl::open_unix_socket(const std::string& socket_path) {
+    FRAMEWORK_LOG_FUNCTION();
+
+    /* open the non-blocking TCP socket (connecting to the broker) */
+    const int sockfd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sockfd == -1) {
+        EVLOG_error << fmt::format("Failed to open socket: {}", strerror(errno));
+        return -1;
+    }
+
+    // Initialize the address structure
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(struct sockaddr_un));
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() > (sizeof(addr.sun_path) - 1)) {
+        EVLOG_error << fmt::format("the given path for the unix domain socket: {} is too big", socket_path);
+        close(sockfd);
+        return -1;
+    }
+    // no need to set the terminating null due to memset
+    std::strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    // make non-blocking
+    auto retval = fcntl(sockfd, F_SETFL,
+                        fcntl(sockfd, F_GETFL) | O_NONBLOCK); // NOLINT: We have no good alternative to fcntl
+    if (retval != 0) {
+        EVLOG_error << fmt::format("Failed to set nonblock for unix domain socket: {}", socket_path);
+        close(sockfd);
+        return -1;
+    }
+
+    // conect the socket, failing to do so is logged by the caller, which knows whether it is retrying
+    if (::connect(sockfd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(struct sockaddr_un)) == -1) {
+        const auto error = errno;
+        close(sockfd);
+        errno = error;
+        return -1;
+    }
+
+    return sockfd;
+}
+
+namespace {
+/// \returns 0 once the non-blocking connect of \p sockfd succeeded, -1 with errno set if it failed or timed out
+int finish_connect(int sockfd) {
+    pollfd poll_fd{sockfd, POLLOUT, 0};
+    const auto ready = poll(&poll_fd, 1, mqtt_connect_timeout_ms);
+    if (ready <= 0) {
+        if (ready == 0) {
+            errno = ETIMEDOUT;
+        }
+        return -1;
+    }
+    const auto error = get_socket_error(sockfd);
+    if (error != 0) {
+        errno = error;
+        return -1;
+    }
+    return 0;
+}
+} // namespace
+
+int MQTTAbstractionImpl::open_nb_socket(const char* addr, const char* port, bool wait_for_connect) {
+    FRAMEWORK_LOG_FUNCTION();
 
     struct addrinfo hints = {0, 0, 0, 0, 0, 0, 0, 0};
 
@@ -627,10 +1470,22 @@ int MQTTAbstractionImpl::open_nb_socket(const char* addr, const char* port) {
             continue;
         }
 
+        /* make non-blocking before connecting, so an unreachable broker blocks at most up to the connect timeout */
+        fcntl(sockfd, F_SETFL, fcntl(sockfd, F_GETFL) | O_NONBLOCK); // NOLINT: We have no good alternative to fcntl
+
         /* connect to server */
         rv = ::connect(sockfd, p->ai_addr, p->ai_addrlen);
+        if (rv == -1 and errno == EINPROGRESS) {
+            if (not wait_for_connect) {
+                // the caller waits for the socket to become writable
+                break;
+            }
+            rv = finish_connect(sockfd);
+        }
         if (rv == -1) {
+            const auto error = errno;
             close(sockfd);
+            errno = error;
             sockfd = -1;
             continue;
         }
@@ -640,18 +1495,13 @@ int MQTTAbstractionImpl::open_nb_socket(const char* addr, const char* port) {
     /* free servinfo */
     freeaddrinfo(servinfo);
 
-    /* make non-blocking */
-    if (sockfd != -1) {
-        fcntl(sockfd, F_SETFL, fcntl(sockfd, F_GETFL) | O_NONBLOCK); // NOLINT: We have no good alternative to fcntl
-    }
-
     /* return the new socket fd */
     return sockfd;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
 bool MQTTAbstractionImpl::check_topic_matches(const std::string& full_topic, const std::string& wildcard_topic) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
     // verbatim topic
     // NOLINTNEXTLINE(clang-analyzer-cplusplus.NewDeleteLeaks)
@@ -697,15 +1547,25 @@ bool MQTTAbstractionImpl::check_topic_matches(const std::string& full_topic, con
     return full_split.size() == wildcard_split.size();
 }
 
+MessagePoolStats MQTTAbstractionImpl::get_message_pool_stats() {
+    return this->message_pool.get_stats();
+}
+
 void MQTTAbstractionImpl::publish_callback(void** state, struct mqtt_response_publish* published) {
-    BOOST_LOG_FUNCTION();
+    FRAMEWORK_LOG_FUNCTION();
 
-    auto message_queue = static_cast<MessageQueue*>(*state);
+    auto* self = static_cast<MQTTAbstractionImpl*>(*state);
+
+    const auto message_size = published->topic_name_size + published->application_message_size;
+    if (message_size > self->largest_received_message) {
+        self->largest_received_message = message_size;
+    }
 
-    // topic_name and application_message are NOT null-terminated, hence copy construct strings
-    message_queue->add(std::unique_ptr<Message>(new Message{
-        std::string(static_cast<const char*>(published->topic_name), published->topic_name_size),
-        std::string(static_cast<const char*>(published->application_message), published->application_message_size)}));
+    // topic_name and application_message point into recvbuf, which MQTT-C re-uses for the next message, and are NOT
+    // null-terminated, hence copy them once into a recycled message whose buffers are usually already large enough
+    self->receive_message(static_cast<const char*>(published->topic_name), published->topic_name_size,
+                          static_cast<const char*>(published->application_message),
+                          published->application_message_size);
 }
 
 } // namespace Everest
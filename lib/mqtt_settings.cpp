@@ -2,8 +2,16 @@
 // Copyright Pionix GmbH and Contributors to EVerest
 #include <utils/mqtt_settings.hpp>
 
+#include <algorithm>
+
 namespace Everest {
 
+namespace {
+bool starts_with(std::string_view value, std::string_view prefix) {
+    return value.substr(0, prefix.size()) == prefix;
+}
+} // namespace
+
 bool MQTTSettings::uses_socket() const {
     if (not broker_socket_path.empty()) {
         return true;
@@ -11,6 +19,50 @@ bool MQTTSettings::uses_socket() const {
     return false;
 }
 
+bool MQTTBrokerShard::uses_socket() const {
+    return not broker_socket_path.empty();
+}
+
+std::size_t get_broker_connection(const std::vector<MQTTBrokerShard>& shards, std::string_view topic) {
+    std::size_t connection = 0;
+    std::size_t longest_prefix = 0;
+    for (std::size_t i = 0; i < shards.size(); i++) {
+        for (const auto& prefix : shards.at(i).topic_prefixes) {
+            if (prefix.size() > longest_prefix and starts_with(topic, prefix)) {
+                connection = i + 1;
+                longest_prefix = prefix.size();
+            }
+        }
+    }
+    return connection;
+}
+
+std::vector<std::size_t> get_broker_connections(const std::vector<MQTTBrokerShard>& shards,
+                                                std::string_view topic_filter) {
+    // every topic matching the filter starts with the part before the first wildcard, it is carried by the
+    // connection of that part or by a shard with a longer prefix starting with it
+    const auto literal = topic_filter.substr(0, topic_filter.find_first_of("+#"));
+    std::vector<std::size_t> connections{get_broker_connection(shards, literal)};
+    if (literal.size() == topic_filter.size()) {
+        return connections;
+    }
+    // a trailing "/#" also matches the parent topic, which may be carried by another connection than its children
+    if (literal.size() + 1 == topic_filter.size() and topic_filter.back() == '#' and not literal.empty()) {
+        connections.push_back(get_broker_connection(shards, literal.substr(0, literal.size() - 1)));
+    }
+    for (std::size_t i = 0; i < shards.size(); i++) {
+        const auto& prefixes = shards.at(i).topic_prefixes;
+        if (std::any_of(prefixes.begin(), prefixes.end(), [literal](const std::string& prefix) {
+                return prefix.size() > literal.size() and starts_with(prefix, literal);
+            })) {
+            connections.push_back(i + 1);
+        }
+    }
+    std::sort(connections.begin(), connections.end());
+    connections.erase(std::unique(connections.begin(), connections.end()), connections.end());
+    return connections;
+}
+
 MQTTSettings create_mqtt_settings(const std::string& mqtt_broker_socket_path, const std::string& mqtt_everest_prefix,
                                   const std::string& mqtt_external_prefix) {
     MQTTSettings mqtt_settings;
@@ -0,0 +1,330 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <fmt/format.h>
+#include <zlib.h>
+
+#include <everest/exceptions.hpp>
+
+#include <utils/payload_encoding.hpp>
+
+namespace Everest {
+
+namespace {
+///
+/// \brief SAX consumer extracting the top level "name" and "type" strings as well as the "id" string of the top level
+/// "data" object, all other values are skipped without being stored
+/// \details With \p id_only parsing stops at the id, which directly follows the opening of the data object in the
+///          sorted keys of the payloads of the framework, so the rest of the data body is not even tokenized
+class EnvelopeSax : public nlohmann::json_sax<nlohmann::json> {
+public:
+    EnvelopeSax(PayloadEnvelope& envelope, bool id_only) : envelope(envelope), id_only(id_only) {
+    }
+
+    bool null() override {
+        return true;
+    }
+    bool boolean(bool /*val*/) override {
+        return true;
+    }
+    bool number_integer(number_integer_t /*val*/) override {
+        return true;
+    }
+    bool number_unsigned(number_unsigned_t /*val*/) override {
+        return true;
+    }
+    bool number_float(number_float_t /*val*/, const string_t& /*s*/) override {
+        return true;
+    }
+    bool binary(binary_t& /*val*/) override {
+        return true;
+    }
+
+    bool string(string_t& val) override {
+        if (this->depth == 1 and this->current_key == "name") {
+            this->envelope.name = std::move(val);
+        } else if (this->depth == 1 and this->current_key == "type") {
+            this->envelope.type = std::move(val);
+        } else if (this->depth == 2 and this->in_data and this->current_key == "id") {
+            this->envelope.id = std::move(val);
+        }
+        // stop early once everything has been found, the remaining payload is of no interest
+        if (this->id_only) {
+            this->complete = not this->envelope.id.empty();
+        } else {
+            this->complete = not this->envelope.name.empty() and not this->envelope.type.empty() and
+                             (this->envelope.type != "result" or not this->envelope.id.empty());
+        }
+        return not this->complete;
+    }
+
+    bool start_object(std::size_t /*elements*/) override {
+        this->in_data = (this->depth == 1 and this->current_key == "data") or (this->in_data and this->depth > 1);
+        this->depth++;
+        return true;
+    }
+    bool end_object() override {
+        this->depth--;
+        if (this->depth <= 1) {
+            this->in_data = false;
+            this->current_key.clear();
+        }
+        return true;
+    }
+    bool start_array(std::size_t /*elements*/) override {
+        this->depth++;
+        return true;
+    }
+    bool end_array() override {
+        this->depth--;
+        return true;
+    }
+
+    bool key(string_t& val) override {
+        if (this->depth <= 2) {
+            this->current_key = std::move(val);
+        }
+        return true;
+    }
+
+    bool parse_error(std::size_t /*position*/, const std::string& /*last_token*/,
+                     const nlohmann::detail::exception& /*ex*/) override {
+        this->failed = true;
+        return false;
+    }
+
+    bool complete{false}; ///< all envelope fields have been found and parsing has been stopped
+    bool failed{false};   ///< the payload could not be parsed
+
+private:
+    PayloadEnvelope& envelope;
+    bool id_only;
+    std::size_t depth{0};
+    bool in_data{false};
+    std::string current_key;
+};
+
+/// \brief payloads smaller than this do not get smaller by compressing them
+constexpr std::size_t min_compressed_payload_size = 256;
+/// \brief protects the receivers from payloads decompressing into more than they can hold
+constexpr std::size_t max_decompressed_payload_size = 256 * 1024 * 1024;
+
+///
+/// \brief preset dictionary of the compressed payloads, both sides have to use exactly the same one
+/// \details Holds the keys and values common in manifests, interfaces, types and schemas, the most common ones at the
+///          end, where deflate finds them with the shortest distances
+constexpr char compression_dictionary[] =
+    R"("license":"https://opensource.org/licenses/Apache-2.0","authors":["metadata":{"enable_external_mqtt":)"
+    R"("enable_telemetry":"enable_global_errors":"capabilities":"config":{"provides":{"requires":{"min_connections":)"
+    R"("max_connections":"errors":[{"reference":"/errors/"cmds":{"vars":{"arguments":{"result":{"interface":")"
+    R"("minLength":"maxLength":"minItems":"maxItems":"minimum":"maximum":"pattern":"format":"date-time")"
+    R"("$schema":"http://json-schema.org/draft-07/schema#","$ref":"/"enum":["default":"required":[)"
+    R"("items":{"additionalProperties":false,"properties":{"type":"number","type":"integer","type":"boolean",)"
+    R"("type":"array","type":"string","type":"object","description":")";
+
+/// \brief the dictionary without its terminating NUL
+constexpr auto compression_dictionary_size = sizeof(compression_dictionary) - 1;
+
+const Bytef* as_bytes(const char* data) {
+    return reinterpret_cast<const Bytef*>(data);
+}
+
+/// \brief inflates the payload compressed by compress_payload() without its marker and identifier
+std::string decompress_payload(const char* data, std::size_t size) {
+    z_stream stream{};
+    if (inflateInit(&stream) != Z_OK) {
+        throw std::runtime_error("Could not initialize the decompression of a payload");
+    }
+    // inflate() only reads from next_in
+    stream.next_in = const_cast<Bytef*>(as_bytes(data));
+    stream.avail_in = static_cast<uInt>(size);
+
+    std::string decompressed(std::max<std::size_t>(size * 4, min_compressed_payload_size), '\0');
+    int result = Z_OK;
+    while (result != Z_STREAM_END) {
+        if (stream.total_out == decompressed.size()) {
+            if (decompressed.size() >= max_decompressed_payload_size) {
+                inflateEnd(&stream);
+                throw std::runtime_error("Compressed payload is too large");
+            }
+            decompressed.resize(std::min(decompressed.size() * 2, max_decompressed_payload_size));
+        }
+        stream.next_out = reinterpret_cast<Bytef*>(&decompressed[stream.total_out]);
+        stream.avail_out = static_cast<uInt>(decompressed.size() - stream.total_out);
+        result = inflate(&stream, Z_NO_FLUSH);
+        if (result == Z_NEED_DICT) {
+            result = inflateSetDictionary(&stream, as_bytes(compression_dictionary), compression_dictionary_size);
+        }
+        if (result != Z_OK and result != Z_STREAM_END and not(result == Z_BUF_ERROR and stream.avail_out == 0)) {
+            inflateEnd(&stream);
+            throw std::runtime_error(fmt::format("Could not decompress payload: {}",
+                                                 stream.msg != nullptr ? stream.msg : zError(result)));
+        }
+    }
+    decompressed.resize(stream.total_out);
+    inflateEnd(&stream);
+    return decompressed;
+}
+
+bool sax_parse_envelope(const std::string& payload, EnvelopeSax& sax) {
+    bool result = false;
+    if (not is_binary_payload(payload)) {
+        result = nlohmann::json::sax_parse(payload, &sax);
+    } else if (payload.at(1) == CBOR_PAYLOAD_IDENTIFIER) {
+        result = nlohmann::json::sax_parse(payload.begin() + 2, payload.end(), &sax,
+                                           nlohmann::json::input_format_t::cbor);
+    } else if (payload.at(1) == MESSAGE_PACK_PAYLOAD_IDENTIFIER) {
+        result = nlohmann::json::sax_parse(payload.begin() + 2, payload.end(), &sax,
+                                           nlohmann::json::input_format_t::msgpack);
+    } else {
+        return false;
+    }
+    return (result or sax.complete) and not sax.failed;
+}
+} // namespace
+
+std::string payload_encoding_to_string(MQTTPayloadEncoding encoding) {
+    switch (encoding) {
+    case MQTTPayloadEncoding::Json:
+        return "json";
+    case MQTTPayloadEncoding::Cbor:
+        return "cbor";
+    case MQTTPayloadEncoding::MessagePack:
+        return "msgpack";
+    }
+
+    throw EverestInternalError("Unknown payload encoding");
+}
+
+MQTTPayloadEncoding string_to_payload_encoding(const std::string& encoding) {
+    if (encoding == "json") {
+        return MQTTPayloadEncoding::Json;
+    }
+    if (encoding == "cbor") {
+        return MQTTPayloadEncoding::Cbor;
+    }
+    if (encoding == "msgpack") {
+        return MQTTPayloadEncoding::MessagePack;
+    }
+
+    throw EverestConfigError(fmt::format("Unknown payload encoding '{}'", encoding));
+}
+
+std::string encode_payload(const nlohmann::json& data, MQTTPayloadEncoding encoding) {
+    std::string payload;
+    encode_payload(data, encoding, payload);
+    return payload;
+}
+
+void encode_payload(const nlohmann::json& data, MQTTPayloadEncoding encoding, std::string& payload) {
+    payload.clear();
+    if (encoding == MQTTPayloadEncoding::Json) {
+        // what dump() does, but into the given string instead of a new one
+        nlohmann::detail::serializer<nlohmann::json> serializer(nlohmann::detail::output_adapter<char>(payload), ' ');
+        serializer.dump(data, false, false, 0);
+        return;
+    }
+
+    payload.push_back(BINARY_PAYLOAD_MARKER);
+    if (encoding == MQTTPayloadEncoding::Cbor) {
+        payload.push_back(CBOR_PAYLOAD_IDENTIFIER);
+        nlohmann::json::to_cbor(data, nlohmann::detail::output_adapter<char>(payload));
+    } else {
+        payload.push_back(MESSAGE_PACK_PAYLOAD_IDENTIFIER);
+        nlohmann::json::to_msgpack(data, nlohmann::detail::output_adapter<char>(payload));
+    }
+}
+
+bool is_binary_payload(const std::string& payload) {
+    return payload.size() >= 2 and payload.front() == BINARY_PAYLOAD_MARKER;
+}
+
+std::string compress_payload(const std::string& payload) {
+    if (payload.size() < min_compressed_payload_size) {
+        return payload;
+    }
+
+    z_stream stream{};
+    if (deflateInit(&stream, Z_BEST_COMPRESSION) != Z_OK or
+        deflateSetDictionary(&stream, as_bytes(compression_dictionary), compression_dictionary_size) != Z_OK) {
+        deflateEnd(&stream);
+        throw std::runtime_error("Could not initialize the compression of a payload");
+    }
+    std::string compressed(2 + deflateBound(&stream, payload.size()), '\0');
+    compressed[0] = BINARY_PAYLOAD_MARKER;
+    compressed[1] = DEFLATE_PAYLOAD_IDENTIFIER;
+    // deflate() only reads from next_in
+    stream.next_in = const_cast<Bytef*>(as_bytes(payload.data()));
+    stream.avail_in = static_cast<uInt>(payload.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&compressed[2]);
+    stream.avail_out = static_cast<uInt>(compressed.size() - 2);
+    const auto result = deflate(&stream, Z_FINISH);
+    compressed.resize(2 + stream.total_out);
+    deflateEnd(&stream);
+    if (result != Z_STREAM_END) {
+        throw std::runtime_error(fmt::format("Could not compress payload: {}", zError(result)));
+    }
+
+    return compressed.size() < payload.size() ? compressed : payload;
+}
+
+nlohmann::json decode_payload(const std::string& payload) {
+    if (not is_binary_payload(payload)) {
+        return nlohmann::json::parse(payload);
+    }
+
+    const auto begin = payload.begin() + 2;
+    switch (payload.at(1)) {
+    case CBOR_PAYLOAD_IDENTIFIER:
+        return nlohmann::json::from_cbor(begin, payload.end());
+    case MESSAGE_PACK_PAYLOAD_IDENTIFIER:
+        return nlohmann::json::from_msgpack(begin, payload.end());
+    case DEFLATE_PAYLOAD_IDENTIFIER:
+        return decode_payload(decompress_payload(payload.data() + 2, payload.size() - 2));
+    default:
+        throw std::runtime_error(
+            fmt::format("Unknown binary payload encoding identifier {:#04x}", static_cast<int>(payload.at(1))));
+    }
+}
+
+bool decode_payload_envelope(const std::string& payload, PayloadEnvelope& envelope) {
+    EnvelopeSax sax(envelope, false);
+    return sax_parse_envelope(payload, sax);
+}
+
+bool decode_payload_id(const std::string& payload, std::string& id) {
+    PayloadEnvelope envelope;
+    EnvelopeSax sax(envelope, true);
+    if (not sax_parse_envelope(payload, sax)) {
+        return false;
+    }
+    id = std::move(envelope.id);
+    return true;
+}
+
+PayloadEnvelope get_payload_envelope(const nlohmann::json& data) {
+    PayloadEnvelope envelope;
+    if (not data.is_object()) {
+        return envelope;
+    }
+    const auto string_at = [](const nlohmann::json& object, const char* key, std::string& value) {
+        const auto field = object.find(key);
+        if (field != object.end() and field->is_string()) {
+            value = field->get<std::string>();
+        }
+    };
+    string_at(data, "name", envelope.name);
+    string_at(data, "type", envelope.type);
+    const auto body = data.find("data");
+    if (body != data.end() and body->is_object()) {
+        string_at(*body, "id", envelope.id);
+    }
+    return envelope;
+}
+
+} // namespace Everest
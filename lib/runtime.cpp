@@ -9,10 +9,13 @@
 #include <utils/error/error_manager_req.hpp>
 #include <utils/error/error_state_monitor.hpp>
 #include <utils/filesystem.hpp>
+#include <utils/payload_encoding.hpp>
 
 #include <algorithm>
 #include <cstdlib>
 #include <fstream>
+#include <map>
+#include <set>
 
 #include <boost/program_options.hpp>
 
@@ -28,6 +31,253 @@ std::string parse_string_option(const po::variables_map& vm, const char* option)
     return vm[option].as<std::string>();
 }
 
+void populate_mqtt_buffer_settings_from_env(MQTTSettings& mqtt_settings) {
+    const auto parse_size = [](const char* variable, std::size_t& size) {
+        // NOLINTNEXTLINE(concurrency-mt-unsafe): not problematic that this function is not threadsafe here
+        const char* value = std::getenv(variable);
+        if (value == nullptr) {
+            return;
+        }
+        try {
+            size = std::stoul(value);
+        } catch (...) {
+            EVLOG_warning << fmt::format("Environment variable {} set, but not set to an integer. Ignoring.", variable);
+        }
+    };
+    parse_size(EV_MQTT_SEND_BUFFER_SIZE, mqtt_settings.buffers.send_buffer_size);
+    parse_size(EV_MQTT_RECV_BUFFER_SIZE, mqtt_settings.buffers.recv_buffer_size);
+
+    // NOLINTNEXTLINE(concurrency-mt-unsafe): not problematic that this function is not threadsafe here
+    const char* growable_buffers = std::getenv(EV_MQTT_GROWABLE_BUFFERS);
+    if (growable_buffers != nullptr) {
+        mqtt_settings.buffers.growable = std::string(growable_buffers) == "1";
+    }
+}
+
+MQTTBufferSettings parse_mqtt_buffer_settings(const nlohmann::json& settings, const MQTTBufferSettings& defaults) {
+    MQTTBufferSettings buffer_settings = defaults;
+    buffer_settings.send_buffer_size = settings.value("mqtt_send_buffer_size", defaults.send_buffer_size);
+    buffer_settings.recv_buffer_size = settings.value("mqtt_recv_buffer_size", defaults.recv_buffer_size);
+    buffer_settings.growable = settings.value("mqtt_growable_buffers", defaults.growable);
+    return buffer_settings;
+}
+
+void populate_mqtt_payload_encoding_from_env(MQTTSettings& mqtt_settings) {
+    // NOLINTNEXTLINE(concurrency-mt-unsafe): not problematic that this function is not threadsafe here
+    const char* payload_encoding = std::getenv(EV_MQTT_PAYLOAD_ENCODING);
+    if (payload_encoding == nullptr) {
+        return;
+    }
+    try {
+        mqtt_settings.payload_encoding = string_to_payload_encoding(payload_encoding);
+    } catch (const EverestConfigError& e) {
+        EVLOG_warning << fmt::format("Environment variable {} set, but {}. Ignoring.", EV_MQTT_PAYLOAD_ENCODING,
+                                     e.what());
+    }
+}
+
+namespace {
+const std::map<std::string, QueueOverflowPolicy> overflow_policies = {
+    {"block", QueueOverflowPolicy::Block},
+    {"drop_oldest", QueueOverflowPolicy::DropOldest},
+    {"drop_newest", QueueOverflowPolicy::DropNewest},
+    {"conflate", QueueOverflowPolicy::ConflatePerTopic},
+};
+
+QueueSettings parse_queue_settings(const nlohmann::json& queues, const std::string& queue) {
+    QueueSettings queue_settings;
+    if (not queues.contains(queue)) {
+        return queue_settings;
+    }
+
+    const auto& settings = queues.at(queue);
+    queue_settings.max_depth = settings.value("max_depth", queue_settings.max_depth);
+    const auto overflow_policy = settings.value("overflow_policy", std::string("block"));
+    const auto policy_it = overflow_policies.find(overflow_policy);
+    if (policy_it == overflow_policies.end()) {
+        throw EverestConfigError(fmt::format("Unknown overflow policy '{}' for queue '{}'", overflow_policy, queue));
+    }
+    queue_settings.overflow_policy = policy_it->second;
+    return queue_settings;
+}
+
+nlohmann::json queue_settings_to_json(const QueueSettings& queue_settings) {
+    for (const auto& [name, policy] : overflow_policies) {
+        if (policy == queue_settings.overflow_policy) {
+            return {{"max_depth", queue_settings.max_depth}, {"overflow_policy", name}};
+        }
+    }
+    return {{"max_depth", queue_settings.max_depth}};
+}
+} // namespace
+
+MQTTQueueSettings parse_mqtt_queue_settings(const nlohmann::json& queues) {
+    return {parse_queue_settings(queues, "receive"), parse_queue_settings(queues, "handler"),
+            parse_queue_settings(queues, "before_connected")};
+}
+
+nlohmann::json mqtt_queue_settings_to_json(const MQTTQueueSettings& queue_settings) {
+    return {{"receive", queue_settings_to_json(queue_settings.receive)},
+            {"handler", queue_settings_to_json(queue_settings.handler)},
+            {"before_connected", queue_settings_to_json(queue_settings.before_connected)}};
+}
+
+void populate_mqtt_queue_settings_from_env(MQTTSettings& mqtt_settings) {
+    // NOLINTNEXTLINE(concurrency-mt-unsafe): not problematic that this function is not threadsafe here
+    const char* queues = std::getenv(EV_MQTT_QUEUES);
+    if (queues == nullptr) {
+        return;
+    }
+    try {
+        mqtt_settings.queues = parse_mqtt_queue_settings(nlohmann::json::parse(queues));
+    } catch (const std::exception& e) {
+        EVLOG_warning << fmt::format("Environment variable {} set, but could not be parsed: {}. Ignoring.",
+                                     EV_MQTT_QUEUES, e.what());
+    }
+}
+
+MQTTDispatchMetricsSettings parse_mqtt_dispatch_metrics_settings(const nlohmann::json& dispatch_metrics) {
+    MQTTDispatchMetricsSettings settings;
+    settings.enabled = dispatch_metrics.value("enabled", false);
+    settings.publish_interval = std::chrono::milliseconds(dispatch_metrics.value("publish_interval_ms", 0));
+    return settings;
+}
+
+void populate_mqtt_dispatch_metrics_settings_from_env(MQTTSettings& mqtt_settings) {
+    // NOLINTNEXTLINE(concurrency-mt-unsafe): not problematic that this function is not threadsafe here
+    const char* publish_interval = std::getenv(EV_MQTT_DISPATCH_METRICS);
+    if (publish_interval == nullptr) {
+        return;
+    }
+    try {
+        mqtt_settings.dispatch_metrics.publish_interval = std::chrono::milliseconds(std::stoll(publish_interval));
+        mqtt_settings.dispatch_metrics.enabled = true;
+    } catch (const std::exception& e) {
+        EVLOG_warning << fmt::format("Environment variable {} set, but could not be parsed: {}. Ignoring.",
+                                     EV_MQTT_DISPATCH_METRICS, e.what());
+    }
+}
+
+MQTTHandlerAccountingSettings parse_mqtt_handler_accounting_settings(const nlohmann::json& handler_accounting) {
+    MQTTHandlerAccountingSettings settings;
+    settings.enabled = handler_accounting.value("enabled", false);
+    settings.budget = std::chrono::milliseconds(handler_accounting.value("budget_ms", 0));
+    return settings;
+}
+
+void populate_mqtt_handler_accounting_settings_from_env(MQTTSettings& mqtt_settings) {
+    // NOLINTNEXTLINE(concurrency-mt-unsafe): not problematic that this function is not threadsafe here
+    const char* budget = std::getenv(EV_MQTT_HANDLER_ACCOUNTING);
+    if (budget == nullptr) {
+        return;
+    }
+    try {
+        mqtt_settings.handler_accounting.budget = std::chrono::milliseconds(std::stoll(budget));
+        mqtt_settings.handler_accounting.enabled = true;
+    } catch (const std::exception& e) {
+        EVLOG_warning << fmt::format("Environment variable {} set, but could not be parsed: {}. Ignoring.",
+                                     EV_MQTT_HANDLER_ACCOUNTING, e.what());
+    }
+}
+
+void populate_mqtt_var_cache_from_env(MQTTSettings& mqtt_settings) {
+    // NOLINTNEXTLINE(concurrency-mt-unsafe): not problematic that this function is not threadsafe here
+    const char* var_cache = std::getenv(EV_MQTT_VAR_CACHE);
+    if (var_cache == nullptr) {
+        return;
+    }
+    mqtt_settings.var_cache = std::string(var_cache) == "1";
+}
+
+void populate_mqtt_topic_aliases_from_env(MQTTSettings& mqtt_settings) {
+    // NOLINTNEXTLINE(concurrency-mt-unsafe): not problematic that this function is not threadsafe here
+    const char* topic_aliases = std::getenv(EV_MQTT_TOPIC_ALIASES);
+    if (topic_aliases == nullptr) {
+        return;
+    }
+    mqtt_settings.topic_aliases = std::string(topic_aliases) == "1";
+}
+
+std::vector<MQTTBrokerShard> parse_mqtt_broker_shards(const nlohmann::json& broker_shards,
+                                                      const MQTTSettings& mqtt_settings,
+                                                      const std::string& telemetry_prefix) {
+    std::vector<MQTTBrokerShard> shards;
+    std::set<std::string> prefixes;
+    for (const auto& shard_json : broker_shards) {
+        MQTTBrokerShard shard;
+        shard.broker_socket_path = shard_json.value("socket_path", "");
+        shard.broker_host = shard_json.value("host", "");
+        shard.broker_port = shard_json.value("port", defaults::MQTT_BROKER_PORT);
+        shard.topic_prefixes = shard_json.value("topics", std::vector<std::string>{});
+        if (shard_json.value("external", false)) {
+            shard.topic_prefixes.push_back(mqtt_settings.external_prefix);
+        }
+        if (shard_json.value("telemetry", false)) {
+            shard.topic_prefixes.push_back(telemetry_prefix);
+        }
+        const auto modules = shard_json.value("modules", std::vector<std::string>{});
+        if (not modules.empty() and mqtt_settings.topic_aliases) {
+            // the cmd, var and res topics of a module do not contain its id with aliases
+            throw EverestConfigError("Modules of an MQTT broker shard cannot be combined with mqtt_topic_aliases");
+        }
+        for (const auto& module_id : modules) {
+            shard.topic_prefixes.push_back(fmt::format("{}modules/{}/", mqtt_settings.everest_prefix, module_id));
+        }
+        if (shard.broker_socket_path.empty() and shard.broker_host.empty()) {
+            throw EverestConfigError("MQTT broker shard without socket_path or host");
+        }
+        if (shard.topic_prefixes.empty()) {
+            throw EverestConfigError(fmt::format("MQTT broker shard {} does not carry any topics",
+                                                 shard.uses_socket() ? shard.broker_socket_path : shard.broker_host));
+        }
+        for (const auto& prefix : shard.topic_prefixes) {
+            if (not prefixes.insert(prefix).second) {
+                throw EverestConfigError(fmt::format("Topic prefix '{}' is carried by several MQTT broker shards",
+                                                     prefix));
+            }
+        }
+        shards.push_back(std::move(shard));
+    }
+    return shards;
+}
+
+nlohmann::json mqtt_broker_shards_to_json(const std::vector<MQTTBrokerShard>& broker_shards) {
+    auto shards = nlohmann::json::array();
+    for (const auto& shard : broker_shards) {
+        shards.push_back({{"socket_path", shard.broker_socket_path},
+                          {"host", shard.broker_host},
+                          {"port", shard.broker_port},
+                          {"topics", shard.topic_prefixes}});
+    }
+    return shards;
+}
+
+void populate_mqtt_broker_shards_from_env(MQTTSettings& mqtt_settings) {
+    // NOLINTNEXTLINE(concurrency-mt-unsafe): not problematic that this function is not threadsafe here
+    const char* broker_shards = std::getenv(EV_MQTT_BROKER_SHARDS);
+    if (broker_shards == nullptr) {
+        return;
+    }
+    try {
+        // the topics have already been resolved by the manager
+        mqtt_settings.broker_shards = parse_mqtt_broker_shards(nlohmann::json::parse(broker_shards), mqtt_settings, "");
+    } catch (const std::exception& e) {
+        EVLOG_warning << fmt::format("Environment variable {} set, but could not be parsed: {}. Ignoring.",
+                                     EV_MQTT_BROKER_SHARDS, e.what());
+    }
+}
+
+void populate_mqtt_module_settings_from_env(MQTTSettings& mqtt_settings) {
+    populate_mqtt_buffer_settings_from_env(mqtt_settings);
+    populate_mqtt_payload_encoding_from_env(mqtt_settings);
+    populate_mqtt_queue_settings_from_env(mqtt_settings);
+    populate_mqtt_dispatch_metrics_settings_from_env(mqtt_settings);
+    populate_mqtt_handler_accounting_settings_from_env(mqtt_settings);
+    populate_mqtt_var_cache_from_env(mqtt_settings);
+    populate_mqtt_topic_aliases_from_env(mqtt_settings);
+    populate_mqtt_broker_shards_from_env(mqtt_settings);
+}
+
 void populate_module_info_path_from_runtime_settings(ModuleInfo& mi, const RuntimeSettings& rs) {
     mi.paths.etc = rs.etc_dir;
     mi.paths.libexec = rs.modules_dir / mi.name;
@@ -36,7 +286,8 @@ void populate_module_info_path_from_runtime_settings(ModuleInfo& mi, const Runti
 
 RuntimeSettings::RuntimeSettings(const fs::path& prefix, const fs::path& etc_dir, const fs::path& data_dir,
                                  const fs::path& modules_dir, const fs::path& logging_config_file,
-                                 const std::string& telemetry_prefix, bool telemetry_enabled, bool validate_schema) :
+                                 const std::string& telemetry_prefix, bool telemetry_enabled, bool validate_schema,
+                                 const ValidationPolicy& validation_policy) :
     prefix(prefix),
     etc_dir(etc_dir),
     data_dir(data_dir),
@@ -44,7 +295,8 @@ RuntimeSettings::RuntimeSettings(const fs::path& prefix, const fs::path& etc_dir
     logging_config_file(logging_config_file),
     telemetry_prefix(telemetry_prefix),
     telemetry_enabled(telemetry_enabled),
-    validate_schema(validate_schema) {
+    validate_schema(validate_schema),
+    validation_policy(validation_policy) {
 }
 
 RuntimeSettings::RuntimeSettings(const nlohmann::json& json) {
@@ -55,6 +307,7 @@ RuntimeSettings::RuntimeSettings(const nlohmann::json& json) {
     this->telemetry_prefix = json.at("telemetry_prefix").get<std::string>();
     this->telemetry_enabled = json.at("telemetry_enabled").get<bool>();
     this->validate_schema = json.at("validate_schema").get<bool>();
+    this->validation_policy = json.value("validation_policy", ValidationPolicy{});
 }
 
 ManagerSettings::ManagerSettings(const std::string& prefix_, const std::string& config_) {
@@ -218,6 +471,11 @@ ManagerSettings::ManagerSettings(const std::string& prefix_, const std::string&
         www_dir = assert_dir(default_www_dir, "Default www directory");
     }
 
+    const auto settings_config_cache_dir_it = settings.find("config_cache_dir");
+    if (settings_config_cache_dir_it != settings.end()) {
+        config_cache_dir = get_prefixed_path_from_json(*settings_config_cache_dir_it, prefix);
+    }
+
     fs::path logging_config_file;
     const auto settings_logging_config_file_it = settings.find("logging_config_file");
     if (settings_logging_config_file_it != settings.end()) {
@@ -249,6 +507,11 @@ ManagerSettings::ManagerSettings(const std::string& prefix_, const std::string&
         controller_rpc_timeout_ms = defaults::CONTROLLER_RPC_TIMEOUT_MS;
     }
 
+    controller_ipc_binary = settings.value("controller_ipc_binary", false);
+
+    metrics_port = settings.value("metrics_port", 0);
+    resource_monitor_interval_ms = settings.value("resource_monitor_interval_ms", 0);
+
     std::string mqtt_broker_socket_path;
     std::string mqtt_broker_host;
     int mqtt_broker_port = 0;
@@ -341,8 +604,31 @@ ManagerSettings::ManagerSettings(const std::string& prefix_, const std::string&
                                mqtt_external_prefix);
     }
 
+    this->mqtt_settings.buffers = parse_mqtt_buffer_settings(settings, MQTTBufferSettings{});
+    this->mqtt_settings.queues = parse_mqtt_queue_settings(settings.value("mqtt_queues", nlohmann::json::object()));
+    this->mqtt_settings.dispatch_metrics =
+        parse_mqtt_dispatch_metrics_settings(settings.value("mqtt_dispatch_metrics", nlohmann::json::object()));
+    this->mqtt_settings.handler_accounting =
+        parse_mqtt_handler_accounting_settings(settings.value("mqtt_handler_accounting", nlohmann::json::object()));
+    this->mqtt_settings.var_cache = settings.value("mqtt_var_cache", false);
+    this->mqtt_settings.topic_aliases = settings.value("mqtt_topic_aliases", false);
+    this->mqtt_settings.payload_encoding =
+        string_to_payload_encoding(settings.value("mqtt_payload_encoding", defaults::MQTT_PAYLOAD_ENCODING));
+
     run_as_user = settings.value("run_as_user", "");
 
+    shm_transport = settings.value("shm_transport", false);
+    shared_config_image = settings.value("shared_config_image", false);
+    compress_retained_config = settings.value("compress_retained_config", false);
+    python_zygote = settings.value("python_zygote", false);
+    javascript_host = settings.value("javascript_host", false);
+    python_host = settings.value("python_host", false);
+
+    const auto settings_mqtt_qos_it = settings.find("mqtt_qos");
+    if (settings_mqtt_qos_it != settings.end()) {
+        mqtt_qos = settings_mqtt_qos_it->get<int>();
+    }
+
     auto version_information_path = data_dir / VERSION_INFORMATION_FILE;
     if (fs::exists(version_information_path)) {
         std::ifstream ifs(version_information_path.string());
@@ -364,6 +650,13 @@ ManagerSettings::ManagerSettings(const std::string& prefix_, const std::string&
         telemetry_prefix = telemetry_prefix += "/";
     }
 
+    this->mqtt_settings.broker_shards = parse_mqtt_broker_shards(
+        settings.value("mqtt_broker_shards", nlohmann::json::array()), this->mqtt_settings, telemetry_prefix);
+    if (not this->mqtt_settings.broker_shards.empty() and shm_transport) {
+        // every broker connection of a module would attach to the same shared memory ring
+        throw BootException("shm_transport cannot be combined with mqtt_broker_shards");
+    }
+
     bool telemetry_enabled = defaults::TELEMETRY_ENABLED;
     const auto settings_telemetry_enabled_it = settings.find("telemetry_enabled");
     if (settings_telemetry_enabled_it != settings.end()) {
@@ -380,8 +673,27 @@ ManagerSettings::ManagerSettings(const std::string& prefix_, const std::string&
         validate_schema = defaults::VALIDATE_SCHEMA;
     }
 
-    runtime_settings = std::make_unique<RuntimeSettings>(prefix, etc_dir, data_dir, modules_dir, logging_config_file,
-                                                         telemetry_prefix, telemetry_enabled, validate_schema);
+    ValidationPolicy validation_policy;
+    const auto settings_validation_mode_it = settings.find("validation_mode");
+    if (settings_validation_mode_it != settings.end()) {
+        validation_policy.mode = validation_mode_from_string(settings_validation_mode_it->get<std::string>());
+    }
+    const auto settings_validation_first_n_it = settings.find("validation_first_n");
+    if (settings_validation_first_n_it != settings.end()) {
+        validation_policy.first_n = settings_validation_first_n_it->get<std::uint64_t>();
+    }
+    const auto settings_validation_sample_rate_it = settings.find("validation_sample_rate");
+    if (settings_validation_sample_rate_it != settings.end()) {
+        validation_policy.sample_rate = settings_validation_sample_rate_it->get<std::uint64_t>();
+    }
+    const auto settings_validation_async_it = settings.find("validation_async");
+    if (settings_validation_async_it != settings.end()) {
+        validation_policy.asynchronous = settings_validation_async_it->get<bool>();
+    }
+
+    runtime_settings =
+        std::make_unique<RuntimeSettings>(prefix, etc_dir, data_dir, modules_dir, logging_config_file, telemetry_prefix,
+                                          telemetry_enabled, validate_schema, validation_policy);
 }
 
 const RuntimeSettings& ManagerSettings::get_runtime_settings() const {
@@ -429,7 +741,8 @@ int ModuleLoader::initialize() {
 
     const auto& rs = this->runtime_settings;
     try {
-        const auto config = Config(this->mqtt_settings, result);
+        const auto shared_config = std::make_shared<const Config>(this->mqtt_settings, result);
+        const auto& config = *shared_config;
         const auto config_instantiation_time = std::chrono::system_clock::now();
         EVLOG_debug
             << "Module " << fmt::format(TERMINAL_STYLE_OK, "{}", module_id) << " after Config() instantiation ["
@@ -457,8 +770,8 @@ int ModuleLoader::initialize() {
         }
         Logging::update_process_name(module_identifier);
 
-        auto everest = Everest(this->module_id, config, rs->validate_schema, this->mqtt, rs->telemetry_prefix,
-                               rs->telemetry_enabled);
+        auto everest = Everest(this->module_id, shared_config, rs->validate_schema, this->mqtt, rs->telemetry_prefix,
+                               rs->telemetry_enabled, rs->validation_policy);
 
         // module import
         EVLOG_debug << fmt::format("Initializing module {}...", module_identifier);
@@ -480,6 +793,16 @@ int ModuleLoader::initialize() {
             return everest.call_cmd(req, cmd_name, std::move(args));
         };
 
+        module_adapter.call_async = [&everest](const Requirement& req, const std::string& cmd_name, Parameters args,
+                                               CmdResultCallback callback) {
+            everest.call_cmd_async(req, cmd_name, std::move(args), std::move(callback));
+        };
+
+        module_adapter.call_all = [&everest](const std::string& requirement_id, const std::string& cmd_name,
+                                             Parameters args) {
+            return everest.call_cmd_all(requirement_id, cmd_name, args);
+        };
+
         module_adapter.publish = [&everest](const std::string& param1, const std::string& param2, Value param3) {
             return everest.publish_var(param1, param2, std::move(param3));
         };
@@ -489,6 +812,11 @@ int ModuleLoader::initialize() {
             return everest.subscribe_var(req, var_name, callback);
         };
 
+        module_adapter.subscribe_latest_value = [&everest](const Requirement& req, const std::string& var_name,
+                                                           const ValueCallback& callback) {
+            return everest.subscribe_var(req, var_name, callback, VarSubscriptionMode::LatestValue);
+        };
+
         module_adapter.get_error_manager_impl = [&everest](const std::string& impl_id) {
             return everest.get_error_manager_impl(impl_id);
         };
@@ -528,6 +856,14 @@ int ModuleLoader::initialize() {
             return everest.provide_external_mqtt_handler(topic, handler);
         };
 
+        module_adapter.ext_mqtt_publish_raw = [&everest](const std::string& topic, std::string_view payload) {
+            everest.external_mqtt_publish_raw(topic, payload);
+        };
+
+        module_adapter.ext_mqtt_subscribe_raw = [&everest](const std::string& topic, const RawHandler& handler) {
+            return everest.provide_external_mqtt_raw_handler(topic, handler);
+        };
+
         module_adapter.telemetry_publish = [&everest](const std::string& category, const std::string& subcategory,
                                                       const std::string& type, const TelemetryMap& telemetry) {
             return everest.telemetry_publish(category, subcategory, type, telemetry);
@@ -694,6 +1030,7 @@ bool ModuleLoader::parse_command_line(int argc, char* argv[]) {
         populate_mqtt_settings(this->mqtt_settings, mqtt_broker_host, mqtt_broker_port, mqtt_everest_prefix,
                                mqtt_external_prefix);
     }
+    populate_mqtt_module_settings_from_env(this->mqtt_settings);
 
     if (vm.count("log_config") != 0) {
         auto command_line_logging_config_file = vm["log_config"].as<std::string>();
@@ -729,7 +1066,8 @@ void adl_serializer<Everest::RuntimeSettings>::to_json(nlohmann::json& j, const
          {"modules_dir", r.modules_dir},
          {"telemetry_prefix", r.telemetry_prefix},
          {"telemetry_enabled", r.telemetry_enabled},
-         {"validate_schema", r.validate_schema}};
+         {"validate_schema", r.validate_schema},
+         {"validation_policy", r.validation_policy}};
 }
 
 void adl_serializer<Everest::RuntimeSettings>::from_json(const nlohmann::json& j, Everest::RuntimeSettings& r) {
@@ -740,5 +1078,6 @@ void adl_serializer<Everest::RuntimeSettings>::from_json(const nlohmann::json& j
     r.telemetry_prefix = j.at("telemetry_prefix").get<std::string>();
     r.telemetry_enabled = j.at("telemetry_enabled").get<bool>();
     r.validate_schema = j.at("validate_schema").get<bool>();
+    r.validation_policy = j.value("validation_policy", Everest::ValidationPolicy{});
 }
 NLOHMANN_JSON_NAMESPACE_END
\ No newline at end of file
@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <cmath>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <fmt/core.h>
+
+#include <utils/schema_validator.hpp>
+
+namespace Everest {
+
+SchemaValidator::SchemaValidator(NativeValidator native) : native(native) {
+}
+
+SchemaValidator::SchemaValidator(std::unique_ptr<nlohmann::json_schema::json_validator> interpreted) :
+    interpreted(std::move(interpreted)) {
+}
+
+void SchemaValidator::validate(const nlohmann::json& value) const {
+    if (this->native != nullptr) {
+        this->native(value);
+    } else {
+        this->interpreted->validate(value);
+    }
+}
+
+bool SchemaValidator::is_native() const {
+    return this->native != nullptr;
+}
+
+namespace native_validators {
+
+namespace {
+struct Registry {
+    std::mutex mutex;
+    std::unordered_map<std::string, NativeValidator> validators; ///< by interface and schema path
+};
+
+// constructed on first use, since generated validators register themselves during static initialization
+Registry& get_registry() {
+    static Registry registry;
+    return registry;
+}
+} // namespace
+
+void add(const std::string& interface_name, const std::string& schema_path, NativeValidator validator) {
+    auto& registry = get_registry();
+    const std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.validators[fmt::format("{}#/{}", interface_name, schema_path)] = validator;
+}
+
+NativeValidator get(const std::string& interface_name, const std::string& schema_path) {
+    auto& registry = get_registry();
+    const std::lock_guard<std::mutex> lock(registry.mutex);
+    const auto validator = registry.validators.find(fmt::format("{}#/{}", interface_name, schema_path));
+    if (validator == registry.validators.end()) {
+        return nullptr;
+    }
+    return validator->second;
+}
+
+void fail(const char* location, const char* reason) {
+    throw std::invalid_argument(fmt::format("At {} of the schema: {}", location, reason));
+}
+
+bool is_integer(const nlohmann::json& value) {
+    if (value.is_number_integer()) {
+        return true;
+    }
+    return value.is_number_float() and std::nearbyint(value.get<double>()) == value.get<double>();
+}
+
+std::size_t utf8_length(const std::string& value) {
+    std::size_t length = 0;
+    for (const auto c : value) {
+        // continuation bytes of multi byte code points start with 0b10
+        if ((static_cast<unsigned char>(c) & 0xC0) != 0x80) {
+            length++;
+        }
+    }
+    return length;
+}
+
+} // namespace native_validators
+
+} // namespace Everest
@@ -8,7 +8,80 @@
 
 #include <unistd.h>
 
+#include <fmt/core.h>
+#include <sys/epoll.h>
+
+#include <everest/logging.hpp>
+
 namespace Everest {
+
+speed_t baud_to_speed(int baud) {
+    switch (baud) {
+    case 9600:
+        return B9600;
+    case 19200:
+        return B19200;
+    case 38400:
+        return B38400;
+    case 57600:
+        return B57600;
+    case 115200:
+        return B115200;
+    case 230400:
+        return B230400;
+#ifdef B460800
+    case 460800:
+        return B460800;
+#endif
+#ifdef B500000
+    case 500000:
+        return B500000;
+#endif
+#ifdef B576000
+    case 576000:
+        return B576000;
+#endif
+#ifdef B921600
+    case 921600:
+        return B921600;
+#endif
+#ifdef B1000000
+    case 1000000:
+        return B1000000;
+#endif
+#ifdef B1152000
+    case 1152000:
+        return B1152000;
+#endif
+#ifdef B1500000
+    case 1500000:
+        return B1500000;
+#endif
+#ifdef B2000000
+    case 2000000:
+        return B2000000;
+#endif
+#ifdef B2500000
+    case 2500000:
+        return B2500000;
+#endif
+#ifdef B3000000
+    case 3000000:
+        return B3000000;
+#endif
+#ifdef B3500000
+    case 3500000:
+        return B3500000;
+#endif
+#ifdef B4000000
+    case 4000000:
+        return B4000000;
+#endif
+    default:
+        return 0;
+    }
+}
+
 Serial::Serial() {
     fd = 0;
     baud = 0;
@@ -30,27 +103,8 @@ bool Serial::openDevice(const char* device, int _baud) {
     } // else printf ("Serial: opened %s as %i\n", device, fd);
     cobsDecodeReset();
 
-    switch (_baud) {
-    case 9600:
-        baud = B9600;
-        break;
-    case 19200:
-        baud = B19200;
-        break;
-    case 38400:
-        baud = B38400;
-        break;
-    case 57600:
-        baud = B57600;
-        break;
-    case 115200:
-        baud = B115200;
-        break;
-    case 230400:
-        baud = B230400;
-        break;
-    default:
-        baud = 0;
+    baud = baud_to_speed(_baud);
+    if (baud == 0) {
         return false;
     }
 
@@ -162,4 +216,193 @@ void Serial::cobsDecodeByte(uint8_t byte) {
     block--;
 }
 
+AsyncSerial::AsyncSerial(EventLoop& event_loop_, const PacketHandler& handler_, std::size_t max_packet_size,
+                         std::size_t max_pending_tx_) :
+    event_loop(event_loop_), handler(handler_), decoder(max_packet_size), max_pending_tx(max_pending_tx_) {
+}
+
+AsyncSerial::~AsyncSerial() {
+    close_device();
+}
+
+bool AsyncSerial::open_device(const std::string& device, int baud) {
+    const auto speed = baud_to_speed(baud);
+    if (speed == 0) {
+        EVLOG_error << fmt::format("Serial: baud rate {} is not supported", baud);
+        return false;
+    }
+
+    const auto device_fd = open(device.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (device_fd < 0) {
+        EVLOG_error << fmt::format("Serial: could not open {}: {}", device, strerror(errno));
+        return false;
+    }
+
+    struct termios tty {};
+    if (tcgetattr(device_fd, &tty) != 0) {
+        EVLOG_error << fmt::format("Serial: tcgetattr on {} failed: {}", device, strerror(errno));
+        close(device_fd);
+        return false;
+    }
+    cfmakeraw(&tty);
+    cfsetospeed(&tty, speed);
+    cfsetispeed(&tty, speed);
+    tty.c_cflag |= (CLOCAL | CREAD); // ignore modem controls, enable reading
+    tty.c_cflag &= ~(PARENB | PARODD | CSTOPB | CRTSCTS);
+    // reads never wait, the event loop reports when data is available
+    tty.c_cc[VMIN] = 0;
+    tty.c_cc[VTIME] = 0;
+    if (tcsetattr(device_fd, TCSANOW, &tty) != 0) {
+        EVLOG_error << fmt::format("Serial: tcsetattr on {} failed: {}", device, strerror(errno));
+        close(device_fd);
+        return false;
+    }
+
+    return attach(device_fd);
+}
+
+bool AsyncSerial::attach(int device_fd) {
+    close_device();
+
+    const auto flags = fcntl(device_fd, F_GETFL);
+    if (flags == -1 or fcntl(device_fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+        EVLOG_error << fmt::format("Serial: could not make fd {} non-blocking: {}", device_fd, strerror(errno));
+        close(device_fd);
+        return false;
+    }
+    this->write_fd = fcntl(device_fd, F_DUPFD_CLOEXEC, 0);
+    if (this->write_fd == -1) {
+        EVLOG_error << fmt::format("Serial: could not duplicate fd {}: {}", device_fd, strerror(errno));
+        close(device_fd);
+        return false;
+    }
+
+    {
+        const std::lock_guard<std::mutex> lock(this->tx_mutex);
+        this->fd = device_fd;
+        this->tx_buffer.clear();
+        this->tx_offset = 0;
+    }
+    this->decoder.reset();
+    this->read_id = this->event_loop.add_fd(this->fd, EPOLLIN | EPOLLRDHUP,
+                                            [this](std::uint32_t events) { this->handle_readable(events); });
+    return true;
+}
+
+void AsyncSerial::close_device() {
+    if (this->read_id != 0) {
+        this->event_loop.remove(this->read_id);
+        this->read_id = 0;
+    }
+
+    const std::lock_guard<std::mutex> lock(this->tx_mutex);
+    if (this->write_id != 0) {
+        this->event_loop.remove(this->write_id);
+        this->write_id = 0;
+    }
+    if (this->write_fd != -1) {
+        close(this->write_fd);
+        this->write_fd = -1;
+    }
+    if (this->fd != -1) {
+        close(this->fd);
+        this->fd = -1;
+    }
+}
+
+bool AsyncSerial::send_packet(const std::uint8_t* data, std::size_t length) {
+    const std::lock_guard<std::mutex> lock(this->tx_mutex);
+    if (this->fd == -1 or this->tx_buffer.size() - this->tx_offset + length > this->max_pending_tx) {
+        return false;
+    }
+
+    if (this->tx_offset == this->tx_buffer.size()) {
+        this->tx_buffer.clear();
+        this->tx_offset = 0;
+    }
+    const auto frame_offset = this->tx_buffer.size();
+    this->tx_buffer.resize(frame_offset + cobs_max_encoded_size(length));
+    const auto frame_size = cobs_encode(data, length, this->tx_buffer.data() + frame_offset);
+    this->tx_buffer.resize(frame_offset + frame_size);
+
+    // while the device is not writable, the frame is appended and written by handle_writable()
+    if (this->write_id == 0) {
+        write_pending();
+    }
+    return true;
+}
+
+std::size_t AsyncSerial::get_dropped_frames() const {
+    return this->decoder.get_dropped_frames();
+}
+
+void AsyncSerial::write_pending() {
+    while (this->tx_offset < this->tx_buffer.size()) {
+        const auto written =
+            write(this->fd, this->tx_buffer.data() + this->tx_offset, this->tx_buffer.size() - this->tx_offset);
+        if (written >= 0) {
+            this->tx_offset += written;
+            continue;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN or errno == EWOULDBLOCK) {
+            if (this->write_id == 0) {
+                this->write_id = this->event_loop.add_fd(this->write_fd, EPOLLOUT,
+                                                         [this](std::uint32_t) { this->handle_writable(); });
+            }
+            return;
+        }
+        EVLOG_error << fmt::format("Serial: write failed, dropping {} bytes: {}",
+                                   this->tx_buffer.size() - this->tx_offset, strerror(errno));
+        break;
+    }
+
+    this->tx_buffer.clear();
+    this->tx_offset = 0;
+    if (this->write_id != 0) {
+        this->event_loop.remove(this->write_id);
+        this->write_id = 0;
+    }
+}
+
+void AsyncSerial::handle_writable() {
+    const std::lock_guard<std::mutex> lock(this->tx_mutex);
+    if (this->fd != -1) {
+        write_pending();
+    }
+}
+
+void AsyncSerial::handle_readable(std::uint32_t events) {
+    while (true) {
+        const auto size = read(this->fd, this->rx_buffer.data(), this->rx_buffer.size());
+        if (size > 0) {
+            this->decoder.feed(this->rx_buffer.data(), size, this->handler);
+            if (static_cast<std::size_t>(size) < this->rx_buffer.size()) {
+                // drained, the event loop reports the next bytes
+                break;
+            }
+            continue;
+        }
+        if (size == -1 and errno == EINTR) {
+            continue;
+        }
+        if (size == -1 and (errno == EAGAIN or errno == EWOULDBLOCK)) {
+            break;
+        }
+        // the device is gone, stop polling it instead of spinning on the hang up
+        EVLOG_error << fmt::format("Serial: device closed ({})", size == 0 ? "end of file" : strerror(errno));
+        this->event_loop.remove(this->read_id);
+        this->read_id = 0;
+        return;
+    }
+
+    if ((events & (EPOLLHUP | EPOLLERR)) != 0 and (events & EPOLLIN) == 0) {
+        EVLOG_error << "Serial: device hung up";
+        this->event_loop.remove(this->read_id);
+        this->read_id = 0;
+    }
+}
+
 } // namespace Everest
@@ -0,0 +1,450 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include <everest/exceptions.hpp>
+#include <everest/logging.hpp>
+
+#include <utils/shm_transport.hpp>
+
+namespace Everest {
+
+namespace {
+constexpr uint32_t SHM_TRANSPORT_MAGIC = 0x45565348; // "EVSH"
+constexpr std::size_t SUBSCRIBER_WORDS = SHM_TRANSPORT_MAX_SLOTS / 64;
+constexpr std::size_t ALIGNMENT = 64;
+
+struct TopicEntry {
+    uint64_t hash;                            ///< FNV-1a hash of the topic, 0 marks an unused entry
+    uint32_t topic_size;                      ///< Size of the topic, which is not null-terminated
+    char topic[SHM_TRANSPORT_MAX_TOPIC_SIZE]; ///< The topic, so topics with colliding hashes are told apart
+    uint64_t subscribers[SUBSCRIBER_WORDS];   ///< Bitmask of the slots subscribed to this topic
+
+    bool matches(uint64_t topic_hash, const std::string& other_topic) const {
+        return this->hash == topic_hash and this->topic_size == other_topic.size() and
+               std::memcmp(this->topic, other_topic.data(), other_topic.size()) == 0;
+    }
+};
+
+struct RecordHeader {
+    uint32_t topic_size;
+    uint32_t payload_size;
+};
+
+std::size_t align(std::size_t size) {
+    return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+uint64_t topic_hash(const std::string& topic) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const auto c : topic) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ULL;
+    }
+    return (hash == 0) ? 1 : hash;
+}
+
+void init_shared_mutex(pthread_mutex_t* mutex) {
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    // a module crashing while holding the lock must not block all other modules
+    pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+/// \brief Scoped lock of a robust process shared mutex
+class SharedMutexLock {
+public:
+    explicit SharedMutexLock(pthread_mutex_t* mutex) : mutex(mutex) {
+        if (pthread_mutex_lock(this->mutex) == EOWNERDEAD) {
+            pthread_mutex_consistent(this->mutex);
+        }
+    }
+    ~SharedMutexLock() {
+        pthread_mutex_unlock(this->mutex);
+    }
+
+    SharedMutexLock(SharedMutexLock const&) = delete;
+    void operator=(SharedMutexLock const&) = delete;
+
+private:
+    pthread_mutex_t* mutex;
+};
+} // namespace
+
+struct ShmTransport::SegmentHeader {
+    uint32_t magic;
+    uint32_t slot_count;
+    uint64_t ring_size;
+    pthread_mutex_t table_mutex;
+    TopicEntry topics[SHM_TRANSPORT_MAX_TOPICS];
+};
+
+struct ShmTransport::RingHeader {
+    pthread_mutex_t mutex;
+    uint64_t head; ///< Total number of bytes written to this ring
+    uint64_t tail; ///< Total number of bytes read from this ring
+
+    uint8_t* data() {
+        return reinterpret_cast<uint8_t*>(this) + align(sizeof(RingHeader));
+    }
+};
+
+std::unique_ptr<ShmTransport> ShmTransport::create(const std::string& name, std::size_t slot_count,
+                                                   std::size_t ring_size) {
+    if (slot_count > SHM_TRANSPORT_MAX_SLOTS) {
+        throw EverestInternalError(fmt::format("Shared memory transport supports at most {} modules, requested {}",
+                                               SHM_TRANSPORT_MAX_SLOTS, slot_count));
+    }
+
+    // a segment left over from a previous run that did not shut down cleanly is replaced
+    shm_unlink(name.c_str());
+    const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+    if (fd == -1) {
+        throw EverestInternalError(fmt::format("Could not create shared memory segment {}: {}", name, strerror(errno)));
+    }
+
+    const auto segment_size = align(sizeof(SegmentHeader)) + slot_count * align(sizeof(RingHeader) + ring_size);
+    if (ftruncate(fd, static_cast<off_t>(segment_size)) == -1) {
+        close(fd);
+        shm_unlink(name.c_str());
+        throw EverestInternalError(fmt::format("Could not resize shared memory segment {}: {}", name, strerror(errno)));
+    }
+
+    void* segment = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (segment == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        throw EverestInternalError(fmt::format("Could not map shared memory segment {}: {}", name, strerror(errno)));
+    }
+
+    // the segment is zero-filled by ftruncate, so all topic entries and ring positions start out empty
+    auto* header = static_cast<SegmentHeader*>(segment);
+    header->slot_count = slot_count;
+    header->ring_size = ring_size;
+    init_shared_mutex(&header->table_mutex);
+
+    // eventfds are deliberately created without EFD_CLOEXEC, so the spawned modules inherit them
+    std::vector<int> event_fds;
+    for (std::size_t slot = 0; slot < slot_count; slot++) {
+        event_fds.push_back(eventfd(0, EFD_NONBLOCK));
+    }
+
+    auto transport = std::unique_ptr<ShmTransport>(
+        new ShmTransport(name, segment, segment_size, std::move(event_fds), SHM_TRANSPORT_MAX_SLOTS, getpid()));
+    for (std::size_t slot = 0; slot < slot_count; slot++) {
+        init_shared_mutex(&transport->ring(slot).mutex);
+    }
+    header->magic = SHM_TRANSPORT_MAGIC;
+
+    return transport;
+}
+
+std::unique_ptr<ShmTransport> ShmTransport::attach_from_env() {
+    // NOLINTBEGIN(concurrency-mt-unsafe): not problematic that this function is not threadsafe here
+    const char* name = std::getenv(EV_SHM_TRANSPORT_NAME);
+    const char* slot = std::getenv(EV_SHM_TRANSPORT_SLOT);
+    const char* event_fds_list = std::getenv(EV_SHM_TRANSPORT_EVENTFDS);
+    // NOLINTEND(concurrency-mt-unsafe)
+    if (name == nullptr or slot == nullptr or event_fds_list == nullptr) {
+        return nullptr;
+    }
+
+    std::vector<int> event_fds;
+    const std::string event_fds_string = event_fds_list;
+    std::size_t start = 0;
+    while (start < event_fds_string.size()) {
+        auto end = event_fds_string.find(',', start);
+        if (end == std::string::npos) {
+            end = event_fds_string.size();
+        }
+        event_fds.push_back(std::stoi(event_fds_string.substr(start, end - start)));
+        start = end + 1;
+    }
+
+    const int fd = shm_open(name, O_RDWR, 0);
+    if (fd == -1) {
+        EVLOG_warning << fmt::format("Could not open shared memory segment {}, using MQTT only: {}", name,
+                                     strerror(errno));
+        return nullptr;
+    }
+    struct stat segment_stat {};
+    if (fstat(fd, &segment_stat) == -1) {
+        close(fd);
+        return nullptr;
+    }
+    const auto segment_size = static_cast<std::size_t>(segment_stat.st_size);
+    void* segment = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (segment == MAP_FAILED) {
+        EVLOG_warning << fmt::format("Could not map shared memory segment {}, using MQTT only: {}", name,
+                                     strerror(errno));
+        return nullptr;
+    }
+
+    const auto* header = static_cast<SegmentHeader*>(segment);
+    const auto own_slot = std::stoul(slot);
+    if (header->magic != SHM_TRANSPORT_MAGIC or own_slot >= header->slot_count or
+        event_fds.size() != header->slot_count) {
+        EVLOG_warning << fmt::format("Shared memory segment {} is invalid, using MQTT only", name);
+        munmap(segment, segment_size);
+        return nullptr;
+    }
+
+    return std::unique_ptr<ShmTransport>(
+        new ShmTransport(name, segment, segment_size, std::move(event_fds), own_slot, 0));
+}
+
+ShmTransport::ShmTransport(std::string name, void* segment, std::size_t segment_size, std::vector<int> event_fds,
+                           std::size_t slot, pid_t owner_pid) :
+    name(std::move(name)),
+    segment(segment),
+    segment_size(segment_size),
+    event_fds(std::move(event_fds)),
+    slot(slot),
+    owner_pid(owner_pid) {
+}
+
+ShmTransport::~ShmTransport() {
+    if (this->receive_thread.joinable()) {
+        eventfd_write(this->stop_event_fd, 1);
+        this->receive_thread.join();
+        close(this->stop_event_fd);
+    }
+
+    munmap(this->segment, this->segment_size);
+    // forked module processes inherit the manager's instance, only the manager itself removes the segment
+    if (this->owner_pid == getpid()) {
+        for (const auto fd : this->event_fds) {
+            close(fd);
+        }
+        shm_unlink(this->name.c_str());
+    }
+}
+
+void ShmTransport::setup_environment(std::size_t slot) const {
+    std::string event_fds_list;
+    for (const auto fd : this->event_fds) {
+        if (not event_fds_list.empty()) {
+            event_fds_list += ",";
+        }
+        event_fds_list += std::to_string(fd);
+    }
+
+    setenv(EV_SHM_TRANSPORT_NAME, this->name.c_str(), 1);
+    setenv(EV_SHM_TRANSPORT_SLOT, std::to_string(slot).c_str(), 1);
+    setenv(EV_SHM_TRANSPORT_EVENTFDS, event_fds_list.c_str(), 1);
+}
+
+ShmTransport::RingHeader& ShmTransport::ring(std::size_t slot) const {
+    const auto* header = static_cast<SegmentHeader*>(this->segment);
+    auto* rings = static_cast<uint8_t*>(this->segment) + align(sizeof(SegmentHeader));
+    return *reinterpret_cast<RingHeader*>(rings + slot * align(sizeof(RingHeader) + header->ring_size));
+}
+
+bool ShmTransport::publish(const std::string& topic, std::string_view payload) {
+    if (topic.size() > SHM_TRANSPORT_MAX_TOPIC_SIZE) {
+        return false;
+    }
+    auto* header = static_cast<SegmentHeader*>(this->segment);
+    const auto hash = topic_hash(topic);
+
+    uint64_t subscribers[SUBSCRIBER_WORDS] = {};
+    bool found = false;
+    {
+        const SharedMutexLock lock(&header->table_mutex);
+        for (std::size_t probe = 0; probe < SHM_TRANSPORT_MAX_TOPICS; probe++) {
+            const auto& entry = header->topics[(hash + probe) % SHM_TRANSPORT_MAX_TOPICS];
+            if (entry.hash == 0) {
+                break;
+            }
+            if (entry.matches(hash, topic)) {
+                std::memcpy(subscribers, entry.subscribers, sizeof(subscribers));
+                found = true;
+                break;
+            }
+        }
+    }
+    if (not found) {
+        return false;
+    }
+
+    bool delivered = false;
+    for (std::size_t subscriber = 0; subscriber < header->slot_count; subscriber++) {
+        if ((subscribers[subscriber / 64] & (uint64_t{1} << (subscriber % 64))) == 0) {
+            continue;
+        }
+        delivered = true;
+
+        // waiting for a slow receiver would block the publishing thread, so the message is dropped for it instead
+        if (not write_to_ring(subscriber, topic, payload) and this->dropped_messages++ == 0) {
+            EVLOG_warning << fmt::format("Shared memory ring of slot {} is full, dropping message on {}, further "
+                                         "drops are only counted",
+                                         subscriber, topic);
+        }
+        eventfd_write(this->event_fds.at(subscriber), 1);
+    }
+
+    return delivered;
+}
+
+bool ShmTransport::write_to_ring(std::size_t slot, const std::string& topic, std::string_view payload) {
+    const auto ring_size = static_cast<SegmentHeader*>(this->segment)->ring_size;
+    auto& ring = this->ring(slot);
+
+    const RecordHeader record{static_cast<uint32_t>(topic.size()), static_cast<uint32_t>(payload.size())};
+    const auto record_size = sizeof(RecordHeader) + topic.size() + payload.size();
+    if (record_size > ring_size) {
+        EVLOG_error << fmt::format("Message on {} does not fit into the shared memory ring", topic);
+        // report success, retrying will not help
+        return true;
+    }
+
+    const SharedMutexLock lock(&ring.mutex);
+    if (record_size > ring_size - (ring.head - ring.tail)) {
+        return false;
+    }
+
+    const auto copy_in = [&ring, ring_size](const void* source, std::size_t size) {
+        const auto offset = ring.head % ring_size;
+        const auto first_part = std::min<std::size_t>(size, ring_size - offset);
+        std::memcpy(ring.data() + offset, source, first_part);
+        std::memcpy(ring.data(), static_cast<const uint8_t*>(source) + first_part, size - first_part);
+        ring.head += size;
+    };
+    copy_in(&record, sizeof(record));
+    copy_in(topic.data(), topic.size());
+    copy_in(payload.data(), payload.size());
+
+    return true;
+}
+
+bool ShmTransport::subscribe(const std::string& topic) {
+    return set_subscribed(topic, true);
+}
+
+void ShmTransport::unsubscribe(const std::string& topic) {
+    set_subscribed(topic, false);
+}
+
+std::uint64_t ShmTransport::get_dropped_messages() const {
+    return this->dropped_messages;
+}
+
+bool ShmTransport::set_subscribed(const std::string& topic, bool subscribed) {
+    if (this->slot >= SHM_TRANSPORT_MAX_SLOTS) {
+        // the manager owning the segment does not receive messages
+        return false;
+    }
+    if (topic.size() > SHM_TRANSPORT_MAX_TOPIC_SIZE) {
+        if (subscribed) {
+            EVLOG_debug << fmt::format("Topic {} is too long for the shared memory transport, using MQTT only", topic);
+        }
+        return false;
+    }
+    auto* header = static_cast<SegmentHeader*>(this->segment);
+    const auto hash = topic_hash(topic);
+    const auto bit = uint64_t{1} << (this->slot % 64);
+
+    const SharedMutexLock lock(&header->table_mutex);
+    for (std::size_t probe = 0; probe < SHM_TRANSPORT_MAX_TOPICS; probe++) {
+        auto& entry = header->topics[(hash + probe) % SHM_TRANSPORT_MAX_TOPICS];
+        if (entry.hash == 0) {
+            if (not subscribed) {
+                return false;
+            }
+            entry.hash = hash;
+            entry.topic_size = static_cast<uint32_t>(topic.size());
+            std::memcpy(entry.topic, topic.data(), topic.size());
+        }
+        if (entry.matches(hash, topic)) {
+            // entries are never removed again, so probing sequences of other topics stay intact
+            if (subscribed) {
+                entry.subscribers[this->slot / 64] |= bit;
+            } else {
+                entry.subscribers[this->slot / 64] &= ~bit;
+            }
+            return true;
+        }
+    }
+    EVLOG_warning << fmt::format("Shared memory topic table is full, {} will only be received via MQTT", topic);
+    return false;
+}
+
+void ShmTransport::start_receiving(const MessageCallback& callback) {
+    this->callback = callback;
+    this->stop_event_fd = eventfd(0, EFD_CLOEXEC);
+    this->receive_thread = std::thread([this]() { this->receive_loop(); });
+}
+
+void ShmTransport::receive_loop() {
+    const int own_event_fd = this->event_fds.at(this->slot);
+
+    while (true) {
+        struct pollfd pollfds[2] = {{own_event_fd, POLLIN, 0}, {this->stop_event_fd, POLLIN, 0}};
+        if (::poll(pollfds, 2, -1) < 0) {
+            // probably we got hit by a signal, nothing to do, just reloop
+            continue;
+        }
+        if (pollfds[1].revents & POLLIN) {
+            return;
+        }
+
+        eventfd_t eventfd_buffer;
+        eventfd_read(own_event_fd, &eventfd_buffer);
+
+        receive_pending();
+    }
+}
+
+void ShmTransport::receive_pending() {
+    if (not this->callback) {
+        return;
+    }
+    const auto ring_size = static_cast<SegmentHeader*>(this->segment)->ring_size;
+    auto& ring = this->ring(this->slot);
+
+    auto& topic = this->received_topic;
+    auto& payload = this->received_payload;
+    while (true) {
+        {
+            const SharedMutexLock lock(&ring.mutex);
+            if (ring.head == ring.tail) {
+                break;
+            }
+
+            const auto copy_out = [&ring, ring_size](void* destination, std::size_t size) {
+                const auto offset = ring.tail % ring_size;
+                const auto first_part = std::min<std::size_t>(size, ring_size - offset);
+                std::memcpy(destination, ring.data() + offset, first_part);
+                std::memcpy(static_cast<uint8_t*>(destination) + first_part, ring.data(), size - first_part);
+                ring.tail += size;
+            };
+            RecordHeader record{};
+            copy_out(&record, sizeof(record));
+            topic.resize(record.topic_size);
+            copy_out(topic.data(), record.topic_size);
+            payload.resize(record.payload_size);
+            copy_out(payload.data(), record.payload_size);
+        }
+        this->callback(topic.data(), topic.size(), payload.data(), payload.size());
+    }
+}
+
+} // namespace Everest
@@ -2,17 +2,23 @@
 // Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
 #include <utils/status_fifo.hpp>
 
+#include <algorithm>
+#include <chrono>
 #include <stdexcept>
 
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
 namespace Everest {
 
-StatusFifo StatusFifo::create_from_path(const std::string& fifo_path) {
+/// \brief how long the writer waits for a full fifo to drain before it checks whether it should stop
+static constexpr int WRITE_POLL_TIMEOUT_MS = 100;
+
+StatusFifo StatusFifo::create_from_path(const std::string& fifo_path, bool structured) {
     if (fifo_path.length() == 0) {
         return StatusFifo();
     }
@@ -33,23 +39,125 @@ StatusFifo StatusFifo::create_from_path(const std::string& fifo_path) {
         }
     }
 
-    return StatusFifo(fd);
+    return StatusFifo(fd, structured);
+}
+
+StatusFifo::StatusFifo(int fd_, bool structured_) : fd(fd_), disabled(false), opened(true), structured(structured_) {
+    writer = std::thread(&StatusFifo::run_writer, this);
 }
 
 void StatusFifo::update(const std::string& message) {
     if (disabled) {
         return;
     }
+    enqueue("", message);
+}
+
+void StatusFifo::report(const std::string& type, const std::string& module, nlohmann::json details) {
+    if (disabled or not structured) {
+        return;
+    }
 
-    const auto ret = write(fd, message.c_str(), message.length());
-    if (ret == -1) {
-        // NOTE (aw): if we fail to write, we might assume, that the reader of the fifo is not interested in us anymore
-        // so we won't send any further messages
-        disabled = true;
+    details["type"] = type;
+    if (not module.empty()) {
+        details["module"] = module;
+    }
+    details["timestamp_ms"] =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    enqueue(type + "/" + module, details.dump() + "\n");
+}
+
+void StatusFifo::enqueue(std::string key, std::string line) {
+    {
+        const std::lock_guard<std::mutex> lock(queue_mutex);
+        if (not key.empty()) {
+            // the reader lags if the last message of this module is still queued, only the newest one matters
+            const auto queued = std::find_if(queue.begin(), queue.end(),
+                                             [&key](const QueuedMessage& message) { return message.key == key; });
+            if (queued != queue.end()) {
+                queued->line = std::move(line);
+                return;
+            }
+        }
+
+        if (queue.size() >= MAX_QUEUED_MESSAGES) {
+            const auto oldest_structured = std::find_if(
+                queue.begin(), queue.end(), [](const QueuedMessage& message) { return not message.key.empty(); });
+            queue.erase(oldest_structured != queue.end() ? oldest_structured : queue.begin());
+            dropped++;
+        }
+        queue.push_back({std::move(key), std::move(line)});
+    }
+    queue_cv.notify_one();
+}
+
+bool StatusFifo::write_all(const std::string& data) {
+    std::size_t written = 0;
+    while (written < data.size()) {
+        const auto ret = write(fd, data.data() + written, data.size() - written);
+        if (ret >= 0) {
+            written += ret;
+            continue;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EAGAIN) {
+            // NOTE (aw): if we fail to write, we might assume, that the reader of the fifo is not interested in us
+            // anymore so we won't send any further messages
+            disabled = true;
+            return false;
+        }
+
+        // the reader lags, wait for it on this thread only
+        pollfd poll_fd{fd, POLLOUT, 0};
+        if (poll(&poll_fd, 1, WRITE_POLL_TIMEOUT_MS) == 0) {
+            const std::lock_guard<std::mutex> lock(queue_mutex);
+            if (stop) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void StatusFifo::run_writer() {
+    while (true) {
+        std::string data;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_cv.wait(lock, [this]() { return stop or not queue.empty(); });
+            if (queue.empty()) {
+                // stopped and everything is written
+                return;
+            }
+            if (dropped != 0 and structured) {
+                data = nlohmann::json({{"type", "dropped"}, {"count", dropped}}).dump() + "\n";
+            }
+            dropped = 0;
+            // messages queued while this batch is written are coalesced
+            for (const auto& message : queue) {
+                data += message.line;
+            }
+            queue.clear();
+        }
+
+        if (not write_all(data)) {
+            return;
+        }
     }
 }
 
 StatusFifo::~StatusFifo() {
+    if (writer.joinable()) {
+        {
+            const std::lock_guard<std::mutex> lock(queue_mutex);
+            stop = true;
+        }
+        queue_cv.notify_one();
+        writer.join();
+    }
     if (opened) {
         close(fd);
     }
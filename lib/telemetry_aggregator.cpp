@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <utils/telemetry_aggregator.hpp>
+
+#include <algorithm>
+
+namespace Everest {
+
+void TelemetryAggregator::add(const std::string& topic, const std::string& type, const nlohmann::json& values) {
+    std::lock_guard<std::mutex> lock(this->samples_mutex);
+    auto& sample = this->samples[{topic, type}];
+    sample.count++;
+    for (const auto& [key, value] : values.items()) {
+        auto& summary = sample.values[key];
+        summary.last = value;
+        if (not value.is_number()) {
+            continue;
+        }
+        const auto number = value.get<double>();
+        if (summary.count == 0) {
+            summary.min = number;
+            summary.max = number;
+        } else {
+            summary.min = std::min(summary.min, number);
+            summary.max = std::max(summary.max, number);
+        }
+        summary.sum += number;
+        summary.count++;
+    }
+}
+
+nlohmann::json TelemetryAggregator::flush() {
+    decltype(this->samples) flushed;
+    {
+        std::lock_guard<std::mutex> lock(this->samples_mutex);
+        std::swap(flushed, this->samples);
+    }
+
+    auto batch = nlohmann::json::array();
+    for (const auto& [topic_type, sample] : flushed) {
+        auto values = nlohmann::json::object();
+        for (const auto& [key, summary] : sample.values) {
+            if (summary.count == 0) {
+                values[key] = {{"last", summary.last}};
+            } else {
+                values[key] = {{"last", summary.last},
+                               {"min", summary.min},
+                               {"max", summary.max},
+                               {"avg", summary.sum / static_cast<double>(summary.count)},
+                               {"count", summary.count}};
+            }
+        }
+        batch.push_back(
+            {{"topic", topic_type.first}, {"type", topic_type.second}, {"count", sample.count}, {"values", values}});
+    }
+    return batch;
+}
+
+} // namespace Everest
@@ -0,0 +1,145 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <utils/topic_trie.hpp>
+
+namespace Everest {
+
+static std::vector<std::string_view> split_topic_levels(std::string_view topic) {
+    std::vector<std::string_view> levels;
+    std::size_t start = 0;
+    while (true) {
+        const auto pos = topic.find('/', start);
+        if (pos == std::string_view::npos) {
+            levels.push_back(topic.substr(start));
+            break;
+        }
+        levels.push_back(topic.substr(start, pos - start));
+        start = pos + 1;
+    }
+    return levels;
+}
+
+bool contains_wildcards(const std::string& topic) {
+    for (const auto& level : split_topic_levels(topic)) {
+        if (level == "+" or level == "#") {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TopicTrie::Node::empty() const {
+    return children.empty() and single_level == nullptr and not multi_level_topic.has_value() and
+           not topic.has_value();
+}
+
+TopicTrie::TopicTrie() = default;
+
+TopicTrie::~TopicTrie() = default;
+
+void TopicTrie::insert(const std::string& wildcard_topic) {
+    const auto levels = split_topic_levels(wildcard_topic);
+
+    Node* node = &this->root;
+    for (std::size_t index = 0; index < levels.size(); index++) {
+        const auto& level = levels[index];
+        // "#" is only a wildcard if it is the last level, otherwise it is treated verbatim
+        if (level == "#" and index == levels.size() - 1) {
+            if (not node->multi_level_topic.has_value()) {
+                node->multi_level_topic = wildcard_topic;
+                this->topic_count++;
+            }
+            return;
+        }
+
+        std::unique_ptr<Node>* next = nullptr;
+        if (level == "+") {
+            next = &node->single_level;
+        } else {
+            next = &node->children[std::string(level)];
+        }
+        if (*next == nullptr) {
+            *next = std::make_unique<Node>();
+        }
+        node = next->get();
+    }
+
+    if (not node->topic.has_value()) {
+        node->topic = wildcard_topic;
+        this->topic_count++;
+    }
+}
+
+void TopicTrie::remove(const std::string& wildcard_topic) {
+    remove(this->root, split_topic_levels(wildcard_topic), 0);
+}
+
+// NOLINTNEXTLINE(misc-no-recursion)
+bool TopicTrie::remove(Node& node, const std::vector<std::string_view>& levels, std::size_t index) {
+    if (index == levels.size()) {
+        if (node.topic.has_value()) {
+            node.topic.reset();
+            this->topic_count--;
+        }
+        return node.empty();
+    }
+
+    const auto& level = levels[index];
+    if (level == "#" and index == levels.size() - 1) {
+        if (node.multi_level_topic.has_value()) {
+            node.multi_level_topic.reset();
+            this->topic_count--;
+        }
+        return node.empty();
+    }
+
+    if (level == "+") {
+        if (node.single_level != nullptr and remove(*node.single_level, levels, index + 1)) {
+            node.single_level.reset();
+        }
+    } else {
+        const auto child = node.children.find(std::string(level));
+        if (child != node.children.end() and remove(*child->second, levels, index + 1)) {
+            node.children.erase(child);
+        }
+    }
+
+    return node.empty();
+}
+
+void TopicTrie::find_matches(const std::string& full_topic, std::vector<const std::string*>& matches) const {
+    find_matches(this->root, split_topic_levels(full_topic), 0, matches);
+}
+
+// NOLINTNEXTLINE(misc-no-recursion)
+void TopicTrie::find_matches(const Node& node, const std::vector<std::string_view>& levels, std::size_t index,
+                             std::vector<const std::string*>& matches) {
+    // a trailing "#" also matches the parent level, so "a/#" matches "a" as well as "a/b/c"
+    if (node.multi_level_topic.has_value()) {
+        matches.push_back(&node.multi_level_topic.value());
+    }
+
+    if (index == levels.size()) {
+        if (node.topic.has_value()) {
+            matches.push_back(&node.topic.value());
+        }
+        return;
+    }
+
+    if (not node.children.empty()) {
+        const auto child = node.children.find(std::string(levels[index]));
+        if (child != node.children.end()) {
+            find_matches(*child->second, levels, index + 1, matches);
+        }
+    }
+
+    if (node.single_level != nullptr) {
+        find_matches(*node.single_level, levels, index + 1, matches);
+    }
+}
+
+std::size_t TopicTrie::size() const {
+    return this->topic_count;
+}
+
+} // namespace Everest
@@ -0,0 +1,197 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <utils/tracing.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <random>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include <everest/exceptions.hpp>
+
+namespace Everest {
+namespace tracing {
+
+namespace {
+thread_local TraceContext current_context;
+
+/// \returns a random non zero number, from a generator per thread so no lock is taken
+std::uint64_t random_id() {
+    thread_local std::mt19937_64 generator(std::random_device{}());
+    std::uint64_t id = 0;
+    while (id == 0) {
+        id = generator();
+    }
+    return id;
+}
+
+long get_thread_id() {
+    thread_local const long thread_id = syscall(SYS_gettid);
+    return thread_id;
+}
+
+std::int64_t to_us(std::chrono::system_clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+} // namespace
+
+std::string to_string(const TraceContext& context) {
+    return fmt::format("{:016x}-{:016x}", context.trace_id, context.span_id);
+}
+
+TraceContext from_string(const std::string& text) {
+    constexpr std::size_t id_size = 16;
+    if (text.size() != 2 * id_size + 1 or text.at(id_size) != '-') {
+        return {};
+    }
+    try {
+        std::size_t trace_id_parsed = 0;
+        std::size_t span_id_parsed = 0;
+        TraceContext context;
+        context.trace_id = std::stoull(text.substr(0, id_size), &trace_id_parsed, 16);
+        context.span_id = std::stoull(text.substr(id_size + 1), &span_id_parsed, 16);
+        if (trace_id_parsed != id_size or span_id_parsed != id_size) {
+            return {};
+        }
+        return context;
+    } catch (const std::exception&) {
+        return {};
+    }
+}
+
+TraceContext current() {
+    return current_context;
+}
+
+ScopedContext::ScopedContext(const TraceContext& context) : previous(current_context) {
+    current_context = context;
+}
+
+ScopedContext::~ScopedContext() {
+    current_context = this->previous;
+}
+
+TracingSettings TracingSettings::parse(const nlohmann::json& module_config) {
+    TracingSettings settings;
+    const auto tracing = module_config.find("tracing");
+    if (tracing == module_config.end()) {
+        return settings;
+    }
+    settings.sample_rate = tracing->value("sample_rate", settings.sample_rate);
+    settings.file = tracing->value("file", settings.file);
+    settings.max_spans = tracing->value("max_spans", settings.max_spans);
+    return settings;
+}
+
+Tracer& Tracer::get() {
+    // never destroyed, so spans of threads outliving static destruction can still be recorded
+    static auto* tracer = new Tracer();
+    return *tracer;
+}
+
+void Tracer::configure(const TracingSettings& settings_) {
+    const std::lock_guard<std::mutex> lock(this->spans_mutex);
+    this->settings = settings_;
+    const auto sample_rate = std::clamp(this->settings.sample_rate, 0.0, 1.0);
+    constexpr auto max_id = std::numeric_limits<std::uint64_t>::max();
+    this->sample_threshold =
+        sample_rate >= 1.0 ? max_id : static_cast<std::uint64_t>(sample_rate * static_cast<double>(max_id));
+    this->recording = not this->settings.file.empty() and this->settings.max_spans > 0;
+}
+
+TraceContext Tracer::new_span_context(bool start_trace) {
+    const auto& parent = current_context;
+    if (parent.is_valid()) {
+        return {parent.trace_id, random_id()};
+    }
+    const auto threshold = this->sample_threshold.load(std::memory_order_relaxed);
+    if (not start_trace or threshold == 0 or random_id() > threshold) {
+        return {};
+    }
+    return {random_id(), random_id()};
+}
+
+void Tracer::record(const char* category, std::string name, const TraceContext& context, const TraceContext& parent,
+                    std::chrono::system_clock::time_point start, std::chrono::system_clock::duration duration) {
+    const auto start_us = to_us(start.time_since_epoch());
+    SpanRecord span{category, std::move(name), context, parent.span_id, start_us, to_us(duration), get_thread_id()};
+    const std::lock_guard<std::mutex> lock(this->spans_mutex);
+    if (this->settings.max_spans == 0) {
+        return;
+    }
+    while (this->spans.size() >= this->settings.max_spans) {
+        this->spans.pop_front();
+    }
+    this->spans.push_back(std::move(span));
+}
+
+nlohmann::json Tracer::get_chrome_trace() const {
+    auto events = nlohmann::json::array();
+    const auto pid = getpid();
+    const std::lock_guard<std::mutex> lock(this->spans_mutex);
+    for (const auto& span : this->spans) {
+        nlohmann::json args = {{"trace_id", fmt::format("{:016x}", span.context.trace_id)},
+                               {"span_id", fmt::format("{:016x}", span.context.span_id)}};
+        if (span.parent_span_id != 0) {
+            args["parent_id"] = fmt::format("{:016x}", span.parent_span_id);
+        }
+        events.push_back({{"name", span.name},
+                          {"cat", span.category},
+                          {"ph", "X"},
+                          {"ts", span.start_us},
+                          {"dur", span.duration_us},
+                          {"pid", pid},
+                          {"tid", span.thread_id},
+                          {"args", std::move(args)}});
+    }
+    return {{"traceEvents", std::move(events)}, {"displayTimeUnit", "ms"}};
+}
+
+void Tracer::write_chrome_trace() const {
+    std::string file;
+    {
+        const std::lock_guard<std::mutex> lock(this->spans_mutex);
+        file = this->settings.file;
+    }
+    if (file.empty()) {
+        return;
+    }
+    std::ofstream stream(file, std::ios::trunc);
+    stream << this->get_chrome_trace().dump();
+    if (not stream) {
+        throw EverestInternalError(fmt::format("Could not write trace to {}", file));
+    }
+}
+
+Span::Span(const char* category_, bool start_trace) : category(category_), parent(current_context) {
+    auto& tracer = Tracer::get();
+    this->context = tracer.new_span_context(start_trace);
+    if (not this->context.is_valid()) {
+        return;
+    }
+    current_context = this->context;
+    this->recording = tracer.is_recording();
+    if (this->recording) {
+        this->name = category_;
+        this->start = std::chrono::system_clock::now();
+    }
+}
+
+Span::~Span() {
+    if (not this->context.is_valid()) {
+        return;
+    }
+    current_context = this->parent;
+    if (this->recording) {
+        Tracer::get().record(this->category, std::move(this->name), this->context, this->parent, this->start,
+                             std::chrono::system_clock::now() - this->start);
+    }
+}
+
+} // namespace tracing
+} // namespace Everest
@@ -0,0 +1,158 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <utils/traffic_recorder.hpp>
+
+#include <cstring>
+
+#include <fmt/core.h>
+
+#include <everest/exceptions.hpp>
+#include <everest/logging.hpp>
+
+namespace Everest {
+
+namespace {
+constexpr char recording_magic[8] = "EVTRAFC";
+constexpr std::uint32_t recording_version = 1;
+constexpr std::uint64_t default_max_bytes = std::uint64_t{256} * 1024 * 1024;
+/// messages claiming to be larger are considered corrupt
+constexpr std::uint32_t max_decoded_size = std::uint32_t{256} * 1024 * 1024;
+
+template <typename T> void write_value(std::ostream& stream, const T& value) {
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T> bool read_value(std::istream& stream, T& value) {
+    return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+void read_bytes(std::istream& stream, std::uint32_t size, std::string& out) {
+    if (size > max_decoded_size) {
+        throw EverestInternalError(fmt::format("Recorded message claims {} bytes, the recording is corrupt", size));
+    }
+    out.resize(size);
+    if (not stream.read(out.data(), size)) {
+        throw EverestInternalError("Recording is truncated");
+    }
+}
+} // namespace
+
+TrafficRecorderSettings TrafficRecorderSettings::parse(const nlohmann::json& module_config,
+                                                       const std::string& module_id) {
+    TrafficRecorderSettings settings{{}, default_max_bytes};
+    const auto traffic_recorder = module_config.find("traffic_recorder");
+    if (traffic_recorder == module_config.end()) {
+        return settings;
+    }
+    settings.file = traffic_recorder->value("file", fmt::format("/tmp/everest_traffic_{}.bin", module_id));
+    settings.max_bytes = traffic_recorder->value("max_mb", default_max_bytes / (1024 * 1024)) * 1024 * 1024;
+    return settings;
+}
+
+TrafficRecorder::TrafficRecorder(const TrafficRecorderSettings& settings, const std::string& module_id) :
+    stream(settings.file, std::ios::binary | std::ios::trunc),
+    start(std::chrono::steady_clock::now()),
+    max_bytes(settings.max_bytes) {
+    if (not this->stream) {
+        throw EverestInternalError(fmt::format("Could not open traffic recording {}", settings.file));
+    }
+    const std::int64_t start_timestamp_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    this->stream.write(recording_magic, sizeof(recording_magic));
+    write_value(this->stream, recording_version);
+    write_value(this->stream, static_cast<std::uint32_t>(module_id.size()));
+    write_value(this->stream, start_timestamp_ns);
+    this->stream.write(module_id.data(), module_id.size());
+    this->written_bytes = sizeof(recording_magic) + 2 * sizeof(std::uint32_t) + sizeof(std::int64_t) + module_id.size();
+    EVLOG_info << fmt::format("Recording the everest traffic of module {} to {}", module_id, settings.file);
+}
+
+TrafficRecorder::~TrafficRecorder() {
+    flush();
+}
+
+void TrafficRecorder::record(TrafficDirection direction, std::string_view topic, std::string_view payload) {
+    const std::int64_t offset_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - this->start).count();
+    const auto size = sizeof(offset_ns) + sizeof(direction) + 2 * sizeof(std::uint32_t) + topic.size() + payload.size();
+
+    const std::lock_guard<std::mutex> lock(this->mutex);
+    if (this->full) {
+        return;
+    }
+    if (this->written_bytes + size > this->max_bytes) {
+        this->full = true;
+        this->stream.flush();
+        EVLOG_warning << fmt::format("Traffic recording reached its limit of {} bytes after {} messages, recording "
+                                     "stopped",
+                                     this->max_bytes, this->recorded);
+        return;
+    }
+    write_value(this->stream, offset_ns);
+    write_value(this->stream, direction);
+    write_value(this->stream, static_cast<std::uint32_t>(topic.size()));
+    write_value(this->stream, static_cast<std::uint32_t>(payload.size()));
+    this->stream.write(topic.data(), topic.size());
+    this->stream.write(payload.data(), payload.size());
+    this->written_bytes += size;
+    this->recorded++;
+}
+
+void TrafficRecorder::flush() {
+    const std::lock_guard<std::mutex> lock(this->mutex);
+    this->stream.flush();
+}
+
+std::uint64_t TrafficRecorder::get_recorded() const {
+    const std::lock_guard<std::mutex> lock(this->mutex);
+    return this->recorded;
+}
+
+TrafficReader::TrafficReader(std::istream& stream) : stream(stream) {
+    char magic[sizeof(recording_magic)]{};
+    std::uint32_t version = 0;
+    std::uint32_t module_id_size = 0;
+    if (not this->stream.read(magic, sizeof(magic)) or std::memcmp(magic, recording_magic, sizeof(magic)) != 0) {
+        throw EverestInternalError("Not a traffic recording");
+    }
+    if (not read_value(this->stream, version) or version != recording_version) {
+        throw EverestInternalError(fmt::format("Unsupported traffic recording version {}", version));
+    }
+    if (not read_value(this->stream, module_id_size) or not read_value(this->stream, this->start_timestamp_ns)) {
+        throw EverestInternalError("Recording is truncated");
+    }
+    read_bytes(this->stream, module_id_size, this->module_id);
+}
+
+const std::string& TrafficReader::get_module_id() const {
+    return this->module_id;
+}
+
+std::int64_t TrafficReader::get_start_timestamp_ns() const {
+    return this->start_timestamp_ns;
+}
+
+std::optional<TrafficRecord> TrafficReader::next() {
+    std::int64_t offset_ns = 0;
+    if (not read_value(this->stream, offset_ns)) {
+        // a recording ends after its last complete message
+        return std::nullopt;
+    }
+    TrafficRecord record;
+    std::uint32_t topic_size = 0;
+    std::uint32_t payload_size = 0;
+    if (not read_value(this->stream, record.direction) or not read_value(this->stream, topic_size) or
+        not read_value(this->stream, payload_size)) {
+        throw EverestInternalError("Recording is truncated");
+    }
+    if (record.direction != TrafficDirection::Received and record.direction != TrafficDirection::Published) {
+        throw EverestInternalError("Recording contains a message with an unknown direction, the recording is corrupt");
+    }
+    record.offset = std::chrono::nanoseconds(offset_ns);
+    read_bytes(this->stream, topic_size, record.topic);
+    read_bytes(this->stream, payload_size, record.payload);
+    return record;
+}
+
+} // namespace Everest
@@ -18,6 +18,10 @@ TypedHandler::TypedHandler(HandlerType type_, std::shared_ptr<Handler> handler_)
     TypedHandler("", "", type_, std::move(handler_)) {
 }
 
+TypedHandler::TypedHandler(HandlerType type_, std::shared_ptr<RawHandler> raw_handler_) :
+    type(type_), raw_handler(std::move(raw_handler_)) {
+}
+
 bool operator<(const Requirement& lhs, const Requirement& rhs) {
     if (lhs.id < rhs.id) {
         return true;
@@ -28,6 +32,18 @@ bool operator<(const Requirement& lhs, const Requirement& rhs) {
     }
 }
 
+HeartbeatSettings HeartbeatSettings::parse(const nlohmann::json& module_config) {
+    constexpr auto default_interval_ms = 1000;
+    HeartbeatSettings settings;
+    const auto heartbeat = module_config.find("heartbeat");
+    if (heartbeat == module_config.end()) {
+        return settings;
+    }
+    settings.interval = std::chrono::milliseconds(heartbeat->value("interval_ms", default_interval_ms));
+    settings.missed_limit = heartbeat->value("missed_limit", settings.missed_limit);
+    return settings;
+}
+
 ImplementationIdentifier::ImplementationIdentifier(const std::string& module_id_, const std::string& implementation_id_,
                                                    std::optional<Mapping> mapping_) :
     module_id(module_id_), implementation_id(implementation_id_), mapping(mapping_) {
@@ -63,10 +79,14 @@ Mapping adl_serializer<Mapping>::from_json(const json& j) {
 
 void adl_serializer<TelemetryConfig>::to_json(json& j, const TelemetryConfig& t) {
     j = {{"id", t.id}};
+    if (t.batch_interval.count() > 0) {
+        j["batch_interval_ms"] = t.batch_interval.count();
+    }
 }
 
 TelemetryConfig adl_serializer<TelemetryConfig>::from_json(const json& j) {
     auto t = TelemetryConfig(j.at("id").get<int>());
+    t.batch_interval = std::chrono::milliseconds(j.value("batch_interval_ms", 0));
     return t;
 }
 
@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+#include <stdexcept>
+
+#include <utils/validation_policy.hpp>
+
+namespace Everest {
+
+ValidationMode validation_mode_from_string(const std::string& mode) {
+    if (mode == "all") {
+        return ValidationMode::All;
+    } else if (mode == "first_n") {
+        return ValidationMode::FirstN;
+    } else if (mode == "sample") {
+        return ValidationMode::Sample;
+    } else if (mode == "publisher") {
+        return ValidationMode::Publisher;
+    }
+    throw std::out_of_range("Provided string " + mode + " could not be converted to enum of type ValidationMode");
+}
+
+std::string validation_mode_to_string(ValidationMode mode) {
+    switch (mode) {
+    case ValidationMode::All:
+        return "all";
+    case ValidationMode::FirstN:
+        return "first_n";
+    case ValidationMode::Sample:
+        return "sample";
+    case ValidationMode::Publisher:
+        return "publisher";
+    }
+    throw std::out_of_range("Provided ValidationMode could not be converted to string");
+}
+
+ValidationSampler::ValidationSampler(const ValidationPolicy& policy, bool sent) : policy(policy), sent(sent) {
+    this->policy.sample_rate = std::max<std::uint64_t>(this->policy.sample_rate, 1);
+}
+
+bool ValidationSampler::should_validate() {
+    switch (this->policy.mode) {
+    case ValidationMode::All:
+        return true;
+    case ValidationMode::FirstN:
+        // avoids contending on the counter once all messages to validate have been seen
+        if (this->messages.load(std::memory_order_relaxed) >= this->policy.first_n) {
+            return false;
+        }
+        return this->messages.fetch_add(1, std::memory_order_relaxed) < this->policy.first_n;
+    case ValidationMode::Sample:
+        return this->messages.fetch_add(1, std::memory_order_relaxed) % this->policy.sample_rate == 0;
+    case ValidationMode::Publisher:
+        return this->sent;
+    }
+    return true;
+}
+
+void ValidationCost::record(std::chrono::nanoseconds duration, bool valid) {
+    this->validations.fetch_add(1, std::memory_order_relaxed);
+    if (not valid) {
+        this->failures.fetch_add(1, std::memory_order_relaxed);
+    }
+    const auto ns = duration.count();
+    this->total_ns.fetch_add(ns, std::memory_order_relaxed);
+    auto max_ns = this->max_ns.load(std::memory_order_relaxed);
+    while (ns > max_ns and not this->max_ns.compare_exchange_weak(max_ns, ns, std::memory_order_relaxed)) {
+    }
+}
+
+ValidationCostStats ValidationCost::get_stats() const {
+    ValidationCostStats stats;
+    stats.validations = this->validations.load(std::memory_order_relaxed);
+    stats.failures = this->failures.load(std::memory_order_relaxed);
+    stats.total = std::chrono::nanoseconds(this->total_ns.load(std::memory_order_relaxed));
+    stats.max = std::chrono::nanoseconds(this->max_ns.load(std::memory_order_relaxed));
+    return stats;
+}
+
+void to_json(nlohmann::json& j, const ValidationPolicy& policy) {
+    j = {{"mode", validation_mode_to_string(policy.mode)},
+         {"first_n", policy.first_n},
+         {"sample_rate", policy.sample_rate},
+         {"asynchronous", policy.asynchronous}};
+}
+
+void from_json(const nlohmann::json& j, ValidationPolicy& policy) {
+    policy.mode = validation_mode_from_string(j.at("mode").get<std::string>());
+    policy.first_n = j.at("first_n").get<std::uint64_t>();
+    policy.sample_rate = j.at("sample_rate").get<std::uint64_t>();
+    policy.asynchronous = j.value("asynchronous", false);
+}
+
+void to_json(nlohmann::json& j, const ValidationStats& stats) {
+    j = {{"validated", stats.validated},
+         {"skipped", stats.skipped},
+         {"violations", stats.violations},
+         {"dropped", stats.dropped}};
+}
+
+void to_json(nlohmann::json& j, const ValidationCostStats& stats) {
+    const auto us = [](std::chrono::nanoseconds duration) { return duration.count() / 1000.0; };
+    j = {{"validations", stats.validations},
+         {"failures", stats.failures},
+         {"total_us", us(stats.total)},
+         {"mean_us", stats.validations == 0 ? 0.0 : us(stats.total) / stats.validations},
+         {"max_us", us(stats.max)}};
+}
+
+} // namespace Everest
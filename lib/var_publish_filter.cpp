@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <utils/var_publish_filter.hpp>
+
+#include <fmt/core.h>
+
+namespace Everest {
+
+namespace {
+VarPublishLimits parse_limits(const nlohmann::json& limits_json, const VarPublishLimits& defaults) {
+    VarPublishLimits limits;
+    limits.change_only = limits_json.value("change_only", defaults.change_only);
+    limits.refresh_interval =
+        std::chrono::milliseconds(limits_json.value("refresh_interval_ms", defaults.refresh_interval.count()));
+    return limits;
+}
+} // namespace
+
+VarPublishSettings VarPublishSettings::parse(const nlohmann::json& module_config) {
+    VarPublishSettings settings;
+    const auto var_publishing = module_config.find("var_publishing");
+    if (var_publishing == module_config.end()) {
+        return settings;
+    }
+    settings.defaults = parse_limits(*var_publishing, settings.defaults);
+    const auto vars = var_publishing->value("vars", nlohmann::json::object());
+    for (const auto& [var, limits] : vars.items()) {
+        settings.vars[var] = parse_limits(limits, settings.defaults);
+    }
+    return settings;
+}
+
+const VarPublishLimits& VarPublishSettings::get_limits(const std::string& impl_id, const std::string& var_name) const {
+    if (this->vars.empty()) {
+        return this->defaults;
+    }
+    const auto it = this->vars.find(fmt::format("{}/{}", impl_id, var_name));
+    return it != this->vars.end() ? it->second : this->defaults;
+}
+
+VarChangeFilter::VarChangeFilter(const VarPublishLimits& limits) : limits(limits) {
+}
+
+bool VarChangeFilter::should_publish(std::size_t hash, clock::time_point now) {
+    const std::lock_guard<std::mutex> lock(this->mutex);
+    const auto refresh_due =
+        this->limits.refresh_interval.count() > 0 and now - this->last_publish >= this->limits.refresh_interval;
+    if (this->last_hash == hash and not refresh_due) {
+        this->suppressed++;
+        return false;
+    }
+    this->last_hash = hash;
+    this->last_publish = now;
+    return true;
+}
+
+std::uint64_t VarChangeFilter::get_suppressed() const {
+    const std::lock_guard<std::mutex> lock(this->mutex);
+    return this->suppressed;
+}
+
+} // namespace Everest
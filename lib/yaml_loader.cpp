@@ -2,10 +2,19 @@
 // Copyright Pionix GmbH and Contributors to EVerest
 #include <utils/yaml_loader.hpp>
 
+#include <cerrno>
 #include <cstddef>
-#include <fstream>
-#include <limits>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <c4/charconv.hpp>
 #include <fmt/core.h>
 #include <ryml.hpp>
 #include <ryml_std.hpp>
@@ -41,46 +50,107 @@ struct RymlCallbackInitializer {
     }
 };
 
-static nlohmann::ordered_json ryml_to_nlohmann_json(const c4::yml::NodeRef& ryml_node) {
-    if (ryml_node.is_map()) {
+/// \brief converts the scalar \p value of \p node into json without intermediate strings
+static void ryml_scalar_to_nlohmann_json(const ryml::Tree& tree, std::size_t node, nlohmann::ordered_json& json) {
+    const auto value = tree.val(node);
+    if (not tree.is_val_quoted(node)) {
+        // check for numbers and booleans
+        if (value.is_integer()) {
+            std::int64_t integer = 0;
+            if (c4::atoi(value, &integer)) {
+                json = integer;
+                return;
+            }
+        }
+        if (value.is_number()) {
+            double number = 0;
+            if (c4::atod(value, &number)) {
+                json = number;
+                return;
+            }
+        } else if (value == "true") {
+            json = true;
+            return;
+        } else if (value == "false") {
+            json = false;
+            return;
+        }
+    }
+    // nothing matched so far, should be string
+    json = std::string(value.str, value.len);
+}
+
+/// \brief builds the json of \p node directly into \p json, so no subtree gets copied while the document is built
+static void ryml_to_nlohmann_json(const ryml::Tree& tree, std::size_t node, nlohmann::ordered_json& json) {
+    if (tree.is_map(node)) {
         // handle object
-        auto object = nlohmann::ordered_json::object();
-        for (const auto& child : ryml_node) {
-            object[std::string(child.key().data(), child.key().len)] = ryml_to_nlohmann_json(child);
+        json = nlohmann::ordered_json::object();
+        for (auto child = tree.first_child(node); child != ryml::NONE; child = tree.next_sibling(child)) {
+            const auto key = tree.key(child);
+            ryml_to_nlohmann_json(tree, child, json[std::string(key.str, key.len)]);
         }
-        return object;
-    } else if (ryml_node.is_seq()) {
+    } else if (tree.is_seq(node)) {
         // handle array
-        auto array = nlohmann::ordered_json::array();
-        for (const auto& child : ryml_node) {
-            array.emplace_back(ryml_to_nlohmann_json(child));
+        json = nlohmann::ordered_json::array();
+        json.get_ref<nlohmann::ordered_json::array_t&>().reserve(tree.num_children(node));
+        for (auto child = tree.first_child(node); child != ryml::NONE; child = tree.next_sibling(child)) {
+            ryml_to_nlohmann_json(tree, child, json.emplace_back());
         }
-        return array;
-    } else if (ryml_node.empty() or ryml_node.val_is_null()) {
-        return nullptr;
+    } else if (tree.empty(node) or tree.val_is_null(node)) {
+        json = nullptr;
     } else {
-        // check type of data
-        const auto& value = ryml_node.val();
-        std::string value_string(value.data(), value.len);
-        const auto value_quoted = ryml_node.is_val_quoted();
-        if (!value_quoted) {
-            // check for numbers and booleans
-            if (ryml_node.val().is_integer()) {
-                return std::stoi(value_string);
-            } else if (ryml_node.val().is_number()) {
-                return std::stod(value_string);
-            } else if (value_string == "true") {
-                return true;
-            } else if (value_string == "false") {
-                return false;
-            }
-        }
-        // nothing matched so far, should be string
-        return value_string;
+        ryml_scalar_to_nlohmann_json(tree, node, json);
     }
 }
 
-static std::string load_yaml_content(std::filesystem::path path) {
+///
+/// \brief Private, writable memory mapping of a whole file
+///
+/// Writes only go to the mapping and not to the file, so ryml can parse the buffer in place.
+///
+class MappedFile {
+public:
+    explicit MappedFile(const std::filesystem::path& path) {
+        const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1) {
+            throw std::runtime_error(fmt::format("Could not open '{}': {}", path.string(), std::strerror(errno)));
+        }
+        struct stat file_stat {};
+        if (fstat(fd, &file_stat) == -1) {
+            const auto error = errno;
+            close(fd);
+            throw std::runtime_error(fmt::format("Could not stat '{}': {}", path.string(), std::strerror(error)));
+        }
+        this->size = static_cast<std::size_t>(file_stat.st_size);
+        if (this->size > 0) {
+            this->data = mmap(nullptr, this->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        }
+        const auto error = errno;
+        close(fd);
+        if (this->data == MAP_FAILED) {
+            throw std::runtime_error(fmt::format("Could not map '{}': {}", path.string(), std::strerror(error)));
+        }
+    }
+
+    ~MappedFile() {
+        if (this->size > 0) {
+            munmap(this->data, this->size);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ryml::substr get_buffer() {
+        return {static_cast<char*>(this->data), this->size};
+    }
+
+private:
+    void* data{nullptr};
+    std::size_t size{0};
+};
+
+static std::filesystem::path find_yaml_file(std::filesystem::path path) {
     namespace fs = std::filesystem;
 
     if (path.extension().string() == ".json") {
@@ -94,16 +164,14 @@ static std::string load_yaml_content(std::filesystem::path path) {
 
     // first check for yaml, if not found try fall back to json and evlog debug deprecated
     if (fs::exists(path)) {
-        std::ifstream ifs(path.string());
-        return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+        return path;
     }
 
     path.replace_extension(".json");
 
     if (fs::exists(path)) {
         EVLOG_info << "Deprecated: loaded file in json format";
-        std::ifstream ifs(path.string());
-        return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+        return path;
     }
 
     // failed to find yaml and json
@@ -116,10 +184,15 @@ nlohmann::ordered_json load_yaml(const std::filesystem::path& path) {
     // FIXME (aw): using the static here this isn't a perfect solution
     static RymlCallbackInitializer ryml_callback_initializer;
 
-    const auto content = load_yaml_content(path);
-    // FIXME (aw): using parse_in_place would be faster but that will need the file as a whole char buffer
-    const auto tree = ryml::parse_in_arena(ryml::to_csubstr(content));
-    return ryml_to_nlohmann_json(tree.rootref());
+    const auto file_path = find_yaml_file(path);
+    const auto file_name = file_path.string();
+    MappedFile file(file_path);
+    // the tree only references the mapped buffer, so it has to be converted before the file gets unmapped
+    auto tree = ryml::parse_in_place(ryml::to_csubstr(file_name), file.get_buffer());
+
+    nlohmann::ordered_json json;
+    ryml_to_nlohmann_json(tree, tree.root_id(), json);
+    return json;
 }
 
 } // namespace Everest
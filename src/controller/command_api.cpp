@@ -89,12 +89,12 @@ nlohmann::json CommandApi::handle(const std::string& cmd, const json& params) {
         const auto name = params.at("name").get<std::string>();
 
         const json config_json = params.value("config", json::object());
-        auto ryml_deserialized = transpile_config(config_json);
+        const auto config_yaml = this->transpiler.transpile(config_json);
 
         const auto configs_path = fs::path(this->config.configs_dir);
         const auto check_config_file_path = configs_path / fmt::format("_{}.yaml", name);
 
-        std::ofstream(check_config_file_path.string()) << ryml_deserialized;
+        std::ofstream(check_config_file_path.string()) << config_yaml;
 
         const auto result = this->rpc.ipc_request("check_config", check_config_file_path.string(), false);
 
@@ -110,6 +110,8 @@ nlohmann::json CommandApi::handle(const std::string& cmd, const json& params) {
         this->rpc.ipc_request("restart_modules", nullptr, true);
 
         return nullptr;
+    } else if (cmd == "get_module_resources") {
+        return this->rpc.ipc_request("get_module_resources", nullptr, false);
     } else if (cmd == "get_rpc_timeout") {
         return this->config.controller_rpc_timeout_ms;
     }
@@ -7,6 +7,8 @@
 
 #include <nlohmann/json.hpp>
 
+#include "transpile_config.hpp"
+
 // forward declaration
 class RPC;
 
@@ -34,6 +36,7 @@ public:
 private:
     Config config;
     RPC& rpc;
+    ConfigTranspiler transpiler; ///< keeps the yaml of the last saved config, so a save only transpiles the changes
 };
 
 #endif // CONTROLLER_COMMAND_API_HPP
@@ -23,9 +23,9 @@ int main(int argc, char* argv[]) {
         return EXIT_FAILURE;
     }
 
-    auto socket_fd = STDIN_FILENO;
+    Everest::controller_ipc::Channel channel(STDIN_FILENO);
 
-    const auto message = Everest::controller_ipc::receive_message(socket_fd);
+    const auto message = channel.receive_message();
 
     if (message.status != Everest::controller_ipc::MESSAGE_RETURN_STATUS::OK) {
         throw std::runtime_error("Controller process could not read initial config message");
@@ -36,6 +36,9 @@ int main(int argc, char* argv[]) {
 
     Everest::Logging::init(config_params.at("logging_config_file"), "everest_ctrl");
 
+    // reply in the encoding chosen by the manager
+    channel.set_encoding(static_cast<Everest::controller_ipc::Encoding>(config_params.value("ipc_encoding", 0)));
+
     EVLOG_debug << "everest controller process started ...";
 
     CommandApi::Config config{
@@ -45,7 +48,7 @@ int main(int argc, char* argv[]) {
         config_params.at("controller_rpc_timeout_ms"),
     };
 
-    RPC rpc(socket_fd, config);
+    RPC rpc(channel, config);
     Server backend;
     int controller_port = config_params.at("controller_port").get<int>();
 
@@ -2,18 +2,30 @@
 // Copyright 2020 - 2022 Pionix GmbH and Contributors to EVerest
 #include "ipc.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <string>
+
 #include <errno.h>
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <unistd.h>
 
-// FIXME (aw): this needs be done better!
-static char raw_message_buffer[16 * 1024];
-
 namespace Everest {
 namespace controller_ipc {
 
-void set_read_timeout(int fd, int timeout_in_ms) {
+static constexpr std::size_t HEADER_SIZE = 5;
+static constexpr std::size_t READ_CHUNK_SIZE = 64 * 1024;
+
+static std::size_t read_payload_size(const std::uint8_t* header) {
+    return (static_cast<std::size_t>(header[0]) << 24) | (static_cast<std::size_t>(header[1]) << 16) |
+           (static_cast<std::size_t>(header[2]) << 8) | static_cast<std::size_t>(header[3]);
+}
+
+Channel::Channel(int fd, Encoding encoding) : fd(fd), encoding(encoding) {
+}
+
+void Channel::set_read_timeout(int timeout_in_ms) {
 
     const int seconds = timeout_in_ms / 1000;
     const int u_seconds = (timeout_in_ms - seconds * 1000) * 1000;
@@ -25,26 +37,142 @@ void set_read_timeout(int fd, int timeout_in_ms) {
     setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, static_cast<void*>(&socket_timeout), sizeof(socket_timeout));
 }
 
-void send_message(int fd, const nlohmann::json& msg) {
-    auto raw = nlohmann::json::to_bson(msg);
-    write(fd, raw.data(), raw.size());
+void Channel::set_encoding(Encoding encoding) {
+    const std::lock_guard<std::mutex> lock(send_mutex);
+    this->encoding = encoding;
 }
 
-// FIXME (aw): recv should be buffered and memory is not that costly here!
-Message receive_message(int fd) {
-    auto retval = read(fd, raw_message_buffer, sizeof(raw_message_buffer));
+void Channel::append_frame(const nlohmann::json& msg) {
+    const auto header_offset = send_buffer.size();
+    send_buffer.resize(header_offset + HEADER_SIZE);
+
+    if (encoding == Encoding::MessagePack) {
+        nlohmann::json::to_msgpack(msg, send_buffer);
+    } else {
+        const auto dumped = msg.dump();
+        send_buffer.insert(send_buffer.end(), dumped.begin(), dumped.end());
+    }
+
+    const auto payload_size = send_buffer.size() - header_offset - HEADER_SIZE;
+    auto header = send_buffer.data() + header_offset;
+    header[0] = static_cast<std::uint8_t>(payload_size >> 24);
+    header[1] = static_cast<std::uint8_t>(payload_size >> 16);
+    header[2] = static_cast<std::uint8_t>(payload_size >> 8);
+    header[3] = static_cast<std::uint8_t>(payload_size);
+    header[4] = static_cast<std::uint8_t>(encoding);
+}
 
-    if (retval == -1) {
-        if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            return {MESSAGE_RETURN_STATUS::TIMEOUT, nullptr};
+void Channel::write_send_buffer() {
+    std::size_t written = 0;
+    while (written < send_buffer.size()) {
+        const auto retval = send(fd, send_buffer.data() + written, send_buffer.size() - written, MSG_NOSIGNAL);
+        if (retval == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // FIXME (aw): add return value for failed send
+            break;
         }
+        written += retval;
+    }
+    send_buffer.clear();
+}
+
+void Channel::send_message(const nlohmann::json& msg) {
+    const std::lock_guard<std::mutex> lock(send_mutex);
+    append_frame(msg);
+    write_send_buffer();
+}
+
+void Channel::queue_message(const nlohmann::json& msg) {
+    const std::lock_guard<std::mutex> lock(send_mutex);
+    append_frame(msg);
+}
+
+void Channel::flush() {
+    const std::lock_guard<std::mutex> lock(send_mutex);
+    if (not send_buffer.empty()) {
+        write_send_buffer();
+    }
+}
 
-        return {MESSAGE_RETURN_STATUS::ERROR, {{"error", strerror(errno)}}};
+bool Channel::has_buffered_message() const {
+    const auto available = receive_buffer.size() - receive_offset;
+    if (available < HEADER_SIZE) {
+        return false;
     }
+    return available - HEADER_SIZE >= read_payload_size(receive_buffer.data() + receive_offset);
+}
+
+Message Channel::receive_message() {
+    while (true) {
+        const auto available = receive_buffer.size() - receive_offset;
+        std::size_t frame_size = HEADER_SIZE;
+
+        if (available >= HEADER_SIZE) {
+            const auto header = receive_buffer.data() + receive_offset;
+            const auto payload_size = read_payload_size(header);
+            if (payload_size > MAX_FRAME_SIZE) {
+                return {MESSAGE_RETURN_STATUS::ERROR,
+                        {{"error", "Frame of " + std::to_string(payload_size) + " bytes exceeds the maximum size"}}};
+            }
+            frame_size += payload_size;
+
+            if (available >= frame_size) {
+                const auto payload_begin = header + HEADER_SIZE;
+                const auto payload_end = payload_begin + payload_size;
+                const auto frame_encoding = static_cast<Encoding>(header[4]);
+
+                nlohmann::json msg;
+                if (frame_encoding == Encoding::Json) {
+                    msg = nlohmann::json::parse(payload_begin, payload_end, nullptr, false);
+                } else if (frame_encoding == Encoding::MessagePack) {
+                    msg = nlohmann::json::from_msgpack(payload_begin, payload_end, true, false);
+                } else {
+                    return {MESSAGE_RETURN_STATUS::ERROR, {{"error", "Frame with unknown encoding"}}};
+                }
+
+                receive_offset += frame_size;
+                if (receive_offset == receive_buffer.size()) {
+                    receive_offset = 0;
+                    // keeps the capacity, following messages are read without reallocating
+                    receive_buffer.clear();
+                }
+
+                if (msg.is_discarded()) {
+                    return {MESSAGE_RETURN_STATUS::ERROR, {{"error", "Could not decode the payload of a frame"}}};
+                }
 
-    const auto& msg_size = retval;
+                return {MESSAGE_RETURN_STATUS::OK, std::move(msg)};
+            }
+        }
+
+        // move the partial frame to the front, so the buffer does not grow with the number of messages read
+        if (receive_offset != 0) {
+            receive_buffer.erase(receive_buffer.begin(), receive_buffer.begin() + receive_offset);
+            receive_offset = 0;
+        }
+
+        const auto buffered = receive_buffer.size();
+        receive_buffer.resize(buffered + std::max(READ_CHUNK_SIZE, frame_size - available));
+        const auto retval = read(fd, receive_buffer.data() + buffered, receive_buffer.size() - buffered);
+        receive_buffer.resize(buffered + std::max<ssize_t>(retval, 0));
+
+        if (retval == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return {MESSAGE_RETURN_STATUS::TIMEOUT, nullptr};
+            }
 
-    return {MESSAGE_RETURN_STATUS::OK, nlohmann::json::from_bson(raw_message_buffer, raw_message_buffer + msg_size)};
+            return {MESSAGE_RETURN_STATUS::ERROR, {{"error", strerror(errno)}}};
+        }
+
+        if (retval == 0) {
+            return {MESSAGE_RETURN_STATUS::ERROR, {{"error", "Connection closed"}}};
+        }
+    }
 }
 
 } // namespace controller_ipc
@@ -3,6 +3,11 @@
 #ifndef CONTROLLER_IPC_HPP
 #define CONTROLLER_IPC_HPP
 
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
 #include <nlohmann/json.hpp>
 
 #define MAGIC_CONTROLLER_ARG0 "MT.EVEREST"
@@ -16,18 +21,68 @@ enum class MESSAGE_RETURN_STATUS {
     TIMEOUT,
 };
 
+/// \brief How the payload of a frame is encoded, every frame carries its encoding so both can be mixed
+enum class Encoding : std::uint8_t {
+    Json = 0,
+    MessagePack = 1,
+};
+
 struct Message {
     Message(MESSAGE_RETURN_STATUS status, nlohmann::json json) : status(status), json(std::move(json)){};
     const MESSAGE_RETURN_STATUS status;
     const nlohmann::json json;
 };
 
-// FIXME (aw): add return value for failed set_timeout
-void set_read_timeout(int fd, int timeout_in_ms);
+/// \brief frames with a larger payload are rejected, the connection cannot be trusted anymore then
+inline constexpr std::size_t MAX_FRAME_SIZE = 64 * 1024 * 1024;
+
+///
+/// \brief A buffered, length-prefixed message channel on a stream socket
+/// \details Every frame consists of a 4 byte payload length in network byte order, one byte with the Encoding of the
+///          payload and the payload itself, so messages of any size can be sent and several messages can be read
+///          with one read. Messages can be queued and written in one go with flush(), which batches the replies and
+///          notifications of one loop iteration. Sending is thread-safe, receiving has to be done by one thread
+///
+class Channel {
+public:
+    explicit Channel(int fd, Encoding encoding = Encoding::Json);
+
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+
+    // FIXME (aw): add return value for failed set_timeout
+    void set_read_timeout(int timeout_in_ms);
+
+    void set_encoding(Encoding encoding);
+
+    /// \brief writes the \p msg and everything queued before it
+    void send_message(const nlohmann::json& msg);
 
-// FIXME (aw): add return value for failed send
-void send_message(int fd, const nlohmann::json& msg);
-Message receive_message(int fd);
+    /// \brief appends the \p msg to the frames written by the next flush() or send_message()
+    void queue_message(const nlohmann::json& msg);
+
+    /// \brief writes all queued messages
+    void flush();
+
+    /// \brief returns the next buffered message, reads from the socket if no complete frame is buffered
+    Message receive_message();
+
+    /// \returns true if a complete message is buffered, so receive_message() returns without reading
+    bool has_buffered_message() const;
+
+private:
+    void append_frame(const nlohmann::json& msg);
+    void write_send_buffer();
+
+    const int fd;
+    Encoding encoding;
+
+    std::mutex send_mutex;
+    std::vector<std::uint8_t> send_buffer;
+
+    std::vector<std::uint8_t> receive_buffer;
+    std::size_t receive_offset{0}; ///< start of the first unread frame in receive_buffer
+};
 
 } // namespace controller_ipc
 } // namespace Everest
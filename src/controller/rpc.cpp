@@ -89,8 +89,8 @@ private:
     nlohmann::json params;
 };
 
-RPC::RPC(int ipc_fd, const CommandApi::Config& config) :
-    ipc_fd(ipc_fd), rpc_timeout(std::chrono::milliseconds(config.controller_rpc_timeout_ms)) {
+RPC::RPC(Everest::controller_ipc::Channel& ipc_channel, const CommandApi::Config& config) :
+    ipc_channel(ipc_channel), rpc_timeout(std::chrono::milliseconds(config.controller_rpc_timeout_ms)) {
     this->api = std::make_unique<CommandApi>(config, *this);
 }
 
@@ -101,7 +101,7 @@ void RPC::run(const NotificationHandler& notification_handler) {
 
     while (true) {
         // polling on command api ..
-        const auto msg = Everest::controller_ipc::receive_message(this->ipc_fd);
+        const auto msg = this->ipc_channel.receive_message();
 
         if (msg.status != Everest::controller_ipc::MESSAGE_RETURN_STATUS::OK) {
             // FIXME (aw): proper error handling!
@@ -111,7 +111,8 @@ void RPC::run(const NotificationHandler& notification_handler) {
         const auto& payload = msg.json;
         if (!payload.contains("id")) {
             // probably only a simple notification
-            this->notification_handler(payload);
+            notification_handler(payload);
+            continue;
         }
 
         // otherwise a result
@@ -176,7 +177,7 @@ nlohmann::json RPC::handle_json_rpc(const std::string& payload) {
 
 nlohmann::json RPC::ipc_request(const std::string& method, const nlohmann::json& params, bool only_notify) {
     if (only_notify) {
-        Everest::controller_ipc::send_message(this->ipc_fd, {{"method", method}, {"params", params}});
+        this->ipc_channel.send_message({{"method", method}, {"params", params}});
         return nullptr;
     }
 
@@ -191,7 +192,7 @@ nlohmann::json RPC::ipc_request(const std::string& method, const nlohmann::json&
 
     lock.unlock();
 
-    Everest::controller_ipc::send_message(this->ipc_fd, {{"method", method}, {"params", params}, {"id", id}});
+    this->ipc_channel.send_message({{"method", method}, {"params", params}, {"id", id}});
 
     const auto status = call_result_future.wait_for(this->rpc_timeout);
 
@@ -13,12 +13,13 @@
 #include <nlohmann/json.hpp>
 
 #include "command_api.hpp"
+#include "ipc.hpp"
 
 class RPC {
 public:
     using NotificationHandler = std::function<void(const nlohmann::json&)>;
 
-    RPC(int ipc_fd, const CommandApi::Config& config);
+    RPC(Everest::controller_ipc::Channel& ipc_channel, const CommandApi::Config& config);
 
     nlohmann::json handle_json_rpc(const std::string& request_string);
     nlohmann::json ipc_request(const std::string& method, const nlohmann::json& params, bool only_notify);
@@ -26,7 +27,7 @@ public:
     void run(const NotificationHandler& handler);
 
 private:
-    int ipc_fd;
+    Everest::controller_ipc::Channel& ipc_channel;
     std::unique_ptr<CommandApi> api;
     NotificationHandler notification_handler;
     std::chrono::milliseconds rpc_timeout;
@@ -5,11 +5,17 @@
 #include <cstddef>
 #include <cstring>
 
+#include <condition_variable>
+#include <cstdint>
 #include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <queue>
-#include <set>
 #include <sstream>
+#include <thread>
+#include <vector>
 
 #include <fmt/core.h>
 
@@ -17,9 +23,29 @@
 
 #include <everest/logging.hpp>
 
+///
+/// \brief A serialized message with the LWS_PRE bytes libwebsockets needs in front of it
+/// \details Frames are immutable once created, so a broadcast is serialized once and the same frame is queued for
+///          every session
+///
+using Frame = std::shared_ptr<const std::vector<unsigned char>>;
+
+static Frame make_frame(const std::string& data) {
+    auto frame = std::make_shared<std::vector<unsigned char>>(LWS_PRE + data.size());
+    memcpy(frame->data() + LWS_PRE, data.data(), data.size());
+    return frame;
+}
+
 // FIXME (aw): naming
 class WebsocketSession {
 public:
+    /// \brief frames queued beyond these limits drop the oldest ones, so a slow client cannot grow the memory
+    static constexpr std::size_t MAX_QUEUED_FRAMES = 256;
+    static constexpr std::size_t MAX_QUEUED_BYTES = 16 * 1024 * 1024;
+
+    explicit WebsocketSession(std::uint64_t id) : id(id) {
+    }
+
     enum class OutputState {
         EMPTY,
         LAST_DATA,
@@ -31,25 +57,32 @@ public:
         unsigned char* buffer{nullptr};
         std::size_t len{0};
 
-        void set_data(const std::string& data) {
-            len = data.size();
-            d.resize(LWS_PRE + len);
-            buffer = d.data() + LWS_PRE;
-            memcpy(buffer, data.data(), len);
+        void set_frame(Frame frame_) {
+            frame = std::move(frame_);
+            // lws_write only writes the header into the LWS_PRE bytes, always on the service thread, so sessions
+            // can share the frame
+            buffer = const_cast<unsigned char*>(frame->data()) + LWS_PRE;
+            len = frame->size() - LWS_PRE;
         }
 
     private:
-        std::vector<unsigned char> d{};
+        Frame frame{};
     };
 
-    void push_output_data(std::string data);
+    void push_output_data(Frame frame);
     Output pop_output();
+    bool has_output();
     void add_input(const char*, std::size_t len);
     std::string finish_input();
 
+    /// \brief unique for the lifetime of the server, unlike the address of the session
+    const std::uint64_t id;
+
 private:
     std::string input;
-    std::queue<std::string> output_queue;
+    std::queue<Frame> output_queue;
+    std::size_t queued_bytes{0};
+    std::size_t dropped_frames{0};
     std::mutex output_mtx;
 };
 
@@ -63,9 +96,25 @@ std::string WebsocketSession::finish_input() {
     return data;
 }
 
-void WebsocketSession::push_output_data(std::string data) {
+void WebsocketSession::push_output_data(Frame frame) {
+    const std::lock_guard<std::mutex> lock(output_mtx);
+    queued_bytes += frame->size();
+    output_queue.emplace(std::move(frame));
+
+    while (output_queue.size() > 1 and
+           (output_queue.size() > MAX_QUEUED_FRAMES or queued_bytes > MAX_QUEUED_BYTES)) {
+        queued_bytes -= output_queue.front()->size();
+        output_queue.pop();
+        // only log once per overflow, a stuck client would flood the log otherwise
+        if (dropped_frames++ == 0) {
+            EVLOG_warning << "Controller websocket client does not keep up, dropping its oldest messages";
+        }
+    }
+}
+
+bool WebsocketSession::has_output() {
     const std::lock_guard<std::mutex> lock(output_mtx);
-    output_queue.emplace(std::move(data));
+    return not output_queue.empty();
 }
 
 WebsocketSession::Output WebsocketSession::pop_output() {
@@ -76,9 +125,16 @@ WebsocketSession::Output WebsocketSession::pop_output() {
         return output;
     }
 
-    output.set_data(output_queue.front());
+    queued_bytes -= output_queue.front()->size();
+    output.set_frame(std::move(output_queue.front()));
     output_queue.pop();
 
+    if (output_queue.empty() and dropped_frames != 0) {
+        EVLOG_warning << fmt::format("Controller websocket client caught up, {} messages were dropped",
+                                     dropped_frames);
+        dropped_frames = 0;
+    }
+
     output.state = output_queue.empty() ? OutputState::LAST_DATA : OutputState::MORE_DATA;
 
     return output;
@@ -107,12 +163,25 @@ private:
 
     static int callback(struct lws* wsi, lws_callback_reasons reason, void* user, void* in, std::size_t len);
 
-    void create_session(WebsocketSession* session);
+    void create_session(WebsocketSession* session, lws* wsi);
     void destroy_session(WebsocketSession* session);
 
+    void dispatch_request(WebsocketSession* session, std::string request);
+    void run_requests();
+    void respond(WebsocketSession* session, std::uint64_t session_id, const nlohmann::json& response);
+
     IncomingMessageHandler message_in_handler;
 
-    std::set<WebsocketSession*> sessions{};
+    std::map<WebsocketSession*, lws*> sessions{};
+    std::uint64_t next_session_id{0};
+
+    /// \brief requests are handled on these threads, so a request waiting for the manager does not block the others
+    static constexpr std::size_t REQUEST_WORKERS = 4;
+    std::vector<std::thread> request_workers;
+    std::queue<std::function<void()>> requests;
+    std::mutex requests_mtx;
+    std::condition_variable requests_cv;
+    bool stop_requests{false};
 };
 
 const lws_protocol_vhost_options Server::Impl::pvo_opt = {nullptr, nullptr, "default", "1"};
@@ -147,7 +216,16 @@ int Server::Impl::callback(struct lws* wsi, lws_callback_reasons reason, void* u
 
     if (LWS_CALLBACK_PROTOCOL_INIT == reason) {
     } else if (LWS_CALLBACK_ESTABLISHED == reason) {
-        instance.create_session(session);
+        instance.create_session(session, wsi);
+
+    } else if (LWS_CALLBACK_EVENT_WAIT_CANCELLED == reason) {
+        // woken up by push(), schedule a write for every session that got a frame
+        const std::lock_guard<std::mutex> lock(instance.context_mtx);
+        for (auto& [session, session_wsi] : instance.sessions) {
+            if (session->has_output()) {
+                lws_callback_on_writable(session_wsi);
+            }
+        }
 
     } else if (LWS_CALLBACK_SERVER_WRITEABLE == reason) {
         using State = WebsocketSession::OutputState;
@@ -171,15 +249,7 @@ int Server::Impl::callback(struct lws* wsi, lws_callback_reasons reason, void* u
             return 0;
         }
 
-        auto input = session->finish_input();
-
-        const auto& retval = instance.message_in_handler(input);
-        // FIXME (aw): this is blocking - do we want that?
-        if (!retval.is_null()) {
-            session->push_output_data(retval.dump());
-
-            lws_callback_on_writable(wsi);
-        }
+        instance.dispatch_request(session, session->finish_input());
 
         return 0;
     } else if (LWS_CALLBACK_CLOSED == reason) {
@@ -191,10 +261,10 @@ int Server::Impl::callback(struct lws* wsi, lws_callback_reasons reason, void* u
     return 0;
 }
 
-void Server::Impl::create_session(WebsocketSession* session) {
-    new (session) WebsocketSession();
+void Server::Impl::create_session(WebsocketSession* session, lws* wsi) {
     const std::lock_guard<std::mutex> lock(context_mtx);
-    sessions.insert(session);
+    new (session) WebsocketSession(next_session_id++);
+    sessions.emplace(session, wsi);
 }
 
 void Server::Impl::destroy_session(WebsocketSession* session) {
@@ -206,6 +276,53 @@ void Server::Impl::destroy_session(WebsocketSession* session) {
     session->~WebsocketSession();
 }
 
+void Server::Impl::dispatch_request(WebsocketSession* session, std::string request) {
+    {
+        const std::lock_guard<std::mutex> lock(requests_mtx);
+        requests.emplace([this, session, session_id = session->id, request = std::move(request)]() {
+            const auto response = message_in_handler(request);
+            if (!response.is_null()) {
+                respond(session, session_id, response);
+            }
+        });
+    }
+    requests_cv.notify_one();
+}
+
+void Server::Impl::run_requests() {
+    while (true) {
+        std::function<void()> request;
+        {
+            std::unique_lock<std::mutex> lock(requests_mtx);
+            requests_cv.wait(lock, [this]() { return stop_requests or !requests.empty(); });
+            if (stop_requests) {
+                return;
+            }
+            request = std::move(requests.front());
+            requests.pop();
+        }
+        try {
+            request();
+        } catch (const std::exception& e) {
+            EVLOG_error << fmt::format("Could not handle controller request: {}", e.what());
+        }
+    }
+}
+
+void Server::Impl::respond(WebsocketSession* session, std::uint64_t session_id, const nlohmann::json& response) {
+    const auto frame = make_frame(response.dump());
+
+    const std::lock_guard<std::mutex> lock(context_mtx);
+    // the session might have been closed while its request was handled
+    const auto it = sessions.find(session);
+    if (context == nullptr or it == sessions.end() or session->id != session_id) {
+        return;
+    }
+    session->push_output_data(frame);
+    // the write is scheduled on the service thread, see LWS_CALLBACK_EVENT_WAIT_CANCELLED
+    lws_cancel_service(context);
+}
+
 void Server::Impl::run(const Server::IncomingMessageHandler& handler, const std::string& html_origin, int port) {
     if (!handler) {
         throw std::runtime_error("Could not run the server with a null incoming message handler");
@@ -240,9 +357,23 @@ void Server::Impl::run(const Server::IncomingMessageHandler& handler, const std:
         context = lws_create_context(&info);
     }
 
+    for (std::size_t i = 0; i < REQUEST_WORKERS; ++i) {
+        request_workers.emplace_back(&Server::Impl::run_requests, this);
+    }
+
     while (lws_service(context, 0) >= 0) {
     }
 
+    {
+        std::lock_guard<std::mutex> lck(requests_mtx);
+        stop_requests = true;
+    }
+    requests_cv.notify_all();
+    for (auto& worker : request_workers) {
+        worker.join();
+    }
+    request_workers.clear();
+
     // FIXME (aw): check for errors and log them somehow ...
     {
         std::lock_guard<std::mutex> lck(context_mtx);
@@ -253,13 +384,15 @@ void Server::Impl::run(const Server::IncomingMessageHandler& handler, const std:
 
 void Server::Impl::push(const nlohmann::json& msg) {
     const std::lock_guard<std::mutex> lock(context_mtx);
-    if (context == nullptr) {
-        // context does not exist, nothing to do
+    if (context == nullptr or sessions.empty()) {
+        // context does not exist or nobody is listening, nothing to do
         return;
     }
 
-    for (auto session : sessions) {
-        session->push_output_data(std::move(msg.dump()));
+    // serialized once, all sessions share the frame
+    const auto frame = make_frame(msg.dump());
+    for (auto& session : sessions) {
+        session.first->push_output_data(frame);
     }
     lws_cancel_service(context);
 }
@@ -30,3 +30,69 @@ c4::yml::Tree transpile_config(nlohmann::json config_json) {
     clear_quote_flags(root);
     return ryml_deserialized;
 }
+
+static std::string emit_yaml(const nlohmann::json& json) {
+    return ryml::emitrs<std::string>(transpile_config(json));
+}
+
+std::string ConfigTranspiler::transpile(const nlohmann::json& config_json) {
+    const std::lock_guard<std::mutex> lock(cache_mutex);
+
+    if (config_json == last_config and not last_yaml.empty()) {
+        return last_yaml;
+    }
+
+    if (not config_json.is_object()) {
+        return emit_yaml(config_json);
+    }
+
+    // only the sections and entries of this config are kept, so the cache does not grow with every edit
+    std::map<std::string, Section> new_sections;
+    std::string yaml;
+
+    for (const auto& [key, value] : config_json.items()) {
+        auto& section = new_sections[key];
+        const auto cached = sections.find(key);
+
+        if (not value.is_object() or value.empty()) {
+            if (cached != sections.end() and cached->second.header.empty() and cached->second.whole.value == value) {
+                section.whole = std::move(cached->second.whole);
+            } else {
+                section.whole = {value, emit_yaml({{key, value}})};
+            }
+            yaml += section.whole.yaml;
+            continue;
+        }
+
+        if (cached != sections.end()) {
+            section.header = cached->second.header;
+        }
+
+        std::string entries_yaml;
+        for (const auto& [entry_key, entry_value] : value.items()) {
+            auto& entry = section.entries[entry_key];
+            if (cached != sections.end()) {
+                const auto cached_entry = cached->second.entries.find(entry_key);
+                if (cached_entry != cached->second.entries.end() and cached_entry->second.value == entry_value) {
+                    entry = std::move(cached_entry->second);
+                    entries_yaml += entry.yaml;
+                    continue;
+                }
+            }
+
+            // the entry is transpiled inside its section, the first line is the key of the section
+            auto entry_yaml = emit_yaml({{key, {{entry_key, entry_value}}}});
+            const auto header_end = entry_yaml.find('\n') + 1;
+            section.header = entry_yaml.substr(0, header_end);
+            entry = {entry_value, entry_yaml.substr(header_end)};
+            entries_yaml += entry.yaml;
+        }
+        yaml += section.header;
+        yaml += entries_yaml;
+    }
+
+    sections = std::move(new_sections);
+    last_config = config_json;
+    last_yaml = yaml;
+    return yaml;
+}
@@ -2,9 +2,44 @@
 // Copyright 2020 - 2024 Pionix GmbH and Contributors to EVerest
 #pragma once
 
+#include <map>
+#include <mutex>
+#include <string>
+
 #include <nlohmann/json.hpp>
 
 #include <ryml.hpp>
 #include <ryml_std.hpp>
 
 c4::yml::Tree transpile_config(nlohmann::json config_json);
+
+///
+/// \brief Transpiles configs to yaml, reusing the yaml of everything that did not change since the last call
+/// \details The block yaml of a map is the concatenation of the yaml of its entries, so the yaml of every entry of the
+///          top-level sections (e.g. every module of active_modules) is cached with the json it was made from. Saving
+///          a config from the admin panel then only transpiles the modules that were edited, and a config that did
+///          not change at all is returned without transpiling anything. Thread-safe
+///
+class ConfigTranspiler {
+public:
+    /// \returns the same yaml as emitting transpile_config(\p config_json)
+    std::string transpile(const nlohmann::json& config_json);
+
+private:
+    struct Fragment {
+        nlohmann::json value;
+        std::string yaml;
+    };
+
+    /// \brief the cache of a top-level section, either of its entries or, if it is no map, of the section itself
+    struct Section {
+        std::string header; ///< the line with the key of the section, if entries are cached
+        std::map<std::string, Fragment> entries;
+        Fragment whole;
+    };
+
+    std::mutex cache_mutex;
+    nlohmann::json last_config;
+    std::string last_yaml;
+    std::map<std::string, Section> sections;
+};
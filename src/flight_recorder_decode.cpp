@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+// Decodes the dumps of the flight recorder of a module, which are written on crashes, critical log messages and SIGUSR2
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <date/date.h>
+#include <fmt/core.h>
+
+#include <everest/exceptions.hpp>
+#include <utils/flight_recorder.hpp>
+
+namespace {
+void print_usage(const char* program) {
+    std::cerr << fmt::format("Usage: {} [--json] <dump file>\n", program)
+              << "Prints the recorded framework events of a flight recorder dump, oldest first\n";
+}
+
+std::string to_rfc3339(std::int64_t timestamp_ns) {
+    const auto time_point = std::chrono::time_point<std::chrono::system_clock, std::chrono::microseconds>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds(timestamp_ns)));
+    return date::format("%FT%TZ", time_point);
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    bool json_output = false;
+    const char* file = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0) {
+            json_output = true;
+        } else if (file == nullptr and argv[i][0] != '-') {
+            file = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (file == nullptr) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::ifstream stream(file, std::ios::binary);
+    if (not stream) {
+        std::cerr << fmt::format("Could not open {}\n", file);
+        return 1;
+    }
+
+    try {
+        const auto recording = Everest::decode_flight_recording(stream);
+        if (json_output) {
+            auto records = nlohmann::json::array();
+            for (const auto& record : recording.records) {
+                records.push_back(Everest::to_json(record));
+            }
+            const nlohmann::json dump = {{"module_id", recording.module_id},
+                                         {"reason", recording.reason},
+                                         {"pid", recording.pid},
+                                         {"dump_timestamp_ns", recording.dump_timestamp_ns},
+                                         {"lost_records", recording.lost_records},
+                                         {"records", std::move(records)}};
+            std::cout << dump.dump(2) << "\n";
+            return 0;
+        }
+
+        std::cout << fmt::format("Flight recorder dump of module {} (pid {}) at {} because of {}\n",
+                                 recording.module_id, recording.pid, to_rfc3339(recording.dump_timestamp_ns),
+                                 recording.reason);
+        std::cout << fmt::format("{} events, {} older events were overwritten\n", recording.records.size(),
+                                 recording.lost_records);
+        for (const auto& record : recording.records) {
+            const auto event = Everest::to_json(record);
+            std::cout << fmt::format("{} {:<11} {:<18} {}", to_rfc3339(record.timestamp_ns),
+                                     event.at("event").get<std::string>(), event.value("handler_type", ""),
+                                     event.at("topic").get<std::string>());
+            if (event.contains("call_id")) {
+                std::cout << fmt::format(" id={}", event.at("call_id").get<std::string>());
+            }
+            if (event.contains("duration_us")) {
+                std::cout << fmt::format(" took {}us", record.duration_us);
+            }
+            std::cout << "\n";
+        }
+    } catch (const Everest::EverestInternalError& e) {
+        std::cerr << fmt::format("Could not decode {}: {}\n", file, e.what());
+        return 1;
+    }
+    return 0;
+}
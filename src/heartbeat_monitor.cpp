@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#include "heartbeat_monitor.hpp"
+
+#include <utility>
+
+#include <fmt/core.h>
+
+#include <everest/logging.hpp>
+
+namespace Everest {
+
+HeartbeatMonitor::HeartbeatMonitor(MQTTAbstraction& mqtt_abstraction_, StatusFifo& status_fifo_) :
+    mqtt_abstraction(mqtt_abstraction_), status_fifo(status_fifo_) {
+}
+
+HeartbeatMonitor::~HeartbeatMonitor() {
+    if (this->check_timer != 0) {
+        this->mqtt_abstraction.get_event_loop().remove(this->check_timer);
+    }
+    for (const auto& [module_id, heartbeats] : this->modules) {
+        this->mqtt_abstraction.unregister_handler(heartbeats.topic, heartbeats.token);
+    }
+}
+
+void HeartbeatMonitor::update(const ManagerConfig& config, const std::map<pid_t, std::string>& running_modules_) {
+    if (running_modules_ == this->running_modules) {
+        return;
+    }
+    this->running_modules = running_modules_;
+
+    std::vector<std::pair<std::string, std::shared_ptr<TypedHandler>>> unregistered;
+    std::vector<std::pair<std::string, std::shared_ptr<TypedHandler>>> registered;
+    {
+        const std::lock_guard<std::mutex> lock(this->modules_mutex);
+        std::map<std::string, pid_t> pids;
+        for (const auto& [pid, module_id] : this->running_modules) {
+            pids.emplace(module_id, pid);
+        }
+        for (auto it = this->modules.begin(); it != this->modules.end();) {
+            const auto pid = pids.find(it->first);
+            if (pid == pids.end() or pid->second != it->second.pid) {
+                unregistered.emplace_back(it->second.topic, it->second.token);
+                it = this->modules.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        const auto& main_config = config.get_main_config();
+        for (const auto& [module_id, pid] : pids) {
+            const auto module_config = main_config.find(module_id);
+            if (this->modules.count(module_id) != 0 or module_config == main_config.end()) {
+                continue;
+            }
+            const auto settings = HeartbeatSettings::parse(*module_config);
+            if (settings.interval.count() <= 0) {
+                continue;
+            }
+            const auto handle_heartbeat = [this, module_id = module_id](const std::string&,
+                                                                        const nlohmann::json& data) {
+                this->handle_heartbeat(module_id, data);
+            };
+            auto token =
+                std::make_shared<TypedHandler>(HandlerType::ExternalMQTT, std::make_shared<Handler>(handle_heartbeat));
+            const auto& topic = config.get_topic(module_id, ModuleTopic::Heartbeat);
+            this->modules.emplace(module_id, ModuleHeartbeats{pid, topic, settings, token, std::nullopt});
+            registered.emplace_back(topic, std::move(token));
+        }
+        this->reschedule();
+    }
+
+    for (const auto& [topic, token] : unregistered) {
+        this->mqtt_abstraction.unregister_handler(topic, token);
+    }
+    for (const auto& [topic, token] : registered) {
+        this->mqtt_abstraction.register_handler(topic, token, QOS::QOS0);
+    }
+}
+
+void HeartbeatMonitor::handle_heartbeat(const std::string& module_id, const nlohmann::json& data) {
+    if (not data.is_number_unsigned()) {
+        EVLOG_warning << fmt::format("Ignoring invalid heartbeat of module {}: {}", module_id, data.dump());
+        return;
+    }
+    const auto sequence = data.get<std::uint64_t>();
+    const auto now = std::chrono::steady_clock::now();
+
+    const std::lock_guard<std::mutex> lock(this->modules_mutex);
+    const auto module = this->modules.find(module_id);
+    if (module == this->modules.end()) {
+        return;
+    }
+    auto& heartbeats = module->second;
+    if (heartbeats.hanging) {
+        heartbeats.hanging = false;
+        const auto silence_ms =
+            std::chrono::duration_cast<std::chrono::milliseconds>(now - heartbeats.last_heartbeat.value()).count();
+        EVLOG_warning << fmt::format("Module {} sends heartbeats again after {}ms", module_id, silence_ms);
+        this->status_fifo.report("health", module_id, {{"hanging", false}, {"silence_ms", silence_ms}});
+    }
+    if (heartbeats.last_heartbeat.has_value() and sequence > heartbeats.next_sequence) {
+        heartbeats.missed += sequence - heartbeats.next_sequence;
+        EVLOG_debug << fmt::format("Module {} missed {} heartbeats, {} in total", module_id,
+                                   sequence - heartbeats.next_sequence, heartbeats.missed);
+    }
+    heartbeats.last_heartbeat = now;
+    heartbeats.next_sequence = sequence + 1;
+}
+
+void HeartbeatMonitor::check() {
+    const auto now = std::chrono::steady_clock::now();
+    const std::lock_guard<std::mutex> lock(this->modules_mutex);
+    for (auto& [module_id, heartbeats] : this->modules) {
+        if (heartbeats.hanging or not heartbeats.last_heartbeat.has_value()) {
+            continue;
+        }
+        const auto silence = now - heartbeats.last_heartbeat.value();
+        if (silence > heartbeats.settings.interval * heartbeats.settings.missed_limit) {
+            heartbeats.hanging = true;
+            const auto silence_ms = std::chrono::duration_cast<std::chrono::milliseconds>(silence).count();
+            EVLOG_error << fmt::format("Module {} (pid: {}) sent no heartbeat for {}ms, it might hang", module_id,
+                                       heartbeats.pid, silence_ms);
+            this->status_fifo.report("health", module_id,
+                                     {{"hanging", true}, {"silence_ms", silence_ms}, {"missed", heartbeats.missed}});
+        }
+    }
+}
+
+void HeartbeatMonitor::reschedule() {
+    std::chrono::milliseconds interval{0};
+    for (const auto& [module_id, heartbeats] : this->modules) {
+        if (interval.count() == 0 or heartbeats.settings.interval < interval) {
+            interval = heartbeats.settings.interval;
+        }
+    }
+    if (interval == this->check_interval) {
+        return;
+    }
+    auto& event_loop = this->mqtt_abstraction.get_event_loop();
+    if (this->check_timer != 0) {
+        event_loop.remove(this->check_timer);
+        this->check_timer = 0;
+    }
+    this->check_interval = interval;
+    if (interval.count() > 0) {
+        this->check_timer = event_loop.add_timer(interval, [this]() { this->check(); });
+    }
+}
+
+} // namespace Everest
@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+#include <utils/config.hpp>
+#include <utils/event_loop.hpp>
+#include <utils/mqtt_abstraction.hpp>
+#include <utils/status_fifo.hpp>
+#include <utils/types.hpp>
+
+namespace Everest {
+
+///
+/// \brief Tracks the heartbeats of the modules spawned by the manager, which have a heartbeat entry in their config,
+/// and reports modules that stopped sending them as hanging
+/// \details All modules are checked by a single timer on the event loop. A module is only checked after its first
+///          heartbeat, so slow module initializations are not reported. Hanging and recovered modules are also
+///          reported as health messages on the status fifo.
+///
+class HeartbeatMonitor {
+public:
+    HeartbeatMonitor(MQTTAbstraction& mqtt_abstraction, StatusFifo& status_fifo);
+    ~HeartbeatMonitor();
+    HeartbeatMonitor(const HeartbeatMonitor&) = delete;
+    HeartbeatMonitor& operator=(const HeartbeatMonitor&) = delete;
+
+    ///
+    /// \brief monitors the heartbeats of the \p running_modules by pid, modules that are no longer running are
+    /// forgotten and restarted modules are monitored from scratch
+    ///
+    void update(const ManagerConfig& config, const std::map<pid_t, std::string>& running_modules);
+
+private:
+    struct ModuleHeartbeats {
+        pid_t pid;
+        std::string topic;
+        HeartbeatSettings settings;
+        std::shared_ptr<TypedHandler> token;
+        std::optional<std::chrono::steady_clock::time_point> last_heartbeat; ///< not set before the first heartbeat
+        std::uint64_t next_sequence{0};
+        std::uint64_t missed{0}; ///< heartbeats missing in the sequence numbers
+        bool hanging{false};
+    };
+
+    void handle_heartbeat(const std::string& module_id, const nlohmann::json& data);
+    void check();
+    /// \brief restarts the check timer with the shortest heartbeat interval of the monitored modules
+    void reschedule();
+
+    MQTTAbstraction& mqtt_abstraction;
+    StatusFifo& status_fifo;
+    std::map<pid_t, std::string> running_modules; ///< of the last update, only used by the thread calling update()
+    std::mutex modules_mutex;
+    std::map<std::string, ModuleHeartbeats> modules;
+    std::chrono::milliseconds check_interval{0};
+    EventLoop::Id check_timer{0};
+};
+
+} // namespace Everest
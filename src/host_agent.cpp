@@ -0,0 +1,345 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+// Spawns the modules a manager on another node asks for, which are the modules with a host entry in its config, and
+// reports their exits back to the manager
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <errno.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <boost/program_options.hpp>
+#include <fmt/core.h>
+
+#include <everest/logging.hpp>
+#include <framework/runtime.hpp>
+#include <utils/mqtt_abstraction.hpp>
+
+#include "remote_host_protocol.hpp"
+
+namespace po = boost::program_options;
+namespace fs = std::filesystem;
+
+extern char** environ;
+
+namespace {
+volatile std::sig_atomic_t stop_requested = 0;
+
+/// Time a module gets to exit after SIGTERM before it is killed
+constexpr auto MODULE_STOP_TIMEOUT = std::chrono::seconds(5);
+
+/// \brief Settings every spawned module gets on its command line, the ones of the agent itself
+struct ModuleArguments {
+    std::string prefix;
+    std::string log_config;
+    Everest::MQTTSettings mqtt_settings;
+};
+
+/// \brief Requests received from the manager, module processes are only forked by the main thread
+class RequestQueue {
+public:
+    struct Request {
+        bool spawn{false}; ///< stop the module otherwise
+        Everest::RemoteSpawnRequest spawn_request;
+        std::string module_id;
+    };
+
+    void push(Request request) {
+        const std::lock_guard<std::mutex> lock(this->mutex);
+        this->requests.push_back(std::move(request));
+    }
+
+    std::deque<Request> take() {
+        const std::lock_guard<std::mutex> lock(this->mutex);
+        return std::exchange(this->requests, {});
+    }
+
+private:
+    std::mutex mutex;
+    std::deque<Request> requests;
+};
+
+/// \brief A module spawned by the agent
+struct RunningModule {
+    std::string module_id;
+    std::string spawn_id;
+};
+
+/// \returns the arguments or environment entries as a null terminated array for exec, pointing into \p values
+std::vector<char*> to_exec_array(std::vector<std::string>& values) {
+    std::vector<char*> array(values.size() + 1, nullptr);
+    for (std::size_t i = 0; i < values.size(); i++) {
+        array.at(i) = values.at(i).data();
+    }
+    return array;
+}
+
+///
+/// \returns the pid of the module spawned for the validated \p request, or -1 if fork() failed
+/// \details Everything the child needs is prepared before fork(), since the agent runs MQTT threads and the child
+///          must not allocate before exec
+///
+pid_t spawn_module(const Everest::RemoteSpawnRequest& request, const fs::path& modules_dir,
+                   const ModuleArguments& module_arguments) {
+    const auto binary = modules_dir / request.module_type / request.module_type;
+    const auto& mqtt_settings = module_arguments.mqtt_settings;
+    std::vector<std::string> arguments = {request.printable_name,
+                                          "--prefix",
+                                          module_arguments.prefix,
+                                          "--module",
+                                          request.module_id,
+                                          "--log_config",
+                                          module_arguments.log_config,
+                                          "--mqtt_everest_prefix",
+                                          mqtt_settings.everest_prefix,
+                                          "--mqtt_external_prefix",
+                                          mqtt_settings.external_prefix};
+    if (mqtt_settings.uses_socket()) {
+        arguments.insert(arguments.end(), {"--mqtt_broker_socket_path", mqtt_settings.broker_socket_path});
+    } else {
+        arguments.insert(arguments.end(), {"--mqtt_broker_host", mqtt_settings.broker_host, "--mqtt_broker_port",
+                                           std::to_string(mqtt_settings.broker_port)});
+    }
+
+    // the environment of the agent, with the variables of the request replacing the agent's ones
+    std::vector<std::string> environment;
+    for (char** entry = environ; *entry != nullptr; entry++) {
+        const std::string variable(*entry);
+        if (request.environment.count(variable.substr(0, variable.find('='))) == 0) {
+            environment.push_back(variable);
+        }
+    }
+    for (const auto& [name, value] : request.environment) {
+        environment.push_back(fmt::format("{}={}", name, value));
+    }
+
+    const auto argv = to_exec_array(arguments);
+    const auto envp = to_exec_array(environment);
+    const auto exec_error = fmt::format("Syscall to execve() with \"{}\" failed\n", binary.string());
+
+    const auto pid = fork();
+    if (pid != 0) {
+        return pid;
+    }
+    execve(binary.c_str(), argv.data(), envp.data());
+    // the exit is reported like any other one of the module
+    const auto written = write(STDERR_FILENO, exec_error.data(), exec_error.size());
+    static_cast<void>(written);
+    _exit(EXIT_FAILURE);
+}
+
+/// \returns the wait status of the module \p pid, which is killed if it did not exit MODULE_STOP_TIMEOUT after SIGTERM
+int stop_module(pid_t pid, const std::string& module_id) {
+    EVLOG_info << fmt::format("Stopping module {} (pid: {})", module_id, pid);
+    kill(pid, SIGTERM);
+    const auto deadline = std::chrono::steady_clock::now() + MODULE_STOP_TIMEOUT;
+    int wstatus = 0;
+    while (waitpid(pid, &wstatus, WNOHANG) == 0) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            EVLOG_warning << fmt::format("Module {} (pid: {}) did not exit after SIGTERM, killing it", module_id, pid);
+            kill(pid, SIGKILL);
+            waitpid(pid, &wstatus, 0);
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return wstatus;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    po::options_description desc("Spawns modules on this node for a manager running on another node");
+    desc.add_options()("help,h", "produce help message");
+    desc.add_options()("host_id", po::value<std::string>(),
+                       "Id of this host, which is the host entry of its modules in the manager config");
+    desc.add_options()("prefix", po::value<std::string>()->default_value(Everest::defaults::PREFIX),
+                       "Prefix path of the everest installation on this node");
+    desc.add_options()("modules_dir", po::value<std::string>(),
+                       "Directory of the modules, defaults to the modules directory below the prefix");
+    desc.add_options()("log_config", po::value<std::string>(), "The path to a custom logging config");
+    desc.add_options()("mqtt_broker_socket_path", po::value<std::string>(),
+                       "MQTT broker socket, host and port are ignored if set");
+    desc.add_options()("mqtt_broker_host", po::value<std::string>()->default_value(Everest::defaults::MQTT_BROKER_HOST),
+                       "MQTT broker host");
+    desc.add_options()("mqtt_broker_port", po::value<int>()->default_value(Everest::defaults::MQTT_BROKER_PORT),
+                       "MQTT broker port");
+    desc.add_options()("mqtt_everest_prefix",
+                       po::value<std::string>()->default_value(Everest::defaults::MQTT_EVEREST_PREFIX),
+                       "The MQTT everest prefix, must match the one of the manager");
+    desc.add_options()("mqtt_external_prefix",
+                       po::value<std::string>()->default_value(Everest::defaults::MQTT_EXTERNAL_PREFIX),
+                       "The MQTT external prefix, must match the one of the manager");
+
+    po::variables_map vm;
+    try {
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+    } catch (const po::error& e) {
+        std::cerr << e.what() << "\n" << desc << "\n";
+        return EXIT_FAILURE;
+    }
+    if (vm.count("help") != 0 or vm.count("host_id") == 0) {
+        std::cerr << desc << "\n";
+        return vm.count("help") != 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    const auto host_id = vm["host_id"].as<std::string>();
+    const fs::path prefix = vm["prefix"].as<std::string>();
+    const fs::path modules_dir =
+        vm.count("modules_dir") != 0
+            ? fs::path(vm["modules_dir"].as<std::string>())
+            : prefix / Everest::defaults::LIBEXEC_DIR / Everest::defaults::NAMESPACE / Everest::defaults::MODULES_DIR;
+    const fs::path log_config = vm.count("log_config") != 0 ? fs::path(vm["log_config"].as<std::string>())
+                                                            : prefix / Everest::defaults::SYSCONF_DIR /
+                                                                  Everest::defaults::NAMESPACE /
+                                                                  Everest::defaults::LOGGING_CONFIG_NAME;
+    Everest::Logging::init(log_config.string(), "host_agent");
+
+    auto everest_prefix = vm["mqtt_everest_prefix"].as<std::string>();
+    if (not everest_prefix.empty() and everest_prefix.back() != '/') {
+        everest_prefix += "/";
+    }
+    const auto external_prefix = vm["mqtt_external_prefix"].as<std::string>();
+    const ModuleArguments module_arguments{
+        prefix.string(), log_config.string(),
+        vm.count("mqtt_broker_socket_path") != 0
+            ? Everest::create_mqtt_settings(vm["mqtt_broker_socket_path"].as<std::string>(), everest_prefix,
+                                            external_prefix)
+            : Everest::create_mqtt_settings(vm["mqtt_broker_host"].as<std::string>(),
+                                            vm["mqtt_broker_port"].as<int>(), everest_prefix, external_prefix)};
+
+    Everest::MQTTAbstraction mqtt(module_arguments.mqtt_settings);
+    if (not mqtt.connect()) {
+        EVLOG_error << "Cannot connect to the MQTT broker";
+        return EXIT_FAILURE;
+    }
+    mqtt.spawn_main_loop_thread();
+
+    const auto topic = [&everest_prefix, &host_id](const char* message) {
+        return Everest::get_remote_host_topic(everest_prefix, host_id, message);
+    };
+
+    RequestQueue requests;
+    const auto handle_spawn = [&requests](const std::string&, const nlohmann::json& data) {
+        try {
+            requests.push({true, data.get<Everest::RemoteSpawnRequest>(), {}});
+        } catch (const nlohmann::json::exception& e) {
+            EVLOG_warning << fmt::format("Ignoring invalid spawn request: {}", e.what());
+        }
+    };
+    const auto handle_stop = [&requests](const std::string&, const nlohmann::json& data) {
+        if (data.is_string()) {
+            requests.push({false, {}, data.get<std::string>()});
+        }
+    };
+    const auto spawn_token =
+        std::make_shared<TypedHandler>(HandlerType::ExternalMQTT, std::make_shared<Handler>(handle_spawn));
+    const auto stop_token =
+        std::make_shared<TypedHandler>(HandlerType::ExternalMQTT, std::make_shared<Handler>(handle_stop));
+    mqtt.register_handler(topic(Everest::REMOTE_HOST_SPAWN), spawn_token, QOS::QOS2);
+    mqtt.register_handler(topic(Everest::REMOTE_HOST_STOP), stop_token, QOS::QOS2);
+
+    struct sigaction stop_action {};
+    stop_action.sa_handler = [](int) { stop_requested = 1; };
+    sigaction(SIGTERM, &stop_action, nullptr);
+    sigaction(SIGINT, &stop_action, nullptr);
+
+    // the manager only sends spawn requests once the agent is online, so the handlers are registered before
+    mqtt.publish(topic(Everest::REMOTE_HOST_ONLINE), nlohmann::json(true), QOS::QOS2, true);
+    EVLOG_info << fmt::format("Host agent {} spawning modules from {}", host_id, modules_dir.string());
+
+    std::map<pid_t, RunningModule> modules;
+    const auto publish_exit = [&mqtt, &host_id, &topic](const RunningModule& module, int pid, int wstatus) {
+        EVLOG_info << fmt::format("Module {} (pid: {}) exited with status: {}", module.module_id, pid, wstatus);
+        const Everest::RemoteModuleExit exit{host_id, module.module_id, module.spawn_id, pid, wstatus};
+        mqtt.publish(topic(Everest::REMOTE_HOST_EXIT), nlohmann::json(exit), QOS::QOS2);
+    };
+    const auto find_module = [&modules](const std::string& module_id) {
+        return std::find_if(modules.begin(), modules.end(),
+                            [&module_id](const auto& module) { return module.second.module_id == module_id; });
+    };
+    const auto take_exits = [&modules, &publish_exit]() {
+        int wstatus = 0;
+        pid_t pid = 0;
+        while ((pid = waitpid(-1, &wstatus, WNOHANG)) > 0) {
+            const auto module = modules.find(pid);
+            if (module == modules.end()) {
+                continue;
+            }
+            publish_exit(module->second, pid, wstatus);
+            modules.erase(module);
+        }
+    };
+
+    while (stop_requested == 0) {
+        for (const auto& request : requests.take()) {
+            const auto& module_id = request.spawn ? request.spawn_request.module_id : request.module_id;
+            const auto running = find_module(module_id);
+            if (running != modules.end()) {
+                // a module restarted by the manager replaces the instance of the previous run
+                publish_exit(running->second, running->first, stop_module(running->first, module_id));
+                modules.erase(running);
+            }
+            if (not request.spawn) {
+                continue;
+            }
+            const RunningModule module{module_id, request.spawn_request.spawn_id};
+            const auto invalid = Everest::validate_spawn_request(request.spawn_request);
+            if (not invalid.empty()) {
+                EVLOG_error << fmt::format("Refusing to spawn module {}: {}", module_id, invalid);
+                publish_exit(module, -1, -1);
+                continue;
+            }
+            const auto pid = spawn_module(request.spawn_request, modules_dir, module_arguments);
+            if (pid == -1) {
+                EVLOG_error << fmt::format("Could not fork module {} ({})", module_id, strerror(errno));
+                publish_exit(module, -1, -1);
+                continue;
+            }
+            EVLOG_info << fmt::format("Spawned module {} (pid: {})", module_id, pid);
+            modules.emplace(pid, module);
+        }
+        take_exits();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    EVLOG_info << fmt::format("Stopping host agent {} and its {} modules", host_id, modules.size());
+    mqtt.publish(topic(Everest::REMOTE_HOST_ONLINE), nlohmann::json(false), QOS::QOS2, true);
+    for (const auto& [pid, module] : modules) {
+        kill(pid, SIGTERM);
+    }
+    const auto deadline = std::chrono::steady_clock::now() + MODULE_STOP_TIMEOUT;
+    while (not modules.empty() and std::chrono::steady_clock::now() < deadline) {
+        take_exits();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    // the modules still running ignored SIGTERM
+    for (const auto& [pid, module] : modules) {
+        EVLOG_warning << fmt::format("Module {} (pid: {}) did not exit after SIGTERM, killing it", module.module_id,
+                                     pid);
+        kill(pid, SIGKILL);
+        int wstatus = 0;
+        waitpid(pid, &wstatus, 0);
+        publish_exit(module, pid, wstatus);
+    }
+    modules.clear();
+    mqtt.unregister_handler(topic(Everest::REMOTE_HOST_SPAWN), spawn_token);
+    mqtt.unregister_handler(topic(Everest::REMOTE_HOST_STOP), stop_token);
+    mqtt.disconnect();
+    return EXIT_SUCCESS;
+}
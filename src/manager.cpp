@@ -1,19 +1,30 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright Pionix GmbH and Contributors to EVerest
 
+#include <algorithm>
+#include <array>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <iterator>
 #include <list>
 #include <map>
 #include <mutex>
+#include <optional>
+#include <set>
+#include <string_view>
 #include <thread>
 
+#include <csignal>
 #include <cstdlib>
 #include <errno.h>
 #include <fcntl.h>
 #include <pwd.h>
+#include <poll.h>
 #include <signal.h>
+#include <sys/prctl.h>
 #include <sys/socket.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -28,10 +39,17 @@
 #include <framework/everest.hpp>
 #include <framework/runtime.hpp>
 #include <utils/config.hpp>
+#include <utils/config_image.hpp>
 #include <utils/mqtt_abstraction.hpp>
+#include <utils/payload_encoding.hpp>
+#include <utils/shm_transport.hpp>
 #include <utils/status_fifo.hpp>
 
 #include "controller/ipc.hpp"
+#include "heartbeat_monitor.hpp"
+#include "metrics_endpoint.hpp"
+#include "remote_hosts.hpp"
+#include "resource_monitor.hpp"
 #include "system_unix.hpp"
 #include <generated/version_information.hpp>
 
@@ -43,21 +61,35 @@ using namespace Everest;
 const auto PARENT_DIED_SIGNAL = SIGTERM;
 const int CONTROLLER_IPC_READ_TIMEOUT_MS = 50;
 const auto complete_start_time = std::chrono::system_clock::now();
+const int PYTHON_ZYGOTE_TIMEOUT_MS = 5000;
+const std::size_t MAX_PYTHON_ZYGOTE_REPORT_SIZE = 1024;
+/// Time the modules stopped by a config reload get to exit after SIGTERM before they are killed
+const auto MODULE_STOP_TIMEOUT = std::chrono::seconds(5);
 
 #ifdef ENABLE_ADMIN_PANEL
 class ControllerHandle {
 public:
-    ControllerHandle(pid_t pid, int socket_fd) : pid(pid), socket_fd(socket_fd) {
+    ControllerHandle(pid_t pid, std::unique_ptr<controller_ipc::Channel> channel) :
+        pid(pid), channel(std::move(channel)) {
         // we do "non-blocking" read
-        controller_ipc::set_read_timeout(socket_fd, CONTROLLER_IPC_READ_TIMEOUT_MS);
+        this->channel->set_read_timeout(CONTROLLER_IPC_READ_TIMEOUT_MS);
     }
 
-    void send_message(const nlohmann::json& msg) {
-        controller_ipc::send_message(socket_fd, msg);
+    /// \brief queues a reply, all replies to the messages of one loop iteration are written together by flush()
+    void queue_message(const nlohmann::json& msg) {
+        channel->queue_message(msg);
+    }
+
+    void flush() {
+        channel->flush();
     }
 
     controller_ipc::Message receive_message() {
-        return controller_ipc::receive_message(socket_fd);
+        return channel->receive_message();
+    }
+
+    bool has_buffered_message() const {
+        return channel->has_buffered_message();
     }
 
     void shutdown() {
@@ -67,7 +99,7 @@ public:
     const pid_t pid;
 
 private:
-    const int socket_fd;
+    std::unique_ptr<controller_ipc::Channel> channel;
 };
 #endif
 
@@ -76,15 +108,18 @@ struct ModuleStartInfo {
     enum class Language {
         cpp,
         javascript,
-        python
+        javascript_host,
+        python,
+        python_host
     };
     ModuleStartInfo(const std::string& name_, const std::string& printable_name_, Language lang_, const fs::path& path_,
-                    std::vector<std::string> capabilities_) :
+                    std::vector<std::string> capabilities_, const MQTTBufferSettings& mqtt_buffers_) :
         name(name_),
         printable_name(printable_name_),
         language(lang_),
         path(path_),
-        capabilities(std::move(capabilities_)) {
+        capabilities(std::move(capabilities_)),
+        mqtt_buffers(mqtt_buffers_) {
     }
     std::string name;
     std::string printable_name;
@@ -93,6 +128,15 @@ struct ModuleStartInfo {
 
     // required capabilities of this module
     std::vector<std::string> capabilities;
+
+    // MQTT buffer sizes of this module
+    MQTTBufferSettings mqtt_buffers;
+
+    // CPU placement and priority of this module
+    system::Scheduling scheduling;
+
+    // modules run in the worker threads of a javascript host
+    std::vector<ModuleStartInfo> hosted_modules;
 };
 
 /// \brief Setup common environment variables for everestjs and everestpy
@@ -184,8 +228,69 @@ static void exec_javascript_module(system::SubProcess& proc_handle, const Module
                                                 strerror(errno)));
 }
 
+/// \returns the id and path of all modules run by the host \p module_info
+static nlohmann::json get_hosted_modules(const ModuleStartInfo& module_info) {
+    nlohmann::json hosted_modules = nlohmann::json::array();
+    for (const auto& hosted_module : module_info.hosted_modules) {
+        hosted_modules.push_back({{"module", hosted_module.name}, {"path", hosted_module.path.string()}});
+    }
+    return hosted_modules;
+}
+
+/// \brief Starts a node process running all \p module_info.hosted_modules in its worker threads
+static void exec_javascript_host(system::SubProcess& proc_handle, const ModuleStartInfo& module_info,
+                                 const RuntimeSettings& rs, const MQTTSettings& mqtt_settings) {
+    const auto node_modules_path = rs.prefix / defaults::LIB_DIR / defaults::NAMESPACE / "node_modules";
+    setenv("NODE_PATH", node_modules_path.c_str(), 0);
+
+    setup_environment(module_info, rs, mqtt_settings);
+
+    setenv(EV_JS_HOST_MODULES, get_hosted_modules(module_info).dump().c_str(), 1);
+
+    const auto node_binary = "node";
+
+    std::vector<std::string> arguments = {
+        "node",
+        "--unhandled-rejections=strict",
+        (node_modules_path / "everestjs" / "host.js").string(),
+    };
+
+    const auto argv_list = arguments_to_exec_argv(arguments);
+    execvp(node_binary, argv_list.data());
+
+    // exec failed
+    proc_handle.send_error_and_exit(fmt::format("Syscall to execv() with \"{} {}\" failed ({})", node_binary,
+                                                fmt::join(arguments.begin() + 1, arguments.end(), " "),
+                                                strerror(errno)));
+}
+
+/// \brief Hands the python module over to the zygote listening on \p zygote_fd, which forks it with the environment
+/// of this process
+static void request_python_zygote_fork(system::SubProcess& proc_handle, const ModuleStartInfo& module_info,
+                                       int zygote_fd) {
+    nlohmann::json environment = nlohmann::json::object();
+    for (char** variable = environ; *variable != nullptr; variable++) {
+        const std::string_view entry(*variable);
+        const auto separator = entry.find('=');
+        if (separator != std::string_view::npos) {
+            environment[std::string(entry.substr(0, separator))] = std::string(entry.substr(separator + 1));
+        }
+    }
+
+    const auto request =
+        nlohmann::json({{"module", module_info.name}, {"path", module_info.path.string()}, {"env", environment}})
+            .dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+    if (send(zygote_fd, request.data(), request.size(), 0) == -1) {
+        proc_handle.send_error_and_exit(
+            fmt::format("Could not send module {} to the python zygote ({})", module_info.name, strerror(errno)));
+    }
+
+    // exiting without an error message reports success, the zygote reports the pid of the module to the manager
+    _exit(EXIT_SUCCESS);
+}
+
 static void exec_python_module(system::SubProcess& proc_handle, const ModuleStartInfo& module_info,
-                               const RuntimeSettings& rs, const MQTTSettings& mqtt_settings) {
+                               const RuntimeSettings& rs, const MQTTSettings& mqtt_settings, int zygote_fd) {
     // instead of using setenv, using execvpe might be a better way for a controlled environment!
 
     const auto pythonpath = rs.prefix / defaults::LIB_DIR / defaults::NAMESPACE / "everestpy";
@@ -194,6 +299,10 @@ static void exec_python_module(system::SubProcess& proc_handle, const ModuleStar
 
     setup_environment(module_info, rs, mqtt_settings);
 
+    if (zygote_fd != -1) {
+        request_python_zygote_fork(proc_handle, module_info, zygote_fd);
+    }
+
     const auto python_binary = "python3";
 
     std::vector<std::string> arguments = {python_binary, module_info.path.c_str()};
@@ -207,8 +316,67 @@ static void exec_python_module(system::SubProcess& proc_handle, const ModuleStar
                                                 strerror(errno)));
 }
 
+/// \brief Starts a python process running all \p module_info.hosted_modules in its threads
+static void exec_python_host(system::SubProcess& proc_handle, const ModuleStartInfo& module_info,
+                             const RuntimeSettings& rs, const MQTTSettings& mqtt_settings) {
+    const auto pythonpath = rs.prefix / defaults::LIB_DIR / defaults::NAMESPACE / "everestpy";
+    setenv("PYTHONPATH", pythonpath.c_str(), 0);
+
+    setup_environment(module_info, rs, mqtt_settings);
+
+    setenv(EV_PY_HOST_MODULES, get_hosted_modules(module_info).dump().c_str(), 1);
+
+    const auto python_binary = "python3";
+
+    std::vector<std::string> arguments = {python_binary, "-m", "everest.framework.host"};
+
+    const auto argv_list = arguments_to_exec_argv(arguments);
+    execvp(python_binary, argv_list.data());
+
+    // exec failed
+    proc_handle.send_error_and_exit(fmt::format("Syscall to execv() with \"{} {}\" failed ({})", python_binary,
+                                                fmt::join(arguments.begin() + 1, arguments.end(), " "),
+                                                strerror(errno)));
+}
+
+/// \returns the MQTT settings passed to a module via the environment, the variables without a value are unset
+static std::vector<std::pair<const char*, std::optional<std::string>>>
+module_mqtt_environment(const MQTTSettings& mqtt_settings, const MQTTBufferSettings& mqtt_buffers) {
+    std::optional<std::string> dispatch_metrics;
+    if (mqtt_settings.dispatch_metrics.enabled) {
+        dispatch_metrics = std::to_string(mqtt_settings.dispatch_metrics.publish_interval.count());
+    }
+    std::optional<std::string> handler_accounting;
+    if (mqtt_settings.handler_accounting.enabled) {
+        handler_accounting = std::to_string(mqtt_settings.handler_accounting.budget.count());
+    }
+    std::optional<std::string> broker_shards;
+    if (not mqtt_settings.broker_shards.empty()) {
+        broker_shards = mqtt_broker_shards_to_json(mqtt_settings.broker_shards).dump();
+    }
+    // buffer sizes are passed via the environment, since they are picked up the same way by all languages
+    return {{EV_MQTT_SEND_BUFFER_SIZE, std::to_string(mqtt_buffers.send_buffer_size)},
+            {EV_MQTT_RECV_BUFFER_SIZE, std::to_string(mqtt_buffers.recv_buffer_size)},
+            {EV_MQTT_GROWABLE_BUFFERS, mqtt_buffers.growable ? "1" : "0"},
+            {EV_MQTT_PAYLOAD_ENCODING, payload_encoding_to_string(mqtt_settings.payload_encoding)},
+            {EV_MQTT_QUEUES, mqtt_queue_settings_to_json(mqtt_settings.queues).dump()},
+            {EV_MQTT_DISPATCH_METRICS, dispatch_metrics},
+            {EV_MQTT_HANDLER_ACCOUNTING, handler_accounting},
+            {EV_MQTT_VAR_CACHE, mqtt_settings.var_cache ? "1" : "0"},
+            {EV_MQTT_TOPIC_ALIASES, mqtt_settings.topic_aliases ? "1" : "0"},
+            {EV_MQTT_BROKER_SHARDS, broker_shards}};
+}
+
 static void exec_module(const RuntimeSettings& rs, const MQTTSettings& mqtt_settings, const ModuleStartInfo& module,
-                        system::SubProcess& proc_handle) {
+                        system::SubProcess& proc_handle, int python_zygote_fd) {
+    for (const auto& [name, value] : module_mqtt_environment(mqtt_settings, module.mqtt_buffers)) {
+        if (value.has_value()) {
+            setenv(name, value->c_str(), 1);
+        } else {
+            unsetenv(name);
+        }
+    }
+
     switch (module.language) {
     case ModuleStartInfo::Language::cpp:
         exec_cpp_module(proc_handle, module, rs, mqtt_settings);
@@ -216,8 +384,14 @@ static void exec_module(const RuntimeSettings& rs, const MQTTSettings& mqtt_sett
     case ModuleStartInfo::Language::javascript:
         exec_javascript_module(proc_handle, module, rs, mqtt_settings);
         break;
+    case ModuleStartInfo::Language::javascript_host:
+        exec_javascript_host(proc_handle, module, rs, mqtt_settings);
+        break;
     case ModuleStartInfo::Language::python:
-        exec_python_module(proc_handle, module, rs, mqtt_settings);
+        exec_python_module(proc_handle, module, rs, mqtt_settings, python_zygote_fd);
+        break;
+    case ModuleStartInfo::Language::python_host:
+        exec_python_host(proc_handle, module, rs, mqtt_settings);
         break;
     default:
         throw std::logic_error("Module language not in enum");
@@ -225,45 +399,398 @@ static void exec_module(const RuntimeSettings& rs, const MQTTSettings& mqtt_sett
     }
 }
 
+/// \brief Points in time a module passed during its startup, these are logged once all modules are ready
+struct ModuleStartupTimeline {
+    std::optional<std::chrono::system_clock::time_point> spawned;     ///< exec of the module binary succeeded
+    std::optional<std::chrono::system_clock::time_point> config_sent; ///< manager answered the get_config request
+    std::optional<std::chrono::system_clock::time_point> ready;       ///< module finished its init and signaled ready
+};
+
+/// \brief Responses to the get_config requests of a module, serialized before the module is started
+struct ConfigResponses {
+    std::string config;                        ///< the config without the parts fetched from the retained topics
+    std::string snapshot;                      ///< the snapshot encoded as CBOR, which is what the modules request
+    std::shared_ptr<const json> snapshot_json; ///< only encoded again for requests of other encodings
+};
+
+/// \brief serializes the get_config responses of a module on a thread of its own, so the responses of all modules
+/// are serialized in parallel while the manager prepares the remaining modules
+static std::shared_future<ConfigResponses> serialize_config_responses(json module_config,
+                                                                     std::shared_ptr<const json> snapshot) {
+    return std::async(std::launch::async,
+                      [module_config = std::move(module_config), snapshot = std::move(snapshot)]() {
+                          ConfigResponses responses;
+                          responses.config = module_config.dump();
+                          responses.snapshot = encode_payload(*snapshot, MQTTPayloadEncoding::Cbor);
+                          responses.snapshot_json = snapshot;
+                          return responses;
+                      })
+        .share();
+}
+
+struct ModuleReadyInfo {
+    bool ready;
+    std::shared_ptr<TypedHandler> ready_token;
+    std::shared_ptr<TypedHandler> get_config_token;
+    ModuleStartupTimeline timeline;
+};
+
+// FIXME (aw): these are globals here, because they are used in the ready callback handlers
+std::map<std::string, ModuleReadyInfo> modules_ready;
+std::mutex modules_ready_mutex;
+/// \brief the modules each ready group waits for by group name, guarded by modules_ready_mutex
+std::map<std::string, std::set<std::string>> ready_groups;
+
+/// \returns the members of the ready groups in the \p main_config, together with all modules they require directly or
+/// indirectly, so the modules of a group never become ready before their requirements
+static std::map<std::string, std::set<std::string>> collect_ready_groups(const nlohmann::json& main_config) {
+    std::map<std::string, std::set<std::string>> groups;
+    for (const auto& [module_id, module_config] : main_config.items()) {
+        const auto group = module_config.value("ready_group", "");
+        if (group.empty()) {
+            continue;
+        }
+        auto& members = groups[group];
+        std::vector<std::string> pending{module_id};
+        while (not pending.empty()) {
+            const auto member = std::move(pending.back());
+            pending.pop_back();
+            if (not members.insert(member).second) {
+                continue;
+            }
+            const auto member_config = main_config.find(member);
+            if (member_config == main_config.end()) {
+                continue;
+            }
+            for (const auto& [requirement_id, fulfillments] :
+                 member_config->value("connections", nlohmann::json::object()).items()) {
+                for (const auto& fulfillment : fulfillments) {
+                    pending.push_back(fulfillment.at("module_id"));
+                }
+            }
+        }
+    }
+    return groups;
+}
+
+/// \brief publishes the ready signal of every ready group of \p module_name whose modules are all ready now
+static void publish_ready_groups(const std::string& module_name, MQTTAbstraction& mqtt_abstraction,
+                                 const std::string& mqtt_everest_prefix) {
+    for (const auto& [group, members] : ready_groups) {
+        if (members.count(module_name) == 0) {
+            continue;
+        }
+        // ignored modules are not tracked, like for the global ready signal
+        const auto all_ready = std::all_of(members.begin(), members.end(), [](const std::string& member) {
+            const auto ready_info = modules_ready.find(member);
+            return ready_info == modules_ready.end() or ready_info->second.ready;
+        });
+        if (all_ready) {
+            EVLOG_info << fmt::format("Modules of ready group {} are initialized", group);
+            mqtt_abstraction.publish(fmt::format("{}ready/{}", mqtt_everest_prefix, group), nlohmann::json(true));
+        }
+    }
+}
+
+/// \brief Logs the startup timeline of all modules relative to the start of the manager, the slowest module last
+static void log_startup_timeline() {
+    std::vector<std::pair<std::string, ModuleStartupTimeline>> timelines;
+    for (const auto& [module_name, ready_info] : modules_ready) {
+        timelines.emplace_back(module_name, ready_info.timeline);
+    }
+    std::stable_sort(timelines.begin(), timelines.end(),
+                     [](const auto& lhs, const auto& rhs) { return lhs.second.ready < rhs.second.ready; });
+
+    const auto since_start = [](const std::optional<std::chrono::system_clock::time_point>& time_point) {
+        if (not time_point.has_value()) {
+            return std::string("-");
+        }
+        return fmt::format(
+            "{}ms",
+            std::chrono::duration_cast<std::chrono::milliseconds>(time_point.value() - complete_start_time).count());
+    };
+    EVLOG_info << "Module startup timeline (spawned / config sent / ready):";
+    for (const auto& [module_name, timeline] : timelines) {
+        EVLOG_info << fmt::format("  {}: {} / {} / {}", module_name, since_start(timeline.spawned),
+                                  since_start(timeline.config_sent), since_start(timeline.ready));
+    }
+}
+
+/// \returns the startup timeline of all modules in milliseconds since the start of the manager, for the status fifo
+static nlohmann::json startup_timeline_json() {
+    const auto since_start = [](const std::optional<std::chrono::system_clock::time_point>& time_point) {
+        if (not time_point.has_value()) {
+            return nlohmann::json(nullptr);
+        }
+        return nlohmann::json(
+            std::chrono::duration_cast<std::chrono::milliseconds>(time_point.value() - complete_start_time).count());
+    };
+    auto timelines = nlohmann::json::object();
+    for (const auto& [module_name, ready_info] : modules_ready) {
+        timelines[module_name] = {{"spawned_ms", since_start(ready_info.timeline.spawned)},
+                                  {"config_sent_ms", since_start(ready_info.timeline.config_sent)},
+                                  {"ready_ms", since_start(ready_info.timeline.ready)}};
+    }
+    return timelines;
+}
+
+/// \returns the CPU placement and priority set in the scheduling entry of the \p module_config
+static system::Scheduling parse_scheduling(const nlohmann::json& module_config) {
+    system::Scheduling scheduling;
+    const auto scheduling_it = module_config.find("scheduling");
+    if (scheduling_it == module_config.end()) {
+        return scheduling;
+    }
+    scheduling.cpu_affinity = scheduling_it->value("cpu_affinity", scheduling.cpu_affinity);
+    if (scheduling_it->contains("nice")) {
+        scheduling.nice = scheduling_it->at("nice").get<int>();
+    }
+    if (scheduling_it->contains("realtime_priority")) {
+        scheduling.realtime_priority = scheduling_it->at("realtime_priority").get<int>();
+    }
+    scheduling.cgroup = scheduling_it->value("cgroup", scheduling.cgroup);
+    return scheduling;
+}
+
+/// \brief Replaces the modules of the given \p language without capabilities in \p modules by a single host process
+/// running all of them, at the position of the first of them
+static void host_modules(std::vector<ModuleStartInfo>& modules, ModuleStartInfo::Language language,
+                         ModuleStartInfo::Language host_language, const std::string& host_name) {
+    const auto is_hosted = [language](const ModuleStartInfo& module) {
+        // capabilities and scheduling are set per process, so modules requiring them keep their own process
+        return module.language == language and module.capabilities.empty() and module.scheduling.is_default();
+    };
+    const auto first_hosted = std::find_if(modules.begin(), modules.end(), is_hosted);
+    if (first_hosted == modules.end()) {
+        return;
+    }
+
+    ModuleStartInfo host(host_name, host_name, host_language, {}, {}, first_hosted->mqtt_buffers);
+    std::copy_if(modules.begin(), modules.end(), std::back_inserter(host.hosted_modules), is_hosted);
+    // all hosted modules share the MQTT connection, so it gets the largest buffers any of them asked for
+    for (const auto& hosted_module : host.hosted_modules) {
+        host.mqtt_buffers.send_buffer_size =
+            std::max(host.mqtt_buffers.send_buffer_size, hosted_module.mqtt_buffers.send_buffer_size);
+        host.mqtt_buffers.recv_buffer_size =
+            std::max(host.mqtt_buffers.recv_buffer_size, hosted_module.mqtt_buffers.recv_buffer_size);
+        host.mqtt_buffers.growable = host.mqtt_buffers.growable or hosted_module.mqtt_buffers.growable;
+    }
+    EVLOG_info << fmt::format("Hosting {} modules in {}", host.hosted_modules.size(), host_name);
+
+    *first_hosted = std::move(host);
+    modules.erase(std::remove_if(std::next(first_hosted), modules.end(), is_hosted), modules.end());
+}
+
+/// \brief Orders \p modules so that every module comes after the modules it is connected to, keeping the config
+/// order otherwise. Modules in dependency cycles are started in config order.
+static void sort_by_dependencies(std::vector<ModuleStartInfo>& modules, const nlohmann::json& main_config) {
+    std::map<std::string, std::size_t> module_indices;
+    for (std::size_t i = 0; i < modules.size(); i++) {
+        module_indices.emplace(modules.at(i).name, i);
+    }
+
+    std::vector<ModuleStartInfo> sorted;
+    sorted.reserve(modules.size());
+    std::vector<bool> visited(modules.size(), false);
+    const std::function<void(std::size_t)> visit = [&](std::size_t index) {
+        if (visited.at(index)) {
+            return;
+        }
+        visited.at(index) = true;
+        const auto& connections = main_config.at(modules.at(index).name).value("connections", nlohmann::json::object());
+        for (const auto& [requirement_id, fulfillments] : connections.items()) {
+            for (const auto& fulfillment : fulfillments) {
+                const auto provider = module_indices.find(fulfillment.at("module_id").get<std::string>());
+                if (provider != module_indices.end()) {
+                    visit(provider->second);
+                }
+            }
+        }
+        sorted.push_back(modules.at(index));
+    };
+    for (std::size_t i = 0; i < modules.size(); i++) {
+        visit(i);
+    }
+    modules = std::move(sorted);
+}
+
+/// \brief A python process with everestpy already imported, forking python modules on request. The modules share the
+/// pages of the interpreter and the bindings with the zygote until they write to them.
+struct PythonZygote {
+    PythonZygote(pid_t pid, int fd) : pid(pid), fd(fd) {
+    }
+    ~PythonZygote() {
+        close(this->fd);
+    }
+    PythonZygote(const PythonZygote&) = delete;
+    PythonZygote& operator=(const PythonZygote&) = delete;
+
+    const pid_t pid;
+    const int fd; ///< manager end of the socket the zygote receives requests on and reports forked modules on
+};
+
+/// \returns true if the module can be forked by the python zygote
+static bool use_python_zygote(const ModuleStartInfo& module) {
+    // capabilities and scheduling are set between fork and exec, which the zygote does not do
+    return module.language == ModuleStartInfo::Language::python and module.capabilities.empty() and
+           module.scheduling.is_default();
+}
+
+static std::unique_ptr<PythonZygote> spawn_python_zygote(const ManagerSettings& ms) {
+    std::array<int, 2> fds{};
+    // sequential packets keep the requests of concurrently spawned modules apart
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, fds.data()) == -1) {
+        throw std::runtime_error(fmt::format("Could not create socket for python zygote ({})", strerror(errno)));
+    }
+    // the zygote orphans the modules it forks, becoming their subreaper keeps them visible to waitpid
+    if (prctl(PR_SET_CHILD_SUBREAPER, 1) == -1) {
+        close(fds[0]);
+        close(fds[1]);
+        throw std::runtime_error(fmt::format("Syscall prctl() failed ({})", strerror(errno)));
+    }
+
+    auto proc_handle = system::SubProcess::create(ms.run_as_user);
+    if (proc_handle.is_child()) {
+        const auto& rs = ms.get_runtime_settings();
+        const auto pythonpath = rs.prefix / defaults::LIB_DIR / defaults::NAMESPACE / "everestpy";
+        setenv("PYTHONPATH", pythonpath.c_str(), 0);
+        setenv(EV_PYTHON_ZYGOTE_FD, std::to_string(fds[1]).c_str(), 1);
+        // only the zygote end of the socket is passed on
+        fcntl(fds[1], F_SETFD, 0);
+
+        const auto python_binary = "python3";
+        std::vector<std::string> arguments = {python_binary, "-m", "everest.framework.zygote"};
+        const auto argv_list = arguments_to_exec_argv(arguments);
+        execvp(python_binary, argv_list.data());
+
+        proc_handle.send_error_and_exit(fmt::format("Syscall to execv() with \"{} {}\" failed ({})", python_binary,
+                                                    fmt::join(arguments.begin() + 1, arguments.end(), " "),
+                                                    strerror(errno)));
+    }
+
+    const auto pid = proc_handle.check_child_executed();
+    close(fds[1]);
+    EVLOG_debug << fmt::format("Started python zygote with pid: {}", pid);
+    return std::make_unique<PythonZygote>(pid, fds[0]);
+}
+
+/// \returns the pid and the id of the next module the \p zygote reports to have forked
+static std::pair<pid_t, std::string> receive_python_zygote_module(const PythonZygote& zygote) {
+    pollfd poll_fd{zygote.fd, POLLIN, 0};
+    if (poll(&poll_fd, 1, PYTHON_ZYGOTE_TIMEOUT_MS) != 1) {
+        throw std::runtime_error("Python zygote did not report a forked module in time");
+    }
+
+    std::string report(MAX_PYTHON_ZYGOTE_REPORT_SIZE, '\0');
+    const auto size = recv(zygote.fd, report.data(), report.size(), 0);
+    if (size <= 0) {
+        throw std::runtime_error(fmt::format("Could not receive the report of the python zygote ({})",
+                                             size == 0 ? "zygote exited" : strerror(errno)));
+    }
+    report.resize(size);
+
+    const auto module = nlohmann::json::parse(report);
+    return {module.at("pid").get<pid_t>(), module.at("module").get<std::string>()};
+}
+
+/// \brief reports the \p started_modules as spawned on the \p status_fifo
+static std::map<pid_t, std::string> report_spawned(std::map<pid_t, std::string> started_modules,
+                                                   StatusFifo& status_fifo) {
+    for (const auto& [pid, module_name] : started_modules) {
+        status_fifo.report("module_state", module_name, {{"state", "spawned"}, {"pid", pid}});
+    }
+    return started_modules;
+}
+
 static std::map<pid_t, std::string> spawn_modules(const std::vector<ModuleStartInfo>& modules,
-                                                  const ManagerSettings& ms) {
+                                                  const ManagerSettings& ms, const ShmTransport* shm_transport,
+                                                  const ConfigImage* config_image, const PythonZygote* python_zygote) {
     std::map<pid_t, std::string> started_modules;
 
     const auto& rs = ms.get_runtime_settings();
 
-    for (const auto& module : modules) {
+    const auto mark_spawned = [](const std::string& module_name) {
+        const std::lock_guard<std::mutex> lock(modules_ready_mutex);
+        const auto module_it = modules_ready.find(module_name);
+        if (module_it != modules_ready.end()) {
+            module_it->second.timeline.spawned = std::chrono::system_clock::now();
+        }
+    };
+    const auto add_started_module = [&started_modules, &mark_spawned](pid_t pid, const std::string& module_name) {
+        EVLOG_debug << fmt::format("Forked module {} with pid: {}", module_name, pid);
+        started_modules[pid] = module_name;
+        mark_spawned(module_name);
+    };
+
+    if (python_zygote != nullptr) {
+        // the zygote is watched like a module, it should only exit when the modules are shut down
+        started_modules[python_zygote->pid] = "python_zygote";
+    }
+
+    // fork all modules first and only then wait for their exec, so the modules start up concurrently
+    std::vector<system::SubProcess> proc_handles;
+    proc_handles.reserve(modules.size());
+    for (std::size_t slot = 0; slot < modules.size(); slot++) {
+        const auto& module = modules.at(slot);
 
-        auto proc_handle = system::SubProcess::create(ms.run_as_user, module.capabilities);
+        auto proc_handle = system::SubProcess::create(ms.run_as_user, module.capabilities, module.scheduling);
 
         if (proc_handle.is_child()) {
             // first, check if we need any capabilities
 
             try {
-                exec_module(rs, ms.mqtt_settings, module, proc_handle);
+                if (shm_transport != nullptr) {
+                    shm_transport->setup_environment(slot);
+                }
+                if (config_image != nullptr) {
+                    config_image->setup_environment();
+                }
+
+                const auto python_zygote_fd =
+                    (python_zygote != nullptr and use_python_zygote(module)) ? python_zygote->fd : -1;
+                exec_module(rs, ms.mqtt_settings, module, proc_handle, python_zygote_fd);
             } catch (const std::exception& err) {
                 proc_handle.send_error_and_exit(err.what());
             }
         }
 
-        // we can only come here, if we're the parent!
-        const auto child_pid = proc_handle.check_child_executed();
+        proc_handles.push_back(proc_handle);
+    }
+
+    // we can only come here, if we're the parent!
+    std::size_t zygote_modules = 0;
+    for (std::size_t slot = 0; slot < modules.size(); slot++) {
+        const auto& module = modules.at(slot);
+        const auto child_pid = proc_handles.at(slot).check_child_executed();
 
-        EVLOG_debug << fmt::format("Forked module {} with pid: {}", module.name, child_pid);
-        started_modules[child_pid] = module.name;
+        if (python_zygote != nullptr and use_python_zygote(module)) {
+            // this child only passed the module on to the zygote and exited already
+            waitpid(child_pid, nullptr, 0);
+            zygote_modules++;
+            continue;
+        }
+        add_started_module(child_pid, module.name);
+        for (const auto& hosted_module : module.hosted_modules) {
+            mark_spawned(hosted_module.name);
+        }
+    }
+
+    for (std::size_t i = 0; i < zygote_modules; i++) {
+        const auto [pid, module_name] = receive_python_zygote_module(*python_zygote);
+        add_started_module(pid, module_name);
     }
 
     return started_modules;
 }
 
-struct ModuleReadyInfo {
-    bool ready;
-    std::shared_ptr<TypedHandler> ready_token;
-    std::shared_ptr<TypedHandler> get_config_token;
-};
+// shared memory segment of the currently running modules, replaced on every (re)start of the modules
+std::unique_ptr<ShmTransport> shm_transport;
 
-// FIXME (aw): these are globals here, because they are used in the ready callback handlers
-std::map<std::string, ModuleReadyInfo> modules_ready;
-std::mutex modules_ready_mutex;
+// config snapshots of the currently running modules, inherited by the spawned modules
+std::unique_ptr<ConfigImage> config_image;
+
+// zygote of the currently running python modules
+std::unique_ptr<PythonZygote> python_zygote;
 
 void cleanup_retained_topics(ManagerConfig& config, MQTTAbstraction& mqtt_abstraction,
                              const std::string& mqtt_everest_prefix) {
@@ -292,31 +819,46 @@ void cleanup_retained_topics(ManagerConfig& config, MQTTAbstraction& mqtt_abstra
     mqtt_abstraction.publish(fmt::format("{}module_config_cache", mqtt_everest_prefix), std::string(), QOS::QOS2, true);
 }
 
+/// \brief Starts all modules of \p config, or only the \p restarted_modules if given while the other modules keep
+/// running
 static std::map<pid_t, std::string> start_modules(ManagerConfig& config, MQTTAbstraction& mqtt_abstraction,
                                                   const std::vector<std::string>& ignored_modules,
                                                   const std::vector<std::string>& standalone_modules,
-                                                  const ManagerSettings& ms, StatusFifo& status_fifo) {
+                                                  const ManagerSettings& ms, StatusFifo& status_fifo,
+                                                  const std::set<std::string>* restarted_modules = nullptr) {
     BOOST_LOG_FUNCTION();
 
     std::vector<ModuleStartInfo> modules_to_spawn;
 
     const auto& main_config = config.get_main_config();
-    const auto number_of_modules = main_config.size();
+    {
+        const std::lock_guard<std::mutex> lock(modules_ready_mutex);
+        ready_groups = collect_ready_groups(main_config);
+    }
+    const auto number_of_modules = restarted_modules != nullptr ? restarted_modules->size() : main_config.size();
     EVLOG_info << "Starting " << number_of_modules << " modules";
 
     const auto serialized_config = config.serialize();
+    // the retained config topics are the largest messages in the broker, they are only compressed if enabled since
+    // tools reading them besides the modules might not support compressed payloads
+    const auto publish_retained_config = [&mqtt_abstraction, &ms](const std::string& topic, const json& data) {
+        if (ms.compress_retained_config) {
+            mqtt_abstraction.publish(topic, compress_payload(data.dump()), QOS::QOS2, true);
+        } else {
+            mqtt_abstraction.publish(topic, data, QOS::QOS2, true);
+        }
+    };
     const auto interface_definitions = config.get_interface_definitions();
     std::vector<std::string> interface_names;
     for (auto& interface_definition : interface_definitions.items()) {
         interface_names.push_back(interface_definition.key());
     }
-    mqtt_abstraction.publish(fmt::format("{}interfaces", ms.mqtt_settings.everest_prefix), interface_names, QOS::QOS2,
-                             true);
+    publish_retained_config(fmt::format("{}interfaces", ms.mqtt_settings.everest_prefix), interface_names);
 
     for (const auto& interface_definition : interface_definitions.items()) {
-        mqtt_abstraction.publish(
+        publish_retained_config(
             fmt::format("{}interface_definitions/{}", ms.mqtt_settings.everest_prefix, interface_definition.key()),
-            interface_definition.value(), QOS::QOS2, true);
+            interface_definition.value());
     }
 
     const auto type_definitions = config.get_types();
@@ -324,37 +866,41 @@ static std::map<pid_t, std::string> start_modules(ManagerConfig& config, MQTTAbs
     for (auto& type_definition : type_definitions.items()) {
         type_names.push_back(type_definition.key());
     }
-    mqtt_abstraction.publish(fmt::format("{}types", ms.mqtt_settings.everest_prefix), type_names, QOS::QOS2, true);
+    publish_retained_config(fmt::format("{}types", ms.mqtt_settings.everest_prefix), type_names);
     for (const auto& type_definition : type_definitions.items()) {
         // type_definition keys already start with a / so omit it in the topic name
-        mqtt_abstraction.publish(
+        publish_retained_config(
             fmt::format("{}type_definitions{}", ms.mqtt_settings.everest_prefix, type_definition.key()),
-            type_definition.value(), QOS::QOS2, true);
+            type_definition.value());
     }
 
     const auto module_provides = config.get_interfaces();
-    mqtt_abstraction.publish(fmt::format("{}module_provides", ms.mqtt_settings.everest_prefix), module_provides,
-                             QOS::QOS2, true);
+    publish_retained_config(fmt::format("{}module_provides", ms.mqtt_settings.everest_prefix), module_provides);
 
     const auto settings = config.get_settings();
-    mqtt_abstraction.publish(fmt::format("{}settings", ms.mqtt_settings.everest_prefix), settings, QOS::QOS2, true);
+    publish_retained_config(fmt::format("{}settings", ms.mqtt_settings.everest_prefix), settings);
 
     const auto schemas = config.get_schemas();
-    mqtt_abstraction.publish(fmt::format("{}schemas", ms.mqtt_settings.everest_prefix), schemas, QOS::QOS2, true);
+    publish_retained_config(fmt::format("{}schemas", ms.mqtt_settings.everest_prefix), schemas);
 
     const auto manifests = config.get_manifests();
-    mqtt_abstraction.publish(fmt::format("{}manifests", ms.mqtt_settings.everest_prefix), manifests, QOS::QOS2, true);
+    publish_retained_config(fmt::format("{}manifests", ms.mqtt_settings.everest_prefix), manifests);
 
     const auto error_types_map = config.get_error_types();
-    mqtt_abstraction.publish(fmt::format("{}error_types_map", ms.mqtt_settings.everest_prefix), error_types_map,
-                             QOS::QOS2, true);
+    publish_retained_config(fmt::format("{}error_types_map", ms.mqtt_settings.everest_prefix), error_types_map);
 
     const auto module_config_cache = config.get_module_config_cache();
-    mqtt_abstraction.publish(fmt::format("{}module_config_cache", ms.mqtt_settings.everest_prefix), module_config_cache,
-                             QOS::QOS2, true);
+    publish_retained_config(fmt::format("{}module_config_cache", ms.mqtt_settings.everest_prefix), module_config_cache);
+
+    // the parts of the config every module needs, sent along with its own slice to modules requesting a snapshot
+    const json shared_snapshot = {{"module_provides", module_provides}, {"settings", settings}, {"schemas", schemas}};
+    std::map<std::string, json> module_snapshots;
 
     for (const auto& module : serialized_config.at("module_names").items()) {
         const std::string& module_name = module.key();
+        if (restarted_modules != nullptr and restarted_modules->find(module_name) == restarted_modules->end()) {
+            continue;
+        }
         json serialized_mod_config = serialized_config;
         serialized_mod_config["module_config"] = json::object();
         // add mappings of fulfillments
@@ -388,7 +934,7 @@ static std::map<pid_t, std::string> start_modules(ManagerConfig& config, MQTTAbs
         // FIXME (aw): shall create a ref to main_confit.at(module_name)!
         const std::string module_type = main_config.at(module_name).at("module");
         // FIXME (aw): implicitely adding ModuleReadyInfo and setting its ready member
-        auto module_it = modules_ready.emplace(module_name, ModuleReadyInfo{false, nullptr, nullptr}).first;
+        auto module_it = modules_ready.emplace(module_name, ModuleReadyInfo{false, nullptr, nullptr, {}}).first;
 
         const auto capabilities = [&module_config = main_config.at(module_name)]() {
             const auto cap_it = module_config.find("capabilities");
@@ -399,18 +945,38 @@ static std::map<pid_t, std::string> start_modules(ManagerConfig& config, MQTTAbs
             return std::vector<std::string>(cap_it->begin(), cap_it->end());
         }();
 
+        const auto mqtt_buffers = parse_mqtt_buffer_settings(main_config.at(module_name), ms.mqtt_settings.buffers);
+
         if (not capabilities.empty()) {
             EVLOG_info << fmt::format("Module {} wants to aquire the following capabilities: {}", module_name,
                                       fmt::join(capabilities.begin(), capabilities.end(), " "));
         }
 
-        const Handler module_ready_handler = [module_name, &mqtt_abstraction, &config, standalone_modules,
+        auto scheduling = parse_scheduling(main_config.at(module_name));
+        if (not scheduling.is_default()) {
+            EVLOG_info << fmt::format(
+                "Module {} runs on CPUs [{}] with nice value {}, SCHED_FIFO priority {} in cgroup {}", module_name,
+                fmt::join(scheduling.cpu_affinity, ", "),
+                scheduling.nice.has_value() ? std::to_string(scheduling.nice.value()) : "-",
+                scheduling.realtime_priority.has_value() ? std::to_string(scheduling.realtime_priority.value()) : "-",
+                scheduling.cgroup.empty() ? "-" : scheduling.cgroup);
+        }
+
+        const Handler module_ready_handler = [module_name, &mqtt_abstraction, standalone_modules,
                                               mqtt_everest_prefix = ms.mqtt_settings.everest_prefix,
                                               &status_fifo](const std::string&, const nlohmann::json& json) {
             EVLOG_debug << fmt::format("received module ready signal for module: {}({})", module_name, json.dump());
             const std::unique_lock<std::mutex> lock(modules_ready_mutex);
             // FIXME (aw): here are race conditions, if the ready handler gets called while modules are shut down!
-            modules_ready.at(module_name).ready = json.get<bool>();
+            auto& ready_info = modules_ready.at(module_name);
+            ready_info.ready = json.get<bool>();
+            if (ready_info.ready) {
+                ready_info.timeline.ready = std::chrono::system_clock::now();
+            }
+            status_fifo.report("module_state", module_name, {{"state", ready_info.ready ? "ready" : "not_ready"}});
+            if (ready_info.ready) {
+                publish_ready_groups(module_name, mqtt_abstraction, mqtt_everest_prefix);
+            }
             std::size_t modules_spawned = 0;
             for (const auto& mod : modules_ready) {
                 const std::string text_ready =
@@ -427,11 +993,15 @@ static std::map<pid_t, std::string> start_modules(ManagerConfig& config, MQTTAbs
             if (std::all_of(modules_ready.begin(), modules_ready.end(),
                             [](const auto& element) { return element.second.ready; })) {
                 const auto complete_end_time = std::chrono::system_clock::now();
+                const auto startup_ms =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(complete_end_time - complete_start_time)
+                        .count();
                 status_fifo.update(StatusFifo::ALL_MODULES_STARTED);
+                status_fifo.report("startup", "", {{"elapsed_ms", startup_ms}, {"modules", startup_timeline_json()}});
                 EVLOG_info << fmt::format(
                     TERMINAL_STYLE_OK, "🚙🚙🚙 All modules are initialized. EVerest up and running [{}ms] 🚙🚙🚙",
-                    std::chrono::duration_cast<std::chrono::milliseconds>(complete_end_time - complete_start_time)
-                        .count());
+                    startup_ms);
+                log_startup_timeline();
                 // cleanup_retained_topics(config, mqtt_abstraction, mqtt_everest_prefix);
                 mqtt_abstraction.publish(fmt::format("{}ready", mqtt_everest_prefix), nlohmann::json(true));
             } else if (!standalone_modules.empty()) {
@@ -443,18 +1013,48 @@ static std::map<pid_t, std::string> start_modules(ManagerConfig& config, MQTTAbs
             }
         };
 
-        const std::string ready_topic = fmt::format("{}/ready", config.mqtt_module_prefix(module_name));
+        const std::string ready_topic = config.get_topic(module_name, ModuleTopic::Ready);
         module_it->second.ready_token =
             std::make_shared<TypedHandler>(HandlerType::ExternalMQTT, std::make_shared<Handler>(module_ready_handler));
         mqtt_abstraction.register_handler(ready_topic, module_it->second.ready_token, QOS::QOS2);
 
-        const std::string config_topic = fmt::format("{}/config", config.mqtt_module_prefix(module_name));
-        const Handler module_get_config_handler = [module_name, config_topic, serialized_mod_config,
+        json module_snapshot = serialized_mod_config;
+        module_snapshot.update(config.get_module_config_slice(module_name));
+        module_snapshot.update(shared_snapshot);
+        if (ms.shared_config_image) {
+            module_snapshots[module_name] = module_snapshot;
+        }
+        // the modules request their configs at nearly the same time, so the handler only hands out the bytes
+        const auto config_responses = serialize_config_responses(
+            std::move(serialized_mod_config), std::make_shared<const json>(std::move(module_snapshot)));
+
+        const std::string config_topic = config.get_topic(module_name, ModuleTopic::Config);
+        const Handler module_get_config_handler = [module_name, config_topic, config_responses,
                                                    &mqtt_abstraction](const std::string&, const nlohmann::json& json) {
-            mqtt_abstraction.publish(config_topic, serialized_mod_config.dump());
+            {
+                const std::lock_guard<std::mutex> lock(modules_ready_mutex);
+                const auto module_it = modules_ready.find(module_name);
+                if (module_it != modules_ready.end()) {
+                    module_it->second.timeline.config_sent = std::chrono::system_clock::now();
+                }
+            }
+
+            const auto& responses = config_responses.get();
+            if (json.value("type", "") != "snapshot") {
+                // the module fetches the remaining parts of the config from the retained topics
+                mqtt_abstraction.publish(config_topic, responses.config);
+                return;
+            }
+
+            const auto encoding = string_to_payload_encoding(json.value("encoding", "json"));
+            if (encoding == MQTTPayloadEncoding::Cbor) {
+                mqtt_abstraction.publish(config_topic, responses.snapshot);
+                return;
+            }
+            mqtt_abstraction.publish(config_topic, encode_payload(*responses.snapshot_json, encoding));
         };
 
-        const std::string get_config_topic = fmt::format("{}/get_config", config.mqtt_module_prefix(module_name));
+        const std::string get_config_topic = config.get_topic(module_name, ModuleTopic::GetConfig);
         module_it->second.get_config_token = std::make_shared<TypedHandler>(
             HandlerType::ExternalMQTT, std::make_shared<Handler>(module_get_config_handler));
         mqtt_abstraction.register_handler(get_config_topic, module_it->second.get_config_token, QOS::QOS2);
@@ -477,15 +1077,15 @@ static std::map<pid_t, std::string> start_modules(ManagerConfig& config, MQTTAbs
         if (fs::exists(binary_path)) {
             EVLOG_debug << fmt::format("module: {} ({}) provided as binary", module_name, module_type);
             modules_to_spawn.emplace_back(module_name, printable_module_name, ModuleStartInfo::Language::cpp,
-                                          binary_path, capabilities);
+                                          binary_path, capabilities, mqtt_buffers);
         } else if (fs::exists(javascript_library_path)) {
             EVLOG_debug << fmt::format("module: {} ({}) provided as javascript library", module_name, module_type);
             modules_to_spawn.emplace_back(module_name, printable_module_name, ModuleStartInfo::Language::javascript,
-                                          fs::canonical(javascript_library_path), capabilities);
+                                          fs::canonical(javascript_library_path), capabilities, mqtt_buffers);
         } else if (fs::exists(python_module_path)) {
             EVLOG_verbose << fmt::format("module: {} ({}) provided as python module", module_name, module_type);
             modules_to_spawn.emplace_back(module_name, printable_module_name, ModuleStartInfo::Language::python,
-                                          fs::canonical(python_module_path), capabilities);
+                                          fs::canonical(python_module_path), capabilities, mqtt_buffers);
         } else {
             throw std::runtime_error(
                 fmt::format("module: {} ({}) cannot be loaded because no Binary, JavaScript or Python "
@@ -496,9 +1096,54 @@ static std::map<pid_t, std::string> start_modules(ManagerConfig& config, MQTTAbs
                             "    py:  {}\n", module_name, module_type, binary_path.string(),
                             javascript_library_path.string(), python_module_path.string()));
         }
+        modules_to_spawn.back().scheduling = std::move(scheduling);
     }
 
-    return spawn_modules(modules_to_spawn, ms);
+    // providers are spawned before their consumers, so they are more likely to be up once their consumers need them
+    sort_by_dependencies(modules_to_spawn, main_config);
+
+    if (restarted_modules != nullptr) {
+        // restarted modules run in their own processes, the shared resources of the running modules stay untouched.
+        // The config image is still valid as long as the running config was not reloaded
+        return report_spawned(spawn_modules(modules_to_spawn, ms, nullptr, config_image.get(), python_zygote.get()),
+                              status_fifo);
+    }
+
+    if (ms.javascript_host) {
+        host_modules(modules_to_spawn, ModuleStartInfo::Language::javascript,
+                     ModuleStartInfo::Language::javascript_host, "javascript_host");
+    }
+    if (ms.python_host) {
+        host_modules(modules_to_spawn, ModuleStartInfo::Language::python, ModuleStartInfo::Language::python_host,
+                     "python_host");
+    }
+
+    shm_transport.reset();
+    if (ms.shm_transport) {
+        if (standalone_modules.empty()) {
+            shm_transport = ShmTransport::create(fmt::format("/everest_{}", getpid()), modules_to_spawn.size());
+        } else {
+            // standalone modules can not attach to the segment and would miss messages bypassing the broker
+            EVLOG_warning << "Shared memory transport disabled, since standalone modules are used";
+        }
+    }
+
+    config_image.reset();
+    if (ms.shared_config_image) {
+        config_image = ConfigImage::create(module_snapshots);
+        EVLOG_info << fmt::format("Sharing config of {} modules in an image of {} bytes", module_snapshots.size(),
+                                  config_image->get_size());
+    }
+
+    // the zygote is started last, so the modules it forks inherit the shared memory and config image as well
+    python_zygote.reset();
+    if (ms.python_zygote and std::any_of(modules_to_spawn.begin(), modules_to_spawn.end(), use_python_zygote)) {
+        python_zygote = spawn_python_zygote(ms);
+    }
+
+    return report_spawned(
+        spawn_modules(modules_to_spawn, ms, shm_transport.get(), config_image.get(), python_zygote.get()),
+        status_fifo);
 }
 
 static void shutdown_modules(const std::map<pid_t, std::string>& modules, ManagerConfig& config,
@@ -510,7 +1155,7 @@ static void shutdown_modules(const std::map<pid_t, std::string>& modules, Manage
         for (const auto& module : modules_ready) {
             const auto& ready_info = module.second;
             const auto& module_name = module.first;
-            const std::string topic = fmt::format("{}/ready", config.mqtt_module_prefix(module_name));
+            const std::string topic = config.get_topic(module_name, ModuleTopic::Ready);
             mqtt_abstraction.unregister_handler(topic, ready_info.ready_token);
         }
 
@@ -538,12 +1183,244 @@ static void shutdown_modules(const std::map<pid_t, std::string>& modules, Manage
     }
 }
 
+/// \brief Unregisters the ready and get_config handlers of the \p stopped_modules, so they can be started again
+static void forget_modules(const std::set<std::string>& stopped_modules, const ManagerConfig& config,
+                           MQTTAbstraction& mqtt_abstraction) {
+    const std::lock_guard<std::mutex> lock(modules_ready_mutex);
+    for (const auto& module_id : stopped_modules) {
+        const auto module_it = modules_ready.find(module_id);
+        if (module_it == modules_ready.end()) {
+            continue;
+        }
+        mqtt_abstraction.unregister_handler(config.get_topic(module_id, ModuleTopic::Ready),
+                                            module_it->second.ready_token);
+        mqtt_abstraction.unregister_handler(config.get_topic(module_id, ModuleTopic::GetConfig),
+                                            module_it->second.get_config_token);
+        modules_ready.erase(module_it);
+    }
+}
+
+/// \brief What the manager does when a module exits, configured in the restart entry of the module
+struct RestartPolicy {
+    std::size_t max_restarts;              ///< Restarts allowed before the module is given up
+    std::chrono::milliseconds backoff;     ///< Delay of the first restart, doubled with every further restart
+    std::chrono::milliseconds max_backoff; ///< Upper limit of the restart delay
+    std::chrono::seconds window;           ///< Restarts are counted from zero again after running this long
+    bool fatal;                            ///< Terminate all modules once the module is given up
+};
+
+/// \brief Restart bookkeeping of a module that exited at least once
+struct ModuleRestarts {
+    std::size_t count{0};                                           ///< Restarts within the window
+    std::chrono::steady_clock::time_point started;                  ///< Time of the last restart
+    std::optional<std::chrono::steady_clock::time_point> scheduled; ///< Time of the pending restart
+    bool given_up{false};                                           ///< The module exceeded its restarts
+};
+
+// restart bookkeeping of all modules that exited, only used by the main loop
+std::map<std::string, ModuleRestarts> module_restarts;
+
+/// \returns the restart policy in \p module_config, std::nullopt if there is none and exiting is fatal
+static std::optional<RestartPolicy> parse_restart_policy(const nlohmann::json& module_config) {
+    const auto restart = module_config.find("restart");
+    if (restart == module_config.end()) {
+        return std::nullopt;
+    }
+    return RestartPolicy{restart->value("max_restarts", std::size_t{3}),
+                         std::chrono::milliseconds(restart->value("backoff_ms", 1000)),
+                         std::chrono::milliseconds(restart->value("max_backoff_ms", 30000)),
+                         std::chrono::seconds(restart->value("window_s", 60)), restart->value("fatal", true)};
+}
+
+/// \brief Schedules the restart of the exited module \p module_id according to its restart policy
+/// \returns false if the exit is fatal for all modules
+static bool schedule_restart(const std::string& module_id, const ManagerConfig& config,
+                             MQTTAbstraction& mqtt_abstraction) {
+    const auto& main_config = config.get_main_config();
+    const auto module_config = main_config.find(module_id);
+    if (module_config == main_config.end()) {
+        // not a module of the config, but a process running several of them
+        return false;
+    }
+    const auto policy = parse_restart_policy(*module_config);
+    if (not policy.has_value()) {
+        return false;
+    }
+    if (shm_transport != nullptr) {
+        EVLOG_error << fmt::format("Module {} can not be restarted with the shared memory transport", module_id);
+        return false;
+    }
+
+    forget_modules({module_id}, config, mqtt_abstraction);
+
+    const auto now = std::chrono::steady_clock::now();
+    auto& restarts = module_restarts[module_id];
+    if (now - restarts.started > policy->window) {
+        restarts.count = 0;
+    }
+    if (restarts.count >= policy->max_restarts) {
+        restarts.given_up = true;
+        EVLOG_error << fmt::format("Module {} exceeded its {} restarts within {}s", module_id, policy->max_restarts,
+                                   policy->window.count());
+        return not policy->fatal;
+    }
+
+    auto backoff = policy->backoff;
+    for (std::size_t i = 0; i < restarts.count and backoff < policy->max_backoff; i++) {
+        backoff *= 2;
+    }
+    backoff = std::min(backoff, policy->max_backoff);
+    restarts.count++;
+    restarts.scheduled = now + backoff;
+    EVLOG_warning << fmt::format("Restarting module {} in {}ms ({}/{})", module_id, backoff.count(), restarts.count,
+                                 policy->max_restarts);
+    return true;
+}
+
+/// \brief Restarts all modules whose scheduled restart is due
+/// \returns the time until the next scheduled restart, std::nullopt if there is none
+static std::optional<std::chrono::steady_clock::duration>
+restart_due_modules(ManagerConfig& config, std::map<pid_t, std::string>& module_handles,
+                    MQTTAbstraction& mqtt_abstraction, const std::vector<std::string>& ignored_modules,
+                    const std::vector<std::string>& standalone_modules, const ManagerSettings& ms,
+                    StatusFifo& status_fifo) {
+    const auto now = std::chrono::steady_clock::now();
+    std::set<std::string> due_modules;
+    std::optional<std::chrono::steady_clock::duration> next_restart;
+    for (auto& [module_id, restarts] : module_restarts) {
+        if (not restarts.scheduled.has_value()) {
+            continue;
+        }
+        if (restarts.scheduled.value() <= now) {
+            due_modules.insert(module_id);
+            restarts.scheduled.reset();
+            restarts.started = now;
+        } else if (not next_restart.has_value() or restarts.scheduled.value() - now < next_restart.value()) {
+            next_restart = restarts.scheduled.value() - now;
+        }
+    }
+
+    if (not due_modules.empty()) {
+        auto restarted_handles = start_modules(config, mqtt_abstraction, ignored_modules, standalone_modules, ms,
+                                               status_fifo, &due_modules);
+        module_handles.insert(restarted_handles.begin(), restarted_handles.end());
+    }
+    return next_restart;
+}
+
+/// \brief Set by SIGHUP, asks the main loop to reload the config
+static volatile std::sig_atomic_t reload_requested = 0;
+
+/// \brief Reloads the config file and restarts only the modules whose config changed, all other modules keep running.
+/// The running config is kept if the reloaded one is invalid or changes settings shared by all modules
+static void reload_modules(std::unique_ptr<ManagerSettings>& reloaded_settings, std::unique_ptr<ManagerConfig>& config,
+                           std::map<pid_t, std::string>& module_handles, MQTTAbstraction& mqtt_abstraction,
+                           const std::vector<std::string>& ignored_modules,
+                           const std::vector<std::string>& standalone_modules, const ManagerSettings& ms,
+                           StatusFifo& status_fifo) {
+    BOOST_LOG_FUNCTION();
+
+    EVLOG_info << fmt::format("Reloading config file at: {}", ms.config_file.string());
+    std::unique_ptr<ManagerSettings> new_settings;
+    std::unique_ptr<ManagerConfig> new_config;
+    try {
+        new_settings = std::make_unique<ManagerSettings>(ms.runtime_settings->prefix.string(), ms.config_file.string());
+        new_config = std::make_unique<ManagerConfig>(*new_settings);
+    } catch (const std::exception& e) {
+        EVLOG_error << fmt::format("Failed to reload config, keeping the running one: {}", e.what());
+        return;
+    }
+
+    const auto changed_modules = config->get_changed_modules(*new_config);
+    if (not changed_modules.has_value()) {
+        EVLOG_error << "Reloaded config changes settings shared by all modules, restart the manager to apply it";
+        return;
+    }
+    if (changed_modules->empty()) {
+        EVLOG_info << "Reloaded config does not change any module";
+        return;
+    }
+    if (shm_transport != nullptr) {
+        EVLOG_error << "Modules can not be restarted individually with the shared memory transport, restart the "
+                       "manager to apply the reloaded config";
+        return;
+    }
+
+    const auto is_listed = [](const std::vector<std::string>& modules, const std::string& module_id) {
+        return std::find(modules.begin(), modules.end(), module_id) != modules.end();
+    };
+    std::set<std::string> restarted_modules;
+    std::map<pid_t, std::string> stopped_modules;
+    for (const auto& module_id : *changed_modules) {
+        if (is_listed(ignored_modules, module_id)) {
+            continue;
+        }
+        if (is_listed(standalone_modules, module_id)) {
+            EVLOG_warning << fmt::format("Config of standalone module {} changed, it needs to be restarted manually",
+                                         module_id);
+        }
+        const auto handle = std::find_if(module_handles.begin(), module_handles.end(),
+                                         [&module_id](const auto& handle) { return handle.second == module_id; });
+        const auto restarts = module_restarts.find(module_id);
+        const auto awaits_restart = restarts != module_restarts.end() and
+                                    (restarts->second.scheduled.has_value() or restarts->second.given_up);
+        if (handle != module_handles.end()) {
+            stopped_modules.insert(*handle);
+        } else if (config->contains(module_id) and not is_listed(standalone_modules, module_id) and
+                   not awaits_restart) {
+            EVLOG_error << fmt::format("Module {} shares its process with other modules and can not be restarted "
+                                       "individually, restart the manager to apply the reloaded config",
+                                       module_id);
+            return;
+        }
+        if (new_config->contains(module_id)) {
+            restarted_modules.insert(module_id);
+        }
+    }
+
+    EVLOG_info << fmt::format("Restarting changed modules: {}", fmt::join(*changed_modules, " "));
+    forget_modules(*changed_modules, *config, mqtt_abstraction);
+    for (const auto& module_id : *changed_modules) {
+        module_restarts.erase(module_id);
+    }
+    for (const auto& [pid, module_id] : stopped_modules) {
+        kill(pid, SIGTERM);
+    }
+    // the stopped modules are reaped here, so the main loop does not take them for crashed modules
+    const auto stop_deadline = std::chrono::steady_clock::now() + MODULE_STOP_TIMEOUT;
+    for (const auto& [pid, module_id] : stopped_modules) {
+        while (waitpid(pid, nullptr, WNOHANG) == 0) {
+            if (std::chrono::steady_clock::now() >= stop_deadline) {
+                EVLOG_warning << fmt::format("Module {} (pid: {}) did not exit after SIGTERM, killing it", module_id,
+                                             pid);
+                kill(pid, SIGKILL);
+                waitpid(pid, nullptr, 0);
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        module_handles.erase(pid);
+        EVLOG_info << fmt::format("Module {} (pid: {}) stopped", module_id, pid);
+    }
+
+    // the old config is destroyed before the settings it references
+    config = std::move(new_config);
+    reloaded_settings = std::move(new_settings);
+    // the config image only contains the snapshots of the old config
+    config_image.reset();
+
+    auto restarted_handles = start_modules(*config, mqtt_abstraction, ignored_modules, standalone_modules, ms,
+                                           status_fifo, &restarted_modules);
+    module_handles.insert(restarted_handles.begin(), restarted_handles.end());
+}
+
 #ifdef ENABLE_ADMIN_PANEL
 static ControllerHandle start_controller(const ManagerSettings& ms) {
     int socket_pair[2];
 
     // FIXME (aw): destroy this socketpair somewhere
-    auto retval = socketpair(AF_UNIX, SOCK_DGRAM, 0, socket_pair);
+    // a stream socket, the channel frames the messages itself so they are not limited by the datagram size
+    auto retval = socketpair(AF_UNIX, SOCK_STREAM, 0, socket_pair);
     const int manager_socket = socket_pair[0];
     const int controller_socket = socket_pair[1];
 
@@ -568,23 +1445,27 @@ static ControllerHandle start_controller(const ManagerSettings& ms) {
 
     close(controller_socket);
 
+    const auto encoding =
+        ms.controller_ipc_binary ? controller_ipc::Encoding::MessagePack : controller_ipc::Encoding::Json;
+    auto channel = std::make_unique<controller_ipc::Channel>(manager_socket, encoding);
+
     // send initial config to controller
-    controller_ipc::send_message(manager_socket,
-                                 {
-                                     {"method", "boot"},
-                                     {"params",
-                                      {
-                                          {"module_dir", ms.runtime_settings->modules_dir.string()},
-                                          {"interface_dir", ms.interfaces_dir.string()},
-                                          {"www_dir", ms.www_dir.string()},
-                                          {"configs_dir", ms.configs_dir.string()},
-                                          {"logging_config_file", ms.runtime_settings->logging_config_file.string()},
-                                          {"controller_port", ms.controller_port},
-                                          {"controller_rpc_timeout_ms", ms.controller_rpc_timeout_ms},
-                                      }},
-                                 });
-
-    return {proc_handle.check_child_executed(), manager_socket};
+    channel->send_message({
+        {"method", "boot"},
+        {"params",
+         {
+             {"module_dir", ms.runtime_settings->modules_dir.string()},
+             {"interface_dir", ms.interfaces_dir.string()},
+             {"www_dir", ms.www_dir.string()},
+             {"configs_dir", ms.configs_dir.string()},
+             {"logging_config_file", ms.runtime_settings->logging_config_file.string()},
+             {"controller_port", ms.controller_port},
+             {"controller_rpc_timeout_ms", ms.controller_rpc_timeout_ms},
+             {"ipc_encoding", static_cast<int>(encoding)},
+         }},
+    });
+
+    return {proc_handle.check_child_executed(), std::move(channel)};
 }
 #endif
 
@@ -719,11 +1600,25 @@ int boot(const po::variables_map& vm) {
         standalone_modules = vm["standalone"].as<std::vector<std::string>>();
     }
 
+    // host ids of the modules spawned by the host agents on other nodes, by module id
+    std::map<std::string, std::string> remote_modules;
     const auto& main_config = config->get_main_config();
     for (const auto& module : main_config.items()) {
         const std::string& module_id = module.key();
         // check if standalone parameter is set
         const auto& module_config = main_config.at(module_id);
+        if (module_config.contains("host")) {
+            const auto host_id = module_config.at("host").get<std::string>();
+            EVLOG_info << "Module " << fmt::format(TERMINAL_STYLE_BLUE, "{}", module_id)
+                       << " is started by host agent " << host_id;
+            remote_modules.emplace(module_id, host_id);
+            // remote modules fetch their config from the manager like standalone modules
+            if (std::find(standalone_modules.begin(), standalone_modules.end(), module_id) ==
+                standalone_modules.end()) {
+                standalone_modules.push_back(module_id);
+            }
+            continue;
+        }
         if (module_config.value("standalone", false)) {
             if (std::find(standalone_modules.begin(), standalone_modules.end(), module_id) ==
                 standalone_modules.end()) {
@@ -741,7 +1636,8 @@ int boot(const po::variables_map& vm) {
     }
 
     // create StatusFifo object
-    auto status_fifo = StatusFifo::create_from_path(vm["status-fifo"].as<std::string>());
+    auto status_fifo = StatusFifo::create_from_path(vm["status-fifo"].as<std::string>(),
+                                                    vm["status-fifo-structured"].as<bool>());
 
     auto mqtt_abstraction = MQTTAbstraction(ms.mqtt_settings);
 
@@ -761,7 +1657,50 @@ int boot(const po::variables_map& vm) {
     auto module_handles =
         start_modules(*config, mqtt_abstraction, ignored_modules, standalone_modules, ms, status_fifo);
     bool modules_started = true;
+
+    RemoteModuleHosts remote_hosts(mqtt_abstraction, ms.mqtt_settings.everest_prefix);
+    for (const auto& [module_id, host_id] : remote_modules) {
+        if (std::find(ignored_modules.begin(), ignored_modules.end(), module_id) != ignored_modules.end()) {
+            continue;
+        }
+        RemoteSpawnRequest request;
+        request.module_id = module_id;
+        request.module_type = main_config.at(module_id).at("module").get<std::string>();
+        request.printable_name = config->printable_identifier(module_id);
+        const auto mqtt_buffers = parse_mqtt_buffer_settings(main_config.at(module_id), ms.mqtt_settings.buffers);
+        for (const auto& [name, value] : module_mqtt_environment(ms.mqtt_settings, mqtt_buffers)) {
+            if (value.has_value()) {
+                request.environment.emplace(name, *value);
+            }
+        }
+        remote_hosts.spawn(host_id, request);
+    }
+
+    HeartbeatMonitor heartbeat_monitor(mqtt_abstraction, status_fifo);
+    heartbeat_monitor.update(*config, module_handles);
+
+    std::unique_ptr<MetricsEndpoint> metrics_endpoint;
+    if (ms.metrics_port > 0) {
+        metrics_endpoint =
+            std::make_unique<MetricsEndpoint>(mqtt_abstraction, ms.runtime_settings->telemetry_prefix, ms.metrics_port);
+    }
+    std::unique_ptr<ResourceMonitor> resource_monitor;
+    if (ms.resource_monitor_interval_ms > 0) {
+        resource_monitor =
+            std::make_unique<ResourceMonitor>(mqtt_abstraction, ms.runtime_settings->telemetry_prefix,
+                                              std::chrono::milliseconds(ms.resource_monitor_interval_ms));
+        resource_monitor->update(module_handles);
+    }
     bool restart_modules = false;
+    // settings of the last reloaded config, which is referenced by config
+    std::unique_ptr<ManagerSettings> reloaded_settings;
+    // time until the next scheduled module restart
+    std::optional<std::chrono::steady_clock::duration> next_restart;
+
+    struct sigaction reload_action {};
+    reload_action.sa_handler = [](int) { reload_requested = 1; };
+    // no SA_RESTART, so a blocking waitpid() returns to handle the reload
+    sigaction(SIGHUP, &reload_action, nullptr);
 
     int wstatus;
 
@@ -782,14 +1721,22 @@ int boot(const po::variables_map& vm) {
         // non-blocking if admin panel is enabled, as this main loop also processes controller RPC
         auto pid = waitpid(-1, &wstatus, WNOHANG);
 #else
-        // block if admin panel is disabled, no controller RPC is handled by main loop
-        auto pid = waitpid(-1, &wstatus, 0);
+        // block if admin panel is disabled, no controller RPC is handled by main loop, unless a restart is scheduled
+        // or the exits of remote modules are polled
+        const auto polling = next_restart.has_value() or not remote_hosts.empty();
+        auto pid = waitpid(-1, &wstatus, polling ? WNOHANG : 0);
 #endif
 
-        if (pid == 0) {
+        if (pid == 0 or (pid == -1 and errno == ECHILD and not remote_hosts.empty())) {
             // nothing new from our child process
+#ifndef ENABLE_ADMIN_PANEL
+            std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(
+                next_restart.value_or(std::chrono::milliseconds(100)), std::chrono::milliseconds(100)));
+#endif
         } else if (pid == -1) {
-            throw std::runtime_error(fmt::format("Syscall to waitpid() failed ({})", strerror(errno)));
+            if (errno != EINTR) {
+                throw std::runtime_error(fmt::format("Syscall to waitpid() failed ({})", strerror(errno)));
+            }
         } else {
 
 #ifdef ENABLE_ADMIN_PANEL
@@ -807,11 +1754,17 @@ int boot(const po::variables_map& vm) {
 
             const auto module_name = module_iter->second;
             module_handles.erase(module_iter);
-            // one of our modules died -> kill 'em all
-            if (modules_started) {
+            const auto restarting = modules_started and schedule_restart(module_name, *config, mqtt_abstraction);
+            status_fifo.report("module_state", module_name,
+                               {{"state", "exited"}, {"pid", pid}, {"status", wstatus}, {"restarting", restarting}});
+            if (restarting) {
+                EVLOG_error << fmt::format("Module {} (pid: {}) exited with status: {}.", module_name, pid, wstatus);
+            } else if (modules_started) {
+                // one of our modules died -> kill 'em all
                 EVLOG_critical << fmt::format("Module {} (pid: {}) exited with status: {}. Terminating all modules.",
                                               module_name, pid, wstatus);
                 shutdown_modules(module_handles, *config, mqtt_abstraction);
+                remote_hosts.stop_all();
                 modules_started = false;
 
                 // Exit if a module died, this gives systemd a change to restart manager
@@ -822,6 +1775,43 @@ int boot(const po::variables_map& vm) {
             }
         }
 
+        for (const auto& exit : remote_hosts.take_exits()) {
+            status_fifo.report("module_state", exit.module_id,
+                               {{"state", "exited"},
+                                {"host", exit.host_id},
+                                {"pid", exit.pid},
+                                {"status", exit.status},
+                                {"restarting", false}});
+            if (modules_started) {
+                EVLOG_critical << fmt::format(
+                    "Module {} (pid: {} on host {}) exited with status: {}. Terminating all modules.", exit.module_id,
+                    exit.pid, exit.host_id, exit.status);
+                shutdown_modules(module_handles, *config, mqtt_abstraction);
+                remote_hosts.stop_all();
+                modules_started = false;
+
+                EVLOG_critical << "Exiting manager.";
+                return EXIT_FAILURE;
+            }
+            EVLOG_info << fmt::format("Module {} (pid: {} on host {}) exited with status: {}.", exit.module_id,
+                                      exit.pid, exit.host_id, exit.status);
+        }
+
+        if (reload_requested != 0 and modules_started) {
+            reload_requested = 0;
+            reload_modules(reloaded_settings, config, module_handles, mqtt_abstraction, ignored_modules,
+                           standalone_modules, ms, status_fifo);
+        }
+
+        if (modules_started) {
+            next_restart = restart_due_modules(*config, module_handles, mqtt_abstraction, ignored_modules,
+                                               standalone_modules, ms, status_fifo);
+        }
+        heartbeat_monitor.update(*config, module_handles);
+        if (resource_monitor != nullptr) {
+            resource_monitor->update(module_handles);
+        }
+
 #ifdef ENABLE_ADMIN_PANEL
         if (module_handles.size() == 0 && restart_modules) {
             module_handles =
@@ -830,37 +1820,48 @@ int boot(const po::variables_map& vm) {
             modules_started = true;
         }
 
-        // check for news from the controller
-        const auto msg = controller_handle.receive_message();
-        if (msg.status == controller_ipc::MESSAGE_RETURN_STATUS::OK) {
-            // FIXME (aw): implement all possible messages here, for now just log them
-            const auto& payload = msg.json;
-            if (payload.at("method") == "restart_modules") {
-                shutdown_modules(module_handles, *config, mqtt_abstraction);
-                config = std::make_unique<ManagerConfig>(ms);
-                modules_started = false;
-                restart_modules = true;
-            } else if (payload.at("method") == "check_config") {
-                const std::string check_config_file_path = payload.at("params");
-
-                try {
-                    // check the config
-                    auto cfg = ManagerConfig(ManagerSettings(prefix_opt, check_config_file_path));
-                    controller_handle.send_message({{"id", payload.at("id")}});
-                } catch (const std::exception& e) {
-                    controller_handle.send_message({{"result", e.what()}, {"id", payload.at("id")}});
+        // check for news from the controller, everything it sent in one go is handled in this iteration
+        bool more_messages = true;
+        while (more_messages) {
+            const auto msg = controller_handle.receive_message();
+            if (msg.status == controller_ipc::MESSAGE_RETURN_STATUS::OK) {
+                // FIXME (aw): implement all possible messages here, for now just log them
+                const auto& payload = msg.json;
+                if (payload.at("method") == "restart_modules") {
+                    shutdown_modules(module_handles, *config, mqtt_abstraction);
+                    config = std::make_unique<ManagerConfig>(ms);
+                    modules_started = false;
+                    restart_modules = true;
+                } else if (payload.at("method") == "get_module_resources") {
+                    controller_handle.queue_message(
+                        {{"result", resource_monitor != nullptr ? resource_monitor->get_snapshot() : json::object()},
+                         {"id", payload.at("id")}});
+                } else if (payload.at("method") == "check_config") {
+                    const std::string check_config_file_path = payload.at("params");
+
+                    try {
+                        // check the config
+                        auto cfg = ManagerConfig(ManagerSettings(prefix_opt, check_config_file_path));
+                        controller_handle.queue_message({{"id", payload.at("id")}});
+                    } catch (const std::exception& e) {
+                        controller_handle.queue_message({{"result", e.what()}, {"id", payload.at("id")}});
+                    }
+                } else {
+                    // unknown payload
+                    EVLOG_error << fmt::format("Received unkown command via controller ipc:\n{}\n... ignoring",
+                                               payload.dump(DUMP_INDENT));
                 }
+                more_messages = controller_handle.has_buffered_message();
+            } else if (msg.status == controller_ipc::MESSAGE_RETURN_STATUS::ERROR) {
+                fmt::print("Error in IPC communication with controller: {}\nExiting\n", msg.json.at("error").dump(2));
+                return EXIT_FAILURE;
             } else {
-                // unknown payload
-                EVLOG_error << fmt::format("Received unkown command via controller ipc:\n{}\n... ignoring",
-                                           payload.dump(DUMP_INDENT));
+                // TIMEOUT fall-through
+                more_messages = false;
             }
-        } else if (msg.status == controller_ipc::MESSAGE_RETURN_STATUS::ERROR) {
-            fmt::print("Error in IPC communication with controller: {}\nExiting\n", msg.json.at("error").dump(2));
-            return EXIT_FAILURE;
-        } else {
-            // TIMEOUT fall-through
         }
+        // the replies are written together
+        controller_handle.flush();
 #endif
     }
 
@@ -889,6 +1890,8 @@ int main(int argc, char* argv[]) {
                        "looked up in the default config directory");
     desc.add_options()("status-fifo", po::value<std::string>()->default_value(""),
                        "Path to a named pipe, that shall be used for status updates from the manager");
+    desc.add_options()("status-fifo-structured", po::bool_switch(),
+                       "Also write module state changes, startup timings and health to the status fifo as JSON lines");
 
     po::variables_map vm;
 
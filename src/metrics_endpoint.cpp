@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#include "metrics_endpoint.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <fmt/core.h>
+
+#include <everest/logging.hpp>
+#include <utils/metrics.hpp>
+
+namespace Everest {
+
+namespace {
+constexpr std::size_t max_request_size = 8192;
+constexpr int listen_backlog = 8;
+constexpr auto client_timeout_s = 2;
+
+void send_all(int fd, const std::string& data) {
+    std::size_t sent = 0;
+    while (sent < data.size()) {
+        const auto result = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (result < 0 and errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            return;
+        }
+        sent += static_cast<std::size_t>(result);
+    }
+}
+
+std::string make_response(const std::string& status, const std::string& content_type, const std::string& body) {
+    return fmt::format("HTTP/1.1 {}\r\nContent-Type: {}\r\nContent-Length: {}\r\nConnection: close\r\n\r\n{}", status,
+                       content_type, body.size(), body);
+}
+} // namespace
+
+MetricsEndpoint::MetricsEndpoint(MQTTAbstraction& mqtt_abstraction_, const std::string& telemetry_prefix, int port) :
+    mqtt_abstraction(mqtt_abstraction_), metrics_topic(fmt::format("{}metrics/+", telemetry_prefix)) {
+    this->listen_fd = ::socket(AF_INET6, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (this->listen_fd < 0) {
+        throw std::runtime_error(fmt::format("Could not create metrics endpoint socket: {}", strerror(errno)));
+    }
+    const int enable = 1;
+    const int disable = 0;
+    setsockopt(this->listen_fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    // serve IPv4 as well
+    setsockopt(this->listen_fd, IPPROTO_IPV6, IPV6_V6ONLY, &disable, sizeof(disable));
+
+    sockaddr_in6 address{};
+    address.sin6_family = AF_INET6;
+    address.sin6_addr = in6addr_any;
+    address.sin6_port = htons(static_cast<std::uint16_t>(port));
+    if (::bind(this->listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 or
+        ::listen(this->listen_fd, listen_backlog) != 0) {
+        const auto error = strerror(errno);
+        ::close(this->listen_fd);
+        throw std::runtime_error(fmt::format("Could not listen on metrics port {}: {}", port, error));
+    }
+
+    const auto handle_metrics = [this](const std::string& topic, const nlohmann::json& data) {
+        auto snapshot = data.is_string() ? nlohmann::json::parse(data.get<std::string>(), nullptr, false) : data;
+        if (not snapshot.is_array()) {
+            EVLOG_warning << fmt::format("Ignoring invalid metrics published on {}", topic);
+            return;
+        }
+        const std::lock_guard<std::mutex> lock(this->snapshots_mutex);
+        this->snapshots[topic] = std::move(snapshot);
+    };
+    this->metrics_token =
+        std::make_shared<TypedHandler>(HandlerType::ExternalMQTT, std::make_shared<Handler>(handle_metrics));
+    this->mqtt_abstraction.register_handler(this->metrics_topic, this->metrics_token, QOS::QOS0);
+
+    this->server_thread = std::thread(&MetricsEndpoint::serve, this);
+    EVLOG_info << fmt::format("Serving OpenMetrics of all modules on port {}", port);
+}
+
+MetricsEndpoint::~MetricsEndpoint() {
+    this->mqtt_abstraction.unregister_handler(this->metrics_topic, this->metrics_token);
+    // makes the blocking accept() return
+    ::shutdown(this->listen_fd, SHUT_RDWR);
+    if (this->server_thread.joinable()) {
+        this->server_thread.join();
+    }
+    ::close(this->listen_fd);
+}
+
+std::string MetricsEndpoint::get_openmetrics() {
+    auto samples = nlohmann::json::array();
+    {
+        const std::lock_guard<std::mutex> lock(this->snapshots_mutex);
+        for (const auto& [topic, snapshot] : this->snapshots) {
+            samples.insert(samples.end(), snapshot.begin(), snapshot.end());
+        }
+    }
+    return to_openmetrics(samples);
+}
+
+void MetricsEndpoint::serve() {
+    while (true) {
+        const int client_fd = ::accept4(this->listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client_fd < 0) {
+            if (errno == EINTR or errno == ECONNABORTED) {
+                continue;
+            }
+            // shut down
+            return;
+        }
+        this->handle_client(client_fd);
+        ::close(client_fd);
+    }
+}
+
+void MetricsEndpoint::handle_client(int client_fd) {
+    // scrapes are answered one after another, a slow client must not block the others forever
+    timeval timeout{client_timeout_s, 0};
+    setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos and request.size() < max_request_size) {
+        const auto received = ::recv(client_fd, buffer, sizeof(buffer), 0);
+        if (received < 0 and errno == EINTR) {
+            continue;
+        }
+        if (received <= 0) {
+            return;
+        }
+        request.append(buffer, static_cast<std::size_t>(received));
+    }
+
+    const auto request_line = request.substr(0, request.find("\r\n"));
+    if (request_line.rfind("GET /metrics ", 0) != 0 and request_line.rfind("GET /metrics?", 0) != 0) {
+        send_all(client_fd, make_response("404 Not Found", "text/plain", "Metrics are served on /metrics\n"));
+        return;
+    }
+    send_all(client_fd, make_response("200 OK", "application/openmetrics-text; version=1.0.0; charset=utf-8",
+                                      this->get_openmetrics()));
+}
+
+} // namespace Everest
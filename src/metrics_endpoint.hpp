@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <nlohmann/json.hpp>
+
+#include <utils/mqtt_abstraction.hpp>
+#include <utils/types.hpp>
+
+namespace Everest {
+
+///
+/// \brief Serves the metrics published by all modules on the telemetry topic metrics/<module id> via HTTP in the
+/// OpenMetrics text format, so they can be scraped by Prometheus
+///
+class MetricsEndpoint {
+public:
+    /// \throws std::runtime_error if \p port can not be bound
+    MetricsEndpoint(MQTTAbstraction& mqtt_abstraction, const std::string& telemetry_prefix, int port);
+    ~MetricsEndpoint();
+    MetricsEndpoint(const MetricsEndpoint&) = delete;
+    MetricsEndpoint& operator=(const MetricsEndpoint&) = delete;
+
+    /// \returns the last published metrics of all modules in the OpenMetrics text format
+    std::string get_openmetrics();
+
+private:
+    void serve();
+    void handle_client(int client_fd);
+
+    MQTTAbstraction& mqtt_abstraction;
+    std::string metrics_topic;
+    std::shared_ptr<TypedHandler> metrics_token;
+    std::mutex snapshots_mutex;
+    std::map<std::string, nlohmann::json> snapshots; ///< last published metrics by topic
+    int listen_fd{-1};
+    std::thread server_thread;
+};
+
+} // namespace Everest
@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <string>
+
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+
+#include <framework/runtime.hpp>
+
+namespace Everest {
+
+// Messages between the manager and the host agents spawning modules on other nodes, exchanged on the topics
+// <everest prefix>hosts/<host id>/<message>
+inline constexpr auto REMOTE_HOST_ONLINE = "online"; ///< retained by the agent, true while it accepts spawn requests
+inline constexpr auto REMOTE_HOST_SPAWN = "spawn";   ///< manager to agent, a RemoteSpawnRequest
+inline constexpr auto REMOTE_HOST_STOP = "stop";     ///< manager to agent, the id of the module to stop
+inline constexpr auto REMOTE_HOST_EXIT = "exit";     ///< agent to manager, a RemoteModuleExit
+
+/// \returns the topic of the \p message of the host agent \p host_id
+inline std::string get_remote_host_topic(const std::string& everest_prefix, const std::string& host_id,
+                                         const std::string& message) {
+    return fmt::format("{}hosts/{}/{}", everest_prefix, host_id, message);
+}
+
+/// The only environment variables a spawn request may set, which are the MQTT settings the manager passes to its
+/// modules via the environment
+inline constexpr std::array<const char*, 10> REMOTE_MODULE_ENVIRONMENT = {
+    EV_MQTT_SEND_BUFFER_SIZE, EV_MQTT_RECV_BUFFER_SIZE, EV_MQTT_GROWABLE_BUFFERS, EV_MQTT_PAYLOAD_ENCODING,
+    EV_MQTT_QUEUES, EV_MQTT_DISPATCH_METRICS, EV_MQTT_HANDLER_ACCOUNTING, EV_MQTT_VAR_CACHE, EV_MQTT_TOPIC_ALIASES,
+    EV_MQTT_BROKER_SHARDS};
+
+/// \returns true if a spawn request may set the environment variable \p name
+inline bool is_remote_module_environment(const std::string& name) {
+    return std::any_of(REMOTE_MODULE_ENVIRONMENT.begin(), REMOTE_MODULE_ENVIRONMENT.end(),
+                       [&name](const char* allowed) { return name == allowed; });
+}
+
+/// \brief Asks a host agent to spawn a C++ module
+struct RemoteSpawnRequest {
+    std::string module_id;
+    std::string spawn_id;       ///< unique per request, so exits of a replaced instance can be told apart
+    std::string module_type;    ///< name of the module, which is looked up in the modules directory of the agent
+    std::string printable_name; ///< passed as the process name
+    /// set for the module in addition to the one of the agent, limited to REMOTE_MODULE_ENVIRONMENT
+    std::map<std::string, std::string> environment;
+};
+
+/// \returns why the agent refuses to spawn \p request, or an empty string if it is valid
+inline std::string validate_spawn_request(const RemoteSpawnRequest& request) {
+    // the module type names a directory below the modules directory, it must not escape it
+    if (request.module_type.empty() or request.module_type.find('/') != std::string::npos or
+        request.module_type.find("..") != std::string::npos) {
+        return fmt::format("invalid module type '{}'", request.module_type);
+    }
+    for (const auto& [name, value] : request.environment) {
+        if (not is_remote_module_environment(name)) {
+            return fmt::format("environment variable {} is not allowed", name);
+        }
+    }
+    return {};
+}
+
+/// \brief Reported by a host agent when a module it spawned exited
+struct RemoteModuleExit {
+    std::string host_id;
+    std::string module_id;
+    std::string spawn_id; ///< of the request the module was spawned for
+    int pid{0};           ///< on the node of the agent, -1 if the module was not spawned
+    int status{0};        ///< as reported by waitpid()
+};
+
+inline void to_json(nlohmann::json& j, const RemoteSpawnRequest& request) {
+    j = {{"module_id", request.module_id},
+         {"spawn_id", request.spawn_id},
+         {"module_type", request.module_type},
+         {"printable_name", request.printable_name},
+         {"environment", request.environment}};
+}
+
+inline void from_json(const nlohmann::json& j, RemoteSpawnRequest& request) {
+    request.module_id = j.at("module_id").get<std::string>();
+    request.spawn_id = j.at("spawn_id").get<std::string>();
+    request.module_type = j.at("module_type").get<std::string>();
+    request.printable_name = j.value("printable_name", request.module_id);
+    request.environment = j.value("environment", std::map<std::string, std::string>{});
+}
+
+inline void to_json(nlohmann::json& j, const RemoteModuleExit& exit) {
+    j = {{"host_id", exit.host_id},
+         {"module_id", exit.module_id},
+         {"spawn_id", exit.spawn_id},
+         {"pid", exit.pid},
+         {"status", exit.status}};
+}
+
+inline void from_json(const nlohmann::json& j, RemoteModuleExit& exit) {
+    exit.host_id = j.at("host_id").get<std::string>();
+    exit.module_id = j.at("module_id").get<std::string>();
+    exit.spawn_id = j.at("spawn_id").get<std::string>();
+    exit.pid = j.at("pid").get<int>();
+    exit.status = j.at("status").get<int>();
+}
+
+} // namespace Everest
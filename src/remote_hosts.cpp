@@ -0,0 +1,143 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#include "remote_hosts.hpp"
+
+#include <utility>
+
+#include <boost/uuid/random_generator.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <boost/uuid/uuid_io.hpp>
+#include <fmt/core.h>
+
+#include <everest/logging.hpp>
+
+namespace Everest {
+
+RemoteModuleHosts::RemoteModuleHosts(MQTTAbstraction& mqtt_abstraction_, const std::string& everest_prefix_) :
+    mqtt_abstraction(mqtt_abstraction_), everest_prefix(everest_prefix_) {
+}
+
+RemoteModuleHosts::~RemoteModuleHosts() {
+    this->stop_all();
+    for (const auto& [host_id, host] : this->hosts) {
+        this->mqtt_abstraction.unregister_handler(
+            get_remote_host_topic(this->everest_prefix, host_id, REMOTE_HOST_ONLINE), host.online_token);
+        this->mqtt_abstraction.unregister_handler(
+            get_remote_host_topic(this->everest_prefix, host_id, REMOTE_HOST_EXIT), host.exit_token);
+    }
+}
+
+void RemoteModuleHosts::spawn(const std::string& host_id, RemoteSpawnRequest request) {
+    request.spawn_id = boost::uuids::to_string(boost::uuids::random_generator()());
+    std::shared_ptr<TypedHandler> online_token;
+    std::shared_ptr<TypedHandler> exit_token;
+    {
+        const std::lock_guard<std::mutex> lock(this->hosts_mutex);
+        auto [host, inserted] = this->hosts.try_emplace(host_id);
+        host->second.modules[request.module_id] = request.spawn_id;
+        if (not inserted) {
+            if (host->second.online) {
+                this->publish_spawn(host_id, request);
+            } else {
+                host->second.pending.push_back(request);
+            }
+            return;
+        }
+        host->second.pending.push_back(request);
+
+        const auto handle_online = [this, host_id](const std::string&, const nlohmann::json& data) {
+            this->handle_online(host_id, data);
+        };
+        const auto handle_exit = [this, host_id](const std::string&, const nlohmann::json& data) {
+            this->handle_exit(host_id, data);
+        };
+        online_token =
+            std::make_shared<TypedHandler>(HandlerType::ExternalMQTT, std::make_shared<Handler>(handle_online));
+        exit_token = std::make_shared<TypedHandler>(HandlerType::ExternalMQTT, std::make_shared<Handler>(handle_exit));
+        host->second.online_token = online_token;
+        host->second.exit_token = exit_token;
+    }
+
+    EVLOG_info << fmt::format("Waiting for host agent {} to spawn module {}", host_id, request.module_id);
+    // the exit handler is registered first, so no exit of a module spawned once the agent is online is missed
+    this->mqtt_abstraction.register_handler(get_remote_host_topic(this->everest_prefix, host_id, REMOTE_HOST_EXIT),
+                                            exit_token, QOS::QOS2);
+    this->mqtt_abstraction.register_handler(get_remote_host_topic(this->everest_prefix, host_id, REMOTE_HOST_ONLINE),
+                                            online_token, QOS::QOS2);
+}
+
+void RemoteModuleHosts::stop_all() {
+    const std::lock_guard<std::mutex> lock(this->hosts_mutex);
+    for (auto& [host_id, host] : this->hosts) {
+        host.pending.clear();
+        for (const auto& [module_id, spawn_id] : host.modules) {
+            EVLOG_info << fmt::format("Stopping module {} on host {}", module_id, host_id);
+            this->mqtt_abstraction.publish(get_remote_host_topic(this->everest_prefix, host_id, REMOTE_HOST_STOP),
+                                           nlohmann::json(module_id), QOS::QOS2);
+        }
+        host.modules.clear();
+    }
+}
+
+bool RemoteModuleHosts::empty() const {
+    const std::lock_guard<std::mutex> lock(this->hosts_mutex);
+    for (const auto& [host_id, host] : this->hosts) {
+        if (not host.modules.empty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<RemoteModuleExit> RemoteModuleHosts::take_exits() {
+    const std::lock_guard<std::mutex> lock(this->hosts_mutex);
+    return std::exchange(this->exits, {});
+}
+
+void RemoteModuleHosts::handle_online(const std::string& host_id, const nlohmann::json& data) {
+    const auto online = data.is_boolean() and data.get<bool>();
+    const std::lock_guard<std::mutex> lock(this->hosts_mutex);
+    auto& host = this->hosts.at(host_id);
+    if (online == host.online) {
+        return;
+    }
+    host.online = online;
+    if (not online) {
+        EVLOG_warning << fmt::format("Host agent {} went offline", host_id);
+        return;
+    }
+    EVLOG_info << fmt::format("Host agent {} is online", host_id);
+    for (const auto& request : std::exchange(host.pending, {})) {
+        this->publish_spawn(host_id, request);
+    }
+}
+
+void RemoteModuleHosts::handle_exit(const std::string& host_id, const nlohmann::json& data) {
+    RemoteModuleExit exit;
+    try {
+        exit = data.get<RemoteModuleExit>();
+    } catch (const nlohmann::json::exception& e) {
+        EVLOG_warning << fmt::format("Ignoring invalid exit report of host agent {}: {}", host_id, e.what());
+        return;
+    }
+    exit.host_id = host_id;
+    const std::lock_guard<std::mutex> lock(this->hosts_mutex);
+    // modules stopped by stop_all() are already forgotten and the exits of replaced instances report an older spawn id,
+    // both are expected
+    auto& modules = this->hosts.at(host_id).modules;
+    const auto module = modules.find(exit.module_id);
+    if (module == modules.end() or module->second != exit.spawn_id) {
+        return;
+    }
+    modules.erase(module);
+    this->exits.push_back(std::move(exit));
+}
+
+void RemoteModuleHosts::publish_spawn(const std::string& host_id, const RemoteSpawnRequest& request) {
+    EVLOG_info << fmt::format("Spawning module {} on host {}", request.module_id, host_id);
+    this->mqtt_abstraction.publish(get_remote_host_topic(this->everest_prefix, host_id, REMOTE_HOST_SPAWN),
+                                   nlohmann::json(request), QOS::QOS2);
+}
+
+} // namespace Everest
@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <utils/mqtt_abstraction.hpp>
+#include <utils/types.hpp>
+
+#include "remote_host_protocol.hpp"
+
+namespace Everest {
+
+///
+/// \brief Spawns the modules with a host entry in their config through the host agent running on that node and
+/// collects their exits
+/// \details Spawn requests are held back until the agent announced it is online, so the manager and the agents can be
+///          started in any order. The modules fetch their config from the manager like standalone modules, which is
+///          why they are treated as standalone modules otherwise.
+///
+class RemoteModuleHosts {
+public:
+    RemoteModuleHosts(MQTTAbstraction& mqtt_abstraction, const std::string& everest_prefix);
+    ~RemoteModuleHosts();
+    RemoteModuleHosts(const RemoteModuleHosts&) = delete;
+    RemoteModuleHosts& operator=(const RemoteModuleHosts&) = delete;
+
+    ///
+    /// \brief asks the agent \p host_id to spawn the module of \p request, as soon as the agent is online
+    /// \details The spawn id of the request is set here, only exits reporting it are taken
+    ///
+    void spawn(const std::string& host_id, RemoteSpawnRequest request);
+
+    /// \brief asks the agents to stop all modules spawned through them, which are then forgotten
+    void stop_all();
+
+    /// \returns true if no modules are spawned on remote hosts
+    bool empty() const;
+
+    /// \returns the modules that exited since the last call, exited modules are forgotten
+    std::vector<RemoteModuleExit> take_exits();
+
+private:
+    struct Host {
+        std::shared_ptr<TypedHandler> online_token;
+        std::shared_ptr<TypedHandler> exit_token;
+        bool online{false};
+        std::vector<RemoteSpawnRequest> pending; ///< requests held back until the agent is online
+        std::map<std::string, std::string> modules; ///< spawn ids by module id, of the modules not exited yet
+    };
+
+    void handle_online(const std::string& host_id, const nlohmann::json& data);
+    void handle_exit(const std::string& host_id, const nlohmann::json& data);
+    void publish_spawn(const std::string& host_id, const RemoteSpawnRequest& request);
+
+    MQTTAbstraction& mqtt_abstraction;
+    std::string everest_prefix;
+    mutable std::mutex hosts_mutex;
+    std::map<std::string, Host> hosts;
+    std::vector<RemoteModuleExit> exits;
+};
+
+} // namespace Everest
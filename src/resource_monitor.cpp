@@ -0,0 +1,246 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#include "resource_monitor.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <fmt/core.h>
+
+#include <everest/logging.hpp>
+
+namespace Everest {
+
+namespace {
+/// large enough for stat, statm, io and status of a process
+constexpr std::size_t proc_file_buffer_size = 4096;
+
+int open_proc_file(pid_t pid, const char* name) {
+    return ::open(fmt::format("/proc/{}/{}", pid, name).c_str(), O_RDONLY | O_CLOEXEC);
+}
+
+/// \returns the current content of the already opened proc file \p fd, empty if it could not be read
+std::string_view read_proc_file(int fd, char (&buffer)[proc_file_buffer_size]) {
+    if (fd < 0) {
+        return {};
+    }
+    // proc files are regenerated with every read from the start
+    const auto size = ::pread(fd, buffer, sizeof(buffer) - 1, 0);
+    if (size <= 0) {
+        return {};
+    }
+    buffer[size] = '\0';
+    return {buffer, static_cast<std::size_t>(size)};
+}
+
+/// \returns the value of the line starting with \p key in the "key: value" formatted proc file \p content
+std::optional<std::uint64_t> find_value(std::string_view content, std::string_view key) {
+    std::size_t position = 0;
+    while (position < content.size()) {
+        const auto line_end = std::min(content.find('\n', position), content.size());
+        const auto line = content.substr(position, line_end - position);
+        if (line.size() > key.size() and line.compare(0, key.size(), key) == 0 and line[key.size()] == ':') {
+            return std::strtoull(line.data() + key.size() + 1, nullptr, 10);
+        }
+        position = line_end + 1;
+    }
+    return std::nullopt;
+}
+
+/// \returns the space separated fields of /proc/<pid>/stat following the command, which can contain spaces itself
+std::vector<std::string_view> stat_fields(std::string_view content) {
+    std::vector<std::string_view> fields;
+    const auto command_end = content.rfind(')');
+    if (command_end == std::string_view::npos) {
+        return fields;
+    }
+    auto position = command_end + 2;
+    while (position < content.size()) {
+        const auto field_end = std::min(content.find(' ', position), content.size());
+        fields.push_back(content.substr(position, field_end - position));
+        position = field_end + 1;
+    }
+    return fields;
+}
+
+std::uint64_t to_uint64(std::string_view field) {
+    return std::strtoull(std::string(field).c_str(), nullptr, 10);
+}
+} // namespace
+
+void to_json(nlohmann::json& j, const ModuleResources& resources) {
+    j = {{"pid", resources.pid},
+         {"cpu_percent", resources.cpu_percent},
+         {"rss_bytes", resources.rss_bytes},
+         {"threads", resources.threads},
+         {"voluntary_ctxt_switches", resources.voluntary_ctxt_switches},
+         {"nonvoluntary_ctxt_switches", resources.nonvoluntary_ctxt_switches}};
+    if (resources.read_bytes.has_value()) {
+        j["read_bytes"] = resources.read_bytes.value();
+    }
+    if (resources.write_bytes.has_value()) {
+        j["write_bytes"] = resources.write_bytes.value();
+    }
+}
+
+struct ResourceMonitor::ModuleProcess {
+    pid_t pid;
+    int stat_fd;
+    int statm_fd;
+    int io_fd;
+    std::optional<std::uint64_t> last_cpu_ticks; ///< not set before the first sample
+    std::chrono::steady_clock::time_point last_sampled;
+    std::optional<ModuleResources> resources;
+
+    explicit ModuleProcess(pid_t pid_) :
+        pid(pid_),
+        stat_fd(open_proc_file(pid_, "stat")),
+        statm_fd(open_proc_file(pid_, "statm")),
+        io_fd(open_proc_file(pid_, "io")) {
+    }
+
+    ~ModuleProcess() {
+        for (const auto fd : {this->stat_fd, this->statm_fd, this->io_fd}) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+    }
+
+    ModuleProcess(const ModuleProcess&) = delete;
+    ModuleProcess& operator=(const ModuleProcess&) = delete;
+
+    /// \returns false if the process could not be sampled, e.g. because it exited
+    bool sample() {
+        static const auto ticks_per_second = static_cast<double>(sysconf(_SC_CLK_TCK));
+        static const auto page_size = static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+        char buffer[proc_file_buffer_size];
+
+        // utime, stime and num_threads are the 14th, 15th and 20th field, the fields start with the 3rd one
+        const auto fields = stat_fields(read_proc_file(this->stat_fd, buffer));
+        if (fields.size() < 18) {
+            return false;
+        }
+        ModuleResources sampled;
+        sampled.pid = this->pid;
+        const auto cpu_ticks = to_uint64(fields.at(11)) + to_uint64(fields.at(12));
+        sampled.threads = to_uint64(fields.at(17));
+        const auto now = std::chrono::steady_clock::now();
+        if (this->last_cpu_ticks.has_value()) {
+            const auto elapsed = std::chrono::duration<double>(now - this->last_sampled).count();
+            if (elapsed > 0) {
+                sampled.cpu_percent =
+                    100.0 * static_cast<double>(cpu_ticks - this->last_cpu_ticks.value()) / ticks_per_second / elapsed;
+            }
+        }
+        this->last_cpu_ticks = cpu_ticks;
+        this->last_sampled = now;
+
+        // size resident shared text lib data dt, in pages
+        const auto statm = read_proc_file(this->statm_fd, buffer);
+        const auto resident = statm.find(' ');
+        if (resident != std::string_view::npos) {
+            sampled.rss_bytes = std::strtoull(statm.data() + resident + 1, nullptr, 10) * page_size;
+        }
+
+        const auto io = read_proc_file(this->io_fd, buffer);
+        sampled.read_bytes = find_value(io, "read_bytes");
+        sampled.write_bytes = find_value(io, "write_bytes");
+
+        // the context switches in /proc/<pid>/status only count the main thread
+        const auto task_dir_path = fmt::format("/proc/{}/task", this->pid);
+        if (auto* task_dir = ::opendir(task_dir_path.c_str())) {
+            while (const auto* entry = ::readdir(task_dir)) {
+                if (entry->d_name[0] == '.') {
+                    continue;
+                }
+                const int status_fd =
+                    ::open(fmt::format("{}/{}/status", task_dir_path, entry->d_name).c_str(), O_RDONLY | O_CLOEXEC);
+                const auto status = read_proc_file(status_fd, buffer);
+                sampled.voluntary_ctxt_switches += find_value(status, "voluntary_ctxt_switches").value_or(0);
+                sampled.nonvoluntary_ctxt_switches += find_value(status, "nonvoluntary_ctxt_switches").value_or(0);
+                if (status_fd >= 0) {
+                    ::close(status_fd);
+                }
+            }
+            ::closedir(task_dir);
+        }
+
+        this->resources = sampled;
+        return true;
+    }
+};
+
+ResourceMonitor::ResourceMonitor(MQTTAbstraction& mqtt_abstraction_, const std::string& telemetry_prefix_,
+                                 std::chrono::milliseconds interval) :
+    mqtt_abstraction(mqtt_abstraction_), telemetry_prefix(telemetry_prefix_) {
+    this->sample_timer = this->mqtt_abstraction.get_event_loop().add_timer(interval, [this]() { this->sample(); });
+    EVLOG_info << fmt::format("Sampling the resource use of all modules every {}ms", interval.count());
+}
+
+ResourceMonitor::~ResourceMonitor() {
+    this->mqtt_abstraction.get_event_loop().remove(this->sample_timer);
+}
+
+void ResourceMonitor::update(const std::map<pid_t, std::string>& running_modules_) {
+    if (running_modules_ == this->running_modules) {
+        return;
+    }
+    this->running_modules = running_modules_;
+
+    const std::lock_guard<std::mutex> lock(this->modules_mutex);
+    std::map<std::string, pid_t> pids;
+    for (const auto& [pid, module_id] : this->running_modules) {
+        pids.emplace(module_id, pid);
+    }
+    for (auto it = this->modules.begin(); it != this->modules.end();) {
+        const auto pid = pids.find(it->first);
+        if (pid == pids.end() or pid->second != it->second->pid) {
+            it = this->modules.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (const auto& [module_id, pid] : pids) {
+        if (this->modules.count(module_id) == 0) {
+            this->modules.emplace(module_id, std::make_unique<ModuleProcess>(pid));
+        }
+    }
+}
+
+nlohmann::json ResourceMonitor::get_snapshot() {
+    auto snapshot = nlohmann::json::object();
+    const std::lock_guard<std::mutex> lock(this->modules_mutex);
+    for (const auto& [module_id, process] : this->modules) {
+        if (process->resources.has_value()) {
+            snapshot[module_id] = process->resources.value();
+        }
+    }
+    return snapshot;
+}
+
+void ResourceMonitor::sample() {
+    std::vector<std::pair<std::string, nlohmann::json>> samples;
+    {
+        const std::lock_guard<std::mutex> lock(this->modules_mutex);
+        samples.reserve(this->modules.size());
+        for (const auto& [module_id, process] : this->modules) {
+            if (process->sample()) {
+                samples.emplace_back(module_id, process->resources.value());
+            }
+        }
+    }
+    for (const auto& [module_id, resources] : samples) {
+        this->mqtt_abstraction.publish(fmt::format("{}resources/{}", this->telemetry_prefix, module_id),
+                                       resources.dump());
+    }
+}
+
+} // namespace Everest
@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include <sys/types.h>
+
+#include <nlohmann/json.hpp>
+
+#include <utils/event_loop.hpp>
+#include <utils/mqtt_abstraction.hpp>
+
+namespace Everest {
+
+///
+/// \brief Resource use of a module process, sampled from /proc
+///
+struct ModuleResources {
+    pid_t pid{0};
+    double cpu_percent{0};      ///< CPU time used since the previous sample, 100 per fully used core
+    std::uint64_t rss_bytes{0}; ///< Resident memory
+    std::uint64_t threads{0};
+    std::uint64_t voluntary_ctxt_switches{0};    ///< Of all threads since the module was started
+    std::uint64_t nonvoluntary_ctxt_switches{0}; ///< Of all threads since the module was started
+    std::optional<std::uint64_t> read_bytes;     ///< Read from storage, not set if /proc/<pid>/io is not readable
+    std::optional<std::uint64_t> write_bytes;    ///< Written to storage, not set if /proc/<pid>/io is not readable
+};
+
+void to_json(nlohmann::json& j, const ModuleResources& resources);
+
+///
+/// \brief Samples the resource use of the modules spawned by the manager and publishes it on the telemetry topic
+/// resources/<module id>
+/// \details The /proc files of every module are opened once and re-read on each sample by a single timer on the event
+///          loop, so sampling does not spawn threads or processes. Context switches are summed over the threads of
+///          the module.
+///
+class ResourceMonitor {
+public:
+    ResourceMonitor(MQTTAbstraction& mqtt_abstraction, const std::string& telemetry_prefix,
+                    std::chrono::milliseconds interval);
+    ~ResourceMonitor();
+    ResourceMonitor(const ResourceMonitor&) = delete;
+    ResourceMonitor& operator=(const ResourceMonitor&) = delete;
+
+    /// \brief samples the running \p modules by pid, modules that are no longer running are forgotten
+    void update(const std::map<pid_t, std::string>& running_modules);
+
+    /// \returns the last sampled resource use by module id
+    nlohmann::json get_snapshot();
+
+private:
+    struct ModuleProcess;
+
+    void sample();
+
+    MQTTAbstraction& mqtt_abstraction;
+    std::string telemetry_prefix;
+    std::map<pid_t, std::string> running_modules; ///< of the last update, only used by the thread calling update()
+    std::mutex modules_mutex;
+    std::map<std::string, std::unique_ptr<ModuleProcess>> modules;
+    EventLoop::Id sample_timer{0};
+};
+
+} // namespace Everest
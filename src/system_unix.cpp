@@ -4,15 +4,18 @@
 #include "system_unix.hpp"
 
 #include <cassert>
+#include <cstring>
 #include <stdexcept>
 
 #include <fcntl.h>
 #include <grp.h>
 #include <linux/securebits.h>
 #include <pwd.h>
+#include <sched.h>
 #include <signal.h>
 #include <sys/capability.h>
 #include <sys/prctl.h>
+#include <sys/resource.h>
 #include <unistd.h>
 
 #include <fmt/core.h>
@@ -159,6 +162,55 @@ pid_t SubProcess::check_child_executed() {
     return pid;
 }
 
+std::string set_scheduling(const Scheduling& scheduling) {
+    // the cgroup and the priorities usually need privileges, which are gone once the real user has been set
+    if (not scheduling.cgroup.empty()) {
+        const auto cgroup_procs =
+            (scheduling.cgroup.front() == '/' ? scheduling.cgroup : "/sys/fs/cgroup/" + scheduling.cgroup) +
+            "/cgroup.procs";
+        const auto fd = open(cgroup_procs.c_str(), O_WRONLY | O_CLOEXEC);
+        // writing 0 moves the writing process
+        if (fd == -1 or write(fd, "0", 1) != 1) {
+            const auto error = fmt::format("Could not move process to cgroup {} ({})", cgroup_procs, strerror(errno));
+            if (fd != -1) {
+                close(fd);
+            }
+            return error;
+        }
+        close(fd);
+    }
+
+    if (not scheduling.cpu_affinity.empty()) {
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        for (const auto cpu : scheduling.cpu_affinity) {
+            if (cpu < 0 or cpu >= CPU_SETSIZE) {
+                return fmt::format("Invalid CPU {} in CPU affinity", cpu);
+            }
+            CPU_SET(cpu, &cpu_set);
+        }
+        if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+            return fmt::format("Syscall sched_setaffinity() failed ({})", strerror(errno));
+        }
+    }
+
+    if (scheduling.nice.has_value() and setpriority(PRIO_PROCESS, 0, scheduling.nice.value()) != 0) {
+        return fmt::format("Syscall setpriority() with nice value {} failed ({})", scheduling.nice.value(),
+                           strerror(errno));
+    }
+
+    if (scheduling.realtime_priority.has_value()) {
+        sched_param param{};
+        param.sched_priority = scheduling.realtime_priority.value();
+        if (sched_setscheduler(0, SCHED_FIFO, &param) != 0) {
+            return fmt::format("Syscall sched_setscheduler() with SCHED_FIFO priority {} failed ({})",
+                               param.sched_priority, strerror(errno));
+        }
+    }
+
+    return {};
+}
+
 std::string set_user_and_capabilities(const std::string& run_as_user, const std::vector<std::string>& capabilities) {
     if (not capabilities.empty()) {
         // we need to keep caps, otherwise, we'll loose all our capabilities (except inherited)
@@ -187,7 +239,8 @@ std::string set_user_and_capabilities(const std::string& run_as_user, const std:
     return {};
 }
 
-SubProcess SubProcess::create(const std::string& run_as_user, const std::vector<std::string>& capabilities) {
+SubProcess SubProcess::create(const std::string& run_as_user, const std::vector<std::string>& capabilities,
+                              const Scheduling& scheduling) {
     int pipefd[2];
 
     if (pipe2(pipefd, O_CLOEXEC | O_DIRECT)) {
@@ -210,7 +263,12 @@ SubProcess SubProcess::create(const std::string& run_as_user, const std::vector<
         close(reading_end_fd);
 
         SubProcess handle{writing_end_fd, pid};
-        auto error = set_user_and_capabilities(run_as_user, capabilities);
+        auto error = set_scheduling(scheduling);
+        if (not error.empty()) {
+            handle.send_error_and_exit(error);
+        }
+
+        error = set_user_and_capabilities(run_as_user, capabilities);
 
         if (not error.empty()) {
             handle.send_error_and_exit(error);
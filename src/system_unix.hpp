@@ -4,6 +4,7 @@
 #pragma once
 
 #include <cstddef>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -11,9 +12,26 @@
 
 namespace Everest::system {
 
+///
+/// \brief CPU placement and priority of a module process, applied between fork and exec so all of its threads inherit
+/// them
+///
+struct Scheduling {
+    std::vector<int> cpu_affinity;        ///< CPUs the process may run on, all if empty
+    std::optional<int> nice;              ///< Nice value of the process, negative values need CAP_SYS_NICE
+    std::optional<int> realtime_priority; ///< Runs the process with SCHED_FIFO and this priority (1-99)
+    std::string cgroup;                   ///< cgroup v2 directory the process is moved to, relative to /sys/fs/cgroup
+
+    bool is_default() const {
+        return this->cpu_affinity.empty() and not this->nice.has_value() and not this->realtime_priority.has_value() and
+               this->cgroup.empty();
+    }
+};
+
 class SubProcess {
 public:
-    static SubProcess create(const std::string& run_as_user, const std::vector<std::string>& capabilities = {});
+    static SubProcess create(const std::string& run_as_user, const std::vector<std::string>& capabilities = {},
+                             const Scheduling& scheduling = {});
     bool is_child() const {
         return this->pid == 0;
     }
@@ -36,6 +54,9 @@ std::string set_caps(const std::vector<std::string>& capabilities);
 
 std::string set_real_user(const std::string& user_name);
 
+/// \returns an error message if \p scheduling could not be applied to the calling process, empty otherwise
+std::string set_scheduling(const Scheduling& scheduling);
+
 std::string set_user_and_capabilities(const std::string& run_as_user, const std::vector<std::string>& capabilities);
 
 } // namespace Everest::system
@@ -0,0 +1,257 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+
+// Replays the everest messages a module received during a traffic recording against a module under test and reports
+// how long the module took to answer the replayed cmd calls
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <boost/program_options.hpp>
+#include <fmt/core.h>
+
+#include <everest/exceptions.hpp>
+#include <utils/latency_histogram.hpp>
+#include <utils/mqtt_abstraction.hpp>
+#include <utils/payload_encoding.hpp>
+#include <utils/traffic_recorder.hpp>
+
+namespace po = boost::program_options;
+
+namespace {
+/// \returns the CPU time the process \p pid spent so far, or nothing if it cannot be read
+std::optional<std::chrono::milliseconds> read_cpu_time(int pid) {
+    std::ifstream stat(fmt::format("/proc/{}/stat", pid));
+    std::string line;
+    if (not std::getline(stat, line)) {
+        return std::nullopt;
+    }
+    // the command name can contain spaces, the fields are counted from its closing parenthesis
+    std::istringstream fields(line.substr(line.rfind(')') + 1));
+    std::vector<std::string> values{std::istream_iterator<std::string>(fields), std::istream_iterator<std::string>()};
+    constexpr std::size_t utime_index = 11;
+    constexpr std::size_t stime_index = 12;
+    if (values.size() <= stime_index) {
+        return std::nullopt;
+    }
+    const auto ticks = std::stoull(values.at(utime_index)) + std::stoull(values.at(stime_index));
+    return std::chrono::milliseconds(ticks * 1000 / sysconf(_SC_CLK_TCK));
+}
+
+/// \brief Latencies of the replayed cmd calls until the module under test published their results
+class CallLatencies {
+public:
+    void sent(const Everest::PayloadEnvelope& call, const std::string& topic) {
+        const std::lock_guard<std::mutex> lock(this->mutex);
+        const auto key = fmt::format("{} {}", topic, call.name);
+        this->histograms.try_emplace(key);
+        this->pending[call.id] = {key, std::chrono::steady_clock::now()};
+    }
+
+    void received(const Everest::PayloadEnvelope& result) {
+        const auto now = std::chrono::steady_clock::now();
+        const std::lock_guard<std::mutex> lock(this->mutex);
+        const auto call = this->pending.find(result.id);
+        if (call == this->pending.end()) {
+            return;
+        }
+        this->histograms.at(call->second.key).record(now - call->second.sent);
+        this->pending.erase(call);
+    }
+
+    std::size_t get_pending() {
+        const std::lock_guard<std::mutex> lock(this->mutex);
+        return this->pending.size();
+    }
+
+    std::map<std::string, Everest::LatencySummary> get_summaries() {
+        const std::lock_guard<std::mutex> lock(this->mutex);
+        std::map<std::string, Everest::LatencySummary> summaries;
+        for (const auto& [key, histogram] : this->histograms) {
+            summaries[key] = histogram.get_summary();
+        }
+        return summaries;
+    }
+
+private:
+    struct PendingCall {
+        std::string key;
+        std::chrono::steady_clock::time_point sent;
+    };
+
+    std::mutex mutex;
+    std::map<std::string, Everest::LatencyHistogram> histograms; ///< by cmd topic and name
+    std::map<std::string, PendingCall> pending;                  ///< by call id
+};
+
+std::string format_us(std::chrono::nanoseconds duration) {
+    return fmt::format("{:.1f}us", std::chrono::duration<double, std::micro>(duration).count());
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    po::options_description desc("Replays the messages a module received during a traffic recording, recorded with "
+                                 "the traffic_recorder setting of the module, against a module under test");
+    desc.add_options()("help,h", "produce help message");
+    desc.add_options()("recording", po::value<std::string>(), "Traffic recording to replay");
+    desc.add_options()("host", po::value<std::string>()->default_value("localhost"), "MQTT broker host");
+    desc.add_options()("port", po::value<int>()->default_value(1883), "MQTT broker port");
+    desc.add_options()("socket", po::value<std::string>(), "MQTT broker socket, host and port are ignored if set");
+    desc.add_options()("prefix", po::value<std::string>()->default_value("everest/"),
+                       "Everest MQTT prefix, must match the one of the recording");
+    desc.add_options()("speed", po::value<double>()->default_value(1.0),
+                       "Replay speed relative to the recording, 0 replays the messages as fast as possible");
+    desc.add_options()("wait", po::value<int>()->default_value(1000),
+                       "Milliseconds to wait for the results of the last calls after the replay");
+    desc.add_options()("pid", po::value<int>(), "Process id of the module under test, to report its CPU time");
+    desc.add_options()("json", "Print the report as JSON");
+
+    po::positional_options_description positional;
+    positional.add("recording", 1);
+
+    po::variables_map vm;
+    try {
+        po::store(po::command_line_parser(argc, argv).options(desc).positional(positional).run(), vm);
+        po::notify(vm);
+    } catch (const po::error& e) {
+        std::cerr << e.what() << "\n" << desc << "\n";
+        return 1;
+    }
+    if (vm.count("help") != 0 or vm.count("recording") == 0) {
+        std::cerr << desc << "\n";
+        return vm.count("help") != 0 ? 0 : 1;
+    }
+
+    const auto file = vm["recording"].as<std::string>();
+    const auto speed = vm["speed"].as<double>();
+    const auto prefix = vm["prefix"].as<std::string>();
+
+    // the first pass only collects the topics the module published, which are subscribed to before replaying
+    std::set<std::string> published_topics;
+    std::string module_id;
+    try {
+        std::ifstream stream(file, std::ios::binary);
+        if (not stream) {
+            std::cerr << fmt::format("Could not open {}\n", file);
+            return 1;
+        }
+        Everest::TrafficReader reader(stream);
+        module_id = reader.get_module_id();
+        while (auto record = reader.next()) {
+            if (record->direction == Everest::TrafficDirection::Published) {
+                published_topics.insert(record->topic);
+            }
+        }
+    } catch (const Everest::EverestInternalError& e) {
+        std::cerr << fmt::format("Could not read {}: {}\n", file, e.what());
+        return 1;
+    }
+
+    const auto mqtt_settings =
+        vm.count("socket") != 0
+            ? Everest::create_mqtt_settings(vm["socket"].as<std::string>(), prefix, "external/")
+            : Everest::create_mqtt_settings(vm["host"].as<std::string>(), vm["port"].as<int>(), prefix, "external/");
+    Everest::MQTTAbstraction mqtt(mqtt_settings);
+    if (not mqtt.connect()) {
+        std::cerr << "Could not connect to the MQTT broker\n";
+        return 1;
+    }
+    mqtt.spawn_main_loop_thread();
+
+    CallLatencies latencies;
+    const auto on_published = std::make_shared<RawHandler>([&latencies](std::string_view, std::string_view payload) {
+        Everest::PayloadEnvelope envelope;
+        if (Everest::decode_payload_envelope(std::string(payload), envelope) and envelope.type == "result") {
+            latencies.received(envelope);
+        }
+    });
+    for (const auto& topic : published_topics) {
+        mqtt.register_handler(topic, std::make_shared<TypedHandler>(HandlerType::ExternalMQTT, on_published),
+                              QOS::QOS2);
+    }
+
+    const auto pid = vm.count("pid") != 0 ? std::optional<int>(vm["pid"].as<int>()) : std::nullopt;
+    const auto cpu_before = pid.has_value() ? read_cpu_time(*pid) : std::nullopt;
+
+    std::uint64_t replayed = 0;
+    std::chrono::nanoseconds max_lag{0};
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        std::ifstream stream(file, std::ios::binary);
+        Everest::TrafficReader reader(stream);
+        while (auto record = reader.next()) {
+            if (record->direction != Everest::TrafficDirection::Received) {
+                continue;
+            }
+            if (speed > 0) {
+                const auto due =
+                    start + std::chrono::duration_cast<std::chrono::nanoseconds>(record->offset / speed);
+                std::this_thread::sleep_until(due);
+                max_lag = std::max(max_lag, std::chrono::steady_clock::now() - due);
+            }
+            Everest::PayloadEnvelope envelope;
+            if (Everest::decode_payload_envelope(record->payload, envelope) and envelope.type == "call") {
+                latencies.sent(envelope, record->topic);
+            }
+            mqtt.publish_raw(record->topic, record->payload, QOS::QOS2);
+            replayed++;
+        }
+    } catch (const Everest::EverestInternalError& e) {
+        std::cerr << fmt::format("Stopped replaying {}: {}\n", file, e.what());
+    }
+    const auto replay_duration = std::chrono::steady_clock::now() - start;
+
+    const auto wait_until = std::chrono::steady_clock::now() + std::chrono::milliseconds(vm["wait"].as<int>());
+    while (latencies.get_pending() > 0 and std::chrono::steady_clock::now() < wait_until) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    const auto cpu_after = pid.has_value() ? read_cpu_time(*pid) : std::nullopt;
+    const auto summaries = latencies.get_summaries();
+    const auto unanswered = latencies.get_pending();
+    mqtt.disconnect();
+
+    const auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(replay_duration).count();
+    if (vm.count("json") != 0) {
+        nlohmann::json report = {{"module_id", module_id},
+                                 {"replayed", replayed},
+                                 {"duration_ms", duration_ms},
+                                 {"max_lag_us", std::chrono::duration_cast<std::chrono::microseconds>(max_lag).count()},
+                                 {"unanswered_calls", unanswered},
+                                 {"calls", summaries}};
+        if (cpu_before.has_value() and cpu_after.has_value()) {
+            report["cpu_ms"] = (*cpu_after - *cpu_before).count();
+        }
+        std::cout << report.dump(2) << "\n";
+        return 0;
+    }
+
+    std::cout << fmt::format("Replayed {} messages received by module {} in {}ms, at most {} behind schedule\n",
+                             replayed, module_id, duration_ms, format_us(max_lag));
+    if (cpu_before.has_value() and cpu_after.has_value()) {
+        std::cout << fmt::format("Module under test used {}ms of CPU time\n", (*cpu_after - *cpu_before).count());
+    }
+    for (const auto& [call, summary] : summaries) {
+        std::cout << fmt::format("{}: {} calls, p50 {} p90 {} p99 {} max {}\n", call, summary.count,
+                                 format_us(summary.p50), format_us(summary.p90), format_us(summary.p99),
+                                 format_us(summary.max));
+    }
+    if (unanswered > 0) {
+        std::cout << fmt::format("{} calls were not answered\n", unanswered);
+    }
+    return 0;
+}
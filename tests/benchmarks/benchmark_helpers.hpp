@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#ifndef BENCHMARK_HELPERS_HPP
+#define BENCHMARK_HELPERS_HPP
+
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+
+#include <framework/everest.hpp>
+#include <utils/config.hpp>
+#include <utils/mqtt_abstraction.hpp>
+
+///
+/// Helpers shared by the benchmarks running modules in this process against a local MQTT broker
+///
+
+namespace Everest::benchmark {
+
+inline std::int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/// \brief A mosquitto process running while this object exists, listening on \p port
+class Broker {
+public:
+    explicit Broker(int port) {
+        this->pid = fork();
+        if (this->pid == 0) {
+            const auto port_arg = std::to_string(port);
+            execlp("mosquitto", "mosquitto", "-p", port_arg.c_str(), nullptr);
+            std::cerr << "Could not start mosquitto, is it installed?\n";
+            _exit(1);
+        }
+        // give the broker time to listen
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+
+    pid_t get_pid() const {
+        return this->pid;
+    }
+
+    ~Broker() {
+        if (this->pid > 0) {
+            kill(this->pid, SIGTERM);
+            waitpid(this->pid, nullptr, 0);
+        }
+    }
+
+    Broker(const Broker&) = delete;
+    Broker& operator=(const Broker&) = delete;
+
+private:
+    pid_t pid{-1};
+};
+
+/// \returns the config the manager would send to the given module
+inline nlohmann::json get_module_config(ManagerConfig& manager_config) {
+    nlohmann::json module_config = nlohmann::json::object();
+    module_config["module_config"] = manager_config.get_main_config();
+    module_config["module_names"] = manager_config.get_module_names();
+    module_config["manifests"] = manager_config.get_manifests();
+    module_config["module_provides"] = manager_config.get_interfaces();
+    module_config["interface_definitions"] = manager_config.get_interface_definitions();
+    module_config["types"] = manager_config.get_types();
+    module_config["settings"] = manager_config.get_settings();
+    module_config["schemas"] = manager_config.get_schemas();
+    module_config["error_map"] = manager_config.get_error_types();
+    module_config["module_config_cache"] = manager_config.get_module_config_cache();
+    return module_config;
+}
+
+/// \brief A module instance with its own MQTT connection, sharing the immutable \p config with the other modules
+struct Module {
+    Module(const std::string& module_id, const MQTTSettings& mqtt_settings, std::shared_ptr<const Config> config) :
+        mqtt(std::make_shared<MQTTAbstraction>(mqtt_settings)) {
+        if (not this->mqtt->connect()) {
+            throw std::runtime_error(fmt::format("Module {} could not connect to the MQTT broker", module_id));
+        }
+        this->mqtt->spawn_main_loop_thread();
+        this->everest = std::make_unique<::Everest::Everest>(module_id, std::move(config), false, this->mqtt,
+                                                             "everest/telemetry/", false);
+    }
+
+    ~Module() {
+        this->everest.reset();
+        this->mqtt->disconnect();
+    }
+
+    Module(const Module&) = delete;
+    Module& operator=(const Module&) = delete;
+
+    std::shared_ptr<MQTTAbstraction> mqtt;
+    std::unique_ptr<::Everest::Everest> everest;
+};
+
+} // namespace Everest::benchmark
+
+#endif // BENCHMARK_HELPERS_HPP
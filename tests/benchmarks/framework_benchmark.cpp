@@ -0,0 +1,262 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+
+#include <everest/logging.hpp>
+
+#include <framework/everest.hpp>
+#include <framework/runtime.hpp>
+#include <utils/config.hpp>
+#include <utils/latency_histogram.hpp>
+#include <utils/mqtt_abstraction.hpp>
+
+#include "benchmark_helpers.hpp"
+
+///
+/// Benchmarks of the framework against a local MQTT broker. All modules are instances of the synthetic TESTBenchmark
+/// module running in this process, each with its own MQTT connection, configured like the manager would configure
+/// them. The results are written as json, so they can be compared between releases.
+///
+
+namespace {
+
+using Everest::LatencyHistogram;
+using Everest::benchmark::Broker;
+using Everest::benchmark::Module;
+using Everest::benchmark::now_ns;
+using json = nlohmann::json;
+using steady_clock = std::chrono::steady_clock;
+
+constexpr auto max_subscribers = 8; ///< Number of consumer modules in the benchmark config
+
+struct Options {
+    std::string prefix = EVEREST_BENCHMARK_DIR;
+    std::string broker_host = "localhost";
+    int broker_port = 18830;
+    bool start_broker = true;
+    int iterations = 10000;
+    int subscribers = max_subscribers;
+    int startups = 20;
+    std::string output;
+};
+
+void print_usage(const char* name) {
+    std::cerr << fmt::format("Usage: {} [--prefix DIR] [--broker HOST:PORT] [--iterations N] [--subscribers N] "
+                             "[--startups N] [--output FILE]\n"
+                             "Starts mosquitto on port {} unless --broker is given.\n",
+                             name, Options{}.broker_port);
+}
+
+bool parse_options(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const std::string value = argv[++i];
+        if (arg == "--prefix") {
+            options.prefix = value;
+        } else if (arg == "--broker") {
+            const auto colon = value.rfind(':');
+            if (colon == std::string::npos) {
+                return false;
+            }
+            options.broker_host = value.substr(0, colon);
+            options.broker_port = std::stoi(value.substr(colon + 1));
+            options.start_broker = false;
+        } else if (arg == "--iterations") {
+            options.iterations = std::stoi(value);
+        } else if (arg == "--subscribers") {
+            options.subscribers = std::stoi(value);
+        } else if (arg == "--startups") {
+            options.startups = std::stoi(value);
+        } else if (arg == "--output") {
+            options.output = value;
+        } else {
+            return false;
+        }
+    }
+    return options.iterations > 0 and options.subscribers > 0 and options.subscribers <= max_subscribers and
+           options.startups > 0;
+}
+
+const Requirement peer{"peer", 0};
+
+json bench_call_cmd(Module& consumer, int iterations) {
+    const auto echo = consumer.everest->bind_cmd(peer, "echo");
+    LatencyHistogram histogram;
+    for (int i = 0; i < iterations; i++) {
+        const auto start = steady_clock::now();
+        consumer.everest->call_cmd(*echo, {{"value", {{"index", i}}}});
+        histogram.record(steady_clock::now() - start);
+    }
+    return histogram.get_summary();
+}
+
+/// \brief Receives the values published by the provider in all consumers subscribed so far
+struct VarReceiver {
+    std::mutex mutex;
+    int subscribers{0}; ///< Number of consumers that subscribed so far
+    std::vector<bool> warmed_up = std::vector<bool>(max_subscribers, false);
+    bool measuring{false};
+    int received{0};
+    int expected{0};
+    std::unique_ptr<LatencyHistogram> histogram;
+    std::promise<void> all_received;
+
+    void receive(int subscriber, const json& value) {
+        const std::lock_guard<std::mutex> lock(this->mutex);
+        if (not this->measuring) {
+            this->warmed_up.at(subscriber) = true;
+            return;
+        }
+        this->histogram->record(std::chrono::nanoseconds(now_ns() - value.at("published").get<std::int64_t>()));
+        if (++this->received == this->expected) {
+            this->all_received.set_value();
+        }
+    }
+};
+
+/// \brief Publishes \p iterations values to the first \p subscribers consumers, which record how long each value took
+/// to arrive
+json bench_publish_var(Module& provider, const std::vector<std::unique_ptr<Module>>& consumers,
+                       VarReceiver& receiver, int subscribers, int iterations) {
+    {
+        const std::lock_guard<std::mutex> lock(receiver.mutex);
+        for (; receiver.subscribers < subscribers; receiver.subscribers++) {
+            const auto subscriber = receiver.subscribers;
+            consumers.at(subscriber)->everest->subscribe_var(
+                peer, "value", [&receiver, subscriber](json value) { receiver.receive(subscriber, value); });
+        }
+        receiver.measuring = false;
+        std::fill(receiver.warmed_up.begin(), receiver.warmed_up.end(), false);
+    }
+
+    // subscriptions are set up asynchronously, so warm up until every subscriber received a value
+    const auto warmed_up = [&receiver, subscribers]() {
+        const std::lock_guard<std::mutex> lock(receiver.mutex);
+        return std::all_of(receiver.warmed_up.begin(), receiver.warmed_up.begin() + subscribers,
+                           [](bool warmed_up) { return warmed_up; });
+    };
+    while (not warmed_up()) {
+        provider.everest->publish_var("main", "value", {{"published", now_ns()}});
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    const auto expected = iterations * subscribers;
+    auto all_received = [&receiver, expected]() {
+        const std::lock_guard<std::mutex> lock(receiver.mutex);
+        receiver.measuring = true;
+        receiver.received = 0;
+        receiver.expected = expected;
+        receiver.histogram = std::make_unique<LatencyHistogram>();
+        receiver.all_received = std::promise<void>();
+        return receiver.all_received.get_future();
+    }();
+
+    const auto start = steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        provider.everest->publish_var("main", "value", {{"published", now_ns()}});
+    }
+    const auto published = steady_clock::now();
+    if (all_received.wait_for(std::chrono::seconds(60)) != std::future_status::ready) {
+        const std::lock_guard<std::mutex> lock(receiver.mutex);
+        throw std::runtime_error(fmt::format("Only {} of {} values arrived", receiver.received, expected));
+    }
+    const auto delivered = steady_clock::now();
+
+    const auto per_second = [](int count, steady_clock::duration duration) {
+        return count / std::chrono::duration<double>(duration).count();
+    };
+    const std::lock_guard<std::mutex> lock(receiver.mutex);
+    return {{"subscribers", subscribers},
+            {"values", iterations},
+            {"published_per_s", per_second(iterations, published - start)},
+            {"delivered_per_s", per_second(expected, delivered - start)},
+            {"latency", receiver.histogram->get_summary()}};
+}
+
+/// \brief Measures the time from creating a module until it completed its first cmd call
+json bench_module_startup(const Everest::MQTTSettings& mqtt_settings,
+                          const std::shared_ptr<const Everest::Config>& config, int startups) {
+    LatencyHistogram histogram;
+    for (int i = 0; i < startups; i++) {
+        const auto start = steady_clock::now();
+        Module module("startup", mqtt_settings, config);
+        module.everest->call_cmd(peer, "echo", {{"value", json::object()}});
+        histogram.record(steady_clock::now() - start);
+    }
+    return histogram.get_summary();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (not parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::unique_ptr<Broker> broker;
+    if (options.start_broker) {
+        broker = std::make_unique<Broker>(options.broker_port);
+    }
+
+    try {
+        const auto prefix = options.prefix + "/";
+        Everest::Logging::init(prefix + "benchmark_logging.ini", "benchmark");
+        Everest::ManagerSettings manager_settings(prefix, prefix + "config.yaml");
+        auto mqtt_settings = manager_settings.mqtt_settings;
+        Everest::populate_mqtt_settings(mqtt_settings, options.broker_host, options.broker_port,
+                                        mqtt_settings.everest_prefix, mqtt_settings.external_prefix);
+        Everest::ManagerConfig manager_config(manager_settings);
+        const auto config = std::make_shared<const Everest::Config>(
+            mqtt_settings, Everest::benchmark::get_module_config(manager_config));
+
+        Module provider("provider", mqtt_settings, config);
+        provider.everest->provide_cmd("main", "echo", [](json args) { return args.at("value"); });
+
+        std::vector<std::unique_ptr<Module>> consumers;
+        for (int i = 1; i <= max_subscribers; i++) {
+            consumers.push_back(std::make_unique<Module>(fmt::format("consumer_{}", i), mqtt_settings, config));
+        }
+
+        // the first call waits until the provider subscribed to its cmds
+        consumers.front()->everest->call_cmd(peer, "echo", {{"value", json::object()}});
+
+        json results = json::object();
+        results["call_cmd"] = bench_call_cmd(*consumers.front(), options.iterations);
+        VarReceiver receiver;
+        results["publish_var"] = bench_publish_var(provider, consumers, receiver, 1, options.iterations);
+        results["fan_out"] =
+            bench_publish_var(provider, consumers, receiver, options.subscribers, options.iterations);
+        results["module_startup"] = bench_module_startup(mqtt_settings, config, options.startups);
+
+        const auto output = results.dump(4);
+        if (options.output.empty()) {
+            std::cout << output << "\n";
+        } else {
+            std::ofstream(options.output) << output << "\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Benchmark failed: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,492 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <fmt/core.h>
+#include <nlohmann/json.hpp>
+
+#include <everest/logging.hpp>
+
+#include <framework/everest.hpp>
+#include <framework/runtime.hpp>
+#include <utils/config.hpp>
+#include <utils/error.hpp>
+#include <utils/error/error_factory.hpp>
+#include <utils/error/error_manager_impl.hpp>
+#include <utils/error/error_manager_req.hpp>
+#include <utils/latency_histogram.hpp>
+
+#include "benchmark_helpers.hpp"
+
+///
+/// Soak test reproducing field load: N instances of the synthetic TESTLoadGenerator module act as EVSEs that publish
+/// vars, call the authorize cmd of a central csms instance and raise and clear errors at the configured rates. Like
+/// the framework benchmark, all modules run in this process with their own MQTT connection. Every report interval a
+/// json line with the throughput, latency percentiles, the RSS of the modules and the CPU use of the broker is
+/// written, so memory growth and latency drift over a multi-hour run can be spotted.
+///
+
+namespace {
+
+using Everest::LatencyHistogram;
+using Everest::benchmark::Broker;
+using Everest::benchmark::Module;
+using Everest::benchmark::now_ns;
+using json = nlohmann::json;
+using steady_clock = std::chrono::steady_clock;
+
+constexpr auto overcurrent = "test_load_generator/Overcurrent";
+constexpr auto max_calls_in_flight = 16; ///< Per EVSE, further calls are skipped while the csms lags behind
+
+struct Options {
+    std::string prefix = EVEREST_LOAD_GENERATOR_DIR;
+    std::string broker_host = "localhost";
+    int broker_port = 18831;
+    bool start_broker = true;
+    pid_t broker_pid = -1;
+    int evses = 10;
+    double var_rate = 10.0;       ///< Vars published per second by every EVSE
+    double cmd_rate = 1.0;        ///< Cmds called per second by every EVSE
+    double error_interval = 30.0; ///< Seconds between raising errors, they are cleared after half of it
+    double duration = 600.0;
+    double report_interval = 10.0;
+    std::string output;
+};
+
+void print_usage(const char* name) {
+    std::cerr << fmt::format("Usage: {} [--prefix DIR] [--broker HOST:PORT] [--broker-pid PID] [--evses N] "
+                             "[--var-rate HZ] [--cmd-rate HZ] [--error-interval S] [--duration S] "
+                             "[--report-interval S] [--output FILE]\n"
+                             "Starts mosquitto on port {} unless --broker is given, the CPU use of an external "
+                             "broker is only reported with --broker-pid.\n",
+                             name, Options{}.broker_port);
+}
+
+bool parse_options(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const std::string value = argv[++i];
+        if (arg == "--prefix") {
+            options.prefix = value;
+        } else if (arg == "--broker") {
+            const auto colon = value.rfind(':');
+            if (colon == std::string::npos) {
+                return false;
+            }
+            options.broker_host = value.substr(0, colon);
+            options.broker_port = std::stoi(value.substr(colon + 1));
+            options.start_broker = false;
+        } else if (arg == "--broker-pid") {
+            options.broker_pid = std::stoi(value);
+        } else if (arg == "--evses") {
+            options.evses = std::stoi(value);
+        } else if (arg == "--var-rate") {
+            options.var_rate = std::stod(value);
+        } else if (arg == "--cmd-rate") {
+            options.cmd_rate = std::stod(value);
+        } else if (arg == "--error-interval") {
+            options.error_interval = std::stod(value);
+        } else if (arg == "--duration") {
+            options.duration = std::stod(value);
+        } else if (arg == "--report-interval") {
+            options.report_interval = std::stod(value);
+        } else if (arg == "--output") {
+            options.output = value;
+        } else {
+            return false;
+        }
+    }
+    return options.evses > 0 and options.var_rate >= 0 and options.cmd_rate >= 0 and options.error_interval >= 0 and
+           options.duration > 0 and options.report_interval > 0;
+}
+
+std::atomic<bool> interrupted{false};
+
+/// \brief Counters and latencies of one report interval, recorded lock-free by the EVSEs and the csms
+struct IntervalStats {
+    std::atomic<std::uint64_t> vars_published{0};
+    std::atomic<std::uint64_t> vars_received{0};
+    std::atomic<std::uint64_t> cmds_sent{0};
+    std::atomic<std::uint64_t> cmds_completed{0};
+    std::atomic<std::uint64_t> cmds_failed{0};
+    std::atomic<std::uint64_t> cmds_skipped{0};
+    std::atomic<std::uint64_t> errors_raised{0};
+    std::atomic<std::uint64_t> errors_cleared{0};
+    std::atomic<std::uint64_t> errors_received{0};
+    LatencyHistogram var_latency;
+    LatencyHistogram cmd_latency;
+};
+
+/// \brief Holds the stats of the current interval, which are replaced as a whole when they are reported
+class Recorder {
+public:
+    IntervalStats& get() {
+        // the reporter keeps replaced stats alive for a while, so recording into them stays safe
+        return *std::atomic_load(&this->current);
+    }
+
+    std::shared_ptr<IntervalStats> swap() {
+        return std::atomic_exchange(&this->current, std::make_shared<IntervalStats>());
+    }
+
+private:
+    std::shared_ptr<IntervalStats> current = std::make_shared<IntervalStats>(); ///< Only accessed atomically
+};
+
+/// \brief CPU time and resident memory of a process read from /proc
+struct ProcessSample {
+    double cpu_seconds{0.0};
+    std::uint64_t rss_bytes{0};
+};
+
+std::optional<ProcessSample> sample_process(const std::string& pid) {
+    std::ifstream stat_file(fmt::format("/proc/{}/stat", pid));
+    std::string stat;
+    if (not std::getline(stat_file, stat)) {
+        return std::nullopt;
+    }
+    // the process name may contain spaces, the fields after it are separated by single spaces
+    std::istringstream fields(stat.substr(stat.rfind(')') + 2));
+    std::string field;
+    std::uint64_t utime = 0;
+    std::uint64_t stime = 0;
+    std::uint64_t rss_pages = 0;
+    // the fields start at the state, which is field 3 of proc_pid_stat(5)
+    for (int index = 3; fields >> field; index++) {
+        if (index == 14) {
+            utime = std::stoull(field);
+        } else if (index == 15) {
+            stime = std::stoull(field);
+        } else if (index == 24) {
+            rss_pages = std::stoull(field);
+            break;
+        }
+    }
+    static const auto ticks_per_second = static_cast<double>(sysconf(_SC_CLK_TCK));
+    static const auto page_size = static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE));
+    return ProcessSample{(utime + stime) / ticks_per_second, rss_pages * page_size};
+}
+
+/// \brief Writes a config with the csms and the EVSEs, which are all connected to the csms and the other way round
+std::filesystem::path write_config(const Options& options) {
+    std::string config = "active_modules:\n  csms:\n    module: TESTLoadGenerator\n    connections:\n      evses:\n";
+    for (int i = 1; i <= options.evses; i++) {
+        config += fmt::format("        - module_id: evse_{}\n          implementation_id: main\n", i);
+    }
+    for (int i = 1; i <= options.evses; i++) {
+        config += fmt::format("  evse_{}:\n    module: TESTLoadGenerator\n    connections:\n      peer:\n"
+                              "        - module_id: csms\n          implementation_id: main\n",
+                              i);
+    }
+    config += "settings:\n  validate_schema: false\n  interfaces_dir: \"interfaces\"\n  modules_dir: \"modules\"\n"
+              "  types_dir: \"types\"\n  errors_dir: \"errors\"\n  schemas_dir: \"schemas\"\n  www_dir: \"www\"\n"
+              "  logging_config_file: \"logging.ini\"\n";
+
+    const auto path = std::filesystem::path(options.prefix) / fmt::format("load_generator_{}_config.yaml",
+                                                                          options.evses);
+    std::ofstream(path) << config;
+    return path;
+}
+
+/// \brief Provides the authorize cmd and receives the vars and errors of all EVSEs
+void setup_csms(Module& csms, const Options& options, Recorder& recorder) {
+    csms.everest->provide_cmd("main", "authorize", [](json) { return json{{"authorized", true}}; });
+    for (int i = 0; i < options.evses; i++) {
+        const Requirement evse{"evses", static_cast<std::size_t>(i)};
+        csms.everest->subscribe_var(evse, "power", [&recorder](json value) {
+            auto& stats = recorder.get();
+            stats.vars_received++;
+            stats.var_latency.record(std::chrono::nanoseconds(now_ns() - value.at("published").get<std::int64_t>()));
+        });
+        csms.everest->get_error_manager_req(evse)->subscribe_all_errors(
+            [&recorder](const Everest::error::Error&) { recorder.get().errors_received++; },
+            [&recorder](const Everest::error::Error&) { recorder.get().errors_received++; });
+    }
+}
+
+/// \brief Calls repeatedly \p action with the given \p rate, starting at \p offset of its period
+class Schedule {
+public:
+    Schedule(double rate, double offset, steady_clock::time_point start) :
+        period(rate > 0 ? std::chrono::duration_cast<steady_clock::duration>(std::chrono::duration<double>(1 / rate))
+                        : steady_clock::duration::max()),
+        next(rate > 0 ? start + std::chrono::duration_cast<steady_clock::duration>(period * offset)
+                      : steady_clock::time_point::max()) {
+    }
+
+    /// \returns true if the action is due at \p now and schedules the next one
+    bool due(steady_clock::time_point now) {
+        if (now < this->next) {
+            return false;
+        }
+        this->next += this->period;
+        return true;
+    }
+
+    steady_clock::time_point get_next() const {
+        return this->next;
+    }
+
+private:
+    steady_clock::duration period;
+    steady_clock::time_point next;
+};
+
+/// \brief Simulates the EVSE \p index until \p running is reset, the EVSEs are staggered to spread their load
+void run_evse(Module& evse, int index, const Options& options, Recorder& recorder, const std::atomic<bool>& running) {
+    const Requirement peer{"peer", 0};
+    const auto error_factory = evse.everest->get_error_factory("main");
+    const auto error_manager = evse.everest->get_error_manager_impl("main");
+    auto in_flight = std::make_shared<std::atomic<int>>(0);
+
+    const auto start = steady_clock::now();
+    const auto offset = static_cast<double>(index) / options.evses;
+    Schedule vars(options.var_rate, offset, start);
+    Schedule cmds(options.cmd_rate, offset, start);
+    Schedule errors(options.error_interval > 0 ? 2 / options.error_interval : 0, offset, start);
+    bool error_raised = false;
+    std::uint64_t sequence = 0;
+
+    while (running) {
+        const auto now = steady_clock::now();
+        if (vars.due(now)) {
+            evse.everest->publish_var("main", "power",
+                                      {{"published", now_ns()}, {"current", 16.0 + sequence % 16}, {"voltage", 230.0}});
+            recorder.get().vars_published++;
+        }
+        if (cmds.due(now)) {
+            if (in_flight->load() >= max_calls_in_flight) {
+                recorder.get().cmds_skipped++;
+            } else {
+                (*in_flight)++;
+                recorder.get().cmds_sent++;
+                const auto sent = steady_clock::now();
+                evse.everest->call_cmd_async(peer, "authorize", {{"token", fmt::format("token_{}", sequence)}},
+                                             [&recorder, in_flight, sent](std::future<json> result) {
+                                                 auto& stats = recorder.get();
+                                                 try {
+                                                     result.get();
+                                                     stats.cmd_latency.record(steady_clock::now() - sent);
+                                                     stats.cmds_completed++;
+                                                 } catch (const std::exception&) {
+                                                     stats.cmds_failed++;
+                                                 }
+                                                 (*in_flight)--;
+                                             });
+            }
+        }
+        if (errors.due(now)) {
+            if (error_raised) {
+                error_manager->clear_error(overcurrent);
+                recorder.get().errors_cleared++;
+            } else {
+                error_manager->raise_error(error_factory->create_error(overcurrent, "", "Simulated overcurrent"));
+                recorder.get().errors_raised++;
+            }
+            error_raised = not error_raised;
+            evse.everest->publish_var("main", "state", error_raised ? "Faulted" : "Charging");
+        }
+        sequence++;
+
+        const auto next = std::min({vars.get_next(), cmds.get_next(), errors.get_next()});
+        // wake up regularly to notice the end of the run
+        std::this_thread::sleep_until(std::min(next, steady_clock::now() + std::chrono::milliseconds(100)));
+    }
+
+    // calls still in flight record into the recorder, which outlives the EVSEs
+    for (int i = 0; i < 100 and in_flight->load() > 0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+/// \brief Turns the stats of one interval into a report line
+json make_report(const IntervalStats& stats, double elapsed, double interval, const ProcessSample& modules,
+                 double modules_cpu, std::optional<double> broker_cpu, int module_count) {
+    const auto per_second = [interval](std::uint64_t count) { return count / interval; };
+    json report = {
+        {"elapsed_s", elapsed},
+        {"interval_s", interval},
+        {"vars",
+         {{"published", stats.vars_published.load()},
+          {"received", stats.vars_received.load()},
+          {"published_per_s", per_second(stats.vars_published)},
+          {"received_per_s", per_second(stats.vars_received)},
+          {"latency", stats.var_latency.get_summary()}}},
+        {"cmds",
+         {{"sent", stats.cmds_sent.load()},
+          {"completed", stats.cmds_completed.load()},
+          {"failed", stats.cmds_failed.load()},
+          {"skipped", stats.cmds_skipped.load()},
+          {"completed_per_s", per_second(stats.cmds_completed)},
+          {"latency", stats.cmd_latency.get_summary()}}},
+        {"errors",
+         {{"raised", stats.errors_raised.load()},
+          {"cleared", stats.errors_cleared.load()},
+          {"received", stats.errors_received.load()}}},
+        {"rss_bytes", modules.rss_bytes},
+        {"rss_per_module_bytes", modules.rss_bytes / module_count},
+        {"modules_cpu_percent", modules_cpu},
+        {"broker_cpu_percent", nullptr},
+    };
+    if (broker_cpu.has_value()) {
+        report["broker_cpu_percent"] = broker_cpu.value();
+    }
+    return report;
+}
+
+/// \brief Compares the first and the last report, growth of the RSS and the latencies over a long run indicates a leak
+/// or a slow down
+json make_summary(const json& first, const json& last) {
+    const auto drift = [&first, &last](const char* kind) {
+        return json{{"first_p99_ns", first.at(kind).at("latency").at("p99")},
+                    {"last_p99_ns", last.at(kind).at("latency").at("p99")}};
+    };
+    return {{"duration_s", last.at("elapsed_s")},
+            {"rss_first_bytes", first.at("rss_bytes")},
+            {"rss_last_bytes", last.at("rss_bytes")},
+            {"rss_growth_bytes",
+             last.at("rss_bytes").get<std::int64_t>() - first.at("rss_bytes").get<std::int64_t>()},
+            {"var_latency", drift("vars")},
+            {"cmd_latency", drift("cmds")}};
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (not parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::unique_ptr<Broker> broker;
+    if (options.start_broker) {
+        broker = std::make_unique<Broker>(options.broker_port);
+        options.broker_pid = broker->get_pid();
+    }
+    std::signal(SIGINT, [](int) { interrupted = true; });
+    std::signal(SIGTERM, [](int) { interrupted = true; });
+
+    try {
+        const auto prefix = options.prefix + "/";
+        Everest::Logging::init(prefix + "benchmark_logging.ini", "load_generator");
+        const auto config_path = write_config(options);
+        Everest::ManagerSettings manager_settings(prefix, config_path.string());
+        auto mqtt_settings = manager_settings.mqtt_settings;
+        Everest::populate_mqtt_settings(mqtt_settings, options.broker_host, options.broker_port,
+                                        mqtt_settings.everest_prefix, mqtt_settings.external_prefix);
+        Everest::ManagerConfig manager_config(manager_settings);
+        const auto config = std::make_shared<const Everest::Config>(
+            mqtt_settings, Everest::benchmark::get_module_config(manager_config));
+
+        Recorder recorder;
+        Module csms("csms", mqtt_settings, config);
+        setup_csms(csms, options, recorder);
+
+        std::vector<std::unique_ptr<Module>> evses;
+        for (int i = 1; i <= options.evses; i++) {
+            evses.push_back(std::make_unique<Module>(fmt::format("evse_{}", i), mqtt_settings, config));
+            // the first call waits until the csms subscribed to its cmds
+            evses.back()->everest->call_cmd({"peer", 0}, "authorize", {{"token", "warm_up"}});
+        }
+        // the subscriptions of the csms are set up asynchronously
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        recorder.swap();
+
+        std::ofstream output;
+        if (not options.output.empty()) {
+            output.open(options.output);
+        }
+        const auto write_line = [&options, &output](const json& line) {
+            if (options.output.empty()) {
+                std::cout << line.dump() << std::endl;
+            } else {
+                output << line.dump() << std::endl;
+            }
+        };
+
+        std::atomic<bool> running{true};
+        std::vector<std::thread> threads;
+        for (int i = 0; i < options.evses; i++) {
+            threads.emplace_back(run_evse, std::ref(*evses.at(i)), i, std::cref(options), std::ref(recorder),
+                                 std::cref(running));
+        }
+
+        const auto start = steady_clock::now();
+        const auto end = start + std::chrono::duration_cast<steady_clock::duration>(
+                                     std::chrono::duration<double>(options.duration));
+        const auto interval = std::chrono::duration_cast<steady_clock::duration>(
+            std::chrono::duration<double>(options.report_interval));
+        const auto broker_pid = std::to_string(options.broker_pid);
+
+        auto last_report = start;
+        auto last_modules = sample_process("self").value_or(ProcessSample{});
+        auto last_broker = sample_process(broker_pid);
+        std::shared_ptr<IntervalStats> retired; ///< Kept until the next report for callbacks still recording into it
+        json first_report;
+        json last_line;
+        while (not interrupted and steady_clock::now() < end) {
+            const auto next_report = std::min(last_report + interval, end);
+            while (not interrupted and steady_clock::now() < next_report) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+
+            const auto now = steady_clock::now();
+            auto stats = recorder.swap();
+            const auto seconds = std::chrono::duration<double>(now - last_report).count();
+            const auto modules = sample_process("self").value_or(ProcessSample{});
+            const auto broker_sample = sample_process(broker_pid);
+            std::optional<double> broker_cpu;
+            if (broker_sample.has_value() and last_broker.has_value()) {
+                broker_cpu = 100 * (broker_sample->cpu_seconds - last_broker->cpu_seconds) / seconds;
+            }
+
+            last_line = make_report(*stats, std::chrono::duration<double>(now - start).count(), seconds, modules,
+                                    100 * (modules.cpu_seconds - last_modules.cpu_seconds) / seconds, broker_cpu,
+                                    options.evses + 1);
+            write_line(last_line);
+            if (first_report.is_null()) {
+                first_report = last_line;
+            }
+
+            retired = std::move(stats);
+            last_report = now;
+            last_modules = modules;
+            last_broker = broker_sample;
+        }
+
+        running = false;
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        if (not last_line.is_null()) {
+            write_line({{"summary", make_summary(first_report, last_line)}});
+        }
+        evses.clear();
+        std::filesystem::remove(config_path);
+    } catch (const std::exception& e) {
+        std::cerr << "Load generator failed: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,413 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fmt/core.h>
+#include <nlohmann/json-schema.hpp>
+#include <nlohmann/json.hpp>
+
+#include <everest/logging.hpp>
+
+#include <framework/runtime.hpp>
+#include <utils/config.hpp>
+#include <utils/error/error_database_map.hpp>
+#include <utils/error/error_filter.hpp>
+#include <utils/executor.hpp>
+#include <utils/message_queue.hpp>
+#include <utils/mqtt_abstraction_impl.hpp>
+#include <utils/types.hpp>
+#include <utils/yaml_loader.hpp>
+
+///
+/// Microbenchmarks of the hot primitives of the framework. Every benchmark repeats its operation until the minimum
+/// time has passed and reports the time per operation as json, so the results can be compared between changes.
+///
+
+#ifndef EVEREST_BENCHMARK_DIR
+#define EVEREST_BENCHMARK_DIR "."
+#endif
+
+#ifndef EVEREST_TEST_INTERFACES_DIR
+#define EVEREST_TEST_INTERFACES_DIR "tests/test_interfaces"
+#endif
+
+namespace {
+
+namespace fs = std::filesystem;
+using json = nlohmann::json;
+using json_validator = nlohmann::json_schema::json_validator;
+using steady_clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string prefix = EVEREST_BENCHMARK_DIR;
+    std::string interfaces_dir = EVEREST_TEST_INTERFACES_DIR;
+    std::chrono::milliseconds min_time{200};
+    std::string filter;
+    bool list{false};
+    std::string output;
+};
+
+void print_usage(const char* name) {
+    std::cerr << fmt::format("Usage: {} [--prefix DIR] [--interfaces DIR] [--min-time MS] [--filter SUBSTRING] "
+                             "[--list] [--output FILE]\n",
+                             name);
+}
+
+bool parse_options(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--list") {
+            options.list = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const std::string value = argv[++i];
+        if (arg == "--prefix") {
+            options.prefix = value;
+        } else if (arg == "--interfaces") {
+            options.interfaces_dir = value;
+        } else if (arg == "--min-time") {
+            options.min_time = std::chrono::milliseconds(std::stoi(value));
+        } else if (arg == "--filter") {
+            options.filter = value;
+        } else if (arg == "--output") {
+            options.output = value;
+        } else {
+            return false;
+        }
+    }
+    return options.min_time.count() > 0;
+}
+
+/// \brief Keeps the compiler from optimizing away the computation of \p value
+template <typename T> void keep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+///
+/// \brief Calls \p operation, which performs \p ops_per_call operations, in growing batches until the minimum time
+/// has passed
+/// \returns the number of operations and the time per operation
+///
+template <typename Operation>
+json measure(const Options& options, Operation&& operation, std::size_t ops_per_call = 1) {
+    // the first call warms up caches and lazily initialized state
+    operation();
+
+    std::size_t calls = 0;
+    std::size_t batch = 1;
+    steady_clock::duration elapsed{};
+    while (elapsed < options.min_time) {
+        const auto start = steady_clock::now();
+        for (std::size_t i = 0; i < batch; i++) {
+            operation();
+        }
+        elapsed += steady_clock::now() - start;
+        calls += batch;
+        batch = std::min<std::size_t>(batch * 2, 1 << 16);
+    }
+
+    const auto operations = calls * ops_per_call;
+    const auto seconds = std::chrono::duration<double>(elapsed).count();
+    return {{"operations", operations},
+            {"ns_per_op", seconds * 1e9 / operations},
+            {"ops_per_s", operations / seconds}};
+}
+
+json bench_topic_matches(const Options& options) {
+    const std::vector<std::pair<std::string, std::string>> topics = {
+        {"everest/evse_manager/evse/var", "everest/evse_manager/evse/var"},
+        {"everest/evse_manager/evse/var", "everest/+/evse/var"},
+        {"everest/evse_manager/evse/var", "everest/evse_manager/#"},
+        {"everest/evse_manager/evse/cmd", "everest/+/+/var"},
+        {"everest/modules/auth/impl/main/cmd", "everest/modules/+/impl/+/cmd"},
+        {"everest/modules/auth/impl/main/cmd", "everest/telemetry/#"},
+    };
+    return measure(
+        options,
+        [&topics]() {
+            for (const auto& [topic, wildcard] : topics) {
+                const auto matches = Everest::MQTTAbstractionImpl::check_topic_matches(topic, wildcard);
+                keep(matches);
+            }
+        },
+        topics.size());
+}
+
+/// \brief Spins until \p counter reached \p target, the benchmarked queues deliver on their own threads
+void wait_for(const std::atomic<std::size_t>& counter, std::size_t target) {
+    while (counter.load(std::memory_order_acquire) < target) {
+        std::this_thread::yield();
+    }
+}
+
+constexpr std::size_t dispatch_batch = 1000; ///< Messages added per measured call of the dispatch benchmarks
+
+json bench_message_queue(const Options& options) {
+    Everest::MessagePool pool(dispatch_batch, 1024);
+    std::atomic<std::size_t> delivered{0};
+    Everest::MessageQueue queue(
+        [&delivered](const Everest::Message& message) {
+            keep(message);
+            delivered.fetch_add(1, std::memory_order_release);
+        });
+
+    const std::string topic = "everest/evse_manager/evse/var";
+    const std::string payload = R"({"name":"power","data":{"current":16.0,"voltage":230.0}})";
+    std::size_t added = 0;
+    return measure(
+        options,
+        [&]() {
+            for (std::size_t i = 0; i < dispatch_batch; i++) {
+                queue.add(pool.acquire(topic.data(), topic.size(), payload.data(), payload.size()));
+            }
+            added += dispatch_batch;
+            wait_for(delivered, added);
+        },
+        dispatch_batch);
+}
+
+json bench_message_handler(const Options& options) {
+    constexpr auto vars = 16;
+    Everest::Executor executor(1, 1);
+    auto handler = std::make_shared<Everest::MessageHandler>(executor);
+    std::atomic<std::size_t> delivered{0};
+    for (int i = 0; i < vars; i++) {
+        handler->add_handler(std::make_shared<TypedHandler>(
+            fmt::format("var_{}", i), HandlerType::SubscribeVar,
+            std::make_shared<Handler>([&delivered](const std::string&, json data) {
+                keep(data);
+                delivered.fetch_add(1, std::memory_order_release);
+            })));
+    }
+
+    std::vector<json> messages;
+    for (std::size_t i = 0; i < dispatch_batch; i++) {
+        messages.push_back({{"name", fmt::format("var_{}", i % vars)}, {"data", {{"current", 16.0}}}});
+    }
+    std::size_t added = 0;
+    auto result = measure(
+        options,
+        [&]() {
+            for (const auto& message : messages) {
+                handler->add(std::make_shared<Everest::ParsedMessage>(
+                    Everest::ParsedMessage{"everest/evse_manager/evse/var", message}));
+            }
+            added += dispatch_batch;
+            wait_for(delivered, added);
+        },
+        dispatch_batch);
+    handler->stop();
+    return result;
+}
+
+/// \brief The var and cmd argument schemas of the test interfaces together with a value matching each of them
+std::vector<std::pair<json, json>> get_interface_schemas(const Options& options) {
+    const auto validators = Everest::load_yaml(fs::path(options.interfaces_dir) / "test_interface_validators.yaml");
+    auto limits = json(validators.at("vars").at("limits"));
+    // type refs need the type definitions of a module config, which are not part of this benchmark
+    limits.at("properties").erase("object");
+    const auto benchmark = Everest::load_yaml(fs::path(options.interfaces_dir) / "test_interface_benchmark.yaml");
+
+    return {
+        {limits, {{"current", 16.5}, {"phases", 3}, {"label", "AC"}, {"tags", {"fast", "eco"}}}},
+        {json(validators.at("vars").at("choice")), 42},
+        {json(benchmark.at("cmds").at("echo").at("arguments").at("value")), {{"index", 1}}},
+    };
+}
+
+json bench_json_validator(const Options& options) {
+    const auto schemas = get_interface_schemas(options);
+    json results = json::object();
+    results["construct_validate"] = measure(
+        options,
+        [&schemas]() {
+            for (const auto& [schema, value] : schemas) {
+                json_validator validator(Everest::Config::loader, Everest::Config::format_checker);
+                validator.set_root_schema(schema);
+                validator.validate(value);
+            }
+        },
+        schemas.size());
+
+    std::vector<std::unique_ptr<json_validator>> validators;
+    for (const auto& [schema, value] : schemas) {
+        validators.push_back(
+            std::make_unique<json_validator>(Everest::Config::loader, Everest::Config::format_checker));
+        validators.back()->set_root_schema(schema);
+    }
+    results["validate"] = measure(
+        options,
+        [&schemas, &validators]() {
+            for (std::size_t i = 0; i < schemas.size(); i++) {
+                validators.at(i)->validate(schemas.at(i).second);
+            }
+        },
+        schemas.size());
+
+    // the manager validates every interface definition against the interface schema
+    const auto interface_schema = json(Everest::load_yaml(fs::path(options.prefix) / "schemas" / "interface.yaml"));
+    std::vector<json> interfaces;
+    for (const auto& entry : fs::directory_iterator(options.interfaces_dir)) {
+        interfaces.push_back(json(Everest::load_yaml(entry.path())));
+    }
+    results["interface_definitions"] = measure(
+        options,
+        [&interface_schema, &interfaces]() {
+            json_validator validator(Everest::Config::loader, Everest::Config::format_checker);
+            validator.set_root_schema(interface_schema);
+            for (const auto& interface : interfaces) {
+                validator.validate(interface);
+            }
+        },
+        interfaces.size());
+    return results;
+}
+
+json bench_load_yaml(const Options& options) {
+    json results = json::object();
+    for (const auto& entry : fs::directory_iterator(fs::path(options.prefix) / "schemas")) {
+        if (entry.path().extension() != ".yaml") {
+            continue;
+        }
+        const auto path = entry.path();
+        results[path.filename().string()] = measure(options, [&path]() {
+            const auto loaded = Everest::load_yaml(path);
+            keep(loaded);
+        });
+    }
+    return results;
+}
+
+/// \brief Writes a config with \p modules instances of TESTBenchmark all connected to the first one
+fs::path write_synthetic_config(const Options& options, int modules) {
+    std::string config = "active_modules:\n  module_0:\n    module: TESTBenchmark\n";
+    for (int i = 1; i < modules; i++) {
+        config += fmt::format("  module_{}:\n    module: TESTBenchmark\n    connections:\n      peer:\n"
+                              "        - module_id: module_0\n          implementation_id: main\n",
+                              i);
+    }
+    config += "settings:\n  validate_schema: false\n  interfaces_dir: \"interfaces\"\n  modules_dir: \"modules\"\n"
+              "  types_dir: \"types\"\n  errors_dir: \"errors\"\n  schemas_dir: \"schemas\"\n  www_dir: \"www\"\n"
+              "  logging_config_file: \"logging.ini\"\n";
+
+    const auto path = fs::path(options.prefix) / fmt::format("synthetic_{}_config.yaml", modules);
+    std::ofstream(path) << config;
+    return path;
+}
+
+json bench_manager_config(const Options& options) {
+    json results = json::object();
+    for (const auto modules : {10, 100, 1000}) {
+        const auto path = write_synthetic_config(options, modules);
+        const Everest::ManagerSettings settings(options.prefix + "/", path.string());
+        results[std::to_string(modules)] = measure(options, [&settings]() {
+            const Everest::ManagerConfig config(settings);
+            keep(config);
+        });
+        fs::remove(path);
+    }
+    return results;
+}
+
+json bench_error_database(const Options& options) {
+    using namespace Everest::error;
+    constexpr auto types = 16;
+
+    json results = json::object();
+    for (const auto active : {10, 100, 1000}) {
+        ErrorDatabaseMap database;
+        for (int i = 0; i < active; i++) {
+            database.add_error(std::make_shared<Error>(fmt::format("evse/Error_{}", i % types), std::to_string(i),
+                                                       "message", "description", fmt::format("evse_{}", i % 8),
+                                                       "main", i % 4 == 0 ? Severity::High : Severity::Low));
+        }
+
+        const std::list<ErrorFilter> by_type = {ErrorFilter(TypeFilter("evse/Error_3"))};
+        const std::list<ErrorFilter> by_severity = {ErrorFilter(SeverityFilter::HIGH_GE)};
+        results[std::to_string(active)] = {
+            {"all", measure(options,
+                            [&database]() {
+                                const auto errors = database.get_errors({});
+                                keep(errors);
+                            })},
+            {"by_type", measure(options,
+                                [&database, &by_type]() {
+                                    const auto errors = database.get_errors(by_type);
+                                    keep(errors);
+                                })},
+            {"by_severity", measure(options,
+                                    [&database, &by_severity]() {
+                                        const auto errors = database.get_errors(by_severity);
+                                        keep(errors);
+                                    })},
+        };
+    }
+    return results;
+}
+
+const std::vector<std::pair<std::string, std::function<json(const Options&)>>> benchmarks = {
+    {"check_topic_matches", bench_topic_matches},
+    {"message_queue_dispatch", bench_message_queue},
+    {"message_handler_dispatch", bench_message_handler},
+    {"json_validator", bench_json_validator},
+    {"load_yaml", bench_load_yaml},
+    {"manager_config", bench_manager_config},
+    {"error_database_get_errors", bench_error_database},
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (not parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (options.list) {
+        for (const auto& [name, benchmark] : benchmarks) {
+            std::cout << name << "\n";
+        }
+        return 0;
+    }
+
+    try {
+        Everest::Logging::init(options.prefix + "/benchmark_logging.ini", "microbenchmarks");
+
+        json results = json::object();
+        for (const auto& [name, benchmark] : benchmarks) {
+            if (name.find(options.filter) == std::string::npos) {
+                continue;
+            }
+            std::cerr << "Running " << name << "\n";
+            results[name] = benchmark(options);
+        }
+
+        const auto output = results.dump(4);
+        if (options.output.empty()) {
+            std::cout << output << "\n";
+        } else {
+            std::ofstream(options.output) << output << "\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Benchmark failed: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
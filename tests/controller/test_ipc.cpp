@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <string>
+#include <thread>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <catch2/catch_all.hpp>
+#include <nlohmann/json.hpp>
+
+#include "ipc.hpp"
+
+using json = nlohmann::json;
+using Everest::controller_ipc::Channel;
+using Everest::controller_ipc::Encoding;
+using Everest::controller_ipc::MESSAGE_RETURN_STATUS;
+
+namespace {
+struct SocketPair {
+    SocketPair() {
+        REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    }
+    ~SocketPair() {
+        close(fds[0]);
+        close(fds[1]);
+    }
+    int fds[2];
+};
+} // namespace
+
+SCENARIO("Messages are framed on a stream socket", "[controller_ipc]") {
+    SocketPair sockets;
+    Channel sender(sockets.fds[0]);
+    Channel receiver(sockets.fds[1]);
+    receiver.set_read_timeout(1000);
+
+    GIVEN("Queued messages") {
+        sender.queue_message({{"method", "first"}});
+        sender.set_encoding(Encoding::MessagePack);
+        sender.queue_message({{"method", "second"}, {"id", 7}});
+        sender.flush();
+
+        THEN("They are received in order with their encoding") {
+            const auto first = receiver.receive_message();
+            REQUIRE(first.status == MESSAGE_RETURN_STATUS::OK);
+            CHECK(first.json.at("method") == "first");
+            CHECK(receiver.has_buffered_message());
+
+            const auto second = receiver.receive_message();
+            REQUIRE(second.status == MESSAGE_RETURN_STATUS::OK);
+            CHECK(second.json.at("id") == 7);
+            CHECK_FALSE(receiver.has_buffered_message());
+        }
+    }
+
+    GIVEN("A message larger than the socket buffer") {
+        const json msg = {{"config", std::string(4 * 1024 * 1024, 'x')}};
+        std::thread writer([&sender, &msg]() { sender.send_message(msg); });
+
+        THEN("It is received completely") {
+            const auto received = receiver.receive_message();
+            writer.join();
+            REQUIRE(received.status == MESSAGE_RETURN_STATUS::OK);
+            CHECK(received.json == msg);
+        }
+    }
+
+    GIVEN("No message") {
+        receiver.set_read_timeout(10);
+
+        THEN("Receiving times out") {
+            CHECK(receiver.receive_message().status == MESSAGE_RETURN_STATUS::TIMEOUT);
+        }
+    }
+}
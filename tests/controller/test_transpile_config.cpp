@@ -1,5 +1,6 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright 2020 - 2024 Pionix GmbH and Contributors to EVerest
+#include <chrono>
 #include <sstream>
 #include <string>
 
@@ -12,6 +13,10 @@
 
 using json = nlohmann::json;
 
+static std::string module_id(std::size_t index) {
+    return "module_" + std::to_string(index);
+}
+
 const std::string json_strings = R"(
     "string": {
         "complex name": "it is",
@@ -184,3 +189,76 @@ SCENARIO("Check config transpiler", "[!throws]") {
         }
     }
 }
+
+static json make_large_config(std::size_t module_count) {
+    json config = {{"settings", {{"telemetry_enabled", true}, {"controller_port", 8849}}}};
+    for (std::size_t i = 0; i < module_count; i++) {
+        config["active_modules"][module_id(i)] = {
+            {"module", "Example"},
+            {"config_module", {{"power_limit", 11000.5}, {"phase_count", 3}, {"name", "evse " + std::to_string(i)}}},
+            {"connections", {{"board", {{{"module_id", "board"}, {"implementation_id", "main"}}}}}},
+        };
+    }
+    return config;
+}
+
+SCENARIO("Check incremental config transpiler", "[!throws]") {
+    ConfigTranspiler transpiler;
+    auto config = make_large_config(20);
+    const auto full_yaml = [](const json& config_json) {
+        return ryml::emitrs<std::string>(transpile_config(config_json));
+    };
+
+    GIVEN("A config transpiled before") {
+        REQUIRE(transpiler.transpile(config) == full_yaml(config));
+
+        THEN("An unchanged config gives the same yaml") {
+            CHECK(transpiler.transpile(config) == full_yaml(config));
+        }
+        THEN("A changed module is transpiled again") {
+            config["active_modules"][module_id(3)]["config_module"]["phase_count"] = 1;
+            CHECK(transpiler.transpile(config) == full_yaml(config));
+        }
+        THEN("Added and removed modules are reflected") {
+            config["active_modules"].erase(module_id(0));
+            config["active_modules"]["a_new_module"] = {{"module", "Other"}};
+            CHECK(transpiler.transpile(config) == full_yaml(config));
+        }
+        THEN("A section changing its type is transpiled again") {
+            config["settings"] = nullptr;
+            CHECK(transpiler.transpile(config) == full_yaml(config));
+            config["settings"] = {{"telemetry_enabled", false}};
+            CHECK(transpiler.transpile(config) == full_yaml(config));
+        }
+    }
+}
+
+TEST_CASE("Config transpiler benchmark", "[.][transpile_config_benchmark]") {
+    ConfigTranspiler transpiler;
+    auto config = make_large_config(500);
+    constexpr auto rounds = 20;
+
+    const auto time_per_round = [&config](auto&& transpile) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++) {
+            // every save in the admin panel edits one module
+            config["active_modules"][module_id(i)]["config_module"]["phase_count"] = i;
+            transpile(config);
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / rounds * 1000;
+    };
+
+    const auto full_ms =
+        time_per_round([](const json& config_json) { ryml::emitrs<std::string>(transpile_config(config_json)); });
+    transpiler.transpile(config);
+    const auto incremental_ms =
+        time_per_round([&transpiler](const json& config_json) { transpiler.transpile(config_json); });
+
+    const auto unchanged_start = std::chrono::steady_clock::now();
+    transpiler.transpile(config);
+    const auto unchanged_ms =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - unchanged_start).count() * 1000;
+
+    WARN("500 modules: full " << full_ms << " ms, incremental " << incremental_ms << " ms, unchanged " << unchanged_ms
+                              << " ms per save");
+}
@@ -0,0 +1,267 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_all.hpp>
+
+#include <utils/cmd_call.hpp>
+#include <utils/message_queue.hpp>
+
+using Everest::AsyncCmdCall;
+using Everest::CMD_STREAM_WINDOW;
+using Everest::CmdCallContext;
+using Everest::CmdChunkStream;
+using Everest::CmdResultCache;
+using nlohmann::json;
+
+static json chunk_message(std::uint64_t seq, json retval) {
+    return {{"id", "call-1"}, {"retval", std::move(retval)}, {"seq", seq}, {"done", false}};
+}
+
+static json done_message(std::uint64_t seq) {
+    return {{"id", "call-1"}, {"retval", nullptr}, {"seq", seq}, {"done", true}};
+}
+
+SCENARIO("Check streamed cmd results", "[cmd_call]") {
+    GIVEN("A chunk stream") {
+        CmdChunkStream stream;
+        json chunk;
+
+        THEN("Chunks should be handed over in order until the final message") {
+            stream.push(chunk_message(0, "a"));
+            stream.push(chunk_message(1, "b"));
+            stream.push(done_message(2));
+            CHECK(stream.next(std::chrono::seconds(1), chunk) == CmdChunkStream::Event::Chunk);
+            CHECK(chunk == "a");
+            CHECK(stream.next(std::chrono::seconds(1), chunk) == CmdChunkStream::Event::Chunk);
+            CHECK(chunk == "b");
+            CHECK(stream.next(std::chrono::seconds(1), chunk) == CmdChunkStream::Event::Done);
+        }
+
+        THEN("A missing chunk should be detected") {
+            stream.push(chunk_message(1, "b"));
+            CHECK(stream.next(std::chrono::seconds(1), chunk) == CmdChunkStream::Event::Lost);
+        }
+
+        THEN("Waiting for a chunk should time out") {
+            CHECK(stream.next(std::chrono::milliseconds(10), chunk) == CmdChunkStream::Event::Timeout);
+        }
+
+        THEN("More chunks than the window allows should not be held") {
+            for (std::uint64_t seq = 0; seq <= CMD_STREAM_WINDOW + 1; seq++) {
+                stream.push(chunk_message(seq, seq));
+            }
+            CHECK(stream.next(std::chrono::seconds(1), chunk) == CmdChunkStream::Event::Overrun);
+        }
+
+        THEN("Consumed chunks should be acknowledged every half window") {
+            for (std::uint64_t seq = 0; seq < CMD_STREAM_WINDOW; seq++) {
+                stream.push(chunk_message(seq, seq));
+            }
+            std::vector<std::uint64_t> acknowledgements;
+            for (std::uint64_t seq = 0; seq < CMD_STREAM_WINDOW; seq++) {
+                REQUIRE(stream.next(std::chrono::seconds(1), chunk) == CmdChunkStream::Event::Chunk);
+                CHECK(chunk == seq);
+                const auto consumed = stream.take_acknowledgement();
+                if (consumed.has_value()) {
+                    acknowledgements.push_back(*consumed);
+                }
+            }
+            CHECK(acknowledgements == std::vector<std::uint64_t>{CMD_STREAM_WINDOW / 2, CMD_STREAM_WINDOW});
+        }
+    }
+}
+
+SCENARIO("Check the window of streamed cmd results", "[cmd_call]") {
+    GIVEN("The context of a streaming call without a deadline") {
+        CmdCallContext context(std::nullopt);
+
+        THEN("Chunks within the window should be sent right away") {
+            CHECK(context.wait_for_window(CMD_STREAM_WINDOW - 1, std::chrono::milliseconds(10)));
+        }
+
+        THEN("The provider should wait for the caller to acknowledge consumed chunks") {
+            auto waiting = std::async(std::launch::async, [&context]() {
+                return context.wait_for_window(CMD_STREAM_WINDOW, std::chrono::seconds(10));
+            });
+            CHECK(waiting.wait_for(std::chrono::milliseconds(20)) == std::future_status::timeout);
+            context.acknowledge(1);
+            CHECK(waiting.get());
+            CHECK(not context.is_cancelled());
+        }
+
+        THEN("A caller not consuming any chunk should cancel the call") {
+            CHECK(not context.wait_for_window(CMD_STREAM_WINDOW, std::chrono::milliseconds(10)));
+            CHECK(context.is_cancelled());
+        }
+
+        THEN("Cancelling the call should stop a provider waiting for the window") {
+            auto waiting = std::async(std::launch::async, [&context]() {
+                return context.wait_for_window(CMD_STREAM_WINDOW, std::chrono::seconds(10));
+            });
+            context.cancel();
+            CHECK(not waiting.get());
+            CHECK(context.is_abandoned());
+        }
+    }
+}
+
+SCENARIO("Check cancelling running cmd calls", "[cmd_call]") {
+    GIVEN("A call running on the strand of its cmd topic and a handler of its control topic") {
+        Everest::Executor executor(2, 2);
+        auto cmd_topic = std::make_shared<Everest::MessageHandler>(executor);
+        auto control_topic = std::make_shared<Everest::MessageHandler>(executor);
+        const auto context = std::make_shared<CmdCallContext>(std::nullopt);
+        std::promise<void> started;
+        std::promise<bool> finished;
+
+        cmd_topic->add_handler(std::make_shared<TypedHandler>(
+            "stream", HandlerType::Call, std::make_shared<Handler>([&](const std::string&, const json&) {
+                started.set_value();
+                // a long running handler checking for cancellation
+                const auto give_up = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+                while (not context->is_cancelled() and std::chrono::steady_clock::now() < give_up) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                finished.set_value(context->is_cancelled());
+            })));
+        control_topic->add_handler(std::make_shared<TypedHandler>(
+            "stream", HandlerType::Call,
+            std::make_shared<Handler>([&context](const std::string&, const json&) { context->cancel(); })));
+
+        THEN("The cancellation should reach the call while it is running") {
+            cmd_topic->add(std::make_shared<Everest::ParsedMessage>(Everest::ParsedMessage{
+                "module/cmd", {{"name", "stream"}, {"type", "call"}, {"data", {{"id", "call-1"}}}}}));
+            started.get_future().wait();
+            control_topic->add(std::make_shared<Everest::ParsedMessage>(Everest::ParsedMessage{
+                "module/cmd/control",
+                {{"name", "stream"}, {"type", "cancel"}, {"data", {{"id", "call-1"}, {"cancel", true}}}}}));
+            CHECK(finished.get_future().get());
+        }
+    }
+}
+
+SCENARIO("Check cached cmd results", "[cmd_call]") {
+    GIVEN("A result cache with a ttl of an hour") {
+        CmdResultCache cache(std::chrono::hours(1));
+        std::uint64_t generation = 0;
+        REQUIRE(not cache.lookup("[1]", generation).has_value());
+
+        THEN("A stored result should be returned for the same arguments only") {
+            cache.store("[1]", generation, "one");
+            std::uint64_t other_generation = 0;
+            CHECK(cache.lookup("[1]", other_generation) == json("one"));
+            CHECK(not cache.lookup("[2]", other_generation).has_value());
+        }
+
+        THEN("The result of a call in flight while the cache was invalidated should not be stored") {
+            cache.invalidate();
+            cache.store("[1]", generation, "outdated");
+            CHECK(not cache.lookup("[1]", generation).has_value());
+        }
+
+        THEN("Invalidating the cache should drop its results") {
+            cache.store("[1]", generation, "one");
+            cache.invalidate();
+            CHECK(not cache.lookup("[1]", generation).has_value());
+        }
+    }
+
+    GIVEN("A result cache with an expired ttl") {
+        CmdResultCache cache(std::chrono::nanoseconds(0));
+        std::uint64_t generation = 0;
+        cache.lookup("[1]", generation);
+        cache.store("[1]", generation, "one");
+
+        THEN("The result should not be returned anymore") {
+            CHECK(not cache.lookup("[1]", generation).has_value());
+        }
+    }
+}
+
+SCENARIO("Check reply topics of cmd calls", "[cmd_call]") {
+    GIVEN("The everest prefix everest/") {
+        THEN("The result topics of modules should be accepted") {
+            CHECK(Everest::is_cmd_reply_topic("everest/modules/evse_manager/res", "everest/"));
+            CHECK(Everest::is_cmd_reply_topic("everest/t/3fa2/res", "everest/"));
+        }
+
+        THEN("Any other topic should be rejected") {
+            CHECK(not Everest::is_cmd_reply_topic("everest/modules/evse_manager/impl/main/var", "everest/"));
+            CHECK(not Everest::is_cmd_reply_topic("everest/modules/evse_manager/impl/main/res", "everest/"));
+            CHECK(not Everest::is_cmd_reply_topic("everest/modules//res", "everest/"));
+            CHECK(not Everest::is_cmd_reply_topic("everest/modules/+/res", "everest/"));
+            CHECK(not Everest::is_cmd_reply_topic("other/modules/evse_manager/res", "everest/"));
+            CHECK(not Everest::is_cmd_reply_topic("external/topic/res", "everest/"));
+        }
+    }
+}
+
+SCENARIO("Check asynchronous cmd calls", "[cmd_call]") {
+    GIVEN("An asynchronous call with a timeout") {
+        std::promise<json> delivered;
+        std::promise<std::thread::id> callback_thread;
+        AsyncCmdCall call([&delivered, &callback_thread](std::future<json> result) {
+            callback_thread.set_value(std::this_thread::get_id());
+            delivered.set_value(result.get());
+        });
+        call.start_timeout([]() { return Everest::EventLoop::Id{7}; });
+
+        THEN("A sent call should be completed once with the id it has been sent as") {
+            CHECK(call.send([]() { return std::string("call-1"); }));
+            const auto completion = call.complete();
+            REQUIRE(completion.has_value());
+            CHECK(completion->sent);
+            CHECK(completion->call_id == "call-1");
+            CHECK(completion->timeout_timer == 7);
+            CHECK(not call.complete().has_value());
+        }
+
+        THEN("A call timing out while waiting for a slot should never be sent") {
+            const auto completion = call.complete();
+            REQUIRE(completion.has_value());
+            CHECK(not completion->sent);
+            bool sent = false;
+            CHECK(not call.send([&sent]() {
+                sent = true;
+                return std::string("call-1");
+            }));
+            CHECK(not sent);
+        }
+
+        THEN("The result should be handed to the callback on a thread of the executor") {
+            Everest::Executor executor(1, 1);
+            std::promise<json> result;
+            result.set_value(42);
+            call.deliver(executor, std::move(result));
+            auto delivered_result = delivered.get_future();
+            REQUIRE(delivered_result.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+            CHECK(delivered_result.get() == 42);
+            CHECK(callback_thread.get_future().get() != std::this_thread::get_id());
+        }
+    }
+
+    GIVEN("An asynchronous call completed by its result and its timeout at the same time") {
+        AsyncCmdCall call([](std::future<json>) {});
+        call.send([]() { return std::string("call-1"); });
+        std::promise<void> go;
+        auto start = go.get_future().share();
+        const auto complete = [&call, start]() {
+            start.wait();
+            return call.complete().has_value();
+        };
+        auto by_result = std::async(std::launch::async, complete);
+        auto by_timeout = std::async(std::launch::async, complete);
+        go.set_value();
+
+        THEN("Only one of them should complete it") {
+            CHECK(by_result.get() != by_timeout.get());
+        }
+    }
+}
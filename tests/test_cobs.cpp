@@ -0,0 +1,175 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <catch2/catch_all.hpp>
+
+#include <utils/cobs.hpp>
+#include <utils/event_loop.hpp>
+#include <utils/serial.hpp>
+
+using namespace Everest;
+using Packet = std::vector<std::uint8_t>;
+
+namespace {
+Packet encode(const Packet& packet) {
+    Packet frame(cobs_max_encoded_size(packet.size()));
+    frame.resize(cobs_encode(packet.data(), packet.size(), frame.data()));
+    return frame;
+}
+
+Packet make_packet(std::size_t size) {
+    Packet packet(size);
+    for (std::size_t i = 0; i < size; i++) {
+        // zeros at irregular distances, including runs longer than a block
+        packet[i] = (i % 7 == 0 or (i > 300 and i < 600)) ? 0 : static_cast<std::uint8_t>(i);
+    }
+    return packet;
+}
+} // namespace
+
+SCENARIO("Packets are COBS encoded and decoded", "[cobs]") {
+    GIVEN("Packets of different sizes and contents") {
+        const std::vector<Packet> packets = {{},
+                                             {0x00},
+                                             {0x00, 0x00},
+                                             {0x11, 0x22, 0x00, 0x33},
+                                             Packet(254, 0x01),
+                                             Packet(255, 0x01),
+                                             make_packet(1000)};
+
+        THEN("They survive a roundtrip and frames contain no zero but the delimiter") {
+            for (const auto& packet : packets) {
+                const auto frame = encode(packet);
+                REQUIRE(frame.size() <= cobs_max_encoded_size(packet.size()));
+                CHECK(frame.back() == 0x00);
+                CHECK(std::count(frame.begin(), frame.end(), 0x00) == 1);
+
+                Packet decoded(frame.size());
+                const auto size = cobs_decode(frame.data(), frame.size() - 1, decoded.data());
+                REQUIRE(size.has_value());
+                decoded.resize(size.value());
+                CHECK(decoded == packet);
+            }
+        }
+    }
+
+    GIVEN("A malformed frame") {
+        const Packet frame = {0x05, 0x01, 0x02};
+        Packet decoded(frame.size());
+
+        THEN("It is rejected") {
+            CHECK_FALSE(cobs_decode(frame.data(), frame.size(), decoded.data()).has_value());
+        }
+    }
+}
+
+SCENARIO("A stream of COBS frames is split into packets", "[cobs]") {
+    CobsDecoder decoder(1024);
+    std::vector<Packet> received;
+    const auto handler = [&received](const std::uint8_t* data, std::size_t length) {
+        received.emplace_back(data, data + length);
+    };
+
+    GIVEN("Frames split at every possible chunk size") {
+        const std::vector<Packet> packets = {make_packet(10), make_packet(500), {0x00}, make_packet(1024)};
+        Packet stream;
+        for (const auto& packet : packets) {
+            const auto frame = encode(packet);
+            stream.insert(stream.end(), frame.begin(), frame.end());
+        }
+
+        THEN("Every packet is received once and in order") {
+            for (const std::size_t chunk : {1, 3, 64, 1000, 4096}) {
+                received.clear();
+                for (std::size_t offset = 0; offset < stream.size(); offset += chunk) {
+                    decoder.feed(stream.data() + offset, std::min(chunk, stream.size() - offset), handler);
+                }
+                CHECK(received == packets);
+            }
+            CHECK(decoder.get_dropped_frames() == 0);
+        }
+    }
+
+    GIVEN("A frame exceeding the maximum packet size between two valid ones") {
+        Packet stream = encode({0x01});
+        const auto oversized = encode(make_packet(2000));
+        stream.insert(stream.end(), oversized.begin(), oversized.end());
+        const auto last = encode({0x02});
+        stream.insert(stream.end(), last.begin(), last.end());
+
+        THEN("Only the oversized frame is dropped") {
+            decoder.feed(stream.data(), stream.size(), handler);
+            CHECK(received == std::vector<Packet>{{0x01}, {0x02}});
+            CHECK(decoder.get_dropped_frames() == 1);
+        }
+    }
+}
+
+SCENARIO("AsyncSerial exchanges packets through the event loop", "[cobs]") {
+    int fds[2];
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+    std::mutex received_mutex;
+    std::condition_variable received_cv;
+    std::vector<Packet> received;
+
+    EventLoop event_loop;
+    const auto handler = [&](const std::uint8_t* data, std::size_t length) {
+        const std::lock_guard<std::mutex> lock(received_mutex);
+        received.emplace_back(data, data + length);
+        received_cv.notify_all();
+    };
+    AsyncSerial serial(event_loop, handler, 4096, 1024 * 1024);
+    REQUIRE(serial.attach(fds[0]));
+    std::thread loop_thread([&event_loop]() { event_loop.run(); });
+
+    GIVEN("Packets written by the peer and sent by the serial") {
+        const auto packet = make_packet(3000);
+        const auto frame = encode(make_packet(1500));
+        REQUIRE(write(fds[1], frame.data(), frame.size()) == static_cast<ssize_t>(frame.size()));
+
+        // more than the socket buffer, so the serial has to wait for the device to become writable
+        const std::size_t count = 200;
+        for (std::size_t i = 0; i < count; i++) {
+            REQUIRE(serial.send_packet(packet.data(), packet.size()));
+        }
+
+        THEN("Both sides receive the complete packets") {
+            {
+                std::unique_lock<std::mutex> lock(received_mutex);
+                REQUIRE(received_cv.wait_for(lock, std::chrono::seconds(5), [&received]() {
+                    return not received.empty();
+                }));
+                CHECK(received.front() == make_packet(1500));
+            }
+
+            CobsDecoder peer(4096);
+            std::size_t peer_received = 0;
+            std::uint8_t buffer[4096];
+            while (peer_received < count) {
+                const auto size = read(fds[1], buffer, sizeof(buffer));
+                REQUIRE(size > 0);
+                peer.feed(buffer, size, [&](const std::uint8_t* data, std::size_t length) {
+                    CHECK(Packet(data, data + length) == packet);
+                    peer_received++;
+                });
+            }
+            CHECK(peer.get_dropped_frames() == 0);
+        }
+    }
+
+    event_loop.stop();
+    loop_thread.join();
+    serial.close_device();
+    close(fds[1]);
+}
@@ -1,5 +1,7 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright Pionix GmbH and Contributors to EVerest
+#include <fstream>
+
 #include <catch2/catch_all.hpp>
 
 #include <framework/runtime.hpp>
@@ -171,6 +173,87 @@ SCENARIO("Check Config Constructor", "[!throws]") {
             }());
         }
     }
+    GIVEN("A valid config with a valid module and enabled schema validation sliced for the module") {
+        auto ms = Everest::ManagerSettings(bin_dir + "valid_module_config_validate/",
+                                           bin_dir + "valid_module_config_validate/config.yaml");
+        auto mc = Everest::ManagerConfig(ms);
+        const auto slice = mc.get_module_config_slice("valid_module");
+        THEN("It should contain the manifest, interface and types of the module") {
+            CHECK(slice.at("manifests").size() == 1);
+            CHECK(slice.at("manifests").contains("TESTValidManifestCmdVar"));
+            CHECK(slice.at("interface_definitions").size() == 1);
+            CHECK(slice.at("interface_definitions").contains("test_interface_cmd_var"));
+            CHECK(slice.at("types").size() == 1);
+            CHECK(slice.at("types").contains("/test_type"));
+            CHECK(slice.at("module_config_cache").contains("TESTValidManifestCmdVar"));
+            // the interface does not declare any errors
+            CHECK(slice.at("error_map").empty());
+        }
+    }
+    GIVEN("A valid config with a valid module queried through the index") {
+        auto ms =
+            Everest::ManagerSettings(bin_dir + "valid_module_config/", bin_dir + "valid_module_config/config.yaml");
+        auto mc = Everest::ManagerConfig(ms);
+        THEN("It should return the same identifiers and prefixes as computed from the json documents") {
+            CHECK(mc.get_module_name("valid_module") == "TESTValidManifest");
+            CHECK(mc.printable_identifier("valid_module") == "valid_module:TESTValidManifest");
+            CHECK(mc.printable_identifier("valid_module", "main") ==
+                  "valid_module:TESTValidManifest->main:test_interface");
+            CHECK(mc.mqtt_module_prefix("valid_module") == ms.mqtt_settings.everest_prefix + "modules/valid_module");
+            CHECK(mc.mqtt_prefix("valid_module", "main") ==
+                  ms.mqtt_settings.everest_prefix + "modules/valid_module/impl/main");
+            CHECK(mc.resolve_requirements("valid_module").empty());
+        }
+        THEN("It should return the precomputed topics") {
+            CHECK(mc.get_topic("valid_module", Everest::ModuleTopic::Ready) ==
+                  mc.mqtt_module_prefix("valid_module") + "/ready");
+            CHECK(mc.get_topic("valid_module", "main", Everest::ImplementationTopic::Cmd) ==
+                  mc.mqtt_prefix("valid_module", "main") + "/cmd");
+            CHECK(mc.get_topic("valid_module", "main", Everest::ImplementationTopic::Error) ==
+                  mc.mqtt_prefix("valid_module", "main") + "/error/");
+            CHECK_THROWS_AS(mc.get_topic("valid_module", "unknown_impl", Everest::ImplementationTopic::Var),
+                            Everest::EverestApiError);
+        }
+        THEN("Unknown ids should throw") {
+            CHECK_THROWS_AS(mc.printable_identifier("unknown_module"), Everest::EverestApiError);
+            CHECK_THROWS_AS(mc.printable_identifier("valid_module", "unknown_impl"), Everest::EverestApiError);
+            CHECK_THROWS_AS(mc.resolve_requirement("valid_module", "unknown_requirement"), Everest::EverestApiError);
+        }
+    }
+    GIVEN("A valid config with a valid module and topic aliases") {
+        auto ms =
+            Everest::ManagerSettings(bin_dir + "valid_module_config/", bin_dir + "valid_module_config/config.yaml");
+        ms.mqtt_settings.topic_aliases = true;
+        auto mc = Everest::ManagerConfig(ms);
+        THEN("Cmd, var and result topics should be aliased, all other topics should stay the same") {
+            const auto& var_topic = mc.get_topic("valid_module", "main", Everest::ImplementationTopic::Var);
+            CHECK(var_topic.rfind(ms.mqtt_settings.everest_prefix + "t/", 0) == 0);
+            CHECK(var_topic.size() < (mc.mqtt_prefix("valid_module", "main") + "/var").size());
+            CHECK(mc.get_topic("valid_module", "main", Everest::ImplementationTopic::Cmd) ==
+                  var_topic.substr(0, var_topic.size() - 4) + "/cmd");
+            CHECK(mc.get_topic("valid_module", Everest::ModuleTopic::CmdResult).rfind("/res") != std::string::npos);
+            CHECK(mc.get_topic("valid_module", "main", Everest::ImplementationTopic::Error) ==
+                  mc.mqtt_prefix("valid_module", "main") + "/error/");
+            CHECK(mc.get_topic("valid_module", Everest::ModuleTopic::Ready) ==
+                  mc.mqtt_module_prefix("valid_module") + "/ready");
+        }
+    }
+    GIVEN("A valid config with a valid module loaded twice") {
+        auto ms =
+            Everest::ManagerSettings(bin_dir + "valid_module_config/", bin_dir + "valid_module_config/config.yaml");
+        auto mc = Everest::ManagerConfig(ms);
+        auto reloaded = Everest::ManagerConfig(ms);
+        THEN("No module should have changed") {
+            const auto changed_modules = mc.get_changed_modules(reloaded);
+            REQUIRE(changed_modules.has_value());
+            CHECK(changed_modules->empty());
+        }
+        THEN("A config with other settings should require a restart of all modules") {
+            auto other_ms = Everest::ManagerSettings(bin_dir + "valid_module_config_userconfig/",
+                                                     bin_dir + "valid_module_config_userconfig/config.yaml");
+            CHECK(not mc.get_changed_modules(Everest::ManagerConfig(other_ms)).has_value());
+        }
+    }
     GIVEN("A valid config with a valid module serialized") {
         auto ms =
             Everest::ManagerSettings(bin_dir + "valid_module_config/", bin_dir + "valid_module_config/config.yaml");
@@ -183,6 +266,30 @@ SCENARIO("Check Config Constructor", "[!throws]") {
             }());
         }
     }
+    GIVEN("A valid config with a valid module and a config cache directory") {
+        const auto cache_dir = fs::path(bin_dir) / "valid_module_config_cache" / "cache";
+        fs::remove_all(cache_dir);
+        auto ms = Everest::ManagerSettings(bin_dir + "valid_module_config_cache/",
+                                           bin_dir + "valid_module_config_cache/config.yaml");
+        auto compiled = Everest::ManagerConfig(ms);
+        THEN("The compiled config should be cached") {
+            CHECK(fs::exists(cache_dir / "config.cbor"));
+        }
+        THEN("The cached config should be equal to the compiled one") {
+            auto cached = Everest::ManagerConfig(ms);
+            CHECK(cached.get_main_config() == compiled.get_main_config());
+            CHECK(cached.get_manifests() == compiled.get_manifests());
+            CHECK(cached.get_interface_definitions() == compiled.get_interface_definitions());
+            CHECK(cached.get_types() == compiled.get_types());
+            CHECK(cached.get_error_types() == compiled.get_error_types());
+            CHECK(cached.get_module_names() == compiled.get_module_names());
+        }
+        THEN("A broken cache should be ignored") {
+            std::ofstream(cache_dir / "config.cbor") << "broken";
+            auto recompiled = Everest::ManagerConfig(ms);
+            CHECK(recompiled.get_main_config() == compiled.get_main_config());
+        }
+    }
     GIVEN("A valid config in legacy json format with a valid module") {
         auto ms = Everest::ManagerSettings(bin_dir + "valid_module_config_json/",
                                            bin_dir + "valid_module_config_json/config.json");
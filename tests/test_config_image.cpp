@@ -0,0 +1,37 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <cstdlib>
+#include <map>
+#include <string>
+
+#include <catch2/catch_all.hpp>
+#include <nlohmann/json.hpp>
+
+#include <utils/config_image.hpp>
+
+using json = nlohmann::json;
+
+SCENARIO("Check shared config image", "[config_image]") {
+    GIVEN("An image of two modules sharing most of their config") {
+        const json shared_types = {{"/test_type", {{"type", "object"}}}};
+        const std::map<std::string, json> module_snapshots = {
+            {"evse", {{"types", shared_types}, {"settings", {{"prefix", "/usr"}}}, {"mappings", nullptr}}},
+            {"meter", {{"types", shared_types}, {"settings", {{"prefix", "/usr"}}}, {"module_names", json::array()}}}};
+        const auto image = Everest::ConfigImage::create(module_snapshots);
+
+        THEN("Every module should get back its own snapshot") {
+            CHECK(image->get_module_snapshot("evse") == module_snapshots.at("evse"));
+            CHECK(image->get_module_snapshot("meter") == module_snapshots.at("meter"));
+            CHECK(not image->get_module_snapshot("unknown").has_value());
+        }
+
+        THEN("A module attaching via the environment should read the same snapshot") {
+            image->setup_environment();
+            const auto attached = Everest::ConfigImage::attach_from_env();
+            unsetenv(Everest::EV_CONFIG_IMAGE_FD);
+            REQUIRE(attached != nullptr);
+            CHECK(attached->get_size() == image->get_size());
+            CHECK(attached->get_module_snapshot("meter") == module_snapshots.at("meter"));
+        }
+    }
+}
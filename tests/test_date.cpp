@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <chrono>
+
+#include <catch2/catch_all.hpp>
+
+#include <utils/date.hpp>
+
+using namespace Everest;
+using namespace std::chrono_literals;
+
+SCENARIO("Check RFC3339 formatting", "[date]") {
+    GIVEN("Timestamps within the same and in following seconds") {
+        const auto start = date::clock_cast<date::utc_clock>(date::sys_days{date::year{2024} / 1 / 31} + 12h);
+        THEN("They should be formatted like date::format") {
+            for (const auto offset : {0ms, 1ms, 999ms, 1000ms, 61001ms, 86399999ms}) {
+                const auto t = start + offset;
+                CHECK(Date::to_rfc3339(t) == date::format("%FT%TZ", date::floor<std::chrono::milliseconds>(t)));
+            }
+        }
+        THEN("The formatted timestamps should be readable by from_rfc3339") {
+            Date::Rfc3339Buffer buffer;
+            CHECK(Date::from_rfc3339(std::string(Date::format_rfc3339(start + 1500ms, buffer))) ==
+                  date::floor<std::chrono::seconds>(start + 1500ms));
+        }
+    }
+
+    GIVEN("A timestamp within a leap second") {
+        const auto leap_second =
+            date::clock_cast<date::utc_clock>(date::sys_days{date::year{2017} / 1 / 1}) - 500ms;
+        THEN("The seconds should read 60") {
+            Date::Rfc3339Buffer buffer;
+            CHECK(Date::format_rfc3339(leap_second, buffer) == "2016-12-31T23:59:60.500Z");
+        }
+    }
+}
+
+SCENARIO("Check coarse clock", "[date]") {
+    THEN("It should be close to the utc clock") {
+        const auto coarse = Date::CoarseClock::now();
+        const auto precise = date::utc_clock::now();
+        CHECK(std::chrono::abs(precise - coarse) < 100ms);
+    }
+}
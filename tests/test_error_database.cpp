@@ -0,0 +1,254 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_all.hpp>
+
+#include <utils/error/error_database_map.hpp>
+#include <utils/error/error_database_ring.hpp>
+#include <utils/error/error_filter.hpp>
+#include <utils/error/error_json.hpp>
+#include <utils/error/error_manager_impl.hpp>
+#include <utils/error/error_pool.hpp>
+#include <utils/error/error_type_map.hpp>
+#include <utils/error/error_state_monitor.hpp>
+#include <utils/latency_histogram.hpp>
+#include <utils/payload_encoding.hpp>
+
+using namespace Everest::error;
+
+static ErrorPtr make_test_error(const ErrorType& type, const ErrorSubType& sub_type, const std::string& module_id,
+                                Severity severity = Severity::Low) {
+    return std::make_shared<Error>(type, sub_type, "message", "description", module_id, "main", severity);
+}
+
+SCENARIO("Check indexed error database queries", "[error_database]") {
+    GIVEN("A database with errors of different types, sub types and origins") {
+        ErrorDatabaseMap database;
+        const auto overcurrent = make_test_error("evse/Overcurrent", "", "evse_1", Severity::High);
+        const auto overvoltage = make_test_error("evse/Overvoltage", "", "evse_1");
+        const auto overcurrent_2 = make_test_error("evse/Overcurrent", "phase_2", "evse_2");
+        database.add_error(overcurrent);
+        database.add_error(overvoltage);
+        database.add_error(overcurrent_2);
+
+        THEN("Combined filters should only return the matching errors") {
+            CHECK(database.get_errors({}).size() == 3);
+            CHECK(database.get_errors({ErrorFilter(TypeFilter("evse/Overcurrent"))}).size() == 2);
+            const auto errors = database.get_errors(
+                {ErrorFilter(TypeFilter("evse/Overcurrent")), ErrorFilter(OriginFilter({"evse_2", "main"}))});
+            REQUIRE(errors.size() == 1);
+            CHECK(errors.front() == overcurrent_2);
+            const auto high = database.get_errors(
+                {ErrorFilter(TypeFilter("evse/Overcurrent")), ErrorFilter(SeverityFilter::HIGH_GE)});
+            REQUIRE(high.size() == 1);
+            CHECK(high.front() == overcurrent);
+            CHECK(database.get_errors({ErrorFilter(TypeFilter("evse/Unknown"))}).empty());
+            CHECK(database.get_errors({ErrorFilter(HandleFilter(overvoltage->uuid))}).front() == overvoltage);
+        }
+
+        WHEN("Errors are removed") {
+            const auto removed = database.remove_errors({ErrorFilter(OriginFilter({"evse_1", "main"}))});
+
+            THEN("They should not be returned by any index anymore") {
+                CHECK(removed.size() == 2);
+                CHECK(database.get_errors({ErrorFilter(TypeFilter("evse/Overcurrent"))}).size() == 1);
+                CHECK(database.get_errors({ErrorFilter(TypeFilter("evse/Overvoltage"))}).empty());
+                CHECK(database.get_errors({ErrorFilter(HandleFilter(overcurrent->uuid))}).empty());
+            }
+        }
+    }
+}
+
+namespace {
+/// \brief Pauses removals after the errors left the database, before the removal is notified
+class PausingErrorDatabase : public ErrorDatabaseMap {
+public:
+    std::promise<void> removed;
+    std::promise<void> resume;
+
+    std::list<ErrorPtr> edit_errors(const std::list<ErrorFilter>& filters, EditErrorFunc edit_func) override {
+        auto result = ErrorDatabaseMap::edit_errors(filters, std::move(edit_func));
+        this->removed.set_value();
+        this->resume.get_future().wait_for(std::chrono::seconds(1));
+        return result;
+    }
+};
+} // namespace
+
+SCENARIO("Check the order of error database change notifications", "[error_database]") {
+    GIVEN("A database with an error, whose removals pause before they are notified") {
+        PausingErrorDatabase database;
+        const auto overcurrent = make_test_error("evse/Overcurrent", "", "evse_1");
+        const auto overvoltage = make_test_error("evse/Overvoltage", "", "evse_1");
+        database.add_error(overcurrent);
+        std::vector<std::string> changes;
+        database.add_change_handler([&changes](const std::list<ErrorPtr>& added, const std::list<ErrorPtr>& removed) {
+            for (const auto& error : added) {
+                changes.push_back("added " + error->type);
+            }
+            for (const auto& error : removed) {
+                changes.push_back("removed " + error->type);
+            }
+        });
+
+        WHEN("Another error is added while the removal of the first one is paused") {
+            std::thread removing([&]() { database.remove_errors({ErrorFilter(HandleFilter(overcurrent->uuid))}); });
+            database.removed.get_future().wait();
+            std::thread adding([&]() { database.add_error(overvoltage); });
+            // the addition would have been notified by now if it was not held back
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            database.resume.set_value();
+            removing.join();
+            adding.join();
+
+            THEN("The handler should see the changes in the order they were made") {
+                CHECK(changes == std::vector<std::string>{"removed evse/Overcurrent", "added evse/Overvoltage"});
+            }
+        }
+    }
+}
+
+SCENARIO("Check registered error state monitor conditions", "[error_database]") {
+    GIVEN("A monitor with a condition on an error that is already active and one that is not") {
+        auto database = std::make_shared<ErrorDatabaseMap>();
+        const auto overcurrent = make_test_error("evse/Overcurrent", "", "evse_1");
+        database->add_error(overcurrent);
+        ErrorStateMonitor monitor(database);
+        std::vector<bool> transitions;
+        const auto id = monitor.register_condition(
+            {{"evse/Overcurrent", "", false}, {"evse/Overvoltage", "", false}},
+            [&transitions](bool satisfied) { transitions.push_back(satisfied); });
+
+        THEN("The condition should not be satisfied initially") {
+            CHECK(not monitor.is_registered_condition_satisfied(id));
+            CHECK(transitions.empty());
+        }
+
+        WHEN("The errors change") {
+            const auto overvoltage = make_test_error("evse/Overvoltage", "", "evse_1");
+            database->remove_errors({ErrorFilter(HandleFilter(overcurrent->uuid))});
+            database->add_error(overvoltage);
+            database->add_error(make_test_error("evse/Overvoltage", "", "evse_2"));
+            database->remove_errors({ErrorFilter(HandleFilter(overvoltage->uuid))});
+            database->remove_errors({ErrorFilter(TypeFilter("evse/Overvoltage"))});
+
+            THEN("The handler should be called on every transition only") {
+                CHECK(transitions == std::vector<bool>{true, false, true});
+                CHECK(monitor.is_registered_condition_satisfied(id));
+                CHECK(monitor.is_condition_satisfied({{"evse/Overcurrent", "", false}}));
+            }
+        }
+
+        WHEN("The condition is unregistered") {
+            monitor.unregister_condition(id);
+            database->remove_errors({});
+
+            THEN("The handler should not be called anymore") {
+                CHECK(transitions.empty());
+            }
+        }
+    }
+}
+
+SCENARIO("Check the error history ring", "[error_database]") {
+    const auto start = date::utc_clock::now();
+    const auto make_timed_error = [start](const ErrorType& type, int second) {
+        return std::make_shared<Error>(type, "", "message", "description",
+                                       ImplementationIdentifier("evse_1", "main"), "everest", Severity::Low,
+                                       start + std::chrono::seconds(second), UUID());
+    };
+
+    GIVEN("A ring with a capacity of three errors and four raised errors") {
+        ErrorDatabaseRing ring(3);
+        for (int i = 0; i < 4; i++) {
+            ring.add_error(make_timed_error("evse/Error" + std::to_string(i), i));
+        }
+
+        THEN("The oldest error should be overwritten") {
+            CHECK(ring.size() == 3);
+            CHECK(ring.get_errors({ErrorFilter(TypeFilter("evse/Error0"))}).empty());
+            CHECK(ring.get_errors({}).front()->type == "evse/Error1");
+        }
+
+        THEN("Time periods should only return the errors raised within them") {
+            const auto errors = ring.get_errors(
+                {ErrorFilter(TimePeriodFilter{start + std::chrono::seconds(2), start + std::chrono::seconds(3)})});
+            REQUIRE(errors.size() == 2);
+            CHECK(errors.front()->type == "evse/Error2");
+            CHECK(errors.back()->type == "evse/Error3");
+        }
+
+        WHEN("An error is removed") {
+            const auto removed = ring.remove_errors({ErrorFilter(TypeFilter("evse/Error2"))});
+
+            THEN("It should stay in the history as cleared") {
+                REQUIRE(removed.size() == 1);
+                CHECK(ring.remove_errors({ErrorFilter(TypeFilter("evse/Error2"))}).empty());
+                CHECK(ring.get_errors({ErrorFilter(StateFilter(State::Active))}).size() == 2);
+                const auto cleared = ring.get_errors({ErrorFilter(StateFilter(State::ClearedByModule))});
+                REQUIRE(cleared.size() == 1);
+                CHECK(cleared.front()->uuid == removed.front()->uuid);
+            }
+        }
+    }
+
+    GIVEN("A ring persisted to a file") {
+        const auto file = std::filesystem::temp_directory_path() / "everest_test_error_ring";
+        std::filesystem::remove(file);
+        const auto error = make_timed_error("evse/Overcurrent", 0);
+        ErrorDatabaseRing(8, file.string()).add_error(error);
+
+        THEN("The errors should be restored from the file with the same capacity only") {
+            const auto restored =
+                ErrorDatabaseRing(8, file.string()).get_errors({ErrorFilter(HandleFilter(error->uuid))});
+            REQUIRE(restored.size() == 1);
+            CHECK(restored.front()->type == "evse/Overcurrent");
+            CHECK(restored.front()->timestamp == error->timestamp);
+            CHECK(ErrorDatabaseRing(4, file.string()).size() == 0);
+        }
+        std::filesystem::remove(file);
+    }
+}
+
+TEST_CASE("Error storm benchmark", "[.][error_storm_benchmark]") {
+    constexpr auto storms = 100000;
+
+    // raised and cleared errors are delivered through the wire encoding into a second database like a subscriber
+    ErrorDatabaseMap received;
+    Everest::LatencyHistogram histogram;
+    const auto deliver = [&received](const Error& error, bool raised) {
+        const auto payload = Everest::encode_payload(nlohmann::json(error), Everest::MQTTPayloadEncoding::Cbor);
+        const auto delivered = Everest::decode_payload(payload).get<Error>();
+        if (raised) {
+            received.add_error(make_error(delivered));
+        } else {
+            received.remove_errors(
+                {ErrorFilter(TypeFilter(delivered.type)), ErrorFilter(SubTypeFilter(delivered.sub_type))});
+        }
+    };
+    ErrorManagerImpl manager(
+        std::make_shared<ErrorTypeMap>(), std::make_shared<ErrorDatabaseMap>(), {},
+        [&deliver](const Error& error) { deliver(error, true); },
+        [&deliver](const Error& error) { deliver(error, false); }, false);
+
+    const Error error("evse/Overcurrent", "", "message", "description", "evse_1", "main", Severity::High);
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < storms; i++) {
+        const auto raised = std::chrono::steady_clock::now();
+        manager.raise_error(error);
+        manager.clear_error(error.type, error.sub_type);
+        histogram.record(std::chrono::steady_clock::now() - raised);
+    }
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    CHECK(received.get_errors({}).empty());
+    WARN(static_cast<std::size_t>(storms / elapsed) << " raises and clears/s, latency "
+                                                    << nlohmann::json(histogram.get_summary()).dump());
+}
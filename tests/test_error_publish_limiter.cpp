@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_all.hpp>
+
+#include <utils/error/error_publish_limiter.hpp>
+
+using namespace Everest::error;
+using namespace std::chrono_literals;
+
+SCENARIO("Check error publish limits", "[error_publish_limiter]") {
+    std::vector<std::string> published;
+    const auto make_limiter = [&published](const nlohmann::json& module_config) {
+        return ErrorPublishLimiter(
+            ErrorPublishSettings::parse(module_config),
+            [&published](const Error& error) { published.push_back("raised " + error.type); },
+            [&published](const Error& error) { published.push_back("cleared " + error.type); });
+    };
+    const Error overcurrent("evse/Overcurrent", "", "message", "description", "evse", "main");
+    const auto start = ErrorPublishLimiter::clock::now();
+
+    GIVEN("A module without error publishing settings") {
+        THEN("The settings should not limit anything") {
+            CHECK(ErrorPublishSettings::parse(nlohmann::json::object()).is_passthrough());
+        }
+    }
+
+    GIVEN("A limiter with a debounce and hold time") {
+        auto limiter = make_limiter({{"error_publishing", {{"debounce_ms", 100}, {"hold_ms", 500}}}});
+
+        WHEN("An error flaps faster than the debounce time") {
+            for (int i = 0; i < 10; i++) {
+                limiter.raise_error(overcurrent, start + i * 10ms);
+                limiter.clear_error(overcurrent, start + i * 10ms + 5ms);
+            }
+            limiter.flush(start + 1s);
+
+            THEN("Nothing should be published") {
+                CHECK(published.empty());
+            }
+        }
+
+        WHEN("An error stays raised and is cleared briefly") {
+            limiter.raise_error(overcurrent, start);
+            CHECK(limiter.flush(start + 50ms) == start + 100ms);
+            limiter.flush(start + 100ms);
+            limiter.clear_error(overcurrent, start + 200ms);
+            limiter.raise_error(overcurrent, start + 300ms);
+            limiter.clear_error(overcurrent, start + 400ms);
+            limiter.flush(start + 800ms);
+            limiter.flush(start + 900ms);
+
+            THEN("Only the settled raise and clear should be published") {
+                CHECK(published == std::vector<std::string>{"raised evse/Overcurrent", "cleared evse/Overcurrent"});
+            }
+        }
+    }
+
+    GIVEN("A limiter with a rate limit for one error type") {
+        auto limiter = make_limiter(
+            {{"error_publishing", {{"types", {{"evse/Overcurrent", {{"max_publishes_per_s", 1}}}}}}}});
+
+        WHEN("An error is raised and cleared several times within a second") {
+            limiter.raise_error(overcurrent, start);
+            limiter.clear_error(overcurrent, start + 100ms);
+            limiter.raise_error(overcurrent, start + 200ms);
+            limiter.clear_error(overcurrent, start + 300ms);
+            const auto next = limiter.flush(start + 300ms);
+
+            THEN("The last state should be published once the rate limit allows it") {
+                CHECK(published == std::vector<std::string>{"raised evse/Overcurrent"});
+                REQUIRE(next.has_value());
+                CHECK(*next >= start + 1s);
+                CHECK(*next < start + 1001ms);
+                limiter.flush(*next);
+                CHECK(published == std::vector<std::string>{"raised evse/Overcurrent", "cleared evse/Overcurrent"});
+            }
+        }
+    }
+
+    GIVEN("A limiter without limits whose publish of a raise is slow") {
+        std::mutex published_mutex;
+        std::promise<void> raise_publishing;
+        std::promise<void> release_raise;
+        auto raise_released = release_raise.get_future();
+        ErrorPublishLimiter limiter(
+            ErrorPublishSettings::parse(nlohmann::json::object()),
+            [&](const Error& error) {
+                raise_publishing.set_value();
+                raise_released.wait_for(1s);
+                const std::lock_guard<std::mutex> lock(published_mutex);
+                published.push_back("raised " + error.type);
+            },
+            [&](const Error& error) {
+                const std::lock_guard<std::mutex> lock(published_mutex);
+                published.push_back("cleared " + error.type);
+            });
+
+        WHEN("The error is cleared on another thread while its raise is being published") {
+            std::thread raising([&]() { limiter.raise_error(overcurrent); });
+            raise_publishing.get_future().wait();
+            std::thread clearing([&]() { limiter.clear_error(overcurrent); });
+            // the clear would be published by now if it was not held back
+            std::this_thread::sleep_for(50ms);
+            release_raise.set_value();
+            raising.join();
+            clearing.join();
+
+            THEN("The raise and the clear should be published in the order they happened") {
+                CHECK(published == std::vector<std::string>{"raised evse/Overcurrent", "cleared evse/Overcurrent"});
+            }
+        }
+    }
+}
@@ -0,0 +1,44 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <filesystem>
+#include <fstream>
+
+#include <catch2/catch_all.hpp>
+
+#include <utils/error/error_type_map.hpp>
+
+using Everest::error::ErrorTypeMap;
+
+SCENARIO("Check lazily loaded error types", "[error_type_map]") {
+    GIVEN("An errors directory with two namespaces, one of them deleted after it was indexed") {
+        const auto errors_dir = std::filesystem::temp_directory_path() / "everest_test_error_types";
+        std::filesystem::remove_all(errors_dir);
+        std::filesystem::create_directories(errors_dir);
+        std::ofstream(errors_dir / "evse.yaml") << "errors:\n"
+                                                   "  - name: Overcurrent\n"
+                                                   "    description: Too much current\n"
+                                                   "  - name: Overvoltage\n"
+                                                   "    description: Too much voltage\n";
+        std::ofstream(errors_dir / "deleted.yaml") << "errors: []\n";
+        ErrorTypeMap map(errors_dir);
+        std::filesystem::remove(errors_dir / "deleted.yaml");
+
+        THEN("Types of a namespace should be available without loading the other namespaces") {
+            CHECK(map.has("evse/Overcurrent"));
+            CHECK(map.get_description("evse/Overvoltage") == "Too much voltage");
+            CHECK(not map.has("evse/Undefined"));
+            CHECK(map.get_error_types({"evse"}).size() == 2);
+        }
+
+        THEN("Copies should share the loaded types") {
+            const ErrorTypeMap copy = map;
+            CHECK(copy.has("evse/Overcurrent"));
+            CHECK(map.get_error_types({"evse", "missing"}) == copy.get_error_types({"evse"}));
+        }
+
+        THEN("The deleted namespace should only be loaded once all error types are requested") {
+            CHECK_THROWS(map.get_error_types());
+        }
+        std::filesystem::remove_all(errors_dir);
+    }
+}
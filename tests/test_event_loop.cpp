@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <catch2/catch_all.hpp>
+
+#include <utils/event_loop.hpp>
+
+using Everest::EventLoop;
+
+/// \brief runs \p loop until it is stopped, at the latest after a few seconds so a failing test does not hang
+static void run_stopping_after(EventLoop& loop, std::chrono::milliseconds timeout = std::chrono::seconds(5)) {
+    loop.add_timer(timeout, [&loop]() { loop.stop(); }, false);
+    loop.run();
+}
+
+SCENARIO("Check event loop timers", "[event_loop]") {
+    GIVEN("An event loop") {
+        EventLoop loop;
+
+        THEN("A one-shot timer should only fire once") {
+            int fired = 0;
+            loop.add_timer(std::chrono::milliseconds(1), [&fired]() { fired++; }, false);
+            run_stopping_after(loop, std::chrono::milliseconds(50));
+            CHECK(fired == 1);
+        }
+
+        THEN("A periodic timer should fire until it is removed") {
+            int fired = 0;
+            EventLoop::Id timer = 0;
+            timer = loop.add_timer(std::chrono::milliseconds(1), [&]() {
+                if (++fired == 3) {
+                    loop.remove(timer);
+                    loop.stop();
+                }
+            });
+            run_stopping_after(loop);
+            CHECK(fired == 3);
+
+            run_stopping_after(loop, std::chrono::milliseconds(20));
+            CHECK(fired == 3);
+        }
+    }
+}
+
+SCENARIO("Check event loop file descriptors", "[event_loop]") {
+    GIVEN("An event loop watching an eventfd") {
+        EventLoop loop;
+        const int event_fd = eventfd(0, EFD_NONBLOCK);
+        REQUIRE(event_fd != -1);
+
+        THEN("The callback should be called once the eventfd is readable") {
+            std::uint32_t events = 0;
+            eventfd_t value = 0;
+            loop.add_fd(event_fd, EPOLLIN, [&](std::uint32_t occurred) {
+                events = occurred;
+                eventfd_read(event_fd, &value);
+                loop.stop();
+            });
+            std::thread writer([event_fd]() { eventfd_write(event_fd, 3); });
+            run_stopping_after(loop);
+            writer.join();
+            CHECK((events & EPOLLIN) != 0);
+            CHECK(value == 3);
+        }
+
+        THEN("A callback removing itself should not be called again, even if its fd stays readable") {
+            int called = 0;
+            EventLoop::Id registration = 0;
+            registration = loop.add_fd(event_fd, EPOLLIN, [&](std::uint32_t) {
+                called++;
+                loop.remove(registration);
+            });
+            eventfd_write(event_fd, 1);
+            run_stopping_after(loop, std::chrono::milliseconds(50));
+            CHECK(called == 1);
+        }
+
+        close(event_fd);
+    }
+}
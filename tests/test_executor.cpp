@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+
+#include <catch2/catch_all.hpp>
+
+#include <utils/executor.hpp>
+
+using Everest::ConcurrencyLimiter;
+using Everest::Executor;
+
+SCENARIO("Check concurrency limiter", "[executor]") {
+    GIVEN("A limiter allowing two concurrent tasks on an executor with four workers") {
+        Executor executor(4, 4);
+        auto limiter = std::make_shared<ConcurrencyLimiter>(executor, 2);
+        std::atomic<int> running{0};
+        std::atomic<int> max_running{0};
+        std::atomic<int> running_serialized{0};
+        std::atomic<int> max_running_serialized{0};
+        std::atomic<int> finished{0};
+        std::promise<void> all_finished;
+
+        const auto count = [](std::atomic<int>& counter, std::atomic<int>& max_counter) {
+            const auto now_running = ++counter;
+            auto current_max = max_counter.load();
+            while (now_running > current_max and not max_counter.compare_exchange_weak(current_max, now_running)) {
+            }
+        };
+        const auto task = [&](bool serialized) {
+            return [&, serialized]() {
+                count(running, max_running);
+                if (serialized) {
+                    count(running_serialized, max_running_serialized);
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                if (serialized) {
+                    running_serialized--;
+                }
+                running--;
+                if (++finished == 12) {
+                    all_finished.set_value();
+                }
+            };
+        };
+        for (int i = 0; i < 6; i++) {
+            limiter->post("", task(false));
+            limiter->post("serialized", task(true));
+        }
+        all_finished.get_future().wait();
+
+        THEN("At most two tasks and at most one serialized task should have run at the same time") {
+            CHECK(max_running == 2);
+            CHECK(max_running_serialized == 1);
+            CHECK(limiter->get_pending_count() == 0);
+        }
+    }
+}
@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <catch2/catch_all.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <everest/exceptions.hpp>
+#include <utils/flight_recorder.hpp>
+
+using namespace Everest;
+
+SCENARIO("Check the flight recorder", "[flight_recorder]") {
+    GIVEN("A flight recorder keeping the last 4 events") {
+        const auto file = (std::filesystem::temp_directory_path() / "everest_test_flight_recorder.bin").string();
+        auto& recorder = FlightRecorder::get();
+        recorder.configure({4, file}, "test_module");
+        REQUIRE(recorder.is_enabled());
+
+        WHEN("More events than it keeps are recorded and dumped") {
+            for (int i = 0; i < 6; ++i) {
+                recorder.record(FlightEvent::Dispatch, HandlerType::Call, fmt::format("everest/module/cmd{}", i),
+                                "0b9c4d5e-2a07-4f29-9d25-7f0e7e0f7c3a", std::chrono::microseconds(10 + i));
+            }
+            const std::string long_topic(100, 'a');
+            recorder.record(FlightEvent::Publish, HandlerType::Unknown, long_topic + "end", {}, {});
+            REQUIRE(recorder.dump("test"));
+
+            THEN("The decoder should give the most recent events, oldest first") {
+                std::ifstream stream(file, std::ios::binary);
+                const auto recording = decode_flight_recording(stream);
+                CHECK(recording.module_id == "test_module");
+                CHECK(recording.reason == "test");
+                CHECK(recording.lost_records == 3);
+                REQUIRE(recording.records.size() == 4);
+
+                const auto first = to_json(recording.records.at(0));
+                CHECK(first.at("event") == "dispatch");
+                CHECK(first.at("handler_type") == "call");
+                CHECK(first.at("topic") == "everest/module/cmd3");
+                CHECK(first.at("call_id") == "0b9c4d5e-2a07-4f29-9d25-7f0e7e0f7c3a");
+                CHECK(first.at("duration_us") == 13);
+
+                const auto& last = recording.records.at(3);
+                CHECK(last.event == FlightEvent::Publish);
+                const auto topic = to_json(last).at("topic").get<std::string>();
+                CHECK(topic.size() == FlightRecord::topic_capacity);
+                CHECK(topic.substr(topic.size() - 3) == "end");
+                CHECK_FALSE(to_json(last).contains("call_id"));
+            }
+        }
+        std::filesystem::remove(file);
+    }
+    GIVEN("Data that is not a dump") {
+        std::istringstream stream("not a flight recorder dump, but long enough to fill the header of one........");
+        THEN("Decoding it should throw") {
+            CHECK_THROWS_AS(decode_flight_recording(stream), EverestInternalError);
+        }
+    }
+}
@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <chrono>
+#include <vector>
+
+#include <catch2/catch_all.hpp>
+
+#include <utils/in_flight_limit.hpp>
+
+using Everest::InFlightLimit;
+using Everest::InFlightOverflow;
+
+SCENARIO("Check in-flight limit", "[in_flight_limit]") {
+    GIVEN("A queueing limit of two calls") {
+        InFlightLimit limit(2, InFlightOverflow::Queue);
+        std::vector<int> started;
+        const auto start = [&started](int call) {
+            return [&started, call]() {
+                started.push_back(call);
+                return true;
+            };
+        };
+        CHECK(limit.admit(start(1)));
+        CHECK(limit.admit(start(2)));
+        CHECK(limit.admit(start(3)));
+        CHECK(limit.admit(start(4)));
+
+        THEN("Calls exceeding the limit should be started in order once slots become free") {
+            CHECK(started == std::vector<int>{1, 2});
+            CHECK(limit.get_stats().queued == 2);
+            limit.release();
+            CHECK(started == std::vector<int>{1, 2, 3});
+            limit.release();
+            limit.release();
+            limit.release();
+            const auto stats = limit.get_stats();
+            CHECK(started == std::vector<int>{1, 2, 3, 4});
+            CHECK(stats.in_flight == 0);
+            CHECK(stats.admitted == 4);
+        }
+
+        THEN("Waiting for a slot should give up at the deadline and its slot should be passed on") {
+            CHECK(not limit.acquire_until(std::chrono::steady_clock::now() + std::chrono::milliseconds(10)));
+            limit.release();
+            limit.release();
+            limit.release();
+            const auto stats = limit.get_stats();
+            CHECK(started == std::vector<int>{1, 2, 3, 4});
+            CHECK(stats.expired == 1);
+            CHECK(stats.in_flight == 1);
+        }
+    }
+
+    GIVEN("A rejecting limit of one call") {
+        InFlightLimit limit(1, InFlightOverflow::Reject);
+        CHECK(limit.acquire_until(std::chrono::steady_clock::now()));
+
+        THEN("Further calls should be rejected until the call finished") {
+            CHECK(not limit.admit([]() { return true; }));
+            CHECK(not limit.acquire_until(std::chrono::steady_clock::now() + std::chrono::seconds(1)));
+            CHECK(limit.get_stats().rejected == 2);
+            limit.release();
+            CHECK(limit.acquire_until(std::chrono::steady_clock::now()));
+        }
+    }
+}
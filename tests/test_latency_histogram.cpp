@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <chrono>
+
+#include <catch2/catch_all.hpp>
+
+#include <utils/latency_histogram.hpp>
+
+using namespace std::chrono_literals;
+
+SCENARIO("Check latency histogram percentiles", "[latency_histogram]") {
+    GIVEN("An empty histogram") {
+        Everest::LatencyHistogram histogram;
+        THEN("The summary should be empty") {
+            const auto summary = histogram.get_summary();
+            CHECK(summary.count == 0);
+            CHECK(summary.p99 == 0ns);
+        }
+    }
+    GIVEN("A histogram with uniformly distributed durations") {
+        Everest::LatencyHistogram histogram;
+        for (int i = 1; i <= 1000; i++) {
+            histogram.record(std::chrono::microseconds(i));
+        }
+        THEN("Percentiles should be at most 12.5% too large") {
+            const auto summary = histogram.get_summary();
+            CHECK(summary.count == 1000);
+            CHECK(summary.max == 1000us);
+            CHECK(summary.mean == 500500ns);
+            CHECK(summary.p50 >= 500us);
+            CHECK(summary.p50 <= 563us);
+            CHECK(summary.p99 >= 990us);
+            CHECK(summary.p99 <= 1000us);
+        }
+    }
+    GIVEN("Negative and huge durations") {
+        Everest::LatencyHistogram histogram;
+        histogram.record(-5ns);
+        histogram.record(std::chrono::hours(1));
+        THEN("They should be clamped instead of being lost") {
+            const auto summary = histogram.get_summary();
+            CHECK(summary.count == 2);
+            CHECK(summary.p50 == 0ns);
+            CHECK(summary.max == std::chrono::hours(1));
+        }
+    }
+}
@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <string>
+
+#include <catch2/catch_all.hpp>
+
+#include <utils/memory_accounting.hpp>
+
+using nlohmann::json;
+
+SCENARIO("Check the estimated memory of json documents", "[memory_accounting]") {
+    GIVEN("Scalar values") {
+        THEN("They only take the size of the node") {
+            CHECK(Everest::estimate_json_bytes(json(nullptr)) == sizeof(json));
+            CHECK(Everest::estimate_json_bytes(json(42)) == sizeof(json));
+            CHECK(Everest::estimate_json_bytes(json(true)) == sizeof(json));
+        }
+    }
+    GIVEN("A long string") {
+        const json value = std::string(1000, 'x');
+        THEN("Its characters are accounted") {
+            CHECK(Everest::estimate_json_bytes(value) > 1000);
+        }
+    }
+    GIVEN("Nested documents") {
+        json document = json::object();
+        for (int i = 0; i < 100; i++) {
+            document[std::to_string(i)] = {{"value", std::string(100, 'x')}, {"list", json::array({1, 2, 3})}};
+        }
+        THEN("The estimate grows with every element and is at least the size of the serialized document") {
+            const auto bytes = Everest::estimate_json_bytes(document);
+            CHECK(bytes > document.dump().size());
+            document["100"] = document.at("0");
+            CHECK(Everest::estimate_json_bytes(document) > bytes);
+        }
+    }
+}
+
+SCENARIO("Check the memory report", "[memory_accounting]") {
+    GIVEN("A report with two subsystems") {
+        Everest::MemoryReport report;
+        report.subsystems["config"].bytes = 1000;
+        report.subsystems["queues"].bytes = 24;
+        report.subsystems["queues"].details["received"] = 1;
+        THEN("The total is the sum of the subsystems") {
+            CHECK(report.total_bytes() == 1024);
+        }
+        THEN("It can be serialized with the details of every subsystem") {
+            const json serialized = report;
+            CHECK(serialized.at("total_bytes") == 1024);
+            CHECK(serialized.at("subsystems").at("config").at("bytes") == 1000);
+            CHECK(serialized.at("subsystems").at("queues").at("received") == 1);
+        }
+    }
+}
@@ -0,0 +1,331 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_all.hpp>
+
+#include <utils/message_queue.hpp>
+
+using Everest::Message;
+using Everest::MessageHandler;
+using Everest::MessagePool;
+using Everest::MessagePriority;
+using Everest::MessageQueue;
+
+static MessagePriority classify(const Message& message) {
+    if (message.topic == "cmd") {
+        return MessagePriority::Command;
+    }
+    return message.topic == "external" ? MessagePriority::External : MessagePriority::Var;
+}
+
+static void add(MessageQueue& queue, MessagePool& pool, const std::string& topic, const std::string& payload = "") {
+    queue.add(pool.acquire(topic.data(), topic.size(), payload.data(), payload.size()));
+}
+
+SCENARIO("Check message queue priority lanes", "[message_queue]") {
+    GIVEN("A message queue whose worker is busy while a var flood and a cmd result are added") {
+        MessagePool pool(64, 1024);
+        std::promise<void> release_worker;
+        auto worker_released = release_worker.get_future().share();
+        std::promise<void> all_delivered;
+        std::vector<std::string> delivered;
+        MessageQueue queue(
+            [&](const Message& message) {
+                if (message.topic == "blocker") {
+                    worker_released.wait();
+                    return;
+                }
+                delivered.push_back(message.topic);
+                if (delivered.size() == 32) {
+                    all_delivered.set_value();
+                }
+            },
+            {}, nullptr, classify);
+
+        add(queue, pool, "blocker");
+        // the worker picks up the blocker before the other messages are added
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        add(queue, pool, "external");
+        for (int i = 0; i < 30; i++) {
+            add(queue, pool, "var");
+        }
+        add(queue, pool, "cmd");
+        release_worker.set_value();
+        all_delivered.get_future().wait();
+
+        THEN("The cmd result should overtake the vars and external messages should not be starved") {
+            CHECK(delivered.front() == "cmd");
+            const auto external = std::find(delivered.begin(), delivered.end(), "external");
+            REQUIRE(external != delivered.end());
+            CHECK(std::distance(delivered.begin(), external) < 20);
+            CHECK(queue.get_stats().depth == 0);
+        }
+    }
+}
+
+SCENARIO("Check the message pool", "[message_queue]") {
+    GIVEN("A message pool keeping two messages of up to 16 bytes of payload") {
+        MessagePool pool(2, 16);
+        const std::string topic = "topic";
+        const std::string payload = "payload";
+        const auto acquire = [&pool, &topic](const std::string& payload) {
+            return pool.acquire(topic.data(), topic.size(), payload.data(), payload.size());
+        };
+
+        THEN("A released message should be handed out again without allocating") {
+            auto message = acquire(payload);
+            CHECK(message->topic == topic);
+            CHECK(message->payload == payload);
+            const auto* first = message.get();
+            message.reset();
+            CHECK(pool.get_stats().pooled == 1);
+
+            auto reused = acquire("other");
+            CHECK(reused.get() == first);
+            CHECK(reused->payload == "other");
+            const auto stats = pool.get_stats();
+            CHECK(stats.allocations == 1);
+            CHECK(stats.reuses == 1);
+            CHECK(stats.discarded == 0);
+            CHECK(stats.pooled == 0);
+        }
+
+        THEN("Messages should only be allocated while the pool is empty") {
+            auto first = acquire(payload);
+            auto second = acquire(payload);
+            first.reset();
+            second.reset();
+            auto third = acquire(payload);
+            auto fourth = acquire(payload);
+            auto fifth = acquire(payload);
+            const auto stats = pool.get_stats();
+            CHECK(stats.allocations == 3);
+            CHECK(stats.reuses == 2);
+            CHECK(stats.pooled == 0);
+        }
+
+        THEN("Messages exceeding the pooled capacity or the pool size should be discarded") {
+            acquire(std::string(64, 'x')).reset();
+            CHECK(pool.get_stats().discarded == 1);
+
+            auto first = acquire(payload);
+            auto second = acquire(payload);
+            auto third = acquire(payload);
+            first.reset();
+            second.reset();
+            third.reset();
+            const auto stats = pool.get_stats();
+            CHECK(stats.discarded == 2);
+            CHECK(stats.pooled == 2);
+        }
+    }
+}
+
+SCENARIO("Check result handlers", "[message_queue]") {
+    GIVEN("A message handler with a handler receiving all results") {
+        Everest::Executor executor(1, 1);
+        auto handler = std::make_shared<MessageHandler>(executor);
+        std::promise<std::string> received;
+        handler->add_handler(std::make_shared<TypedHandler>(
+            HandlerType::Result, std::make_shared<Handler>([&received](const std::string&, const json& data) {
+                received.set_value(data.at("id").get<std::string>());
+            })));
+
+        THEN("It should want results of any call, but no calls") {
+            CHECK(handler->wants_message({"authorize", "result", "call-1"}));
+            CHECK(not handler->wants_message({"authorize", "call", "call-1"}));
+            CHECK(not handler->filters_results());
+        }
+
+        THEN("It should receive results of any cmd") {
+            handler->add(std::make_shared<Everest::ParsedMessage>(Everest::ParsedMessage{
+                "module/cmd", {{"name", "authorize"}, {"type", "result"}, {"data", {{"id", "call-1"}}}}}));
+            CHECK(received.get_future().get() == "call-1");
+        }
+    }
+    GIVEN("A message handler with a handler receiving the result of a specific call") {
+        Everest::Executor executor(1, 1);
+        auto handler = std::make_shared<MessageHandler>(executor);
+        handler->add_handler(std::make_shared<TypedHandler>(
+            "authorize", "call-1", HandlerType::Result,
+            std::make_shared<Handler>([](const std::string&, const json&) {})));
+
+        THEN("Its messages should be filtered by the result id alone") {
+            CHECK(handler->filters_results());
+            CHECK(handler->wants_result("call-1"));
+            CHECK(not handler->wants_result("call-2"));
+        }
+    }
+}
+
+SCENARIO("Check external handlers", "[message_queue]") {
+    GIVEN("A message handler with a raw and a json handler for an external topic") {
+        Everest::Executor executor(1, 1);
+        auto handler = std::make_shared<MessageHandler>(executor);
+        std::promise<std::string> raw_received;
+        std::promise<json> json_received;
+        handler->add_handler(std::make_shared<TypedHandler>(
+            HandlerType::ExternalMQTT,
+            std::make_shared<RawHandler>([&raw_received](std::string_view topic, std::string_view payload) {
+                raw_received.set_value(std::string(topic) + " " + std::string(payload));
+            })));
+        handler->add_handler(std::make_shared<TypedHandler>(
+            HandlerType::ExternalMQTT, std::make_shared<Handler>([&json_received](const std::string&, json data) {
+                json_received.set_value(std::move(data));
+            })));
+
+        THEN("The raw handler should get the payload as is and the json handler the wrapped payload") {
+            auto message = std::make_shared<Everest::ParsedMessage>(Everest::ParsedMessage{"meter/power", {}});
+            message->raw = true;
+            message->payload = R"({"W": 42})";
+            handler->add(message);
+            CHECK(raw_received.get_future().get() == R"(meter/power {"W": 42})");
+            CHECK(json_received.get_future().get() == json(R"({"W": 42})"));
+        }
+    }
+}
+
+SCENARIO("Check handler accounting", "[message_queue]") {
+    GIVEN("A message handler with a budget of 10 ms and a var handler taking 30 ms") {
+        Everest::Executor executor(1, 1);
+        auto handler = std::make_shared<MessageHandler>(executor, Everest::QueueSettings{}, false, true,
+                                                        std::chrono::milliseconds(10));
+        std::promise<void> handled;
+        handler->add_handler(std::make_shared<TypedHandler>(
+            "power", HandlerType::SubscribeVar,
+            std::make_shared<Handler>([&handled](const std::string&, const json&) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(30));
+                handled.set_value();
+            })));
+
+        handler->add(std::make_shared<Everest::ParsedMessage>(
+            Everest::ParsedMessage{"module/var", {{"name", "power"}, {"data", 42}}}));
+        handled.get_future().wait();
+        // the accounting is updated right after the handler returned
+        for (int i = 0; i < 100 and handler->get_handler_accounting().at(0).calls == 0; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        THEN("The call should be accounted and exceed the budget") {
+            const auto accounting = handler->get_handler_accounting();
+            REQUIRE(accounting.size() == 1);
+            CHECK(accounting.at(0).name == "power");
+            CHECK(accounting.at(0).calls == 1);
+            CHECK(accounting.at(0).over_budget == 1);
+            CHECK(accounting.at(0).wall >= std::chrono::milliseconds(30));
+            // sleeping does not use any CPU time
+            CHECK(accounting.at(0).cpu < std::chrono::milliseconds(10));
+        }
+    }
+}
+
+SCENARIO("Check the var cache", "[message_queue]") {
+    GIVEN("A message handler caching vars, which received a var before anybody subscribed to it") {
+        Everest::Executor executor(1, 1);
+        auto handler = std::make_shared<MessageHandler>(executor, Everest::QueueSettings{}, false, false,
+                                                        std::chrono::nanoseconds{}, true);
+        // keeps the topic alive like the subscriptions of the requirements do
+        handler->add_handler(std::make_shared<TypedHandler>(
+            HandlerType::SubscribeVar, std::make_shared<Handler>([](const std::string&, const json&) {})));
+
+        THEN("It should want all vars, but no calls") {
+            CHECK(handler->wants_message({"power", "", ""}));
+            CHECK(not handler->wants_message({"authorize", "call", "call-1"}));
+        }
+
+        std::promise<void> cached;
+        handler->add_handler(std::make_shared<TypedHandler>(
+            "marker", HandlerType::SubscribeVar,
+            std::make_shared<Handler>([&cached](const std::string&, const json&) { cached.set_value(); })));
+        handler->add(std::make_shared<Everest::ParsedMessage>(
+            Everest::ParsedMessage{"module/var", {{"name", "power"}, {"data", 42}}}));
+        handler->add(std::make_shared<Everest::ParsedMessage>(
+            Everest::ParsedMessage{"module/var", {{"name", "marker"}, {"data", true}}}));
+        cached.get_future().wait();
+        // the marker is cached right after its handler returned
+        for (int i = 0; i < 100 and handler->count_cached_vars() < 2; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        REQUIRE(handler->count_cached_vars() == 2);
+
+        THEN("A handler subscribing later should get the cached value followed by newer ones") {
+            std::mutex received_mutex;
+            std::vector<int> received;
+            std::promise<void> all_received;
+            handler->add_handler(std::make_shared<TypedHandler>(
+                "power", HandlerType::SubscribeVar,
+                std::make_shared<Handler>([&](const std::string&, const json& data) {
+                    const std::lock_guard<std::mutex> lock(received_mutex);
+                    received.push_back(data.get<int>());
+                    if (received.size() == 2) {
+                        all_received.set_value();
+                    }
+                })));
+            handler->add(std::make_shared<Everest::ParsedMessage>(
+                Everest::ParsedMessage{"module/var", {{"name", "power"}, {"data", 43}}}));
+            all_received.get_future().wait();
+            const std::lock_guard<std::mutex> lock(received_mutex);
+            CHECK(received == std::vector<int>{42, 43});
+        }
+    }
+}
+
+TEST_CASE("Message queue benchmark", "[.][message_queue_benchmark]") {
+    constexpr auto producers = 4;
+    constexpr auto messages_per_producer = 100000;
+    constexpr auto total = std::size_t{producers * messages_per_producer};
+
+    MessagePool pool(1024, 1024);
+    std::vector<std::int64_t> latencies;
+    latencies.reserve(total);
+    std::promise<void> all_delivered;
+
+    const auto now = []() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    };
+
+    MessageQueue queue(
+        [&](const Message& message) {
+            std::int64_t enqueued = 0;
+            std::memcpy(&enqueued, message.payload.data(), sizeof(enqueued));
+            latencies.push_back(now() - enqueued);
+            if (latencies.size() == total) {
+                all_delivered.set_value();
+            }
+        },
+        {}, nullptr, classify);
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&]() {
+            const std::string topic = "var";
+            for (int i = 0; i < messages_per_producer; i++) {
+                const auto enqueued = now();
+                queue.add(pool.acquire(topic.data(), topic.size(), reinterpret_cast<const char*>(&enqueued),
+                                       sizeof(enqueued)));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    all_delivered.get_future().wait();
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::sort(latencies.begin(), latencies.end());
+    WARN(static_cast<std::size_t>(total / elapsed) << " messages/s, p50 " << latencies.at(total / 2) / 1000
+                                                   << " us, p99 " << latencies.at(total * 99 / 100) / 1000 << " us");
+}
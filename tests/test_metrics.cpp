@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <chrono>
+
+#include <catch2/catch_all.hpp>
+
+#include <everest/exceptions.hpp>
+#include <utils/metrics.hpp>
+
+using namespace std::chrono_literals;
+
+SCENARIO("Check metrics registry", "[metrics]") {
+    GIVEN("A registry with a counter, a gauge and a histogram") {
+        Everest::MetricsRegistry registry;
+        auto& calls = registry.counter("everest_calls", "Calls", {{"impl", "main"}});
+        auto& depth = registry.gauge("everest_queue_depth", "Queue depth");
+        auto& duration = registry.histogram("everest_duration_seconds", "Duration");
+        calls.increment();
+        calls.increment(2);
+        depth.set(5);
+        depth.add(-1.5);
+        duration.record(1ms);
+
+        THEN("Looking up a metric again should return the same metric") {
+            CHECK(&registry.counter("everest_calls", "Calls", {{"impl", "main"}}) == &calls);
+            CHECK(&registry.counter("everest_calls", "Calls", {{"impl", "other"}}) != &calls);
+            CHECK(calls.get() == 3);
+            CHECK(depth.get() == 3.5);
+        }
+        THEN("Registering a name as a different type should throw") {
+            CHECK_THROWS_AS(registry.gauge("everest_calls", "Calls"), Everest::EverestInternalError);
+        }
+        THEN("The snapshot should contain all metrics with the extra labels") {
+            const auto snapshot = registry.get_snapshot({{"module", "evse"}});
+            REQUIRE(snapshot.size() == 3);
+            CHECK(snapshot.at(0).at("name") == "everest_calls");
+            CHECK(snapshot.at(0).at("labels") == nlohmann::json({{"impl", "main"}, {"module", "evse"}}));
+            CHECK(snapshot.at(0).at("value") == 3);
+            CHECK(snapshot.at(1).at("type") == "summary");
+            CHECK(snapshot.at(1).at("count") == 1);
+        }
+    }
+}
+
+SCENARIO("Check OpenMetrics text format", "[metrics]") {
+    GIVEN("The snapshots of two modules") {
+        Everest::MetricsRegistry first;
+        Everest::MetricsRegistry second;
+        first.counter("everest_calls", "Calls of \"main\"").increment(4);
+        second.counter("everest_calls", "Calls of \"main\"").increment(2);
+        second.gauge("everest_depth", "Depth").set(1);
+        auto samples = first.get_snapshot({{"module", "a"}});
+        for (const auto& sample : second.get_snapshot({{"module", "b"}})) {
+            samples.push_back(sample);
+        }
+        THEN("Samples of a metric should be written as one family") {
+            CHECK(Everest::to_openmetrics(samples) == "# TYPE everest_calls counter\n"
+                                                       "# HELP everest_calls Calls of \\\"main\\\"\n"
+                                                       "everest_calls_total{module=\"a\"} 4\n"
+                                                       "everest_calls_total{module=\"b\"} 2\n"
+                                                       "# TYPE everest_depth gauge\n"
+                                                       "# HELP everest_depth Depth\n"
+                                                       "everest_depth{module=\"b\"} 1.0\n"
+                                                       "# EOF\n");
+        }
+    }
+}
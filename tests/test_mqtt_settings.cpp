@@ -0,0 +1,43 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <catch2/catch_all.hpp>
+
+#include <utils/mqtt_settings.hpp>
+
+using namespace Everest;
+
+SCENARIO("Check routing of topics to broker shards", "[mqtt_settings]") {
+    GIVEN("No broker shards") {
+        const std::vector<MQTTBrokerShard> shards;
+        THEN("Every topic should be carried by the main broker") {
+            CHECK(get_broker_connection(shards, "everest/modules/evse_1/impl/main/var") == 0);
+            CHECK(get_broker_connections(shards, "everest/#") == std::vector<std::size_t>{0});
+        }
+    }
+
+    GIVEN("Shards for external topics, all modules and a single module") {
+        std::vector<MQTTBrokerShard> shards(3);
+        shards.at(0).topic_prefixes = {"external/"};
+        shards.at(1).topic_prefixes = {"everest/modules/"};
+        shards.at(2).topic_prefixes = {"everest/modules/evse_2/"};
+
+        THEN("A topic should be carried by the shard with the longest matching prefix") {
+            CHECK(get_broker_connection(shards, "external/ocpp/status") == 1);
+            CHECK(get_broker_connection(shards, "everest/modules/evse_1/impl/main/var") == 2);
+            CHECK(get_broker_connection(shards, "everest/modules/evse_2/impl/main/var") == 3);
+            CHECK(get_broker_connection(shards, "everest/ready") == 0);
+            CHECK(get_broker_connection(shards, "everest/modules/evse_2") == 2);
+        }
+
+        THEN("A subscription should go to all brokers that could carry a matching topic") {
+            CHECK(get_broker_connections(shards, "everest/modules/evse_1/impl/main/var") ==
+                  std::vector<std::size_t>{2});
+            CHECK(get_broker_connections(shards, "everest/modules/+/impl/+/error/#") ==
+                  std::vector<std::size_t>{2, 3});
+            CHECK(get_broker_connections(shards, "everest/modules/evse_2/#") == std::vector<std::size_t>{2, 3});
+            CHECK(get_broker_connections(shards, "everest/modules/#") == std::vector<std::size_t>{0, 2, 3});
+            CHECK(get_broker_connections(shards, "#") == std::vector<std::size_t>{0, 1, 2, 3});
+            CHECK(get_broker_connections(shards, "external/+/status") == std::vector<std::size_t>{1});
+        }
+    }
+}
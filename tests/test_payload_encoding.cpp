@@ -0,0 +1,175 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <string>
+
+#include <catch2/catch_all.hpp>
+#include <nlohmann/json.hpp>
+
+#include <utils/payload_encoding.hpp>
+
+using Everest::MQTTPayloadEncoding;
+using json = nlohmann::json;
+
+static json sample_cmd_envelope() {
+    return {{"name", "set_charging_current"},
+            {"type", "call"},
+            {"data",
+             {{"id", "3f1a2b4c-5d6e-7f80-91a2-b3c4d5e6f708"},
+              {"origin", "evse_manager_1"},
+              {"args", {{"max_current", 16.5}, {"phases", 3}, {"enabled", true}}}}}};
+}
+
+SCENARIO("Check payload encoding round trips", "[payload_encoding]") {
+    GIVEN("A cmd envelope") {
+        const auto envelope = sample_cmd_envelope();
+        THEN("It should be decoded unchanged from every encoding") {
+            for (const auto encoding :
+                 {MQTTPayloadEncoding::Json, MQTTPayloadEncoding::Cbor, MQTTPayloadEncoding::MessagePack}) {
+                const auto payload = Everest::encode_payload(envelope, encoding);
+                CHECK(Everest::is_binary_payload(payload) == (encoding != MQTTPayloadEncoding::Json));
+                CHECK(Everest::decode_payload(payload) == envelope);
+            }
+        }
+        THEN("Binary encodings should be smaller than JSON") {
+            const auto json_size = Everest::encode_payload(envelope, MQTTPayloadEncoding::Json).size();
+            CHECK(Everest::encode_payload(envelope, MQTTPayloadEncoding::Cbor).size() < json_size);
+            CHECK(Everest::encode_payload(envelope, MQTTPayloadEncoding::MessagePack).size() < json_size);
+        }
+        THEN("Encoding into a reused buffer should replace its contents and keep its capacity") {
+            std::string payload(4096, 'x');
+            const auto capacity = payload.capacity();
+            for (const auto encoding :
+                 {MQTTPayloadEncoding::Json, MQTTPayloadEncoding::Cbor, MQTTPayloadEncoding::MessagePack}) {
+                Everest::encode_payload(envelope, encoding, payload);
+                CHECK(payload == Everest::encode_payload(envelope, encoding));
+                CHECK(payload.capacity() == capacity);
+            }
+        }
+    }
+    GIVEN("Payloads that are not envelopes") {
+        THEN("Scalars and strings should round trip as well") {
+            for (const auto& value : {json(true), json("2024-01-01T00:00:00.000Z"), json(nullptr), json(42)}) {
+                CHECK(Everest::decode_payload(Everest::encode_payload(value, MQTTPayloadEncoding::Cbor)) == value);
+            }
+        }
+    }
+    GIVEN("Invalid payloads") {
+        THEN("Decoding should throw") {
+            CHECK_THROWS(Everest::decode_payload("{\"name\":"));
+            CHECK_THROWS(Everest::decode_payload(std::string{'\0', 'X', 'a'}));
+        }
+    }
+    GIVEN("A large interface definition") {
+        json interface = {{"description", "Interface of a power meter"}, {"vars", json::object()}};
+        for (int i = 0; i < 50; i++) {
+            interface["vars"]["value_" + std::to_string(i)] = {
+                {"description", "Measured value"}, {"type", "object"}, {"$ref", "/powermeter#/Powermeter"}};
+        }
+        THEN("It should be decoded unchanged after compressing its JSON or CBOR encoding") {
+            for (const auto encoding : {MQTTPayloadEncoding::Json, MQTTPayloadEncoding::Cbor}) {
+                const auto payload = Everest::encode_payload(interface, encoding);
+                const auto compressed = Everest::compress_payload(payload);
+                CHECK(Everest::is_binary_payload(compressed));
+                CHECK(compressed.at(1) == Everest::DEFLATE_PAYLOAD_IDENTIFIER);
+                CHECK(compressed.size() < payload.size() / 4);
+                CHECK(Everest::decode_payload(compressed) == interface);
+            }
+        }
+        THEN("Truncated compressed payloads should not be decoded") {
+            const auto compressed = Everest::compress_payload(interface.dump());
+            CHECK_THROWS(Everest::decode_payload(compressed.substr(0, compressed.size() / 2)));
+        }
+    }
+    GIVEN("A small payload") {
+        THEN("It should not be compressed") {
+            const auto payload = sample_cmd_envelope().dump();
+            CHECK(Everest::compress_payload(payload) == payload);
+        }
+    }
+    GIVEN("Encoding names") {
+        THEN("They should be converted in both directions") {
+            CHECK(Everest::string_to_payload_encoding("msgpack") == MQTTPayloadEncoding::MessagePack);
+            CHECK(Everest::payload_encoding_to_string(MQTTPayloadEncoding::Cbor) == "cbor");
+            CHECK_THROWS(Everest::string_to_payload_encoding("xml"));
+        }
+    }
+}
+
+// run with: everest-framework_tests "[payload_encoding_benchmark]"
+SCENARIO("Check lazy envelope decoding", "[payload_encoding]") {
+    GIVEN("A result envelope") {
+        const json result = {{"name", "set_charging_current"},
+                             {"type", "result"},
+                             {"data", {{"id", "3f1a2b4c"}, {"retval", {{"id", "nested"}, {"name", "nested"}}}}}};
+        THEN("Name, type and id should be extracted from every encoding") {
+            for (const auto encoding :
+                 {MQTTPayloadEncoding::Json, MQTTPayloadEncoding::Cbor, MQTTPayloadEncoding::MessagePack}) {
+                Everest::PayloadEnvelope envelope;
+                CHECK(Everest::decode_payload_envelope(Everest::encode_payload(result, encoding), envelope));
+                CHECK(envelope.name == "set_charging_current");
+                CHECK(envelope.type == "result");
+                CHECK(envelope.id == "3f1a2b4c");
+            }
+        }
+        THEN("The id alone should be extracted from every encoding") {
+            for (const auto encoding :
+                 {MQTTPayloadEncoding::Json, MQTTPayloadEncoding::Cbor, MQTTPayloadEncoding::MessagePack}) {
+                std::string id;
+                CHECK(Everest::decode_payload_id(Everest::encode_payload(result, encoding), id));
+                CHECK(id == "3f1a2b4c");
+            }
+        }
+        THEN("The envelope of the decoded message should match the lazily decoded one") {
+            const auto envelope = Everest::get_payload_envelope(result);
+            CHECK(envelope.name == "set_charging_current");
+            CHECK(envelope.type == "result");
+            CHECK(envelope.id == "3f1a2b4c");
+        }
+    }
+    GIVEN("A payload whose data body is cut off after its id") {
+        THEN("The id should be extracted without parsing the rest") {
+            std::string id;
+            CHECK(Everest::decode_payload_id(R"({"data":{"id":"abc","retval":)", id));
+            CHECK(id == "abc");
+        }
+    }
+    GIVEN("A var envelope with a scalar data body") {
+        THEN("The id should stay empty") {
+            Everest::PayloadEnvelope envelope;
+            CHECK(Everest::decode_payload_envelope(R"({"data":"abc","name":"state","type":"var"})", envelope));
+            CHECK(envelope.name == "state");
+            CHECK(envelope.type == "var");
+            CHECK(envelope.id.empty());
+        }
+        THEN("The envelope of the decoded message should have no id either") {
+            const auto envelope = Everest::get_payload_envelope(json::parse(R"({"data":"abc","name":"state"})"));
+            CHECK(envelope.name == "state");
+            CHECK(envelope.type.empty());
+            CHECK(envelope.id.empty());
+        }
+    }
+    GIVEN("An invalid payload") {
+        THEN("Decoding should fail") {
+            Everest::PayloadEnvelope envelope;
+            CHECK_FALSE(Everest::decode_payload_envelope(R"({"data":{"id":"abc"},"name":)", envelope));
+        }
+    }
+}
+
+TEST_CASE("Payload encoding benchmark", "[.][payload_encoding_benchmark]") {
+    const auto envelope = sample_cmd_envelope();
+
+    for (const auto encoding :
+         {MQTTPayloadEncoding::Json, MQTTPayloadEncoding::Cbor, MQTTPayloadEncoding::MessagePack}) {
+        const auto name = Everest::payload_encoding_to_string(encoding);
+        const auto payload = Everest::encode_payload(envelope, encoding);
+        WARN(name << ": " << payload.size() << " bytes per message");
+
+        BENCHMARK("encode " + name) {
+            return Everest::encode_payload(envelope, encoding);
+        };
+        BENCHMARK("decode " + name) {
+            return Everest::decode_payload(payload);
+        };
+    }
+}
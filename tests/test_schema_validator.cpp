@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <memory>
+#include <string>
+
+#include <catch2/catch_all.hpp>
+#include <nlohmann/json-schema.hpp>
+
+#include <utils/schema_validator.hpp>
+#include <utils/yaml_loader.hpp>
+
+using Everest::SchemaValidator;
+using json = nlohmann::json;
+
+namespace native_validators = Everest::native_validators;
+
+/// \returns a validator interpreting the schema of the var \p var_name of the test_interface_validators interface
+static SchemaValidator get_interpreted_validator(const std::string& var_name) {
+    const std::string source_dir = EVEREST_TEST_SOURCE_DIR;
+    const json interface = Everest::load_yaml(source_dir + "/test_interfaces/test_interface_validators.yaml");
+    auto validator = std::make_unique<nlohmann::json_schema::json_validator>(
+        [source_dir](const nlohmann::json_uri& uri, json& schema) {
+            schema = Everest::load_yaml(source_dir + "/test_types" + uri.path() + ".yaml").at("types");
+        },
+        nlohmann::json_schema::default_string_format_check);
+    validator->set_root_schema(interface.at("vars").at(var_name));
+    return SchemaValidator(std::move(validator));
+}
+
+static bool is_valid(const SchemaValidator& validator, const json& value) {
+    try {
+        validator.validate(value);
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+SCENARIO("Check generated validators", "[schema_validator]") {
+    GIVEN("The generated and the interpreted validator of a var") {
+        const auto native = native_validators::get("test_interface_validators", "vars/limits");
+        REQUIRE(native != nullptr);
+        const SchemaValidator generated(native);
+        const auto interpreted = get_interpreted_validator("limits");
+        CHECK(generated.is_native());
+
+        THEN("They should accept and reject the same values") {
+            const auto value = GENERATE(
+                json::parse(R"({"current": 16})"), json::parse(R"({"current": 16.0, "phases": 3.0})"),
+                json::parse(R"({"current": 0, "label": "A1", "tags": ["a", "b"]})"),
+                json::parse(R"({"current": 16, "object": {"first": 1, "second": "x"}})"), json::parse(R"({})"),
+                json::parse(R"({"current": -1})"), json::parse(R"({"current": 64})"),
+                json::parse(R"({"current": "16"})"), json::parse(R"({"current": 16, "phases": 2})"),
+                json::parse(R"({"current": 16, "label": ""})"), json::parse(R"({"current": 16, "label": "ABCDE"})"),
+                json::parse(R"({"current": 16, "label": "a"})"), json::parse(R"({"current": 16, "tags": ["a", "a"]})"),
+                json::parse(R"({"current": 16, "tags": ["a", "b", "c"]})"),
+                json::parse(R"({"current": 16, "tags": [1]})"), json::parse(R"({"current": 16, "unknown": 1})"),
+                json::parse(R"({"current": 16, "object": {"first": "1"}})"),
+                json::parse(R"({"current": 16, "object": {"third": 3}})"), json::parse(R"([16])"));
+            CAPTURE(value);
+            CHECK(is_valid(generated, value) == is_valid(interpreted, value));
+        }
+    }
+    GIVEN("A var using a keyword that is not supported by the generator") {
+        THEN("No validator should have been generated") {
+            CHECK(native_validators::get("test_interface_validators", "vars/choice") == nullptr);
+            CHECK(native_validators::get("unknown_interface", "vars/limits") == nullptr);
+        }
+    }
+}
@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <catch2/catch_all.hpp>
+
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <nlohmann/json.hpp>
+
+#include <utils/status_fifo.hpp>
+
+using namespace Everest;
+
+namespace {
+/// \returns all lines written to the fifo read from \p fd
+std::vector<std::string> read_lines(int fd) {
+    std::string data;
+    char buffer[4096];
+    ssize_t size = 0;
+    while ((size = read(fd, buffer, sizeof(buffer))) > 0) {
+        data.append(buffer, size);
+    }
+    std::vector<std::string> lines;
+    std::istringstream stream(data);
+    for (std::string line; std::getline(stream, line);) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+} // namespace
+
+SCENARIO("Check the status fifo", "[status_fifo]") {
+    const auto path = (std::filesystem::temp_directory_path() / "everest_test_status_fifo").string();
+    std::filesystem::remove(path);
+    REQUIRE(mkfifo(path.c_str(), 0600) == 0);
+    const auto reader = open(path.c_str(), O_RDONLY | O_NONBLOCK);
+    REQUIRE(reader != -1);
+
+    GIVEN("A status fifo with structured messages") {
+        {
+            auto status_fifo = StatusFifo::create_from_path(path, true);
+            status_fifo.report("module_state", "evse", {{"state", "spawned"}});
+            status_fifo.update(StatusFifo::ALL_MODULES_STARTED);
+            // the fifo is written completely before it is closed
+        }
+
+        THEN("Text and JSON lines are written in order") {
+            const auto lines = read_lines(reader);
+            REQUIRE(lines.size() == 2);
+            const auto state = nlohmann::json::parse(lines.at(0));
+            CHECK(state.at("type") == "module_state");
+            CHECK(state.at("module") == "evse");
+            CHECK(state.at("state") == "spawned");
+            CHECK(lines.at(1) == "ALL_MODULES_STARTED");
+        }
+    }
+
+    GIVEN("A status fifo with text messages only") {
+        {
+            auto status_fifo = StatusFifo::create_from_path(path);
+            status_fifo.report("module_state", "evse", {{"state", "spawned"}});
+            status_fifo.update(StatusFifo::WAITING_FOR_STANDALONE_MODULES);
+        }
+
+        THEN("Structured messages are not written") {
+            const auto lines = read_lines(reader);
+            REQUIRE(lines.size() == 1);
+            CHECK(lines.at(0) == "WAITING_FOR_STANDALONE_MODULES");
+        }
+    }
+
+    close(reader);
+    std::filesystem::remove(path);
+}
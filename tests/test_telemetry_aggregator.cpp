@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <catch2/catch_all.hpp>
+
+#include <utils/telemetry_aggregator.hpp>
+
+using json = nlohmann::json;
+
+SCENARIO("Check telemetry aggregation", "[telemetry_aggregator]") {
+    GIVEN("An empty aggregator") {
+        Everest::TelemetryAggregator aggregator;
+        THEN("Flushing should return an empty batch") {
+            CHECK(aggregator.flush().empty());
+        }
+    }
+    GIVEN("An aggregator with samples of two topics") {
+        Everest::TelemetryAggregator aggregator;
+        aggregator.add("power/1/meter", "Measurement", {{"power", 10}, {"state", "charging"}});
+        aggregator.add("power/1/meter", "Measurement", {{"power", 31.5}, {"state", "paused"}});
+        aggregator.add("power/1/meter", "Measurement", {{"power", 3.5}, {"enabled", true}});
+        aggregator.add("temperature/1/board", "Measurement", {{"celsius", -4}});
+        THEN("Numeric values should be aggregated and the last value should be kept of all values") {
+            const auto batch = aggregator.flush();
+            REQUIRE(batch.size() == 2);
+            const auto& meter = batch.at(0);
+            CHECK(meter.at("topic") == "power/1/meter");
+            CHECK(meter.at("type") == "Measurement");
+            CHECK(meter.at("count") == 3);
+            const auto& power = meter.at("values").at("power");
+            CHECK(power.at("last") == 3.5);
+            CHECK(power.at("min") == 3.5);
+            CHECK(power.at("max") == 31.5);
+            CHECK(power.at("avg") == 15.0);
+            CHECK(power.at("count") == 3);
+            CHECK(meter.at("values").at("state") == json({{"last", "paused"}}));
+            CHECK(meter.at("values").at("enabled") == json({{"last", true}}));
+            CHECK(batch.at(1).at("values").at("celsius").at("min") == -4.0);
+        }
+        THEN("A flush should start the next interval") {
+            aggregator.flush();
+            CHECK(aggregator.flush().empty());
+            aggregator.add("power/1/meter", "Measurement", {{"power", 7}});
+            const auto batch = aggregator.flush();
+            REQUIRE(batch.size() == 1);
+            CHECK(batch.at(0).at("count") == 1);
+            CHECK(batch.at(0).at("values").at("power").at("max") == 7.0);
+        }
+    }
+}
@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_all.hpp>
+
+#include <utils/topic_trie.hpp>
+
+static std::vector<std::string> matches(const Everest::TopicTrie& trie, const std::string& topic) {
+    std::vector<const std::string*> found;
+    trie.find_matches(topic, found);
+    std::vector<std::string> result;
+    std::transform(found.begin(), found.end(), std::back_inserter(result), [](const auto* t) { return *t; });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+SCENARIO("Check topic wildcard detection", "[topic_trie]") {
+    GIVEN("Topics with and without wildcards") {
+        THEN("Only complete wildcard levels should be detected") {
+            CHECK(Everest::contains_wildcards("a/+/c"));
+            CHECK(Everest::contains_wildcards("a/#"));
+            CHECK(Everest::contains_wildcards("#"));
+            CHECK_FALSE(Everest::contains_wildcards("a/b/c"));
+            CHECK_FALSE(Everest::contains_wildcards("a/b+/c"));
+            CHECK_FALSE(Everest::contains_wildcards("a/b#"));
+        }
+    }
+}
+
+SCENARIO("Check topic trie matching", "[topic_trie]") {
+    GIVEN("A trie with single and multi level wildcard topics") {
+        Everest::TopicTrie trie;
+        trie.insert("a/+/c");
+        trie.insert("a/#");
+        trie.insert("+/b/+");
+        trie.insert("#");
+        trie.insert("x/y");
+
+        THEN("It should contain all inserted topics") {
+            CHECK(trie.size() == 5);
+        }
+        THEN("Single level wildcards should match exactly one level") {
+            CHECK(matches(trie, "a/b/c") == std::vector<std::string>{"#", "+/b/+", "a/#", "a/+/c"});
+            CHECK(matches(trie, "a/b/c/d") == std::vector<std::string>{"#", "a/#"});
+        }
+        THEN("Multi level wildcards should also match the parent level") {
+            CHECK(matches(trie, "a") == std::vector<std::string>{"#", "a/#"});
+        }
+        THEN("Verbatim topics should only match themselves") {
+            CHECK(matches(trie, "x/y") == std::vector<std::string>{"#", "x/y"});
+            CHECK(matches(trie, "x/y/z") == std::vector<std::string>{"#"});
+        }
+        WHEN("Topics are removed") {
+            trie.remove("#");
+            trie.remove("a/+/c");
+            trie.remove("not/inserted");
+            THEN("They should no longer match") {
+                CHECK(trie.size() == 3);
+                CHECK(matches(trie, "a/b/c") == std::vector<std::string>{"+/b/+", "a/#"});
+                CHECK(matches(trie, "q/r/s").empty());
+            }
+        }
+    }
+    GIVEN("A topic inserted twice") {
+        Everest::TopicTrie trie;
+        trie.insert("a/+");
+        trie.insert("a/+");
+        THEN("It should only be stored once") {
+            CHECK(trie.size() == 1);
+            CHECK(matches(trie, "a/b") == std::vector<std::string>{"a/+"});
+        }
+    }
+}
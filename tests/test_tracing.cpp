@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <catch2/catch_all.hpp>
+
+#include <utils/tracing.hpp>
+
+using namespace Everest::tracing;
+
+SCENARIO("Check trace context propagation", "[tracing]") {
+    GIVEN("A trace context") {
+        const TraceContext context{0x0123456789abcdef, 0x42};
+        THEN("It should survive the round trip through its text form") {
+            const auto text = to_string(context);
+            CHECK(text == "0123456789abcdef-0000000000000042");
+            const auto parsed = from_string(text);
+            CHECK(parsed.trace_id == context.trace_id);
+            CHECK(parsed.span_id == context.span_id);
+        }
+        THEN("Malformed text should give an invalid context") {
+            CHECK_FALSE(from_string("").is_valid());
+            CHECK_FALSE(from_string("0123456789abcdef+0000000000000042").is_valid());
+            CHECK_FALSE(from_string("0123456789abcdeg-0000000000000042").is_valid());
+        }
+        THEN("Spans in its scope should be children of it") {
+            const ScopedContext scope(context);
+            {
+                const Span span("test", false);
+                CHECK(span.get_context().trace_id == context.trace_id);
+                CHECK(span.get_context().span_id != context.span_id);
+                CHECK(current().span_id == span.get_context().span_id);
+            }
+            CHECK(current().span_id == context.span_id);
+        }
+    }
+    GIVEN("No current context and no sampling") {
+        Tracer::get().configure({});
+        THEN("Spans should not be traced") {
+            const Span span("test");
+            CHECK_FALSE(span.get_context().is_valid());
+            CHECK_FALSE(current().is_valid());
+        }
+    }
+    GIVEN("A tracer sampling every trace") {
+        TracingSettings settings;
+        settings.sample_rate = 1.0;
+        settings.file = "unused";
+        settings.max_spans = 2;
+        Tracer::get().configure(settings);
+        THEN("Nested spans should be recorded in one trace, only the most recent spans should be kept") {
+            {
+                Span outer("cmd");
+                outer.set_name("outer");
+                {
+                    Span inner("publish");
+                    inner.set_name("inner");
+                    CHECK(inner.get_context().trace_id == outer.get_context().trace_id);
+                }
+                Span last("publish");
+            }
+            const auto events = Tracer::get().get_chrome_trace().at("traceEvents");
+            REQUIRE(events.size() == 2);
+            CHECK(events.at(0).at("name") == "publish");
+            CHECK(events.at(1).at("name") == "outer");
+            CHECK(events.at(1).at("ph") == "X");
+            CHECK(events.at(0).at("args").at("parent_id") == events.at(1).at("args").at("span_id"));
+        }
+        Tracer::get().configure({});
+    }
+}
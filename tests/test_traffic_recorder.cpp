@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <catch2/catch_all.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <everest/exceptions.hpp>
+#include <utils/traffic_recorder.hpp>
+
+using namespace Everest;
+
+SCENARIO("Check the traffic recorder", "[traffic_recorder]") {
+    const auto file = (std::filesystem::temp_directory_path() / "everest_test_traffic_recorder.bin").string();
+
+    GIVEN("A recording of received and published messages") {
+        {
+            TrafficRecorder recorder({file, 1024 * 1024}, "test_module");
+            recorder.record(TrafficDirection::Received, "everest/test_module/main/cmd", R"({"name":"get"})");
+            recorder.record(TrafficDirection::Published, "everest/caller/res", std::string("\0C\x01", 3));
+            CHECK(recorder.get_recorded() == 2);
+        }
+
+        THEN("The reader should give the messages in order with their payloads as is") {
+            std::ifstream stream(file, std::ios::binary);
+            TrafficReader reader(stream);
+            CHECK(reader.get_module_id() == "test_module");
+            CHECK(reader.get_start_timestamp_ns() > 0);
+
+            const auto first = reader.next();
+            REQUIRE(first.has_value());
+            CHECK(first->direction == TrafficDirection::Received);
+            CHECK(first->topic == "everest/test_module/main/cmd");
+            CHECK(first->payload == R"({"name":"get"})");
+
+            const auto second = reader.next();
+            REQUIRE(second.has_value());
+            CHECK(second->direction == TrafficDirection::Published);
+            CHECK(second->payload == std::string("\0C\x01", 3));
+            CHECK(second->offset >= first->offset);
+
+            CHECK_FALSE(reader.next().has_value());
+        }
+    }
+
+    GIVEN("A recorder with a size limit") {
+        {
+            TrafficRecorder recorder({file, 100}, "test_module");
+            for (int i = 0; i < 10; ++i) {
+                recorder.record(TrafficDirection::Received, "everest/topic", "payload");
+            }
+            THEN("Recording should stop at the limit") {
+                CHECK(recorder.get_recorded() < 10);
+            }
+        }
+    }
+
+    GIVEN("A file that is no recording") {
+        std::istringstream stream("no recording");
+        THEN("The reader should throw") {
+            CHECK_THROWS_AS(TrafficReader(stream), EverestInternalError);
+        }
+    }
+
+    std::filesystem::remove(file);
+}
@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <chrono>
+
+#include <catch2/catch_all.hpp>
+
+#include <utils/validation_policy.hpp>
+
+using Everest::ValidationMode;
+using Everest::ValidationPolicy;
+using Everest::ValidationSampler;
+
+static int count_validated(ValidationSampler& sampler, int messages) {
+    int validated = 0;
+    for (int i = 0; i < messages; i++) {
+        if (sampler.should_validate()) {
+            validated++;
+        }
+    }
+    return validated;
+}
+
+SCENARIO("Check validation sampling", "[validation_policy]") {
+    GIVEN("A policy validating the first 5 messages") {
+        ValidationSampler sampler({ValidationMode::FirstN, 5, 1}, false);
+        THEN("Only the first 5 messages should be validated") {
+            CHECK(sampler.should_validate());
+            CHECK(count_validated(sampler, 99) == 4);
+            CHECK(not sampler.should_validate());
+        }
+    }
+    GIVEN("A policy validating every 10th message") {
+        ValidationSampler sampler({ValidationMode::Sample, 0, 10}, true);
+        THEN("The first and every 10th message after it should be validated") {
+            CHECK(sampler.should_validate());
+            CHECK(count_validated(sampler, 98) == 9);
+            CHECK(not sampler.should_validate());
+        }
+    }
+    GIVEN("A policy validating only sent messages") {
+        const ValidationPolicy policy{ValidationMode::Publisher};
+        ValidationSampler sent(policy, true);
+        ValidationSampler received(policy, false);
+        THEN("Received messages should never be validated") {
+            CHECK(count_validated(sent, 10) == 10);
+            CHECK(count_validated(received, 10) == 0);
+        }
+    }
+    GIVEN("A serialized policy") {
+        const nlohmann::json serialized = ValidationPolicy{ValidationMode::Sample, 3, 7, true};
+        THEN("It should be restored") {
+            CHECK(serialized.at("mode") == "sample");
+            const auto policy = serialized.get<ValidationPolicy>();
+            CHECK(policy.mode == ValidationMode::Sample);
+            CHECK(policy.first_n == 3);
+            CHECK(policy.sample_rate == 7);
+            CHECK(policy.asynchronous);
+        }
+    }
+}
+
+SCENARIO("Check validation cost accounting", "[validation_policy]") {
+    GIVEN("A cost with a valid and an invalid message") {
+        Everest::ValidationCost cost;
+        cost.record(std::chrono::microseconds(10), true);
+        cost.record(std::chrono::microseconds(30), false);
+        THEN("Both should be accounted") {
+            const auto stats = cost.get_stats();
+            CHECK(stats.validations == 2);
+            CHECK(stats.failures == 1);
+            CHECK(stats.total == std::chrono::microseconds(40));
+            CHECK(stats.max == std::chrono::microseconds(30));
+            CHECK(nlohmann::json(stats).at("mean_us") == 20.0);
+        }
+    }
+}
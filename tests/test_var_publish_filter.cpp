@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <chrono>
+#include <functional>
+
+#include <catch2/catch_all.hpp>
+
+#include <utils/var_publish_filter.hpp>
+
+using namespace Everest;
+using namespace std::chrono_literals;
+
+SCENARIO("Check var publish filter", "[var_publish_filter]") {
+    const auto start = VarChangeFilter::clock::now();
+    const auto hash = [](const nlohmann::json& value) { return std::hash<nlohmann::json>{}(value); };
+
+    GIVEN("A module without var publishing settings") {
+        const auto settings = VarPublishSettings::parse(nlohmann::json::object());
+        THEN("Every var should be published") {
+            CHECK_FALSE(settings.get_limits("main", "voltage").change_only);
+        }
+    }
+
+    GIVEN("A module publishing a single var change only") {
+        const auto settings = VarPublishSettings::parse(nlohmann::json::parse(R"({
+            "var_publishing": {"refresh_interval_ms": 1000, "vars": {"main/voltage": {"change_only": true}}}
+        })"));
+        THEN("Only that var should be filtered and inherit the refresh interval") {
+            const auto& limits = settings.get_limits("main", "voltage");
+            CHECK(limits.change_only);
+            CHECK(limits.refresh_interval == 1000ms);
+            CHECK_FALSE(settings.get_limits("main", "current").change_only);
+            CHECK_FALSE(settings.get_limits("other", "voltage").change_only);
+        }
+    }
+
+    GIVEN("A change only filter without refresh interval") {
+        VarChangeFilter filter({true, 0ms});
+        THEN("Only changed values should be published") {
+            CHECK(filter.should_publish(hash({{"voltage", 230}}), start));
+            CHECK_FALSE(filter.should_publish(hash({{"voltage", 230}}), start + 1h));
+            CHECK(filter.should_publish(hash({{"voltage", 231}}), start + 2h));
+            CHECK(filter.should_publish(hash({{"voltage", 230}}), start + 3h));
+            CHECK(filter.get_suppressed() == 1);
+        }
+    }
+
+    GIVEN("A change only filter with a refresh interval") {
+        VarChangeFilter filter({true, 1000ms});
+        THEN("Unchanged values should be published once the refresh interval passed") {
+            CHECK(filter.should_publish(hash(true), start));
+            CHECK_FALSE(filter.should_publish(hash(true), start + 999ms));
+            CHECK(filter.should_publish(hash(true), start + 1000ms));
+            CHECK_FALSE(filter.should_publish(hash(true), start + 1500ms));
+            CHECK(filter.get_suppressed() == 2);
+        }
+    }
+}
@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_all.hpp>
+
+#include <tests/helpers.hpp>
+#include <utils/yaml_loader.hpp>
+
+namespace fs = std::filesystem;
+
+/// \returns the path of a yaml file with the given \p content, created next to the test binary
+static fs::path write_yaml(const std::string& name, const std::string& content) {
+    const auto path = Everest::tests::get_bin_dir() / (name + ".yaml");
+    std::ofstream(path) << content;
+    return path;
+}
+
+SCENARIO("Check yaml loading", "[yaml_loader]") {
+    GIVEN("A yaml file with all kinds of scalars") {
+        const auto path = write_yaml("yaml_loader_scalars", R"(integer: 42
+negative: -7
+large: 9007199254740993
+number: 2.5
+yes: true
+no: false
+null_value: null
+empty:
+quoted_integer: "42"
+quoted_bool: 'true'
+escaped: "tab\there"
+text: hello there
+list: [1, two, 3.5]
+nested:
+  z: 1
+  a: 2
+)");
+        const auto json = Everest::load_yaml(path);
+        THEN("Unquoted numbers and booleans should be converted") {
+            CHECK(json.at("integer") == 42);
+            CHECK(json.at("negative") == -7);
+            CHECK(json.at("large").get<std::int64_t>() == 9007199254740993);
+            CHECK(json.at("number") == 2.5);
+            CHECK(json.at("yes") == true);
+            CHECK(json.at("no") == false);
+            CHECK(json.at("null_value").is_null());
+            CHECK(json.at("empty").is_null());
+        }
+        THEN("Quoted scalars should stay strings") {
+            CHECK(json.at("quoted_integer") == "42");
+            CHECK(json.at("quoted_bool") == "true");
+            CHECK(json.at("escaped") == "tab\there");
+            CHECK(json.at("text") == "hello there");
+        }
+        THEN("Sequences and maps should keep their order") {
+            CHECK(json.at("list") == nlohmann::ordered_json::array({1, "two", 3.5}));
+            CHECK(json.at("nested").begin().key() == "z");
+        }
+    }
+    GIVEN("An empty yaml file") {
+        const auto path = write_yaml("yaml_loader_empty", "");
+        THEN("It should be loaded as null") {
+            CHECK(Everest::load_yaml(path).is_null());
+        }
+    }
+    GIVEN("A broken yaml file") {
+        const auto path = write_yaml("yaml_loader_broken", "key: [1, 2\n");
+        THEN("It should throw") {
+            CHECK_THROWS(Everest::load_yaml(path));
+        }
+    }
+    GIVEN("A yaml file that does not exist") {
+        THEN("It should throw") {
+            CHECK_THROWS(Everest::load_yaml(Everest::tests::get_bin_dir() / "yaml_loader_missing.yaml"));
+        }
+    }
+}
+
+TEST_CASE("Yaml loader benchmark", "[.][yaml_loader_benchmark]") {
+    // loads the schemas and test interfaces, EV_YAML_BENCHMARK_DIR can point to a full set of interfaces and types
+    const fs::path source_dir = EVEREST_TEST_SOURCE_DIR;
+    std::vector<fs::path> dirs{source_dir / ".." / "schemas", source_dir / "test_interfaces",
+                               source_dir / "test_types"};
+    // NOLINTNEXTLINE(concurrency-mt-unsafe): not problematic that this function is not threadsafe here
+    if (const auto* benchmark_dir = std::getenv("EV_YAML_BENCHMARK_DIR")) {
+        dirs.emplace_back(benchmark_dir);
+    }
+
+    std::vector<fs::path> files;
+    std::uintmax_t bytes = 0;
+    for (const auto& dir : dirs) {
+        for (const auto& entry : fs::recursive_directory_iterator(dir)) {
+            if (entry.is_regular_file() and entry.path().extension() == ".yaml") {
+                files.push_back(entry.path());
+                bytes += entry.file_size();
+            }
+        }
+    }
+    REQUIRE(not files.empty());
+
+    constexpr auto rounds = 100;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        for (const auto& file : files) {
+            Everest::load_yaml(file);
+        }
+    }
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    WARN(files.size() << " files (" << bytes / 1024 << " KiB): " << elapsed / rounds * 1000 << " ms per round, "
+                      << bytes * rounds / elapsed / (1024 * 1024) << " MiB/s");
+}